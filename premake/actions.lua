@@ -52,6 +52,11 @@ newoption {
 	description = "Enables code-coverage compiler hooks",
 }
 
+newoption {
+	trigger = "telemetry-trace",
+	description = "Enables the telemetry macros with the built-in trace capture backend (Chrome trace JSON files)",
+}
+
 newoption {
 	trigger = "research",
 	description = "Enables the inclusion of research projects",
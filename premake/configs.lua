@@ -117,6 +117,9 @@ end
 filter {"configurations:*telemetry*"}
 	defines {"_TELEMETRY"}
 
+filter {"options:telemetry-trace"}
+	defines {"_TELEMETRY", "_TELEMETRY_TRACE"}
+
 filter {"options:canvas-experimental"}
 	defines {"_CANVAS_EXPERIMENTAL"}
 
@@ -19,6 +19,7 @@ function m.link(prj)
             "cncbus",
             "extender",
             "log",
+            "telemetry",
             "app_thunk",
             "interpreter",
             "json_deflate",
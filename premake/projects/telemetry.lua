@@ -0,0 +1,10 @@
+-------------------------------------------------------------------------------
+-- telemetry.lua
+-- Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+-------------------------------------------------------------------------------
+
+project "telemetry"
+	kind "staticlib"
+	group "adk"
+	files "**.c"
+	files "**.h"
@@ -39,6 +39,7 @@ standard ADK app init thunks
 #include "source/adk/runtime/hosted_app.h"
 #include "source/adk/runtime/private/events.h"
 #include "source/adk/runtime/runtime.h"
+#include "source/adk/runtime/screenshot.h"
 #include "source/adk/runtime/thread_pool.h"
 #include "source/adk/steamboat/sb_platform.h"
 #include "source/adk/steamboat/sb_socket.h"
@@ -133,7 +134,8 @@ static int bus_dispatcher_thread_proc(void * const arg) {
     bus_dispatcher_t * const dispatcher = arg;
 
     while (dispatcher->run) {
-        if (cncbus_dispatch(dispatcher->bus, cncbus_dispatch_flush) != cncbus_dispatch_ok) {
+        // batches keep one busy receiver from starving the others
+        while (cncbus_dispatch(dispatcher->bus, cncbus_dispatch_batch) == cncbus_dispatch_ok) {
         }
 
         sb_thread_sleep((milliseconds_t){1});
@@ -229,6 +231,7 @@ bool app_init_subsystems(const runtime_configuration_t runtime_config) {
         the_app.guard_page_mode,
         adk_httpx_init_normal,
         "app-httpx");
+    adk_httpx_client_set_fragment_budget(the_app.httpx_client, runtime_config.network_pump_fragment_budget);
     APP_THUNK_TRACE_POP();
 
     APP_THUNK_TRACE_PUSH("init_reporting");
@@ -262,7 +265,7 @@ bool app_init_subsystems(const runtime_configuration_t runtime_config) {
 
     APP_THUNK_TRACE_PUSH("log_init");
     log_receiver_init(&the_app.bus, CNCBUS_ADDRESS_LOGGER);
-    log_init(&the_app.bus, CNCBUS_ADDRESS_LOGGER, CNCBUS_SUBNET_MASK_CORE, runtime_config.reporting.capture_logs ? the_app.reporting_instance : NULL);
+    log_init(&the_app.bus, CNCBUS_GROUP_LOGGER, CNCBUS_SUBNET_MASK_GROUP, runtime_config.reporting.capture_logs ? the_app.reporting_instance : NULL);
     APP_THUNK_TRACE_POP();
 
     APP_THUNK_TRACE_PUSH("event_logger init");
@@ -311,6 +314,11 @@ bool app_init_subsystems(const runtime_configuration_t runtime_config) {
             .tracking = {
                 .enabled = the_app.runtime_config.renderer.rhi_command_diffing.tracking.enabled,
                 .buffer_size = the_app.runtime_config.renderer.rhi_command_diffing.tracking.buffer_size,
+            },
+            .dirty_regions = {
+                .enabled = the_app.runtime_config.renderer.rhi_command_diffing.dirty_regions.enabled,
+                .tile_size = the_app.runtime_config.renderer.rhi_command_diffing.dirty_regions.tile_size,
+                .back_buffer_age = the_app.runtime_config.renderer.rhi_command_diffing.dirty_regions.back_buffer_age,
             }}});
 
     statics.subsystems_init = true;
@@ -352,6 +360,8 @@ void app_init_main_display(const int display_index, const int display_mode_index
     if (err) {
         LOG_ERROR(TAG_APP, "create_render_device error: '%s'", rhi_get_error_message(err));
         rhi_error_release(err, MALLOC_TAG);
+    } else {
+        render_set_max_pending_frames(render_device, the_app.runtime_config.renderer.device.max_pending_frames);
     }
 
     the_app.window = w;
@@ -387,6 +397,7 @@ void app_init_main_display(const int display_index, const int display_mode_index
 
 void app_shutdown_main_display(const app_display_shutdown_mode_e window) {
     if (the_app.window) {
+        adk_stop_continuous_capture();
         // Drain thread pool to ensure we aren't currently performing operations before tearing down canvas
         thread_pool_drain(&the_app.default_thread_pool);
         render_device_frame(the_app.render_device);
@@ -418,6 +429,9 @@ void app_shutdown_thunk() {
     // do this before shutting down systems to make sure
     // any enqueued tasks finish.
 
+    if (the_app.render_device) {
+        adk_stop_continuous_capture();
+    }
     thread_pool_drain(&the_app.default_thread_pool);
     thread_pool_shutdown(&the_app.default_thread_pool, MALLOC_TAG);
 
@@ -439,7 +453,7 @@ void app_shutdown_thunk() {
 
     // reinit the log with the same initial initializers except the reporting instance,
     // so that any of the remaining shutdowns that try to log something would not report it to the reporting instance.
-    log_init(&the_app.bus, CNCBUS_ADDRESS_LOGGER, CNCBUS_SUBNET_MASK_CORE, NULL);
+    log_init(&the_app.bus, CNCBUS_GROUP_LOGGER, CNCBUS_SUBNET_MASK_GROUP, NULL);
     adk_reporting_instance_free(the_app.reporting_instance);
     adk_httpx_client_free(the_app.httpx_client);
     heap_destroy(&statics.reporting_instance_heap, MALLOC_TAG);
@@ -608,12 +622,18 @@ int adk_main(const int argc, const char * const * const argv) {
     const int telemetry_help = findarg("--telemetry-help", argc, argv);
     const char * const telemetry_groups = getargarg("--telemetry", argc, argv);
     const char * const telemetry_address = getargarg("--telemetry-server", argc, argv);
+    const char * const telemetry_file = getargarg("--telemetry-file", argc, argv);
 #ifdef _TELEMETRY
     if (telemetry_help != -1) {
         telemetry_print_help();
         return merlin_exit_code_success;
     }
 
+#ifdef _TELEMETRY_TRACE
+    (void)telemetry_address;
+    telemetry_init(telemetry_file ? telemetry_file : "telemetry.json", telemetry_groups);
+#else
+    (void)telemetry_file;
     if (telemetry_address) {
         char address_buff[1024];
         strcpy_s(address_buff, ARRAY_SIZE(address_buff), telemetry_address);
@@ -624,8 +644,9 @@ int adk_main(const int argc, const char * const * const argv) {
     } else {
         telemetry_init("localhost", 4719, telemetry_groups);
     }
+#endif
 #else
-    if (telemetry_help || telemetry_groups || telemetry_address) {
+    if (telemetry_help || telemetry_groups || telemetry_address || telemetry_file) {
         LOG_ALWAYS(TAG_APP, "Telemetry disabled in build!");
     }
 #endif
@@ -699,6 +720,7 @@ static void log_periodic_metrics(const milliseconds_t delta_time, const sb_displ
 
         render_cmd_log_metrics();
         render_device_log_resource_tracking(the_app.render_device, the_app.runtime_config.renderer.render_resource_tracking.periodic_logging);
+        render_device_log_frame_metrics(the_app.render_device, the_app.runtime_config.renderer.frame_metrics.periodic_logging);
 
         the_app.fps.time.ms = 0;
         the_app.fps.num_frames = 0;
@@ -814,7 +836,7 @@ void app_event_loop(int (*tick_fn)(const uint32_t abstime, const float dt, void
                 cncbus_msg_write_checked(cncbus_msg, &batch_size, sizeof(size_t));
                 cncbus_msg_write_checked(cncbus_msg, the_app.event_head, (int)(sizeof(adk_event_t) * batch_size));
 
-                cncbus_send_async(cncbus_msg, CNCBUS_INVALID_ADDRESS, CNCBUS_ADDRESS_EVENTS, CNCBUS_SUBNET_MASK_CORE, NULL);
+                cncbus_send_async(cncbus_msg, CNCBUS_INVALID_ADDRESS, CNCBUS_GROUP_EVENTS, CNCBUS_SUBNET_MASK_GROUP, NULL);
             }
 
             APP_THUNK_TRACE_POP();
@@ -896,6 +918,7 @@ void app_event_loop(int (*tick_fn)(const uint32_t abstime, const float dt, void
                     APP_THUNK_TRACE_POP();
 
                     APP_THUNK_TRACE_PUSH("render write_present & device_frame");
+                    adk_continuous_capture_tick();
                     RENDER_ENSURE_WRITE_CMD_STREAM(
                         &the_app.render_device->default_cmd_stream,
                         render_cmd_buf_write_present,
@@ -991,7 +1014,8 @@ void app_drop_callback(void * const closure) {
         return;
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_i("app_drop_callback", (uint32_t)(uintptr_t)closure);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_drop_callback, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
 }
 
@@ -1001,7 +1025,8 @@ int app_run_callback(void * const closure) {
         return statics.rust_calls.callback(closure);
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_i("app_dispatch_callback", (uint32_t)(uintptr_t)closure);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
     return 0;
 }
@@ -1012,10 +1037,11 @@ int app_run_callback_v(void * const closure, void * const a0) {
         return statics.rust_calls.callback_v(closure, a0);
     }
 #endif
-    uint32_t ret = 0;
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_ri_ip("app_dispatch_callback_v", &ret, (uint32_t)(uintptr_t)closure, a0);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.I = (uint64_t)(uintptr_t)a0}};
+    wasm_call_slot_t ret = {0};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_v, &ret, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
-    return ret;
+    return (int)ret.i;
 }
 
 void app_run_callback_vi(void * const closure, void * const a0, const int a1) {
@@ -1025,7 +1051,8 @@ void app_run_callback_vi(void * const closure, void * const a0, const int a1) {
         return;
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_ipi("app_dispatch_callback_vi", (uint32_t)(uintptr_t)closure, a0, (uint32_t)a1);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.I = (uint64_t)(uintptr_t)a0}, {.i = (uint32_t)a1}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_vi, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
 }
 
@@ -1035,10 +1062,11 @@ int app_run_callback_vvi(void * const closure, void * const a0, void * const a1,
         return statics.rust_calls.callback_vvi(closure, a0, a1, a2);
     }
 #endif
-    uint32_t ret = 0;
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_ri_ippi("app_dispatch_callback_vvi", &ret, (uint32_t)(uintptr_t)closure, a0, a1, (uint32_t)a2);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.I = (uint64_t)(uintptr_t)a0}, {.I = (uint64_t)(uintptr_t)a1}, {.i = (uint32_t)a2}};
+    wasm_call_slot_t ret = {0};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_vvi, &ret, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
-    return ret;
+    return (int)ret.i;
 }
 
 int app_run_callback_vvii(void * const closure, void * const a0, void * const a1, const int a2, const int a3) {
@@ -1047,10 +1075,11 @@ int app_run_callback_vvii(void * const closure, void * const a0, void * const a1
         return statics.rust_calls.callback_vvii(closure, a0, a1, a2, a3);
     }
 #endif
-    uint32_t ret = 0;
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_ri_ippii("app_dispatch_callback_vvii", &ret, (uint32_t)(uintptr_t)closure, a0, a1, (uint32_t)a2, (uint32_t)a3);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.I = (uint64_t)(uintptr_t)a0}, {.I = (uint64_t)(uintptr_t)a1}, {.i = (uint32_t)a2}, {.i = (uint32_t)a3}};
+    wasm_call_slot_t ret = {0};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_vvii, &ret, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
-    return ret;
+    return (int)ret.i;
 }
 
 int app_run_callback_ivi(void * const closure, const int a0, void * const a1, const int a2) {
@@ -1059,10 +1088,11 @@ int app_run_callback_ivi(void * const closure, const int a0, void * const a1, co
         return statics.rust_calls.callback_ivi(closure, a0, a1, a2);
     }
 #endif
-    uint32_t ret = 0;
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_ri_iipi("app_dispatch_callback_ivi", &ret, (uint32_t)(uintptr_t)closure, (uint32_t)a0, a1, (uint32_t)a2);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.i = (uint32_t)a0}, {.I = (uint64_t)(uintptr_t)a1}, {.i = (uint32_t)a2}};
+    wasm_call_slot_t ret = {0};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_ivi, &ret, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
-    return ret;
+    return (int)ret.i;
 }
 
 void app_run_callback_once_i(void * const closure, const int a0) {
@@ -1072,7 +1102,8 @@ void app_run_callback_once_i(void * const closure, const int a0) {
         return;
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_ii("app_dispatch_callback_once_i", (uint32_t)(uintptr_t)closure, (uint32_t)a0);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.i = (uint32_t)a0}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_once_i, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
 }
 
@@ -1083,7 +1114,8 @@ void app_run_callback_once_ii(void * const closure, const int a0, const int a1)
         return;
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_iii("app_dispatch_callback_once_ii", (uint32_t)(uintptr_t)closure, (uint32_t)a0, (uint32_t)a1);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.i = (uint32_t)a0}, {.i = (uint32_t)a1}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_once_ii, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
 }
 
@@ -1094,7 +1126,8 @@ void app_run_callback_once_iii(void * const closure, const int a0, const int a1,
         return;
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_iiii("app_dispatch_callback_once_iii", (uint32_t)(uintptr_t)closure, (uint32_t)a0, (uint32_t)a1, (uint32_t)a2);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.i = (uint32_t)a0}, {.i = (uint32_t)a1}, {.i = (uint32_t)a2}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_once_iii, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
 }
 
@@ -1105,7 +1138,8 @@ void app_run_callback_once_iiii(void * const closure, const int a0, const int a1
         return;
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_iiiii("app_dispatch_callback_once_iiii", (uint32_t)(uintptr_t)closure, (uint32_t)a0, (uint32_t)a1, (uint32_t)a2, (uint32_t)a3);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.i = (uint32_t)a0}, {.i = (uint32_t)a1}, {.i = (uint32_t)a2}, {.i = (uint32_t)a3}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_once_iiii, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
 }
 
@@ -1116,7 +1150,8 @@ void app_run_callback_once_v(void * const closure, void * const a0) {
         return;
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_ip("app_dispatch_callback_once_v", (uint32_t)(uintptr_t)closure, a0);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.I = (uint64_t)(uintptr_t)a0}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_once_v, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
 }
 
@@ -1127,7 +1162,8 @@ void app_run_callback_once_vi(void * const closure, void * const a0, const int a
         return;
     }
 #endif
-    const wasm_call_result_t call_result = get_active_wasm_interpreter()->call_ipi("app_dispatch_callback_once_vi", (uint32_t)(uintptr_t)closure, a0, (uint32_t)a1);
+    const wasm_call_slot_t args[] = {{.i = (uint32_t)(uintptr_t)closure}, {.I = (uint64_t)(uintptr_t)a0}, {.i = (uint32_t)a1}};
+    const wasm_call_result_t call_result = wasm_call_export(wasm_export_app_dispatch_callback_once_vi, NULL, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(call_result);
 }
 
@@ -23,12 +23,23 @@ cg.c
 
 cg_statics_t cg_statics;
 
-void * cg_alloc(cg_heap_t * const cg_heap, const size_t alloc_size, const char * const tag) {
-    CG_TRACE_PUSH_FN();
+static void * cg_heap_unchecked_alloc(cg_heap_t * const cg_heap, const size_t alloc_size, const char * const tag) {
+    if (cg_heap->thread_cache.internal.init) {
+        return heap_thread_cache_unchecked_alloc(&cg_heap->thread_cache, alloc_size, tag);
+    }
 
     sb_lock_mutex(cg_heap->mutex);
-    void * const ptr = heap_alloc(&cg_heap->heap, alloc_size, tag);
+    void * const ptr = heap_unchecked_alloc(&cg_heap->heap, alloc_size, tag);
+    cg_heap->heap.internal.max_used_size = max_size_t(cg_heap->heap.internal.max_used_size, cg_heap->heap.internal.used_block_size);
     sb_unlock_mutex(cg_heap->mutex);
+    return ptr;
+}
+
+void * cg_alloc(cg_heap_t * const cg_heap, const size_t alloc_size, const char * const tag) {
+    CG_TRACE_PUSH_FN();
+
+    void * const ptr = cg_heap_unchecked_alloc(cg_heap, alloc_size, tag);
+    TRAP_HEAP_OUT_OF_MEMORY(ptr, &cg_heap->heap, alloc_size, tag);
     CG_TRACE_HEAP(&cg_heap->heap);
 
     CG_TRACE_POP();
@@ -38,9 +49,9 @@ void * cg_alloc(cg_heap_t * const cg_heap, const size_t alloc_size, const char *
 void * cg_calloc(cg_heap_t * const cg_heap, const size_t alloc_size, const char * const tag) {
     CG_TRACE_PUSH_FN();
 
-    sb_lock_mutex(cg_heap->mutex);
-    void * const ptr = heap_calloc(&cg_heap->heap, alloc_size, tag);
-    sb_unlock_mutex(cg_heap->mutex);
+    void * const ptr = cg_heap_unchecked_alloc(cg_heap, alloc_size, tag);
+    TRAP_HEAP_OUT_OF_MEMORY(ptr, &cg_heap->heap, alloc_size, tag);
+    memset(ptr, 0, alloc_size);
     CG_TRACE_HEAP(&cg_heap->heap);
 
     CG_TRACE_POP();
@@ -62,9 +73,13 @@ void * cg_realloc(cg_heap_t * const cg_heap, void * const ptr, const size_t new_
 void cg_free(cg_heap_t * const cg_heap, void * ptr, const char * const tag) {
     CG_TRACE_PUSH_FN();
 
-    sb_lock_mutex(cg_heap->mutex);
-    heap_free(&cg_heap->heap, ptr, tag);
-    sb_unlock_mutex(cg_heap->mutex);
+    if (cg_heap->thread_cache.internal.init) {
+        heap_thread_cache_free(&cg_heap->thread_cache, ptr, tag);
+    } else {
+        sb_lock_mutex(cg_heap->mutex);
+        heap_free(&cg_heap->heap, ptr, tag);
+        sb_unlock_mutex(cg_heap->mutex);
+    }
     CG_TRACE_HEAP(&cg_heap->heap);
 
     CG_TRACE_POP();
@@ -75,9 +90,7 @@ cg_allocation_t cg_unchecked_alloc(struct cg_heap_t * const cg_heap, const size_
     if (!cg_heap->heap.internal.init) {
         return (cg_allocation_t){0};
     }
-    sb_lock_mutex(cg_heap->mutex);
-    const cg_allocation_t alloc = {{{.cg_heap = cg_heap, .region = MEM_REGION(.ptr = heap_unchecked_alloc(&cg_heap->heap, alloc_size, tag), .size = alloc_size)}}};
-    sb_unlock_mutex(cg_heap->mutex);
+    const cg_allocation_t alloc = {{{.cg_heap = cg_heap, .region = MEM_REGION(.ptr = cg_heap_unchecked_alloc(cg_heap, alloc_size, tag), .size = alloc_size)}}};
     CG_TRACE_HEAP(&cg_heap->heap);
 
     CG_TRACE_POP();
@@ -608,30 +621,24 @@ static void cg_path_rounded_rect(cg_path_t * const paths, const cg_rect_t rect,
     CG_TRACE_POP();
 }
 
-static void cg_subpath_stroke(cg_gl_state_t * const gl, const cg_subpath_t * const subpath, const cg_state_t * const state, const cg_path_options_e options) {
+// miter length limit of strokes, in pixels
+#define CG_PATH_MITER_LIMIT 32.0f
+
+static int cg_subpath_stroke_vertex_count(const cg_subpath_t * const subpath) {
+    const int count = cg_subpath_size(subpath);
+    return (count < 2) ? 0 : (count - 1) * 10 + (subpath->closed ? 10 : 0);
+}
+
+// Writes the stroke of `subpath` to `verts` as one tristrip and returns the number of vertices written.
+static int cg_subpath_tessellate_stroke(cg_gl_vertex_t * const verts, const cg_subpath_t * const subpath, const float radius, const float feather, const float miter_limit, const float alpha) {
     CG_TRACE_PUSH_FN();
-    if (cg_subpath_size(subpath) < 2) {
-        CG_TRACE_POP();
-        return;
-    }
 
-    const float feather = state->feather;
-    const cg_color_t color = {
-        state->stroke_style.r,
-        state->stroke_style.g,
-        state->stroke_style.b,
-        state->stroke_style.a * state->global_alpha};
     const int count = cg_subpath_size(subpath);
     const bool closed = subpath->closed;
-    const int tri_strip_size = (count - 1) * 10 + (closed ? 10 : 0);
-    const float radius = state->line_width * 0.5f;
     int idx = 0;
     cg_vec2_t q0, q1 = {0}, q2, q3 = {0}, q4, q5 = {0}, q6, q7 = {0};
     bool cache_valid = false;
 
-    const int output_count = tri_strip_size;
-    cg_gl_vertex_t * verts = cg_gl_state_map_vertex_range(gl, output_count);
-
     for (int32_t i = 0; i < count - 1; ++i) {
         cg_subpath_wrap_e wrap_mode = closed ? cg_subpath_wrap_normal : cg_subpath_wrap_tangent;
         const cg_vec2_t * const p0 = cg_subpath_at(subpath, i - 1, wrap_mode);
@@ -648,7 +655,6 @@ static void cg_subpath_stroke(cg_gl_state_t * const gl, const cg_subpath_t * con
 
         const cg_vec2_t * const bi_normal = cg_vec2_normalize(cg_vec2_sub(p2, p1));
         const cg_vec2_t * const normal = cg_vec2_rot90(bi_normal);
-        const float k = 32.0f;
 
         // miter length is proportional to the angle between the binormal and normal
         // (this needs a proper limit/bevel!)
@@ -656,7 +662,7 @@ static void cg_subpath_stroke(cg_gl_state_t * const gl, const cg_subpath_t * con
             cg_vec2_normalize(
                 cg_vec2_add(cg_vec2_normalize(cg_vec2_sub(p3, p2)), bi_normal)));
         const float miter1k = radius * cg_inv(cg_vec2_dot(normal, tan1));
-        const cg_vec2_t * const miter1 = cg_vec2_scale(tan1, clamp_float(miter1k, 0.0f, k));
+        const cg_vec2_t * const miter1 = cg_vec2_scale(tan1, clamp_float(miter1k, 0.0f, miter_limit));
 
         // optimal, ccw wound, single tristrip order
         //
@@ -684,7 +690,7 @@ static void cg_subpath_stroke(cg_gl_state_t * const gl, const cg_subpath_t * con
                 cg_vec2_normalize(
                     cg_vec2_add(cg_vec2_normalize(cg_vec2_sub(p1, p0)), bi_normal)));
             const float miter0k = radius * cg_inv(cg_vec2_dot(normal, tan0));
-            const cg_vec2_t * const miter0 = cg_vec2_scale(tan0, clamp_float(miter0k, 0.0f, k));
+            const cg_vec2_t * const miter0 = cg_vec2_scale(tan0, clamp_float(miter0k, 0.0f, miter_limit));
 
             q4 = *cg_vec2_add(p1, miter0);
             q6 = *cg_vec2_add(&q4, cg_vec2_scale(tan0, feather));
@@ -704,7 +710,7 @@ static void cg_subpath_stroke(cg_gl_state_t * const gl, const cg_subpath_t * con
 
         // output continous tristrip (10 verts per segment total)
 
-        cg_color_t z = *cg_color(0, 0, 0, 0), a = *cg_color(0, 0, 0, color.a);
+        cg_color_t z = *cg_color(0, 0, 0, 0), a = *cg_color(0, 0, 0, alpha);
         cg_set_vert(verts, idx++, &q0, &z); // degenerate restart (might need to verify this?)
         cg_set_vert(verts, idx++, &q0, &z);
         cg_set_vert(verts, idx++, &q0, &z);
@@ -732,6 +738,25 @@ static void cg_subpath_stroke(cg_gl_state_t * const gl, const cg_subpath_t * con
         }
     }
 
+    CG_TRACE_POP();
+    return idx;
+}
+
+static void cg_subpath_stroke(cg_gl_state_t * const gl, const cg_subpath_t * const subpath, const cg_state_t * const state, const cg_path_options_e options) {
+    CG_TRACE_PUSH_FN();
+    if (cg_subpath_size(subpath) < 2) {
+        CG_TRACE_POP();
+        return;
+    }
+
+    const cg_color_t color = {
+        state->stroke_style.r,
+        state->stroke_style.g,
+        state->stroke_style.b,
+        state->stroke_style.a * state->global_alpha};
+
+    cg_gl_vertex_t * verts = cg_gl_state_map_vertex_range(gl, cg_subpath_stroke_vertex_count(subpath));
+    const int idx = cg_subpath_tessellate_stroke(verts, subpath, state->line_width * 0.5f, state->feather, CG_PATH_MITER_LIMIT, color.a);
     cg_gl_state_finish_vertex_range(gl);
 
     cg_select_blend_and_shader(gl, state, &color, NULL, cg_rgb_fill_alpha_red_disabled);
@@ -741,35 +766,28 @@ static void cg_subpath_stroke(cg_gl_state_t * const gl, const cg_subpath_t * con
     CG_TRACE_POP();
 }
 
-static void cg_subpath_fill(cg_gl_state_t * const gl, const cg_subpath_t * const subpath, cg_state_t * const state, const cg_path_options_e options) {
-    CG_TRACE_PUSH_FN();
-
-    if ((subpath->closed == false) || (cg_subpath_size(subpath) < 3)) {
-        CG_TRACE_POP();
-        return;
-    }
+static int cg_subpath_fill_strip_vertex_count(const cg_subpath_t * const subpath) {
+    return (cg_subpath_size(subpath) - 1) * 4 + 2;
+}
 
-    const float feather = state->feather;
+static int cg_subpath_fill_fan_vertex_count(const cg_subpath_t * const subpath) {
+    return cg_subpath_size(subpath) * 2 - 2;
+}
 
-    const cg_color_t color = {
-        state->fill_style.r,
-        state->fill_style.g,
-        state->fill_style.b,
-        state->fill_style.a * state->global_alpha};
+// Writes the feather tristrip of `subpath` to `verts` followed by its fill trifan, and returns the number of strip vertices written.
+// The fan starts at `cg_subpath_fill_strip_vertex_count()`, texture coordinates are the positions scaled by `uv_scale_x/y`.
+static int cg_subpath_tessellate_fill(cg_gl_vertex_t * const verts, const cg_subpath_t * const subpath, const float feather, const float alpha, const float uv_scale_x, const float uv_scale_y) {
+    CG_TRACE_PUSH_FN();
 
     const int count = cg_subpath_size(subpath);
-    const int tri_strip_size = (count - 1) * 4 + 2;
-    const int fan_size = count * 2 - 2;
+    const int tri_strip_size = cg_subpath_fill_strip_vertex_count(subpath);
     int tidx = 0, fidx0 = tri_strip_size, fidx = fidx0;
     cg_vec2_t q0, q1, q2 = {0}, q3 = {0};
     bool cache_valid = false;
 
-    const float w = ((state->image == NULL) || (state->image->status != cg_image_async_load_complete)) ? 1.0f : 1.0f / state->image->cg_texture.texture->width;
-    const float h = ((state->image == NULL) || (state->image->status != cg_image_async_load_complete)) ? 1.0f : 1.0f / state->image->cg_texture.texture->height;
-    const float a = color.a;
-
-    const int output_count = tri_strip_size + fan_size;
-    cg_gl_vertex_t * verts = cg_gl_state_map_vertex_range(gl, output_count);
+    const float w = uv_scale_x;
+    const float h = uv_scale_y;
+    const float a = alpha;
 
     for (int32_t i = 0; i < count - 1; ++i) {
         const cg_vec2_t * const p0 = cg_subpath_at(subpath, i - 1, cg_subpath_wrap_normal);
@@ -834,24 +852,36 @@ static void cg_subpath_fill(cg_gl_state_t * const gl, const cg_subpath_t * const
         }
     }
 
-    cg_gl_state_finish_vertex_range(gl);
+    CG_TRACE_POP();
+    return tidx;
+}
 
-    cg_select_blend_and_shader(gl, state, &color, (state->image && (state->image->status == cg_image_async_load_complete)) ? &state->image->cg_texture : NULL, cg_rgb_fill_alpha_red_disabled);
+// Draws from the streamed vertex range when `mesh` is NULL.
+static void cg_path_draw(cg_gl_state_t * const gl, r_mesh_t * const mesh, const rhi_rect_t bounds, const rhi_draw_mode_e prim, const int count, const int offset) {
+    if (mesh) {
+        cg_gl_state_draw_mesh_in_bounds(gl, mesh, prim, count, offset, bounds);
+    } else {
+        cg_gl_state_draw(gl, prim, count, offset);
+    }
+}
+
+static void cg_subpath_draw_fill(cg_gl_state_t * const gl, r_mesh_t * const mesh, const rhi_rect_t bounds, const cg_path_options_e options, const int strip_count, const int strip_offset, const int fan_count, const int fan_offset) {
+    CG_TRACE_PUSH_FN();
 
     if (options & cg_path_options_concave) {
         // concave
 
         // fill
         cg_gl_state_set_mode_stencil_accum(gl);
-        cg_gl_state_draw_tri_fan(gl, fan_size, fidx0);
+        cg_path_draw(gl, mesh, bounds, rhi_triangle_fan, fan_count, fan_offset);
 
         // feather
         cg_gl_state_set_mode_stencil_eq(gl);
-        cg_gl_state_draw_tri_strip(gl, tidx, 0);
+        cg_path_draw(gl, mesh, bounds, rhi_triangle_strip, strip_count, strip_offset);
 
         // fill
         cg_gl_state_set_mode_stencil_neq(gl);
-        cg_gl_state_draw_tri_fan(gl, fan_size, fidx0);
+        cg_path_draw(gl, mesh, bounds, rhi_triangle_fan, fan_count, fan_offset);
 
         cg_gl_state_set_mode_stencil_off(gl);
     } else {
@@ -859,20 +889,64 @@ static void cg_subpath_fill(cg_gl_state_t * const gl, const cg_subpath_t * const
 
         // feather
         if ((options & cg_path_options_no_fethering) == 0) {
-            cg_gl_state_draw_tri_strip(gl, tidx, 0);
+            cg_path_draw(gl, mesh, bounds, rhi_triangle_strip, strip_count, strip_offset);
         }
 
         // fill
-        cg_gl_state_draw_tri_fan(gl, fan_size, fidx0);
+        cg_path_draw(gl, mesh, bounds, rhi_triangle_fan, fan_count, fan_offset);
     }
 
     CG_TRACE_POP();
 }
 
+static void cg_subpath_fill(cg_gl_state_t * const gl, const cg_subpath_t * const subpath, cg_state_t * const state, const cg_path_options_e options) {
+    CG_TRACE_PUSH_FN();
+
+    if ((subpath->closed == false) || (cg_subpath_size(subpath) < 3)) {
+        CG_TRACE_POP();
+        return;
+    }
+
+    const cg_color_t color = {
+        state->fill_style.r,
+        state->fill_style.g,
+        state->fill_style.b,
+        state->fill_style.a * state->global_alpha};
+
+    const int tri_strip_size = cg_subpath_fill_strip_vertex_count(subpath);
+    const int fan_size = cg_subpath_fill_fan_vertex_count(subpath);
+
+    const float w = ((state->image == NULL) || (state->image->status != cg_image_async_load_complete)) ? 1.0f : 1.0f / state->image->cg_texture.texture->width;
+    const float h = ((state->image == NULL) || (state->image->status != cg_image_async_load_complete)) ? 1.0f : 1.0f / state->image->cg_texture.texture->height;
+
+    cg_gl_vertex_t * verts = cg_gl_state_map_vertex_range(gl, tri_strip_size + fan_size);
+    const int tidx = cg_subpath_tessellate_fill(verts, subpath, state->feather, color.a, w, h);
+    cg_gl_state_finish_vertex_range(gl);
+
+    cg_select_blend_and_shader(gl, state, &color, (state->image && (state->image->status == cg_image_async_load_complete)) ? &state->image->cg_texture : NULL, cg_rgb_fill_alpha_red_disabled);
+
+    cg_subpath_draw_fill(gl, NULL, (rhi_rect_t){0}, options, tidx, 0, fan_size, tri_strip_size);
+
+    CG_TRACE_POP();
+}
+
 /* ===========================================================================
  * CANVAS
  * ==========================================================================*/
 
+static void cg_heap_init_thread_cache(cg_context_t * const ctx, cg_heap_t * const cg_heap) {
+    // the high heap comes and goes with the memory mode, its mutex outlives it
+    if (ctx->config.thread_cache.enabled && cg_heap->mutex && cg_heap->heap.internal.init && !cg_heap->thread_cache.internal.init) {
+        heap_thread_cache_init_with_heap(&cg_heap->thread_cache, &cg_heap->heap, cg_heap->mutex);
+    }
+}
+
+static void cg_heap_destroy_thread_cache(cg_heap_t * const cg_heap) {
+    if (cg_heap->thread_cache.internal.init) {
+        heap_thread_cache_destroy(&cg_heap->thread_cache);
+    }
+}
+
 void cg_context_init(
     cg_context_t * const ctx,
     cg_gl_state_t * const gl,
@@ -908,6 +982,9 @@ void cg_context_init(
     ctx->gl = gl;
     ctx->config = canvas_config;
 
+    cg_heap_init_thread_cache(ctx, &ctx->cg_heap_low);
+    cg_heap_init_thread_cache(ctx, &ctx->cg_heap_high);
+
     ctx->state_idx = 0;
 
     ctx->states = cg_alloc(&ctx->cg_heap_low, sizeof(*ctx->states) * ctx->config.internal_limits.max_states, MALLOC_TAG);
@@ -932,6 +1009,7 @@ void cg_context_init(
         ctx,
         canvas_config.font_atlas.width ? canvas_config.font_atlas.width : virtual_display.width,
         canvas_config.font_atlas.height ? canvas_config.font_atlas.height : virtual_display.height,
+        canvas_config.font_atlas.num_pages ? canvas_config.font_atlas.num_pages : cg_default_font_atlas_num_pages,
         memory_initializers.font_scratchpad_mem,
         memory_initializers.guard_page_mode,
         tag);
@@ -953,6 +1031,9 @@ void cg_context_free(cg_context_t * const ctx, const char * const tag) {
         ctx->free_block_chain = block;
     }
 
+    cg_heap_destroy_thread_cache(&ctx->cg_heap_low);
+    cg_heap_destroy_thread_cache(&ctx->cg_heap_high);
+
 #ifndef _SHIP
     heap_debug_print_leaks(&ctx->cg_heap_low.heap);
     if (ctx->cg_heap_high.heap.internal.init) {
@@ -971,6 +1052,7 @@ void cg_context_free(cg_context_t * const ctx, const char * const tag) {
 
 void cg_context_set_memory_mode(cg_context_t * const ctx, const cg_memory_mode_e memory_mode) {
     if ((memory_mode == cg_memory_mode_low) && ctx->cg_heap_high.heap.internal.init) {
+        cg_heap_destroy_thread_cache(&ctx->cg_heap_high);
 #ifndef _SHIP
         heap_debug_print_leaks(&ctx->cg_heap_high.heap);
 #endif
@@ -988,6 +1070,7 @@ void cg_context_set_memory_mode(cg_context_t * const ctx, const cg_memory_mode_e
             ctx->high_mem_region = sb_map_pages(PAGE_ALIGN_INT(ctx->high_mem_region.size), system_page_protect_read_write);
             heap_init_with_region(&ctx->cg_heap_high.heap, ctx->high_mem_region, 8, 0, "canvas_heap_high");
         }
+        cg_heap_init_thread_cache(ctx, &ctx->cg_heap_high);
     }
 }
 
@@ -1278,6 +1361,354 @@ void cg_context_stroke(const char * const tag) {
     CG_TRACE_POP();
 }
 
+/* ===========================================================================
+ * RETAINED PATH
+ * ==========================================================================*/
+
+typedef struct cg_retained_path_range_t {
+    int subpath;
+    int offset;
+    int strip_count;
+    // fill fan, relative to `offset`. strokes have no fan
+    int fan_offset;
+    int fan_count;
+} cg_retained_path_range_t;
+
+// Tessellated fill or stroke of a retained path.
+// The vertices are tessellated in path space with their alpha as coverage, and transformed into the mesh when the transform, alpha or texture scale changes.
+typedef struct cg_retained_path_mesh_t {
+    cg_retained_path_range_t * ranges;
+    int num_ranges;
+    int num_verts;
+
+    cg_gl_vertex_t * local_verts;
+    // double buffered so an upload never has to wait on the one before it
+    cg_gl_vertex_t * staging_verts[2];
+    rb_fence_t staging_fences[2];
+    int staging_index;
+
+    r_mesh_t * r_mesh;
+    const_mem_region_t null_buffer;
+    rhi_rect_t bounds;
+
+    // what `local_verts` was tessellated for
+    struct {
+        float scale;
+        float feather;
+        float line_width;
+        bool mirrored;
+        bool valid;
+    } tessellation;
+
+    // what `r_mesh` holds
+    struct {
+        cg_affine_t transform;
+        float alpha;
+        float uv_scale_x;
+        float uv_scale_y;
+        bool valid;
+    } upload;
+} cg_retained_path_mesh_t;
+
+struct cg_retained_path_t {
+    // path space subpaths, the last one is closed by fills when it was left open (see `cg_context_fill`)
+    cg_subpath_t * subpaths;
+    int num_subpaths;
+    bool fill_closes_last_subpath;
+
+    cg_retained_path_mesh_t fill;
+    cg_retained_path_mesh_t stroke;
+};
+
+static bool cg_retained_path_is_filled_subpath(const cg_retained_path_t * const path, const int subpath_index) {
+    const cg_subpath_t * const subpath = &path->subpaths[subpath_index];
+    return (subpath->closed || (path->fill_closes_last_subpath && (subpath_index == path->num_subpaths - 1))) && (cg_subpath_size(subpath) >= 3);
+}
+
+static void cg_retained_path_mesh_init_ranges(cg_retained_path_t * const path, cg_retained_path_mesh_t * const mesh, const bool fill, const char * const tag) {
+    CG_TRACE_PUSH_FN();
+
+    cg_context_t * const ctx = cg_statics.ctx;
+    mesh->ranges = cg_alloc(&ctx->cg_heap_low, sizeof(cg_retained_path_range_t) * (path->num_subpaths + 1), tag);
+    for (int i = 0; i < path->num_subpaths; ++i) {
+        const cg_subpath_t * const subpath = &path->subpaths[i];
+        if (fill ? !cg_retained_path_is_filled_subpath(path, i) : (cg_subpath_size(subpath) < 2)) {
+            continue;
+        }
+
+        cg_retained_path_range_t * const range = &mesh->ranges[mesh->num_ranges++];
+        range->subpath = i;
+        range->offset = mesh->num_verts;
+        range->strip_count = 0;
+        range->fan_offset = fill ? cg_subpath_fill_strip_vertex_count(subpath) : 0;
+        range->fan_count = fill ? cg_subpath_fill_fan_vertex_count(subpath) : 0;
+        mesh->num_verts += fill ? (range->fan_offset + range->fan_count) : cg_subpath_stroke_vertex_count(subpath);
+    }
+
+    CG_TRACE_POP();
+}
+
+static void cg_retained_path_mesh_alloc(cg_retained_path_mesh_t * const mesh, const char * const tag) {
+    CG_TRACE_PUSH_FN();
+
+    cg_context_t * const ctx = cg_statics.ctx;
+    const size_t verts_size = sizeof(cg_gl_vertex_t) * mesh->num_verts;
+
+    // vertices of segments skipped by the tessellator are never written, they stay degenerate
+    mesh->local_verts = cg_calloc(&ctx->cg_heap_low, verts_size, tag);
+    for (int i = 0; i < ARRAY_SIZE(mesh->staging_verts); ++i) {
+        mesh->staging_verts[i] = cg_alloc(&ctx->cg_heap_low, verts_size, tag);
+        mesh->staging_fences[i] = render_get_cmd_stream_fence(&ctx->gl->render_device->default_cmd_stream);
+    }
+
+    mesh->null_buffer = CONST_MEM_REGION(.ptr = NULL, .size = verts_size);
+
+    rhi_mesh_data_init_indirect_t mi;
+    ZEROMEM(&mi);
+    mi.num_channels = 1;
+    mi.channels = &mesh->null_buffer;
+
+    mesh->r_mesh = render_create_mesh(ctx->gl->render_device, mi, ctx->gl->mesh_layout, tag);
+
+    CG_TRACE_POP();
+}
+
+static void cg_retained_path_mesh_free(cg_retained_path_mesh_t * const mesh, const char * const tag) {
+    CG_TRACE_PUSH_FN();
+
+    cg_context_t * const ctx = cg_statics.ctx;
+    if (mesh->local_verts) {
+        render_device_t * const render_device = ctx->gl->render_device;
+        for (int i = 0; i < ARRAY_SIZE(mesh->staging_verts); ++i) {
+            render_conditional_flush_cmd_stream_and_wait_fence(render_device, &render_device->default_cmd_stream, mesh->staging_fences[i]);
+            cg_free(&ctx->cg_heap_low, mesh->staging_verts[i], tag);
+        }
+        render_release(&mesh->r_mesh->resource, tag);
+        cg_free(&ctx->cg_heap_low, mesh->local_verts, tag);
+    }
+    if (mesh->ranges) {
+        cg_free(&ctx->cg_heap_low, mesh->ranges, tag);
+    }
+    ZEROMEM(mesh);
+
+    CG_TRACE_POP();
+}
+
+static void cg_retained_path_tessellate(cg_retained_path_t * const path, cg_retained_path_mesh_t * const mesh, const bool fill, const cg_state_t * const state, const float scale, const bool mirrored) {
+    CG_TRACE_PUSH_FN();
+
+    if (mesh->tessellation.valid && (mesh->tessellation.scale == scale) && (mesh->tessellation.feather == state->feather) && (fill || (mesh->tessellation.line_width == state->line_width)) && (mesh->tessellation.mirrored == mirrored)) {
+        CG_TRACE_POP();
+        return;
+    }
+
+    // feather, line width and miter limit are in pixels, so they shrink with the scale of the transform in path space
+    const float inv_scale = 1.0f / scale;
+    for (int i = 0; i < mesh->num_ranges; ++i) {
+        cg_retained_path_range_t * const range = &mesh->ranges[i];
+        cg_subpath_t * const subpath = &path->subpaths[range->subpath];
+
+        // tessellate for a clock wise winding on screen, the same as immediate fills and strokes do
+        const cg_subpath_winding_e winding = cg_subpath_winding(subpath);
+        if ((winding != cg_subpath_winding_none) && ((winding == cg_subpath_winding_ccw) != mirrored)) {
+            cg_subpath_reverse(subpath);
+        }
+
+        if (fill) {
+            cg_subpath_t closed_subpath = *subpath;
+            closed_subpath.closed = true;
+            range->strip_count = cg_subpath_tessellate_fill(&mesh->local_verts[range->offset], &closed_subpath, state->feather * inv_scale, 1.0f, 0.0f, 0.0f);
+        } else {
+            range->strip_count = cg_subpath_tessellate_stroke(&mesh->local_verts[range->offset], subpath, state->line_width * 0.5f * inv_scale, state->feather * inv_scale, CG_PATH_MITER_LIMIT * inv_scale, 1.0f);
+        }
+    }
+
+    mesh->tessellation.scale = scale;
+    mesh->tessellation.feather = state->feather;
+    mesh->tessellation.line_width = state->line_width;
+    mesh->tessellation.mirrored = mirrored;
+    mesh->tessellation.valid = true;
+    mesh->upload.valid = false;
+
+    CG_TRACE_POP();
+}
+
+static void cg_retained_path_upload(cg_retained_path_mesh_t * const mesh, const cg_affine_t * const transform, const float alpha, const float uv_scale_x, const float uv_scale_y) {
+    CG_TRACE_PUSH_FN();
+
+    if (mesh->upload.valid && !memcmp(&mesh->upload.transform, transform, sizeof(*transform)) && (mesh->upload.alpha == alpha) && (mesh->upload.uv_scale_x == uv_scale_x) && (mesh->upload.uv_scale_y == uv_scale_y)) {
+        CG_TRACE_POP();
+        return;
+    }
+
+    render_device_t * const render_device = cg_statics.ctx->gl->render_device;
+    const int staging_index = mesh->staging_index;
+    cg_gl_vertex_t * const staging_verts = mesh->staging_verts[staging_index];
+    render_conditional_flush_cmd_stream_and_wait_fence(render_device, &render_device->default_cmd_stream, mesh->staging_fences[staging_index]);
+
+    for (int i = 0; i < mesh->num_verts; ++i) {
+        const cg_gl_vertex_t * const local = &mesh->local_verts[i];
+        const cg_vec2_t * const pos = cg_affine_apply(transform, cg_vec2(local->x, local->y));
+        staging_verts[i] = (cg_gl_vertex_t){
+            .x = pos->x,
+            .y = pos->y,
+            .r = pos->x * uv_scale_x,
+            .g = pos->y * uv_scale_y,
+            .b = 0.0f,
+            .a = local->a * alpha};
+    }
+
+    mesh->r_mesh->hash = render_cmd_stream_upload_mesh_channel_data(
+        &render_device->default_cmd_stream,
+        &mesh->r_mesh->mesh,
+        0,
+        0,
+        mesh->num_verts,
+        sizeof(cg_gl_vertex_t),
+        staging_verts,
+        MALLOC_TAG);
+    mesh->staging_fences[staging_index] = render_get_cmd_stream_fence(&render_device->default_cmd_stream);
+    mesh->staging_index = staging_index ^ 1;
+    mesh->bounds = cg_gl_vertex_bounds(staging_verts, mesh->num_verts);
+
+    mesh->upload.transform = *transform;
+    mesh->upload.alpha = alpha;
+    mesh->upload.uv_scale_x = uv_scale_x;
+    mesh->upload.uv_scale_y = uv_scale_y;
+    mesh->upload.valid = true;
+
+    CG_TRACE_POP();
+}
+
+// Makes `mesh` current for the state's transform, returns false when there is nothing to draw.
+static bool cg_retained_path_prepare(cg_retained_path_t * const path, cg_retained_path_mesh_t * const mesh, const bool fill, const cg_state_t * const state, const float alpha, const float uv_scale_x, const float uv_scale_y) {
+    CG_TRACE_PUSH_FN();
+
+    const cg_affine_t * const transform = &state->transform;
+    const float scale = cg_affine_get_scale(transform);
+    if ((mesh->num_verts == 0) || !(scale > 0.0f)) {
+        CG_TRACE_POP();
+        return false;
+    }
+
+    if (!mesh->local_verts) {
+        cg_retained_path_mesh_alloc(mesh, MALLOC_TAG);
+    }
+
+    const bool mirrored = ((transform->a * transform->d) - (transform->b * transform->c)) < 0.0f;
+    cg_retained_path_tessellate(path, mesh, fill, state, scale, mirrored);
+    cg_retained_path_upload(mesh, transform, alpha, uv_scale_x, uv_scale_y);
+
+    CG_TRACE_POP();
+    return true;
+}
+
+cg_retained_path_t * cg_context_create_retained_path(const char * const tag) {
+    CG_TRACE_PUSH_FN();
+
+    cg_context_t * const ctx = cg_statics.ctx;
+    const cg_path_t * const cur_path = &ctx->path;
+    const int num_closed_subpaths = (int)cg_path_size(cur_path);
+    const bool has_open_subpath = cg_subpath_size(&cur_path->cur_path) > 1;
+
+    cg_retained_path_t * const path = cg_calloc(&ctx->cg_heap_low, sizeof(cg_retained_path_t), tag);
+    path->num_subpaths = num_closed_subpaths + (has_open_subpath ? 1 : 0);
+    path->fill_closes_last_subpath = has_open_subpath;
+    path->subpaths = cg_alloc(&ctx->cg_heap_low, sizeof(cg_subpath_t) * (path->num_subpaths + 1), tag);
+
+    // path points are already transformed, bring them back into the space they were specified in
+    cg_affine_t inv_transform = ctx->cur_state->transform;
+    cg_affine_invert(&inv_transform);
+
+    for (int i = 0; i < path->num_subpaths; ++i) {
+        const cg_subpath_t * const src = (i < num_closed_subpaths) ? &cur_path->paths[i] : &cur_path->cur_path;
+        cg_subpath_t * const dst = &path->subpaths[i];
+        *dst = *cg_subpath(tag);
+        dst->closed = src->closed;
+        const int count = cg_subpath_size(src);
+        for (int j = 0; j < count; ++j) {
+            cg_subpath_push(dst, cg_affine_apply(&inv_transform, &src->array[j]), tag);
+        }
+    }
+
+    cg_retained_path_mesh_init_ranges(path, &path->fill, true, tag);
+    cg_retained_path_mesh_init_ranges(path, &path->stroke, false, tag);
+
+    CG_TRACE_POP();
+    return path;
+}
+
+void cg_context_free_retained_path(cg_retained_path_t * const path, const char * const tag) {
+    CG_TRACE_PUSH_FN();
+
+    cg_context_t * const ctx = cg_statics.ctx;
+    cg_retained_path_mesh_free(&path->fill, tag);
+    cg_retained_path_mesh_free(&path->stroke, tag);
+    for (int i = 0; i < path->num_subpaths; ++i) {
+        cg_subpath_free(&path->subpaths[i], tag);
+    }
+    cg_free(&ctx->cg_heap_low, path->subpaths, tag);
+    cg_free(&ctx->cg_heap_low, path, tag);
+
+    CG_TRACE_POP();
+}
+
+void cg_context_fill_retained_path(cg_retained_path_t * const path, const cg_path_options_e options) {
+    CG_TRACE_PUSH_FN();
+
+    cg_context_t * const ctx = cg_statics.ctx;
+    const cg_state_t * const state = ctx->cur_state;
+    const cg_color_t color = {
+        state->fill_style.r,
+        state->fill_style.g,
+        state->fill_style.b,
+        state->fill_style.a * state->global_alpha};
+
+    const bool has_image = state->image && (state->image->status == cg_image_async_load_complete);
+    const float w = has_image ? 1.0f / state->image->cg_texture.texture->width : 1.0f;
+    const float h = has_image ? 1.0f / state->image->cg_texture.texture->height : 1.0f;
+
+    cg_retained_path_mesh_t * const mesh = &path->fill;
+    if (!cg_retained_path_prepare(path, mesh, true, state, color.a, w, h)) {
+        CG_TRACE_POP();
+        return;
+    }
+
+    cg_select_blend_and_shader(ctx->gl, state, &color, has_image ? &state->image->cg_texture : NULL, cg_rgb_fill_alpha_red_disabled);
+    for (int i = 0; i < mesh->num_ranges; ++i) {
+        const cg_retained_path_range_t * const range = &mesh->ranges[i];
+        cg_subpath_draw_fill(ctx->gl, mesh->r_mesh, mesh->bounds, options, range->strip_count, range->offset, range->fan_count, range->offset + range->fan_offset);
+    }
+
+    CG_TRACE_POP();
+}
+
+void cg_context_stroke_retained_path(cg_retained_path_t * const path, const cg_path_options_e options) {
+    CG_TRACE_PUSH_FN();
+
+    cg_context_t * const ctx = cg_statics.ctx;
+    const cg_state_t * const state = ctx->cur_state;
+    const cg_color_t color = {
+        state->stroke_style.r,
+        state->stroke_style.g,
+        state->stroke_style.b,
+        state->stroke_style.a * state->global_alpha};
+
+    cg_retained_path_mesh_t * const mesh = &path->stroke;
+    if (!cg_retained_path_prepare(path, mesh, false, state, color.a, 0.0f, 0.0f)) {
+        CG_TRACE_POP();
+        return;
+    }
+
+    cg_select_blend_and_shader(ctx->gl, state, &color, NULL, cg_rgb_fill_alpha_red_disabled);
+    for (int i = 0; i < mesh->num_ranges; ++i) {
+        const cg_retained_path_range_t * const range = &mesh->ranges[i];
+        cg_path_draw(ctx->gl, mesh->r_mesh, mesh->bounds, rhi_triangle_strip, range->strip_count, range->offset);
+    }
+
+    CG_TRACE_POP();
+}
+
 void cg_context_quad_bezier_to(const float cpx, const float cpy, const float x, const float y, const char * const tag) {
     CG_TRACE_PUSH_FN();
     cg_path_quad_bezier_to(&cg_statics.ctx->path, cpx, cpy, x, y, tag);
@@ -1494,7 +1925,7 @@ void cg_context_sdf_draw_image_rect_rounded(const cg_image_t * const image, cons
     const float iw = 1.0f / (drawable_image ? drawable_image->cg_texture.texture->width : 1);
     const float ih = 1.0f / (drawable_image ? drawable_image->cg_texture.texture->height : 1);
 
-    cg_gl_vertex_t * verts = cg_gl_state_map_vertex_range(ctx->gl, 6);
+    cg_gl_vertex_t * verts = cg_gl_state_map_unbatched_vertex_range(ctx->gl, 6);
     cg_2d_mesh_t mesh = {.verts = verts, .max_verts = 6};
     cg_set_quad_verts(&mesh, (cg_vec2_t){iw, ih}, src, dst, ctx->cur_state->fill_style.a * ctx->cur_state->global_alpha);
 
@@ -1556,7 +1987,7 @@ void cg_context_sdf_fill_image_rect_rounded(const cg_image_t * const image, cons
         .height = src.height * uv_repeats.y,
     };
 
-    cg_gl_vertex_t * const verts = cg_gl_state_map_vertex_range(ctx->gl, 6);
+    cg_gl_vertex_t * const verts = cg_gl_state_map_unbatched_vertex_range(ctx->gl, 6);
     cg_2d_mesh_t mesh = (cg_2d_mesh_t){.verts = verts, .max_verts = 6};
 
     cg_set_quad_verts(&mesh, inverse_img_dims, src_rect, dst_rect, ctx->cur_state->fill_style.a * ctx->cur_state->global_alpha);
@@ -1832,7 +2263,7 @@ void cg_context_blit_video_frame(const cg_rect_t rect) {
         const cg_vec2_t * const p2 = cg_affine_apply(xform, cg_vec2(rect.x + rect.width, rect.y + rect.height));
         const cg_vec2_t * const p3 = cg_affine_apply(xform, cg_vec2(rect.x, rect.y + rect.height));
 
-        cg_gl_vertex_t * verts = cg_gl_state_map_vertex_range(ctx->gl, 4);
+        cg_gl_vertex_t * verts = cg_gl_state_map_unbatched_vertex_range(ctx->gl, 4);
 
         cg_set_vert(verts, 0, p0, cg_color(0, 0, 0, video_alpha));
         cg_set_vert(verts, 1, p1, cg_color(1, 0, 0, video_alpha));
@@ -1871,7 +2302,7 @@ void cg_context_blit_video_frame(const cg_rect_t rect) {
     if (subtitle_frame) {
         const float a = fill_alpha;
 
-        cg_gl_vertex_t * verts = cg_gl_state_map_vertex_range(ctx->gl, 4);
+        cg_gl_vertex_t * verts = cg_gl_state_map_unbatched_vertex_range(ctx->gl, 4);
 
         const cg_vec2_t * const p0 = cg_affine_apply(xform, cg_vec2(output_rect.x1, output_rect.y1));
         const cg_vec2_t * const p1 = cg_affine_apply(xform, cg_vec2(output_rect.x2, output_rect.y1));
@@ -14,6 +14,7 @@ cg.h
 
 #include "source/adk/manifest/manifest.h"
 #include "source/adk/runtime/memory.h"
+#include "source/adk/runtime/memory_thread_cache.h"
 #include "source/adk/runtime/runtime.h"
 #include "source/adk/runtime/thread_pool.h"
 #include "source/adk/steamboat/sb_file.h"
@@ -34,6 +35,9 @@ extern "C" {
 enum {
     cg_default_max_states = 128,
     cg_default_max_text_mesh_cache_size = 64,
+    cg_default_text_mesh_cache_max_bytes = 512 * 1024,
+    cg_default_font_atlas_num_pages = 1,
+    cg_max_font_atlas_pages = 32, // pages referenced by a cached text mesh are tracked in a 32bit mask
     cg_default_max_tesselation_steps = 10,
     cg_gl_default_max_verts_per_vertex_bank = 16 * 1024,
     cg_gl_default_vertex_banks = 2,
@@ -208,6 +212,9 @@ typedef struct cg_image_t {
     cg_context_t * cg_ctx;
 
     struct image_load_data_t * load_user;
+    // decode job while the image is queued for decoding, cancelled if the image is freed before it runs
+    thread_pool_job_handle_t decode_job;
+    thread_pool_priority_e load_priority;
     cg_image_async_load_status_e status;
     cg_image_animation_state_e image_animation_state;
     int32_t ripcut_error_code;
@@ -320,6 +327,8 @@ struct cg_mem_block_t;
 typedef struct cg_heap_t {
     heap_t heap;
     sb_mutex_t * mutex;
+    // optional per-thread magazines for small allocations, see `runtime_configuration_canvas_t.thread_cache`
+    heap_thread_cache_t thread_cache;
 } cg_heap_t;
 
 typedef enum cg_memory_mode_e {
@@ -401,6 +410,19 @@ heap_metrics_t cg_context_get_heap_metrics_high(cg_context_t * const ctx);
 
 heap_metrics_t cg_context_get_heap_metrics_low(cg_context_t * const ctx);
 
+typedef struct cg_text_mesh_cache_metrics_t {
+    uint64_t hits;
+    uint64_t misses;
+    // meshes dropped to make room (lru/byte budget) or because the atlas page they sampled was evicted
+    uint64_t evictions;
+    uint64_t num_entries;
+    // vertex bytes held by cached meshes, and the budget they're kept under (0 when unbounded)
+    uint64_t bytes_used;
+    uint64_t max_bytes;
+} cg_text_mesh_cache_metrics_t;
+
+cg_text_mesh_cache_metrics_t cg_context_get_text_mesh_cache_metrics(cg_context_t * const ctx);
+
 FFI_EXPORT FFI_PTR_NATIVE cg_context_t * cg_get_context();
 FFI_EXPORT void cg_set_context(FFI_PTR_NATIVE cg_context_t * const ctx);
 
@@ -498,6 +520,28 @@ FFI_EXPORT void cg_context_stroke_with_options(const cg_path_options_e options,
 
 /* ------------------------------------------------------------------------- */
 
+/// A path that is tessellated once and drawn many times, for static shapes such as focus rings and cards.
+typedef struct cg_retained_path_t cg_retained_path_t;
+
+/// Captures the current path (see `cg_context_begin_path`) into a retained path.
+/// The path is kept in the space of the current transform, later draws place it with the transform current at draw time.
+/// An open last subpath is closed by fills, the same as `cg_context_fill`.
+cg_retained_path_t * cg_context_create_retained_path(const char * const tag);
+
+/// Frees a retained path, waiting for the renderer to finish with its meshes.
+void cg_context_free_retained_path(cg_retained_path_t * const path, const char * const tag);
+
+/// Fills a retained path with the current fill style, see `cg_context_fill_with_options`.
+/// Its vertices are only re-tessellated when the scale of the transform, its mirroring or the feather change,
+/// and only re-uploaded when the transform, alpha or fill image size change.
+void cg_context_fill_retained_path(cg_retained_path_t * const path, const cg_path_options_e options);
+
+/// Strokes a retained path with the current stroke style and line width, see `cg_context_stroke_with_options`.
+/// Same caching as `cg_context_fill_retained_path`, the line width is also part of the tessellation.
+void cg_context_stroke_retained_path(cg_retained_path_t * const path, const cg_path_options_e options);
+
+/* ------------------------------------------------------------------------- */
+
 /// Applies a rotation to the current canvas state
 /// Positive rotations are counter clock wise.
 /// Subsequent draws will be rotated by the current total amount of rotation.
@@ -671,6 +715,10 @@ FFI_EXPORT void cg_context_image_set_repeat(FFI_PTR_NATIVE cg_image_t * const im
 /// A running animation will continue to run.
 FFI_EXPORT void cg_context_set_image_animation_state(FFI_PTR_NATIVE cg_image_t * const image, const cg_image_animation_state_e image_animation_state);
 
+/// Sets the thread pool lane the image is decoded on, e.g. drop images that scrolled off screen to low priority.
+/// Takes effect on a decode that is still queued, or on the decode of an image that is still being fetched.
+void cg_context_image_set_load_priority(cg_image_t * const image, const thread_pool_priority_e priority);
+
 /* ===========================================================================
  * PATTERN
  * ==========================================================================*/
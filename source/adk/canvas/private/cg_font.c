@@ -57,15 +57,65 @@ static bool compare_less_int32_t(const int32_t a, const int32_t b) {
 
 enum {
     default_font_glyph_index_size = 512,
-    max_unique_glyphs_per_stb_raster_pass = 16
+    // empty border kept around every glyph so linear filtering never samples a neighbour.
+    font_atlas_glyph_padding = 1,
 };
 
+enum {
+    // codepoints below this get a dense glyph index/advance table (basic latin through latin extended-b).
+    font_metrics_dense_codepoints = 0x250,
+    // every kerning pair between these codepoints is computed at load, other pairs are memoized on first use.
+    font_metrics_precomputed_kern_first = 0x20,
+    font_metrics_precomputed_kern_last = 0x7e,
+    font_metrics_codepoint_table_size = 1024,
+    font_metrics_min_kern_table_size = 4096,
+    font_metrics_empty_kern_pair = 0xffffffff,
+};
+
+typedef struct font_metrics_glyph_t {
+    int32_t glyph_index;
+    // unscaled, multiply by the font context's scale
+    int32_t advance;
+} font_metrics_glyph_t;
+
+typedef struct font_metrics_codepoint_entry_t {
+    int32_t codepoint; // -1 when the slot is empty
+    font_metrics_glyph_t glyph;
+} font_metrics_codepoint_entry_t;
+
+typedef struct font_metrics_kern_entry_t {
+    uint32_t glyph_pair; // (left << 16) | right, `font_metrics_empty_kern_pair` when the slot is empty
+    int32_t kern_advance;
+} font_metrics_kern_entry_t;
+
+// size independent layout tables built once per font file, so measuring and laying out text never searches the font's cmap/kern/GPOS tables.
+typedef struct font_metrics_t {
+    font_metrics_glyph_t dense[font_metrics_dense_codepoints];
+
+    // open addressed, memoizes codepoints outside the dense range
+    font_metrics_codepoint_entry_t * codepoints;
+    uint32_t codepoints_mask;
+    uint32_t num_codepoints;
+
+    // open addressed pair kerning
+    font_metrics_kern_entry_t * kern_pairs;
+    uint32_t kern_pairs_mask;
+    uint32_t num_kern_pairs;
+
+    // bit per glyph whose kerning pairs with every other such glyph are already in `kern_pairs`,
+    // so a missing pair between two of them is known to be zero.
+    uint32_t * kern_complete_glyphs;
+    bool kern_complete;
+    bool has_kerning;
+} font_metrics_t;
+
 struct cg_font_file_t {
     cg_context_t * cg_ctx;
 
     struct font_async_load_user_t * load_user;
     cg_const_allocation_t font_bytes;
     stbtt_fontinfo font_info;
+    font_metrics_t metrics;
     int32_t font_ascent;
 
     cg_font_async_load_status_e async_load_status;
@@ -76,6 +126,240 @@ struct cg_font_file_t {
 /* ------------------------------------------------------------------------- */
 /* ------------------------------------------------------------------------- */
 
+static uint32_t font_metrics_hash(uint32_t key) {
+    key ^= key >> 16;
+    key *= 0x7feb352d;
+    key ^= key >> 15;
+    key *= 0x846ca68b;
+    key ^= key >> 16;
+    return key;
+}
+
+static uint32_t font_metrics_table_size(const uint32_t min_entries) {
+    uint32_t size = 16;
+    while (size < min_entries) {
+        size <<= 1;
+    }
+    return size;
+}
+
+static bool font_metrics_kern_table_has_room(const font_metrics_t * const metrics) {
+    // keep the load factor under 3/4 so probes stay short
+    return (metrics->num_kern_pairs + 1) * 4 <= (metrics->kern_pairs_mask + 1) * 3;
+}
+
+static void font_metrics_insert_kern_pair(font_metrics_t * const metrics, const uint32_t glyph_pair, const int32_t kern_advance) {
+    for (uint32_t slot = font_metrics_hash(glyph_pair) & metrics->kern_pairs_mask;; slot = (slot + 1) & metrics->kern_pairs_mask) {
+        font_metrics_kern_entry_t * const entry = &metrics->kern_pairs[slot];
+        if (entry->glyph_pair == font_metrics_empty_kern_pair) {
+            *entry = (font_metrics_kern_entry_t){.glyph_pair = glyph_pair, .kern_advance = kern_advance};
+            ++metrics->num_kern_pairs;
+            return;
+        } else if (entry->glyph_pair == glyph_pair) {
+            entry->kern_advance = kern_advance;
+            return;
+        }
+    }
+}
+
+static bool font_metrics_is_kern_complete_glyph(const font_metrics_t * const metrics, const int32_t glyph_index) {
+    return metrics->kern_complete || (metrics->kern_complete_glyphs && (metrics->kern_complete_glyphs[glyph_index >> 5] & (1u << (glyph_index & 31))));
+}
+
+// mirrors stb_truetype's lookup: the first subtable of the 'kern' table, if it's horizontal format 0.
+static uint32_t font_metrics_count_kern_table_pairs(const stbtt_fontinfo * const font_info) {
+    stbtt_uint8 * const data = font_info->data + font_info->kern;
+    if (!font_info->kern || (ttUSHORT(data + 2) < 1) || (ttUSHORT(data + 8) != 1)) {
+        return 0;
+    }
+    return ttUSHORT(data + 10);
+}
+
+// the tables only save lookups, when one can't be allocated the font goes without it
+static void * font_metrics_alloc(cg_heap_t * const cg_heap, const size_t size) {
+    return cg_unchecked_alloc(cg_heap, size, MALLOC_TAG).region.ptr;
+}
+
+// `kern_table_size` is the number of kerning table slots (a power of two), `cg_font_kern_table_size_from_font`
+// sizes it for the font's pairs and `cg_font_no_kern_table` leaves every pair to stb.
+static void font_metrics_build(font_metrics_t * const metrics, stbtt_fontinfo * const font_info, cg_heap_t * const cg_heap, const int32_t kern_table_size) {
+    CG_FONT_TRACE_PUSH_FN();
+    ZEROMEM(metrics);
+
+    for (int32_t codepoint = 0; codepoint < font_metrics_dense_codepoints; ++codepoint) {
+        font_metrics_glyph_t * const glyph = &metrics->dense[codepoint];
+        int32_t left_side_bearing;
+        glyph->glyph_index = stbtt_FindGlyphIndex(font_info, codepoint);
+        stbtt_GetGlyphHMetrics(font_info, glyph->glyph_index, &glyph->advance, &left_side_bearing);
+    }
+
+    metrics->codepoints = font_metrics_alloc(cg_heap, sizeof(*metrics->codepoints) * font_metrics_codepoint_table_size);
+    if (metrics->codepoints) {
+        metrics->codepoints_mask = font_metrics_codepoint_table_size - 1;
+        for (uint32_t slot = 0; slot < font_metrics_codepoint_table_size; ++slot) {
+            metrics->codepoints[slot].codepoint = -1;
+        }
+    }
+
+    metrics->has_kerning = font_info->kern || font_info->gpos;
+    if (!metrics->has_kerning || (kern_table_size == cg_font_no_kern_table)) {
+        CG_FONT_TRACE_POP();
+        return;
+    }
+
+    // stb only consults 'kern' when there is no 'GPOS', in which case every pair stb could report is in the table itself.
+    const uint32_t num_kern_table_pairs = font_info->gpos ? 0 : font_metrics_count_kern_table_pairs(font_info);
+    const uint32_t num_precomputed_codepoints = font_metrics_precomputed_kern_last - font_metrics_precomputed_kern_first + 1;
+    const uint32_t num_kern_slots = (kern_table_size != cg_font_kern_table_size_from_font) ? (uint32_t)kern_table_size : font_metrics_table_size(max_uint32_t(font_metrics_min_kern_table_size, font_info->gpos ? (num_precomputed_codepoints * num_precomputed_codepoints / 4) : (num_kern_table_pairs * 2)));
+    ASSERT(num_kern_slots && !(num_kern_slots & (num_kern_slots - 1)));
+    metrics->kern_pairs = font_metrics_alloc(cg_heap, sizeof(*metrics->kern_pairs) * num_kern_slots);
+    if (!metrics->kern_pairs) {
+        CG_FONT_TRACE_POP();
+        return;
+    }
+    metrics->kern_pairs_mask = num_kern_slots - 1;
+    for (uint32_t slot = 0; slot < num_kern_slots; ++slot) {
+        metrics->kern_pairs[slot].glyph_pair = font_metrics_empty_kern_pair;
+    }
+
+    if (!font_info->gpos) {
+        stbtt_uint8 * const pairs = font_info->data + font_info->kern + 18;
+        bool all_inserted = true;
+        for (uint32_t pair_ind = 0; pair_ind < num_kern_table_pairs; ++pair_ind) {
+            const int32_t kern_advance = ttSHORT(pairs + pair_ind * 6 + 4);
+            if (kern_advance == 0) {
+                continue;
+            } else if (!font_metrics_kern_table_has_room(metrics)) {
+                all_inserted = false;
+                break;
+            }
+            font_metrics_insert_kern_pair(metrics, ((uint32_t)ttUSHORT(pairs + pair_ind * 6) << 16) | ttUSHORT(pairs + pair_ind * 6 + 2), kern_advance);
+        }
+        // a pair missing from a partial table may still kern, those are searched for in the font
+        metrics->kern_complete = all_inserted;
+        CG_FONT_TRACE_POP();
+        return;
+    }
+
+    // GPOS can't be enumerated cheaply, resolve the printable ascii pairs up front and memoize the rest as they're seen.
+    const size_t kern_complete_glyphs_size = sizeof(uint32_t) * ((font_info->numGlyphs + 31) / 32);
+    metrics->kern_complete_glyphs = font_metrics_alloc(cg_heap, kern_complete_glyphs_size);
+    if (!metrics->kern_complete_glyphs) {
+        CG_FONT_TRACE_POP();
+        return;
+    }
+    memset(metrics->kern_complete_glyphs, 0, kern_complete_glyphs_size);
+
+    for (int32_t left = font_metrics_precomputed_kern_first; left <= font_metrics_precomputed_kern_last; ++left) {
+        const int32_t left_glyph = metrics->dense[left].glyph_index;
+        bool all_inserted = true;
+        for (int32_t right = font_metrics_precomputed_kern_first; right <= font_metrics_precomputed_kern_last; ++right) {
+            const int32_t right_glyph = metrics->dense[right].glyph_index;
+            const int32_t kern_advance = stbtt_GetGlyphKernAdvance(font_info, left_glyph, right_glyph);
+            if (kern_advance == 0) {
+                continue;
+            } else if (!font_metrics_kern_table_has_room(metrics)) {
+                all_inserted = false;
+                break;
+            }
+            font_metrics_insert_kern_pair(metrics, ((uint32_t)left_glyph << 16) | (uint32_t)right_glyph, kern_advance);
+        }
+        // only a glyph with all of its pairs in the table can have a missing pair taken as zero
+        if (all_inserted) {
+            metrics->kern_complete_glyphs[left_glyph >> 5] |= 1u << (left_glyph & 31);
+        }
+    }
+    CG_FONT_TRACE_POP();
+}
+
+static void font_metrics_free(font_metrics_t * const metrics, cg_heap_t * const cg_heap) {
+    if (metrics->codepoints) {
+        cg_free(cg_heap, metrics->codepoints, MALLOC_TAG);
+    }
+    if (metrics->kern_pairs) {
+        cg_free(cg_heap, metrics->kern_pairs, MALLOC_TAG);
+    }
+    if (metrics->kern_complete_glyphs) {
+        cg_free(cg_heap, metrics->kern_complete_glyphs, MALLOC_TAG);
+    }
+    ZEROMEM(metrics);
+}
+
+static font_metrics_glyph_t font_metrics_get_glyph(font_metrics_t * const metrics, const stbtt_fontinfo * const font_info, const int32_t codepoint) {
+    if ((codepoint >= 0) && (codepoint < font_metrics_dense_codepoints)) {
+        return metrics->dense[codepoint];
+    }
+
+    uint32_t slot = font_metrics_hash((uint32_t)codepoint) & metrics->codepoints_mask;
+    for (; metrics->codepoints; slot = (slot + 1) & metrics->codepoints_mask) {
+        const font_metrics_codepoint_entry_t * const entry = &metrics->codepoints[slot];
+        if (entry->codepoint == codepoint) {
+            return entry->glyph;
+        } else if (entry->codepoint == -1) {
+            break;
+        }
+    }
+
+    font_metrics_glyph_t glyph;
+    int32_t left_side_bearing;
+    glyph.glyph_index = stbtt_FindGlyphIndex(font_info, codepoint);
+    stbtt_GetGlyphHMetrics(font_info, glyph.glyph_index, &glyph.advance, &left_side_bearing);
+
+    // `slot` is the empty slot that ended the probe, once the table is 3/4 full further codepoints just aren't memoized.
+    if (metrics->codepoints && ((metrics->num_codepoints + 1) * 4 <= (metrics->codepoints_mask + 1) * 3)) {
+        metrics->codepoints[slot] = (font_metrics_codepoint_entry_t){.codepoint = codepoint, .glyph = glyph};
+        ++metrics->num_codepoints;
+    }
+    return glyph;
+}
+
+static int32_t font_metrics_get_kern_advance(font_metrics_t * const metrics, const stbtt_fontinfo * const font_info, const int32_t left_glyph, const int32_t right_glyph) {
+    if (!metrics->has_kerning || !left_glyph || !right_glyph) {
+        return 0;
+    }
+
+    if (!metrics->kern_pairs) {
+        return stbtt_GetGlyphKernAdvance(font_info, left_glyph, right_glyph);
+    }
+
+    const uint32_t glyph_pair = ((uint32_t)left_glyph << 16) | (uint32_t)right_glyph;
+    for (uint32_t slot = font_metrics_hash(glyph_pair) & metrics->kern_pairs_mask;; slot = (slot + 1) & metrics->kern_pairs_mask) {
+        const font_metrics_kern_entry_t * const entry = &metrics->kern_pairs[slot];
+        if (entry->glyph_pair == glyph_pair) {
+            return entry->kern_advance;
+        } else if (entry->glyph_pair == font_metrics_empty_kern_pair) {
+            break;
+        }
+    }
+
+    if (font_metrics_is_kern_complete_glyph(metrics, left_glyph) && font_metrics_is_kern_complete_glyph(metrics, right_glyph)) {
+        return 0;
+    }
+
+    // memoize the pair (zeros included) so it's only ever searched for once.
+    const int32_t kern_advance = stbtt_GetGlyphKernAdvance(font_info, left_glyph, right_glyph);
+    if (font_metrics_kern_table_has_room(metrics)) {
+        font_metrics_insert_kern_pair(metrics, glyph_pair, kern_advance);
+    }
+    return kern_advance;
+}
+
+void cg_font_file_rebuild_metrics(cg_font_file_t * const font, const int32_t kern_table_size) {
+    ASSERT_IS_MAIN_THREAD();
+    ASSERT(font->async_load_status == cg_font_async_load_complete);
+
+    font_metrics_free(&font->metrics, &font->cg_ctx->cg_heap_low);
+    font_metrics_build(&font->metrics, &font->font_info, &font->cg_ctx->cg_heap_low, kern_table_size);
+}
+
+int32_t cg_font_file_get_kern_advance(cg_font_file_t * const font, const int32_t left_codepoint, const int32_t right_codepoint) {
+    const int32_t left_glyph = font_metrics_get_glyph(&font->metrics, &font->font_info, left_codepoint).glyph_index;
+    const int32_t right_glyph = font_metrics_get_glyph(&font->metrics, &font->font_info, right_codepoint).glyph_index;
+    return font_metrics_get_kern_advance(&font->metrics, &font->font_info, left_glyph, right_glyph);
+}
+
+/* ------------------------------------------------------------------------- */
+
 static void cg_font_load_user_http_failure_cleanup(void * const void_user);
 
 void cg_context_font_file_free(cg_font_file_t * const font, const char * const tag) {
@@ -93,6 +377,7 @@ void cg_context_font_file_free(cg_font_file_t * const font, const char * const t
             if (font->font_bytes.region.ptr) {
                 cg_free_const_alloc(font->font_bytes, tag);
             }
+            font_metrics_free(&font->metrics, &font->cg_ctx->cg_heap_low);
             cg_free(&font->cg_ctx->cg_heap_low, font, tag);
         } else {
             font->async_load_status = cg_font_async_load_aborted;
@@ -344,12 +629,6 @@ typedef enum mosaic_raster_insert_status_e {
     mosaic_raster_insert_new = 1,
 } mosaic_raster_insert_status_e;
 
-// this will be our offset into the texture atlas, there is zero chance we're going to have a texture atlas larger than 32k
-typedef struct cg_int16_rect_t {
-    int16_t x, y;
-    int16_t width, height;
-} cg_int16_rect_t;
-
 typedef struct cg_uvec2_t {
     uint32_t x, y;
 } cg_uvec2_t;
@@ -359,6 +638,7 @@ typedef enum codepoint_raster_state_e {
     codepoint_packing_failed = -1,
     codepoint_uninit = 0,
     codepoint_rasterized = 1,
+    codepoint_evicted = 2, // was rasterized, but the atlas page holding it has since been reclaimed
 } codepoint_raster_state_e;
 
 typedef enum codepoint_rasterizing_e {
@@ -372,6 +652,8 @@ typedef struct codepoint_info_t {
     float y_off;
     float x_advance;
 
+    // atlas page holding the glyph's bitmap, -1 when the glyph has no bitmap (e.g. spaces)
+    int32_t page;
     codepoint_raster_state_e state;
 } codepoint_info_t;
 
@@ -388,19 +670,46 @@ typedef struct font_glyph_cache_t {
     uint32_t num_unrasterized;
 } font_glyph_cache_t;
 
-typedef struct mosaic_glyph_raster_t {
-    stbtt_pack_context pack_context;
+typedef struct font_atlas_skyline_node_t {
+    int16_t x;
+    int16_t y;
+    int16_t width;
+} font_atlas_skyline_node_t;
 
-    mosaic_context_t * mosaic_ctx;
+typedef struct font_atlas_page_t {
+    // bottom-left skyline of the page, sorted by x and always spanning the full page width.
+    font_atlas_skyline_node_t * skyline;
+    int32_t skyline_size;
 
-    font_glyph_cache_t * font_glyph_cache_head;
-    font_glyph_cache_t * font_glyph_cache_tail;
+    // number of glyphs of live fonts rasterized into this page.
+    int32_t num_glyphs;
+    // use stamp of the last draw that referenced a glyph on this page, the oldest page is evicted first.
+    uint32_t last_use;
 
-    bool atlas_dirty;
+    bool dirty;
     struct {
         cg_uvec2_t p00;
         cg_uvec2_t p11;
     } dirty_region;
+} font_atlas_page_t;
+
+typedef struct mosaic_glyph_raster_t {
+    mosaic_context_t * mosaic_ctx;
+
+    font_glyph_cache_t * font_glyph_cache_head;
+    font_glyph_cache_t * font_glyph_cache_tail;
+
+    font_atlas_page_t * pages;
+    font_atlas_skyline_node_t * skyline_nodes;
+    int32_t num_pages;
+    int32_t page_width;
+    int32_t page_height;
+
+    // bumped at the start of every text draw, pages stamped with the current value are referenced by unflushed verts and can't be evicted.
+    uint32_t use_stamp;
+    uint32_t num_page_evictions;
+
+    bool atlas_dirty;
 } mosaic_glyph_raster_t;
 
 static bool is_whitespace(const int32_t codepoint) {
@@ -424,30 +733,35 @@ static int32_t get_missing_glyph_codepoint(const mosaic_context_t * const mosaic
     return codepoint;
 }
 
+static void font_atlas_page_reset(const mosaic_glyph_raster_t * const glyph_raster, font_atlas_page_t * const page) {
+    page->skyline[0] = (font_atlas_skyline_node_t){.x = 0, .y = 0, .width = (int16_t)glyph_raster->page_width};
+    page->skyline_size = 1;
+    page->num_glyphs = 0;
+    page->last_use = 0;
+}
+
 static void mosaic_glyph_raster_emplace_init(mosaic_glyph_raster_t * const glyph_raster, mosaic_context_t * const mosaic_ctx) {
     CG_FONT_TRACE_PUSH_FN();
     ZEROMEM(glyph_raster);
 
     glyph_raster->mosaic_ctx = mosaic_ctx;
-    glyph_raster->dirty_region.p00 = (cg_uvec2_t){(uint32_t)-1, (uint32_t)-1};
-    glyph_raster->dirty_region.p11 = (cg_uvec2_t){0};
+    glyph_raster->num_pages = mosaic_ctx->atlas.num_pages;
+    glyph_raster->page_width = mosaic_ctx->atlas.image.image.width;
+    glyph_raster->page_height = mosaic_ctx->atlas.page_height;
+    glyph_raster->use_stamp = 1;
 
-#if defined(_VADER) || defined(_LEIA)
-    // make sure any pending operations are complete on the atlas before we call stbtt_PackBegin (it has an implicit memset to zero on the supplied pointer)
-    render_conditional_flush_cmd_stream_and_wait_fence(
-        mosaic_ctx->cg_ctx->gl->render_device,
-        &mosaic_ctx->cg_ctx->gl->render_device->default_cmd_stream,
-        mosaic_ctx->atlas.image_fence);
-#endif
+    // a skyline can't have more nodes than the page has columns.
+    const size_t max_skyline_nodes = (size_t)glyph_raster->page_width + 1;
+    cg_heap_t * const cg_heap = &mosaic_ctx->cg_ctx->cg_heap_low;
+    glyph_raster->pages = cg_alloc(cg_heap, sizeof(font_atlas_page_t) * glyph_raster->num_pages, MALLOC_TAG);
+    glyph_raster->skyline_nodes = cg_alloc(cg_heap, sizeof(font_atlas_skyline_node_t) * max_skyline_nodes * glyph_raster->num_pages, MALLOC_TAG);
 
-    stbtt_PackBegin(
-        &glyph_raster->pack_context,
-        mosaic_ctx->atlas.image.pixel_buffer.region.ptr,
-        mosaic_ctx->atlas.image.image.width,
-        mosaic_ctx->atlas.image.image.height,
-        0,
-        1,
-        glyph_raster->mosaic_ctx);
+    for (int32_t page_ind = 0; page_ind < glyph_raster->num_pages; ++page_ind) {
+        font_atlas_page_t * const page = &glyph_raster->pages[page_ind];
+        ZEROMEM(page);
+        page->skyline = glyph_raster->skyline_nodes + max_skyline_nodes * page_ind;
+        font_atlas_page_reset(glyph_raster, page);
+    }
     CG_FONT_TRACE_POP();
 }
 
@@ -455,6 +769,12 @@ static void font_glyph_cache_free(mosaic_glyph_raster_t * const glyph_raster, fo
     CG_FONT_TRACE_PUSH_FN();
     cg_heap_t * const cg_heap = &glyph_raster->mosaic_ctx->cg_ctx->cg_heap_low;
     LL_REMOVE(glyph_cache, prev, next, glyph_raster->font_glyph_cache_head, glyph_raster->font_glyph_cache_tail);
+    for (int32_t codepoint_ind = 0; codepoint_ind < glyph_cache->codepoints_size; ++codepoint_ind) {
+        const codepoint_info_t * const codepoint_info = &glyph_cache->codepoint_infos[codepoint_ind];
+        if ((codepoint_info->state == codepoint_rasterized) && (codepoint_info->page >= 0)) {
+            --glyph_raster->pages[codepoint_info->page].num_glyphs;
+        }
+    }
     if (glyph_cache->codepoints) {
         cg_free(cg_heap, glyph_cache->codepoints, MALLOC_TAG);
     }
@@ -473,7 +793,10 @@ static void mosaic_glyph_raster_shutdown(mosaic_glyph_raster_t * const glyph_ras
         font_glyph_cache_free(glyph_raster, curr_font_glyph_cache);
         curr_font_glyph_cache = next;
     }
-    stbtt_PackEnd(&glyph_raster->pack_context);
+
+    cg_heap_t * const cg_heap = &glyph_raster->mosaic_ctx->cg_ctx->cg_heap_low;
+    cg_free(cg_heap, glyph_raster->skyline_nodes, MALLOC_TAG);
+    cg_free(cg_heap, glyph_raster->pages, MALLOC_TAG);
     CG_FONT_TRACE_POP();
 }
 
@@ -571,9 +894,29 @@ static font_glyph_cache_t * mosaic_glyph_raster_create_glyph_cache(mosaic_glyph_
     return glyph_cache;
 }
 
+static void mosaic_glyph_raster_touch_page(mosaic_glyph_raster_t * const glyph_raster, const int32_t page) {
+    if (page >= 0) {
+        glyph_raster->pages[page].last_use = glyph_raster->use_stamp;
+    }
+}
+
+// starts a new draw: pages touched by previous draws become candidates for eviction.
+static void mosaic_glyph_raster_begin_use(mosaic_glyph_raster_t * const glyph_raster) {
+    ++glyph_raster->use_stamp;
+}
+
 static mosaic_raster_insert_status_e mosaic_glyph_raster_try_push_codepoint(mosaic_glyph_raster_t * const glyph_raster, const int32_t codepoint, font_glyph_cache_t * const glyph_cache) {
     CG_FONT_TRACE_PUSH_FN();
-    if (font_glyph_cache_find_codepoint_index(codepoint, glyph_cache) >= 0) {
+    const int32_t codepoint_ind = font_glyph_cache_find_codepoint_index(codepoint, glyph_cache);
+    if (codepoint_ind >= 0) {
+        codepoint_info_t * const codepoint_info = &glyph_cache->codepoint_infos[codepoint_ind];
+        if (codepoint_info->state == codepoint_rasterized) {
+            // keep the glyph's page alive for the remainder of this draw.
+            mosaic_glyph_raster_touch_page(glyph_raster, codepoint_info->page);
+        } else if ((codepoint_info->state == codepoint_evicted) || (codepoint_info->state == codepoint_packing_failed)) {
+            codepoint_info->state = codepoint_uninit;
+            ++glyph_cache->num_unrasterized;
+        }
         CG_FONT_TRACE_POP();
         return mosaic_raster_insert_exists;
     }
@@ -588,65 +931,260 @@ static mosaic_raster_insert_status_e mosaic_glyph_raster_try_push_codepoint(mosa
     return mosaic_raster_insert_new;
 }
 
-static codepoint_rasterizing_e mosaic_glyph_raster_rasterize_glyph_range(
-    mosaic_glyph_raster_t * const glyph_raster,
-    font_glyph_cache_t * const glyph_cache,
-    const int32_t * const codepoints,
-    int32_t * const glyph_offsets,
-    const int32_t * const codepoint_indices,
-    const int32_t num_new_codepoints) {
+// returns the y a `width` x `height` rect would land at if placed at skyline node `node_ind`, or -1 if it doesn't fit.
+static int32_t font_atlas_page_skyline_fit(const mosaic_glyph_raster_t * const glyph_raster, const font_atlas_page_t * const page, const int32_t node_ind, const int32_t width, const int32_t height) {
+    const int32_t x = page->skyline[node_ind].x;
+    if (x + width > glyph_raster->page_width) {
+        return -1;
+    }
+
+    int32_t y = 0;
+    int32_t width_left = width;
+    for (int32_t ind = node_ind; width_left > 0; ++ind) {
+        ASSERT(ind < page->skyline_size);
+        y = max_int32_t(y, page->skyline[ind].y);
+        if (y + height > glyph_raster->page_height) {
+            return -1;
+        }
+        width_left -= page->skyline[ind].width;
+    }
+    return y;
+}
+
+static bool font_atlas_page_alloc_rect(const mosaic_glyph_raster_t * const glyph_raster, font_atlas_page_t * const page, const int32_t width, const int32_t height, int32_t * const out_x, int32_t * const out_y) {
     CG_FONT_TRACE_PUSH_FN();
-    mosaic_font_data_t * const selected_font = &glyph_raster->mosaic_ctx->fonts[glyph_cache->font_id];
-    codepoint_rasterizing_e rasterizing_state = codepoint_rasterizing_renderable_rasterized;
-    lba_reset(&glyph_raster->mosaic_ctx->atlas_lba);
-    stbtt_packedchar glyph_packed_char_buff[max_unique_glyphs_per_stb_raster_pass];
-
-    stbtt_pack_range pack_range = {0};
-    pack_range.font_size = (float)selected_font->height;
-    pack_range.array_of_unicode_codepoints = codepoints;
-    pack_range.num_chars = num_new_codepoints;
-    pack_range.chardata_for_range = glyph_packed_char_buff;
-    pack_range.out_array_of_glyph_offsets = glyph_offsets;
-    stbtt_PackFontRanges(&glyph_raster->pack_context, &selected_font->cg_font->font_info, 0, &pack_range, 1);
-
-    for (int ind = 0; ind < num_new_codepoints; ++ind) {
-        const stbtt_packedchar * const packed_char = &pack_range.chardata_for_range[ind];
-        codepoint_info_t * const curr_codepoint_info = &glyph_cache->codepoint_infos[codepoint_indices[ind]];
-
-        curr_codepoint_info->tex_coords = (cg_int16_rect_t){
-            .x = (int16_t)packed_char->x0,
-            .y = (int16_t)packed_char->y0,
-            .width = (int16_t)(packed_char->x1 - packed_char->x0),
-            .height = (int16_t)(packed_char->y1 - packed_char->y0)};
-
-        curr_codepoint_info->x_advance = packed_char->xadvance;
-        curr_codepoint_info->x_off = packed_char->xoff;
-        curr_codepoint_info->y_off = packed_char->yoff;
-
-        if ((glyph_offsets[ind] == 0) && !is_control_character(codepoints[ind])) {
-            curr_codepoint_info->state = codepoint_no_backing_glyph;
+    // bottom-left heuristic: lowest resulting top edge wins, ties go to the narrowest node.
+    int32_t best_ind = -1;
+    int32_t best_bottom = INT32_MAX;
+    int32_t best_width = INT32_MAX;
+    int32_t best_y = 0;
+    for (int32_t ind = 0; ind < page->skyline_size; ++ind) {
+        const int32_t y = font_atlas_page_skyline_fit(glyph_raster, page, ind, width, height);
+        if ((y >= 0) && ((y + height < best_bottom) || ((y + height == best_bottom) && (page->skyline[ind].width < best_width)))) {
+            best_ind = ind;
+            best_bottom = y + height;
+            best_width = page->skyline[ind].width;
+            best_y = y;
+        }
+    }
+
+    if (best_ind < 0) {
+        CG_FONT_TRACE_POP();
+        return false;
+    }
+
+    *out_x = page->skyline[best_ind].x;
+    *out_y = best_y;
+
+    // raise the skyline over the new rect
+    VERIFY(page->skyline_size < glyph_raster->page_width + 1);
+    memmove(&page->skyline[best_ind + 1], &page->skyline[best_ind], (page->skyline_size - best_ind) * sizeof(*page->skyline));
+    page->skyline[best_ind] = (font_atlas_skyline_node_t){.x = (int16_t)*out_x, .y = (int16_t)(best_y + height), .width = (int16_t)width};
+    ++page->skyline_size;
+
+    // trim (or drop) the nodes now covered by it
+    for (int32_t ind = best_ind + 1; ind < page->skyline_size;) {
+        const font_atlas_skyline_node_t * const prev = &page->skyline[ind - 1];
+        font_atlas_skyline_node_t * const curr = &page->skyline[ind];
+        const int32_t overlap = prev->x + prev->width - curr->x;
+        if (overlap <= 0) {
+            break;
+        }
+        if (curr->width > overlap) {
+            curr->x = (int16_t)(curr->x + overlap);
+            curr->width = (int16_t)(curr->width - overlap);
+            break;
+        }
+        memmove(curr, curr + 1, (page->skyline_size - ind - 1) * sizeof(*page->skyline));
+        --page->skyline_size;
+    }
+
+    // merge neighbours at the same height
+    for (int32_t ind = 0; ind + 1 < page->skyline_size;) {
+        font_atlas_skyline_node_t * const curr = &page->skyline[ind];
+        if (curr->y == curr[1].y) {
+            curr->width = (int16_t)(curr->width + curr[1].width);
+            memmove(curr + 1, curr + 2, (page->skyline_size - ind - 2) * sizeof(*page->skyline));
+            --page->skyline_size;
         } else {
-            // stb indicates that a glyph is missing from the atlas (or otherwise unrenderable) by having its rect's dimensions = 0.
-            // note: this is different than a width or height of zero, which apparently spaces can have? they only take up a 1x1 region (their rect dims are 1,1,1,1) so we get a width & height of zero.
-            // but the xadvance is a valid value for advancing.
-            const bool is_in_atlas = (packed_char->x0 != 0) || (packed_char->x1 != 0) || (packed_char->y0 != 0) || (packed_char->y1 != 0);
-            curr_codepoint_info->state = is_in_atlas ? codepoint_rasterized : codepoint_packing_failed;
-            if (is_in_atlas) {
-                int padding = glyph_raster->pack_context.padding;
-                glyph_raster->dirty_region.p00.x = min_uint32_t(glyph_raster->dirty_region.p00.x, (uint32_t)max_int32_t(packed_char->x0 - padding, 0));
-                glyph_raster->dirty_region.p00.y = min_uint32_t(glyph_raster->dirty_region.p00.y, (uint32_t)max_int32_t(packed_char->y0 - padding, 0));
-
-                glyph_raster->dirty_region.p11.x = glyph_raster->dirty_region.p11.x == (uint32_t)-1 ? (uint32_t)packed_char->x1 : max_uint32_t(glyph_raster->dirty_region.p11.x, (uint32_t)packed_char->x1 + padding);
-                glyph_raster->dirty_region.p11.y = glyph_raster->dirty_region.p11.y == (uint32_t)-1 ? (uint32_t)packed_char->y1 : max_uint32_t(glyph_raster->dirty_region.p11.y, (uint32_t)packed_char->y1 + padding);
-
-                glyph_raster->atlas_dirty = true;
-            } else {
-                rasterizing_state = codepoint_rasterizing_partial_failure;
+            ++ind;
+        }
+    }
+    CG_FONT_TRACE_POP();
+    return true;
+}
+
+static void text_mesh_cache_evict_atlas_page_nodes(text_mesh_cache_t * const cache, const uint32_t atlas_page_mask, const char * const tag);
+
+static void mosaic_glyph_raster_evict_page(mosaic_glyph_raster_t * const glyph_raster, const int32_t page_ind) {
+    CG_FONT_TRACE_PUSH_FN();
+    mosaic_context_t * const mosaic_ctx = glyph_raster->mosaic_ctx;
+
+#if defined(_VADER) || defined(_LEIA)
+    // the page is about to be overwritten in place, make sure the gpu is done with the last upload of the atlas.
+    render_conditional_flush_cmd_stream_and_wait_fence(
+        mosaic_ctx->cg_ctx->gl->render_device,
+        &mosaic_ctx->cg_ctx->gl->render_device->default_cmd_stream,
+        mosaic_ctx->atlas.image_fence);
+#endif
+
+    for (font_glyph_cache_t * glyph_cache = glyph_raster->font_glyph_cache_head; glyph_cache != NULL; glyph_cache = glyph_cache->next) {
+        for (int32_t codepoint_ind = 0; codepoint_ind < glyph_cache->codepoints_size; ++codepoint_ind) {
+            codepoint_info_t * const codepoint_info = &glyph_cache->codepoint_infos[codepoint_ind];
+            if ((codepoint_info->state == codepoint_rasterized) && (codepoint_info->page == page_ind)) {
+                codepoint_info->state = codepoint_evicted;
+                codepoint_info->page = -1;
             }
         }
     }
+
+    // only the cached meshes sampling this page are stale, everything else stays resident.
+    text_mesh_cache_evict_atlas_page_nodes(&mosaic_ctx->text_mesh_cache, 1u << page_ind, MALLOC_TAG);
+    font_atlas_page_reset(glyph_raster, &glyph_raster->pages[page_ind]);
+    ++glyph_raster->num_page_evictions;
+
+    LOG_DEBUG(TAG_CG_FONT, "Evicted font atlas page [%i]", page_ind);
+    CG_FONT_TRACE_POP();
+}
+
+static void mosaic_glyph_raster_evict_all_pages(mosaic_glyph_raster_t * const glyph_raster) {
+    for (int32_t page_ind = 0; page_ind < glyph_raster->num_pages; ++page_ind) {
+        mosaic_glyph_raster_evict_page(glyph_raster, page_ind);
+    }
+}
+
+// picks the page to reclaim: pages whose glyphs all belonged to freed fonts first, then the least recently used.
+// pages touched by the current draw are never picked since unflushed verts may still reference them.
+static int32_t mosaic_glyph_raster_find_evictable_page(const mosaic_glyph_raster_t * const glyph_raster) {
+    int32_t victim_ind = -1;
+    for (int32_t page_ind = 0; page_ind < glyph_raster->num_pages; ++page_ind) {
+        const font_atlas_page_t * const page = &glyph_raster->pages[page_ind];
+        if (page->last_use == glyph_raster->use_stamp) {
+            continue;
+        }
+        if (victim_ind < 0) {
+            victim_ind = page_ind;
+            continue;
+        }
+        const font_atlas_page_t * const victim = &glyph_raster->pages[victim_ind];
+        const bool page_is_orphaned = page->num_glyphs == 0;
+        const bool victim_is_orphaned = victim->num_glyphs == 0;
+        if ((page_is_orphaned && !victim_is_orphaned) || ((page_is_orphaned == victim_is_orphaned) && (page->last_use < victim->last_use))) {
+            victim_ind = page_ind;
+        }
+    }
+    return victim_ind;
+}
+
+static bool mosaic_glyph_raster_alloc_glyph_rect(mosaic_glyph_raster_t * const glyph_raster, const int32_t width, const int32_t height, int32_t * const out_page_ind, int32_t * const out_x, int32_t * const out_y) {
+    CG_FONT_TRACE_PUSH_FN();
+    for (int32_t page_ind = 0; page_ind < glyph_raster->num_pages; ++page_ind) {
+        if (font_atlas_page_alloc_rect(glyph_raster, &glyph_raster->pages[page_ind], width, height, out_x, out_y)) {
+            *out_page_ind = page_ind;
+            CG_FONT_TRACE_POP();
+            return true;
+        }
+    }
+
+    // every page is full, reclaim one. if the glyph doesn't fit an empty page either it's simply too large for the atlas.
+    const int32_t victim_ind = mosaic_glyph_raster_find_evictable_page(glyph_raster);
+    if (victim_ind < 0) {
+        CG_FONT_TRACE_POP();
+        return false;
+    }
+    mosaic_glyph_raster_evict_page(glyph_raster, victim_ind);
+    *out_page_ind = victim_ind;
+    const bool allocated = font_atlas_page_alloc_rect(glyph_raster, &glyph_raster->pages[victim_ind], width, height, out_x, out_y);
+    CG_FONT_TRACE_POP();
+    return allocated;
+}
+
+static void font_atlas_page_mark_dirty(mosaic_glyph_raster_t * const glyph_raster, font_atlas_page_t * const page, const cg_uvec2_t p00, const cg_uvec2_t p11) {
+    if (page->dirty) {
+        page->dirty_region.p00.x = min_uint32_t(page->dirty_region.p00.x, p00.x);
+        page->dirty_region.p00.y = min_uint32_t(page->dirty_region.p00.y, p00.y);
+        page->dirty_region.p11.x = max_uint32_t(page->dirty_region.p11.x, p11.x);
+        page->dirty_region.p11.y = max_uint32_t(page->dirty_region.p11.y, p11.y);
+    } else {
+        page->dirty_region.p00 = p00;
+        page->dirty_region.p11 = p11;
+        page->dirty = true;
+    }
+    glyph_raster->atlas_dirty = true;
+}
+
+static void mosaic_glyph_raster_rasterize_glyph(mosaic_glyph_raster_t * const glyph_raster, const mosaic_font_data_t * const selected_font, const int32_t codepoint, codepoint_info_t * const codepoint_info) {
+    CG_FONT_TRACE_PUSH_FN();
+    mosaic_context_t * const mosaic_ctx = glyph_raster->mosaic_ctx;
+    stbtt_fontinfo * const font_info = &selected_font->cg_font->font_info;
+    const int32_t glyph_index = stbtt_FindGlyphIndex(font_info, codepoint);
+
+    codepoint_info->page = -1;
+    codepoint_info->tex_coords = (cg_int16_rect_t){0};
+
+    if ((glyph_index == 0) && !is_control_character(codepoint)) {
+        codepoint_info->state = codepoint_no_backing_glyph;
+        CG_FONT_TRACE_POP();
+        return;
+    }
+
+    const float scale = selected_font->scale;
+    int32_t advance, left_side_bearing;
+    stbtt_GetGlyphHMetrics(font_info, glyph_index, &advance, &left_side_bearing);
+    int32_t x0, y0, x1, y1;
+    stbtt_GetGlyphBitmapBox(font_info, glyph_index, scale, scale, &x0, &y0, &x1, &y1);
+
+    codepoint_info->x_advance = scale * advance;
+    codepoint_info->x_off = (float)x0;
+    codepoint_info->y_off = (float)y0;
+
+    const int32_t width = x1 - x0;
+    const int32_t height = y1 - y0;
+    if ((width <= 0) || (height <= 0)) {
+        // nothing to draw (e.g. spaces), only the advance is meaningful.
+        codepoint_info->state = codepoint_rasterized;
+        CG_FONT_TRACE_POP();
+        return;
+    }
+
+    int32_t page_ind, x, y;
+    if (!mosaic_glyph_raster_alloc_glyph_rect(glyph_raster, width + font_atlas_glyph_padding * 2, height + font_atlas_glyph_padding * 2, &page_ind, &x, &y)) {
+        codepoint_info->state = codepoint_packing_failed;
+        CG_FONT_TRACE_POP();
+        return;
+    }
+
+    font_atlas_page_t * const page = &glyph_raster->pages[page_ind];
+    const int32_t atlas_x = x;
+    const int32_t atlas_y = page_ind * glyph_raster->page_height + y;
+    const int32_t stride = mosaic_ctx->atlas.image.image.pitch;
+    uint8_t * const pixels = mosaic_ctx->atlas.image.pixel_buffer.region.byte_ptr;
+
+    // the rect may hold a previously evicted glyph, clear it (including the padding border) before rasterizing.
+    for (int32_t row = 0; row < height + font_atlas_glyph_padding * 2; ++row) {
+        memset(pixels + (atlas_y + row) * stride + atlas_x, 0, width + font_atlas_glyph_padding * 2);
+    }
+
+    lba_reset(&mosaic_ctx->atlas_lba);
+    font_info->userdata = mosaic_ctx;
+    stbtt_MakeGlyphBitmap(font_info, pixels + (atlas_y + font_atlas_glyph_padding) * stride + atlas_x + font_atlas_glyph_padding, width, height, stride, scale, scale, glyph_index);
+
+    codepoint_info->tex_coords = (cg_int16_rect_t){
+        .x = (int16_t)(atlas_x + font_atlas_glyph_padding),
+        .y = (int16_t)(atlas_y + font_atlas_glyph_padding),
+        .width = (int16_t)width,
+        .height = (int16_t)height};
+    codepoint_info->page = page_ind;
+    codepoint_info->state = codepoint_rasterized;
+
+    ++page->num_glyphs;
+    mosaic_glyph_raster_touch_page(glyph_raster, page_ind);
+    font_atlas_page_mark_dirty(
+        glyph_raster,
+        page,
+        (cg_uvec2_t){(uint32_t)atlas_x, (uint32_t)atlas_y},
+        (cg_uvec2_t){(uint32_t)(atlas_x + width + font_atlas_glyph_padding * 2), (uint32_t)(atlas_y + height + font_atlas_glyph_padding * 2)});
     CG_FONT_TRACE_POP();
-    return rasterizing_state;
 }
 
 static codepoint_rasterizing_e mosaic_glyph_raster_rasterize_glyphs(mosaic_glyph_raster_t * const glyph_raster, font_glyph_cache_t * const glyph_cache, const int32_t first_codepoint_of_string) {
@@ -656,28 +1194,26 @@ static codepoint_rasterizing_e mosaic_glyph_raster_rasterize_glyphs(mosaic_glyph
         return codepoint_rasterizing_renderable_rasterized;
     }
 
-    // always pack the first glyph, since stb can fail anywhere in our range of provided glyphs (this will ensure we can make progress with this current variant)
-    // if we support effectively 'masking' what glyphs can be drawn from the string, and only drawing those, we don't necessarily need to rasterize the first glyph, we can just draw all of them.
+    const mosaic_font_data_t * const selected_font = &glyph_raster->mosaic_ctx->fonts[glyph_cache->font_id];
+    codepoint_rasterizing_e rasterizing_state = codepoint_rasterizing_renderable_rasterized;
+
+    // always place the first glyph of the string first, so a string that overflows the atlas still makes progress with this current variant.
     const int32_t first_codepoint_of_string_ind = font_glyph_cache_find_codepoint_index(first_codepoint_of_string, glyph_cache);
-    const int32_t first_codepoint = glyph_cache->codepoints[first_codepoint_of_string_ind];
-    int32_t first_codepoint_glyph_offset;
-    codepoint_rasterizing_e rasterizing_state = mosaic_glyph_raster_rasterize_glyph_range(glyph_raster, glyph_cache, &first_codepoint, &first_codepoint_glyph_offset, &first_codepoint_of_string_ind, 1);
-
-    int32_t uninit_codepoint_indices_buffer[max_unique_glyphs_per_stb_raster_pass];
-    int32_t codepoint_buffer[max_unique_glyphs_per_stb_raster_pass];
-    int32_t glyph_offset_buffer[max_unique_glyphs_per_stb_raster_pass];
-    int32_t codepoint_ind = 0;
-    while (codepoint_ind < glyph_cache->codepoints_size) {
-        int32_t codepoint_buffer_ind = 0;
-        for (; (codepoint_ind < glyph_cache->codepoints_size) && (codepoint_buffer_ind < ARRAY_SIZE(uninit_codepoint_indices_buffer)); ++codepoint_ind) {
-            if (glyph_cache->codepoint_infos[codepoint_ind].state == codepoint_uninit) {
-                codepoint_buffer[codepoint_buffer_ind] = glyph_cache->codepoints[codepoint_ind];
-                uninit_codepoint_indices_buffer[codepoint_buffer_ind++] = codepoint_ind;
-            }
+    if ((first_codepoint_of_string_ind >= 0) && (glyph_cache->codepoint_infos[first_codepoint_of_string_ind].state == codepoint_uninit)) {
+        codepoint_info_t * const codepoint_info = &glyph_cache->codepoint_infos[first_codepoint_of_string_ind];
+        mosaic_glyph_raster_rasterize_glyph(glyph_raster, selected_font, first_codepoint_of_string, codepoint_info);
+        if (codepoint_info->state == codepoint_packing_failed) {
+            rasterizing_state = codepoint_rasterizing_partial_failure;
         }
+    }
 
-        if (codepoint_buffer_ind > 0) {
-            rasterizing_state = mosaic_glyph_raster_rasterize_glyph_range(glyph_raster, glyph_cache, codepoint_buffer, glyph_offset_buffer, uninit_codepoint_indices_buffer, codepoint_buffer_ind) == codepoint_rasterizing_partial_failure ? codepoint_rasterizing_partial_failure : rasterizing_state;
+    for (int32_t codepoint_ind = 0; codepoint_ind < glyph_cache->codepoints_size; ++codepoint_ind) {
+        codepoint_info_t * const codepoint_info = &glyph_cache->codepoint_infos[codepoint_ind];
+        if (codepoint_info->state == codepoint_uninit) {
+            mosaic_glyph_raster_rasterize_glyph(glyph_raster, selected_font, glyph_cache->codepoints[codepoint_ind], codepoint_info);
+            if (codepoint_info->state == codepoint_packing_failed) {
+                rasterizing_state = codepoint_rasterizing_partial_failure;
+            }
         }
     }
 
@@ -789,24 +1325,32 @@ static void mosaic_glyph_raster_flush_atlas(mosaic_glyph_raster_t * const glyph_
 
         cg_image_t * const atlas_image = &glyph_raster->mosaic_ctx->atlas.image;
 #if !(defined(_VADER) || defined(_LEIA))
-        image_t image = atlas_image->image;
-        image = atlas_image->image;
-        image.width = glyph_raster->dirty_region.p11.x - glyph_raster->dirty_region.p00.x;
-        image.height = glyph_raster->dirty_region.p11.y - glyph_raster->dirty_region.p00.y;
-        image.x = glyph_raster->dirty_region.p00.x;
-        image.y = glyph_raster->dirty_region.p00.y;
+        // upload each page's dirty rect separately, so the staging buffer never needs to hold more than a page.
+        for (int32_t page_ind = 0; page_ind < glyph_raster->num_pages; ++page_ind) {
+            font_atlas_page_t * const page = &glyph_raster->pages[page_ind];
+            if (!page->dirty) {
+                continue;
+            }
+            page->dirty = false;
 
-        font_atlas_upload_region_t * const upload_region = mosaic_glyph_raster_alloc_sub_texture_region(glyph_raster, image.width * image.height * 1);
-        image.data = upload_region->region.ptr;
+            image_t image = atlas_image->image;
+            image.width = page->dirty_region.p11.x - page->dirty_region.p00.x;
+            image.height = page->dirty_region.p11.y - page->dirty_region.p00.y;
+            image.x = page->dirty_region.p00.x;
+            image.y = page->dirty_region.p00.y;
 
-        image_mips_t image_mips = {0};
-        image_mips.num_levels = 1;
-        image_mips.levels[0] = image;
+            font_atlas_upload_region_t * const upload_region = mosaic_glyph_raster_alloc_sub_texture_region(glyph_raster, image.width * image.height * 1);
+            image.data = upload_region->region.ptr;
 
-        mosaic_glyph_raster_copy_sub_image(&atlas_image->image, &image);
-        cg_gl_sub_texture_update(glyph_raster->mosaic_ctx->cg_ctx->gl, &atlas_image->cg_texture, image_mips);
+            image_mips_t image_mips = {0};
+            image_mips.num_levels = 1;
+            image_mips.levels[0] = image;
 
-        upload_region->fence = render_flush_cmd_stream(&glyph_raster->mosaic_ctx->cg_ctx->gl->render_device->default_cmd_stream, render_no_wait);
+            mosaic_glyph_raster_copy_sub_image(&atlas_image->image, &image);
+            cg_gl_sub_texture_update(glyph_raster->mosaic_ctx->cg_ctx->gl, &atlas_image->cg_texture, image_mips);
+
+            upload_region->fence = render_flush_cmd_stream(&glyph_raster->mosaic_ctx->cg_ctx->gl->render_device->default_cmd_stream, render_no_wait);
+        }
 #else
         render_conditional_flush_cmd_stream_and_wait_fence(
             glyph_raster->mosaic_ctx->cg_ctx->gl->render_device,
@@ -817,9 +1361,10 @@ static void mosaic_glyph_raster_flush_atlas(mosaic_glyph_raster_t * const glyph_
 
         glyph_raster->mosaic_ctx->atlas.image_fence = render_flush_cmd_stream(&glyph_raster->mosaic_ctx->cg_ctx->gl->render_device->default_cmd_stream, render_no_wait);
 
+        for (int32_t page_ind = 0; page_ind < glyph_raster->num_pages; ++page_ind) {
+            glyph_raster->pages[page_ind].dirty = false;
+        }
 #endif
-        glyph_raster->dirty_region.p00 = (cg_uvec2_t){(uint32_t)-1, (uint32_t)-1};
-        glyph_raster->dirty_region.p11 = (cg_uvec2_t){0};
     }
     CG_FONT_TRACE_POP();
 }
@@ -860,24 +1405,13 @@ static codepoint_rasterizing_e mosaic_glyph_raster_try_rasterize_glyphs(mosaic_c
     return rasterize_state;
 }
 
-typedef struct mosaic_glyph_raster_rebuild_font_atlas_rets_t {
-    font_glyph_cache_t * glyph_cache;
-    codepoint_rasterizing_e rasterize_state;
-} mosaic_glyph_raster_rebuild_font_atlas_rets_t;
-
-static mosaic_glyph_raster_rebuild_font_atlas_rets_t mosaic_glyph_raster_rebuild_font_atlas(mosaic_context_t * const mosaic_ctx, const int32_t font_id, const char * const text_begin, const char * const text_end) {
+// called once everything drawn so far has been flushed: the pages it referenced become evictable again, so room can be made for the rest of the string.
+static codepoint_rasterizing_e mosaic_glyph_raster_evict_and_rasterize_glyphs(mosaic_context_t * const mosaic_ctx, font_glyph_cache_t * const glyph_cache, const char * const text_begin, const char * const text_end) {
     CG_FONT_TRACE_PUSH_FN();
-    mosaic_glyph_raster_t * const glyph_raster = mosaic_ctx->glyph_raster;
-
-    mosaic_glyph_raster_shutdown(glyph_raster);
-    mosaic_glyph_raster_emplace_init(glyph_raster, mosaic_ctx);
-
-    mosaic_glyph_raster_rebuild_font_atlas_rets_t rebuild_rets;
-    rebuild_rets.glyph_cache = mosaic_glyph_raster_create_glyph_cache(glyph_raster, font_id);
-
-    rebuild_rets.rasterize_state = mosaic_glyph_raster_try_rasterize_glyphs(mosaic_ctx, rebuild_rets.glyph_cache, text_begin, text_end);
+    mosaic_glyph_raster_begin_use(mosaic_ctx->glyph_raster);
+    const codepoint_rasterizing_e rasterize_state = mosaic_glyph_raster_try_rasterize_glyphs(mosaic_ctx, glyph_cache, text_begin, text_end);
     CG_FONT_TRACE_POP();
-    return rebuild_rets;
+    return rasterize_state;
 }
 
 void mosaic_context_glyph_raster_debug_draw(const mosaic_context_t * const mosaic_ctx, const int32_t mouse_pos_x, const int32_t mouse_pos_y, const bool draw_rects) {
@@ -1061,6 +1595,8 @@ static void font_load_job(void * const void_user, thread_pool_t * const thread_p
     }
 
     stbtt_GetFontVMetrics(&user->cg_font->font_info, &user->cg_font->font_ascent, 0, 0);
+    // built here on the worker so the main thread never pays for it.
+    font_metrics_build(&user->cg_font->metrics, &user->cg_font->font_info, &user->cg_font->cg_ctx->cg_heap_low, cg_font_kern_table_size_from_font);
     CG_FONT_TRACE_POP();
 }
 
@@ -1204,12 +1740,13 @@ cg_font_async_load_status_e cg_get_font_load_status(const cg_font_file_t * const
 
 /* ------------------------------------------------------------------------- */
 
-static void text_mesh_cache_init_emplace(text_mesh_cache_t * const cache, uint32_t size, const char * const tag);
+static void text_mesh_cache_init_emplace(text_mesh_cache_t * const cache, uint32_t size, const uint32_t max_bytes, const char * const tag);
 
 mosaic_context_t * mosaic_context_new(
     cg_context_t * const cg_ctx,
     const int32_t width,
     const int32_t height,
+    const int32_t requested_num_pages,
     const mem_region_t canvas_font_scratchpad,
     const system_guard_page_mode_e guard_page_mode,
     const char * const tag) {
@@ -1217,12 +1754,29 @@ mosaic_context_t * mosaic_context_new(
     mosaic_context_t * const mosaic_ctx = cg_alloc(&cg_ctx->cg_heap_low, sizeof(mosaic_context_t), tag);
     ZEROMEM(mosaic_ctx);
 
+    // pages are stacked vertically in a single texture so text keeps drawing with one texture binding.
+    VERIFY_MSG((requested_num_pages > 0) && (requested_num_pages <= cg_max_font_atlas_pages), "font atlas must have between 1 and %i pages, got: %i", cg_max_font_atlas_pages, requested_num_pages);
+
+    // the whole stack has to fit the device's max texture size (0 when the device doesn't report one) and the int16 tex coords.
+    const int32_t max_texture_size = cg_ctx->gl->render_device->caps.max_texture_size;
+    const int32_t max_atlas_height = (max_texture_size > 0) ? min_int32_t(max_texture_size, INT16_MAX) : INT16_MAX;
+    VERIFY_MSG((height > 0) && (height <= max_atlas_height), "font atlas page of %i rows doesn't fit a texture of %i rows", height, max_atlas_height);
+
+    const int32_t num_pages = min_int32_t(requested_num_pages, max_atlas_height / height);
+    if (num_pages < requested_num_pages) {
+        LOG_WARN(TAG_CG_FONT, "Font atlas clamped to [%i] of [%i] pages, [%i] rows per page exceeds the max texture size of [%i]", num_pages, requested_num_pages, height, max_atlas_height);
+    }
+
+    const int32_t atlas_height = height * num_pages;
+
     mosaic_ctx->cg_ctx = cg_ctx;
     mosaic_ctx->max_width = width;
-    mosaic_ctx->max_height = height;
+    mosaic_ctx->max_height = atlas_height;
+    mosaic_ctx->atlas.num_pages = num_pages;
+    mosaic_ctx->atlas.page_height = height;
 
     if (cg_statics.ctx->config.text_mesh_cache.enabled) {
-        text_mesh_cache_init_emplace(&mosaic_ctx->text_mesh_cache, cg_statics.ctx->config.text_mesh_cache.size, MALLOC_TAG);
+        text_mesh_cache_init_emplace(&mosaic_ctx->text_mesh_cache, cg_statics.ctx->config.text_mesh_cache.size, cg_statics.ctx->config.text_mesh_cache.max_bytes, MALLOC_TAG);
     }
 
 #ifdef GUARD_PAGE_SUPPORT
@@ -1248,7 +1802,7 @@ mosaic_context_t * mosaic_context_new(
         lba_init(&mosaic_ctx->atlas_lba, canvas_font_scratchpad.ptr, (int)canvas_font_scratchpad.size, "font_atlas_lba");
     }
 
-    const size_t atlas_size = width * height * 1;
+    const size_t atlas_size = width * atlas_height * 1;
     mosaic_ctx->atlas.image.pixel_buffer = (cg_allocation_t){{{.cg_heap = &cg_ctx->cg_heap_low, .region = MEM_REGION(.ptr = cg_alloc(&cg_ctx->cg_heap_low, atlas_size, MALLOC_TAG), .size = atlas_size)}}};
 
 #if !(defined(_VADER) || defined(_LEIA))
@@ -1258,7 +1812,9 @@ mosaic_context_t * mosaic_context_new(
         LL_ADD(&mosaic_ctx->atlas.upload_region.buffer[i], prev, next, mosaic_ctx->atlas.upload_region.free_head, mosaic_ctx->atlas.upload_region.free_tail);
     }
 
-    mosaic_ctx->atlas.sub_image_copy_buffer = (cg_allocation_t){{{.cg_heap = &cg_ctx->cg_heap_low, .region = MEM_REGION(.ptr = cg_alloc(&cg_ctx->cg_heap_low, atlas_size, MALLOC_TAG), .size = atlas_size)}}};
+    // dirty rects are uploaded a page at a time
+    const size_t atlas_page_size = width * height * 1;
+    mosaic_ctx->atlas.sub_image_copy_buffer = (cg_allocation_t){{{.cg_heap = &cg_ctx->cg_heap_low, .region = MEM_REGION(.ptr = cg_alloc(&cg_ctx->cg_heap_low, atlas_page_size, MALLOC_TAG), .size = atlas_page_size)}}};
 
     heap_init_with_region(&mosaic_ctx->atlas.sub_image_heap, mosaic_ctx->atlas.sub_image_copy_buffer.region, 8, 0, "mosaic_ctx_atlas_sub_image_heap");
 #endif
@@ -1266,12 +1822,12 @@ mosaic_context_t * mosaic_context_new(
     mosaic_ctx->atlas.image.image = (image_t){
         .encoding = image_encoding_uncompressed,
         .width = width,
-        .height = height,
+        .height = atlas_height,
         .depth = 1,
         .bpp = 1,
         .pitch = 1 * width,
-        .spitch = width * height * 1,
-        .data_len = width * height * 1,
+        .spitch = width * atlas_height * 1,
+        .data_len = width * atlas_height * 1,
         .data = mosaic_ctx->atlas.image.pixel_buffer.region.ptr,
     };
 
@@ -1347,6 +1903,33 @@ void mosaic_context_free(mosaic_context_t * ctx) {
     CG_FONT_TRACE_POP();
 }
 
+mosaic_atlas_stats_t mosaic_context_get_atlas_stats(const mosaic_context_t * const mosaic_ctx) {
+    const mosaic_glyph_raster_t * const glyph_raster = mosaic_ctx->glyph_raster;
+    return (mosaic_atlas_stats_t){
+        .num_pages = glyph_raster->num_pages,
+        .page_width = glyph_raster->page_width,
+        .page_height = glyph_raster->page_height,
+        .num_resident_glyphs = mosaic_context_get_resident_glyph_rects(mosaic_ctx, NULL, 0),
+        .num_page_evictions = glyph_raster->num_page_evictions,
+    };
+}
+
+int32_t mosaic_context_get_resident_glyph_rects(const mosaic_context_t * const mosaic_ctx, cg_int16_rect_t * const out_rects, const int32_t max_rects) {
+    int32_t num_resident = 0;
+    for (const font_glyph_cache_t * glyph_cache = mosaic_ctx->glyph_raster->font_glyph_cache_head; glyph_cache != NULL; glyph_cache = glyph_cache->next) {
+        for (int32_t codepoint_ind = 0; codepoint_ind < glyph_cache->codepoints_size; ++codepoint_ind) {
+            const codepoint_info_t * const codepoint_info = &glyph_cache->codepoint_infos[codepoint_ind];
+            if ((codepoint_info->state == codepoint_rasterized) && (codepoint_info->page >= 0)) {
+                if (num_resident < max_rects) {
+                    out_rects[num_resident] = codepoint_info->tex_coords;
+                }
+                ++num_resident;
+            }
+        }
+    }
+    return num_resident;
+}
+
 /* ------------------------------------------------------------------------- */
 
 void mosaic_context_font_bind(mosaic_context_t * ctx, int32_t index) {
@@ -1388,15 +1971,12 @@ static void find_linebreak_position(
         return;
     }
 
-    int32_t x_advance, ignored;
+    font_metrics_t * const font_metrics = &mosaic_font->cg_font->metrics;
     const int32_t missing_glyph_codepoint = get_missing_glyph_codepoint(mosaic_ctx, mosaic_font);
-    const int32_t missing_glyph_index = stbtt_FindGlyphIndex(stbtt_font_info, missing_glyph_codepoint);
-    stbtt_GetGlyphHMetrics(stbtt_font_info, missing_glyph_index, &x_advance, &ignored);
-    const int32_t missing_glyph_codepoint_width = x_advance;
+    const font_metrics_glyph_t missing_glyph = font_metrics_get_glyph(font_metrics, stbtt_font_info, missing_glyph_codepoint);
 
-    const int32_t space_glyph_index = stbtt_FindGlyphIndex(stbtt_font_info, (int32_t)' ');
-    stbtt_GetGlyphHMetrics(stbtt_font_info, space_glyph_index, &x_advance, &ignored);
-    const int32_t tab_width = x_advance * mosaic_font->tab_space_multiplier;
+    const font_metrics_glyph_t space_glyph = font_metrics_get_glyph(font_metrics, stbtt_font_info, (int32_t)' ');
+    const int32_t tab_width = space_glyph.advance * mosaic_font->tab_space_multiplier;
 
     const char * last_codepoint_location = curr_text_location;
 
@@ -1405,20 +1985,23 @@ static void find_linebreak_position(
         last_codepoint_location = curr_text_location;
         curr_text_location += utf8_to_codepoint(curr_text_location, &curr_codepoint);
         utf8_to_codepoint(curr_text_location, &next_codepoint);
-        int32_t curr_glyph_index = stbtt_FindGlyphIndex(stbtt_font_info, curr_codepoint);
-        const int32_t next_glyph_index = stbtt_FindGlyphIndex(stbtt_font_info, next_codepoint);
-
-        if ((curr_codepoint != '\t') && curr_glyph_index) {
-            stbtt_GetGlyphHMetrics(stbtt_font_info, curr_glyph_index, &x_advance, &ignored);
-        } else if ((curr_codepoint != '\t') && !curr_glyph_index) {
-            curr_glyph_index = curr_glyph_index ? curr_glyph_index : missing_glyph_index;
-            x_advance = missing_glyph_codepoint_width;
+        const font_metrics_glyph_t curr_glyph = font_metrics_get_glyph(font_metrics, stbtt_font_info, curr_codepoint);
+        const font_metrics_glyph_t next_glyph = font_metrics_get_glyph(font_metrics, stbtt_font_info, next_codepoint);
+
+        int32_t x_advance, kern_glyph_index;
+        if ((curr_codepoint != '\t') && curr_glyph.glyph_index) {
+            x_advance = curr_glyph.advance;
+            kern_glyph_index = curr_glyph.glyph_index;
+        } else if (curr_codepoint != '\t') {
+            x_advance = missing_glyph.advance;
+            kern_glyph_index = missing_glyph.glyph_index;
         } else {
             x_advance = tab_width;
+            kern_glyph_index = space_glyph.glyph_index;
         }
 
         curr_line_width += font_scale * x_advance;
-        curr_line_width += font_scale * stbtt_GetGlyphKernAdvance(stbtt_font_info, curr_codepoint != '\t' ? curr_glyph_index : space_glyph_index, next_glyph_index);
+        curr_line_width += font_scale * font_metrics_get_kern_advance(font_metrics, stbtt_font_info, kern_glyph_index, next_glyph.glyph_index);
 
         if (curr_line_width > max_line_width) {
             break;
@@ -1492,8 +2075,9 @@ static draw_text_status_e draw_partial_text(
     const float font_scale = mosaic_font->scale;
     const float font_baseline = mosaic_font->ascent * font_scale;
 
+    font_metrics_t * const font_metrics = &mosaic_font->cg_font->metrics;
     const int32_t missing_glyph_codepoint = get_missing_glyph_codepoint(mosaic_ctx, mosaic_font);
-    const int32_t missing_glyph_index = stbtt_FindGlyphIndex(stbtt_font_info, missing_glyph_codepoint);
+    const int32_t missing_glyph_index = font_metrics_get_glyph(font_metrics, stbtt_font_info, missing_glyph_codepoint).glyph_index;
     const codepoint_info_t * const missing_glyph_codepoint_info = font_glyph_cache_find_codepoint_info(missing_glyph_index ? missing_glyph_codepoint : ' ', glyph_cache);
 
     float curr_width = offset.x;
@@ -1511,7 +2095,7 @@ static draw_text_status_e draw_partial_text(
 
         const bool is_tab = curr_codepoint == '\t';
         const codepoint_info_t * codepoint_info = font_glyph_cache_find_codepoint_info(!is_tab ? curr_codepoint : (int32_t)' ', glyph_cache);
-        if (codepoint_info == NULL) {
+        if ((codepoint_info == NULL) || (codepoint_info->state == codepoint_evicted)) {
             CG_FONT_TRACE_POP();
             return draw_text_codepoint_not_in_cache;
         } else if ((codepoint_info->state == codepoint_no_backing_glyph) && missing_glyph_codepoint_info && (missing_glyph_codepoint_info->state == codepoint_rasterized) && !is_control_character(curr_codepoint)) {
@@ -1523,6 +2107,11 @@ static draw_text_status_e draw_partial_text(
 
         *out_last_codepoint = curr_text;
 
+        if (codepoint_info->page >= 0) {
+            mosaic_glyph_raster_touch_page(mosaic_ctx->glyph_raster, codepoint_info->page);
+            mesh->atlas_page_mask |= 1u << codepoint_info->page;
+        }
+
         // 1px padding
         const float x = codepoint_info->tex_coords.x, y = codepoint_info->tex_coords.y;
         const float w = codepoint_info->tex_coords.width, h = codepoint_info->tex_coords.height;
@@ -1534,9 +2123,10 @@ static draw_text_status_e draw_partial_text(
 
         curr_width += codepoint_info->x_advance * ((is_tab) ? mosaic_font->tab_space_multiplier : 1);
 
-        const int32_t next_codepoint = **out_last_codepoint;
-        if (next_codepoint) {
-            curr_width += font_scale * stbtt_GetCodepointKernAdvance(stbtt_font_info, curr_codepoint, next_codepoint);
+        if (**out_last_codepoint) {
+            int32_t next_codepoint;
+            utf8_to_codepoint(*out_last_codepoint, &next_codepoint);
+            curr_width += font_scale * font_metrics_get_kern_advance(font_metrics, stbtt_font_info, font_metrics_get_glyph(font_metrics, stbtt_font_info, curr_codepoint).glyph_index, font_metrics_get_glyph(font_metrics, stbtt_font_info, next_codepoint).glyph_index);
         }
 
         if (is_whitespace(curr_codepoint)) {
@@ -1739,6 +2329,7 @@ cg_rect_t mosaic_context_draw_text_block(
     if (glyph_cache == NULL) {
         glyph_cache = mosaic_glyph_raster_create_glyph_cache(mosaic_ctx->glyph_raster, mosaic_ctx->font_index);
     }
+    mosaic_glyph_raster_begin_use(mosaic_ctx->glyph_raster);
 
     const float font_height = (float)font->height;
     const float line_height = (options & cg_text_block_line_space_relative) ? (font_height * extra_line_spacing) : (font_height + extra_line_spacing);
@@ -1762,9 +2353,8 @@ cg_rect_t mosaic_context_draw_text_block(
         find_linebreak_position(mosaic_ctx, INFINITY, optional_ellipses, &linebreak_ignored, &ellipses_width, &line_width_ignored);
     }
 
-    int32_t space_width_int, tab_width_int, lsb_ignored;
-    stbtt_GetCodepointHMetrics(&font->cg_font->font_info, ' ', &space_width_int, &lsb_ignored);
-    stbtt_GetCodepointHMetrics(&font->cg_font->font_info, '\t', &tab_width_int, &lsb_ignored);
+    const int32_t space_width_int = font_metrics_get_glyph(&font->cg_font->metrics, &font->cg_font->font_info, ' ').advance;
+    const int32_t tab_width_int = font_metrics_get_glyph(&font->cg_font->metrics, &font->cg_font->font_info, '\t').advance;
 
     const float space_width = font->scale * space_width_int;
     const float tab_width = font->scale * tab_width_int;
@@ -1840,7 +2430,7 @@ cg_rect_t mosaic_context_draw_text_block(
 
             } else if (draw_text_status == draw_text_glyph_not_in_atlas) {
                 flush_and_draw_mesh(mosaic_ctx, &text_mesh);
-                glyph_cache = mosaic_glyph_raster_rebuild_font_atlas(mosaic_ctx, mosaic_ctx->font_index, curr_text_position, linebreak_position).glyph_cache;
+                mosaic_glyph_raster_evict_and_rasterize_glyphs(mosaic_ctx, glyph_cache, curr_text_position, linebreak_position);
 
             } else if (draw_text_status == draw_text_no_more_indices) {
                 flush_and_draw_mesh(mosaic_ctx, &text_mesh);
@@ -1881,7 +2471,7 @@ cg_rect_t mosaic_context_draw_text_block(
 
                 } else if (draw_text_status == draw_text_glyph_not_in_atlas) {
                     flush_and_draw_mesh(mosaic_ctx, &text_mesh);
-                    glyph_cache = mosaic_glyph_raster_rebuild_font_atlas(mosaic_ctx, mosaic_ctx->font_index, curr_ellipses_position, end_of_ellipses).glyph_cache;
+                    mosaic_glyph_raster_evict_and_rasterize_glyphs(mosaic_ctx, glyph_cache, curr_ellipses_position, end_of_ellipses);
 
                 } else if (draw_text_status == draw_text_no_more_indices) {
                     flush_and_draw_mesh(mosaic_ctx, &text_mesh);
@@ -1941,6 +2531,7 @@ void mosaic_context_draw_text_line(
     if (glyph_cache == NULL) {
         glyph_cache = mosaic_glyph_raster_create_glyph_cache(mosaic_ctx->glyph_raster, mosaic_ctx->font_index);
     }
+    mosaic_glyph_raster_begin_use(mosaic_ctx->glyph_raster);
 
     const cg_context_t * const cg_ctx = mosaic_ctx->cg_ctx;
 
@@ -1979,7 +2570,7 @@ void mosaic_context_draw_text_line(
 
             } else if (draw_text_status == draw_text_glyph_not_in_atlas) {
                 flush_and_draw_mesh(mosaic_ctx, &text_mesh);
-                glyph_cache = mosaic_glyph_raster_rebuild_font_atlas(mosaic_ctx, mosaic_ctx->font_index, curr_text_position, text_end).glyph_cache;
+                mosaic_glyph_raster_evict_and_rasterize_glyphs(mosaic_ctx, glyph_cache, curr_text_position, text_end);
 
             } else if (draw_text_status == draw_text_no_more_indices) {
                 flush_and_draw_mesh(mosaic_ctx, &text_mesh);
@@ -2147,15 +2738,20 @@ static codepoint_rasterizing_e mosaic_context_precache_glyphs(cg_font_context_t
 }
 
 void cg_context_font_precache_glyphs(cg_font_context_t * const font_ctx, const char * const characters) {
+    mosaic_glyph_raster_begin_use(font_ctx->mosaic_ctx->glyph_raster);
     mosaic_context_precache_glyphs(font_ctx, characters);
 }
 
+static void text_mesh_cache_evict_active_nodes(text_mesh_cache_t * const cache, const char * const tag);
+
 void cg_context_font_clear_glyph_cache() {
     mosaic_context_t * const mosaic_ctx = cg_statics.ctx->mosaic_ctx;
     mosaic_glyph_raster_t * const glyph_raster = mosaic_ctx->glyph_raster;
 
     mosaic_glyph_raster_shutdown(glyph_raster);
     mosaic_glyph_raster_emplace_init(glyph_raster, mosaic_ctx);
+    // cached meshes reference glyphs that are gone now
+    text_mesh_cache_evict_active_nodes(&mosaic_ctx->text_mesh_cache, MALLOC_TAG);
 }
 
 static uint32_t string_get_num_codepoints(const char * const str) {
@@ -2292,9 +2888,8 @@ static void mosaic_context_create_text_block_mesh(
         find_linebreak_position(mosaic_ctx, INFINITY, optional_ellipses, &linebreak_ignored, &ellipses_width, &line_width_ignored);
     }
 
-    int32_t space_width_int, tab_width_int, lsb_ignored;
-    stbtt_GetCodepointHMetrics(&font->cg_font->font_info, ' ', &space_width_int, &lsb_ignored);
-    stbtt_GetCodepointHMetrics(&font->cg_font->font_info, '\t', &tab_width_int, &lsb_ignored);
+    const int32_t space_width_int = font_metrics_get_glyph(&font->cg_font->metrics, &font->cg_font->font_info, ' ').advance;
+    const int32_t tab_width_int = font_metrics_get_glyph(&font->cg_font->metrics, &font->cg_font->font_info, '\t').advance;
 
     const float space_width = font->scale * space_width_int;
     const float tab_width = font->scale * tab_width_int;
@@ -2436,33 +3031,74 @@ static text_mesh_id_block_t mosaic_context_text_block_create_mesh_id_block(mosai
     id_block.rect = affine_apply_rect(text_rect);
     memcpy(id_block.first_n_chars, text, min_size_t(id_block.str_len, sizeof(id_block.first_n_chars)));
 
-    // TODO: need to apply the cg affine to the text rect, else we could have a case where client tries to draw the same string in 4 locations, with the entire same set of data... but they just translate via cg_translate.
-    id_block.crc = crc_32((const unsigned char *)&text_rect, sizeof(text_rect));
-    id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)&id_block.font_id, sizeof(id_block.font_id));
-    id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)&scroll_offset, sizeof(scroll_offset));
-    id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)&extra_line_spacing, sizeof(extra_line_spacing));
-
+    // the crc keys the cache's hash index, so it covers the string and every layout parameter (the rect post-affine, so translated copies of a string get their own mesh).
     id_block.crc = crc_32((const unsigned char *)text, id_block.str_len);
     if (optional_ellipses) {
         id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)optional_ellipses, strlen(optional_ellipses));
     }
 
+    id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)&id_block.rect, sizeof(id_block.rect));
+    id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)&id_block.font_id, sizeof(id_block.font_id));
+    id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)&scroll_offset, sizeof(scroll_offset));
+    id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)&extra_line_spacing, sizeof(extra_line_spacing));
     id_block.crc = update_crc_32(id_block.crc, (const unsigned char *)&options, sizeof(options));
 
     CG_FONT_TRACE_POP();
     return id_block;
 }
 
-static void text_mesh_cache_init_emplace(text_mesh_cache_t * const cache, uint32_t size, const char * const tag) {
+static void text_mesh_cache_init_emplace(text_mesh_cache_t * const cache, uint32_t size, const uint32_t max_bytes, const char * const tag) {
     cg_context_t * const ctx = cg_statics.ctx;
     *cache = (text_mesh_cache_t){0};
 
     cache->storage = cg_alloc(&ctx->cg_heap_low, size * sizeof(text_mesh_cache_node_t), tag);
     cache->storage_len = size;
+    cache->max_bytes = max_bytes;
 
     for (uint32_t i = 0; i < size; ++i) {
         LL_ADD(&cache->storage[i], prev, next, cache->free.head, cache->free.tail);
     }
+
+    // power of two buckets, at least 2x the nodes to keep chains short.
+    uint32_t num_buckets = 16;
+    while (num_buckets < size * 2) {
+        num_buckets <<= 1;
+    }
+    cache->buckets = cg_alloc(&ctx->cg_heap_low, num_buckets * sizeof(*cache->buckets), tag);
+    memset(cache->buckets, 0, num_buckets * sizeof(*cache->buckets));
+    cache->bucket_mask = num_buckets - 1;
+}
+
+static void text_mesh_cache_hash_insert(text_mesh_cache_t * const cache, text_mesh_cache_node_t * const node) {
+    text_mesh_cache_node_t ** const bucket = &cache->buckets[node->id_block.crc & cache->bucket_mask];
+    node->hash_next = *bucket;
+    *bucket = node;
+}
+
+static void text_mesh_cache_hash_remove(text_mesh_cache_t * const cache, text_mesh_cache_node_t * const node) {
+    text_mesh_cache_node_t ** curr = &cache->buckets[node->id_block.crc & cache->bucket_mask];
+    while (*curr != node) {
+        ASSERT(*curr);
+        curr = &(*curr)->hash_next;
+    }
+    *curr = node->hash_next;
+    node->hash_next = NULL;
+}
+
+// frees the node's mesh and drops it from the index, the node itself stays on whichever list it is on.
+static void text_mesh_cache_release_node_mesh(text_mesh_cache_t * const cache, text_mesh_cache_node_t * const node, const char * const tag) {
+    text_mesh_cache_hash_remove(cache, node);
+    ASSERT(cache->bytes_used >= node->text_mesh.null_buffer.size);
+    cache->bytes_used -= node->text_mesh.null_buffer.size;
+    ++cache->counters.evictions;
+    text_mesh_free(&node->text_mesh, tag);
+}
+
+static void text_mesh_cache_evict_node(text_mesh_cache_t * const cache, text_mesh_cache_node_t * const node, const char * const tag) {
+    text_mesh_cache_release_node_mesh(cache, node, tag);
+    LL_REMOVE(node, prev, next, cache->active.head, cache->active.tail);
+    *node = (text_mesh_cache_node_t){0};
+    LL_ADD(node, prev, next, cache->free.head, cache->free.tail);
 }
 
 static void text_mesh_cache_evict_active_nodes(text_mesh_cache_t * const cache, const char * const tag) {
@@ -2470,10 +3106,20 @@ static void text_mesh_cache_evict_active_nodes(text_mesh_cache_t * const cache,
     text_mesh_cache_node_t * curr_node = cache->active.head;
     while (curr_node) {
         text_mesh_cache_node_t * const next_node = curr_node->next;
-        text_mesh_free(&curr_node->text_mesh, tag);
-        LL_REMOVE(curr_node, prev, next, cache->active.head, cache->active.tail);
-        *curr_node = (text_mesh_cache_node_t){0};
-        LL_ADD(curr_node, prev, next, cache->free.head, cache->free.tail);
+        text_mesh_cache_evict_node(cache, curr_node, tag);
+        curr_node = next_node;
+    }
+    CG_FONT_TRACE_POP();
+}
+
+static void text_mesh_cache_evict_atlas_page_nodes(text_mesh_cache_t * const cache, const uint32_t atlas_page_mask, const char * const tag) {
+    CG_FONT_TRACE_PUSH_FN();
+    text_mesh_cache_node_t * curr_node = cache->active.head;
+    while (curr_node) {
+        text_mesh_cache_node_t * const next_node = curr_node->next;
+        if (curr_node->text_mesh.atlas_page_mask & atlas_page_mask) {
+            text_mesh_cache_evict_node(cache, curr_node, tag);
+        }
         curr_node = next_node;
     }
     CG_FONT_TRACE_POP();
@@ -2484,6 +3130,7 @@ static void text_mesh_cache_free(text_mesh_cache_t * const cache, const char * c
     cg_context_t * const ctx = cg_statics.ctx;
 
     text_mesh_cache_evict_active_nodes(cache, tag);
+    cg_free(&ctx->cg_heap_low, cache->buckets, tag);
     cg_free(&ctx->cg_heap_low, cache->storage, tag);
     CG_FONT_TRACE_POP();
 }
@@ -2492,8 +3139,9 @@ static text_mesh_cache_node_t * text_mesh_cache_try_pop_free(text_mesh_cache_t *
     text_mesh_cache_node_t * const node = cache->free.head;
     if (node) {
         LL_REMOVE(node, prev, next, cache->free.head, cache->free.tail);
-        LL_ADD(node, prev, next, cache->active.head, cache->active.tail);
+        LL_PUSH_FRONT(node, prev, next, cache->active.head, cache->active.tail);
         node->id_block = *id_block;
+        text_mesh_cache_hash_insert(cache, node);
     }
     return node;
 }
@@ -2503,14 +3151,24 @@ static text_mesh_cache_node_t * text_mesh_cache_reuse_oldest_node(text_mesh_cach
     text_mesh_cache_node_t * const node = cache->active.tail;
     LL_REMOVE(node, prev, next, cache->active.head, cache->active.tail);
     LL_PUSH_FRONT(node, prev, next, cache->active.head, cache->active.tail);
-    text_mesh_free(&node->text_mesh, tag);
+    text_mesh_cache_release_node_mesh(cache, node, tag);
     node->id_block = *id_block;
+    text_mesh_cache_hash_insert(cache, node);
     return node;
 }
 
+// drops least recently used meshes until the cache is back under its byte budget, `keep` (the mesh just built) always survives.
+static void text_mesh_cache_enforce_byte_budget(text_mesh_cache_t * const cache, const text_mesh_cache_node_t * const keep, const char * const tag) {
+    CG_FONT_TRACE_PUSH_FN();
+    while ((cache->max_bytes > 0) && (cache->bytes_used > cache->max_bytes) && cache->active.tail && (cache->active.tail != keep)) {
+        text_mesh_cache_evict_node(cache, cache->active.tail, tag);
+    }
+    CG_FONT_TRACE_POP();
+}
+
 static text_mesh_cache_node_t * text_mesh_cache_find_node(text_mesh_cache_t * const cache, const text_mesh_id_block_t * const id_block) {
     CG_FONT_TRACE_PUSH_FN();
-    text_mesh_cache_node_t * curr_node = cache->active.head;
+    text_mesh_cache_node_t * curr_node = cache->buckets[id_block->crc & cache->bucket_mask];
     while (curr_node) {
         if (text_mesh_id_block_compare(&curr_node->id_block, id_block)) {
             // shuffle the nodes around so the most recently used node is up front, so we can have the least used towards the end of the list.
@@ -2519,7 +3177,7 @@ static text_mesh_cache_node_t * text_mesh_cache_find_node(text_mesh_cache_t * co
             CG_FONT_TRACE_POP();
             return curr_node;
         }
-        curr_node = curr_node->next;
+        curr_node = curr_node->hash_next;
     }
     CG_FONT_TRACE_POP();
     return NULL;
@@ -2535,35 +3193,52 @@ static cg_rect_t mosaic_context_draw_text_block_memoized(
     const cg_text_block_options_e options) {
     CG_FONT_TRACE_PUSH_FN();
     text_mesh_cache_t * const text_mesh_cache = &font_ctx->mosaic_ctx->text_mesh_cache;
+    mosaic_glyph_raster_t * const glyph_raster = font_ctx->mosaic_ctx->glyph_raster;
+    mosaic_glyph_raster_begin_use(glyph_raster);
 
     const text_mesh_id_block_t id_block = mosaic_context_text_block_create_mesh_id_block(font_ctx->mosaic_ctx, text_rect, scroll_offset, extra_line_spacing, text, optional_ellipses, options);
 
     // we have the node, trivial case of just reusing.
     text_mesh_cache_node_t * node = text_mesh_cache_find_node(text_mesh_cache, &id_block);
     if (node) {
+        ++text_mesh_cache->counters.hits;
+        for (int32_t page_ind = 0; page_ind < glyph_raster->num_pages; ++page_ind) {
+            if (node->text_mesh.atlas_page_mask & (1u << page_ind)) {
+                mosaic_glyph_raster_touch_page(glyph_raster, page_ind);
+            }
+        }
         text_mesh_draw(&node->text_mesh);
         if (node->text_mesh.verts && render_check_fence(node->text_mesh.fence)) {
             text_mesh_free_verts(&node->text_mesh, MALLOC_TAG);
         }
         CG_FONT_TRACE_POP();
         return node->text_mesh.bounding_box;
-    } else if ((mosaic_context_precache_glyphs(font_ctx, text) == codepoint_rasterizing_renderable_rasterized) && (!optional_ellipses || (mosaic_context_precache_glyphs(font_ctx, optional_ellipses) == codepoint_rasterizing_renderable_rasterized))) {
+    }
+
+    ++text_mesh_cache->counters.misses;
+    if ((mosaic_context_precache_glyphs(font_ctx, text) == codepoint_rasterizing_renderable_rasterized) && (!optional_ellipses || (mosaic_context_precache_glyphs(font_ctx, optional_ellipses) == codepoint_rasterizing_renderable_rasterized))) {
         // we do have glyphs in the atlas, just need to find a valid node we can use.
         node = text_mesh_cache_try_pop_free(text_mesh_cache, &id_block);
         if (!node) {
             node = text_mesh_cache_reuse_oldest_node(text_mesh_cache, &id_block, MALLOC_TAG);
         }
     } else {
-        // glyphs could not fit, must flush the atlas, and all existing meshes and rebuild.
-        text_mesh_cache_evict_active_nodes(text_mesh_cache, MALLOC_TAG);
-        VERIFY(mosaic_glyph_raster_rebuild_font_atlas(font_ctx->mosaic_ctx, font_ctx->font_index, text, text + id_block.str_len).rasterize_state == codepoint_rasterizing_renderable_rasterized);
+        // the string's glyphs don't fit even after evicting every page it doesn't use, so start from an empty atlas.
+        // this also drops the cached meshes referencing any of the pages.
+        mosaic_glyph_raster_evict_all_pages(glyph_raster);
+        mosaic_glyph_raster_begin_use(glyph_raster);
+        VERIFY(mosaic_context_precache_glyphs(font_ctx, text) == codepoint_rasterizing_renderable_rasterized);
         node = text_mesh_cache_try_pop_free(text_mesh_cache, &id_block);
-        VERIFY(node);
+        if (!node) {
+            node = text_mesh_cache_reuse_oldest_node(text_mesh_cache, &id_block, MALLOC_TAG);
+        }
     }
     ASSERT(node);
 
     // create the text mesh, flush the atlas, and draw.
     mosaic_context_create_text_block_mesh(font_ctx->mosaic_ctx, text_rect, scroll_offset, extra_line_spacing, text, optional_ellipses, options, &node->text_mesh);
+    text_mesh_cache->bytes_used += node->text_mesh.null_buffer.size;
+    text_mesh_cache_enforce_byte_budget(text_mesh_cache, node, MALLOC_TAG);
     text_mesh_upload_mesh_indirect(&node->text_mesh);
     mosaic_glyph_raster_flush_atlas(font_ctx->mosaic_ctx->glyph_raster);
     text_mesh_draw(&node->text_mesh);
@@ -2571,4 +3246,20 @@ static cg_rect_t mosaic_context_draw_text_block_memoized(
 
     CG_FONT_TRACE_POP();
     return node->text_mesh.bounding_box;
-}
\ No newline at end of file
+}
+
+cg_text_mesh_cache_metrics_t cg_context_get_text_mesh_cache_metrics(cg_context_t * const ctx) {
+    const text_mesh_cache_t * const cache = &ctx->mosaic_ctx->text_mesh_cache;
+    uint64_t num_entries = 0;
+    for (const text_mesh_cache_node_t * node = cache->active.head; node; node = node->next) {
+        ++num_entries;
+    }
+    return (cg_text_mesh_cache_metrics_t){
+        .hits = cache->counters.hits,
+        .misses = cache->counters.misses,
+        .evictions = cache->counters.evictions,
+        .num_entries = num_entries,
+        .bytes_used = cache->bytes_used,
+        .max_bytes = cache->max_bytes,
+    };
+}
@@ -19,8 +19,20 @@ enum {
     cg_utf8_max_codepoint_len = 4,
 };
 
+// kerning table sizes of cg_font_file_rebuild_metrics() besides an explicit power of two
+enum {
+    cg_font_kern_table_size_from_font = 0,
+    cg_font_no_kern_table = -1,
+};
+
 struct cg_font_file_t;
 
+// this will be our offset into the texture atlas, there is zero chance we're going to have a texture atlas larger than 32k
+typedef struct cg_int16_rect_t {
+    int16_t x, y;
+    int16_t width, height;
+} cg_int16_rect_t;
+
 typedef struct text_mesh_t {
     r_mesh_t * r_mesh;
     rb_fence_t fence;
@@ -35,6 +47,9 @@ typedef struct text_mesh_t {
     int32_t glyphs_drawn;
     int32_t reserved_verts;
 
+    // bit per atlas page this mesh samples glyphs from, the mesh is invalidated when any of them is evicted.
+    uint32_t atlas_page_mask;
+
     cg_rect_t bounding_box;
 } text_mesh_t;
 
@@ -60,6 +75,8 @@ typedef struct text_mesh_cache_node_t {
     text_mesh_t text_mesh;
     struct text_mesh_cache_node_t * prev;
     struct text_mesh_cache_node_t * next;
+    // next node in the same hash bucket
+    struct text_mesh_cache_node_t * hash_next;
 } text_mesh_cache_node_t;
 
 typedef struct text_mesh_cache_t {
@@ -74,6 +91,19 @@ typedef struct text_mesh_cache_t {
 
     text_mesh_cache_node_t * storage;
     uint32_t storage_len;
+
+    // index over the active nodes keyed by `id_block.crc`, so lookups don't walk the lru list.
+    text_mesh_cache_node_t ** buckets;
+    uint32_t bucket_mask;
+
+    size_t bytes_used;
+    size_t max_bytes;
+
+    struct {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+    } counters;
 } text_mesh_cache_t;
 
 typedef struct mosaic_font_data_t {
@@ -103,7 +133,10 @@ struct mosaic_context_t {
 
     struct {
         // the image's image.data is cpu local bytes only.
+        // pages are stacked vertically in the image, each `page_height` rows tall.
         cg_image_t image;
+        int32_t num_pages;
+        int32_t page_height;
 #if defined(_VADER) || defined(_LEIA)
         rb_fence_t image_fence;
 #endif
@@ -147,6 +180,7 @@ mosaic_context_t * mosaic_context_new(
     cg_context_t * const cg_ctx,
     const int32_t width,
     const int32_t height,
+    const int32_t requested_num_pages,
     const mem_region_t font_atlas_lba_region,
     const system_guard_page_mode_e guard_page_mode,
     const char * const tag);
@@ -181,6 +215,27 @@ cg_rect_t mosaic_context_get_text_block_extents(
     float * const out_widest_line,
     const cg_text_block_options_e options);
 
+// Glyph residency of the font atlas, to test packing and page eviction.
+typedef struct mosaic_atlas_stats_t {
+    int32_t num_pages;
+    int32_t page_width;
+    int32_t page_height;
+    // glyph bitmaps currently packed into the atlas
+    int32_t num_resident_glyphs;
+    uint32_t num_page_evictions;
+} mosaic_atlas_stats_t;
+
+mosaic_atlas_stats_t mosaic_context_get_atlas_stats(const mosaic_context_t * const mosaic_ctx);
+
+// Copies the atlas rects (padding excluded) of up to `max_rects` resident glyph bitmaps, returns the number of resident glyphs.
+int32_t mosaic_context_get_resident_glyph_rects(const mosaic_context_t * const mosaic_ctx, cg_int16_rect_t * const out_rects, const int32_t max_rects);
+
+// Rebuilds the layout tables of a loaded font with a kerning table of `kern_table_size` slots, to test lookups against full or missing tables.
+void cg_font_file_rebuild_metrics(struct cg_font_file_t * const font, const int32_t kern_table_size);
+
+// Kerning between two codepoints in unscaled font units, as text layout sees it.
+int32_t cg_font_file_get_kern_advance(struct cg_font_file_t * const font, const int32_t left_codepoint, const int32_t right_codepoint);
+
 cg_text_block_page_offsets_t mosaic_context_get_text_block_page_offsets(
     mosaic_context_t * const mosaic_ctx,
     const cg_rect_t text_rect,
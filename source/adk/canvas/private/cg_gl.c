@@ -32,6 +32,8 @@ canvas rendering backend
 #include "source/adk/experimental/canvas/cg_experimental.h"
 #endif
 
+#include <math.h>
+
 #define TAG_CG_GL FOURCC('C', 'G', 'G', 'L')
 #define CG_GL_SCREEN_SCISSOR_MAX_RANGE 16 * 1024
 
@@ -307,6 +309,8 @@ void cg_gl_texture_bind_two(cg_gl_state_t * const state, const cg_gl_texture_t *
 void cg_gl_texture_update_sampler_state(cg_gl_state_t * const state, cg_gl_texture_t * const tex) {
     CG_GL_TRACE_PUSH_FN();
 
+    cg_gl_state_flush_batch(state);
+
     RENDER_ENSURE_WRITE_CMD_STREAM(
         &state->render_device->default_cmd_stream,
         render_cmd_buf_write_set_texture_sampler_state_indirect,
@@ -325,6 +329,14 @@ void cg_gl_texture_update_sampler_state(cg_gl_state_t * const state, cg_gl_textu
 void cg_gl_texture_free(cg_gl_state_t * const state, cg_gl_texture_t * const tex) {
     CG_GL_TRACE_PUSH_FN();
     if (tex->texture) {
+        cg_gl_state_flush_batch(state);
+
+        // a new texture may be allocated at the same address, make sure it gets bound
+        cg_gl_draw_state_t * const rhi = &state->draw_state.rhi;
+        if ((rhi->fenced_textures[0] == tex->texture) || (rhi->fenced_textures[1] == tex->texture)) {
+            rhi->num_textures = 0;
+        }
+
         render_release(&tex->texture->resource, MALLOC_TAG);
         tex->texture = NULL;
     }
@@ -334,6 +346,8 @@ void cg_gl_texture_free(cg_gl_state_t * const state, cg_gl_texture_t * const tex
 void cg_gl_texture_update(cg_gl_state_t * const state, cg_gl_texture_t * const tex, void * const pixels) {
     CG_GL_TRACE_PUSH_FN();
 
+    cg_gl_state_flush_batch(state);
+
     const int data_len = tex->texture->width * tex->texture->height * tex->texture->channels;
 
     image_mips_t mipmaps;
@@ -367,6 +381,8 @@ void cg_gl_texture_update(cg_gl_state_t * const state, cg_gl_texture_t * const t
 void cg_gl_sub_texture_update(cg_gl_state_t * const state, cg_gl_texture_t * const tex, const image_mips_t image_mips) {
     CG_GL_TRACE_PUSH_FN();
 
+    cg_gl_state_flush_batch(state);
+
     RENDER_ENSURE_WRITE_CMD_STREAM(
         &state->render_device->default_cmd_stream,
         render_cmd_buf_write_upload_sub_texture_indirect,
@@ -386,6 +402,7 @@ void cg_gl_sub_texture_update(cg_gl_state_t * const state, cg_gl_texture_t * con
 void cg_gl_framebuffer_free(cg_gl_state_t * const state, cg_gl_framebuffer_t * const fb) {
     CG_GL_TRACE_PUSH_FN();
     if (fb->render_target) {
+        cg_gl_state_flush_batch(state);
         render_release(&fb->render_target->resource, MALLOC_TAG);
         fb->render_target = NULL;
     }
@@ -395,6 +412,8 @@ void cg_gl_framebuffer_free(cg_gl_state_t * const state, cg_gl_framebuffer_t * c
 void cg_gl_discard_framebuffer(cg_gl_state_t * const state, const cg_gl_framebuffer_t * const fb) {
     CG_GL_TRACE_PUSH_FN();
 
+    cg_gl_state_flush_batch(state);
+
     RENDER_ENSURE_WRITE_CMD_STREAM(
         &state->render_device->default_cmd_stream,
         render_cmd_buf_write_discard_render_target_data_indirect,
@@ -407,6 +426,8 @@ void cg_gl_discard_framebuffer(cg_gl_state_t * const state, const cg_gl_framebuf
 void cg_gl_render_to_framebuffer(cg_gl_state_t * const state, const cg_gl_framebuffer_t * const fb) {
     CG_GL_TRACE_PUSH_FN();
 
+    cg_gl_state_flush_batch(state);
+
     RENDER_ENSURE_WRITE_CMD_STREAM(
         &state->render_device->default_cmd_stream,
         render_cmd_buf_write_set_render_target_indirect,
@@ -425,6 +446,7 @@ void cg_gl_render_to_framebuffer(cg_gl_state_t * const state, const cg_gl_frameb
 void cg_gl_render_to_screen(cg_gl_state_t * const state, const int32_t width, const int32_t height) {
     // TODO: fix viewport
     CG_GL_TRACE_PUSH_FN();
+    cg_gl_state_flush_batch(state);
     {
         const float viewport[] = {(float)width, (float)height};
         cg_gl_set_uniform_vec2(state, rhi_program_uniform_viewport, viewport, MALLOC_TAG);
@@ -518,6 +540,12 @@ void cg_gl_state_init(cg_gl_state_t * const state, cg_heap_t * const cg_heap, re
     ZEROMEM(state);
     state->config = config;
 
+    // each frame in flight may still be drawing from a bank while the next one is written
+    const uint32_t min_vertex_banks = (uint32_t)render_get_max_pending_frames(render_device) + 1;
+    if (state->config.internal_limits.num_vertex_banks < min_vertex_banks) {
+        state->config.internal_limits.num_vertex_banks = min_vertex_banks;
+    }
+
     state->render_device = render_device;
     state->cg_heap = cg_heap;
     state->shaders.color = load_shader_program(
@@ -687,10 +715,41 @@ void cg_gl_state_init(cg_gl_state_t * const state, cg_heap_t * const cg_heap, re
 
         state->mesh_layout = render_create_mesh_data_layout(render_device, desc, MALLOC_TAG);
 
-        state->gl_fences = cg_calloc(cg_heap, sizeof(*state->gl_fences) * config.internal_limits.num_vertex_banks, MALLOC_TAG);
-        state->vertices = cg_alloc(cg_heap, sizeof(*state->vertices) * config.internal_limits.num_vertex_banks, MALLOC_TAG);
-        for (uint32_t i = 0; i < config.internal_limits.num_vertex_banks; ++i) {
-            state->vertices[i] = cg_alloc(cg_heap, sizeof(*state->vertices[i]) * config.internal_limits.max_verts_per_vertex_bank, MALLOC_TAG);
+        state->gl_fences = cg_calloc(cg_heap, sizeof(*state->gl_fences) * state->config.internal_limits.num_vertex_banks, MALLOC_TAG);
+        state->vertices = cg_alloc(cg_heap, sizeof(*state->vertices) * state->config.internal_limits.num_vertex_banks, MALLOC_TAG);
+
+        // streamed banks aren't visible to command diffing, which hashes uploads, and a single bank would be overwritten while drawn from
+        if (config.enable_streaming_vertices && !render_cmd_get_is_rhi_command_diffing_enabled() && (state->config.internal_limits.num_vertex_banks > 1) && (state->config.internal_limits.num_vertex_banks <= rhi_max_mesh_stream_fences)) {
+            verts.usage = rhi_usage_stream;
+            state->stream_mesh_layout = render_create_mesh_data_layout(render_device, desc, MALLOC_TAG);
+
+            const const_mem_region_t stream_null_buffer = {.size = sizeof(cg_gl_vertex_t) * config.internal_limits.max_verts_per_vertex_bank * state->config.internal_limits.num_vertex_banks};
+            rhi_mesh_data_init_indirect_t mi;
+            ZEROMEM(&mi);
+            mi.num_channels = 1;
+            mi.channels = &stream_null_buffer;
+
+            state->stream_mesh = render_create_mesh(render_device, mi, state->stream_mesh_layout, MALLOC_TAG);
+            // blocks until the mesh has been created, so `stream_null_buffer` outlives the command reading it
+            cg_gl_vertex_t * const stream_vertices = render_map_mesh_channel(render_device, state->stream_mesh, 0, MALLOC_TAG);
+
+            if (stream_vertices) {
+                for (uint32_t i = 0; i < state->config.internal_limits.num_vertex_banks; ++i) {
+                    state->vertices[i] = stream_vertices + i * config.internal_limits.max_verts_per_vertex_bank;
+                }
+                state->stream_staging = cg_alloc(cg_heap, sizeof(*state->stream_staging) * config.internal_limits.max_verts_per_vertex_bank, MALLOC_TAG);
+            } else {
+                render_release(&state->stream_mesh->resource, MALLOC_TAG);
+                render_release(&state->stream_mesh_layout->resource, MALLOC_TAG);
+                state->stream_mesh = NULL;
+                state->stream_mesh_layout = NULL;
+            }
+        }
+
+        if (!state->stream_mesh) {
+            for (uint32_t i = 0; i < state->config.internal_limits.num_vertex_banks; ++i) {
+                state->vertices[i] = cg_alloc(cg_heap, sizeof(*state->vertices[i]) * config.internal_limits.max_verts_per_vertex_bank, MALLOC_TAG);
+            }
         }
 
         state->mesh_null_buffer.size = sizeof(cg_gl_vertex_t) * config.internal_limits.max_verts_per_vertex_bank;
@@ -705,6 +764,15 @@ void cg_gl_state_init(cg_gl_state_t * const state, cg_heap_t * const cg_heap, re
         }
     }
 
+    // a batch is uploaded to its own mesh while the range it was built from may still be drawn
+    state->config.enable_draw_batching = config.enable_draw_batching && (config.internal_limits.num_meshes > 1);
+    if (!state->stream_mesh) {
+        state->batch.vertices = cg_alloc(cg_heap, sizeof(cg_gl_vertex_t) * config.internal_limits.max_verts_per_vertex_bank, MALLOC_TAG);
+    }
+
+    state->draw_state.canvas.blend = state->bs_blend_off_color_write_mask_rgb;
+    state->draw_state.canvas.depth_stencil = state->dss_stencil_off;
+
 #ifdef _CANVAS_EXPERIMENTAL
     cg_experimental_init(state, cg_heap, render_device);
 #endif
@@ -720,10 +788,20 @@ void cg_gl_state_free(cg_gl_state_t * const state) {
 #endif
 
     cg_free(state->cg_heap, state->gl_fences, MALLOC_TAG);
-    for (uint32_t i = 0; i < state->config.internal_limits.num_vertex_banks; ++i) {
-        cg_free(state->cg_heap, state->vertices[i], MALLOC_TAG);
+    if (state->stream_mesh) {
+        // the banks are unmapped with the mesh
+        render_release(&state->stream_mesh->resource, MALLOC_TAG);
+        render_release(&state->stream_mesh_layout->resource, MALLOC_TAG);
+        cg_free(state->cg_heap, state->stream_staging, MALLOC_TAG);
+    } else {
+        for (uint32_t i = 0; i < state->config.internal_limits.num_vertex_banks; ++i) {
+            cg_free(state->cg_heap, state->vertices[i], MALLOC_TAG);
+        }
     }
     cg_free(state->cg_heap, state->vertices, MALLOC_TAG);
+    if (state->batch.vertices) {
+        cg_free(state->cg_heap, state->batch.vertices, MALLOC_TAG);
+    }
 
     cg_gl_texture_free(state, &state->white);
     render_release(&state->shaders.color->resource, MALLOC_TAG);
@@ -771,6 +849,13 @@ void cg_gl_state_free(cg_gl_state_t * const state) {
 void cg_gl_state_begin(cg_gl_state_t * const state, const int width, const int height, uint32_t clear_color) {
     CG_GL_TRACE_PUSH_FN();
 
+    ASSERT(state->batch.num_draws == 0);
+
+    // anything may have been rendered since the last frame, forget what the RHI has bound
+    ZEROMEM(&state->draw_state.rhi);
+    state->draw_state.rhi_fill_valid = false;
+    state->draw_state.rhi_threshold_valid = false;
+
     // render to state->screen
     cg_gl_render_to_screen(state, width, height);
 
@@ -799,184 +884,199 @@ void cg_gl_state_begin(cg_gl_state_t * const state, const int width, const int h
         0,
         MALLOC_TAG);
 
+    state->scissor.rhi.enabled = false;
+    state->draw_state.canvas.blend = state->draw_state.rhi.blend = state->bs_blend_off_color_write_mask_rgb;
+    state->draw_state.canvas.depth_stencil = state->draw_state.rhi.depth_stencil = state->dss_stencil_off;
+
     CG_GL_TRACE_POP();
 }
 
 void cg_gl_state_end(cg_gl_state_t * const state) {
+    cg_gl_state_flush_batch(state);
 }
 
-void cg_gl_state_bind_color_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex) {
-    CG_GL_TRACE_PUSH_FN();
-
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.color->program,
-        MALLOC_TAG);
-
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
-    cg_gl_texture_bind(state, (tex == NULL) ? &state->white : tex);
+/* ------------------------------------------------------------------------- */
 
-    CG_GL_TRACE_POP();
+static bool cg_gl_program_uses_threshold(const cg_gl_state_t * const state, const r_program_t * const program) {
+    return (program == state->shaders.color_alpha_test) || (program == state->shaders.color_alpha_test_rgb_fill_alpha_red);
 }
 
-void cg_gl_state_bind_color_rgb_fill_alpha_red_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex) {
-    CG_GL_TRACE_PUSH_FN();
-
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.color_rgb_fill_alpha_red->program,
-        MALLOC_TAG);
-
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
-    cg_gl_texture_bind(state, (tex == NULL) ? &state->white : tex);
-
-    CG_GL_TRACE_POP();
+static void cg_gl_set_program(cg_gl_state_t * const state, r_program_t * const program, const cg_color_t * const fill, const bool batchable) {
+    cg_gl_draw_state_t * const draw_state = &state->draw_state.canvas;
+    draw_state->program = program;
+    draw_state->fill = *fill;
+    draw_state->batchable = batchable;
 }
 
-void cg_gl_state_bind_color_shader_alpha_mask(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const cg_gl_texture_t * const mask) {
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.color_alpha_mask->program,
-        MALLOC_TAG);
+static void cg_gl_set_textures(cg_gl_state_t * const state, const cg_gl_texture_t * const tex0, const cg_gl_texture_t * const tex1) {
+    cg_gl_draw_state_t * const draw_state = &state->draw_state.canvas;
+    const cg_gl_texture_t * const textures[] = {(tex0 == NULL) ? &state->white : tex0, tex1};
 
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
-    cg_gl_texture_bind_two(state, (tex == NULL) ? &state->white : tex, (mask == NULL) ? &state->white : mask);
+    draw_state->num_textures = (tex1 == NULL) ? 1 : 2;
+    for (int i = 0; i < draw_state->num_textures; ++i) {
+        draw_state->textures[i] = &textures[i]->texture->texture;
+        draw_state->fenced_textures[i] = textures[i]->texture;
+    }
 }
 
-void cg_gl_state_bind_color_shader_alpha_test(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const float threshold) {
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.color_alpha_test->program,
-        MALLOC_TAG);
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
-    cg_gl_set_uniform_float(state, rhi_program_uniform_threshold, threshold, MALLOC_TAG);
-    cg_gl_texture_bind(state, (tex == NULL) ? &state->white : tex);
+static void cg_gl_set_raw_textures(cg_gl_state_t * const state, rhi_texture_t * const * const tex0, rhi_texture_t * const * const tex1) {
+    cg_gl_draw_state_t * const draw_state = &state->draw_state.canvas;
+    draw_state->num_textures = (tex1 == NULL) ? 1 : 2;
+    draw_state->textures[0] = tex0;
+    draw_state->textures[1] = tex1;
+    draw_state->fenced_textures[0] = draw_state->fenced_textures[1] = NULL;
 }
 
-void cg_gl_state_bind_color_shader_alpha_rgb_fill_alpha_red_test(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const float threshold) {
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.color_alpha_test_rgb_fill_alpha_red->program,
-        MALLOC_TAG);
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
-    cg_gl_set_uniform_float(state, rhi_program_uniform_threshold, threshold, MALLOC_TAG);
-    cg_gl_texture_bind(state, (tex == NULL) ? &state->white : tex);
+static bool cg_gl_same_textures(const cg_gl_draw_state_t * const a, const cg_gl_draw_state_t * const b) {
+    return (a->num_textures == b->num_textures) && (a->textures[0] == b->textures[0]) && ((a->num_textures < 2) || (a->textures[1] == b->textures[1]));
 }
 
-void cg_gl_state_bind_color_shader_raw(cg_gl_state_t * const state, const cg_color_t * const fill, rhi_texture_t * const * const tex) {
-    CG_GL_TRACE_PUSH_FN();
-
-    ASSERT(tex);
-
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.color->program,
-        MALLOC_TAG);
-
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
-    cg_gl_texture_bind_raw(state, tex);
+static bool cg_gl_same_scissor(const cg_gl_scissor_state_t * const a, const cg_gl_scissor_state_t * const b) {
+    return (a->enabled == b->enabled) && (!a->enabled || ((a->x0 == b->x0) && (a->y0 == b->y0) && (a->x1 == b->x1) && (a->y1 == b->y1)));
+}
 
-    CG_GL_TRACE_POP();
+static bool cg_gl_can_batch_with(const cg_gl_state_t * const state, const cg_gl_batch_t * const batch) {
+    const cg_gl_draw_state_t * const a = &batch->draw_state;
+    const cg_gl_draw_state_t * const b = &state->draw_state.canvas;
+
+    return (a->program == b->program)
+           && (memcmp(&a->fill, &b->fill, sizeof(a->fill)) == 0)
+           && (!cg_gl_program_uses_threshold(state, a->program) || (a->threshold == b->threshold))
+           && cg_gl_same_textures(a, b)
+           && (a->blend == b->blend)
+           && (a->depth_stencil == b->depth_stencil)
+           && cg_gl_same_scissor(&batch->scissor, &state->scissor.canvas);
 }
 
-void cg_gl_state_bind_video_shader(cg_gl_state_t * const state, const cg_color_t * const fill, rhi_texture_t * const * const chroma, rhi_texture_t * const * const luma, const cg_ivec2_t luma_tex_dim, const cg_ivec2_t chroma_tex_dim, const cg_ivec2_t framesize_dim) {
+static void cg_gl_write_scissor_state(cg_gl_state_t * const state, const cg_gl_scissor_state_t * const scissor) {
     CG_GL_TRACE_PUSH_FN();
 
-    ASSERT(chroma && luma);
-
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.video->program,
-        MALLOC_TAG);
+    if (scissor->enabled && (state->scissor.rhi.x0 != scissor->x0 || state->scissor.rhi.y0 != scissor->y0 || state->scissor.rhi.x1 != scissor->x1 || state->scissor.rhi.y1 != scissor->y1)) {
+        RENDER_ENSURE_WRITE_CMD_STREAM(
+            &state->render_device->default_cmd_stream,
+            render_cmd_buf_write_set_scissor_rect,
+            scissor->x0,
+            scissor->y0,
+            scissor->x1,
+            scissor->y1,
+            MALLOC_TAG);
 
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
+        state->scissor.rhi.x0 = scissor->x0;
+        state->scissor.rhi.y0 = scissor->y0;
+        state->scissor.rhi.x1 = scissor->x1;
+        state->scissor.rhi.y1 = scissor->y1;
+    }
 
-    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_ltexsize, (const int[]){luma_tex_dim.x, luma_tex_dim.y}, MALLOC_TAG);
-    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_ctexsize, (const int[]){chroma_tex_dim.x, chroma_tex_dim.y}, MALLOC_TAG);
-    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_framesize, (const int[]){framesize_dim.x, framesize_dim.y}, MALLOC_TAG);
+    if (state->scissor.rhi.enabled != scissor->enabled) {
+        RENDER_ENSURE_WRITE_CMD_STREAM(
+            &state->render_device->default_cmd_stream,
+            render_cmd_buf_write_set_render_state_indirect,
+            scissor->enabled ? &state->rs_scissor_on->rasterizer_state : &state->rs_scissor_off->rasterizer_state,
+            NULL,
+            NULL,
+            0,
+            MALLOC_TAG);
 
-    cg_gl_texture_bind_raw_two(state, chroma, luma);
+        state->scissor.rhi.enabled = scissor->enabled;
+    }
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_bind_video_shader_hdr(cg_gl_state_t * const state, const cg_color_t * const fill, rhi_texture_t * const * const chroma, rhi_texture_t * const * const luma, const cg_ivec2_t luma_tex_dim, const cg_ivec2_t chroma_tex_dim, const cg_ivec2_t framesize_dim) {
+// Writes the parts of `draw_state` that differ from what the RHI has bound
+static void cg_gl_write_draw_state(cg_gl_state_t * const state, const cg_gl_draw_state_t * const draw_state) {
     CG_GL_TRACE_PUSH_FN();
 
-    ASSERT(chroma && luma);
-    ASSERT(&state->shaders.video_hdr);
+    cg_gl_draw_state_t * const rhi = &state->draw_state.rhi;
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.video_hdr->program,
-        MALLOC_TAG);
+    ASSERT(draw_state->blend && draw_state->depth_stencil);
+    if ((draw_state->blend != rhi->blend) || (draw_state->depth_stencil != rhi->depth_stencil)) {
+        RENDER_ENSURE_WRITE_CMD_STREAM(
+            &state->render_device->default_cmd_stream,
+            render_cmd_buf_write_set_render_state_indirect,
+            NULL,
+            (draw_state->depth_stencil != rhi->depth_stencil) ? &draw_state->depth_stencil->depth_stencil_state : NULL,
+            (draw_state->blend != rhi->blend) ? &draw_state->blend->blend_state : NULL,
+            0,
+            MALLOC_TAG);
 
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
+        rhi->blend = draw_state->blend;
+        rhi->depth_stencil = draw_state->depth_stencil;
+    }
 
-    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_ltexsize, (const int[]){luma_tex_dim.x, luma_tex_dim.y}, MALLOC_TAG);
-    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_ctexsize, (const int[]){chroma_tex_dim.x, chroma_tex_dim.y}, MALLOC_TAG);
-    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_framesize, (const int[]){framesize_dim.x, framesize_dim.y}, MALLOC_TAG);
+    ASSERT(draw_state->program);
+    if (draw_state->program != rhi->program) {
+        RENDER_ENSURE_WRITE_CMD_STREAM(
+            &state->render_device->default_cmd_stream,
+            render_cmd_buf_write_set_program_indirect,
+            &draw_state->program->program,
+            MALLOC_TAG);
 
-    cg_gl_texture_bind_raw_two(state, chroma, luma);
+        rhi->program = draw_state->program;
+    }
 
-    CG_GL_TRACE_POP();
-}
+    if (!state->draw_state.rhi_fill_valid || (memcmp(&draw_state->fill, &rhi->fill, sizeof(rhi->fill)) != 0)) {
+        cg_gl_set_uniform_color(state, rhi_program_uniform_fill, &draw_state->fill, MALLOC_TAG);
+        rhi->fill = draw_state->fill;
+        state->draw_state.rhi_fill_valid = true;
+    }
 
-void cg_gl_state_bind_sdf_rect_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const cg_sdf_rect_uniforms_t uniforms) {
-    CG_GL_TRACE_PUSH_FN();
+    if (cg_gl_program_uses_threshold(state, draw_state->program) && (!state->draw_state.rhi_threshold_valid || (draw_state->threshold != rhi->threshold))) {
+        cg_gl_set_uniform_float(state, rhi_program_uniform_threshold, draw_state->threshold, MALLOC_TAG);
+        rhi->threshold = draw_state->threshold;
+        state->draw_state.rhi_threshold_valid = true;
+    }
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.sdf_rect->program,
-        MALLOC_TAG);
+    // raw textures are owned elsewhere and may be recreated at the same address, always rebind them
+    if (!cg_gl_same_textures(draw_state, rhi) || (draw_state->fenced_textures[0] == NULL)) {
+        if (draw_state->num_textures == 2) {
+            cg_gl_texture_bind_raw_two(state, draw_state->textures[0], draw_state->textures[1]);
+        } else {
+            cg_gl_texture_bind_raw(state, draw_state->textures[0]);
+        }
 
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
-    const float rect[] = {uniforms.box.centerpoint.x, uniforms.box.centerpoint.y, uniforms.box.half_dim.x, uniforms.box.half_dim.y};
-    cg_gl_set_uniform_vec4(state, rhi_program_uniform_rect, rect, MALLOC_TAG);
-    cg_gl_set_uniform_float(state, rhi_program_uniform_rect_roundness, uniforms.roundness, MALLOC_TAG);
-    cg_gl_set_uniform_float(state, rhi_program_uniform_fade, uniforms.fade, MALLOC_TAG);
+        rhi->num_textures = draw_state->num_textures;
+        rhi->textures[0] = draw_state->textures[0];
+        rhi->textures[1] = draw_state->textures[1];
+        rhi->fenced_textures[0] = draw_state->fenced_textures[0];
+        rhi->fenced_textures[1] = draw_state->fenced_textures[1];
+    }
 
-    cg_gl_texture_bind(state, (tex == NULL) ? &state->white : tex);
+    // update fences so we don't cg_free the textures before the draw is processed
+    for (int i = 0; i < draw_state->num_textures; ++i) {
+        if (draw_state->fenced_textures[i]) {
+            draw_state->fenced_textures[i]->resource.fence = render_get_cmd_stream_fence(&state->render_device->default_cmd_stream);
+        }
+    }
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_bind_sdf_rect_border_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const struct cg_sdf_rect_border_uniforms_t uniforms) {
-    CG_GL_TRACE_PUSH_FN();
-
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_program_indirect,
-        &state->shaders.sdf_rect_border->program,
-        MALLOC_TAG);
-
-    cg_gl_set_uniform_color(state, rhi_program_uniform_fill, fill, MALLOC_TAG);
-    const float rect[] = {uniforms.sdf_rect_uniforms.box.centerpoint.x, uniforms.sdf_rect_uniforms.box.centerpoint.y, uniforms.sdf_rect_uniforms.box.half_dim.x, uniforms.sdf_rect_uniforms.box.half_dim.y};
-    cg_gl_set_uniform_vec4(state, rhi_program_uniform_rect, rect, MALLOC_TAG);
-    cg_gl_set_uniform_vec4(state, rhi_program_uniform_stroke_color, (float *)&uniforms.stroke_color, MALLOC_TAG);
-    cg_gl_set_uniform_float(state, rhi_program_uniform_stroke_size, uniforms.stroke_size, MALLOC_TAG);
-    cg_gl_set_uniform_float(state, rhi_program_uniform_rect_roundness, uniforms.sdf_rect_uniforms.roundness, MALLOC_TAG);
-    cg_gl_set_uniform_float(state, rhi_program_uniform_fade, uniforms.sdf_rect_uniforms.fade, MALLOC_TAG);
+// Screen area covered by `vertices`, empty unless the RHI diffs commands (dirty region tracking is the only reader)
+rhi_rect_t cg_gl_vertex_bounds(const cg_gl_vertex_t * const vertices, const int count) {
+    if ((count <= 0) || !render_cmd_get_is_rhi_command_diffing_enabled()) {
+        return (rhi_rect_t){0};
+    }
 
-    cg_gl_texture_bind(state, (tex == NULL) ? &state->white : tex);
+    float x0 = vertices[0].x, y0 = vertices[0].y, x1 = x0, y1 = y0;
+    for (int i = 1; i < count; ++i) {
+        x0 = (vertices[i].x < x0) ? vertices[i].x : x0;
+        y0 = (vertices[i].y < y0) ? vertices[i].y : y0;
+        x1 = (vertices[i].x > x1) ? vertices[i].x : x1;
+        y1 = (vertices[i].y > y1) ? vertices[i].y : y1;
+    }
 
-    CG_GL_TRACE_POP();
+    // a pixel of slack for antialiasing and rounding
+    return (rhi_rect_t){
+        .x0 = (int)floorf(x0) - 1,
+        .y0 = (int)floorf(y0) - 1,
+        .x1 = (int)ceilf(x1) + 1,
+        .y1 = (int)ceilf(y1) + 1};
 }
 
-void cg_gl_state_draw_mesh(cg_gl_state_t * const state, r_mesh_t * const mesh, const rhi_draw_mode_e prim, const int count, const int offset) {
+static void cg_gl_write_draw(cg_gl_state_t * const state, r_mesh_t * const mesh, const rhi_draw_mode_e prim, const int count, const int offset, const int num_batched_draws, const rhi_rect_t bounds) {
     CG_GL_TRACE_PUSH_FN();
 
-    cg_gl_apply_scissor_state(state);
-
     rhi_draw_params_indirect_t draw_params;
 
     struct {
@@ -995,6 +1095,10 @@ void cg_gl_state_draw_mesh(cg_gl_state_t * const state, r_mesh_t * const mesh, c
     draw_params.mesh_list = &draw_single_mesh->mesh;
     draw_params.mode = prim;
     draw_params.num_meshes = 1;
+    draw_params.num_batched_draws = num_batched_draws;
+    draw_params.bounds = bounds;
+    // raw textures (video) change without going through the command stream
+    draw_params.dynamic_content = (state->draw_state.rhi.num_textures > 0) && (state->draw_state.rhi.fenced_textures[0] == NULL);
 
     draw_single_mesh->idx_ofs = offset;
     draw_single_mesh->elm_count = count;
@@ -1021,215 +1125,482 @@ void cg_gl_state_draw_mesh(cg_gl_state_t * const state, r_mesh_t * const mesh, c
         VERIFY(render_cmd_buf_write_draw_indirect(state->render_device->default_cmd_stream.buf, draw_params, MALLOC_TAG));
     }
 
-    state->meshes[state->cur_mesh]->resource.fence = render_get_cmd_stream_fence(&state->render_device->default_cmd_stream);
+    mesh->resource.fence = render_get_cmd_stream_fence(&state->render_device->default_cmd_stream);
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_draw(cg_gl_state_t * const state, const rhi_draw_mode_e prim, const int count, const int offset) {
-    ASSERT(!state->map_count);
-    cg_gl_state_draw_mesh(state, state->meshes[state->cur_mesh], prim, count, offset);
-}
-
-cg_gl_vertex_t * cg_gl_state_map_vertex_range(cg_gl_state_t * const state, const int count) {
+// Returns the offset of `count` free vertices in the active bank, moving to the next bank if they don't fit
+static int cg_gl_reserve_vertices(cg_gl_state_t * const state, const int count) {
     CG_GL_TRACE_PUSH_FN();
 
-    ++state->cur_mesh;
-    if ((uint32_t)state->cur_mesh >= state->config.internal_limits.num_meshes) {
-        state->cur_mesh = 0;
-    }
+    ASSERT((uint32_t)count <= state->config.internal_limits.max_verts_per_vertex_bank);
 
-    state->map_count = count;
+    if ((uint32_t)(state->map_ofs + count) > state->config.internal_limits.max_verts_per_vertex_bank) {
+        // overflow, flush this vertex bank.
+        const int next_bank = (state->active_bank + 1) % state->config.internal_limits.num_vertex_banks;
+
+        if (state->stream_mesh) {
+            // only the active bank is drawn from, fence it as we leave. The render thread waits out the gpu reads of
+            // the bank after the next one, which was fenced when it was last left, and the fence of this command tells
+            // us when that bank can be written. With two banks that is the bank we are leaving.
+            const int wait_bank = (next_bank + 1) % state->config.internal_limits.num_vertex_banks;
+            render_cmd_stream_fence_mesh_stream(&state->render_device->default_cmd_stream, state->stream_mesh, state->active_bank, wait_bank, MALLOC_TAG);
+            state->gl_fences[wait_bank] = render_get_cmd_stream_fence(&state->render_device->default_cmd_stream);
+        }
 
-    const int vertex_ofs = state->vertex_ofs = state->map_ofs;
+        // make sure we have flushed the previous buffer before we start writing here, the fence of the next bank
+        // was recorded when we last moved off it or the bank before it, so this doesn't wait on the commands just written
 
-    if ((uint32_t)(vertex_ofs + count) <= state->config.internal_limits.max_verts_per_vertex_bank) {
-        const int bank = state->active_bank;
-        ASSERT((bank >= 0) && ((uint32_t)bank < state->config.internal_limits.num_vertex_banks));
-        CG_GL_TRACE_POP();
-        return &state->vertices[bank][vertex_ofs];
-    }
+        render_conditional_flush_cmd_stream_and_wait_fence(
+            state->render_device,
+            &state->render_device->default_cmd_stream,
+            state->gl_fences[next_bank]);
 
-    // overflow, flush this vertex bank.
-    const int active_bank = state->active_bank;
-    const int next_bank = (active_bank + 1) % state->config.internal_limits.num_vertex_banks;
+        // no need to copy partial verts from current buffer...
 
-    // make sure we have flushed the previous buffer before we start writing here...
+        state->vertex_ofs = 0;
+        state->map_ofs = 0;
+        state->active_bank = next_bank;
+    }
 
-    render_conditional_flush_cmd_stream_and_wait_fence(
-        state->render_device,
-        &state->render_device->default_cmd_stream,
-        state->gl_fences[next_bank]);
+    ASSERT((state->active_bank >= 0) && ((uint32_t)state->active_bank < state->config.internal_limits.num_vertex_banks));
 
-    // no need to copy partial verts from current buffer...
+    CG_GL_TRACE_POP();
+    return state->map_ofs;
+}
 
-    state->vertex_ofs = 0;
-    state->map_ofs = 0;
-    state->active_bank = next_bank;
+// Copies `count` vertices into the active streamed bank and returns the stream mesh, `mesh_ofs` receives the first vertex of the copy in it.
+static r_mesh_t * cg_gl_stream_vertices(cg_gl_state_t * const state, const cg_gl_vertex_t * const src, const int count, int * const mesh_ofs) {
+    CG_GL_TRACE_PUSH_FN();
+    ASSERT(state->stream_mesh);
 
-    ASSERT((uint32_t)count <= state->config.internal_limits.max_verts_per_vertex_bank);
+    const int ofs = cg_gl_reserve_vertices(state, count);
+    memcpy(&state->vertices[state->active_bank][ofs], src, sizeof(cg_gl_vertex_t) * count);
+    state->map_ofs = ofs + count;
+    *mesh_ofs = state->active_bank * state->config.internal_limits.max_verts_per_vertex_bank + ofs;
 
     CG_GL_TRACE_POP();
-    return &state->vertices[next_bank][0];
-}
-
-void cg_gl_state_finish_vertex_range(cg_gl_state_t * const state) {
-    ASSERT(state->map_count > 0);
-    cg_gl_state_finish_vertex_range_with_count(state, state->map_count);
+    return state->stream_mesh;
 }
 
-void cg_gl_state_finish_vertex_range_with_count(cg_gl_state_t * const state, const int count) {
+// Uploads vertices from a bank into the next mesh and returns the mesh, `mesh_ofs` receives the first vertex of the upload in it.
+static r_mesh_t * cg_gl_upload_vertices(cg_gl_state_t * const state, const int bank, const int ofs, const int count, int * const mesh_ofs) {
     CG_GL_TRACE_PUSH_FN();
+    ASSERT(!state->stream_mesh);
 
-    ASSERT((state->map_count > 0) && (count <= state->map_count));
-    state->map_count = 0;
+    *mesh_ofs = 0;
 
-    // move the bank watermark forward
-    ASSERT(state->map_ofs < state->vertex_ofs + count);
+    ++state->cur_mesh;
+    if ((uint32_t)state->cur_mesh >= state->config.internal_limits.num_meshes) {
+        state->cur_mesh = 0;
+    }
 
-    state->map_ofs = state->vertex_ofs + count;
-    const int bank = state->active_bank;
-    const float * const data = (float *)&state->vertices[bank][state->vertex_ofs];
+    r_mesh_t * const mesh = state->meshes[state->cur_mesh];
 
     const int channel_index = 0;
     const int first_elem = 0;
-    const int num_elems = state->map_ofs - state->vertex_ofs;
     const size_t stride = sizeof(cg_gl_vertex_t);
 
-    const uint32_t hash = render_cmd_stream_upload_mesh_channel_data(
+    mesh->hash = render_cmd_stream_upload_mesh_channel_data(
         &state->render_device->default_cmd_stream,
-        &state->meshes[state->cur_mesh]->mesh,
+        &mesh->mesh,
         channel_index,
         first_elem,
-        num_elems,
+        count,
         stride,
-        data,
+        (const float *)&state->vertices[bank][ofs],
         MALLOC_TAG);
 
-    state->meshes[state->cur_mesh]->hash = hash;
     state->gl_fences[bank] = render_get_cmd_stream_fence(&state->render_device->default_cmd_stream);
 
     CG_GL_TRACE_POP();
+    return mesh;
 }
 
-void cg_gl_state_set_mode_blend_off(cg_gl_state_t * const state) {
+// Where the batch is built, streamed batches are written in place in the active bank
+static cg_gl_vertex_t * cg_gl_batch_vertices(const cg_gl_state_t * const state) {
+    return state->stream_mesh ? &state->vertices[state->active_bank][state->batch.ofs] : state->batch.vertices;
+}
+
+void cg_gl_state_flush_batch(cg_gl_state_t * const state) {
+    cg_gl_batch_t * const batch = &state->batch;
+    if (batch->num_draws == 0) {
+        return;
+    }
+
     CG_GL_TRACE_PUSH_FN();
+    ASSERT(!state->map_count);
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_render_state_indirect,
-        NULL,
-        NULL,
-        &state->bs_blend_off_color_write_mask_rgb->blend_state,
-        0,
-        MALLOC_TAG);
+    int mesh_ofs;
+    r_mesh_t * mesh;
+    if (state->stream_mesh) {
+        mesh = state->stream_mesh;
+        mesh_ofs = state->active_bank * state->config.internal_limits.max_verts_per_vertex_bank + batch->ofs;
+    } else {
+        const int ofs = cg_gl_reserve_vertices(state, batch->num_vertices);
+        memcpy(&state->vertices[state->active_bank][ofs], batch->vertices, sizeof(cg_gl_vertex_t) * batch->num_vertices);
+        state->map_ofs = ofs + batch->num_vertices;
+        mesh = cg_gl_upload_vertices(state, state->active_bank, ofs, batch->num_vertices, &mesh_ofs);
+    }
+
+    cg_gl_write_scissor_state(state, &batch->scissor);
+    cg_gl_write_draw_state(state, &batch->draw_state);
+    cg_gl_write_draw(state, mesh, rhi_triangles, batch->num_vertices, mesh_ofs, batch->num_draws, cg_gl_vertex_bounds(cg_gl_batch_vertices(state), batch->num_vertices));
+
+    batch->num_vertices = 0;
+    batch->num_draws = 0;
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_set_mode_blend_alpha_rgb(cg_gl_state_t * const state) {
+// The vertices of the last range, only staged ranges are read back from streamed banks
+static const cg_gl_vertex_t * cg_gl_last_range_vertices(const cg_gl_state_t * const state) {
+    return state->last_range.staged ? state->stream_staging : &state->vertices[state->last_range.bank][state->last_range.ofs];
+}
+
+static int cg_gl_num_batched_vertices(const rhi_draw_mode_e prim, const int count) {
+    switch (prim) {
+        case rhi_triangles:
+            return count - (count % 3);
+        case rhi_triangle_strip:
+        case rhi_triangle_fan:
+            return (count >= 3) ? (count - 2) * 3 : 0;
+        default:
+            return -1;
+    }
+}
+
+// Appends the draw to the batch as a triangle list, keeping each triangle's winding for the stencil passes
+static void cg_gl_batch_draw(cg_gl_state_t * const state, const rhi_draw_mode_e prim, const int count, const int offset) {
+    cg_gl_batch_t * const batch = &state->batch;
+    const cg_gl_vertex_t * const src = cg_gl_last_range_vertices(state) + offset;
+    cg_gl_vertex_t * const batch_vertices = cg_gl_batch_vertices(state);
+    cg_gl_vertex_t * dst = &batch_vertices[batch->num_vertices];
+
+    switch (prim) {
+        case rhi_triangles:
+            memcpy(dst, src, sizeof(cg_gl_vertex_t) * (count - (count % 3)));
+            dst += count - (count % 3);
+            break;
+        case rhi_triangle_strip:
+            for (int i = 0; i < count - 2; ++i) {
+                // odd triangles of a strip are wound the other way
+                *dst++ = src[(i & 1) ? i + 1 : i];
+                *dst++ = src[(i & 1) ? i : i + 1];
+                *dst++ = src[i + 2];
+            }
+            break;
+        case rhi_triangle_fan:
+            for (int i = 1; i < count - 1; ++i) {
+                *dst++ = src[0];
+                *dst++ = src[i];
+                *dst++ = src[i + 1];
+            }
+            break;
+        default:
+            TRAP("unbatchable draw mode");
+    }
+
+    batch->num_vertices = (int)(dst - batch_vertices);
+    ++batch->num_draws;
+}
+
+void cg_gl_state_bind_color_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex) {
+    cg_gl_set_program(state, state->shaders.color, fill, true);
+    cg_gl_set_textures(state, tex, NULL);
+}
+
+void cg_gl_state_bind_color_rgb_fill_alpha_red_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex) {
+    cg_gl_set_program(state, state->shaders.color_rgb_fill_alpha_red, fill, true);
+    cg_gl_set_textures(state, tex, NULL);
+}
+
+void cg_gl_state_bind_color_shader_alpha_mask(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const cg_gl_texture_t * const mask) {
+    cg_gl_set_program(state, state->shaders.color_alpha_mask, fill, true);
+    cg_gl_set_textures(state, tex, (mask == NULL) ? &state->white : mask);
+}
+
+void cg_gl_state_bind_color_shader_alpha_test(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const float threshold) {
+    cg_gl_set_program(state, state->shaders.color_alpha_test, fill, true);
+    state->draw_state.canvas.threshold = threshold;
+    cg_gl_set_textures(state, tex, NULL);
+}
+
+void cg_gl_state_bind_color_shader_alpha_rgb_fill_alpha_red_test(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const float threshold) {
+    cg_gl_set_program(state, state->shaders.color_alpha_test_rgb_fill_alpha_red, fill, true);
+    state->draw_state.canvas.threshold = threshold;
+    cg_gl_set_textures(state, tex, NULL);
+}
+
+void cg_gl_state_bind_color_shader_raw(cg_gl_state_t * const state, const cg_color_t * const fill, rhi_texture_t * const * const tex) {
+    ASSERT(tex);
+
+    cg_gl_set_program(state, state->shaders.color, fill, true);
+    cg_gl_set_raw_textures(state, tex, NULL);
+}
+
+void cg_gl_state_bind_video_shader(cg_gl_state_t * const state, const cg_color_t * const fill, rhi_texture_t * const * const chroma, rhi_texture_t * const * const luma, const cg_ivec2_t luma_tex_dim, const cg_ivec2_t chroma_tex_dim, const cg_ivec2_t framesize_dim) {
     CG_GL_TRACE_PUSH_FN();
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_render_state_indirect,
-        NULL,
-        NULL,
-        &state->bs_blend_alpha_color_write_mask_rgb->blend_state,
-        0,
-        MALLOC_TAG);
+    ASSERT(chroma && luma);
+
+    cg_gl_state_flush_batch(state);
+    cg_gl_set_program(state, state->shaders.video, fill, false);
+    cg_gl_set_raw_textures(state, chroma, luma);
+    cg_gl_write_draw_state(state, &state->draw_state.canvas);
+
+    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_ltexsize, (const int[]){luma_tex_dim.x, luma_tex_dim.y}, MALLOC_TAG);
+    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_ctexsize, (const int[]){chroma_tex_dim.x, chroma_tex_dim.y}, MALLOC_TAG);
+    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_framesize, (const int[]){framesize_dim.x, framesize_dim.y}, MALLOC_TAG);
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_set_mode_blend_alpha_all(cg_gl_state_t * const state) {
+void cg_gl_state_bind_video_shader_hdr(cg_gl_state_t * const state, const cg_color_t * const fill, rhi_texture_t * const * const chroma, rhi_texture_t * const * const luma, const cg_ivec2_t luma_tex_dim, const cg_ivec2_t chroma_tex_dim, const cg_ivec2_t framesize_dim) {
     CG_GL_TRACE_PUSH_FN();
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_render_state_indirect,
-        NULL,
-        NULL,
-        &state->bs_blend_alpha_color_write_mask_all->blend_state,
-        0,
-        MALLOC_TAG);
+    ASSERT(chroma && luma);
+    ASSERT(&state->shaders.video_hdr);
+
+    cg_gl_state_flush_batch(state);
+    cg_gl_set_program(state, state->shaders.video_hdr, fill, false);
+    cg_gl_set_raw_textures(state, chroma, luma);
+    cg_gl_write_draw_state(state, &state->draw_state.canvas);
+
+    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_ltexsize, (const int[]){luma_tex_dim.x, luma_tex_dim.y}, MALLOC_TAG);
+    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_ctexsize, (const int[]){chroma_tex_dim.x, chroma_tex_dim.y}, MALLOC_TAG);
+    cg_gl_set_uniform_ivec2(state, rhi_program_uniform_framesize, (const int[]){framesize_dim.x, framesize_dim.y}, MALLOC_TAG);
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_set_mode_blit(cg_gl_state_t * const state) {
+void cg_gl_state_bind_sdf_rect_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const cg_sdf_rect_uniforms_t uniforms) {
     CG_GL_TRACE_PUSH_FN();
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_render_state_indirect,
-        NULL,
-        NULL,
-        &state->bs_blend_blit->blend_state,
-        0,
-        MALLOC_TAG);
+    cg_gl_state_flush_batch(state);
+    cg_gl_set_program(state, state->shaders.sdf_rect, fill, false);
+    cg_gl_set_textures(state, tex, NULL);
+    cg_gl_write_draw_state(state, &state->draw_state.canvas);
+
+    const float rect[] = {uniforms.box.centerpoint.x, uniforms.box.centerpoint.y, uniforms.box.half_dim.x, uniforms.box.half_dim.y};
+    cg_gl_set_uniform_vec4(state, rhi_program_uniform_rect, rect, MALLOC_TAG);
+    cg_gl_set_uniform_float(state, rhi_program_uniform_rect_roundness, uniforms.roundness, MALLOC_TAG);
+    cg_gl_set_uniform_float(state, rhi_program_uniform_fade, uniforms.fade, MALLOC_TAG);
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_set_mode_stencil_off(cg_gl_state_t * const state) {
+void cg_gl_state_bind_sdf_rect_border_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const struct cg_sdf_rect_border_uniforms_t uniforms) {
     CG_GL_TRACE_PUSH_FN();
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_render_state_indirect,
-        NULL,
-        &state->dss_stencil_off->depth_stencil_state,
-        NULL,
-        0,
-        MALLOC_TAG);
+    cg_gl_state_flush_batch(state);
+    cg_gl_set_program(state, state->shaders.sdf_rect_border, fill, false);
+    cg_gl_set_textures(state, tex, NULL);
+    cg_gl_write_draw_state(state, &state->draw_state.canvas);
+
+    const float rect[] = {uniforms.sdf_rect_uniforms.box.centerpoint.x, uniforms.sdf_rect_uniforms.box.centerpoint.y, uniforms.sdf_rect_uniforms.box.half_dim.x, uniforms.sdf_rect_uniforms.box.half_dim.y};
+    cg_gl_set_uniform_vec4(state, rhi_program_uniform_rect, rect, MALLOC_TAG);
+    cg_gl_set_uniform_vec4(state, rhi_program_uniform_stroke_color, (float *)&uniforms.stroke_color, MALLOC_TAG);
+    cg_gl_set_uniform_float(state, rhi_program_uniform_stroke_size, uniforms.stroke_size, MALLOC_TAG);
+    cg_gl_set_uniform_float(state, rhi_program_uniform_rect_roundness, uniforms.sdf_rect_uniforms.roundness, MALLOC_TAG);
+    cg_gl_set_uniform_float(state, rhi_program_uniform_fade, uniforms.sdf_rect_uniforms.fade, MALLOC_TAG);
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_set_mode_stencil_accum(cg_gl_state_t * const state) {
+void cg_gl_state_draw_mesh_in_bounds(cg_gl_state_t * const state, r_mesh_t * const mesh, const rhi_draw_mode_e prim, const int count, const int offset, const rhi_rect_t bounds) {
+    cg_gl_state_flush_batch(state);
+    cg_gl_write_scissor_state(state, &state->scissor.canvas);
+    cg_gl_write_draw_state(state, &state->draw_state.canvas);
+    cg_gl_write_draw(state, mesh, prim, count, offset, 0, bounds);
+}
+
+void cg_gl_state_draw_mesh(cg_gl_state_t * const state, r_mesh_t * const mesh, const rhi_draw_mode_e prim, const int count, const int offset) {
     CG_GL_TRACE_PUSH_FN();
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_render_state_indirect,
-        NULL,
-        &state->dss_stencil_accum->depth_stencil_state,
-        &state->bs_blend_off_color_write_mask_none->blend_state,
-        0,
-        MALLOC_TAG);
+    // vertices of external meshes aren't visible here, the draw covers the whole screen (or scissor)
+    cg_gl_state_draw_mesh_in_bounds(state, mesh, prim, count, offset, (rhi_rect_t){0});
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_set_mode_stencil_eq(cg_gl_state_t * const state) {
+void cg_gl_state_draw(cg_gl_state_t * const state, const rhi_draw_mode_e prim, const int count, const int offset) {
     CG_GL_TRACE_PUSH_FN();
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_render_state_indirect,
-        NULL,
-        &state->dss_stencil_eq->depth_stencil_state,
-        &state->bs_blend_alpha_color_write_mask_rgb->blend_state,
-        0,
-        MALLOC_TAG);
+    ASSERT(!state->map_count);
+    ASSERT(offset + count <= state->last_range.count);
+
+    // ranges written in place in a streamed bank can't be read back to batch them
+    const bool batchable = state->config.enable_draw_batching && state->draw_state.canvas.batchable && (!state->stream_mesh || state->last_range.staged);
+    const int num_batched_vertices = batchable ? cg_gl_num_batched_vertices(prim, count) : -1;
+    if ((num_batched_vertices >= 0) && ((uint32_t)num_batched_vertices <= state->config.internal_limits.max_verts_per_vertex_bank)) {
+        cg_gl_batch_t * const batch = &state->batch;
+        if ((batch->num_draws > 0) && (!cg_gl_can_batch_with(state, batch) || ((uint32_t)(batch->ofs + batch->num_vertices + num_batched_vertices) > state->config.internal_limits.max_verts_per_vertex_bank))) {
+            cg_gl_state_flush_batch(state);
+        }
+
+        if (batch->num_draws == 0) {
+            batch->draw_state = state->draw_state.canvas;
+            batch->scissor = state->scissor.canvas;
+            if (state->stream_mesh) {
+                // nothing else is reserved in the bank until the batch is flushed, so it can grow in place
+                batch->ofs = cg_gl_reserve_vertices(state, num_batched_vertices);
+            }
+        }
+
+        cg_gl_batch_draw(state, prim, count, offset);
+        if (state->stream_mesh) {
+            state->map_ofs = batch->ofs + batch->num_vertices;
+        }
+    } else {
+        if (state->stream_mesh) {
+            cg_gl_state_flush_batch(state);
+            if (state->last_range.staged) {
+                // copy the range out of staging, again if a flush has since fenced the bank it was copied to
+                if (!state->last_range.uploaded || (state->last_range.bank != state->active_bank)) {
+                    state->last_range.mesh = cg_gl_stream_vertices(state, state->stream_staging, state->last_range.count, &state->last_range.mesh_ofs);
+                    state->last_range.bank = state->active_bank;
+                    state->last_range.uploaded = true;
+                }
+            } else {
+                // written in place, no bank switch can happen before its draws
+                ASSERT(state->last_range.uploaded && (state->last_range.bank == state->active_bank));
+            }
+        } else if (!state->last_range.uploaded) {
+            // upload before flushing the batch, the flush may reuse the bank when there is only one
+            state->last_range.mesh = cg_gl_upload_vertices(state, state->last_range.bank, state->last_range.ofs, state->last_range.count, &state->last_range.mesh_ofs);
+            state->last_range.uploaded = true;
+        }
+        const rhi_rect_t bounds = cg_gl_vertex_bounds(cg_gl_last_range_vertices(state) + offset, count);
+        cg_gl_state_draw_mesh_in_bounds(state, state->last_range.mesh, prim, count, state->last_range.mesh_ofs + offset, bounds);
+    }
 
     CG_GL_TRACE_POP();
 }
 
-void cg_gl_state_set_mode_stencil_neq(cg_gl_state_t * const state) {
+static cg_gl_vertex_t * cg_gl_map_vertex_range(cg_gl_state_t * const state, const int count, const bool staged) {
     CG_GL_TRACE_PUSH_FN();
 
-    RENDER_ENSURE_WRITE_CMD_STREAM(
-        &state->render_device->default_cmd_stream,
-        render_cmd_buf_write_set_render_state_indirect,
-        NULL,
-        &state->dss_stencil_neq->depth_stencil_state,
-        NULL,
-        0,
-        MALLOC_TAG);
+    if (state->stream_mesh) {
+        ASSERT((uint32_t)count <= state->config.internal_limits.max_verts_per_vertex_bank);
+        if (staged) {
+            // the last range was copied into the batch or a bank, its staging space is free
+            state->map_count = count;
+            state->map_staged = true;
+            state->vertex_ofs = 0;
+            CG_GL_TRACE_POP();
+            return state->stream_staging;
+        }
+
+        // an open batch grows in place in the active bank, it is drawn before the range is written after it
+        cg_gl_state_flush_batch(state);
+        state->map_count = count;
+        state->map_staged = false;
+        state->vertex_ofs = cg_gl_reserve_vertices(state, count);
+        CG_GL_TRACE_POP();
+        return &state->vertices[state->active_bank][state->vertex_ofs];
+    }
+
+    // vertices of the last range were copied into the batch, reuse their space
+    if (!state->last_range.uploaded && (state->last_range.bank == state->active_bank) && (state->last_range.ofs + state->last_range.count == state->map_ofs)) {
+        state->map_ofs = state->last_range.ofs;
+        state->last_range.count = 0;
+    }
+
+    state->map_count = count;
+    state->vertex_ofs = cg_gl_reserve_vertices(state, count);
 
     CG_GL_TRACE_POP();
+    return &state->vertices[state->active_bank][state->vertex_ofs];
+}
+
+cg_gl_vertex_t * cg_gl_state_map_vertex_range(cg_gl_state_t * const state, const int count) {
+    // batching reads the range back, which streamed banks can't be
+    return cg_gl_map_vertex_range(state, count, state->config.enable_draw_batching);
+}
+
+cg_gl_vertex_t * cg_gl_state_map_unbatched_vertex_range(cg_gl_state_t * const state, const int count) {
+    return cg_gl_map_vertex_range(state, count, false);
+}
+
+void cg_gl_state_finish_vertex_range(cg_gl_state_t * const state) {
+    ASSERT(state->map_count > 0);
+    cg_gl_state_finish_vertex_range_with_count(state, state->map_count);
+}
+
+void cg_gl_state_finish_vertex_range_with_count(cg_gl_state_t * const state, const int count) {
+    CG_GL_TRACE_PUSH_FN();
+
+    ASSERT((state->map_count > 0) && (count <= state->map_count));
+    state->map_count = 0;
+
+    if (state->stream_mesh && state->map_staged) {
+        // the bank is picked when the range is copied out of staging
+        state->last_range.bank = -1;
+        state->last_range.ofs = 0;
+        state->last_range.count = count;
+        state->last_range.uploaded = false;
+        state->last_range.staged = true;
+        CG_GL_TRACE_POP();
+        return;
+    }
+
+    // move the bank watermark forward
+    ASSERT(state->map_ofs < state->vertex_ofs + count);
+
+    state->map_ofs = state->vertex_ofs + count;
+
+    state->last_range.bank = state->active_bank;
+    state->last_range.ofs = state->vertex_ofs;
+    state->last_range.count = count;
+    state->last_range.staged = false;
+
+    if (state->stream_mesh) {
+        // written in place, the range is drawn from the bank as is
+        state->last_range.mesh = state->stream_mesh;
+        state->last_range.mesh_ofs = state->active_bank * state->config.internal_limits.max_verts_per_vertex_bank + state->vertex_ofs;
+        state->last_range.uploaded = true;
+    } else {
+        // the upload is deferred until a draw can't be batched
+        state->last_range.uploaded = false;
+    }
+
+    CG_GL_TRACE_POP();
+}
+
+void cg_gl_state_set_mode_blend_off(cg_gl_state_t * const state) {
+    state->draw_state.canvas.blend = state->bs_blend_off_color_write_mask_rgb;
+}
+
+void cg_gl_state_set_mode_blend_alpha_rgb(cg_gl_state_t * const state) {
+    state->draw_state.canvas.blend = state->bs_blend_alpha_color_write_mask_rgb;
+}
+
+void cg_gl_state_set_mode_blend_alpha_all(cg_gl_state_t * const state) {
+    state->draw_state.canvas.blend = state->bs_blend_alpha_color_write_mask_all;
+}
+
+void cg_gl_state_set_mode_blit(cg_gl_state_t * const state) {
+    state->draw_state.canvas.blend = state->bs_blend_blit;
+}
+
+void cg_gl_state_set_mode_stencil_off(cg_gl_state_t * const state) {
+    state->draw_state.canvas.depth_stencil = state->dss_stencil_off;
+}
+
+void cg_gl_state_set_mode_stencil_accum(cg_gl_state_t * const state) {
+    state->draw_state.canvas.depth_stencil = state->dss_stencil_accum;
+    state->draw_state.canvas.blend = state->bs_blend_off_color_write_mask_none;
+}
+
+void cg_gl_state_set_mode_stencil_eq(cg_gl_state_t * const state) {
+    state->draw_state.canvas.depth_stencil = state->dss_stencil_eq;
+    state->draw_state.canvas.blend = state->bs_blend_alpha_color_write_mask_rgb;
+}
+
+void cg_gl_state_set_mode_stencil_neq(cg_gl_state_t * const state) {
+    state->draw_state.canvas.depth_stencil = state->dss_stencil_neq;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1250,36 +1621,6 @@ void cg_gl_enable_scissor(cg_gl_state_t * const state, const bool enabled) {
 }
 
 void cg_gl_apply_scissor_state(cg_gl_state_t * const state) {
-    CG_GL_TRACE_PUSH_FN();
-
-    if (state->scissor.canvas.enabled && (state->scissor.rhi.x0 != state->scissor.canvas.x0 || state->scissor.rhi.y0 != state->scissor.canvas.y0 || state->scissor.rhi.x1 != state->scissor.canvas.x1 || state->scissor.rhi.y1 != state->scissor.canvas.y1)) {
-        RENDER_ENSURE_WRITE_CMD_STREAM(
-            &state->render_device->default_cmd_stream,
-            render_cmd_buf_write_set_scissor_rect,
-            state->scissor.canvas.x0,
-            state->scissor.canvas.y0,
-            state->scissor.canvas.x1,
-            state->scissor.canvas.y1,
-            MALLOC_TAG);
-
-        state->scissor.rhi.x0 = state->scissor.canvas.x0;
-        state->scissor.rhi.y0 = state->scissor.canvas.y0;
-        state->scissor.rhi.x1 = state->scissor.canvas.x1;
-        state->scissor.rhi.y1 = state->scissor.canvas.y1;
-    }
-
-    if (state->scissor.rhi.enabled != state->scissor.canvas.enabled) {
-        RENDER_ENSURE_WRITE_CMD_STREAM(
-            &state->render_device->default_cmd_stream,
-            render_cmd_buf_write_set_render_state_indirect,
-            state->scissor.canvas.enabled ? &state->rs_scissor_on->rasterizer_state : &state->rs_scissor_off->rasterizer_state,
-            NULL,
-            NULL,
-            0,
-            MALLOC_TAG);
-
-        state->scissor.rhi.enabled = state->scissor.canvas.enabled;
-    }
-
-    CG_GL_TRACE_POP();
+    cg_gl_state_flush_batch(state);
+    cg_gl_write_scissor_state(state, &state->scissor.canvas);
 }
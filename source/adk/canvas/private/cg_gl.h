@@ -56,6 +56,35 @@ typedef struct cg_gl_scissor_state_t {
 
 /* ------------------------------------------------------------------------- */
 
+// Render state a draw depends on. The bind/set_mode calls only record it, it is written to the
+// command stream when a draw needs it and it differs from what was written last.
+typedef struct cg_gl_draw_state_t {
+    r_program_t * program;
+    cg_color_t fill;
+    float threshold;
+    rhi_texture_t * const * textures[2];
+    // bumped to the command stream fence when bound, NULL for raw textures
+    r_texture_t * fenced_textures[2];
+    int num_textures;
+    r_blend_state_t * blend;
+    r_depth_stencil_state_t * depth_stencil;
+    // shaders with per-draw uniforms (sdf, video) are written by their bind call and never batched
+    bool batchable;
+} cg_gl_draw_state_t;
+
+// Consecutive draws with the same state are merged into one triangle list, uploaded and drawn once.
+typedef struct cg_gl_batch_t {
+    // NULL when streaming, the batch is then built in place in the active bank starting at `ofs`
+    cg_gl_vertex_t * vertices;
+    int ofs;
+    int num_vertices;
+    int num_draws;
+    cg_gl_draw_state_t draw_state;
+    cg_gl_scissor_state_t scissor;
+} cg_gl_batch_t;
+
+/* ------------------------------------------------------------------------- */
+
 struct cg_heap_t;
 
 typedef struct cg_gl_state_t {
@@ -68,8 +97,31 @@ typedef struct cg_gl_state_t {
     int map_ofs;
     int vertex_ofs;
     int map_count;
+    // the mapped range is written to `stream_staging` instead of the active bank
+    bool map_staged;
     int cur_mesh;
 
+    // Vertex range of the last finish_vertex_range call, only uploaded when a draw can't be batched
+    struct {
+        int bank;
+        int ofs;
+        int count;
+        r_mesh_t * mesh;
+        // first vertex of the range in `mesh`
+        int mesh_ofs;
+        bool uploaded;
+        // the range is in `stream_staging`, it is copied into the active bank if a draw can't batch it
+        bool staged;
+    } last_range;
+
+    // When set the vertex banks are regions of this persistently mapped mesh and are drawn
+    // from in place instead of being uploaded, `gl_fences` then track the gpu reads of each bank.
+    r_mesh_t * stream_mesh;
+    r_mesh_data_layout_t * stream_mesh_layout;
+    // The banks are write-combined memory that is only ever written to. Ranges that may be batched are mapped
+    // here since batching reads them back, everything else is written to the active bank and drawn in place.
+    cg_gl_vertex_t * stream_staging;
+
     render_device_t * render_device;
 
     struct {
@@ -114,6 +166,15 @@ typedef struct cg_gl_state_t {
         cg_gl_scissor_state_t rhi; // The scissor state that has been sent to the RHI
         cg_gl_scissor_state_t canvas; // The scissor state requested by the canvas
     } scissor;
+
+    struct {
+        cg_gl_draw_state_t rhi; // The draw state that has been sent to the RHI
+        cg_gl_draw_state_t canvas; // The draw state requested by the canvas
+        bool rhi_fill_valid;
+        bool rhi_threshold_valid;
+    } draw_state;
+
+    cg_gl_batch_t batch;
 } cg_gl_state_t;
 
 /* ------------------------------------------------------------------------- */
@@ -167,10 +228,19 @@ void cg_gl_state_begin(cg_gl_state_t * const state, const int width, const int h
 
 void cg_gl_state_end(cg_gl_state_t * const state);
 
+// Writes the pending batch to the command stream, call before writing to the default command stream directly.
+void cg_gl_state_flush_batch(cg_gl_state_t * const state);
+
 void cg_gl_state_draw(cg_gl_state_t * const state, const rhi_draw_mode_e prim, const int count, const int offset);
 
 void cg_gl_state_draw_mesh(cg_gl_state_t * const state, r_mesh_t * const mesh, const rhi_draw_mode_e prim, const int count, const int offset);
 
+// Same as `cg_gl_state_draw_mesh` for meshes whose screen bounds are known, see `cg_gl_vertex_bounds`.
+void cg_gl_state_draw_mesh_in_bounds(cg_gl_state_t * const state, r_mesh_t * const mesh, const rhi_draw_mode_e prim, const int count, const int offset, const rhi_rect_t bounds);
+
+// Screen bounds of `vertices` for dirty region tracking, empty (the whole screen) when RHI command diffing is disabled.
+rhi_rect_t cg_gl_vertex_bounds(const cg_gl_vertex_t * const vertices, const int count);
+
 static inline void cg_gl_state_draw_points(cg_gl_state_t * const state, const int count, const int offset) {
     cg_gl_state_draw(state, rhi_triangles, count, offset);
 }
@@ -203,6 +273,8 @@ void cg_gl_state_bind_sdf_rect_shader(cg_gl_state_t * const state, const cg_colo
 void cg_gl_state_bind_sdf_rect_border_shader(cg_gl_state_t * const state, const cg_color_t * const fill, const cg_gl_texture_t * const tex, const struct cg_sdf_rect_border_uniforms_t uniforms);
 
 cg_gl_vertex_t * cg_gl_state_map_vertex_range(cg_gl_state_t * const state, const int count);
+// For ranges drawn with shaders that are never batched (sdf, video), when streaming they are written straight into the mapped bank
+cg_gl_vertex_t * cg_gl_state_map_unbatched_vertex_range(cg_gl_state_t * const state, const int count);
 void cg_gl_state_finish_vertex_range(cg_gl_state_t * const state);
 void cg_gl_state_finish_vertex_range_with_count(cg_gl_state_t * const state, const int count);
 
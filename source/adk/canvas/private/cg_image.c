@@ -81,7 +81,9 @@ void cg_context_image_free(cg_image_t * const image, const char * const tag) {
         cg_gl_texture_free(image->cg_ctx->gl, &image->cg_texture);
         cg_free(&image->cg_ctx->cg_heap_low, image, tag);
     } else {
+        // the decode is skipped if it hasn't started, the upload completion call frees the image
         image->status = cg_image_async_load_aborted;
+        thread_pool_cancel(image->cg_ctx->thread_pool, image->decode_job);
     }
 }
 
@@ -235,6 +237,7 @@ static void rhi_upload_job_main_thread(void * void_user, thread_pool_t * const p
 
     image_load_data_t * const user = void_user;
     cg_context_t * const cg_ctx = user->cg_image->cg_ctx;
+    user->cg_image->decode_job = (thread_pool_job_handle_t){0};
 
 #ifdef CG_IMAGE_TIME_LOGGING
     user->rhi_delay_end = sb_read_nanosecond_clock();
@@ -409,7 +412,7 @@ static void image_decode_job(void * void_user, thread_pool_t * const pool) {
     CG_IMAGE_TIME_SPAN_END(user->url);
 #endif
 
-    if (user->cg_image->status != cg_image_async_load_pending) {
+    if ((user->cg_image->status != cg_image_async_load_pending) || thread_pool_current_job_is_cancelled(pool)) {
         return;
     }
 
@@ -632,6 +635,16 @@ any character length for forward compatability.
 This function will return -1 if there is no X-BAMTECH-ERROR header detected and
 0 if it can't parse the X-BAMTECH-ERROR header.
 */
+static void submit_image_decode_job(image_load_data_t * const user) {
+    cg_image_t * const image = user->cg_image;
+    const thread_pool_job_desc_t desc = {
+        .job = image_decode_job,
+        .completion_call = rhi_upload_job_main_thread,
+        .user = user,
+        .priority = image->load_priority};
+    image->decode_job = thread_pool_submit(image->cg_ctx->thread_pool, &desc);
+}
+
 static int32_t check_for_ripcut_error(mem_region_t header) {
     static const char http_header_key_bamtech_error[] = "X-BAMTECH-ERROR:";
     const char * const ripcut_header = strstr((const char *)header.byte_ptr, http_header_key_bamtech_error);
@@ -720,7 +733,7 @@ static void url_image_http_fetch_complete(adk_curl_handle_t * const handle, cons
             CG_IMAGE_TIME_SPAN_BEGIN(user->url, "[decode-delay] %s", user->url);
             user->decode_delay_start = sb_read_nanosecond_clock();
 #endif
-            thread_pool_enqueue(user->cg_image->cg_ctx->thread_pool, image_decode_job, rhi_upload_job_main_thread, user);
+            submit_image_decode_job(user);
         }
 
     } else {
@@ -834,6 +847,7 @@ cg_image_t * cg_context_load_image_async(const char * const file_location, const
     image_load_data->cg_image->cg_ctx = ctx;
     image_load_data->cg_image->num_frames = 1;
     image_load_data->cg_image->status = cg_image_async_load_pending;
+    image_load_data->cg_image->load_priority = thread_pool_priority_normal;
 
     {
         // keep URL for error reporting
@@ -870,7 +884,7 @@ cg_image_t * cg_context_load_image_async(const char * const file_location, const
         CG_IMAGE_TIME_SPAN_BEGIN(image_load_data->url, "[decode-delay] %s", image_load_data->url);
         image_load_data->decode_delay_start = sb_read_nanosecond_clock();
 #endif
-        thread_pool_enqueue(ctx->thread_pool, image_decode_job, rhi_upload_job_main_thread, image_load_data);
+        submit_image_decode_job(image_load_data);
     }
 
     return image_load_data->cg_image;
@@ -904,6 +918,12 @@ void cg_context_set_image_animation_state(cg_image_t * const image, const cg_ima
     image->image_animation_state = image_animation_state;
 }
 
+void cg_context_image_set_load_priority(cg_image_t * const image, const thread_pool_priority_e priority) {
+    ASSERT_IS_MAIN_THREAD();
+    image->load_priority = priority;
+    thread_pool_set_priority(image->cg_ctx->thread_pool, image->decode_job, priority);
+}
+
 int32_t cg_get_image_ripcut_error_code(const cg_image_t * const image) {
     return image->ripcut_error_code;
 }
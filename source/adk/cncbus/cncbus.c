@@ -114,6 +114,9 @@ enum {
 
 STATIC_ASSERT(first_msg_frag_size > 0);
 STATIC_ASSERT(message_fragment_size > sizeof(cncbus_msg_data_t));
+// routes store the matching receivers as a bitmask
+STATIC_ASSERT(cncbus_max_receivers <= 32);
+STATIC_ASSERT((cncbus_route_cache_size & (cncbus_route_cache_size - 1)) == 0);
 STATIC_ASSERT(IS_ALIGNED(sizeof(cncbus_msg_data_t), 8));
 
 static void set_msg_guard(cncbus_msg_t * const msg) {
@@ -168,6 +171,7 @@ void cncbus_init(cncbus_t * const bus, const mem_region_t region, const system_g
         }
 
         bus->internal.free_receiver_msg_chain = last;
+        bus->internal.num_free_msg_chains = bus->internal.min_free_msg_chains = num_receiver_chains;
         {
             for (int i = 1; i < num_receiver_chains; ++i) {
                 cncbus_receiver_msg_chain_t * next;
@@ -201,6 +205,7 @@ void cncbus_init(cncbus_t * const bus, const mem_region_t region, const system_g
         VERIFY(msg_frag_region.size >= sizeof(cncbus_msg_frag_t));
         const int num_frags = (int)(msg_frag_region.size / sizeof(cncbus_msg_frag_t));
         bus->internal.alloc_msg_frags_count = num_frags;
+        bus->internal.num_free_msg_frags = bus->internal.min_free_msg_frags = num_frags;
 
         cncbus_msg_frag_t * last;
 #ifdef GUARD_PAGE_SUPPORT
@@ -240,6 +245,8 @@ void cncbus_init(cncbus_t * const bus, const mem_region_t region, const system_g
             last->next = NULL;
         }
     }
+
+    bus->internal.dispatch_batch_size = cncbus_default_dispatch_batch_size;
 }
 
 void cncbus_destroy(cncbus_t * const bus) {
@@ -289,7 +296,7 @@ typedef enum bus_hazard_e {
 
 typedef enum receiver_hazard_e {
     receiver_hazard_none = 0,
-    receiver_hazard_access_msg_chain = 1,
+    // held by the receiver queue's single consumer
     receiver_hazard_dispatch = 2,
     receiver_hazard_destroyed = 4
 } receiver_hazard_e;
@@ -358,6 +365,8 @@ static cncbus_msg_frag_t * bus_get_free_msg_frag(cncbus_t * const bus) {
 
     if (frag) {
         bus->internal.free_msg_frag_chain = frag->next;
+        --bus->internal.num_free_msg_frags;
+        bus->internal.min_free_msg_frags = min_int(bus->internal.min_free_msg_frags, bus->internal.num_free_msg_frags);
     }
 
     sb_atomic_store(&bus->internal.free_msg_chain_hazard, 0, memory_order_release);
@@ -366,12 +375,18 @@ static cncbus_msg_frag_t * bus_get_free_msg_frag(cncbus_t * const bus) {
 }
 
 static void bus_release_msg_frag_chain(cncbus_t * const bus, cncbus_msg_frag_t * const head, cncbus_msg_frag_t * const tail) {
+    int num_frags = 1;
+    for (cncbus_msg_frag_t * frag = head; frag != tail; frag = frag->next) {
+        ++num_frags;
+    }
+
     // grab head element hazard
     while (sb_atomic_cas(&bus->internal.free_msg_chain_hazard, 1, 0, memory_order_acquire) != 0) {
     }
 
     tail->next = bus->internal.free_msg_frag_chain;
     bus->internal.free_msg_frag_chain = head;
+    bus->internal.num_free_msg_frags += num_frags;
 
     sb_atomic_store(&bus->internal.free_msg_chain_hazard, 0, memory_order_release);
 }
@@ -385,6 +400,8 @@ static cncbus_receiver_msg_chain_t * bus_get_free_msg_chain(cncbus_t * const bus
     if (chain) {
         // store next
         bus->internal.free_receiver_msg_chain = chain->next;
+        --bus->internal.num_free_msg_chains;
+        bus->internal.min_free_msg_chains = min_int(bus->internal.min_free_msg_chains, bus->internal.num_free_msg_chains);
     }
 
     sb_atomic_store(&bus->internal.free_receiver_msg_chain_hazard, 0, memory_order_release);
@@ -392,28 +409,33 @@ static cncbus_receiver_msg_chain_t * bus_get_free_msg_chain(cncbus_t * const bus
     return chain;
 }
 
+// drops a reference to the message, the last reference signals the sender and frees the message fragments
+static void bus_release_msg_data(cncbus_t * const bus, cncbus_msg_data_t * const msg_data) {
+    check_msg_guard(&msg_data->cursor);
+
+    if (sb_atomic_fetch_add(&msg_data->ref_count, -1, memory_order_relaxed) == 1) {
+        // signal requested
+        if (msg_data->signal) {
+            sb_lock_mutex(msg_data->signal->mutex);
+            msg_data->signal->signaled = 1;
+            // ideally this wake would be outside the mutex to
+            // prevent a wake-sleep event occuring, but that risks
+            // the signal data or condition being destroyed
+            // when we try and access it outside the mutex
+            sb_condition_wake_all(msg_data->signal->condition);
+            sb_unlock_mutex(msg_data->signal->mutex);
+        }
+
+        bus_release_msg_frag_chain(bus, msg_data->frag_head, msg_data->frag_tail);
+    }
+}
+
 static void bus_release_msg_chain(cncbus_t * const bus, cncbus_receiver_msg_chain_t * msg) {
     cncbus_receiver_msg_chain_t * next;
     for (; msg; msg = next) {
         next = msg->next;
 
-        check_msg_guard(&msg->msg_data->cursor);
-
-        if (sb_atomic_fetch_add(&msg->msg_data->ref_count, -1, memory_order_relaxed) == 1) {
-            // signal requested
-            if (msg->msg_data->signal) {
-                sb_lock_mutex(msg->msg_data->signal->mutex);
-                msg->msg_data->signal->signaled = 1;
-                // ideally this wake would be outside the mutex to
-                // prevent a wake-sleep event occuring, but that risks
-                // the signal data or condition being destroyed
-                // when we try and access it outside the mutex
-                sb_condition_wake_all(msg->msg_data->signal->condition);
-                sb_unlock_mutex(msg->msg_data->signal->mutex);
-            }
-
-            bus_release_msg_frag_chain(bus, msg->msg_data->frag_head, msg->msg_data->frag_tail);
-        }
+        bus_release_msg_data(bus, msg->msg_data);
 
         // grab head element hazard
         while (sb_atomic_cas(&bus->internal.free_receiver_msg_chain_hazard, 1, 0, memory_order_acquire) != 0) {
@@ -421,11 +443,147 @@ static void bus_release_msg_chain(cncbus_t * const bus, cncbus_receiver_msg_chai
 
         msg->next = bus->internal.free_receiver_msg_chain;
         bus->internal.free_receiver_msg_chain = msg;
+        ++bus->internal.num_free_msg_chains;
 
         sb_atomic_store(&bus->internal.free_receiver_msg_chain_hazard, 0, memory_order_release);
     }
 }
 
+/*
+===============================================================================
+Receiver queue
+
+Intrusive multi-producer/single-consumer queue (Vyukov). Producers swap
+themselves in as the new head and then link the previous head to them, the
+consumer walks from the tail. A stub link keeps the queue non-empty so
+producers never touch the tail.
+
+Between a producer's swap and its link the queue looks empty past the previous
+head, `num_pending` tells the consumer a message is on its way.
+===============================================================================
+*/
+
+static void * atomic_exchange_ptr(sb_atomic_ptr_t * const x, void * const value) {
+    void * expected = sb_atomic_load_ptr(x, memory_order_relaxed);
+    for (;;) {
+        void * const prev = sb_atomic_cas_ptr(x, value, expected, memory_order_seq_cst);
+        if (prev == expected) {
+            return prev;
+        }
+        expected = prev;
+    }
+}
+
+static void receiver_queue_init(cncbus_receiver_t * const receiver) {
+    ZEROMEM(&receiver->internal.queue_stub);
+    sb_atomic_store_ptr(&receiver->internal.queue_head, &receiver->internal.queue_stub, memory_order_relaxed);
+    receiver->internal.queue_tail = &receiver->internal.queue_stub;
+}
+
+static void receiver_queue_link(cncbus_receiver_t * const receiver, cncbus_receiver_msg_chain_t * const chain) {
+    sb_atomic_store_ptr(&chain->queue_next, NULL, memory_order_relaxed);
+    cncbus_receiver_msg_chain_t * const prev = atomic_exchange_ptr(&receiver->internal.queue_head, chain);
+    sb_atomic_store_ptr(&prev->queue_next, chain, memory_order_release);
+}
+
+// any thread
+static void receiver_queue_push(cncbus_receiver_t * const receiver, cncbus_receiver_msg_chain_t * const chain) {
+    const int num_pending = sb_atomic_fetch_add(&receiver->internal.num_pending, 1, memory_order_relaxed) + 1;
+    sb_atomic_fetch_add(&receiver->internal.num_queued, 1, memory_order_relaxed);
+
+    int max_pending = sb_atomic_load(&receiver->internal.max_pending, memory_order_relaxed);
+    while (num_pending > max_pending) {
+        const int prev = sb_atomic_cas(&receiver->internal.max_pending, num_pending, max_pending, memory_order_relaxed);
+        if (prev == max_pending) {
+            break;
+        }
+        max_pending = prev;
+    }
+
+    receiver_queue_link(receiver, chain);
+}
+
+// consumer only, returns NULL if the queue is empty or the next message is still being linked
+static cncbus_receiver_msg_chain_t * receiver_queue_pop(cncbus_receiver_t * const receiver) {
+    cncbus_receiver_msg_chain_t * const stub = &receiver->internal.queue_stub;
+    cncbus_receiver_msg_chain_t * tail = receiver->internal.queue_tail;
+    cncbus_receiver_msg_chain_t * next = sb_atomic_load_ptr(&tail->queue_next, memory_order_acquire);
+
+    if (tail == stub) {
+        if (!next) {
+            return NULL;
+        }
+        receiver->internal.queue_tail = tail = next;
+        next = sb_atomic_load_ptr(&tail->queue_next, memory_order_acquire);
+    }
+
+    if (!next) {
+        if (tail != sb_atomic_load_ptr(&receiver->internal.queue_head, memory_order_acquire)) {
+            // a producer swapped in a new head but hasn't linked it yet
+            return NULL;
+        }
+        // `tail` is the last message, put the stub behind it so it can be unlinked
+        receiver_queue_link(receiver, stub);
+        next = sb_atomic_load_ptr(&tail->queue_next, memory_order_acquire);
+        if (!next) {
+            return NULL;
+        }
+    }
+
+    receiver->internal.queue_tail = next;
+    sb_atomic_fetch_add(&receiver->internal.num_pending, -1, memory_order_relaxed);
+    tail->next = NULL;
+    return tail;
+}
+
+// takes the consumer side of the receiver queue, fails if it is being dispatched or the receiver is disconnecting
+static bool receiver_try_enter_consumer(cncbus_receiver_t * const receiver) {
+    const int flags = sb_atomic_fetch_or(&receiver->internal.hazard, receiver_hazard_dispatch, memory_order_acquire);
+    if (flags & receiver_hazard_dispatch) {
+        return false;
+    }
+    if (flags & receiver_hazard_destroyed) {
+        atomic_clear(&receiver->internal.hazard, receiver_hazard_dispatch, memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+// runs up to `max_messages` queued messages through the receiver, caller is the queue consumer.
+// returns the number of messages dispatched, *out_in_flight is set if the queue stopped on a message still being linked
+static int receiver_dispatch(cncbus_t * const bus, cncbus_receiver_t * const receiver, const int max_messages, bool * const out_in_flight) {
+#ifdef _CNCBUS_DEBUG_GUARDS
+    VERIFY(sb_atomic_fetch_add(&receiver->internal.access_count, 1, memory_order_relaxed) == 0);
+#endif
+
+    int num_dispatched = 0;
+    while (num_dispatched < max_messages) {
+        cncbus_receiver_msg_chain_t * const chain = receiver_queue_pop(receiver);
+        if (!chain) {
+            *out_in_flight = sb_atomic_load(&receiver->internal.num_pending, memory_order_relaxed) > 0;
+            break;
+        }
+
+        cncbus_msg_t cursor;
+        ZEROMEM(&cursor);
+        cursor.internal.msg_data = chain->msg_data;
+        cursor.internal.frag_ofs = first_msg_frag_ofs;
+        cursor.internal.frag = chain->msg_data->frag_head;
+
+        check_msg_guard(&chain->msg_data->cursor);
+        receiver->internal.vtable->on_msg_recv(receiver, chain->msg_data->header, &cursor);
+        bus_release_msg_chain(bus, chain);
+        ++num_dispatched;
+    }
+
+    receiver->internal.num_dispatched += num_dispatched;
+
+#ifdef _CNCBUS_DEBUG_GUARDS
+    VERIFY(sb_atomic_fetch_add(&receiver->internal.access_count, -1, memory_order_relaxed) == 1);
+#endif
+    return num_dispatched;
+}
+
 cncbus_dispatch_result_e cncbus_dispatch(cncbus_t * const bus, const cncbus_dispatch_mode_e mode) {
     if (!bus_try_enter_read_hazard(bus)) {
         return cncbus_dispatch_busy;
@@ -436,77 +594,44 @@ cncbus_dispatch_result_e cncbus_dispatch(cncbus_t * const bus, const cncbus_disp
     int num_receivers = bus->internal.num_receivers;
     bool all_busy = num_receivers > 0;
     bool read_hazard = true;
+    bool in_flight = false;
 
     for (int i = 0; i < num_receivers; ++i) {
         const int idx = sb_atomic_fetch_add(&bus->internal.next_dispatch_slot, 1, memory_order_relaxed) % num_receivers;
         cncbus_receiver_t * const receiver = bus->internal.receivers[idx];
 
         // try and get dispatch access to the receiver
-        if (atomic_test_and_set(&receiver->internal.hazard, receiver_hazard_dispatch, 0, memory_order_relaxed)) {
+        if (atomic_test_and_set(&receiver->internal.hazard, receiver_hazard_dispatch, 0, memory_order_acquire)) {
             all_busy = false;
 
             // safe for other threads to modify receivers[]
             bus_exit_read_hazard(bus);
             read_hazard = false;
 
-            // acquire message chain hazard
-            while (!atomic_test_and_set(&receiver->internal.hazard, receiver_hazard_access_msg_chain, 0, memory_order_acquire)) {
+            int max_messages;
+            switch (mode) {
+                case cncbus_dispatch_single_message:
+                    max_messages = 1;
+                    break;
+                case cncbus_dispatch_batch:
+                    max_messages = bus->internal.dispatch_batch_size;
+                    break;
+                default:
+                    ASSERT(mode == cncbus_dispatch_flush);
+                    // only what is pending now, so senders can't keep a flush going forever
+                    max_messages = max_int(sb_atomic_load(&receiver->internal.num_pending, memory_order_relaxed), 1);
+                    break;
             }
 
-#ifdef _CNCBUS_DEBUG_GUARDS
-            VERIFY(sb_atomic_fetch_add(&receiver->internal.access_count, 1, memory_order_relaxed) == 0);
-#endif
-
-            cncbus_receiver_msg_chain_t * const msg = receiver->internal.chain_head;
-            if (msg) {
-                if (mode == cncbus_dispatch_flush) {
-                    // unhook all pending messages
-                    receiver->internal.chain_head = receiver->internal.chain_tail = NULL;
-                } else {
-                    receiver->internal.chain_head = msg->next;
-                    if (!msg->next) {
-                        receiver->internal.chain_tail = NULL;
-                    }
-                    msg->next = NULL;
-                }
-
-                // clear message chain access hazard, we won't access it further.
-
-#ifdef _CNCBUS_DEBUG_GUARDS
-                VERIFY(sb_atomic_fetch_add(&receiver->internal.access_count, -1, memory_order_relaxed) == 1);
-#endif
-                atomic_clear(&receiver->internal.hazard, receiver_hazard_access_msg_chain, memory_order_release);
-
-                // dispatch each pending message serially to the receiver
-                cncbus_receiver_msg_chain_t * next;
-                for (cncbus_receiver_msg_chain_t * chain = msg; chain; chain = next) {
-                    next = chain->next;
-                    chain->next = NULL;
-
-                    cncbus_msg_t cursor;
-                    ZEROMEM(&cursor);
-                    cursor.internal.msg_data = chain->msg_data;
-                    cursor.internal.frag_ofs = first_msg_frag_ofs;
-                    cursor.internal.frag = chain->msg_data->frag_head;
-
-                    check_msg_guard(&chain->msg_data->cursor);
-                    receiver->internal.vtable->on_msg_recv(receiver, chain->msg_data->header, &cursor);
-                    bus_release_msg_chain(bus, chain);
-                }
-
+            const int num_dispatched = receiver_dispatch(bus, receiver, max_messages, &in_flight);
+            if (num_dispatched > 0) {
                 result = cncbus_dispatch_ok;
-
-                // release all hazards
-                atomic_clear(&receiver->internal.hazard, receiver_hazard_dispatch, memory_order_relaxed);
-            } else {
-#ifdef _CNCBUS_DEBUG_GUARDS
-                VERIFY(sb_atomic_fetch_add(&receiver->internal.access_count, -1, memory_order_relaxed) == 1);
-#endif
-                // release all hazards
-                atomic_clear(&receiver->internal.hazard, receiver_hazard_dispatch | receiver_hazard_access_msg_chain, memory_order_release);
             }
 
-            if (msg && (mode == cncbus_dispatch_single_message)) {
+            // release all hazards
+            atomic_clear(&receiver->internal.hazard, receiver_hazard_dispatch, memory_order_release);
+
+            if ((num_dispatched > 0) && (mode == cncbus_dispatch_single_message)) {
                 break;
             }
 
@@ -523,13 +648,125 @@ cncbus_dispatch_result_e cncbus_dispatch(cncbus_t * const bus, const cncbus_disp
         bus_exit_read_hazard(bus);
     }
 
-    return all_busy ? cncbus_dispatch_busy : result;
+    if (all_busy || (in_flight && (result == cncbus_dispatch_no_messages))) {
+        return cncbus_dispatch_busy;
+    }
+    return result;
+}
+
+/*
+===============================================================================
+Routing
+
+A route is the set of connected receivers that a (dest address, subnet mask)
+pair resolves to, stored as a bitmask over the receivers array.
+
+Senders fill in routes under the read hazard. Each route slot is a sequence
+lock: a sender that finds the slot being written by another sender simply
+doesn't cache its route, and readers retry the table scan if the sequence
+changed under them. Connect, disconnect and group membership changes empty the
+cache under the cdc hazard when no sender can be looking at it.
+===============================================================================
+*/
+
+static int route_cache_slot(const cncbus_address_t address, const cncbus_address_t subnet_mask) {
+    uint32_t hash = (address.u32 ^ (subnet_mask.u32 * 0x9e3779b1u)) * 0x85ebca6bu;
+    hash ^= hash >> 16;
+    return (int)(hash & (cncbus_route_cache_size - 1));
+}
+
+// must be done inside the cdc hazard
+static void bus_invalidate_routes(cncbus_t * const bus) {
+    ZEROMEM(&bus->internal.routes);
+}
+
+static int bus_find_receiver(const cncbus_t * const bus, const cncbus_receiver_t * const receiver) {
+    for (int i = 0; i < bus->internal.num_receivers; ++i) {
+        if (bus->internal.receivers[i] == receiver) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// must be done inside a read hazard
+static uint32_t bus_resolve_route(const cncbus_t * const bus, const cncbus_address_t address, const cncbus_address_t subnet_mask) {
+    const uint32_t masked_address = address.u32 & subnet_mask.u32;
+    uint32_t receiver_bits = 0;
+
+    if (CNCBUS_IS_GROUP_ADDRESS(address)) {
+        for (int i = 0; i < cncbus_max_groups; ++i) {
+            const cncbus_group_t * const group = &bus->internal.groups[i];
+            if ((group->num_members > 0) && ((group->address.u32 & subnet_mask.u32) == masked_address)) {
+                for (int j = 0; j < group->num_members; ++j) {
+                    const int index = bus_find_receiver(bus, group->members[j]);
+                    ASSERT(index >= 0);
+                    receiver_bits |= 1u << index;
+                }
+            }
+        }
+    } else {
+        for (int i = 0; i < bus->internal.num_receivers; ++i) {
+            if ((bus->internal.receiver_addresses[i].u32 & subnet_mask.u32) == masked_address) {
+                receiver_bits |= 1u << i;
+            }
+        }
+    }
+
+    return receiver_bits;
+}
+
+// must be done inside a read hazard
+static uint32_t bus_lookup_route(cncbus_t * const bus, const cncbus_address_t address, const cncbus_address_t subnet_mask) {
+    if (!address.u32) {
+        // broadcast address
+        return (uint32_t)((1ull << bus->internal.num_receivers) - 1);
+    }
+
+    cncbus_route_t * const route = &bus->internal.routes[route_cache_slot(address, subnet_mask)];
+    const int sequence = sb_atomic_load(&route->sequence, memory_order_acquire);
+
+    if ((sequence != 0) && !(sequence & 1)) {
+        const cncbus_address_t route_address = route->address;
+        const cncbus_address_t route_subnet_mask = route->subnet_mask;
+        const uint32_t receiver_bits = route->receiver_bits;
+        sb_atomic_thread_fence(memory_order_acquire);
+
+        if ((sb_atomic_load(&route->sequence, memory_order_relaxed) == sequence) && (route_address.u32 == address.u32) && (route_subnet_mask.u32 == subnet_mask.u32)) {
+            return receiver_bits;
+        }
+    }
+
+    const uint32_t receiver_bits = bus_resolve_route(bus, address, subnet_mask);
+
+    // replace whatever is in the slot unless another sender is writing it
+    if (!(sequence & 1) && (sb_atomic_cas(&route->sequence, (int)((uint32_t)sequence + 1), sequence, memory_order_relaxed) == sequence)) {
+        sb_atomic_thread_fence(memory_order_release);
+        route->address = address;
+        route->subnet_mask = subnet_mask;
+        route->receiver_bits = receiver_bits;
+        sb_atomic_store(&route->sequence, (int)((uint32_t)sequence + 2), memory_order_release);
+    }
+
+    return receiver_bits;
 }
 
 void cncbus_init_receiver(cncbus_receiver_t * const receiver, const cncbus_receiver_vtable_t * const vtable, const cncbus_address_t address) {
+    ASSERT_MSG(!CNCBUS_IS_GROUP_ADDRESS(address), "receivers cannot be bound to a multicast group address");
     ZEROMEM(receiver);
     receiver->internal.vtable = vtable;
     receiver->internal.address = address;
+    receiver->internal.backpressure_policy = cncbus_backpressure_block;
+    receiver_queue_init(receiver);
+}
+
+static void bus_remove_group_member(cncbus_group_t * const group, const cncbus_receiver_t * const receiver) {
+    for (int i = 0; i < group->num_members; ++i) {
+        if (group->members[i] == receiver) {
+            group->members[i] = group->members[--group->num_members];
+            return;
+        }
+    }
 }
 
 void cncbus_connect(cncbus_t * const bus, cncbus_receiver_t * const receiver) {
@@ -542,8 +779,8 @@ void cncbus_connect(cncbus_t * const bus, cncbus_receiver_t * const receiver) {
     VERIFY(bus->internal.num_receivers < cncbus_max_receivers);
 
     receiver->internal.hazard.i32 = 0;
-    receiver->internal.chain_head = NULL;
-    receiver->internal.chain_tail = NULL;
+    receiver->internal.num_pending.i32 = 0;
+    receiver_queue_init(receiver);
 
 #ifdef _CNCBUS_DEBUG_GUARDS
     receiver->internal.access_count.i32 = 0;
@@ -569,6 +806,7 @@ void cncbus_connect(cncbus_t * const bus, cncbus_receiver_t * const receiver) {
     *lb = receiver;
     bus->internal.receiver_addresses[ofs] = receiver->internal.address;
     ++bus->internal.num_receivers;
+    bus_invalidate_routes(bus);
 
     bus_exit_cdc_hazard(bus);
 }
@@ -599,6 +837,12 @@ void cncbus_disconnect(cncbus_t * const bus, cncbus_receiver_t * const receiver)
 
     --bus->internal.num_receivers;
 
+    for (int i = 0; i < cncbus_max_groups; ++i) {
+        bus_remove_group_member(&bus->internal.groups[i], receiver);
+    }
+
+    bus_invalidate_routes(bus);
+
     bus_exit_cdc_hazard(bus);
 
     // wait for read hazards to clear
@@ -608,9 +852,105 @@ void cncbus_disconnect(cncbus_t * const bus, cncbus_receiver_t * const receiver)
     // read hazards are clear, this receiver is now disconnected from the bus
     // return any unprocessed messages fragments
 
-    if (receiver->internal.chain_head) {
-        bus_release_msg_chain(bus, receiver->internal.chain_head);
+    cncbus_receiver_msg_chain_t * chain;
+    while ((chain = receiver_queue_pop(receiver)) != NULL) {
+        bus_release_msg_chain(bus, chain);
+    }
+    ASSERT(sb_atomic_load(&receiver->internal.num_pending, memory_order_relaxed) == 0);
+}
+
+void cncbus_join_group(cncbus_t * const bus, cncbus_receiver_t * const receiver, const cncbus_address_t group_address) {
+    ASSERT_MSG(CNCBUS_IS_GROUP_ADDRESS(group_address), "not a multicast group address");
+
+    // look the group up under the hazard, a concurrent join/leave can claim or free a group slot before it is set
+    bus_wait_enter_cdc_hazard(bus);
+    ASSERT_MSG(bus_find_receiver(bus, receiver) >= 0, "receiver must be connected to join a group");
+
+    cncbus_group_t * group = NULL;
+    for (int i = 0; i < cncbus_max_groups; ++i) {
+        cncbus_group_t * const it = &bus->internal.groups[i];
+        if ((it->num_members > 0) && (it->address.u32 == group_address.u32)) {
+            group = it;
+            break;
+        }
+        if (!group && (it->num_members == 0)) {
+            group = it;
+        }
+    }
+
+    VERIFY_MSG(group, "out of cncbus multicast groups");
+
+    for (int i = 0; i < group->num_members; ++i) {
+        if (group->members[i] == receiver) {
+            bus_exit_cdc_hazard(bus);
+            return;
+        }
+    }
+
+    group->address = group_address;
+    group->members[group->num_members++] = receiver;
+    bus_invalidate_routes(bus);
+
+    bus_exit_cdc_hazard(bus);
+}
+
+void cncbus_leave_group(cncbus_t * const bus, cncbus_receiver_t * const receiver, const cncbus_address_t group_address) {
+    bus_wait_enter_cdc_hazard(bus);
+
+    for (int i = 0; i < cncbus_max_groups; ++i) {
+        cncbus_group_t * const group = &bus->internal.groups[i];
+        if ((group->num_members > 0) && (group->address.u32 == group_address.u32)) {
+            bus_remove_group_member(group, receiver);
+        }
     }
+
+    bus_invalidate_routes(bus);
+
+    bus_exit_cdc_hazard(bus);
+}
+
+void cncbus_receiver_set_backpressure_policy(cncbus_receiver_t * const receiver, const cncbus_backpressure_policy_e policy) {
+    receiver->internal.backpressure_policy = policy;
+}
+
+cncbus_receiver_stats_t cncbus_receiver_get_stats(cncbus_receiver_t * const receiver) {
+    return (cncbus_receiver_stats_t){
+        .num_pending = sb_atomic_load(&receiver->internal.num_pending, memory_order_relaxed),
+        .max_pending = sb_atomic_load(&receiver->internal.max_pending, memory_order_relaxed),
+        .num_queued = (uint32_t)sb_atomic_load(&receiver->internal.num_queued, memory_order_relaxed),
+        .num_dispatched = receiver->internal.num_dispatched,
+        .num_dropped = (uint32_t)sb_atomic_load(&receiver->internal.num_dropped, memory_order_relaxed),
+        .num_coalesced = (uint32_t)sb_atomic_load(&receiver->internal.num_coalesced, memory_order_relaxed)};
+}
+
+void cncbus_set_dispatch_batch_size(cncbus_t * const bus, const int batch_size) {
+    ASSERT(batch_size > 0);
+    bus->internal.dispatch_batch_size = batch_size;
+}
+
+cncbus_occupancy_t cncbus_get_occupancy(cncbus_t * const bus) {
+    cncbus_occupancy_t occupancy = {
+        .num_msg_links = max_pending_messages_per_receiver_soft_limit * cncbus_max_receivers,
+        .num_free_msg_links = bus->internal.num_free_msg_chains,
+        .min_free_msg_links = bus->internal.min_free_msg_chains,
+        .num_msg_frags = bus->internal.alloc_msg_frags_count,
+        .num_free_msg_frags = bus->internal.num_free_msg_frags,
+        .min_free_msg_frags = bus->internal.min_free_msg_frags,
+        .num_blocked_sends = (uint32_t)sb_atomic_load(&bus->internal.num_blocked_sends, memory_order_relaxed)};
+
+    while (!bus_try_enter_read_hazard(bus)) {
+    }
+
+    occupancy.num_receivers = bus->internal.num_receivers;
+    for (int i = 0; i < occupancy.num_receivers; ++i) {
+        const cncbus_receiver_stats_t stats = cncbus_receiver_get_stats(bus->internal.receivers[i]);
+        occupancy.num_pending_messages += stats.num_pending;
+        occupancy.num_dropped += stats.num_dropped;
+        occupancy.num_coalesced += stats.num_coalesced;
+    }
+
+    bus_exit_read_hazard(bus);
+    return occupancy;
 }
 
 cncbus_msg_t * cncbus_msg_begin_unchecked(cncbus_t * const bus, const uint32_t msg_type) {
@@ -834,40 +1174,65 @@ int cncbus_msg_seek(cncbus_msg_t * const msg, const int ofs, const cncbus_msg_se
     return cursor;
 }
 
-// must be done inside a read hazard
-static int collect_receivers(
-    cncbus_receiver_t * const receiver_table[cncbus_max_receivers],
-    const cncbus_address_t receiver_address_table[cncbus_max_receivers],
-    const int num_receivers,
-    cncbus_receiver_t * out_matched_receiver_table[cncbus_max_receivers],
-    const cncbus_address_t address,
-    const cncbus_address_t subnet_mask) {
-    if (address.u32) {
-        const uint32_t masked_address = address.u32 & subnet_mask.u32;
-
-        int num_matched = 0;
-        for (int i = 0; i < num_receivers; ++i) {
-            const cncbus_address_t receiver_address = receiver_address_table[i];
-
-            // because this array is sorted the array can't match
-            // any further receivers.
-
-            if (subnet_mask.u32 < receiver_address.u32) {
-                break;
-            }
+// frees up a link for `receiver` by evicting (or coalescing into) one of its pending messages.
+// returns the link to use, or NULL if `msg_data` was coalesced or dropped.
+// `msg_data` carries the reference for this receiver, it is released if the message is dropped.
+static cncbus_receiver_msg_chain_t * bus_apply_backpressure(cncbus_t * const bus, cncbus_receiver_t * const receiver, cncbus_msg_data_t * const msg_data) {
+    if (!receiver_try_enter_consumer(receiver)) {
+        // the receiver is being dispatched (possibly by this thread) or disconnected, don't wait on it
+        sb_atomic_fetch_add(&receiver->internal.num_dropped, 1, memory_order_relaxed);
+        bus_release_msg_data(bus, msg_data);
+        return NULL;
+    }
 
-            if ((receiver_address.u32 & subnet_mask.u32) == masked_address) {
-                cncbus_receiver_t * const receiver = receiver_table[i];
-                out_matched_receiver_table[num_matched++] = receiver;
+    if (receiver->internal.backpressure_policy == cncbus_backpressure_coalesce) {
+        // queued links are stable while we own the consumer side, swap the payload of the oldest same type message
+        for (cncbus_receiver_msg_chain_t * link = receiver->internal.queue_tail; link; link = sb_atomic_load_ptr(&link->queue_next, memory_order_acquire)) {
+            if ((link != &receiver->internal.queue_stub) && (link->msg_data->header.msg_type == msg_data->header.msg_type)) {
+                cncbus_msg_data_t * const coalesced = link->msg_data;
+                link->msg_data = msg_data;
+                atomic_clear(&receiver->internal.hazard, receiver_hazard_dispatch, memory_order_release);
+                sb_atomic_fetch_add(&receiver->internal.num_coalesced, 1, memory_order_relaxed);
+                bus_release_msg_data(bus, coalesced);
+                return NULL;
             }
         }
+    }
+
+    cncbus_receiver_msg_chain_t * const chain = receiver_queue_pop(receiver);
+    atomic_clear(&receiver->internal.hazard, receiver_hazard_dispatch, memory_order_release);
 
-        return num_matched;
+    sb_atomic_fetch_add(&receiver->internal.num_dropped, 1, memory_order_relaxed);
+    if (chain) {
+        // reuse the evicted message's link
+        bus_release_msg_data(bus, chain->msg_data);
+        return chain;
+    }
+
+    // nothing of ours to evict, the links are all pending on other receivers
+    bus_release_msg_data(bus, msg_data);
+    return NULL;
+}
+
+// must be done inside a read hazard
+static cncbus_receiver_msg_chain_t * bus_get_msg_chain_for_receiver(cncbus_t * const bus, cncbus_receiver_t * const receiver, cncbus_msg_data_t * const msg_data) {
+    cncbus_receiver_msg_chain_t * chain = bus_get_free_msg_chain(bus);
+    if (chain) {
+        return chain;
     }
 
-    // broadcast address
-    memcpy(out_matched_receiver_table, receiver_table, sizeof(cncbus_receiver_t *) * num_receivers);
-    return num_receivers;
+    if (receiver->internal.backpressure_policy != cncbus_backpressure_block) {
+        return bus_apply_backpressure(bus, receiver, msg_data);
+    }
+
+    // there are no more free message chains, run dispatch pump
+    // to try and free one up.
+    sb_atomic_fetch_add(&bus->internal.num_blocked_sends, 1, memory_order_relaxed);
+    do {
+        cncbus_dispatch(bus, cncbus_dispatch_single_message);
+        chain = bus_get_free_msg_chain(bus);
+    } while (chain == NULL);
+    return chain;
 }
 
 void cncbus_send_async(cncbus_msg_t * const msg, const cncbus_address_t source_address, const cncbus_address_t dest_address, const cncbus_address_t subnet_mask, cncbus_signal_t * const signal) {
@@ -897,11 +1262,9 @@ void cncbus_send_async(cncbus_msg_t * const msg, const cncbus_address_t source_a
     while (!bus_try_enter_read_hazard(bus)) {
     }
 
-    cncbus_receiver_t * pending[cncbus_max_receivers];
-
-    int num_pending = collect_receivers(bus->internal.receivers, bus->internal.receiver_addresses, bus->internal.num_receivers, pending, dest_address, subnet_mask);
+    uint32_t receiver_bits = bus_lookup_route(bus, dest_address, subnet_mask);
 
-    if (num_pending < 1) {
+    if (!receiver_bits) {
         bus_exit_read_hazard(bus);
         bus_release_msg_frag_chain(bus, msg_data->frag_head, msg_data->frag_tail);
         return;
@@ -909,88 +1272,24 @@ void cncbus_send_async(cncbus_msg_t * const msg, const cncbus_address_t source_a
 
     msg_data->ref_count.i32 = 1;
 
-    cncbus_receiver_msg_chain_t * chain = NULL;
-
-    while (num_pending > 0) {
-        // make a pass through the pending list
-        // if the receiver was latched enqueue the message and remove it from pending.
-        // if the receiver was destroyed remove it from pending.
-
-        for (int i = 0; i < num_pending;) {
-            bool remove = false;
-
-            cncbus_receiver_t * const receiver = pending[i];
-
-            // grab another message link, do this outside of the msg_chain access hazard
-            if (!chain) {
-                chain = bus_get_free_msg_chain(bus);
-                if (chain == NULL) {
-                    // there are no more free message chains, run dispatch pump
-                    // to try and free one up.
-                    do {
-                        cncbus_dispatch(bus, cncbus_dispatch_single_message);
-                        chain = bus_get_free_msg_chain(bus);
-                    } while (chain == NULL);
-                }
-                chain->next = NULL;
-                chain->msg_data = msg_data;
-                sb_atomic_fetch_add(&msg_data->ref_count, 1, memory_order_relaxed);
-            }
-
-            const int flags = sb_atomic_fetch_or(&receiver->internal.hazard, receiver_hazard_access_msg_chain, memory_order_acquire);
-            const bool locked = !(flags & receiver_hazard_access_msg_chain);
-
-#ifdef _CNCBUS_DEBUG_GUARDS
-            if (locked) {
-                VERIFY(sb_atomic_fetch_add(&receiver->internal.access_count, 1, memory_order_relaxed) == 0);
-            }
-#endif
-
-            if (flags & receiver_hazard_destroyed) {
-                remove = true;
-            } else if (locked) {
-                remove = true;
-
-                if (receiver->internal.chain_tail) {
-                    receiver->internal.chain_tail->next = chain;
-                } else {
-                    ASSERT(!receiver->internal.chain_head);
-                    receiver->internal.chain_head = chain;
-                }
-
-                receiver->internal.chain_tail = chain;
-                chain = NULL;
-            }
-
-            if (remove) {
-                if (locked) {
-#ifdef _CNCBUS_DEBUG_GUARDS
-                    VERIFY(sb_atomic_fetch_add(&receiver->internal.access_count, -1, memory_order_relaxed) == 1);
-#endif
-                    // clear access to allow destroy to proceed
-                    sb_atomic_fetch_and(&receiver->internal.hazard, ~receiver_hazard_access_msg_chain, (flags & receiver_hazard_destroyed) ? memory_order_relaxed : memory_order_release);
-                }
+    for (; receiver_bits; receiver_bits &= receiver_bits - 1) {
+        cncbus_receiver_t * const receiver = bus->internal.receivers[__builtin_ctz(receiver_bits)];
+        if (sb_atomic_load(&receiver->internal.hazard, memory_order_acquire) & receiver_hazard_destroyed) {
+            continue;
+        }
 
-                // compact
-                if (i < num_pending - 1) {
-                    memmove(&pending[i], &pending[i + 1], sizeof(cncbus_receiver_t *) * (num_pending - i));
-                }
+        // the reference is owned by the link (or the coalesced link) from here
+        sb_atomic_fetch_add(&msg_data->ref_count, 1, memory_order_relaxed);
 
-                --num_pending;
-            } else {
-                ++i;
-            }
+        cncbus_receiver_msg_chain_t * const chain = bus_get_msg_chain_for_receiver(bus, receiver, msg_data);
+        if (chain) {
+            chain->next = NULL;
+            chain->msg_data = msg_data;
+            receiver_queue_push(receiver, chain);
         }
     }
 
     bus_exit_read_hazard(bus);
 
-    if (chain) {
-        // free dangling reference
-        bus_release_msg_chain(bus, chain);
-    }
-
-    if (sb_atomic_fetch_add(&msg_data->ref_count, -1, memory_order_relaxed) == 1) {
-        bus_release_msg_frag_chain(bus, msg_data->frag_head, msg_data->frag_tail);
-    }
+    bus_release_msg_data(bus, msg_data);
 }
@@ -38,6 +38,24 @@ guaranteed. Bus addressing supports one-to-many (broadcast) and many-to-one.
 A connected receiver will receive messages serially so the receiver itself
 will not ever be invoked from multiple threads simultaneously. However no
 guarantee is made about the thread that a receiver dispatch will be executed on.
+
+Each receiver owns a lock-free multi-producer/single-consumer queue: senders
+never wait on each other or on a dispatch in progress, the thread that holds
+the receiver's dispatch hazard is the single consumer.
+
+When the bus runs out of message links a send applies the destination
+receiver's back-pressure policy. The default (block) keeps the delivery
+guarantee by pumping dispatch on the sending thread, the drop/coalesce
+policies trade delivery of stale messages for never stalling the sender.
+
+Sends resolve their receivers through a routing cache keyed by (destination
+address, subnet mask), so repeat senders skip the address table scan. The
+cache is flushed by anything that changes the routing table: connect,
+disconnect and multicast group membership changes.
+
+Multicast groups live in 224.0.0.0/8 (see CNCBUS_MAKE_GROUP_ADDRESS). A message
+sent to a group address is delivered to every receiver that joined a matching
+group instead of to receivers bound at that address.
 ===============================================================================
 */
 
@@ -58,16 +76,36 @@ guarantee is made about the thread that a receiver dispatch will be executed on.
     (cncbus_address_t) {       \
         .u32 = UINT32_MAX      \
     }
+#define CNCBUS_MAKE_GROUP_ADDRESS(_b, _c, _d) CNCBUS_MAKE_ADDRESS(224, _b, _c, _d)
+#define CNCBUS_IS_GROUP_ADDRESS(_address) (((_address).u32 >> 24) == 224)
 
 enum {
-    cncbus_max_receivers = 10
+    cncbus_max_receivers = 10,
+    cncbus_max_groups = 8,
+    // number of (dest address, subnet mask) routes remembered by the bus, must be a power of two
+    cncbus_route_cache_size = 32,
+    // messages handed to each receiver per pass in cncbus_dispatch_batch mode, see cncbus_set_dispatch_batch_size
+    cncbus_default_dispatch_batch_size = 8
 };
 
 typedef enum cncbus_dispatch_mode_e {
     cncbus_dispatch_single_message,
-    cncbus_dispatch_flush
+    // drains every message that was pending on each receiver when it was visited
+    cncbus_dispatch_flush,
+    // drains up to the bus dispatch batch size messages from each receiver
+    cncbus_dispatch_batch
 } cncbus_dispatch_mode_e;
 
+// what cncbus_send_async does when the bus is out of message links for a receiver
+typedef enum cncbus_backpressure_policy_e {
+    // pump dispatch on the sending thread until a link frees up
+    cncbus_backpressure_block,
+    // evict the receiver's oldest pending message
+    cncbus_backpressure_drop_oldest,
+    // replace the receiver's oldest pending message of the same type in place, otherwise evict the oldest
+    cncbus_backpressure_coalesce
+} cncbus_backpressure_policy_e;
+
 typedef enum cncbus_dispatch_result_e {
     cncbus_dispatch_no_messages, // no pending messages
     cncbus_dispatch_busy, // messages pending but all receivers are busy
@@ -131,25 +169,65 @@ typedef struct cncbus_receiver_vtable_t {
 // internal use by bus.
 typedef struct cncbus_receiver_msg_chain_t {
     struct cncbus_receiver_msg_chain_t * next;
+    // link in the receiver queue
+    sb_atomic_ptr_t queue_next;
     cncbus_msg_data_t * msg_data;
 #ifdef GUARD_PAGE_SUPPORT
     debug_sys_page_block_t guard_pages;
 #endif
 } cncbus_receiver_msg_chain_t;
 
+// receiver occupancy counters, sampled without synchronization
+typedef struct cncbus_receiver_stats_t {
+    int32_t num_pending;
+    int32_t max_pending;
+    uint32_t num_queued;
+    uint32_t num_dispatched;
+    // messages lost to back-pressure
+    uint32_t num_dropped;
+    uint32_t num_coalesced;
+} cncbus_receiver_stats_t;
+
 // an instance of a receiver, managed by receiver author.
 typedef struct cncbus_receiver_t {
     struct {
-        cncbus_receiver_msg_chain_t *chain_head, *chain_tail;
+        // senders push at `queue_head`, the dispatching thread pops at `queue_tail`
+        sb_atomic_ptr_t queue_head;
+        cncbus_receiver_msg_chain_t * queue_tail;
+        cncbus_receiver_msg_chain_t queue_stub;
         const cncbus_receiver_vtable_t * vtable;
         sb_atomic_int32_t hazard; // set when being accessed
 #ifdef _CNCBUS_DEBUG_GUARDS
         sb_atomic_int32_t access_count;
 #endif
+        sb_atomic_int32_t num_pending;
+        sb_atomic_int32_t max_pending;
+        sb_atomic_int32_t num_queued;
+        sb_atomic_int32_t num_dropped;
+        sb_atomic_int32_t num_coalesced;
+        uint32_t num_dispatched;
+        cncbus_backpressure_policy_e backpressure_policy;
         cncbus_address_t address;
     } internal;
 } cncbus_receiver_t;
 
+// internal use by bus.
+typedef struct cncbus_route_t {
+    // odd while the route is being written, 0 for an empty slot
+    sb_atomic_int32_t sequence;
+    cncbus_address_t address;
+    cncbus_address_t subnet_mask;
+    // bit i is set if receivers[i] matches the route
+    uint32_t receiver_bits;
+} cncbus_route_t;
+
+// internal use by bus.
+typedef struct cncbus_group_t {
+    cncbus_address_t address;
+    cncbus_receiver_t * members[cncbus_max_receivers];
+    int num_members;
+} cncbus_group_t;
+
 // bus signal
 typedef struct cncbus_signal_t {
     sb_mutex_t * mutex;
@@ -176,13 +254,41 @@ typedef struct cncbus_t {
         cncbus_receiver_t * receivers[cncbus_max_receivers];
         cncbus_address_t receiver_addresses[cncbus_max_receivers];
         int num_receivers;
+        // routes and groups only change under the cdc hazard
+        cncbus_route_t routes[cncbus_route_cache_size];
+        cncbus_group_t groups[cncbus_max_groups];
         int alloc_msg_frags_count;
+        int dispatch_batch_size;
+        // guarded by the free chain hazards
+        int num_free_msg_frags;
+        int min_free_msg_frags;
+        int num_free_msg_chains;
+        int min_free_msg_chains;
+        sb_atomic_int32_t num_blocked_sends;
 #ifdef GUARD_PAGE_SUPPORT
         bool guard_pages;
 #endif
     } internal;
 } cncbus_t;
 
+// bus occupancy counters, sampled without synchronization
+typedef struct cncbus_occupancy_t {
+    int32_t num_receivers;
+    // messages queued on all connected receivers
+    int32_t num_pending_messages;
+    int32_t num_msg_links;
+    int32_t num_free_msg_links;
+    int32_t min_free_msg_links;
+    int32_t num_msg_frags;
+    int32_t num_free_msg_frags;
+    int32_t min_free_msg_frags;
+    // summed over connected receivers
+    uint32_t num_dropped;
+    uint32_t num_coalesced;
+    // sends that had to pump dispatch to get a message link
+    uint32_t num_blocked_sends;
+} cncbus_occupancy_t;
+
 /*
 ===============================================================================
 CNC bus API
@@ -208,6 +314,18 @@ EXT_EXPORT void cncbus_init_receiver(cncbus_receiver_t * const receiver, const s
 EXT_EXPORT void cncbus_connect(cncbus_t * const bus, cncbus_receiver_t * const receiver);
 EXT_EXPORT void cncbus_disconnect(cncbus_t * const bus, cncbus_receiver_t * const receiver);
 
+// receivers default to cncbus_backpressure_block, change the policy before connecting the receiver.
+void cncbus_receiver_set_backpressure_policy(cncbus_receiver_t * const receiver, const cncbus_backpressure_policy_e policy);
+cncbus_receiver_stats_t cncbus_receiver_get_stats(cncbus_receiver_t * const receiver);
+
+// multicast group membership follows the same rules as connect/disconnect.
+// the receiver must be connected, disconnecting it leaves all of its groups.
+void cncbus_join_group(cncbus_t * const bus, cncbus_receiver_t * const receiver, const cncbus_address_t group_address);
+void cncbus_leave_group(cncbus_t * const bus, cncbus_receiver_t * const receiver, const cncbus_address_t group_address);
+
+void cncbus_set_dispatch_batch_size(cncbus_t * const bus, const int batch_size);
+cncbus_occupancy_t cncbus_get_occupancy(cncbus_t * const bus);
+
 // unchecked bus message functions can fail, allowing caller to gracefully handle
 // bus saturation
 
@@ -16,6 +16,11 @@ extern "C" {
 #define CNCBUS_ADDRESS_LOGGER CNCBUS_MAKE_ADDRESS(42, 42, 1, 0)
 #define CNCBUS_SUBNET_MASK_CORE CNCBUS_MAKE_ADDRESS(255, 255, 0, 0)
 
+// multicast groups the core receivers join, high frequency senders target these
+#define CNCBUS_GROUP_LOGGER CNCBUS_MAKE_GROUP_ADDRESS(0, 1, 0)
+#define CNCBUS_GROUP_EVENTS CNCBUS_MAKE_GROUP_ADDRESS(0, 2, 0)
+#define CNCBUS_SUBNET_MASK_GROUP CNCBUS_MAKE_ADDRESS(255, 255, 255, 255)
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,6 +17,8 @@ extern "C" {
 enum {
     cncbus_msg_type_utf8 = FOURCC('U', 'T', 'F', '8'),
     cncbus_msg_type_log_v1 = FOURCC('L', 'O', 'G', '1'),
+    // deferred formatting, see log_message_deferred
+    cncbus_msg_type_log_v2 = FOURCC('L', 'O', 'G', '2'),
     cncbus_msg_type_metric_v2 = FOURCC('M', 'E', 'T', '2'),
     cncbus_msg_type_event = FOURCC('E', 'V', 'N', 'T'),
 };
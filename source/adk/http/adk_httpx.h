@@ -38,8 +38,14 @@ FFI_EXPORT FFI_ENUM_CLEAN_NAMES typedef enum adk_httpx_result_e {
 FFI_ALWAYS_TYPED
 typedef struct adk_httpx_response_t adk_httpx_response_t;
 
+/// A body fragment received by the network pump, handed to an `on_body_fragment` consumer without copying it.
+typedef struct adk_httpx_body_fragment_t adk_httpx_body_fragment_t;
+
 typedef bool (*adk_httpx_on_header_t)(adk_httpx_response_t * const response, const const_mem_region_t header, void * userdata);
 typedef bool (*adk_httpx_on_body_t)(adk_httpx_response_t * const response, const const_mem_region_t body, void * userdata);
+/// Called with each body fragment in order, ownership of `fragment` moves to the callee which must give it back with
+/// `adk_httpx_body_fragment_release` (from any thread) before the client is freed. Return false to abort the request.
+typedef bool (*adk_httpx_on_body_fragment_t)(adk_httpx_response_t * const response, adk_httpx_body_fragment_t * const fragment, void * userdata);
 typedef void (*adk_httpx_on_complete_t)(adk_httpx_response_t * const response, void * userdata);
 
 typedef enum adk_httpx_init_mode_e {
@@ -75,6 +81,48 @@ void adk_httpx_client_dump_heap_usage(adk_httpx_client_t * const client);
 
 heap_metrics_t adk_httpx_client_get_heap_metrics(adk_httpx_client_t * const client);
 
+enum {
+    adk_httpx_latency_histogram_num_buckets = 16
+};
+
+/// Request latencies as seen by the thread ticking the client, measured from `adk_httpx_send`.
+/// Bucket 0 counts requests under 1ms, bucket `i` requests in [2^(i-1), 2^i) ms, the last bucket everything above.
+typedef struct adk_httpx_latency_histogram_t {
+    uint32_t buckets[adk_httpx_latency_histogram_num_buckets];
+    uint32_t count;
+    microseconds_t min;
+    microseconds_t max;
+    microseconds_t total;
+} adk_httpx_latency_histogram_t;
+
+typedef struct adk_httpx_client_latency_t {
+    // until the first header or body bytes were handed to the client
+    adk_httpx_latency_histogram_t time_to_first_byte;
+    // until the response was ready
+    adk_httpx_latency_histogram_t time_to_complete;
+} adk_httpx_client_latency_t;
+
+adk_httpx_client_latency_t adk_httpx_client_get_latency(adk_httpx_client_t * const client);
+void adk_httpx_client_reset_latency(adk_httpx_client_t * const client);
+
+typedef struct adk_httpx_fragment_metrics_t {
+    // payload bytes per fragment
+    uint32_t fragment_size;
+    uint32_t num_fragments;
+    uint32_t num_free;
+    // owned by `on_body_fragment` consumers
+    uint32_t num_held;
+    // times the network pump waited for a fragment to be returned
+    uint32_t num_stalls;
+    size_t grown_bytes;
+    size_t budget;
+} adk_httpx_fragment_metrics_t;
+
+/// Lets the network pump map up to `budget` bytes of fragments on top of the client's fragments region when it runs out of
+/// fragments, instead of stalling until the main thread returns some. Grown memory is kept until the client is freed.
+void adk_httpx_client_set_fragment_budget(adk_httpx_client_t * const client, const size_t budget);
+adk_httpx_fragment_metrics_t adk_httpx_client_get_fragment_metrics(adk_httpx_client_t * const client);
+
 FFI_EXPORT FFI_ENUM_CLEAN_NAMES typedef enum adk_httpx_method_e {
     adk_httpx_method_get,
     adk_httpx_method_post,
@@ -112,6 +160,9 @@ void adk_httpx_request_set_user_agent(
 
 void adk_httpx_request_set_on_header(adk_httpx_request_t * const request, adk_httpx_on_header_t on_header);
 void adk_httpx_request_set_on_body(adk_httpx_request_t * const request, adk_httpx_on_body_t on_body);
+/// Streams the body to `on_body_fragment` instead of copying it, the body is not buffered unless `adk_httpx_buffering_mode_body` is set.
+/// Called after `on_body` when both are set.
+void adk_httpx_request_set_on_body_fragment(adk_httpx_request_t * const request, adk_httpx_on_body_fragment_t on_body_fragment);
 void adk_httpx_request_set_on_complete(adk_httpx_request_t * const request, adk_httpx_on_complete_t on_complete);
 void adk_httpx_request_set_userdata(adk_httpx_request_t * const request, void * const userdata);
 
@@ -151,6 +202,10 @@ const_mem_region_t adk_httpx_response_get_body(const adk_httpx_response_t * cons
 
 FFI_EXPORT FFI_PUB_CRATE void adk_httpx_response_free(FFI_PTR_NATIVE adk_httpx_response_t * const response);
 
+const_mem_region_t adk_httpx_body_fragment_get_data(const adk_httpx_body_fragment_t * const fragment);
+/// Returns `fragment` to its client's network pump, may be called from any thread.
+void adk_httpx_body_fragment_release(adk_httpx_body_fragment_t * const fragment);
+
 typedef bool (*adk_httpx_fetch_on_header_t)(const const_mem_region_t header, void * userdata);
 typedef bool (*adk_httpx_fetch_on_body_t)(const const_mem_region_t body, void * userdata);
 typedef void (*adk_httpx_fetch_on_complete_t)(adk_httpx_result_e result, int32_t response_code, void * userdata);
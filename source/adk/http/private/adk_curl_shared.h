@@ -9,6 +9,7 @@
 #include "source/adk/http/private/adk_curl_common.h"
 #include "source/adk/http/private/adk_curl_context.h"
 #include "source/adk/runtime/memory.h"
+#include "source/adk/steamboat/sb_platform.h"
 #include "source/adk/steamboat/sb_thread.h"
 
 #define CURL_NO_OLDIES
@@ -33,6 +34,9 @@ struct adk_httpx_client_t {
     struct adk_httpx_handle_t * handle_tail;
 
     curl_common_ssl_ctx_data_t ssl_ctx_data;
+
+    // only touched by the thread ticking the client
+    adk_httpx_client_latency_t latency;
 };
 
 struct adk_httpx_response_t {
@@ -77,9 +81,14 @@ struct adk_httpx_request_t {
 
     adk_httpx_on_header_t on_header;
     adk_httpx_on_body_t on_body;
+    adk_httpx_on_body_fragment_t on_body_fragment;
     adk_httpx_on_complete_t on_complete;
     bool aborted_by_callback;
 
+    // set by adk_httpx_send, for the client's latency histograms
+    nanoseconds_t send_time;
+    bool received_first_byte;
+
     adk_httpx_network_pump_fragment_t * active_header_fragment;
     adk_httpx_network_pump_fragment_t * active_body_fragment;
 
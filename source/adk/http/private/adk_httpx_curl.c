@@ -89,6 +89,45 @@ heap_metrics_t adk_httpx_client_get_heap_metrics(adk_httpx_client_t * const clie
     return heap_get_metrics(client->heap);
 }
 
+static void latency_histogram_add(adk_httpx_latency_histogram_t * const histogram, const nanoseconds_t start_time) {
+    const uint64_t us = (sb_read_nanosecond_clock().ns - start_time.ns) / 1000;
+    const uint64_t ms = us / 1000;
+
+    // bucket index is the bit width of the latency in milliseconds
+    int bucket = 0;
+    for (uint64_t t = ms; t != 0; t >>= 1) {
+        ++bucket;
+    }
+    ++histogram->buckets[min_int(bucket, adk_httpx_latency_histogram_num_buckets - 1)];
+
+    if ((histogram->count == 0) || (us < histogram->min.us)) {
+        histogram->min.us = us;
+    }
+    if (us > histogram->max.us) {
+        histogram->max.us = us;
+    }
+    histogram->total.us += us;
+    ++histogram->count;
+}
+
+adk_httpx_client_latency_t adk_httpx_client_get_latency(adk_httpx_client_t * const client) {
+    ASSERT_IS_SAME_THREAD(client->thread_id);
+    return client->latency;
+}
+
+void adk_httpx_client_reset_latency(adk_httpx_client_t * const client) {
+    ASSERT_IS_SAME_THREAD(client->thread_id);
+    ZEROMEM(&client->latency);
+}
+
+void adk_httpx_client_set_fragment_budget(adk_httpx_client_t * const client, const size_t budget) {
+    adk_httpx_network_pump_set_fragment_budget(client->network_pump, budget);
+}
+
+adk_httpx_fragment_metrics_t adk_httpx_client_get_fragment_metrics(adk_httpx_client_t * const client) {
+    return adk_httpx_network_pump_get_fragment_metrics(client->network_pump);
+}
+
 // Handle should be freed only after the request has went through the networking pump and been completed.
 static void free_handle(adk_httpx_client_t * const client, adk_httpx_handle_t * const handle) {
     HTTPX_TRACE_PUSH_FN();
@@ -314,74 +353,103 @@ bool adk_httpx_client_tick(adk_httpx_client_t * const client) {
         const bool response_freed = response == NULL;
 
         const bool buffered_headers_fragments = (request->on_header == NULL) || (request->buffering_mode & adk_httpx_buffering_mode_header) != 0;
-        const bool buffered_body_fragments = (request->on_body == NULL) || (request->buffering_mode & adk_httpx_buffering_mode_body) != 0;
+        const bool buffered_body_fragments = ((request->on_body == NULL) && (request->on_body_fragment == NULL)) || (request->buffering_mode & adk_httpx_buffering_mode_body) != 0;
 
         sb_lock_mutex(request->fragments_lock);
         adk_httpx_network_pump_fragment_t * const fragments_head = request->fragments_head;
-        adk_httpx_network_pump_fragment_t * const fragments_tail = request->fragments_tail;
         request->fragments_head = request->fragments_tail = NULL;
         const bool data_stream_ended = handle->data_stream_ended;
         sb_unlock_mutex(request->fragments_lock);
 
+        if (fragments_head && !request->received_first_byte) {
+            request->received_first_byte = true;
+            latency_histogram_add(&client->latency.time_to_first_byte, request->send_time);
+        }
+
+        if (data_stream_ended) {
+            latency_histogram_add(&client->latency.time_to_complete, request->send_time);
+        }
+
         // Processing fragments.
         // If the response has been freed, this section is ignored and callbacks won't be called. Fragment would still be returned to the pump's pool.
-        for (const adk_httpx_network_pump_fragment_t * fragment = fragments_head; fragment != NULL && !response_freed && !request->aborted_by_callback; fragment = fragment->next) {
-            ASSERT(fragment->size > 0);
-            if (fragment->type == adk_httpx_network_pump_header_fragment) {
-                if ((request->on_header != NULL)) {
-                    size_t offset = 0;
-                    while (offset < fragment->size) {
-                        const uint8_t * header = fragment->region.byte_ptr + offset;
-
-                        do {
-                            ++offset;
-                        } while (fragment->region.byte_ptr[offset - 1] != '\n');
-
-                        const size_t header_length = (fragment->region.adr + offset) - (uintptr_t)header;
-                        const mem_region_t header_value = MEM_REGION(.ptr = header, .size = header_length);
-                        if (!request->on_header(response, header_value.consted, request->userdata)) {
-                            // Storing response->result here does race with the pump if it happens
-                            // to encounter an error. In this case, by definition the result is undefined since technically
-                            // both things happened: callback was aborted, and curl had an error. Which error code
-                            // wins is not functionally important since an error will be signaled.
-                            handle->response->result = adk_httpx_error;
-                            request->aborted_by_callback = true;
-                            break;
+        // Body fragments handed to `on_body_fragment` are returned by the consumer instead.
+        adk_httpx_network_pump_fragment_t * free_fragments_head = NULL;
+        adk_httpx_network_pump_fragment_t * free_fragments_tail = NULL;
+        for (adk_httpx_network_pump_fragment_t *fragment = fragments_head, *next_fragment; fragment != NULL; fragment = next_fragment) {
+            next_fragment = fragment->next;
+            bool handed_off = false;
+
+            if (!response_freed && !request->aborted_by_callback) {
+                ASSERT(fragment->size > 0);
+                if (fragment->type == adk_httpx_network_pump_header_fragment) {
+                    if ((request->on_header != NULL)) {
+                        size_t offset = 0;
+                        while (offset < fragment->size) {
+                            const uint8_t * header = fragment->region.byte_ptr + offset;
+
+                            do {
+                                ++offset;
+                            } while (fragment->region.byte_ptr[offset - 1] != '\n');
+
+                            const size_t header_length = (fragment->region.adr + offset) - (uintptr_t)header;
+                            const mem_region_t header_value = MEM_REGION(.ptr = header, .size = header_length);
+                            if (!request->on_header(response, header_value.consted, request->userdata)) {
+                                // Storing response->result here does race with the pump if it happens
+                                // to encounter an error. In this case, by definition the result is undefined since technically
+                                // both things happened: callback was aborted, and curl had an error. Which error code
+                                // wins is not functionally important since an error will be signaled.
+                                handle->response->result = adk_httpx_error;
+                                request->aborted_by_callback = true;
+                                break;
+                            }
                         }
                     }
-                }
 
-                if (buffered_headers_fragments) {
-                    response->headers.ptr = adk_httpx_realloc(client, response->headers.ptr, response->headers.size + fragment->size + 1, MALLOC_TAG);
-                    memcpy(response->headers.byte_ptr + response->headers.size, fragment->region.ptr, fragment->size);
-                    response->headers.size += fragment->size;
-                    // add nul so string functions will always find a nul inside our buffer regardless of what data we receive.
-                    response->headers.byte_ptr[response->headers.size] = 0;
-                }
-            } else {
-                ASSERT(fragment->type == adk_httpx_network_pump_body_fragment);
-                if ((request->on_body != NULL) && !request->on_body(response, CONST_MEM_REGION(.byte_ptr = fragment->region.byte_ptr, .size = fragment->size), request->userdata)) {
-                    // Storing response->result here does race with the pump if it happens
-                    // to encounter an error. In this case, by definition the result is undefined since technically
-                    // both things happened: callback was aborted, and curl had an error. Which error code
-                    // wins is not functionally important since an error will be signaled.
-                    handle->response->result = adk_httpx_error;
-                    request->aborted_by_callback = true;
-                    break;
-                }
+                    if (buffered_headers_fragments) {
+                        response->headers.ptr = adk_httpx_realloc(client, response->headers.ptr, response->headers.size + fragment->size + 1, MALLOC_TAG);
+                        memcpy(response->headers.byte_ptr + response->headers.size, fragment->region.ptr, fragment->size);
+                        response->headers.size += fragment->size;
+                        // add nul so string functions will always find a nul inside our buffer regardless of what data we receive.
+                        response->headers.byte_ptr[response->headers.size] = 0;
+                    }
+                } else {
+                    ASSERT(fragment->type == adk_httpx_network_pump_body_fragment);
+                    if ((request->on_body != NULL) && !request->on_body(response, CONST_MEM_REGION(.byte_ptr = fragment->region.byte_ptr, .size = fragment->size), request->userdata)) {
+                        // Storing response->result here does race with the pump if it happens
+                        // to encounter an error. In this case, by definition the result is undefined since technically
+                        // both things happened: callback was aborted, and curl had an error. Which error code
+                        // wins is not functionally important since an error will be signaled.
+                        handle->response->result = adk_httpx_error;
+                        request->aborted_by_callback = true;
+                    } else {
+                        if (buffered_body_fragments) {
+                            response->body.ptr = adk_httpx_realloc(client, response->body.ptr, response->body.size + fragment->size + 1, MALLOC_TAG);
+                            memcpy(response->body.byte_ptr + response->body.size, fragment->region.ptr, fragment->size);
+                            response->body.size += fragment->size;
+                            // add nul so string functions will always find a nul inside our buffer regardless of what data we receive.
+                            response->body.byte_ptr[response->body.size] = 0;
+                        }
 
-                if (buffered_body_fragments) {
-                    response->body.ptr = adk_httpx_realloc(client, response->body.ptr, response->body.size + fragment->size + 1, MALLOC_TAG);
-                    memcpy(response->body.byte_ptr + response->body.size, fragment->region.ptr, fragment->size);
-                    response->body.size += fragment->size;
-                    // add nul so string functions will always find a nul inside our buffer regardless of what data we receive.
-                    response->body.byte_ptr[response->body.size] = 0;
+                        if (request->on_body_fragment != NULL) {
+                            adk_httpx_network_pump_fragment_hand_off(fragment);
+                            handed_off = true;
+                            if (!request->on_body_fragment(response, (adk_httpx_body_fragment_t *)fragment, request->userdata)) {
+                                // see above on racing with the pump
+                                handle->response->result = adk_httpx_error;
+                                request->aborted_by_callback = true;
+                            }
+                        }
+                    }
                 }
             }
+
+            if (!handed_off) {
+                LL_ADD(fragment, prev, next, free_fragments_head, free_fragments_tail);
+            }
         }
 
-        if (fragments_head) {
-            adk_httpx_network_pump_fragments_free(client->network_pump, fragments_head, fragments_tail);
+        if (free_fragments_head) {
+            adk_httpx_network_pump_fragments_free(client->network_pump, free_fragments_head, free_fragments_tail);
         }
 
         if (data_stream_ended) {
@@ -556,6 +624,10 @@ void adk_httpx_request_set_on_body(adk_httpx_request_t * const request, adk_http
     request->on_body = on_body;
 }
 
+void adk_httpx_request_set_on_body_fragment(adk_httpx_request_t * const request, adk_httpx_on_body_fragment_t on_body_fragment) {
+    request->on_body_fragment = on_body_fragment;
+}
+
 void adk_httpx_request_set_on_complete(adk_httpx_request_t * const request, adk_httpx_on_complete_t on_complete) {
     request->on_complete = on_complete;
 }
@@ -622,6 +694,7 @@ adk_httpx_response_t * adk_httpx_send(
 
     request->fragments_lock = sb_create_mutex(MALLOC_TAG);
 
+    request->send_time = sb_read_nanosecond_clock();
     adk_httpx_network_pump_add_request(handle);
 
     HTTPX_TRACE_POP();
@@ -674,6 +747,17 @@ void adk_httpx_response_free(adk_httpx_response_t * const response) {
     HTTPX_TRACE_POP();
 }
 
+const_mem_region_t adk_httpx_body_fragment_get_data(const adk_httpx_body_fragment_t * const fragment) {
+    const adk_httpx_network_pump_fragment_t * const pump_fragment = (const adk_httpx_network_pump_fragment_t *)fragment;
+    return CONST_MEM_REGION(.byte_ptr = pump_fragment->region.byte_ptr, .size = pump_fragment->size);
+}
+
+void adk_httpx_body_fragment_release(adk_httpx_body_fragment_t * const fragment) {
+    HTTPX_TRACE_PUSH_FN();
+    adk_httpx_network_pump_fragment_release((adk_httpx_network_pump_fragment_t *)fragment);
+    HTTPX_TRACE_POP();
+}
+
 static size_t adk_httpx_fetch_header_callback(const char * const ptr, const size_t size, const size_t nmemb, void * const userdata) {
     HTTPX_TRACE_PUSH_FN();
 
@@ -13,6 +13,19 @@
 
 #define HTTPX_NETWORK_PUMP FOURCC('H', 'X', 'N', 'P')
 
+enum {
+    // longest the pump waits on its sockets when it can be woken up for new requests
+    network_pump_idle_poll_timeout_ms = 1000,
+    // fewest fragments mapped when the pool grows past its initial region
+    network_pump_min_growth_fragments = 16
+};
+
+// Header of a region mapped when the fragment pool grows, fragments are carved from the rest of it
+typedef struct network_pump_fragment_chunk_t {
+    mem_region_t pages;
+    struct network_pump_fragment_chunk_t * next;
+} network_pump_fragment_chunk_t;
+
 // Used to get a chunk of memory for the response error message
 void * adk_httpx_malloc(adk_httpx_client_t * const client, const size_t size, const char * const tag);
 void adk_httpx_free(adk_httpx_client_t * const client, void * const ptr, const char * const tag);
@@ -23,13 +36,32 @@ struct adk_httpx_network_pump_t {
     bool is_running;
     sb_thread_id_t network_pump_thread;
 
+    // Longest wait for socket activity when curl_multi_wakeup is not available on the platform,
+    // new requests are picked up with up to this much latency.
     uint32_t sleep_period;
+    bool can_wakeup;
+
+    system_guard_page_mode_e guard_page_mode;
+    size_t fragment_size;
+    size_t fragment_stride;
+
+    // The pool maps more fragments instead of stalling the pump while less than `fragment_budget` bytes were grown.
+    // Grown chunks are kept until shutdown, the pool settles at the high watermark of the workload.
+    size_t fragment_budget;
+    size_t grown_bytes;
+    network_pump_fragment_chunk_t * grown_chunks;
 
     // free list
     sb_condition_variable_t * free_fragment_enqued;
     sb_mutex_t * free_list_lock;
     adk_httpx_network_pump_fragment_t * free_list_head;
     adk_httpx_network_pump_fragment_t * free_list_tail;
+    uint32_t num_fragments;
+    uint32_t num_free_fragments;
+    uint32_t num_stalls;
+
+    // fragments owned by `on_body_fragment` consumers
+    sb_atomic_int32_t num_held_fragments;
 
     // Client that ownes this pump and which requests this pump processes
     adk_httpx_client_t * client;
@@ -41,19 +73,90 @@ struct adk_httpx_network_pump_t {
 
 static THREAD_LOCAL bool did_get_data = false;
 
+// Carves `arena` into fragments and adds them to the free list, returns the number of fragments added
+static uint32_t add_fragments(adk_httpx_network_pump_t * const pump, const mem_region_t arena) {
+    const size_t header_size = sizeof(adk_httpx_network_pump_fragment_t);
+
+    uint8_t * const first = ALIGN_PTR(arena.byte_ptr, ALIGN_OF(adk_httpx_network_pump_fragment_t));
+    const uint8_t * const end = arena.byte_ptr + arena.size;
+
+    uint32_t num_fragments = 0;
+    for (uint8_t * fragment_offset = first; fragment_offset + pump->fragment_size <= end; fragment_offset += pump->fragment_stride) {
+        adk_httpx_network_pump_fragment_t * const header = (adk_httpx_network_pump_fragment_t *)fragment_offset;
+        ZEROMEM(header);
+
+        header->pump = pump;
+        header->region = MEM_REGION(.ptr = fragment_offset + header_size, .size = pump->fragment_size - header_size);
+
+        LL_ADD(header, prev, next, pump->free_list_head, pump->free_list_tail);
+
+        num_fragments++;
+    }
+
+    pump->num_fragments += num_fragments;
+    pump->num_free_fragments += num_fragments;
+    return num_fragments;
+}
+
+// Maps another chunk of fragments if the budget allows it, called with `free_list_lock` held.
+static bool grow_fragments(adk_httpx_network_pump_t * const pump) {
+    if (pump->fragment_budget <= pump->grown_bytes) {
+        return false;
+    }
+
+    // Double the grown memory on every step so that a burst only needs a few mappings
+    const size_t min_chunk_size = sizeof(network_pump_fragment_chunk_t) + network_pump_min_growth_fragments * pump->fragment_stride;
+    const size_t chunk_size = PAGE_ALIGN_INT(pump->grown_bytes > min_chunk_size ? pump->grown_bytes : min_chunk_size);
+    const size_t remaining_budget = REV_PAGE_ALIGN_INT(pump->fragment_budget - pump->grown_bytes);
+    const size_t size = chunk_size < remaining_budget ? chunk_size : remaining_budget;
+    if (size < sizeof(network_pump_fragment_chunk_t) + ALIGN_OF(adk_httpx_network_pump_fragment_t) + pump->fragment_size) {
+        return false;
+    }
+
+    mem_region_t pages;
+#ifdef GUARD_PAGE_SUPPORT
+    if (pump->guard_page_mode == system_guard_page_mode_enabled) {
+        pages = debug_sys_map_pages(size, system_page_protect_read_write, MALLOC_TAG);
+    } else
+#endif
+    {
+        pages = sb_map_pages(size, system_page_protect_read_write);
+    }
+
+    if (!pages.ptr) {
+        LOG_WARN(HTTPX_NETWORK_PUMP, "Failed to map %" PRIu64 " bytes of network pump fragments", (uint64_t)size);
+        return false;
+    }
+
+    network_pump_fragment_chunk_t * const chunk = pages.ptr;
+    chunk->pages = pages;
+    chunk->next = pump->grown_chunks;
+    pump->grown_chunks = chunk;
+    pump->grown_bytes += size;
+
+    const uint32_t num_fragments = add_fragments(pump, MEM_REGION(.byte_ptr = pages.byte_ptr + sizeof(network_pump_fragment_chunk_t), .size = size - sizeof(network_pump_fragment_chunk_t)));
+    LOG_DEBUG(HTTPX_NETWORK_PUMP, "Grew network pump by %d fragments, %" PRIu64 " of %" PRIu64 " budget bytes used", num_fragments, (uint64_t)pump->grown_bytes, (uint64_t)pump->fragment_budget);
+    return true;
+}
+
 static adk_httpx_network_pump_fragment_t * blocking_get_free_fragment(adk_httpx_network_pump_t * const pump) {
-    HTTPX_TRACE_PUSH_FN()
+    HTTPX_TRACE_PUSH_FN();
 
     adk_httpx_network_pump_fragment_t * fragment = NULL;
     sb_lock_mutex(pump->free_list_lock);
     {
-        while (pump->free_list_head == NULL) {
-            sb_wait_condition(pump->free_fragment_enqued, pump->free_list_lock, sb_timeout_infinite);
+        if ((pump->free_list_head == NULL) && !grow_fragments(pump)) {
+            // Out of budget, wait for the main thread or a consumer to return fragments
+            ++pump->num_stalls;
+            while (pump->free_list_head == NULL) {
+                sb_wait_condition(pump->free_fragment_enqued, pump->free_list_lock, sb_timeout_infinite);
+            }
         }
 
         fragment = pump->free_list_head;
 
         LL_REMOVE(fragment, prev, next, pump->free_list_head, pump->free_list_tail);
+        --pump->num_free_fragments;
     }
     sb_unlock_mutex(pump->free_list_lock);
 
@@ -203,6 +306,9 @@ void adk_httpx_network_pump_add_request(adk_httpx_handle_t * const handle) {
         LL_ADD(request, prev, next, pump->incoming_requests_head, pump->incoming_requests_tail);
     }
     sb_unlock_mutex(pump->incoming_requests_lock);
+
+    // interrupt the pump's wait so the request starts right away
+    curl_multi_wakeup(client->multi);
     CURL_POP_CTX();
     HTTPX_TRACE_POP();
 }
@@ -312,8 +418,14 @@ static int network_pump_proc(void * userdata) {
             sb_unlock_mutex(request->fragments_lock);
         }
 
-        if (!did_get_data) {
-            sb_thread_sleep((milliseconds_t){.ms = pump->sleep_period});
+        if (!did_get_data && pump->is_running) {
+            // Wait for socket activity, curl's next timeout or a wakeup from adk_httpx_network_pump_add_request/shutdown
+            const int timeout_ms = pump->can_wakeup ? network_pump_idle_poll_timeout_ms : (int)pump->sleep_period;
+            const CURLMcode mc = curl_multi_poll(client->multi, NULL, 0, timeout_ms, NULL);
+            if (mc != CURLM_OK) {
+                LOG_ERROR(HTTPX_NETWORK_PUMP, "curl_multi_poll failed with code %d", mc);
+                sb_thread_sleep((milliseconds_t){.ms = pump->sleep_period});
+            }
         }
 
         HTTPX_TRACE_POP();
@@ -322,41 +434,6 @@ static int network_pump_proc(void * userdata) {
     return 0;
 }
 
-static void create_fragment_regions(adk_httpx_network_pump_t * const pump, const size_t fragment_size) {
-    HTTPX_TRACE_PUSH_FN();
-
-    const size_t fragment_alignment = ALIGN_OF(adk_httpx_network_pump_fragment_t);
-
-    mem_region_t arena = pump->fragment_buffers;
-    arena.adr = ALIGN_PTR(arena.byte_ptr, fragment_alignment);
-    arena.size = arena.size - (arena.adr - pump->fragment_buffers.adr);
-
-    uint32_t num_fragments = 0;
-
-    const size_t header_size = sizeof(adk_httpx_network_pump_fragment_t);
-    const size_t fragment_data_size = fragment_size - header_size;
-
-    const size_t aligned_fragment_size = ALIGN_INT(fragment_size, fragment_alignment);
-    VERIFY_MSG(arena.size >= aligned_fragment_size, "Network pump's memory size must be at least the size of a single fragment.");
-
-    for (size_t offset = 0; offset < arena.size; offset += aligned_fragment_size) {
-        uint8_t * const fragment_offset = arena.byte_ptr + offset;
-        uint8_t * const fragment_data = fragment_offset + header_size;
-
-        adk_httpx_network_pump_fragment_t * const header = (adk_httpx_network_pump_fragment_t * const)fragment_offset;
-        ZEROMEM(header);
-
-        header->region = MEM_REGION(.ptr = fragment_data, .size = fragment_data_size);
-
-        LL_ADD(header, prev, next, pump->free_list_head, pump->free_list_tail);
-
-        num_fragments++;
-    }
-
-    HTTPX_TRACE_POP();
-    LOG_DEBUG(HTTPX_NETWORK_PUMP, "Created %d fragments of size %d", num_fragments, fragment_size);
-}
-
 void adk_httpx_network_pump_init(
     adk_httpx_client_t * const client,
     const mem_region_t region,
@@ -370,6 +447,10 @@ void adk_httpx_network_pump_init(
     client->network_pump = network_pump;
     network_pump->sleep_period = sleep_period;
     network_pump->client = client;
+    network_pump->guard_page_mode = guard_page_mode;
+    network_pump->fragment_size = fragment_size;
+    network_pump->fragment_stride = ALIGN_INT(fragment_size, ALIGN_OF(adk_httpx_network_pump_fragment_t));
+    VERIFY_MSG(fragment_size > sizeof(adk_httpx_network_pump_fragment_t), "Network pump's fragment size must be larger than the fragment header.");
 
     network_pump->fragment_buffers = region;
     if (!network_pump->fragment_buffers.ptr) {
@@ -382,13 +463,23 @@ void adk_httpx_network_pump_init(
             network_pump->fragment_buffers = sb_map_pages(PAGE_ALIGN_INT(region.size), system_page_protect_read_write);
         }
     }
-    create_fragment_regions(network_pump, fragment_size);
+
+    const uint32_t num_fragments = add_fragments(network_pump, network_pump->fragment_buffers);
+    VERIFY_MSG(num_fragments > 0, "Network pump's memory size must be at least the size of a single fragment.");
+    LOG_DEBUG(HTTPX_NETWORK_PUMP, "Created %d fragments of size %d", num_fragments, fragment_size);
 
     network_pump->free_list_lock = sb_create_mutex(MALLOC_TAG);
     network_pump->free_fragment_enqued = sb_create_condition_variable(MALLOC_TAG);
 
     network_pump->incoming_requests_lock = sb_create_mutex(MALLOC_TAG);
 
+    // curl_multi_wakeup fails on platforms without socketpair support, the pump then polls with a short timeout instead.
+    // A successful wakeup leaves the first wait returning immediately which is harmless.
+    network_pump->can_wakeup = curl_multi_wakeup(client->multi) == CURLM_OK;
+    if (!network_pump->can_wakeup) {
+        LOG_WARN(HTTPX_NETWORK_PUMP, "curl_multi_wakeup is not supported, polling every %ums", sleep_period);
+    }
+
     network_pump->is_running = true;
     network_pump->network_pump_thread = sb_create_thread("m5_net_pump", sb_thread_default_options, &network_pump_proc, network_pump, MALLOC_TAG);
 
@@ -402,8 +493,23 @@ void adk_httpx_network_pump_shutdown(adk_httpx_network_pump_t * const pump) {
     adk_httpx_client_t * const client = pump->client;
 
     pump->is_running = false;
+    curl_multi_wakeup(client->multi);
     sb_join_thread(pump->network_pump_thread);
 
+    VERIFY_MSG(sb_atomic_load(&pump->num_held_fragments, memory_order_acquire) == 0, "All body fragments must be released before the httpx client is freed.");
+
+    for (network_pump_fragment_chunk_t *chunk = pump->grown_chunks, *next; chunk != NULL; chunk = next) {
+        next = chunk->next;
+#ifdef GUARD_PAGE_SUPPORT
+        if (pump->guard_page_mode == system_guard_page_mode_enabled) {
+            debug_sys_unmap_pages(chunk->pages, MALLOC_TAG);
+        } else
+#endif
+        {
+            sb_unmap_pages(chunk->pages);
+        }
+    }
+
     sb_destroy_mutex(pump->free_list_lock, MALLOC_TAG);
     sb_destroy_mutex(pump->incoming_requests_lock, MALLOC_TAG);
     sb_destroy_condition_variable(pump->free_fragment_enqued, MALLOC_TAG);
@@ -421,8 +527,14 @@ void adk_httpx_network_pump_fragments_free(
     adk_httpx_network_pump_fragment_t * const fragments_tail) {
     HTTPX_TRACE_PUSH_FN();
 
+    uint32_t num_fragments = 0;
+    for (const adk_httpx_network_pump_fragment_t * fragment = fragments_head; fragment != NULL; fragment = fragment->next) {
+        ++num_fragments;
+    }
+
     sb_lock_mutex(pump->free_list_lock);
     {
+        pump->num_free_fragments += num_fragments;
         if (pump->free_list_tail) {
             pump->free_list_tail->next = fragments_head;
             fragments_head->prev = pump->free_list_tail;
@@ -437,3 +549,42 @@ void adk_httpx_network_pump_fragments_free(
 
     HTTPX_TRACE_POP();
 }
+
+void adk_httpx_network_pump_fragment_hand_off(adk_httpx_network_pump_fragment_t * const fragment) {
+    fragment->prev = fragment->next = NULL;
+    sb_atomic_fetch_add(&fragment->pump->num_held_fragments, 1, memory_order_relaxed);
+}
+
+void adk_httpx_network_pump_fragment_release(adk_httpx_network_pump_fragment_t * const fragment) {
+    adk_httpx_network_pump_t * const pump = fragment->pump;
+    ASSERT((fragment->prev == NULL) && (fragment->next == NULL));
+
+    adk_httpx_network_pump_fragments_free(pump, fragment, fragment);
+    const int32_t num_held = sb_atomic_fetch_add(&pump->num_held_fragments, -1, memory_order_release);
+    ASSERT(num_held > 0);
+    (void)num_held;
+}
+
+void adk_httpx_network_pump_set_fragment_budget(adk_httpx_network_pump_t * const pump, const size_t budget) {
+    sb_lock_mutex(pump->free_list_lock);
+    pump->fragment_budget = budget;
+    sb_unlock_mutex(pump->free_list_lock);
+}
+
+adk_httpx_fragment_metrics_t adk_httpx_network_pump_get_fragment_metrics(adk_httpx_network_pump_t * const pump) {
+    adk_httpx_fragment_metrics_t metrics;
+    sb_lock_mutex(pump->free_list_lock);
+    {
+        metrics = (adk_httpx_fragment_metrics_t){
+            .fragment_size = (uint32_t)(pump->fragment_size - sizeof(adk_httpx_network_pump_fragment_t)),
+            .num_fragments = pump->num_fragments,
+            .num_free = pump->num_free_fragments,
+            .num_held = (uint32_t)sb_atomic_load(&pump->num_held_fragments, memory_order_relaxed),
+            .num_stalls = pump->num_stalls,
+            .grown_bytes = pump->grown_bytes,
+            .budget = pump->fragment_budget,
+        };
+    }
+    sb_unlock_mutex(pump->free_list_lock);
+    return metrics;
+}
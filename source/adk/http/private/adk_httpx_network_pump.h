@@ -22,6 +22,7 @@ typedef enum adk_httpx_network_pump_fragment_type_e {
 
 struct adk_httpx_network_pump_fragment_t {
     adk_httpx_network_pump_fragment_type_e type;
+    adk_httpx_network_pump_t * pump;
 
     mem_region_t region;
     size_t size;
@@ -31,3 +32,11 @@ struct adk_httpx_network_pump_fragment_t {
 };
 
 void adk_httpx_network_pump_fragments_free(adk_httpx_network_pump_t * const pump, adk_httpx_network_pump_fragment_t * const head, adk_httpx_network_pump_fragment_t * const tail);
+
+// Marks a fragment as owned by an `on_body_fragment` consumer, it goes back to the pool through adk_httpx_network_pump_fragment_release
+void adk_httpx_network_pump_fragment_hand_off(adk_httpx_network_pump_fragment_t * const fragment);
+// Thread safe
+void adk_httpx_network_pump_fragment_release(adk_httpx_network_pump_fragment_t * const fragment);
+
+void adk_httpx_network_pump_set_fragment_budget(adk_httpx_network_pump_t * const pump, const size_t budget);
+adk_httpx_fragment_metrics_t adk_httpx_network_pump_get_fragment_metrics(adk_httpx_network_pump_t * const pump);
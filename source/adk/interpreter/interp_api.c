@@ -8,6 +8,16 @@
 
 wasm_interpreter_t * active_interpreter;
 
+static const char * const export_names[] = {
+#define WASM_WELL_KNOWN_EXPORT(_name) #_name,
+    WASM_WELL_KNOWN_EXPORTS
+#undef WASM_WELL_KNOWN_EXPORT
+};
+
+STATIC_ASSERT(ARRAY_SIZE(export_names) == wasm_export_count);
+
+static wasm_function_handle_t exports[wasm_export_count];
+
 #define VERIFY_WASM_INTERPRETER
 
 static void verify_interpreter_completeness(const wasm_interpreter_t * const interpreter) {
@@ -42,3 +52,25 @@ void * wasm_translate_ptr_wasm_to_native(wasm_ptr_t addr) {
 wasm_ptr_t wasm_translate_ptr_native_to_wasm(void * addr) {
     return active_interpreter->translate_ptr_native_to_wasm(addr);
 }
+
+void wasm_resolve_exports(void) {
+    for (int i = 0; i < wasm_export_count; ++i) {
+        // apps only export the callbacks they use, a missing one fails like a call by name would
+        active_interpreter->find_function(export_names[i], &exports[i]);
+    }
+}
+
+void wasm_reset_exports(void) {
+    for (int i = 0; i < wasm_export_count; ++i) {
+        exports[i] = (wasm_function_handle_t){.name = export_names[i]};
+    }
+}
+
+wasm_function_handle_t wasm_get_export(const wasm_export_e which) {
+    ASSERT((which >= 0) && (which < wasm_export_count));
+    return exports[which];
+}
+
+wasm_call_result_t wasm_call_export(const wasm_export_e which, wasm_call_slot_t * const ret, const uint32_t argc, const wasm_call_slot_t * const args) {
+    return active_interpreter->call_handle(wasm_get_export(which), ret, argc, args);
+}
@@ -61,6 +61,24 @@ typedef struct wasm_call_result_t {
     const char * func_name;
 } wasm_call_result_t;
 
+/// A Wasm export resolved once through `find_function`, so later calls skip the lookup by name.
+/// Handles stay valid until the Wasm binary is unloaded.
+typedef struct wasm_function_handle_t {
+    /// The interpreter's function, NULL if the export was not found.
+    void * function;
+
+    /// The name the handle was resolved from.
+    const char * name;
+} wasm_function_handle_t;
+
+/// An argument or result of a call through a `wasm_function_handle_t`. Each slot must hold the
+/// member matching the Wasm type of its parameter, pointers go in `I` like the `p` signatures do.
+typedef union wasm_call_slot_t {
+    uint32_t i;
+    uint64_t I;
+    float f;
+} wasm_call_slot_t;
+
 typedef size_t (*wasm_fread_t)(void * const buffer, const size_t size, void * const file);
 
 /// An interface that represents a Wasm interpreter.
@@ -172,6 +190,13 @@ typedef struct wasm_interpreter_t {
 
     /// Performs a C -> Wasm function call.
     wasm_call_result_t (*call_rI)(const char * const name, uint64_t * const ret);
+
+    /// Resolves an exported Wasm function for `call_handle`. On failure the handle's `function` is NULL.
+    wasm_call_result_t (*find_function)(const char * const name, wasm_function_handle_t * const out_handle);
+
+    /// Performs a C -> Wasm function call through a resolved handle, with the arguments copied directly
+    /// onto the Wasm stack. `ret` may be NULL.
+    wasm_call_result_t (*call_handle)(const wasm_function_handle_t handle, wasm_call_slot_t * const ret, const uint32_t argc, const wasm_call_slot_t * const args);
 } wasm_interpreter_t;
 
 // Include this in an individual interpreter implementation to make missing signatures a compile-time error.
@@ -206,10 +231,45 @@ typedef struct wasm_interpreter_t {
         WASM_CALLEE_SIGNATURE(ri_argv),  \
         WASM_CALLEE_SIGNATURE(rI)
 
+// Exports called on every frame or from native callbacks, resolved once per load by `wasm_resolve_exports`.
+#define WASM_WELL_KNOWN_EXPORTS                                 \
+    WASM_WELL_KNOWN_EXPORT(app_tick)                            \
+    WASM_WELL_KNOWN_EXPORT(app_drop_callback)                   \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback)               \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_v)             \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_vi)            \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_vvi)           \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_vvii)          \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_ivi)           \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_once_i)        \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_once_ii)       \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_once_iii)      \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_once_iiii)     \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_once_v)        \
+    WASM_WELL_KNOWN_EXPORT(app_dispatch_callback_once_vi)
+
+typedef enum wasm_export_e {
+#define WASM_WELL_KNOWN_EXPORT(_name) TOKENPASTE(wasm_export_, _name),
+    WASM_WELL_KNOWN_EXPORTS
+#undef WASM_WELL_KNOWN_EXPORT
+    wasm_export_count
+} wasm_export_e;
+
 void set_active_wasm_interpreter(wasm_interpreter_t * const interpreter);
 wasm_interpreter_t * get_active_wasm_interpreter(void);
 
 void * wasm_translate_ptr_wasm_to_native(wasm_ptr_t addr);
 wasm_ptr_t wasm_translate_ptr_native_to_wasm(void * addr);
 
+// Resolves the well-known exports through the active interpreter, called once the Wasm binary is loaded.
+void wasm_resolve_exports(void);
+
+// Forgets the resolved exports, called before the Wasm binary is unloaded.
+void wasm_reset_exports(void);
+
+wasm_function_handle_t wasm_get_export(const wasm_export_e which);
+
+// Calls a well-known export through its cached handle.
+wasm_call_result_t wasm_call_export(const wasm_export_e which, wasm_call_slot_t * const ret, const uint32_t argc, const wasm_call_slot_t * const args);
+
 #endif // FFI_GEN
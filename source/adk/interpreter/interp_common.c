@@ -175,6 +175,7 @@ wasm_memory_region_t wasm_load_common(const sb_file_directory_e directory, const
             free_mem_region(wasm_memory.wasm_mem_region);
             return (wasm_memory_region_t){0};
         }
+        wasm_resolve_exports();
     } else {
         free_mem_region(wasm_memory.wasm_mem_region);
         wasm_memory.wasm_mem_region.region.ptr = NULL;
@@ -203,6 +204,7 @@ wasm_memory_region_t wasm_load_fp_common(
             free_mem_region(wasm_memory.wasm_mem_region);
             return (wasm_memory_region_t){0};
         }
+        wasm_resolve_exports();
     } else {
         free_mem_region(wasm_memory.wasm_mem_region);
         wasm_memory.wasm_mem_region.region.ptr = NULL; // return size for error handling
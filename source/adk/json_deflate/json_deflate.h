@@ -72,6 +72,9 @@ heap_metrics_t json_deflate_get_heap_metrics(void);
 
 json_deflate_parse_data_result_t json_deflate_parse_data(const const_mem_region_t schema_layout, const const_mem_region_t data, const mem_region_t buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash);
 void json_deflate_parse_data_async(const const_mem_region_t schema_layout, const const_mem_region_t data, const mem_region_t buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash, void * const on_complete);
+// Parallel mode for the async parsers: big top-level arrays (not nested in another array or map) are deflated in chunks on the
+// thread pool passed to json_deflate_init. Off by default. Can be toggled at any time, a parse that already started keeps its mode.
+void json_deflate_set_parallel_mode(const bool enabled);
 void json_deflate_parse_http_async(const const_mem_region_t schema_layout, adk_curl_handle_t * const http, const mem_region_t buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash, void * const on_deflate_complete);
 
 typedef struct json_deflate_http_future_t json_deflate_http_future_t;
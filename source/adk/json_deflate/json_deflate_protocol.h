@@ -27,7 +27,10 @@ typedef json_deflate_bump_ptr_t json_deflate_bump_snap_t;
 
 enum {
     json_deflate_binary_magic_number = 0x076D,
-    json_deflate_binary_version = 0x4,
+    // 0x5: structs carry a displacement table for their fields (see json_deflate_type_has_field_table)
+    json_deflate_binary_version = 0x5,
+    // oldest layout the runtime still reads, fields sorted by CRC32 of their name
+    json_deflate_binary_minimum_version = 0x4,
     json_deflate_minimum_alignment_requirement = sizeof(json_deflate_bump_ptr_t)
 };
 
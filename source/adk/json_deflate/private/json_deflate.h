@@ -30,6 +30,7 @@ extern "C" {
 
 enum {
     json_deflate_max_string_length = 1024,
+    json_deflate_max_array_chunks = 64,
 };
 
 typedef struct json_deflate_bump_area_owned_t {
@@ -80,7 +81,114 @@ typedef struct json_deflate_context_info_t {
     const char * const path_part;
 } json_deflate_context_info_t;
 
+typedef enum json_deflate_stream_status_e {
+    json_deflate_stream_status_parsing = 0,
+    json_deflate_stream_status_complete = 1,
+    json_deflate_stream_status_failed = 2,
+    // the stream ran out of scratch memory (or a split array failed), the document has to be parsed again by another parser
+    json_deflate_stream_status_fallback = 3,
+} json_deflate_stream_status_e;
+
+typedef struct json_deflate_stream_frame_t json_deflate_stream_frame_t;
+
+typedef struct json_deflate_stream_scratch_block_t {
+    uint8_t * base;
+    size_t capacity;
+} json_deflate_stream_scratch_block_t;
+
+// LIFO staging memory for arrays and maps whose length is only known once they are closed
+typedef struct json_deflate_stream_scratch_t {
+    json_deflate_stream_scratch_block_t * blocks;
+    int32_t num_blocks;
+    int32_t block;
+    size_t top;
+} json_deflate_stream_scratch_t;
+
+// Progress through a multi-byte UTF-8 sequence, kept across fed fragments
+typedef struct json_deflate_utf8_state_t {
+    uint8_t remaining;
+    // valid range of the next continuation byte
+    uint8_t lower;
+    uint8_t upper;
+} json_deflate_utf8_state_t;
+
+// returned by json_deflate_utf8_validate
+#define JSON_DEFLATE_UTF8_INVALID SIZE_MAX
+
+// Element boundaries of an array found by json_deflate_scan_array, offsets are relative to the byte after the opening bracket
+typedef struct json_deflate_array_scan_t {
+    // offset of the closing bracket
+    size_t end;
+    uint32_t count;
+    int32_t num_chunks;
+    // offset and index of the first element of each chunk
+    size_t chunk_offsets[json_deflate_max_array_chunks];
+    uint32_t chunk_first[json_deflate_max_array_chunks];
+} json_deflate_array_scan_t;
+
+// Splitting of top-level arrays (arrays not nested in another array or map) across a thread pool
+typedef struct json_deflate_split_options_t {
+    thread_pool_t * pool;
+    // jobs queued to help the calling thread, which parses chunks as well
+    int32_t num_helpers;
+    // arrays spanning fewer bytes are parsed in place
+    size_t min_array_size;
+    size_t min_chunk_size;
+} json_deflate_split_options_t;
+
+// Single-pass deflate: tokenizes the JSON as it is fed and writes the binary layout while walking the schema
+typedef struct json_deflate_stream_t {
+    json_deflate_bump_area_t schema_area;
+    json_deflate_bump_area_t data_area;
+    json_deflate_schema_context_t ctx;
+    json_deflate_parse_target_e target;
+
+    json_deflate_schema_type_t * ty_root;
+    json_deflate_schema_type_t * ty_integer;
+    json_deflate_schema_type_t * ty_number;
+    json_deflate_schema_type_t * ty_boolean;
+    json_deflate_schema_type_t * ty_char;
+    json_deflate_schema_type_t * ty_string;
+    json_deflate_schema_type_t * ty_ptr;
+    json_deflate_schema_type_t * ty_size;
+    int32_t option_none_index;
+
+    uint8_t * root;
+    char * root_error_msg;
+    const char * slice_path;
+    bool slice_found;
+
+    json_deflate_stream_frame_t * frames;
+    int32_t num_frames;
+    int32_t max_frames;
+    int32_t depth;
+    json_deflate_stream_scratch_t scratch;
+
+    int32_t lex_state;
+    uint8_t escape[12];
+    int32_t escape_length;
+    json_deflate_utf8_state_t utf8;
+    int32_t bom_matched;
+    // input position after the token being handled and the end of the fed fragment, a split array moves `input` past its end
+    const uint8_t * input;
+    const uint8_t * input_end;
+    // NULL unless top-level arrays are split into chunks
+    const json_deflate_split_options_t * split;
+    // error path of the array a chunk stream belongs to
+    const char * path_prefix;
+    char * token;
+    size_t token_length;
+    size_t token_capacity;
+    double number_value;
+    int32_t number_int;
+    bool number_decimalpoint;
+
+    json_deflate_stream_status_e status;
+    json_deflate_parse_status_e failure;
+} json_deflate_stream_t;
+
 thread_pool_t * json_deflate_get_pool(void);
+const json_deflate_split_options_t * json_deflate_get_split_options(void);
 sb_mutex_t * json_deflate_get_parallel_mutex(void);
 sb_condition_variable_t * json_deflate_get_cv(void);
 system_guard_page_mode_e json_deflate_get_guard_mode(void);
@@ -106,6 +214,9 @@ void * json_deflate_bump_get_ptr(const json_deflate_bump_area_t * const area, co
 size_t json_deflate_bump_get_offset(const json_deflate_bump_area_t * const area, const void * const ptr);
 
 uint32_t json_deflate_schema_calculate_field_name_hash(const char * const text);
+uint32_t json_deflate_schema_calculate_key_hash(const char * const text, const size_t length);
+uint32_t json_deflate_schema_field_bucket(const uint32_t hash, const uint32_t field_count);
+uint32_t json_deflate_schema_field_slot(const uint32_t hash, const uint32_t displacement, const uint32_t field_count);
 
 int32_t json_deflate_flag_mask_calculate_shift(const uint32_t mask);
 
@@ -127,6 +238,10 @@ void json_deflate_type_set_non_exhaustive(json_deflate_schema_type_t * const typ
 void json_deflate_type_set_collisions(json_deflate_schema_type_t * const type, const uint8_t val);
 uint8_t json_deflate_type_get_collisions(const json_deflate_schema_type_t * const type);
 
+// fields stored by slot of a minimal perfect hash, the displacement of bucket i is stored in fields[i].reserved
+void json_deflate_type_set_field_table(json_deflate_schema_type_t * const type, const uint8_t val);
+uint8_t json_deflate_type_has_field_table(const json_deflate_schema_type_t * const type);
+
 json_deflate_schema_type_class_t json_deflate_type_get_class(const json_deflate_schema_type_t * const type);
 void json_deflate_type_set_class(json_deflate_schema_type_t * const type, const json_deflate_schema_type_class_t val);
 
@@ -142,11 +257,31 @@ void json_deflate_field_set_can_fail(json_deflate_schema_field_t * const field,
 int json_deflate_find_by_hash(const void * const key, const void * const field);
 
 json_deflate_schema_field_t * json_deflate_type_lookup_field(const json_deflate_bump_area_t * const area, const json_deflate_schema_type_t * const ty, const char * const name);
+json_deflate_schema_field_t * json_deflate_type_lookup_field_with_length(const json_deflate_bump_area_t * const area, const json_deflate_schema_type_t * const ty, const char * const name, const size_t length);
 
 void * json_deflate_process_document(json_deflate_bump_area_t * const data_area, json_deflate_bump_area_t * const schema_area, json_deflate_schema_context_t * const ctx, const json_deflate_parse_target_e target, json_deflate_schema_type_t * const type, cJSON * const json);
 
 cJSON_Env json_deflate_create_alloc_ctx(json_deflate_bump_area_ctx_t * const area);
 
+// Offset of the first byte that is not JSON whitespace (anything up to and including space, as in cJSON)
+size_t json_deflate_scan_whitespace(const uint8_t * const ptr, const size_t size);
+// Offset of the first quote, backslash or non-ASCII byte
+size_t json_deflate_scan_string(const uint8_t * const ptr, const size_t size);
+// Validates up to the first ASCII byte after a complete sequence, returns its offset, size while a sequence is incomplete or JSON_DEFLATE_UTF8_INVALID
+size_t json_deflate_utf8_validate(json_deflate_utf8_state_t * const state, const uint8_t * const ptr, const size_t size);
+// Finds the closing bracket of the array starting at `ptr` (just past the opening bracket) and counts its elements, starting
+// a new chunk at the first element after every `chunk_size` bytes. Returns false if the array is not closed within `size` bytes.
+bool json_deflate_scan_array(const uint8_t * const ptr, const size_t size, const size_t chunk_size, json_deflate_array_scan_t * const out_scan);
+
+void json_deflate_stream_init(json_deflate_stream_t * const stream, const const_mem_region_t schema_layout, const mem_region_t output_buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash);
+bool json_deflate_stream_feed(json_deflate_stream_t * const stream, const const_mem_region_t data);
+json_deflate_stream_status_e json_deflate_stream_finish(json_deflate_stream_t * const stream, json_deflate_parse_result_t * const out_result);
+void json_deflate_stream_destroy(json_deflate_stream_t * const stream);
+
+json_deflate_parse_data_result_t json_deflate_parse_data_stream(const const_mem_region_t schema_layout, const const_mem_region_t data, const mem_region_t buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash, bool * const out_fallback);
+json_deflate_parse_data_result_t json_deflate_parse_data_parallel(const const_mem_region_t schema_layout, const const_mem_region_t data, const mem_region_t buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash, const json_deflate_split_options_t * const options);
+json_deflate_parse_data_result_t json_deflate_parse_data_dom(const const_mem_region_t schema_layout, const const_mem_region_t data, const mem_region_t buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash);
+
 #ifdef __cplusplus
 }
 #endif
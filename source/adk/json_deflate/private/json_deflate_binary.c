@@ -24,7 +24,7 @@ json_deflate_binary_read_status_e json_deflate_binary_read(sb_file_t * const f,
         JSON_DEFLATE_TRACE_POP();
         return json_deflate_binary_read_invalid_format;
     }
-    if (header.version != json_deflate_binary_version) {
+    if ((header.version < json_deflate_binary_minimum_version) || (header.version > json_deflate_binary_version)) {
         JSON_DEFLATE_TRACE_POP();
         return json_deflate_binary_read_unsupported_version;
     }
@@ -59,7 +59,7 @@ json_deflate_binary_read_status_e json_deflate_binary_read_from_memory(const con
         JSON_DEFLATE_TRACE_POP();
         return json_deflate_binary_read_invalid_format;
     }
-    if (header.version != json_deflate_binary_version) {
+    if ((header.version < json_deflate_binary_minimum_version) || (header.version > json_deflate_binary_version)) {
         JSON_DEFLATE_TRACE_POP();
         return json_deflate_binary_read_unsupported_version;
     }
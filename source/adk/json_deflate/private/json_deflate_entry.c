@@ -60,7 +60,13 @@ static void json_deflate_parse_data_async_adapter(void * args, thread_pool_t * c
     json_deflate_parse_data_args_t * const t_args = args;
 
     for (;;) {
-        const json_deflate_parse_data_result_t data_result = json_deflate_parse_data(t_args->schema, t_args->data, t_args->buffer, t_args->target, t_args->expected_size, t_args->schema_hash);
+        json_deflate_parse_data_result_t data_result;
+        const json_deflate_split_options_t * const split_options = json_deflate_get_split_options();
+        if (split_options) {
+            data_result = json_deflate_parse_data_parallel(t_args->schema, t_args->data, t_args->buffer, t_args->target, t_args->expected_size, t_args->schema_hash, split_options);
+        } else {
+            data_result = json_deflate_parse_data(t_args->schema, t_args->data, t_args->buffer, t_args->target, t_args->expected_size, t_args->schema_hash);
+        }
 
         // If we couldn't allocate memory to complete this deflate, wait until another one finishes and try again
         if (data_result.do_retry == true) {
@@ -177,28 +183,90 @@ typedef struct json_deflate_parse_httpx_args_t {
     json_deflate_parse_target_e target;
     uint32_t expected_size;
     uint32_t schema_hash;
+
+    // Body fragments are deflated as they arrive, in batches handed to the pool one at a time
+    bool streaming;
+    adk_httpx_body_fragment_t ** pending;
+    int32_t num_pending;
+    int32_t max_pending;
+    adk_httpx_body_fragment_t ** batch;
+    int32_t num_batch;
+    int32_t max_batch;
+    int32_t num_consumed;
+    bool batch_in_flight;
+    // the batch ends the body, finish the stream after feeding it
+    bool finish_batch;
+    bool body_complete;
+    // the stream could not complete the deflate, parse the buffered body once it is complete
+    bool fallback;
+    bool stream_active;
+    json_deflate_stream_t stream;
+    json_deflate_parse_result_t stream_result;
 } json_deflate_parse_httpx_args_t;
 
 struct json_deflate_http_future_t {
     adk_future_status_e status;
     adk_httpx_response_t * response;
     json_deflate_parse_result_t result;
+    thread_pool_job_handle_t parse_job;
+    // request sent or parse job submitted and not yet completed
+    bool in_flight;
+    // dropped while in flight, freed once the request/parse job completes
+    bool dropped;
 };
 
+static void json_deflate_http_future_free(json_deflate_http_future_t * const future) {
+    adk_httpx_response_free(future->response);
+    json_deflate_free(future);
+}
+
+static void json_deflate_parse_httpx_args_free(json_deflate_parse_httpx_args_t * const args) {
+    for (int32_t i = 0; i < args->num_pending; ++i) {
+        adk_httpx_body_fragment_release(args->pending[i]);
+    }
+
+    if (args->stream_active) {
+        json_deflate_stream_destroy(&args->stream);
+    }
+
+    if (args->pending) {
+        json_deflate_free(args->pending);
+    }
+    if (args->batch) {
+        json_deflate_free(args->batch);
+    }
+    json_deflate_free(args);
+}
+
 static void json_deflate_parse_data_httpx_async_complete_adapter(void * userdata, thread_pool_t * const pool) {
     json_deflate_parse_httpx_args_t * const args = userdata;
+    args->future->in_flight = false;
+    args->future->parse_job = (thread_pool_job_handle_t){0};
+
+    if (args->future->dropped) {
+        json_deflate_http_future_free(args->future);
+        json_deflate_parse_httpx_args_free(args);
+        return;
+    }
+
     ASSERT(args->future->result.status == json_deflate_parse_status_success);
     ASSERT(args->future->result.offset != args->future->result.end);
 
     args->future->status = adk_future_status_ready;
 
-    json_deflate_free(args);
+    json_deflate_parse_httpx_args_free(args);
 }
 
 static void json_deflate_parse_httpx_async_adapter(void * const userdata, thread_pool_t * const pool) {
     json_deflate_parse_httpx_args_t * const args = userdata;
 
     for (;;) {
+        if (thread_pool_current_job_is_cancelled(pool)) {
+            // hand any pending wake to the next waiting deflate
+            json_deflate_queue_continue();
+            break;
+        }
+
         const json_deflate_parse_data_result_t data_result = json_deflate_parse_data(
             args->schema, adk_httpx_response_get_body(args->future->response), args->buffer, args->target, args->expected_size, args->schema_hash);
 
@@ -213,11 +281,173 @@ static void json_deflate_parse_httpx_async_adapter(void * const userdata, thread
     }
 }
 
+static void json_deflate_parse_httpx_submit(json_deflate_parse_httpx_args_t * const args) {
+    const thread_pool_job_desc_t desc = {
+        .job = json_deflate_parse_httpx_async_adapter,
+        .completion_call = json_deflate_parse_data_httpx_async_complete_adapter,
+        .user = args,
+        .priority = thread_pool_priority_normal};
+    args->future->in_flight = true;
+    args->future->parse_job = thread_pool_submit(json_deflate_get_pool(), &desc);
+}
+
+static void json_deflate_parse_httpx_stream_adapter(void * const userdata, thread_pool_t * const pool) {
+    json_deflate_parse_httpx_args_t * const args = userdata;
+    if (thread_pool_current_job_is_cancelled(pool)) {
+        return;
+    }
+
+    if (!args->stream_active) {
+        json_deflate_stream_init(&args->stream, args->schema, args->buffer, args->target, args->expected_size, args->schema_hash);
+        args->stream_active = true;
+    }
+
+    // fragments go back to the network pump as soon as they are consumed
+    for (; args->num_consumed < args->num_batch; ++args->num_consumed) {
+        adk_httpx_body_fragment_t * const fragment = args->batch[args->num_consumed];
+        json_deflate_stream_feed(&args->stream, adk_httpx_body_fragment_get_data(fragment));
+        adk_httpx_body_fragment_release(fragment);
+    }
+
+    if (args->finish_batch) {
+        if (json_deflate_stream_finish(&args->stream, &args->stream_result) == json_deflate_stream_status_fallback) {
+            args->fallback = true;
+        }
+        json_deflate_stream_destroy(&args->stream);
+        args->stream_active = false;
+    } else if (args->stream.status == json_deflate_stream_status_fallback) {
+        args->fallback = true;
+    }
+}
+
+static void json_deflate_parse_httpx_stream_complete_adapter(void * const userdata, thread_pool_t * const pool);
+
+static void json_deflate_parse_httpx_stream_submit(json_deflate_parse_httpx_args_t * const args) {
+    ASSERT(!args->batch_in_flight);
+
+    // hand the pending fragments to the job, new ones queue up behind it
+    adk_httpx_body_fragment_t ** const batch = args->batch;
+    const int32_t max_batch = args->max_batch;
+    args->batch = args->pending;
+    args->max_batch = args->max_pending;
+    args->num_batch = args->num_pending;
+    args->pending = batch;
+    args->max_pending = max_batch;
+    args->num_pending = 0;
+
+    args->num_consumed = 0;
+    args->finish_batch = args->body_complete;
+    args->batch_in_flight = true;
+
+    const thread_pool_job_desc_t desc = {
+        .job = json_deflate_parse_httpx_stream_adapter,
+        .completion_call = json_deflate_parse_httpx_stream_complete_adapter,
+        .user = args,
+        .priority = thread_pool_priority_normal};
+    args->future->parse_job = thread_pool_submit(json_deflate_get_pool(), &desc);
+}
+
+static void json_deflate_parse_httpx_fall_back(json_deflate_parse_httpx_args_t * const args) {
+    LOG_DEBUG(TAG_JSON_DEFLATE, "[json_deflate] Streaming deflate ran out of scratch memory, parsing the buffered body instead");
+    if (args->stream_active) {
+        json_deflate_stream_destroy(&args->stream);
+        args->stream_active = false;
+    }
+    json_deflate_parse_httpx_submit(args);
+}
+
+static void json_deflate_parse_httpx_stream_complete_adapter(void * const userdata, thread_pool_t * const pool) {
+    json_deflate_parse_httpx_args_t * const args = userdata;
+    json_deflate_http_future_t * const future = args->future;
+
+    // fragments of a cancelled batch were not consumed
+    for (int32_t i = args->num_consumed; i < args->num_batch; ++i) {
+        adk_httpx_body_fragment_release(args->batch[i]);
+    }
+    args->num_batch = args->num_consumed = 0;
+    args->batch_in_flight = false;
+    future->parse_job = (thread_pool_job_handle_t){0};
+
+    if (future->dropped) {
+        // otherwise `httpx_on_complete` frees once the aborted request completes
+        if (args->body_complete) {
+            json_deflate_http_future_free(future);
+            json_deflate_parse_httpx_args_free(args);
+        }
+        return;
+    }
+
+    if (args->fallback) {
+        for (int32_t i = 0; i < args->num_pending; ++i) {
+            adk_httpx_body_fragment_release(args->pending[i]);
+        }
+        args->num_pending = 0;
+
+        if (args->body_complete) {
+            json_deflate_parse_httpx_fall_back(args);
+        }
+        return;
+    }
+
+    if (args->finish_batch) {
+        future->in_flight = false;
+        future->result = args->stream_result;
+
+        ASSERT(future->result.status == json_deflate_parse_status_success);
+        ASSERT(future->result.offset != future->result.end);
+
+        future->status = adk_future_status_ready;
+        json_deflate_parse_httpx_args_free(args);
+    } else if (args->num_pending || args->body_complete) {
+        json_deflate_parse_httpx_stream_submit(args);
+    }
+}
+
+static bool httpx_on_body_fragment(adk_httpx_response_t * const response, adk_httpx_body_fragment_t * const fragment, void * userdata) {
+    json_deflate_parse_httpx_args_t * const args = (json_deflate_parse_httpx_args_t *)userdata;
+    if (args->future->dropped || args->fallback) {
+        adk_httpx_body_fragment_release(fragment);
+        // a dropped future aborts the download
+        return !args->future->dropped;
+    }
+
+    if (args->num_pending == args->max_pending) {
+        args->max_pending = args->max_pending ? args->max_pending * 2 : 16;
+        args->pending = json_deflate_realloc(args->pending, args->max_pending * sizeof(*args->pending));
+    }
+    args->pending[args->num_pending++] = fragment;
+
+    if (!args->batch_in_flight) {
+        json_deflate_parse_httpx_stream_submit(args);
+    }
+
+    return true;
+}
+
 static void httpx_on_complete(adk_httpx_response_t * const response, void * userdata) {
     json_deflate_parse_httpx_args_t * const args = (json_deflate_parse_httpx_args_t *)userdata;
 
-    args->future->response = response;
-    thread_pool_enqueue(json_deflate_get_pool(), json_deflate_parse_httpx_async_adapter, json_deflate_parse_data_httpx_async_complete_adapter, args);
+    json_deflate_http_future_t * const future = args->future;
+
+    future->response = response;
+    args->body_complete = true;
+    if (future->dropped) {
+        if (!args->batch_in_flight) {
+            json_deflate_http_future_free(future);
+            json_deflate_parse_httpx_args_free(args);
+        }
+        return;
+    }
+
+    if (!args->streaming) {
+        json_deflate_parse_httpx_submit(args);
+    } else if (args->fallback) {
+        if (!args->batch_in_flight) {
+            json_deflate_parse_httpx_fall_back(args);
+        }
+    } else if (!args->batch_in_flight) {
+        json_deflate_parse_httpx_stream_submit(args);
+    }
 }
 
 static json_deflate_parse_httpx_args_t * json_deflate_parse_httpx_args(
@@ -265,6 +495,12 @@ json_deflate_http_future_t * json_deflate_parse_httpx_async(
         schema_hash,
         future);
 
+    // the buffered body backs `json_deflate_http_future_get_response`, resizes and the fallback parse
+    args->streaming = true;
+    adk_httpx_request_set_buffering_mode(request, adk_httpx_buffering_mode_body | adk_httpx_buffering_mode_header);
+
+    future->in_flight = true;
+    adk_httpx_request_set_on_body_fragment(request, httpx_on_body_fragment);
     adk_httpx_request_set_on_complete(request, httpx_on_complete);
     adk_httpx_request_set_userdata(request, args);
     adk_httpx_send(request);
@@ -296,7 +532,7 @@ json_deflate_http_future_t * json_deflate_parse_httpx_response_async(
     args->expected_size = expected_size;
     args->schema_hash = schema_hash;
 
-    thread_pool_enqueue(json_deflate_get_pool(), json_deflate_parse_httpx_async_adapter, json_deflate_parse_data_httpx_async_complete_adapter, args);
+    json_deflate_parse_httpx_submit(args);
 
     return future;
 }
@@ -339,8 +575,14 @@ json_deflate_parse_result_t json_deflate_http_future_get_result(const json_defla
 }
 
 void json_deflate_http_future_drop(json_deflate_http_future_t * const future) {
-    adk_httpx_response_free(future->response);
-    json_deflate_free(future);
+    if (future->in_flight) {
+        // skip the parse if it hasn't started yet, the completion frees the future
+        future->dropped = true;
+        thread_pool_cancel(json_deflate_get_pool(), future->parse_job);
+        return;
+    }
+
+    json_deflate_http_future_free(future);
 }
 
 // ========================================
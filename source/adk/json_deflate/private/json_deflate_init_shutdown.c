@@ -27,12 +27,29 @@ static struct {
 
     sb_mutex_t * parallel_mutex;
     sb_condition_variable_t * cv;
+
+    json_deflate_split_options_t split_options;
+    // read by pool threads when an async parse starts, `split_options` itself never changes after init
+    sb_atomic_int32_t parallel_mode;
 } statics;
 
+enum {
+    json_deflate_split_min_array_size = 64 * 1024,
+    json_deflate_split_min_chunk_size = 16 * 1024,
+};
+
 thread_pool_t * json_deflate_get_pool(void) {
     return statics.pool;
 }
 
+const json_deflate_split_options_t * json_deflate_get_split_options(void) {
+    return sb_atomic_load(&statics.parallel_mode, memory_order_relaxed) ? &statics.split_options : NULL;
+}
+
+void json_deflate_set_parallel_mode(const bool enabled) {
+    sb_atomic_store(&statics.parallel_mode, enabled ? 1 : 0, memory_order_relaxed);
+}
+
 sb_mutex_t * json_deflate_get_parallel_mutex(void) {
     return statics.parallel_mutex;
 }
@@ -111,6 +128,12 @@ void json_deflate_init(const mem_region_t region, const system_guard_page_mode_e
     statics.parallel_mutex = sb_create_mutex(MALLOC_TAG);
     statics.pool = thread_pool;
     statics.cv = sb_create_condition_variable(MALLOC_TAG);
+    statics.split_options = (json_deflate_split_options_t){
+        .pool = thread_pool,
+        .num_helpers = thread_pool->thread_count,
+        .min_array_size = json_deflate_split_min_array_size,
+        .min_chunk_size = json_deflate_split_min_chunk_size,
+    };
 
 #ifdef GUARD_PAGE_SUPPORT
     statics.guard_mode = guard_page_mode;
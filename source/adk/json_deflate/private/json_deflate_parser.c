@@ -102,7 +102,48 @@ static json_deflate_parse_data_result_t create_error_data_result(const json_defl
     return data_result;
 }
 
-json_deflate_parse_data_result_t json_deflate_parse_data(const const_mem_region_t schema_layout, const const_mem_region_t json_data, const mem_region_t output_buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash) {
+static bool is_valid_utf8(const char * const str, const size_t length) {
+    const uint8_t * const ptr = (const uint8_t *)str;
+    json_deflate_utf8_state_t utf8 = {0};
+    size_t i = 0;
+    while (i < length) {
+        if (!utf8.remaining) {
+            i += json_deflate_scan_string(ptr + i, length - i);
+            if (i == length) {
+                break;
+            } else if (ptr[i] < 0x80) {
+                // quote or backslash decoded from an escape
+                ++i;
+                continue;
+            }
+        }
+
+        const size_t valid = json_deflate_utf8_validate(&utf8, ptr + i, length - i);
+        if (valid == JSON_DEFLATE_UTF8_INVALID) {
+            return false;
+        }
+        i += valid;
+    }
+    return utf8.remaining == 0;
+}
+
+// Rust strings must be valid UTF-8, which cJSON never checked, keys are checked too like in the streaming parser
+static bool dom_strings_are_valid_utf8(const cJSON * node) {
+    for (; node; node = node->next) {
+        if (node->string && !is_valid_utf8(node->string, strlen(node->string))) {
+            return false;
+        }
+        if (cJSON_IsString(node) && !is_valid_utf8(node->valuestring, node->valuestring_length)) {
+            return false;
+        }
+        if (node->child && !dom_strings_are_valid_utf8(node->child)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+json_deflate_parse_data_result_t json_deflate_parse_data_dom(const const_mem_region_t schema_layout, const const_mem_region_t json_data, const mem_region_t output_buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash) {
     JSON_DEFLATE_TRACE_PUSH_FN();
     if (json_data.size == 0) {
         JSON_DEFLATE_TRACE_POP();
@@ -192,6 +233,14 @@ json_deflate_parse_data_result_t json_deflate_parse_data(const const_mem_region_
         }
     }
 
+    if (!dom_strings_are_valid_utf8(data_root)) {
+        json_deflate_bump_owned_destroy(&graph_area);
+        conditional_free_data_from_protected_region(protected_pages);
+        json_deflate_parse_data_result_t ret = create_error_data_result(json_deflate_parse_status_invalid_json, false);
+        JSON_DEFLATE_TRACE_POP();
+        return ret;
+    }
+
     const char * const slice_path = json_deflate_bump_get_ptr(&schema_area, ctx->slice_path);
     cJSON * const data_slice = slice_path ? json_deflate_data_navigate_to(data_root, slice_path) : data_root;
     VERIFY_MSG(data_slice, "[json_deflate] Failed to navigate to slice");
@@ -237,3 +286,69 @@ json_deflate_parse_data_result_t json_deflate_parse_data(const const_mem_region_
     JSON_DEFLATE_TRACE_POP();
     return success_result;
 }
+
+static json_deflate_parse_data_result_t parse_data_stream(const const_mem_region_t schema_layout, const const_mem_region_t json_data, const mem_region_t output_buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash, const json_deflate_split_options_t * const split, bool * const out_fallback) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    *out_fallback = false;
+    if (json_data.size == 0) {
+        JSON_DEFLATE_TRACE_POP();
+        return create_error_data_result(json_deflate_parse_status_invalid_json, false);
+    }
+
+    const microseconds_t full_start = adk_read_microsecond_clock();
+
+    mem_region_t protected_pages = {0};
+    const const_mem_region_t json_data_protected = conditional_copy_data_to_protected_region(json_data, &protected_pages);
+
+    json_deflate_stream_t stream;
+    json_deflate_stream_init(&stream, schema_layout, output_buffer, target, expected_size, schema_hash);
+    stream.split = split;
+    json_deflate_stream_feed(&stream, json_data_protected);
+
+    json_deflate_parse_data_result_t data_result = {0};
+    const json_deflate_stream_status_e status = json_deflate_stream_finish(&stream, &data_result.result);
+    json_deflate_stream_destroy(&stream);
+    conditional_free_data_from_protected_region(protected_pages);
+
+    *out_fallback = status == json_deflate_stream_status_fallback;
+
+    const microseconds_t full_end = adk_read_microsecond_clock();
+    LOG_DEBUG(TAG_JSON_DEFLATE, "[json_deflate] Timings -- Stream%s: %llu us", split ? " (split arrays)" : "", full_end.us - full_start.us);
+
+    JSON_DEFLATE_TRACE_POP();
+    return data_result;
+}
+
+json_deflate_parse_data_result_t json_deflate_parse_data_stream(const const_mem_region_t schema_layout, const const_mem_region_t json_data, const mem_region_t output_buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash, bool * const out_fallback) {
+    return parse_data_stream(schema_layout, json_data, output_buffer, target, expected_size, schema_hash, NULL, out_fallback);
+}
+
+json_deflate_parse_data_result_t json_deflate_parse_data_parallel(const const_mem_region_t schema_layout, const const_mem_region_t json_data, const mem_region_t output_buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash, const json_deflate_split_options_t * const options) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    bool fallback = false;
+    json_deflate_parse_data_result_t result = parse_data_stream(schema_layout, json_data, output_buffer, target, expected_size, schema_hash, options, &fallback);
+
+    // split arrays only handle the common case, everything else (including reporting invalid JSON) is left to the sequential parsers
+    if (fallback) {
+        LOG_DEBUG(TAG_JSON_DEFLATE, "[json_deflate] Parallel deflate fell back to the sequential parsers");
+        result = json_deflate_parse_data(schema_layout, json_data, output_buffer, target, expected_size, schema_hash);
+    }
+
+    JSON_DEFLATE_TRACE_POP();
+    return result;
+}
+
+json_deflate_parse_data_result_t json_deflate_parse_data(const const_mem_region_t schema_layout, const const_mem_region_t json_data, const mem_region_t output_buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    bool fallback = false;
+    json_deflate_parse_data_result_t result = json_deflate_parse_data_stream(schema_layout, json_data, output_buffer, target, expected_size, schema_hash, &fallback);
+
+    // the streaming parser stages arrays and maps in heap memory, parse again with the DOM parser when that runs out
+    if (fallback) {
+        LOG_DEBUG(TAG_JSON_DEFLATE, "[json_deflate] Streaming parser ran out of scratch memory, falling back to the DOM parser");
+        result = json_deflate_parse_data_dom(schema_layout, json_data, output_buffer, target, expected_size, schema_hash);
+    }
+
+    JSON_DEFLATE_TRACE_POP();
+    return result;
+}
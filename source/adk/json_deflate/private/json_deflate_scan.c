@@ -0,0 +1,271 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+json_deflate_scan.c
+
+Block scanning for the JSON deflate tokenizer: finds the end of whitespace and string runs 16/32 bytes at a time
+(SSE2/AVX2 on x86, NEON on ARM, 8 bytes at a time otherwise) and validates UTF-8 in strings.
+Also holds the structural pre-scan that cuts a large array into chunks for parallel deflating.
+*/
+
+#include "source/adk/json_deflate/private/json_deflate.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JSON_DEFLATE_SCAN_NEON
+#elif defined(__AVX2__)
+#define JSON_DEFLATE_SCAN_AVX2
+#elif defined(_SSE2)
+#define JSON_DEFLATE_SCAN_SSE2
+#endif
+
+// ========================================
+// scalar, used for the tail of the input and on targets without vector units
+
+static size_t scan_whitespace_scalar(const uint8_t * const ptr, const size_t offset, const size_t size) {
+    size_t i = offset;
+    while ((i < size) && (ptr[i] <= ' ')) {
+        ++i;
+    }
+    return i;
+}
+
+static size_t scan_string_scalar(const uint8_t * const ptr, const size_t offset, const size_t size) {
+    size_t i = offset;
+    while ((i < size) && (ptr[i] != '\"') && (ptr[i] != '\\') && (ptr[i] < 0x80)) {
+        ++i;
+    }
+    return i;
+}
+
+#if !defined(JSON_DEFLATE_SCAN_NEON) && !defined(JSON_DEFLATE_SCAN_AVX2) && !defined(JSON_DEFLATE_SCAN_SSE2)
+// SWAR: a lane matches when its high bit is set; matches only send the loop to the scalar tail so
+// swar_has_byte's false positives above a true match are harmless
+static const uint64_t swar_ones = 0x0101010101010101ull;
+static const uint64_t swar_highs = 0x8080808080808080ull;
+
+static uint64_t swar_has_byte(const uint64_t word, const uint8_t byte) {
+    const uint64_t x = word ^ (swar_ones * byte);
+    return (x - swar_ones) & ~x & swar_highs;
+}
+
+// exact per lane: the low 7 bits plus (0x7F - byte) cannot carry into the next lane
+static uint64_t swar_greater_than(const uint64_t word, const uint8_t byte) {
+    return (((word & ~swar_highs) + swar_ones * (0x7F - byte)) | word) & swar_highs;
+}
+#endif
+
+// ========================================
+
+size_t json_deflate_scan_whitespace(const uint8_t * const ptr, const size_t size) {
+    size_t i = 0;
+#if defined(JSON_DEFLATE_SCAN_AVX2)
+    const __m256i space = _mm256_set1_epi8(' ');
+    for (; i + 32 <= size; i += 32) {
+        const __m256i block = _mm256_loadu_si256((const __m256i *)(ptr + i));
+        // bytes <= space are unchanged by min(block, space)
+        const uint32_t whitespace = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(block, space), block));
+        if (whitespace != UINT32_MAX) {
+            return i + __builtin_ctz(~whitespace);
+        }
+    }
+#elif defined(JSON_DEFLATE_SCAN_SSE2)
+    const __m128i space = _mm_set1_epi8(' ');
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i *)(ptr + i));
+        const uint32_t whitespace = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(block, space), block));
+        if (whitespace != 0xFFFF) {
+            return i + __builtin_ctz(~whitespace);
+        }
+    }
+#elif defined(JSON_DEFLATE_SCAN_NEON)
+    const uint8x16_t space = vdupq_n_u8(' ');
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t non_whitespace = vcgtq_u8(vld1q_u8(ptr + i), space);
+        // narrow to 4 bits per byte to get a scalar mask
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(non_whitespace), 4)), 0);
+        if (mask) {
+            return i + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+#else
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, ptr + i, sizeof(word));
+        if (swar_greater_than(word, ' ')) {
+            break;
+        }
+    }
+#endif
+    return scan_whitespace_scalar(ptr, i, size);
+}
+
+size_t json_deflate_scan_string(const uint8_t * const ptr, const size_t size) {
+    size_t i = 0;
+#if defined(JSON_DEFLATE_SCAN_AVX2)
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    for (; i + 32 <= size; i += 32) {
+        const __m256i block = _mm256_loadu_si256((const __m256i *)(ptr + i));
+        const __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)), block);
+        // the high bit flags quotes, backslashes and non-ASCII bytes
+        const uint32_t mask = (uint32_t)_mm256_movemask_epi8(special);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(JSON_DEFLATE_SCAN_SSE2)
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i *)(ptr + i));
+        const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)), block);
+        const uint32_t mask = (uint32_t)_mm_movemask_epi8(special);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(JSON_DEFLATE_SCAN_NEON)
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t high = vdupq_n_u8(0x80);
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t block = vld1q_u8(ptr + i);
+        const uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash)), vcgeq_u8(block, high));
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+        if (mask) {
+            return i + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+#else
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, ptr + i, sizeof(word));
+        if (swar_has_byte(word, '\"') | swar_has_byte(word, '\\') | (word & swar_highs)) {
+            break;
+        }
+    }
+#endif
+    return scan_string_scalar(ptr, i, size);
+}
+
+size_t json_deflate_utf8_validate(json_deflate_utf8_state_t * const state, const uint8_t * const ptr, const size_t size) {
+    size_t i = 0;
+    for (;;) {
+        // continuation bytes of the current sequence
+        while (state->remaining) {
+            if (i == size) {
+                return i;
+            }
+
+            const uint8_t c = ptr[i];
+            if ((c < state->lower) || (c > state->upper)) {
+                return JSON_DEFLATE_UTF8_INVALID;
+            }
+            state->lower = 0x80;
+            state->upper = 0xBF;
+            --state->remaining;
+            ++i;
+        }
+
+        if ((i == size) || (ptr[i] < 0x80)) {
+            return i;
+        }
+
+        // lead byte, ranges exclude overlong encodings, surrogates and code points above U+10FFFF
+        const uint8_t lead = ptr[i++];
+        state->lower = 0x80;
+        state->upper = 0xBF;
+        if ((lead >= 0xC2) && (lead <= 0xDF)) {
+            state->remaining = 1;
+        } else if ((lead >= 0xE0) && (lead <= 0xEF)) {
+            state->remaining = 2;
+            if (lead == 0xE0) {
+                state->lower = 0xA0;
+            } else if (lead == 0xED) {
+                state->upper = 0x9F;
+            }
+        } else if ((lead >= 0xF0) && (lead <= 0xF4)) {
+            state->remaining = 3;
+            if (lead == 0xF0) {
+                state->lower = 0x90;
+            } else if (lead == 0xF4) {
+                state->upper = 0x8F;
+            }
+        } else {
+            return JSON_DEFLATE_UTF8_INVALID;
+        }
+    }
+}
+
+// ========================================
+// structural pre-scan for splitting arrays, only brackets, braces, commas and strings are looked at
+
+bool json_deflate_scan_array(const uint8_t * const ptr, const size_t size, const size_t chunk_size, json_deflate_array_scan_t * const out_scan) {
+    ZEROMEM(out_scan);
+    out_scan->num_chunks = 1;
+
+    uint32_t commas = 0;
+    int32_t depth = 0;
+    bool has_elements = false;
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t c = ptr[i];
+        if (c <= ' ') {
+            i += json_deflate_scan_whitespace(ptr + i, size - i);
+            continue;
+        }
+
+        switch (c) {
+            case '\"':
+                // escapes are skipped whole so an escaped quote does not end the string
+                for (++i;;) {
+                    i += json_deflate_scan_string(ptr + i, size - i);
+                    if (i >= size) {
+                        return false;
+                    } else if (ptr[i] == '\"') {
+                        break;
+                    }
+                    i += (ptr[i] == '\\') ? 2 : 1;
+                }
+                break;
+            case '[':
+            case '{':
+                ++depth;
+                break;
+            case ']':
+            case '}':
+                if (depth == 0) {
+                    if (c != ']') {
+                        return false;
+                    }
+                    out_scan->end = i;
+                    out_scan->count = has_elements ? commas + 1 : 0;
+                    return true;
+                }
+                --depth;
+                break;
+            case ',':
+                if (depth == 0) {
+                    ++commas;
+                    const int32_t chunk = out_scan->num_chunks;
+                    if ((chunk < json_deflate_max_array_chunks) && (i + 1 - out_scan->chunk_offsets[chunk - 1] >= chunk_size)) {
+                        out_scan->chunk_offsets[chunk] = i + 1;
+                        out_scan->chunk_first[chunk] = commas;
+                        out_scan->num_chunks++;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+        has_elements = true;
+        ++i;
+    }
+
+    return false;
+}
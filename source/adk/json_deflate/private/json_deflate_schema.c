@@ -22,6 +22,54 @@ uint32_t json_deflate_schema_calculate_field_name_hash(const char * const text)
     return ret;
 }
 
+static uint64_t load_le64(const uint8_t * const bytes) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+static uint64_t load_le_tail(const uint8_t * const bytes, const size_t length) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < length; i++) {
+        word |= (uint64_t)bytes[i] << (i * 8);
+    }
+    return word;
+}
+
+// Multiply-xorshift over 8-byte words, little endian regardless of the host so the tool and every target agree
+uint32_t json_deflate_schema_calculate_key_hash(const char * const text, const size_t length) {
+    const uint8_t * const bytes = (const uint8_t *)text;
+    const uint64_t multiplier = 0x9FB21C651E98DF25ull;
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        hash = (hash ^ load_le64(bytes + i)) * multiplier;
+        hash ^= hash >> 29;
+    }
+    hash = (hash ^ load_le_tail(bytes + i, length - i)) * multiplier;
+    hash ^= hash >> 32;
+    hash *= multiplier;
+    hash ^= hash >> 29;
+    return (uint32_t)hash;
+}
+
+uint32_t json_deflate_schema_field_bucket(const uint32_t hash, const uint32_t field_count) {
+    return (uint32_t)(((uint64_t)hash * field_count) >> 32);
+}
+
+uint32_t json_deflate_schema_field_slot(const uint32_t hash, const uint32_t displacement, const uint32_t field_count) {
+    uint32_t x = hash ^ (displacement * 0x9E3779B9u);
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return (uint32_t)(((uint64_t)x * field_count) >> 32);
+}
+
 int32_t json_deflate_flag_mask_calculate_shift(const uint32_t mask) {
     uint32_t m_mask = mask;
     if (!m_mask) {
@@ -87,6 +135,14 @@ uint8_t json_deflate_type_get_collisions(const json_deflate_schema_type_t * cons
     return json_deflate_flags_get_value(&type->flags, 0x08);
 }
 
+void json_deflate_type_set_field_table(json_deflate_schema_type_t * const type, const uint8_t val) {
+    json_deflate_flags_set_value(&type->flags, val, 0x04);
+}
+
+uint8_t json_deflate_type_has_field_table(const json_deflate_schema_type_t * const type) {
+    return json_deflate_flags_get_value(&type->flags, 0x04);
+}
+
 void json_deflate_type_set_class(json_deflate_schema_type_t * const type, const json_deflate_schema_type_class_t val) {
     json_deflate_flags_set_value(&type->flags, val, 0x03);
 }
@@ -177,10 +233,23 @@ static json_deflate_schema_field_t * lookup_field_binary_resolve_collisions(cons
     return NULL;
 }
 
-json_deflate_schema_field_t * json_deflate_type_lookup_field(const json_deflate_bump_area_t * const area, const json_deflate_schema_type_t * const ty, const char * const name) {
+json_deflate_schema_field_t * json_deflate_type_lookup_field_with_length(const json_deflate_bump_area_t * const area, const json_deflate_schema_type_t * const ty, const char * const name, const size_t length) {
     JSON_DEFLATE_TRACE_PUSH_FN();
-    const uint32_t hash = json_deflate_schema_calculate_field_name_hash(name);
     json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(area, ty->fields);
+    if (json_deflate_type_has_field_table(ty)) {
+        // one hash, one probe
+        const uint32_t hash = json_deflate_schema_calculate_key_hash(name, length);
+        const uint32_t displacement = fields[json_deflate_schema_field_bucket(hash, ty->field_count)].reserved;
+        json_deflate_schema_field_t * const field = &fields[json_deflate_schema_field_slot(hash, displacement, ty->field_count)];
+        if ((field->hash == hash) && !strcmp(json_deflate_bump_get_ptr(area, field->json_name), name)) {
+            JSON_DEFLATE_TRACE_POP();
+            return field;
+        }
+        JSON_DEFLATE_TRACE_POP();
+        return NULL;
+    }
+
+    const uint32_t hash = json_deflate_schema_calculate_field_name_hash(name);
     if (json_deflate_type_get_collisions(ty) || ty->field_count < 2) {
         json_deflate_schema_field_t * ret = lookup_field_binary_resolve_collisions(area, fields, ty->field_count, name, hash);
         JSON_DEFLATE_TRACE_POP();
@@ -195,6 +264,10 @@ json_deflate_schema_field_t * json_deflate_type_lookup_field(const json_deflate_
     }
 }
 
+json_deflate_schema_field_t * json_deflate_type_lookup_field(const json_deflate_bump_area_t * const area, const json_deflate_schema_type_t * const ty, const char * const name) {
+    return json_deflate_type_lookup_field_with_length(area, ty, name, strlen(name));
+}
+
 cJSON * json_deflate_data_navigate_to(cJSON * const json, const char * const path) {
     JSON_DEFLATE_TRACE_PUSH_FN();
     if (!path) {
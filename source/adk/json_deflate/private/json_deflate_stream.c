@@ -0,0 +1,1946 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+json_deflate_stream.c
+
+Single-pass JSON deflate: tokenizes the JSON incrementally and writes the binary layout while walking the schema, without
+building a cJSON tree first. Produces the same values (and error messages) as json_deflate_process_document.
+
+Values nested in arrays and maps are written to LIFO scratch memory until the container closes, then copied to the data
+area in one piece. Everything a value points to lives in the data area already, so moving the value bytes is safe.
+
+With split options, big top-level arrays are pre-scanned for element boundaries and their elements are parsed in chunks on
+a thread pool, each chunk by its own stream allocating from its own part of the output buffer (see stream_split_array).
+*/
+
+#include "source/adk/interpreter/interp_api.h"
+#include "source/adk/json_deflate/json_deflate.h"
+#include "source/adk/json_deflate/private/json_deflate.h"
+#include "source/adk/log/log.h"
+#include "source/adk/runtime/crc.h"
+#include "source/adk/steamboat/sb_thread.h"
+
+#include <ctype.h>
+
+enum {
+    json_deflate_stream_scratch_block_size = 64 * 1024,
+    json_deflate_stream_initial_frames = 32,
+    json_deflate_stream_initial_token_capacity = 256,
+    // same limit cJSON enforces
+    json_deflate_stream_max_depth = 1000,
+    json_deflate_stream_max_number_length = 63,
+    json_deflate_stream_max_error_message_length = 1024,
+    // chunks of a split array are moved by multiples of this so the values they hold stay aligned
+    json_deflate_stream_chunk_alignment = 16,
+};
+
+typedef enum stream_lex_state_e {
+    stream_lex_bom = 0,
+    stream_lex_between,
+    stream_lex_string,
+    stream_lex_escape,
+    stream_lex_number,
+    stream_lex_literal,
+    // the root value has been parsed, trailing input is ignored like cJSON_Parse does
+    stream_lex_done,
+} stream_lex_state_e;
+
+typedef enum stream_token_e {
+    stream_token_object_begin,
+    stream_token_object_end,
+    stream_token_array_begin,
+    stream_token_array_end,
+    stream_token_colon,
+    stream_token_comma,
+    stream_token_string,
+    stream_token_number,
+    stream_token_true,
+    stream_token_false,
+    stream_token_null,
+} stream_token_e;
+
+typedef enum stream_frame_kind_e {
+    stream_frame_struct,
+    stream_frame_array,
+    stream_frame_map,
+    // Ok value in progress, switches to Err once the value completes with an error
+    stream_frame_result,
+    stream_frame_skip_object,
+    stream_frame_skip_array,
+    // object on the way to the slice root
+    stream_frame_slice,
+    // elements of a split array, written in place and never closed
+    stream_frame_chunk,
+} stream_frame_kind_e;
+
+typedef enum stream_frame_state_e {
+    stream_state_key_or_end,
+    stream_state_key,
+    stream_state_colon,
+    stream_state_value,
+    stream_state_value_or_end,
+    stream_state_comma_or_end,
+} stream_frame_state_e;
+
+typedef struct stream_scratch_mark_t {
+    int32_t block;
+    size_t top;
+} stream_scratch_mark_t;
+
+// Map entries are staged as a record followed by the value
+typedef struct stream_map_entry_t {
+    uint32_t hash;
+    uint32_t length;
+    char * string;
+} stream_map_entry_t;
+
+struct json_deflate_stream_frame_t {
+    stream_frame_kind_e kind;
+    stream_frame_state_e state;
+    json_deflate_schema_type_t * type;
+    uint8_t * dest;
+    // frame holding the error message for this value, -1 for the root
+    int32_t error_slot;
+    stream_scratch_mark_t mark;
+
+    // destination of the value following the last key, NULL type skips the value
+    json_deflate_schema_type_t * value_type;
+    uint8_t * value_dest;
+    const char * path_part;
+
+    // struct
+    uint8_t * checkmarks;
+    int32_t field_index;
+    bool broken;
+
+    // array elements or map entries
+    json_deflate_schema_type_t * elem_type;
+    uint8_t * items;
+    uint32_t count;
+    uint32_t stride;
+    uint32_t value_offset;
+    // chunk: index of the first element and number of elements
+    uint32_t first_index;
+    uint32_t capacity;
+
+    // slice
+    const char * slice_path;
+    const char * value_slice_path;
+    bool slice_matched;
+
+    // result
+    char * inner_error_msg;
+};
+
+static const char * const JSON_BOOLEAN = "boolean";
+static const char * const JSON_INTEGER = "integer";
+static const char * const JSON_NUMBER = "number";
+static const char * const JSON_STRING = "string";
+static const char * const JSON_OBJECT = "object";
+static const char * const JSON_MAP = "map (object)";
+static const char * const JSON_ARRAY = "array";
+static const char * const JSON_NULL = "null";
+
+// ========================================
+// memory
+
+static bool stream_grow(void ** const ptr, const size_t old_size, const size_t new_size) {
+    void * const grown = json_deflate_unchecked_calloc(1, new_size);
+    if (!grown) {
+        return false;
+    }
+
+    if (*ptr) {
+        memcpy(grown, *ptr, old_size);
+        json_deflate_free(*ptr);
+    }
+
+    *ptr = grown;
+    return true;
+}
+
+static void stream_fail(json_deflate_stream_t * const stream, const json_deflate_parse_status_e failure) {
+    if (stream->status == json_deflate_stream_status_parsing) {
+        stream->status = json_deflate_stream_status_failed;
+        stream->failure = failure;
+    }
+    stream->lex_state = stream_lex_done;
+}
+
+static void stream_fallback(json_deflate_stream_t * const stream) {
+    if (stream->status == json_deflate_stream_status_parsing) {
+        stream->status = json_deflate_stream_status_fallback;
+    }
+    stream->lex_state = stream_lex_done;
+}
+
+static bool stream_running(const json_deflate_stream_t * const stream) {
+    return stream->status == json_deflate_stream_status_parsing;
+}
+
+static void * stream_data_alloc(json_deflate_stream_t * const stream, const size_t size, const size_t alignment) {
+    void * const ptr = json_deflate_bump_alloc(&stream->data_area, size, alignment);
+    if (!ptr) {
+        stream_fail(stream, json_deflate_parse_status_out_of_target_memory);
+    }
+    return ptr;
+}
+
+static stream_scratch_mark_t scratch_mark(const json_deflate_stream_scratch_t * const scratch) {
+    return (stream_scratch_mark_t){.block = scratch->block, .top = scratch->top};
+}
+
+static void scratch_release(json_deflate_stream_scratch_t * const scratch, const stream_scratch_mark_t mark) {
+    scratch->block = mark.block;
+    scratch->top = mark.top;
+}
+
+// Makes the block after the current one at least `size` bytes, blocks past the current one are unused
+static uint8_t * scratch_next_block(json_deflate_stream_scratch_t * const scratch, const size_t size) {
+    const int32_t next = scratch->block + 1;
+    if ((next < scratch->num_blocks) && (scratch->blocks[next].capacity >= size)) {
+        return scratch->blocks[next].base;
+    }
+
+    const size_t capacity = (size > json_deflate_stream_scratch_block_size) ? size : json_deflate_stream_scratch_block_size;
+    uint8_t * const base = json_deflate_unchecked_calloc(1, capacity);
+    if (!base) {
+        return NULL;
+    }
+
+    if (next < scratch->num_blocks) {
+        json_deflate_free(scratch->blocks[next].base);
+    } else {
+        void * blocks = scratch->blocks;
+        if (!stream_grow(&blocks, scratch->num_blocks * sizeof(*scratch->blocks), (scratch->num_blocks + 1) * sizeof(*scratch->blocks))) {
+            json_deflate_free(base);
+            return NULL;
+        }
+        scratch->blocks = blocks;
+        scratch->num_blocks++;
+    }
+
+    scratch->blocks[next] = (json_deflate_stream_scratch_block_t){.base = base, .capacity = capacity};
+    return base;
+}
+
+static uint8_t * scratch_push(json_deflate_stream_scratch_t * const scratch, const size_t size, const size_t requested_alignment) {
+    const size_t alignment = requested_alignment ? requested_alignment : 1;
+    if (scratch->block >= 0) {
+        const json_deflate_stream_scratch_block_t * const block = &scratch->blocks[scratch->block];
+        uint8_t * const ptr = (uint8_t *)FWD_ALIGN_PTR(block->base + scratch->top, alignment);
+        if (ptr + size <= block->base + block->capacity) {
+            scratch->top = (size_t)(ptr - block->base) + size;
+            memset(ptr, 0, size);
+            return ptr;
+        }
+    }
+
+    uint8_t * const base = scratch_next_block(scratch, size + alignment);
+    if (!base) {
+        return NULL;
+    }
+
+    scratch->block++;
+    uint8_t * const ptr = (uint8_t *)FWD_ALIGN_PTR(base, alignment);
+    scratch->top = (size_t)(ptr - base) + size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+// Appends `size` zeroed bytes to the range at the top of the scratch stack, moving the range to a bigger block if needed
+static uint8_t * scratch_extend(json_deflate_stream_scratch_t * const scratch, uint8_t ** const range, const size_t used, const size_t size, const size_t requested_alignment) {
+    const size_t alignment = requested_alignment ? requested_alignment : 1;
+    if (!*range) {
+        *range = scratch_push(scratch, size, alignment);
+        return *range;
+    }
+
+    const json_deflate_stream_scratch_block_t * const block = &scratch->blocks[scratch->block];
+    uint8_t * const end = *range + used;
+    ASSERT(end == block->base + scratch->top);
+    if (end + size <= block->base + block->capacity) {
+        scratch->top += size;
+        memset(end, 0, size);
+        return end;
+    }
+
+    uint8_t * const base = scratch_next_block(scratch, used + size + alignment);
+    if (!base) {
+        return NULL;
+    }
+
+    scratch->block++;
+    uint8_t * const moved = (uint8_t *)FWD_ALIGN_PTR(base, alignment);
+    memcpy(moved, *range, used);
+    memset(moved + used, 0, size);
+    scratch->top = (size_t)(moved - base) + used + size;
+    *range = moved;
+    return moved + used;
+}
+
+static void scratch_destroy(json_deflate_stream_scratch_t * const scratch) {
+    for (int32_t i = 0; i < scratch->num_blocks; ++i) {
+        json_deflate_free(scratch->blocks[i].base);
+    }
+    if (scratch->blocks) {
+        json_deflate_free(scratch->blocks);
+    }
+    ZEROMEM(scratch);
+    scratch->block = -1;
+}
+
+// ========================================
+// frames
+
+static json_deflate_stream_frame_t * stream_top(json_deflate_stream_t * const stream) {
+    return stream->num_frames ? &stream->frames[stream->num_frames - 1] : NULL;
+}
+
+static char ** stream_error_slot(json_deflate_stream_t * const stream, const int32_t error_slot) {
+    return (error_slot < 0) ? &stream->root_error_msg : &stream->frames[error_slot].inner_error_msg;
+}
+
+static bool stream_kind_is_container(const stream_frame_kind_e kind) {
+    return kind != stream_frame_result;
+}
+
+static bool stream_kind_is_object(const stream_frame_kind_e kind) {
+    return (kind == stream_frame_struct) || (kind == stream_frame_map) || (kind == stream_frame_skip_object) || (kind == stream_frame_slice);
+}
+
+static json_deflate_stream_frame_t * stream_push_frame(json_deflate_stream_t * const stream, const stream_frame_kind_e kind, json_deflate_schema_type_t * const type, uint8_t * const dest, const int32_t error_slot) {
+    if (stream_kind_is_container(kind)) {
+        if (stream->depth >= json_deflate_stream_max_depth) {
+            stream_fail(stream, json_deflate_parse_status_invalid_json);
+            return NULL;
+        }
+        stream->depth++;
+    }
+
+    if (stream->num_frames == stream->max_frames) {
+        const int32_t max_frames = stream->max_frames ? stream->max_frames * 2 : json_deflate_stream_initial_frames;
+        void * frames = stream->frames;
+        if (!stream_grow(&frames, stream->max_frames * sizeof(*stream->frames), max_frames * sizeof(*stream->frames))) {
+            stream_fallback(stream);
+            return NULL;
+        }
+        stream->frames = frames;
+        stream->max_frames = max_frames;
+    }
+
+    json_deflate_stream_frame_t * const frame = &stream->frames[stream->num_frames++];
+    ZEROMEM(frame);
+    frame->kind = kind;
+    frame->state = stream_kind_is_object(kind) ? stream_state_key_or_end : stream_state_value_or_end;
+    frame->type = type;
+    frame->dest = dest;
+    frame->error_slot = error_slot;
+    frame->mark = scratch_mark(&stream->scratch);
+    return frame;
+}
+
+static void stream_pop_frame(json_deflate_stream_t * const stream) {
+    json_deflate_stream_frame_t * const frame = stream_top(stream);
+    if (stream_kind_is_container(frame->kind)) {
+        stream->depth--;
+    }
+    scratch_release(&stream->scratch, frame->mark);
+    stream->num_frames--;
+}
+
+// ========================================
+// error messages
+
+static void stream_append_path(json_deflate_stream_t * const stream, const int32_t num_frames, char * const out, const size_t out_size) {
+    if (stream->path_prefix) {
+        strcat_s(out, out_size, stream->path_prefix);
+    }
+
+    for (int32_t i = 0; i < num_frames; ++i) {
+        const json_deflate_stream_frame_t * const frame = &stream->frames[i];
+        char index_num[16] = {0};
+        const char * part = NULL;
+        if ((frame->kind == stream_frame_struct) || (frame->kind == stream_frame_map)) {
+            part = frame->path_part;
+        } else if ((frame->kind == stream_frame_array) || (frame->kind == stream_frame_chunk)) {
+            sprintf_s(index_num, sizeof(index_num), "<%d>", (int)(frame->first_index + frame->count) - 1);
+            part = index_num;
+        }
+
+        if (part) {
+            strcat_s(out, out_size, "/");
+            strcat_s(out, out_size, part);
+        }
+    }
+}
+
+static void stream_write_path(json_deflate_stream_t * const stream, const int32_t num_frames, char * const out, const size_t out_size) {
+    stream_append_path(stream, num_frames, out, out_size);
+    if (!out[0]) {
+        strcat_s(out, out_size, "/");
+    }
+}
+
+static void stream_store_error(json_deflate_stream_t * const stream, const int32_t error_slot, const char * const message) {
+    const size_t length = strlen(message) + 1;
+    char * const stored = stream_data_alloc(stream, length, sizeof(char));
+    if (stored) {
+        memcpy(stored, message, length);
+        *stream_error_slot(stream, error_slot) = stored;
+    }
+}
+
+static const char * stream_token_type_string(const json_deflate_stream_t * const stream, const stream_token_e token) {
+    switch (token) {
+        case stream_token_true:
+        case stream_token_false:
+            return JSON_BOOLEAN;
+        case stream_token_number:
+            return stream->number_decimalpoint ? JSON_NUMBER : JSON_INTEGER;
+        case stream_token_string:
+            return JSON_STRING;
+        case stream_token_object_begin:
+            return JSON_OBJECT;
+        case stream_token_array_begin:
+            return JSON_ARRAY;
+        default:
+            return JSON_NULL;
+    }
+}
+
+static void stream_expectation_error(json_deflate_stream_t * const stream, const int32_t error_slot, const char * const expectation, const stream_token_e token) {
+    char message[json_deflate_stream_max_error_message_length] = {0};
+    char path[json_deflate_stream_max_error_message_length] = {0};
+    stream_write_path(stream, stream->num_frames, path, sizeof(path));
+    sprintf_s(message, sizeof(message), "Expected %s but found %s at %s", expectation, stream_token_type_string(stream, token), path);
+    stream_store_error(stream, error_slot, message);
+}
+
+// ========================================
+// layout writers
+
+static void stream_set_variant_tag(json_deflate_stream_t * const stream, json_deflate_schema_type_t * const type, const json_deflate_schema_field_t * const choice, uint8_t * const dest) {
+    const json_deflate_schema_field_t * const tag_field = json_deflate_type_lookup_field(&stream->schema_area, type, "tag");
+    const uint8_t choice_value = (uint8_t)choice->choice_value;
+    memcpy(dest + tag_field->offset, &choice_value, sizeof(choice_value));
+}
+
+static void stream_write_header_value(json_deflate_stream_t * const stream, json_deflate_schema_type_t * const type, uint8_t * const dest, void * const ptr, const size_t value) {
+    int32_t valueint;
+    uint32_t valueuint;
+    size_t valuesz;
+    void * valueptr;
+    const void * src = NULL;
+    if (type == stream->ty_ptr) {
+        if (stream->target == json_deflate_parse_target_native) {
+            valueptr = ptr;
+            src = &valueptr;
+        } else {
+            ASSERT_MSG(type->size == sizeof(uint32_t), "[json_deflate] Wasm target may only declare 32-bit pointers");
+            valueuint = get_active_wasm_interpreter()->translate_ptr_native_to_wasm(ptr).ofs;
+            src = &valueuint;
+        }
+    } else if (type == stream->ty_size) {
+        if (stream->target == json_deflate_parse_target_native) {
+            valuesz = value;
+            src = &valuesz;
+        } else {
+            ASSERT_MSG(type->size == sizeof(uint32_t), "[json_deflate] Wasm target may only declare 32-bit sizes");
+            ASSERT_MSG(value <= UINT32_MAX, "[json_deflate] Cannot fit %llu in a 32-bit integer.", value);
+            valueuint = (uint32_t)value;
+            src = &valueuint;
+        }
+    } else if (type == stream->ty_integer) {
+        valueint = (int32_t)value;
+        src = &valueint;
+    } else {
+        TRAP("[json_deflate] Unexpected collection header field type");
+    }
+
+    memcpy(dest, src, type->var);
+}
+
+// Points the ptr/cap/len header of the collection at `dest` to `length` elements at `array_start`
+static void stream_write_collection_header(json_deflate_stream_t * const stream, json_deflate_schema_type_t * const type, uint8_t * const dest, void * const array_start, const size_t length) {
+    json_deflate_bump_area_t * const schema_area = &stream->schema_area;
+    const json_deflate_schema_field_t * const field_ptr = json_deflate_type_lookup_field(schema_area, type, "ptr");
+    const json_deflate_schema_field_t * const field_cap = json_deflate_type_lookup_field(schema_area, type, "cap");
+    const json_deflate_schema_field_t * const field_len = json_deflate_type_lookup_field(schema_area, type, "len");
+
+    stream_write_header_value(stream, json_deflate_bump_get_ptr(schema_area, field_ptr->type), dest + field_ptr->offset, array_start, 0);
+    stream_write_header_value(stream, json_deflate_bump_get_ptr(schema_area, field_cap->type), dest + field_cap->offset, NULL, length);
+    stream_write_header_value(stream, json_deflate_bump_get_ptr(schema_area, field_len->type), dest + field_len->offset, NULL, length);
+}
+
+static char * stream_store_string(json_deflate_stream_t * const stream, json_deflate_schema_type_t * const type, uint8_t * const dest, const char * const str, const size_t length) {
+    if (!length) {
+        return NULL;
+    }
+
+    const json_deflate_schema_type_t * const elem_type = json_deflate_bump_get_ptr(&stream->schema_area, type->rel_type);
+    char * const stored = stream_data_alloc(stream, (length + 1) * elem_type->var, elem_type->align);
+    if (!stored) {
+        return NULL;
+    }
+
+    memcpy(stored, str, length);
+    stored[length] = 0;
+    stream_write_collection_header(stream, type, dest, stored, length);
+    return stored;
+}
+
+static int stream_sort_by_value(const void * const s1, const void * const s2) {
+    const uint32_t v1 = *(uint32_t *)s1;
+    const uint32_t v2 = *(uint32_t *)s2;
+    if (v1 < v2) {
+        return -1;
+    } else if (v1 > v2) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+static bool stream_string_non_empty(const json_deflate_schema_type_t * const ptr_ty, const uint8_t * const string_place) {
+    if (ptr_ty->var == 8) {
+        return *(const uint64_t *)string_place;
+    } else if (ptr_ty->var == 4) {
+        return *(const uint32_t *)string_place;
+    } else {
+        TRAP("[json_deflate] Unexpected pointer size %d. The schema may be corrupted.", ptr_ty->var);
+        return false;
+    }
+}
+
+// ========================================
+// values
+
+static void stream_complete_value(json_deflate_stream_t * const stream);
+
+// Consumes a value that is not deflated
+static void stream_skip_value(json_deflate_stream_t * const stream, const stream_token_e token, const int32_t error_slot) {
+    if (token == stream_token_object_begin) {
+        stream_push_frame(stream, stream_frame_skip_object, NULL, NULL, error_slot);
+    } else if (token == stream_token_array_begin) {
+        stream_push_frame(stream, stream_frame_skip_array, NULL, NULL, error_slot);
+    } else {
+        stream_complete_value(stream);
+    }
+}
+
+static void stream_begin_struct(json_deflate_stream_t * const stream, json_deflate_schema_type_t * const type, uint8_t * const dest, const int32_t error_slot) {
+    enum {
+        max_fields = 16384,
+    };
+    ASSERT_MSG(type->field_count < max_fields, "[json_deflate] Field count limit exceeded.");
+
+    json_deflate_stream_frame_t * const frame = stream_push_frame(stream, stream_frame_struct, type, dest, error_slot);
+    if (!frame) {
+        return;
+    }
+
+    frame->checkmarks = scratch_push(&stream->scratch, type->field_count + 1, 1);
+    if (!frame->checkmarks) {
+        stream_fallback(stream);
+        return;
+    }
+
+    json_deflate_bump_area_t * const schema_area = &stream->schema_area;
+    json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(schema_area, type->fields);
+    for (uint32_t i = 0; i < type->field_count; i++) {
+        json_deflate_schema_type_t * const optional_field_type = json_deflate_bump_get_ptr(schema_area, fields[i].type);
+        if (optional_field_type->type_ctor == stream->ctx.ty_option) {
+            frame->checkmarks[i] = UINT8_MAX;
+
+            json_deflate_schema_field_t * const optional_field_type_first_field = json_deflate_bump_get_ptr(schema_area, optional_field_type->fields);
+            json_deflate_schema_field_t * const optional_field_type_none_field = optional_field_type_first_field + stream->option_none_index;
+            if (optional_field_type_none_field->choice_value) {
+                // NOTE: relative to the struct, same as json_deflate_process_value
+                stream_set_variant_tag(stream, optional_field_type, optional_field_type_none_field, dest);
+            }
+        }
+    }
+}
+
+static void stream_begin_variant(json_deflate_stream_t * const stream, json_deflate_schema_type_t * const type, uint8_t * const dest, const int32_t error_slot, const stream_token_e token);
+static void stream_split_array(json_deflate_stream_t * const stream, json_deflate_stream_frame_t * const frame);
+
+static void stream_begin_typed_value(json_deflate_stream_t * const stream, json_deflate_schema_type_t * const type, uint8_t * const dest, const int32_t error_slot, const stream_token_e token) {
+    json_deflate_bump_area_t * const schema_area = &stream->schema_area;
+    const json_deflate_schema_context_t * const ctx = &stream->ctx;
+
+    const void * src = NULL;
+    char valuechar;
+    uint8_t valuebool;
+    int32_t valueint;
+    double valuedouble;
+
+    if (type == stream->ty_integer) {
+        if (token == stream_token_number) {
+            valueint = stream->number_int;
+            src = &valueint;
+        } else {
+            stream_expectation_error(stream, error_slot, JSON_INTEGER, token);
+        }
+    } else if (type == stream->ty_number) {
+        if (token == stream_token_number) {
+            valuedouble = stream->number_value;
+            src = &valuedouble;
+        } else {
+            stream_expectation_error(stream, error_slot, JSON_NUMBER, token);
+        }
+    } else if (type == stream->ty_boolean) {
+        if ((token == stream_token_true) || (token == stream_token_false)) {
+            valuebool = token == stream_token_true;
+            src = &valuebool;
+        } else {
+            stream_expectation_error(stream, error_slot, JSON_BOOLEAN, token);
+        }
+    } else if (type == stream->ty_char) {
+        if (token == stream_token_string) {
+            valuechar = stream->token[0];
+            src = &valuechar;
+        } else {
+            stream_expectation_error(stream, error_slot, JSON_STRING, token);
+        }
+    } else if ((type == stream->ty_ptr) || (type == stream->ty_size)) {
+        // not backed by JSON
+    } else if (type->type_ctor == ctx->ty_result) {
+        json_deflate_schema_field_t * const ok_field = json_deflate_type_lookup_field(schema_area, type, "Ok");
+        stream_set_variant_tag(stream, type, ok_field, dest);
+        if (!stream_push_frame(stream, stream_frame_result, type, dest, error_slot)) {
+            return;
+        }
+        stream_begin_typed_value(stream, json_deflate_bump_get_ptr(schema_area, ok_field->type), dest + ok_field->offset, stream->num_frames - 1, token);
+        return;
+    } else if (type->type_ctor == ctx->ty_option) {
+        if (token != stream_token_null) {
+            json_deflate_schema_field_t * const some_field = json_deflate_type_lookup_field(schema_area, type, "Some");
+            stream_set_variant_tag(stream, type, some_field, dest);
+            stream_begin_typed_value(stream, json_deflate_bump_get_ptr(schema_area, some_field->type), dest + some_field->offset, error_slot, token);
+            return;
+        }
+    } else {
+        const json_deflate_schema_type_class_t type_class = json_deflate_type_get_class(type);
+        if (type_class == schema_type_struct) {
+            if (token == stream_token_object_begin) {
+                stream_begin_struct(stream, type, dest, error_slot);
+                return;
+            }
+            stream_expectation_error(stream, error_slot, JSON_OBJECT, token);
+        } else if (type_class == schema_type_array) {
+            if (type == stream->ty_string) {
+                if (token == stream_token_string) {
+                    stream_store_string(stream, type, dest, stream->token, stream->token_length);
+                } else {
+                    stream_expectation_error(stream, error_slot, JSON_STRING, token);
+                }
+            } else if (token == stream_token_array_begin) {
+                json_deflate_stream_frame_t * const frame = stream_push_frame(stream, stream_frame_array, type, dest, error_slot);
+                if (frame) {
+                    frame->elem_type = json_deflate_bump_get_ptr(schema_area, type->rel_type);
+                    frame->stride = frame->elem_type->var;
+                    if (stream->split) {
+                        stream_split_array(stream, frame);
+                    }
+                }
+                return;
+            } else {
+                stream_expectation_error(stream, error_slot, JSON_ARRAY, token);
+            }
+        } else if (type_class == schema_type_map) {
+            if (token == stream_token_object_begin) {
+                json_deflate_stream_frame_t * const frame = stream_push_frame(stream, stream_frame_map, type, dest, error_slot);
+                if (frame) {
+                    frame->elem_type = json_deflate_bump_get_ptr(schema_area, type->rel_type);
+                    const uint32_t alignment = max_uint32_t(frame->elem_type->align, (uint32_t)ALIGN_OF(stream_map_entry_t));
+                    frame->value_offset = ALIGN_INT((uint32_t)sizeof(stream_map_entry_t), max_uint32_t(frame->elem_type->align, 1));
+                    frame->stride = ALIGN_INT(frame->value_offset + frame->elem_type->var, alignment);
+                }
+                return;
+            }
+            stream_expectation_error(stream, error_slot, JSON_MAP, token);
+        } else if (type_class == schema_type_variant) {
+            stream_begin_variant(stream, type, dest, error_slot, token);
+            return;
+        }
+    }
+
+    if (src) {
+        memcpy(dest, src, type->var);
+    }
+
+    if (stream_running(stream)) {
+        stream_skip_value(stream, token, error_slot);
+    }
+}
+
+static void stream_begin_variant(json_deflate_stream_t * const stream, json_deflate_schema_type_t * const type, uint8_t * const dest, const int32_t error_slot, const stream_token_e token) {
+    ASSERT_MSG(type->field_count >= 2, "[json_deflate] Enums without variants are not allowed");
+    json_deflate_bump_area_t * const schema_area = &stream->schema_area;
+
+    struct candidates_t {
+        json_deflate_schema_field_t * boolean_variant;
+        json_deflate_schema_field_t * integer_variant;
+        json_deflate_schema_field_t * number_variant;
+        json_deflate_schema_field_t * string_variant;
+        json_deflate_schema_field_t * array_variant;
+        json_deflate_schema_field_t * map_variant;
+        json_deflate_schema_field_t * object_variant;
+    } candidates = {0};
+
+    json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(schema_area, type->fields);
+    for (uint32_t i = 0; i < type->field_count; i++) {
+        json_deflate_schema_field_t * const choice = &fields[i];
+
+        const char * const field_name = json_deflate_bump_get_ptr(schema_area, choice->json_name);
+        if (!strcmp(field_name, "tag")) {
+            continue;
+        }
+
+        json_deflate_schema_type_t * const choice_type = json_deflate_bump_get_ptr(schema_area, choice->type);
+        if (choice_type == stream->ty_boolean) {
+            candidates.boolean_variant = choice;
+        } else if (choice_type == stream->ty_integer) {
+            candidates.integer_variant = choice;
+        } else if (choice_type == stream->ty_number) {
+            candidates.number_variant = choice;
+        } else if (choice_type == stream->ty_string) {
+            candidates.string_variant = choice;
+        } else if (json_deflate_type_get_class(choice_type) == schema_type_array) {
+            candidates.array_variant = choice;
+        } else if (json_deflate_type_get_class(choice_type) == schema_type_map) {
+            candidates.map_variant = choice;
+        } else if (json_deflate_type_get_class(choice_type) == schema_type_struct && !json_deflate_type_is_builtin(choice_type)) {
+            candidates.object_variant = choice;
+        }
+    }
+
+    json_deflate_schema_field_t * choice = NULL;
+    if ((token == stream_token_true) || (token == stream_token_false)) {
+        choice = candidates.boolean_variant;
+    } else if (token == stream_token_string) {
+        choice = candidates.string_variant;
+    } else if (token == stream_token_array_begin) {
+        choice = candidates.array_variant;
+    } else if (token == stream_token_object_begin) {
+        choice = candidates.map_variant ? candidates.map_variant : candidates.object_variant;
+    } else if (token == stream_token_number) {
+        if (candidates.integer_variant && candidates.number_variant) {
+            choice = stream->number_decimalpoint ? candidates.number_variant : candidates.integer_variant;
+        } else {
+            choice = candidates.number_variant ? candidates.number_variant : candidates.integer_variant;
+        }
+    }
+
+    if (choice) {
+        stream_set_variant_tag(stream, type, choice, dest);
+        stream_begin_typed_value(stream, json_deflate_bump_get_ptr(schema_area, choice->type), dest + choice->offset, error_slot, token);
+    } else {
+        const char * const type_name = json_deflate_bump_get_ptr(schema_area, type->name);
+
+        char msg[json_deflate_stream_max_error_message_length] = {0};
+        strcpy_s(msg, sizeof(msg), "Expected one of the choices of: ");
+        strcat_s(msg, sizeof(msg), type_name);
+        stream_store_error(stream, error_slot, msg);
+        if (stream_running(stream)) {
+            stream_skip_value(stream, token, error_slot);
+        }
+    }
+}
+
+static void stream_navigate_slice(json_deflate_stream_t * const stream, const char * const path, const stream_token_e token) {
+    // same path splitting as json_deflate_data_navigate_to
+    if (!path[0] || !path[1] || (path[1] == '/')) {
+        stream->slice_found = true;
+        stream_begin_typed_value(stream, stream->ty_root, stream->root, -1, token);
+    } else if (token == stream_token_object_begin) {
+        json_deflate_stream_frame_t * const frame = stream_push_frame(stream, stream_frame_slice, NULL, NULL, -1);
+        if (frame) {
+            frame->slice_path = path;
+        }
+    } else {
+        stream_skip_value(stream, token, -1);
+    }
+}
+
+static bool stream_slice_key_matches(const char * const path, const char * const key, const char ** const out_rest) {
+    size_t length = 0;
+    while (path[length + 1] && (path[length + 1] != '/') && (length < json_deflate_max_string_length - 1)) {
+        length++;
+    }
+
+    *out_rest = path + length + 1;
+    // cJSON_GetObjectItem compares case insensitively
+    for (size_t i = 0; i < length; ++i) {
+        if (tolower((unsigned char)key[i]) != tolower((unsigned char)path[i + 1])) {
+            return false;
+        }
+    }
+    return key[length] == 0;
+}
+
+static void stream_begin_value(json_deflate_stream_t * const stream, const stream_token_e token) {
+    json_deflate_stream_frame_t * const frame = stream_top(stream);
+    if (!frame) {
+        if (stream->slice_path) {
+            stream_navigate_slice(stream, stream->slice_path, token);
+        } else {
+            stream_begin_typed_value(stream, stream->ty_root, stream->root, -1, token);
+        }
+        return;
+    }
+
+    switch (frame->kind) {
+        case stream_frame_struct:
+        case stream_frame_map:
+            if (frame->value_type) {
+                stream_begin_typed_value(stream, frame->value_type, frame->value_dest, frame->error_slot, token);
+            } else {
+                stream_skip_value(stream, token, frame->error_slot);
+            }
+            break;
+        case stream_frame_array: {
+            uint8_t * const elem = scratch_extend(&stream->scratch, &frame->items, frame->count * frame->stride, frame->stride, frame->elem_type->align);
+            if (!elem) {
+                stream_fallback(stream);
+                return;
+            }
+            frame->count++;
+            stream_begin_typed_value(stream, frame->elem_type, elem, frame->error_slot, token);
+            break;
+        }
+        case stream_frame_chunk: {
+            // more elements than the pre-scan found, the input is not valid JSON
+            if (frame->count == frame->capacity) {
+                stream_fail(stream, json_deflate_parse_status_invalid_json);
+                return;
+            }
+            uint8_t * const elem = frame->items + (size_t)frame->count * frame->stride;
+            frame->count++;
+            stream_begin_typed_value(stream, frame->elem_type, elem, frame->error_slot, token);
+            break;
+        }
+        case stream_frame_slice:
+            if (frame->value_slice_path) {
+                stream_navigate_slice(stream, frame->value_slice_path, token);
+            } else {
+                stream_skip_value(stream, token, -1);
+            }
+            break;
+        default:
+            stream_skip_value(stream, token, frame->error_slot);
+            break;
+    }
+}
+
+static void stream_on_key(json_deflate_stream_t * const stream) {
+    json_deflate_stream_frame_t * const frame = stream_top(stream);
+    frame->value_type = NULL;
+
+    if (frame->kind == stream_frame_struct) {
+        if (frame->broken) {
+            return;
+        }
+
+        json_deflate_bump_area_t * const schema_area = &stream->schema_area;
+        json_deflate_schema_field_t * const field = json_deflate_type_lookup_field_with_length(schema_area, frame->type, stream->token, stream->token_length);
+        if (field) {
+            json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(schema_area, frame->type->fields);
+            frame->value_type = json_deflate_bump_get_ptr(schema_area, field->type);
+            frame->value_dest = frame->dest + field->offset;
+            frame->path_part = json_deflate_bump_get_ptr(schema_area, field->json_name);
+            frame->field_index = (int32_t)(field - fields);
+        }
+    } else if (frame->kind == stream_frame_map) {
+        uint8_t * const entry = scratch_extend(&stream->scratch, &frame->items, frame->count * frame->stride, frame->stride, max_uint32_t(frame->elem_type->align, (uint32_t)ALIGN_OF(stream_map_entry_t)));
+        if (!entry) {
+            stream_fallback(stream);
+            return;
+        }
+        frame->count++;
+
+        stream_map_entry_t * const record = (stream_map_entry_t *)entry;
+        const size_t length = strlen(stream->token);
+        record->hash = crc_str_32(stream->token);
+        record->length = (uint32_t)length;
+        if (length) {
+            record->string = stream_data_alloc(stream, length + 1, sizeof(char));
+            if (!record->string) {
+                return;
+            }
+            memcpy(record->string, stream->token, length + 1);
+        }
+
+        frame->value_type = frame->elem_type;
+        frame->value_dest = entry + frame->value_offset;
+        frame->path_part = record->string ? record->string : "";
+    } else if (frame->kind == stream_frame_slice) {
+        const char * rest = NULL;
+        frame->value_slice_path = NULL;
+        if (!frame->slice_matched && stream_slice_key_matches(frame->slice_path, stream->token, &rest)) {
+            frame->slice_matched = true;
+            frame->value_slice_path = rest;
+        }
+    }
+}
+
+static void stream_close_struct(json_deflate_stream_t * const stream) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    json_deflate_stream_frame_t * const frame = stream_top(stream);
+    const int32_t frame_index = stream->num_frames - 1;
+    if (!*stream_error_slot(stream, frame->error_slot)) {
+        json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(&stream->schema_area, frame->type->fields);
+        for (uint32_t i = 0; i < frame->type->field_count; i++) {
+            if (!frame->checkmarks[i]) {
+                const char * const field_name = json_deflate_bump_get_ptr(&stream->schema_area, fields[i].json_name);
+                char message[json_deflate_stream_max_error_message_length] = {0};
+                char path[json_deflate_stream_max_error_message_length] = {0};
+                stream_write_path(stream, frame_index, path, sizeof(path));
+                sprintf_s(message, sizeof(message), "Missing required field \"%s\" at %s", field_name, path);
+                stream_store_error(stream, frame->error_slot, message);
+                break;
+            }
+        }
+    }
+    JSON_DEFLATE_TRACE_POP();
+}
+
+static void stream_close_array(json_deflate_stream_t * const stream) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    json_deflate_stream_frame_t * const frame = stream_top(stream);
+    if (frame->count) {
+        const size_t size = (size_t)frame->count * frame->stride;
+        uint8_t * const array_start = stream_data_alloc(stream, size, frame->elem_type->align);
+        if (array_start) {
+            memcpy(array_start, frame->items, size);
+            stream_write_collection_header(stream, frame->type, frame->dest, array_start, frame->count);
+        }
+    }
+    JSON_DEFLATE_TRACE_POP();
+}
+
+static void stream_close_map(json_deflate_stream_t * const stream) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    json_deflate_stream_frame_t * const frame = stream_top(stream);
+    const int32_t elem_count = (int32_t)frame->count;
+    if (!elem_count) {
+        JSON_DEFLATE_TRACE_POP();
+        return;
+    }
+
+    json_deflate_bump_area_t * const schema_area = &stream->schema_area;
+    json_deflate_schema_type_t * const type = frame->type;
+    json_deflate_schema_field_t * const field_keys = json_deflate_type_lookup_field(schema_area, type, "keys");
+    json_deflate_schema_field_t * const field_values = json_deflate_type_lookup_field(schema_area, type, "values");
+    json_deflate_schema_field_t * const field_strings = json_deflate_type_lookup_field(schema_area, type, "strings");
+
+    json_deflate_schema_type_t * const key_type = stream->ty_integer;
+    json_deflate_schema_type_t * const elem_type = frame->elem_type;
+    json_deflate_schema_type_t * const string_type = stream->ty_string;
+
+    uint8_t * const array_start_keys = stream_data_alloc(stream, elem_count * key_type->var, key_type->align);
+    uint8_t * const array_start_values = array_start_keys ? stream_data_alloc(stream, elem_count * elem_type->var, elem_type->align) : NULL;
+    uint8_t * const array_start_strings = array_start_values ? stream_data_alloc(stream, elem_count * string_type->var, string_type->align) : NULL;
+    if (!array_start_strings) {
+        JSON_DEFLATE_TRACE_POP();
+        return;
+    }
+
+    stream_write_collection_header(stream, json_deflate_bump_get_ptr(schema_area, field_keys->type), frame->dest + field_keys->offset, array_start_keys, elem_count);
+    stream_write_collection_header(stream, json_deflate_bump_get_ptr(schema_area, field_values->type), frame->dest + field_values->offset, array_start_values, elem_count);
+    stream_write_collection_header(stream, json_deflate_bump_get_ptr(schema_area, field_strings->type), frame->dest + field_strings->offset, array_start_strings, elem_count);
+
+    for (int32_t i = 0; i < elem_count; ++i) {
+        const stream_map_entry_t * const record = (const stream_map_entry_t *)(frame->items + frame->stride * i);
+        memcpy(array_start_keys + key_type->var * i, &record->hash, key_type->var);
+    }
+
+    qsort(array_start_keys, elem_count, key_type->var, stream_sort_by_value);
+
+    // same placement as json_deflate_process_value so both parsers agree on the layout of colliding keys
+    json_deflate_schema_type_t * const ptr_ty = stream->ty_ptr;
+    for (int32_t i = 0; i < elem_count; ++i) {
+        const uint8_t * const entry = frame->items + frame->stride * i;
+        const stream_map_entry_t * const record = (const stream_map_entry_t *)entry;
+        const uint32_t hash = record->hash;
+        uint32_t * found_ptr = bsearch(&hash, array_start_keys, elem_count, key_type->var, stream_sort_by_value);
+        ASSERT_MSG(found_ptr, "[json_deflate] Internal consistency of map compromised");
+
+        const uint32_t initial_found_index = (uint32_t)(((uintptr_t)found_ptr - (uintptr_t)array_start_keys) / key_type->var);
+        int32_t found_index = (int32_t)initial_found_index;
+        while ((found_index < elem_count) && (*(uint32_t *)(array_start_keys + key_type->var * found_index) == hash) && stream_string_non_empty(ptr_ty, array_start_strings + string_type->var * found_index)) {
+            ++found_index;
+        }
+
+        if ((found_index >= elem_count) || (*(uint32_t *)(array_start_keys + key_type->var * found_index) != hash)) {
+            found_index = (int32_t)initial_found_index;
+            while ((found_index >= 0) && (*(uint32_t *)(array_start_keys + key_type->var * found_index) == hash) && stream_string_non_empty(ptr_ty, array_start_strings + string_type->var * found_index)) {
+                --found_index;
+            }
+
+            ASSERT_MSG(found_index >= 0, "[json_deflate] Not enough space in the map");
+            ASSERT_MSG(*(uint32_t *)(array_start_keys + key_type->var * found_index) == hash, "[json_deflate] Not enough space in the map");
+        }
+
+        if (record->length) {
+            stream_write_collection_header(stream, string_type, array_start_strings + string_type->var * found_index, record->string, record->length);
+        }
+
+        memcpy(array_start_values + elem_type->var * found_index, entry + frame->value_offset, elem_type->var);
+    }
+    JSON_DEFLATE_TRACE_POP();
+}
+
+static void stream_close_container(json_deflate_stream_t * const stream) {
+    json_deflate_stream_frame_t * const frame = stream_top(stream);
+    switch (frame->kind) {
+        case stream_frame_struct:
+            stream_close_struct(stream);
+            break;
+        case stream_frame_array:
+            stream_close_array(stream);
+            break;
+        case stream_frame_map:
+            stream_close_map(stream);
+            break;
+        case stream_frame_chunk:
+            // the closing bracket belongs to the parent stream
+            stream_fail(stream, json_deflate_parse_status_invalid_json);
+            return;
+        default:
+            break;
+    }
+
+    if (!stream_running(stream)) {
+        return;
+    }
+
+    stream_pop_frame(stream);
+    stream_complete_value(stream);
+}
+
+static void stream_complete_value(json_deflate_stream_t * const stream) {
+    for (;;) {
+        json_deflate_stream_frame_t * const frame = stream_top(stream);
+        if (!frame) {
+            stream->lex_state = stream_lex_done;
+            return;
+        }
+
+        if (frame->kind == stream_frame_result) {
+            if (frame->inner_error_msg) {
+                json_deflate_schema_field_t * const err_field = json_deflate_type_lookup_field(&stream->schema_area, frame->type, "Err");
+                stream_set_variant_tag(stream, frame->type, err_field, frame->dest);
+                json_deflate_schema_type_t * const err_type = json_deflate_bump_get_ptr(&stream->schema_area, err_field->type);
+                stream_store_string(stream, err_type, frame->dest + err_field->offset, frame->inner_error_msg, strlen(frame->inner_error_msg));
+                if (!stream_running(stream)) {
+                    return;
+                }
+            }
+            stream_pop_frame(stream);
+            continue;
+        }
+
+        if ((frame->kind == stream_frame_struct) && frame->value_type) {
+            if (*stream_error_slot(stream, frame->error_slot)) {
+                frame->broken = true;
+            } else {
+                frame->checkmarks[frame->field_index] = UINT8_MAX;
+            }
+        }
+
+        frame->state = stream_state_comma_or_end;
+        return;
+    }
+}
+
+static bool stream_token_begins_value(const stream_token_e token) {
+    return (token != stream_token_object_end) && (token != stream_token_array_end) && (token != stream_token_colon) && (token != stream_token_comma);
+}
+
+static void stream_on_token(json_deflate_stream_t * const stream, const stream_token_e token) {
+    json_deflate_stream_frame_t * const frame = stream_top(stream);
+    if (!frame) {
+        if (stream_token_begins_value(token)) {
+            stream_begin_value(stream, token);
+        } else {
+            stream_fail(stream, json_deflate_parse_status_invalid_json);
+        }
+        return;
+    }
+
+    ASSERT(frame->kind != stream_frame_result);
+    const bool is_object = stream_kind_is_object(frame->kind);
+    switch (frame->state) {
+        case stream_state_key_or_end:
+        case stream_state_key:
+            if (token == stream_token_string) {
+                frame->state = stream_state_colon;
+                stream_on_key(stream);
+                return;
+            } else if ((token == stream_token_object_end) && (frame->state == stream_state_key_or_end)) {
+                stream_close_container(stream);
+                return;
+            }
+            break;
+        case stream_state_colon:
+            if (token == stream_token_colon) {
+                frame->state = stream_state_value;
+                return;
+            }
+            break;
+        case stream_state_value:
+        case stream_state_value_or_end:
+            if (stream_token_begins_value(token)) {
+                stream_begin_value(stream, token);
+                return;
+            } else if ((token == stream_token_array_end) && (frame->state == stream_state_value_or_end)) {
+                stream_close_container(stream);
+                return;
+            }
+            break;
+        case stream_state_comma_or_end:
+            if (token == stream_token_comma) {
+                frame->state = is_object ? stream_state_key : stream_state_value;
+                return;
+            } else if (token == (is_object ? stream_token_object_end : stream_token_array_end)) {
+                stream_close_container(stream);
+                return;
+            }
+            break;
+    }
+
+    stream_fail(stream, json_deflate_parse_status_invalid_json);
+}
+
+// ========================================
+// tokenizer
+
+static bool stream_reserve_token(json_deflate_stream_t * const stream, const size_t length) {
+    const size_t required = stream->token_length + length + 1;
+    if (required <= stream->token_capacity) {
+        return true;
+    }
+
+    size_t capacity = stream->token_capacity ? stream->token_capacity : json_deflate_stream_initial_token_capacity;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+
+    void * token = stream->token;
+    if (!stream_grow(&token, stream->token_length, capacity)) {
+        stream_fallback(stream);
+        return false;
+    }
+    stream->token = token;
+    stream->token_capacity = capacity;
+    return true;
+}
+
+static bool stream_append_token(json_deflate_stream_t * const stream, const uint8_t * const bytes, const size_t length) {
+    if (!stream_reserve_token(stream, length)) {
+        return false;
+    }
+    memcpy(stream->token + stream->token_length, bytes, length);
+    stream->token_length += length;
+    stream->token[stream->token_length] = 0;
+    return true;
+}
+
+static int32_t stream_parse_hex4(const uint8_t * const input) {
+    int32_t h = 0;
+    for (int i = 0; i < 4; i++) {
+        const uint8_t c = input[i];
+        h <<= 4;
+        if ((c >= '0') && (c <= '9')) {
+            h += c - '0';
+        } else if ((c >= 'A') && (c <= 'F')) {
+            h += 10 + c - 'A';
+        } else if ((c >= 'a') && (c <= 'f')) {
+            h += 10 + c - 'a';
+        } else {
+            return -1;
+        }
+    }
+    return h;
+}
+
+static bool stream_append_codepoint(json_deflate_stream_t * const stream, uint32_t codepoint) {
+    uint8_t utf8[4];
+    int length;
+    uint8_t first_byte_mark = 0;
+    if (codepoint < 0x80) {
+        length = 1;
+    } else if (codepoint < 0x800) {
+        length = 2;
+        first_byte_mark = 0xC0;
+    } else if (codepoint < 0x10000) {
+        length = 3;
+        first_byte_mark = 0xE0;
+    } else if (codepoint <= 0x10FFFF) {
+        length = 4;
+        first_byte_mark = 0xF0;
+    } else {
+        return false;
+    }
+
+    for (int i = length - 1; i > 0; i--) {
+        utf8[i] = (uint8_t)((codepoint | 0x80) & 0xBF);
+        codepoint >>= 6;
+    }
+    utf8[0] = (length > 1) ? (uint8_t)((codepoint | first_byte_mark) & 0xFF) : (uint8_t)(codepoint & 0x7F);
+    return stream_append_token(stream, utf8, length);
+}
+
+// Decodes the escape sequence collected so far, returns false while it is incomplete
+static bool stream_escape_complete(json_deflate_stream_t * const stream) {
+    const uint8_t * const escape = stream->escape;
+    const int32_t length = stream->escape_length;
+    uint8_t decoded;
+    switch (escape[0]) {
+        case 'b':
+            decoded = '\b';
+            break;
+        case 'f':
+            decoded = '\f';
+            break;
+        case 'n':
+            decoded = '\n';
+            break;
+        case 'r':
+            decoded = '\r';
+            break;
+        case 't':
+            decoded = '\t';
+            break;
+        case '\"':
+        case '\\':
+        case '/':
+            decoded = escape[0];
+            break;
+        case 'u': {
+            if (length < 5) {
+                return false;
+            }
+
+            const int32_t first_code = stream_parse_hex4(escape + 1);
+            if ((first_code < 0) || ((first_code >= 0xDC00) && (first_code <= 0xDFFF))) {
+                stream_fail(stream, json_deflate_parse_status_invalid_json);
+                return true;
+            }
+
+            uint32_t codepoint = (uint32_t)first_code;
+            if ((first_code >= 0xD800) && (first_code <= 0xDBFF)) {
+                // UTF-16 surrogate pair
+                if (((length > 5) && (escape[5] != '\\')) || ((length > 6) && (escape[6] != 'u'))) {
+                    stream_fail(stream, json_deflate_parse_status_invalid_json);
+                    return true;
+                }
+                if (length < 11) {
+                    return false;
+                }
+
+                const int32_t second_code = stream_parse_hex4(escape + 7);
+                if ((second_code < 0xDC00) || (second_code > 0xDFFF)) {
+                    stream_fail(stream, json_deflate_parse_status_invalid_json);
+                    return true;
+                }
+                codepoint = 0x10000 + ((((uint32_t)first_code & 0x3FF) << 10) | ((uint32_t)second_code & 0x3FF));
+            }
+
+            if (!stream_append_codepoint(stream, codepoint) && stream_running(stream)) {
+                stream_fail(stream, json_deflate_parse_status_invalid_json);
+            }
+            return true;
+        }
+        default:
+            stream_fail(stream, json_deflate_parse_status_invalid_json);
+            return true;
+    }
+
+    stream_append_token(stream, &decoded, 1);
+    return true;
+}
+
+// Advances past string bytes up to the next quote, backslash or the end of the input, validating UTF-8 on the way
+static bool stream_scan_string_run(json_deflate_stream_t * const stream, const uint8_t ** const ptr, const uint8_t * const end) {
+    const uint8_t * p = *ptr;
+    while (p < end) {
+        if (!stream->utf8.remaining) {
+            p += json_deflate_scan_string(p, (size_t)(end - p));
+            if ((p == end) || (*p < 0x80)) {
+                break;
+            }
+        }
+
+        // Rust strings must be valid UTF-8, which cJSON never checked
+        const size_t valid = json_deflate_utf8_validate(&stream->utf8, p, (size_t)(end - p));
+        if (valid == JSON_DEFLATE_UTF8_INVALID) {
+            stream_fail(stream, json_deflate_parse_status_invalid_json);
+            return false;
+        }
+        p += valid;
+    }
+    *ptr = p;
+    return true;
+}
+
+// Collects escape bytes until the sequence decodes or the input ends
+static void stream_scan_escape(json_deflate_stream_t * const stream, const uint8_t ** const ptr, const uint8_t * const end) {
+    const uint8_t * p = *ptr;
+    while (p < end) {
+        stream->escape[stream->escape_length++] = *p++;
+        if (stream_escape_complete(stream)) {
+            if (stream_running(stream)) {
+                stream->lex_state = stream_lex_string;
+            }
+            break;
+        }
+    }
+    *ptr = p;
+}
+
+static bool stream_is_number_char(const uint8_t c) {
+    return ((c >= '0') && (c <= '9')) || (c == '+') || (c == '-') || (c == 'e') || (c == 'E') || (c == '.');
+}
+
+static void stream_complete_number(json_deflate_stream_t * const stream) {
+    const char * const text = stream->token;
+    const size_t length = stream->token_length;
+    if (!length || (length > json_deflate_stream_max_number_length)) {
+        stream_fail(stream, json_deflate_parse_status_invalid_json);
+        return;
+    }
+
+    stream->number_decimalpoint = memchr(text, '.', length) != NULL;
+
+    // plain integers that fit in a double's mantissa don't need strtod
+    const size_t digits_start = (text[0] == '-') ? 1 : 0;
+    bool is_plain_integer = (length > digits_start) && (length - digits_start <= 15);
+    int64_t integer = 0;
+    for (size_t i = digits_start; is_plain_integer && (i < length); ++i) {
+        if ((text[i] < '0') || (text[i] > '9')) {
+            is_plain_integer = false;
+        } else {
+            integer = integer * 10 + (text[i] - '0');
+        }
+    }
+
+    double number;
+    if (is_plain_integer) {
+        number = (double)(digits_start ? -integer : integer);
+    } else {
+        char * after_end = NULL;
+        number = strtod(text, &after_end);
+        if (after_end != text + length) {
+            stream_fail(stream, json_deflate_parse_status_invalid_json);
+            return;
+        }
+    }
+
+    stream->number_value = number;
+    // use saturation in case of overflow, like cJSON
+    if (number >= INT_MAX) {
+        stream->number_int = INT_MAX;
+    } else if (number <= (double)INT_MIN) {
+        stream->number_int = INT_MIN;
+    } else {
+        stream->number_int = (int32_t)number;
+    }
+
+    stream->lex_state = stream_lex_between;
+    stream_on_token(stream, stream_token_number);
+}
+
+static void stream_complete_literal(json_deflate_stream_t * const stream) {
+    stream->lex_state = stream_lex_between;
+    if (!strcmp(stream->token, "true")) {
+        stream_on_token(stream, stream_token_true);
+    } else if (!strcmp(stream->token, "false")) {
+        stream_on_token(stream, stream_token_false);
+    } else if (!strcmp(stream->token, "null")) {
+        stream_on_token(stream, stream_token_null);
+    } else {
+        stream_fail(stream, json_deflate_parse_status_invalid_json);
+    }
+}
+
+static void stream_begin_token(json_deflate_stream_t * const stream, const stream_lex_state_e state) {
+    stream->lex_state = state;
+    stream->token_length = 0;
+    if (stream->token) {
+        stream->token[0] = 0;
+    }
+}
+
+// numbers and literals end with the input
+static void stream_end_input(json_deflate_stream_t * const stream) {
+    if (stream->lex_state == stream_lex_number) {
+        stream_complete_number(stream);
+    } else if (stream->lex_state == stream_lex_literal) {
+        stream_complete_literal(stream);
+    }
+}
+
+// ========================================
+// split arrays
+
+typedef struct stream_chunk_t {
+    json_deflate_stream_t stream;
+    const_mem_region_t input;
+    uint32_t first;
+    uint32_t count;
+    // part of the output buffer the chunk allocates from
+    uint8_t * area_start;
+    uint8_t * area_end;
+    bool complete;
+} stream_chunk_t;
+
+// Shared by the stream splitting an array and its helper jobs, freed by whoever drops the last reference.
+// Helpers that start after all chunks were taken only touch `next_chunk` and `refs`.
+typedef struct stream_split_t {
+    const json_deflate_stream_t * parent;
+    json_deflate_schema_type_t * type;
+    json_deflate_schema_type_t * elem_type;
+    uint8_t * items;
+    const char * path_prefix;
+    stream_chunk_t * chunks;
+    int32_t num_chunks;
+
+    sb_atomic_int32_t next_chunk;
+    sb_atomic_int32_t refs;
+    sb_mutex_t * mutex;
+    sb_condition_variable_t * cv;
+    int32_t chunks_done;
+} stream_split_t;
+
+static void stream_init_chunk(const stream_split_t * const split, stream_chunk_t * const chunk) {
+    const json_deflate_stream_t * const parent = split->parent;
+    json_deflate_stream_t * const stream = &chunk->stream;
+    ZEROMEM(stream);
+    stream->scratch.block = -1;
+    stream->target = parent->target;
+    stream->lex_state = stream_lex_between;
+    stream->status = json_deflate_stream_status_parsing;
+
+    stream->schema_area = parent->schema_area;
+    stream->ctx = parent->ctx;
+    stream->ty_root = parent->ty_root;
+    stream->ty_integer = parent->ty_integer;
+    stream->ty_number = parent->ty_number;
+    stream->ty_boolean = parent->ty_boolean;
+    stream->ty_char = parent->ty_char;
+    stream->ty_string = parent->ty_string;
+    stream->ty_ptr = parent->ty_ptr;
+    stream->ty_size = parent->ty_size;
+    stream->option_none_index = parent->option_none_index;
+    stream->path_prefix = split->path_prefix;
+
+    // offsets stay relative to the whole output buffer
+    uint8_t * const buffer = parent->data_area.payload.borrowed.borrowed_buffer;
+    json_deflate_bump_borrowed_init(&stream->data_area, MEM_REGION(.ptr = buffer, .size = (size_t)(chunk->area_end - buffer)));
+    stream->data_area.payload.borrowed.next = (size_t)(chunk->area_start - buffer);
+
+    // the array frame is counted in the parent's depth already
+    stream->depth = parent->depth - 1;
+    json_deflate_stream_frame_t * const frame = stream_push_frame(stream, stream_frame_chunk, split->type, NULL, -1);
+    if (frame) {
+        frame->state = stream_state_value;
+        frame->elem_type = split->elem_type;
+        frame->stride = split->elem_type->var;
+        frame->items = split->items + (size_t)chunk->first * frame->stride;
+        frame->first_index = chunk->first;
+        frame->capacity = chunk->count;
+    }
+}
+
+static void stream_parse_chunk(const stream_split_t * const split, stream_chunk_t * const chunk) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    json_deflate_stream_t * const stream = &chunk->stream;
+    stream_init_chunk(split, chunk);
+    json_deflate_stream_feed(stream, chunk->input);
+    if (stream_running(stream)) {
+        stream_end_input(stream);
+    }
+
+    // errors of the array itself would have to be merged into the parent's error slot, those are left to the sequential parse
+    const json_deflate_stream_frame_t * const frame = stream_top(stream);
+    chunk->complete = stream_running(stream) && (stream->num_frames == 1) && (frame->state == stream_state_comma_or_end) && (frame->count == frame->capacity) && !stream->root_error_msg;
+    JSON_DEFLATE_TRACE_POP();
+}
+
+static void stream_split_work(stream_split_t * const split) {
+    for (;;) {
+        const int32_t index = sb_atomic_fetch_add(&split->next_chunk, 1, memory_order_relaxed);
+        if (index >= split->num_chunks) {
+            return;
+        }
+
+        stream_parse_chunk(split, &split->chunks[index]);
+
+        sb_lock_mutex(split->mutex);
+        split->chunks_done++;
+        sb_condition_wake_all(split->cv);
+        sb_unlock_mutex(split->mutex);
+    }
+}
+
+static void stream_split_release(stream_split_t * const split) {
+    if (sb_atomic_fetch_add(&split->refs, -1, memory_order_seq_cst) == 1) {
+        sb_destroy_condition_variable(split->cv, MALLOC_TAG);
+        sb_destroy_mutex(split->mutex, MALLOC_TAG);
+        json_deflate_free(split);
+    }
+}
+
+static void stream_split_helper(void * const user, thread_pool_t * const pool) {
+    stream_split_t * const split = user;
+    stream_split_work(split);
+    stream_split_release(split);
+}
+
+static size_t stream_read_size(const json_deflate_schema_type_t * const type, const uint8_t * const src) {
+    if (type->var == sizeof(uint64_t)) {
+        uint64_t value;
+        memcpy(&value, src, sizeof(value));
+        return (size_t)value;
+    } else {
+        uint32_t value;
+        memcpy(&value, src, sizeof(value));
+        return value;
+    }
+}
+
+// Moves the pointer at `dest` down by `delta` bytes and returns where it points to now
+static uint8_t * stream_relocate_pointer(const json_deflate_stream_t * const stream, uint8_t * const dest, const size_t delta) {
+    if (stream->target == json_deflate_parse_target_native) {
+        uint8_t * ptr;
+        memcpy(&ptr, dest, sizeof(ptr));
+        if (!ptr) {
+            return NULL;
+        }
+        ptr -= delta;
+        memcpy(dest, &ptr, sizeof(ptr));
+        return ptr;
+    }
+
+    uint32_t ofs;
+    memcpy(&ofs, dest, sizeof(ofs));
+    if (!ofs) {
+        return NULL;
+    }
+    ofs -= (uint32_t)delta;
+    memcpy(dest, &ofs, sizeof(ofs));
+    return get_active_wasm_interpreter()->translate_ptr_wasm_to_native((wasm_ptr_t){.ofs = (int32_t)ofs});
+}
+
+// Fixes up the pointers of the value at `dest` after everything it references moved down by `delta` bytes
+static void stream_relocate_value(const json_deflate_stream_t * const stream, const json_deflate_schema_type_t * const type, uint8_t * const dest, const size_t delta) {
+    const json_deflate_bump_area_t * const schema_area = &stream->schema_area;
+    const json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(schema_area, type->fields);
+    switch (json_deflate_type_get_class(type)) {
+        case schema_type_struct:
+        case schema_type_map:
+            for (uint32_t i = 0; i < type->field_count; ++i) {
+                stream_relocate_value(stream, json_deflate_bump_get_ptr(schema_area, fields[i].type), dest + fields[i].offset, delta);
+            }
+            break;
+        case schema_type_variant: {
+            const json_deflate_schema_field_t * const tag_field = json_deflate_type_lookup_field(schema_area, type, "tag");
+            for (uint32_t i = 0; i < type->field_count; ++i) {
+                if ((&fields[i] != tag_field) && (fields[i].choice_value == dest[tag_field->offset])) {
+                    stream_relocate_value(stream, json_deflate_bump_get_ptr(schema_area, fields[i].type), dest + fields[i].offset, delta);
+                    break;
+                }
+            }
+            break;
+        }
+        case schema_type_array: {
+            const json_deflate_schema_field_t * const field_ptr = json_deflate_type_lookup_field(schema_area, type, "ptr");
+            uint8_t * const elems = stream_relocate_pointer(stream, dest + field_ptr->offset, delta);
+            const json_deflate_schema_type_t * const elem_type = json_deflate_bump_get_ptr(schema_area, type->rel_type);
+            // scalars (and characters of strings) have no fields
+            if (elems && elem_type->field_count) {
+                const json_deflate_schema_field_t * const field_len = json_deflate_type_lookup_field(schema_area, type, "len");
+                const size_t length = stream_read_size(json_deflate_bump_get_ptr(schema_area, field_len->type), dest + field_len->offset);
+                for (size_t i = 0; i < length; ++i) {
+                    stream_relocate_value(stream, elem_type, elems + i * elem_type->var, delta);
+                }
+            }
+            break;
+        }
+    }
+}
+
+// Parses the elements of the array `frame` was just pushed for on the thread pool when the array is big enough. The element
+// block is allocated up front, every chunk of elements allocates what they point to from its own part of the rest of the
+// output buffer (shared out in proportion to the chunk's input size), then the parts are moved together and the pointers
+// into them fixed up. Anything unusual (invalid JSON, a part running out of memory, errors that are not contained in the
+// elements) makes the whole document fall back to the sequential parse.
+static void stream_split_array(json_deflate_stream_t * const stream, json_deflate_stream_frame_t * const frame) {
+    const json_deflate_split_options_t * const options = stream->split;
+    const size_t available = (size_t)(stream->input_end - stream->input);
+    if (!stream->input || (available < options->min_array_size) || !frame->stride) {
+        return;
+    }
+
+    // only arrays outside of other arrays and maps, so every byte is pre-scanned at most once
+    for (int32_t i = 0; i < stream->num_frames - 1; ++i) {
+        if ((stream->frames[i].kind == stream_frame_array) || (stream->frames[i].kind == stream_frame_map)) {
+            return;
+        }
+    }
+
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    const microseconds_t scan_start = adk_read_microsecond_clock();
+    json_deflate_array_scan_t scan;
+    const size_t chunk_size = max_size_t(options->min_chunk_size, available / json_deflate_max_array_chunks);
+    if (!json_deflate_scan_array(stream->input, available, chunk_size, &scan) || (scan.end < options->min_array_size) || (scan.num_chunks < 2)) {
+        JSON_DEFLATE_TRACE_POP();
+        return;
+    }
+
+    const size_t stride = frame->stride;
+    uint8_t * const items = stream_data_alloc(stream, scan.count * stride, frame->elem_type->align);
+    stream_chunk_t * const chunks = items ? json_deflate_unchecked_calloc(scan.num_chunks, sizeof(stream_chunk_t)) : NULL;
+    stream_split_t * const split = chunks ? json_deflate_unchecked_calloc(1, sizeof(stream_split_t)) : NULL;
+    if (!split) {
+        if (chunks) {
+            json_deflate_free(chunks);
+        }
+        stream_fallback(stream);
+        JSON_DEFLATE_TRACE_POP();
+        return;
+    }
+
+    uint8_t * const buffer = stream->data_area.payload.borrowed.borrowed_buffer;
+    uint8_t * const free_start = buffer + stream->data_area.payload.borrowed.next;
+    uint8_t * const free_end = buffer + stream->data_area.payload.borrowed.capacity;
+    const uint64_t free_size = (uint64_t)(free_end - free_start);
+    for (int32_t i = 0; i < scan.num_chunks; ++i) {
+        stream_chunk_t * const chunk = &chunks[i];
+        const bool last = i == scan.num_chunks - 1;
+        const size_t begin = scan.chunk_offsets[i];
+        // the comma before the next chunk belongs to neither
+        const size_t end = last ? scan.end : scan.chunk_offsets[i + 1] - 1;
+        chunk->input = CONST_MEM_REGION(stream->input + begin, end - begin);
+        chunk->first = scan.chunk_first[i];
+        chunk->count = (last ? scan.count : scan.chunk_first[i + 1]) - chunk->first;
+        chunk->area_start = (uint8_t *)FWD_ALIGN_PTR(free_start + free_size * begin / scan.end, json_deflate_stream_chunk_alignment);
+        chunk->area_end = last ? free_end : free_start + free_size * scan.chunk_offsets[i + 1] / scan.end;
+    }
+
+    char path_prefix[json_deflate_stream_max_error_message_length] = {0};
+    stream_append_path(stream, stream->num_frames - 1, path_prefix, sizeof(path_prefix));
+
+    split->parent = stream;
+    split->type = frame->type;
+    split->elem_type = frame->elem_type;
+    split->items = items;
+    split->path_prefix = path_prefix;
+    split->chunks = chunks;
+    split->num_chunks = scan.num_chunks;
+    split->mutex = sb_create_mutex(MALLOC_TAG);
+    split->cv = sb_create_condition_variable(MALLOC_TAG);
+
+    // the calling thread takes chunks as well, so this cannot stall on a busy pool
+    const int32_t num_helpers = min_int32_t(options->num_helpers, scan.num_chunks - 1);
+    sb_atomic_store(&split->refs, num_helpers + 1, memory_order_relaxed);
+    const microseconds_t parse_start = adk_read_microsecond_clock();
+    for (int32_t i = 0; i < num_helpers; ++i) {
+        thread_pool_enqueue(options->pool, stream_split_helper, NULL, split);
+    }
+    stream_split_work(split);
+
+    sb_lock_mutex(split->mutex);
+    while (split->chunks_done < split->num_chunks) {
+        sb_wait_condition(split->cv, split->mutex, sb_timeout_infinite);
+    }
+    sb_unlock_mutex(split->mutex);
+    stream_split_release(split);
+
+    const microseconds_t stitch_start = adk_read_microsecond_clock();
+    bool complete = true;
+    for (int32_t i = 0; i < scan.num_chunks; ++i) {
+        complete = complete && chunks[i].complete;
+    }
+
+    if (complete) {
+        uint8_t * cursor = buffer + chunks[0].stream.data_area.payload.borrowed.next;
+        for (int32_t i = 1; i < scan.num_chunks; ++i) {
+            const stream_chunk_t * const chunk = &chunks[i];
+            uint8_t * const used_end = buffer + chunk->stream.data_area.payload.borrowed.next;
+            const size_t used = (size_t)(used_end - chunk->area_start);
+            cursor = (uint8_t *)FWD_ALIGN_PTR(cursor, json_deflate_stream_chunk_alignment);
+            const size_t delta = (size_t)(chunk->area_start - cursor);
+            if (delta) {
+                memmove(cursor, chunk->area_start, used);
+                // the rest of the buffer has to stay zeroed for the allocations that follow
+                uint8_t * const stale = (cursor + used > chunk->area_start) ? cursor + used : chunk->area_start;
+                memset(stale, 0, (size_t)(used_end - stale));
+                for (uint32_t j = 0; j < chunk->count; ++j) {
+                    stream_relocate_value(stream, frame->elem_type, items + (chunk->first + j) * stride, delta);
+                }
+            }
+            cursor += used;
+        }
+        stream->data_area.payload.borrowed.next = (size_t)(cursor - buffer);
+    }
+
+    for (int32_t i = 0; i < scan.num_chunks; ++i) {
+        json_deflate_stream_destroy(&chunks[i].stream);
+    }
+    json_deflate_free(chunks);
+
+    if (!complete) {
+        LOG_DEBUG(TAG_JSON_DEFLATE, "[json_deflate] Split array of %u elements failed, parsing it again sequentially", scan.count);
+        stream_fallback(stream);
+        JSON_DEFLATE_TRACE_POP();
+        return;
+    }
+
+    const microseconds_t stitch_end = adk_read_microsecond_clock();
+    LOG_DEBUG(TAG_JSON_DEFLATE, "[json_deflate] Split array of %u elements into %d chunks -- Scan: %llu us, Parse: %llu us, Stitch: %llu us", scan.count, scan.num_chunks, parse_start.us - scan_start.us, stitch_start.us - parse_start.us, stitch_end.us - stitch_start.us);
+
+    stream_write_collection_header(stream, frame->type, frame->dest, items, scan.count);
+    stream->input += scan.end + 1;
+    stream_pop_frame(stream);
+    stream_complete_value(stream);
+    JSON_DEFLATE_TRACE_POP();
+}
+
+// ========================================
+
+void json_deflate_stream_init(json_deflate_stream_t * const stream, const const_mem_region_t schema_layout, const mem_region_t output_buffer, const json_deflate_parse_target_e target, const uint32_t expected_size, const uint32_t schema_hash) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    ZEROMEM(stream);
+    stream->scratch.block = -1;
+    stream->target = target;
+    stream->lex_state = stream_lex_bom;
+    stream->status = json_deflate_stream_status_parsing;
+
+    memset(output_buffer.ptr, 0, output_buffer.size);
+
+    json_deflate_metadata_t metadata = {0};
+    json_deflate_schema_context_t wasm_ctx = {0};
+    json_deflate_schema_context_t native_ctx = {0};
+    if (json_deflate_binary_read_from_memory(schema_layout, &stream->schema_area, &metadata, &wasm_ctx, &native_ctx) != json_deflate_binary_read_success) {
+        stream_fail(stream, json_deflate_parse_status_invalid_binary_layout);
+        JSON_DEFLATE_TRACE_POP();
+        return;
+    }
+
+    stream->ctx = (target == json_deflate_parse_target_wasm) ? wasm_ctx : native_ctx;
+    json_deflate_bump_area_t * const schema_area = &stream->schema_area;
+    const json_deflate_schema_context_t * const ctx = &stream->ctx;
+    stream->ty_root = json_deflate_bump_get_ptr(schema_area, ctx->ty_root);
+
+    VERIFY_MSG(schema_hash == metadata.rust_schema_hash,
+               "[json_deflate] The Rust schema currently in use is incompatible with the binary layout file in some way. "
+               "Please regenerate your Rust schema and your binary layout file using the same version of the tool.");
+
+    VERIFY_MSG(expected_size == stream->ty_root->var,
+               "[json_deflate] The binary schema does not match the provided Rust types. "
+               "This may be a result of tampering with the Rust types, an outdated schema file, or a bug in the json_deflate_tool.");
+
+    stream->ty_integer = json_deflate_bump_get_ptr(schema_area, ctx->ty_integer);
+    stream->ty_number = json_deflate_bump_get_ptr(schema_area, ctx->ty_number);
+    stream->ty_boolean = json_deflate_bump_get_ptr(schema_area, ctx->ty_boolean);
+    stream->ty_char = json_deflate_bump_get_ptr(schema_area, ctx->ty_char);
+    stream->ty_string = json_deflate_bump_get_ptr(schema_area, ctx->ty_string);
+    stream->ty_ptr = json_deflate_bump_get_ptr(schema_area, ctx->ty_ptr);
+    stream->ty_size = json_deflate_bump_get_ptr(schema_area, ctx->ty_size);
+    stream->slice_path = json_deflate_bump_get_ptr(schema_area, ctx->slice_path);
+
+    json_deflate_schema_type_t * const optional_type_ctor = json_deflate_bump_get_ptr(schema_area, ctx->ty_option);
+    json_deflate_schema_field_t * const optional_field_first = json_deflate_bump_get_ptr(schema_area, optional_type_ctor->fields);
+    json_deflate_schema_field_t * const optional_field_none = json_deflate_type_lookup_field(schema_area, optional_type_ctor, "None");
+    stream->option_none_index = (int32_t)(optional_field_none - optional_field_first);
+
+    json_deflate_bump_borrowed_init(&stream->data_area, output_buffer);
+    // allocated first so the root lands at the same offset as with json_deflate_process_document
+    stream->root = stream_data_alloc(stream, stream->ty_root->var, stream->ty_root->align);
+    JSON_DEFLATE_TRACE_POP();
+}
+
+bool json_deflate_stream_feed(json_deflate_stream_t * const stream, const const_mem_region_t data) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    static const uint8_t bom[] = {0xEF, 0xBB, 0xBF};
+
+    const uint8_t * p = data.byte_ptr;
+    const uint8_t * const end = p + data.size;
+    stream->input_end = end;
+    while ((p < end) && stream_running(stream)) {
+        switch (stream->lex_state) {
+            case stream_lex_bom:
+                if (*p == bom[stream->bom_matched]) {
+                    ++p;
+                    if (++stream->bom_matched == ARRAY_SIZE(bom)) {
+                        stream->lex_state = stream_lex_between;
+                    }
+                } else if (stream->bom_matched) {
+                    stream_fail(stream, json_deflate_parse_status_invalid_json);
+                } else {
+                    stream->lex_state = stream_lex_between;
+                }
+                break;
+
+            case stream_lex_between: {
+                // cJSON treats everything up to and including space as whitespace
+                if (*p <= 32) {
+                    p += json_deflate_scan_whitespace(p, (size_t)(end - p));
+                }
+                if (p == end) {
+                    break;
+                }
+
+                const uint8_t c = *p;
+                switch (c) {
+                    case '{':
+                        ++p;
+                        stream_on_token(stream, stream_token_object_begin);
+                        break;
+                    case '}':
+                        ++p;
+                        stream_on_token(stream, stream_token_object_end);
+                        break;
+                    case '[':
+                        ++p;
+                        stream->input = p;
+                        stream_on_token(stream, stream_token_array_begin);
+                        p = stream->input;
+                        break;
+                    case ']':
+                        ++p;
+                        stream_on_token(stream, stream_token_array_end);
+                        break;
+                    case ':':
+                        ++p;
+                        stream_on_token(stream, stream_token_colon);
+                        break;
+                    case ',':
+                        ++p;
+                        stream_on_token(stream, stream_token_comma);
+                        break;
+                    case '\"':
+                        ++p;
+                        stream_begin_token(stream, stream_lex_string);
+                        break;
+                    case 't':
+                    case 'f':
+                    case 'n':
+                        stream_begin_token(stream, stream_lex_literal);
+                        break;
+                    default:
+                        if ((c == '-') || ((c >= '0') && (c <= '9'))) {
+                            stream_begin_token(stream, stream_lex_number);
+                        } else {
+                            stream_fail(stream, json_deflate_parse_status_invalid_json);
+                        }
+                        break;
+                }
+                break;
+            }
+
+            case stream_lex_string: {
+                // runs and escapes are consumed here until the closing quote, the escape state only resumes escapes split across fragments
+                while ((p < end) && (stream->lex_state == stream_lex_string)) {
+                    const uint8_t * const run = p;
+                    if (!stream_scan_string_run(stream, &p, end) || !stream_append_token(stream, run, (size_t)(p - run)) || (p == end)) {
+                        break;
+                    }
+
+                    if (*p++ == '\"') {
+                        stream->lex_state = stream_lex_between;
+                        stream_on_token(stream, stream_token_string);
+                    } else {
+                        stream->lex_state = stream_lex_escape;
+                        stream->escape_length = 0;
+                        stream_scan_escape(stream, &p, end);
+                    }
+                }
+                break;
+            }
+
+            case stream_lex_escape:
+                stream_scan_escape(stream, &p, end);
+                break;
+
+            case stream_lex_number:
+            case stream_lex_literal: {
+                const bool number = stream->lex_state == stream_lex_number;
+                const uint8_t * const run = p;
+                while ((p < end) && (number ? stream_is_number_char(*p) : ((*p >= 'a') && (*p <= 'z')))) {
+                    ++p;
+                }
+                if (!stream_append_token(stream, run, (size_t)(p - run)) || (p == end)) {
+                    break;
+                }
+
+                if (number) {
+                    stream_complete_number(stream);
+                } else {
+                    stream_complete_literal(stream);
+                }
+                break;
+            }
+
+            case stream_lex_done:
+                p = end;
+                break;
+        }
+    }
+
+    const bool running = stream_running(stream);
+    JSON_DEFLATE_TRACE_POP();
+    return running;
+}
+
+json_deflate_stream_status_e json_deflate_stream_finish(json_deflate_stream_t * const stream, json_deflate_parse_result_t * const out_result) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    if (stream_running(stream)) {
+        stream_end_input(stream);
+        if (stream_running(stream) && (stream->lex_state != stream_lex_done)) {
+            stream_fail(stream, json_deflate_parse_status_invalid_json);
+        }
+    }
+
+    ZEROMEM(out_result);
+    if (stream->status == json_deflate_stream_status_failed) {
+        out_result->status = stream->failure;
+        JSON_DEFLATE_TRACE_POP();
+        return stream->status;
+    } else if (stream->status == json_deflate_stream_status_fallback) {
+        JSON_DEFLATE_TRACE_POP();
+        return stream->status;
+    }
+
+    VERIFY_MSG(!stream->slice_path || stream->slice_found, "[json_deflate] Failed to navigate to slice");
+
+    stream->status = json_deflate_stream_status_complete;
+    out_result->status = json_deflate_parse_status_success;
+    out_result->offset = (uint32_t)json_deflate_bump_get_offset(&stream->data_area, stream->root);
+    out_result->end = (uint32_t)stream->data_area.payload.borrowed.next;
+    JSON_DEFLATE_TRACE_POP();
+    return stream->status;
+}
+
+void json_deflate_stream_destroy(json_deflate_stream_t * const stream) {
+    JSON_DEFLATE_TRACE_PUSH_FN();
+    scratch_destroy(&stream->scratch);
+    if (stream->frames) {
+        json_deflate_free(stream->frames);
+        stream->frames = NULL;
+    }
+    if (stream->token) {
+        json_deflate_free(stream->token);
+        stream->token = NULL;
+    }
+    JSON_DEFLATE_TRACE_POP();
+}
@@ -116,6 +116,11 @@ void json_deflate_prepare_schema(
     const uint32_t rust_schema_hash_seed = 0x03030303;
     metadata.rust_schema_hash = json_deflate_generate_hash(&area, &wasm_ctx, &native_ctx, rust_schema_hash_seed);
 
+    // after the schema hash, which depends on field order, so Rust schemas do not change with the lookup tables
+    LOG_DEBUG(TAG_JSON_DEFLATE, "[json_deflate_tool] Building field lookup tables");
+    json_deflate_schema_build_field_tables(&area, &wasm_ctx);
+    json_deflate_schema_build_field_tables(&area, &native_ctx);
+
     LOG_DEBUG(TAG_JSON_DEFLATE, "[json_deflate_tool] Writing schema to file %s", schema_binary_file);
     FILE * const bs = fopen(schema_binary_file, "wb+");
     VERIFY_MSG(bs, "[json_deflate_tool] Failed to open file %s", schema_binary_file);
@@ -267,8 +267,8 @@ static void json_deflate_schema_print_rust_type(FILE * const rust_schema_file, j
                 json_deflate_write_string(rust_schema_file, ",\n");
             }
 
-            reorder_fields_by_hash(area, wasm_type);
-            reorder_fields_by_hash(area, native_type);
+            reorder_fields_for_lookup(area, wasm_type);
+            reorder_fields_for_lookup(area, native_type);
 
             json_deflate_write_string(rust_schema_file, "}\n\n");
         } else if (json_deflate_type_get_class(wasm_type) == schema_type_variant) {
@@ -309,8 +309,8 @@ static void json_deflate_schema_print_rust_type(FILE * const rust_schema_file, j
                 }
             }
 
-            reorder_fields_by_hash(area, wasm_type);
-            reorder_fields_by_hash(area, native_type);
+            reorder_fields_for_lookup(area, wasm_type);
+            reorder_fields_for_lookup(area, native_type);
 
             json_deflate_write_string(rust_schema_file, "}\n\n");
         }
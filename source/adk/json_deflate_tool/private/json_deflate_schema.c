@@ -149,6 +149,198 @@ void reorder_fields_by_size(json_deflate_bump_area_t * const area, json_deflate_
     }
 }
 
+enum {
+    json_deflate_field_table_max_displacement = 1 << 16,
+};
+
+typedef struct json_deflate_field_bucket_t {
+    uint32_t index;
+    uint32_t size;
+} json_deflate_field_bucket_t;
+
+static int sort_buckets_by_size(const void * const a, const void * const b) {
+    const json_deflate_field_bucket_t * const t_a = a;
+    const json_deflate_field_bucket_t * const t_b = b;
+    if (t_a->size != t_b->size) {
+        return t_a->size < t_b->size ? 1 : -1;
+    }
+    return SIGN((int64_t)t_a->index - (int64_t)t_b->index);
+}
+
+// Hash and displace: fields hash into field_count buckets, the largest buckets first search for the smallest
+// displacement that moves all their fields into free slots. The result only depends on the names, not on the
+// current order. Fails if two names of the type share a hash, the type then keeps the CRC32 sorted fields.
+bool json_deflate_type_build_field_table(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const ty) {
+    const uint32_t count = ty->field_count;
+    if (!ty->fields || !count) {
+        return false;
+    }
+
+    json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(area, ty->fields);
+
+    uint32_t * const hashes = json_deflate_calloc(count, sizeof(uint32_t));
+    uint32_t * const slots = json_deflate_calloc(count, sizeof(uint32_t));
+    uint32_t * const displacements = json_deflate_calloc(count, sizeof(uint32_t));
+    bool * const taken = json_deflate_calloc(count, sizeof(bool));
+    json_deflate_field_bucket_t * const buckets = json_deflate_calloc(count, sizeof(json_deflate_field_bucket_t));
+    json_deflate_schema_field_t * const arranged = json_deflate_calloc(count, sizeof(json_deflate_schema_field_t));
+
+    for (uint32_t i = 0; i < count; i++) {
+        const char * const name = json_deflate_bump_get_ptr(area, fields[i].json_name);
+        hashes[i] = json_deflate_schema_calculate_key_hash(name, strlen(name));
+        buckets[i].index = i;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        buckets[json_deflate_schema_field_bucket(hashes[i], count)].size++;
+    }
+    qsort(buckets, count, sizeof(json_deflate_field_bucket_t), sort_buckets_by_size);
+
+    bool success = true;
+    for (uint32_t b = 0; (b < count) && buckets[b].size && success; b++) {
+        const uint32_t bucket = buckets[b].index;
+        success = false;
+        for (uint32_t displacement = 0; (displacement < json_deflate_field_table_max_displacement) && !success; displacement++) {
+            success = true;
+            for (uint32_t i = 0; (i < count) && success; i++) {
+                if (json_deflate_schema_field_bucket(hashes[i], count) != bucket) {
+                    continue;
+                }
+                slots[i] = json_deflate_schema_field_slot(hashes[i], displacement, count);
+                success = !taken[slots[i]];
+                for (uint32_t j = 0; (j < i) && success; j++) {
+                    success = (json_deflate_schema_field_bucket(hashes[j], count) != bucket) || (slots[j] != slots[i]);
+                }
+            }
+            if (success) {
+                displacements[bucket] = displacement;
+                for (uint32_t i = 0; i < count; i++) {
+                    if (json_deflate_schema_field_bucket(hashes[i], count) == bucket) {
+                        taken[slots[i]] = true;
+                    }
+                }
+            }
+        }
+    }
+
+    if (success) {
+        for (uint32_t i = 0; i < count; i++) {
+            arranged[slots[i]] = fields[i];
+            arranged[slots[i]].hash = hashes[i];
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            arranged[i].reserved = displacements[i];
+        }
+        memcpy(fields, arranged, count * sizeof(json_deflate_schema_field_t));
+        json_deflate_type_set_collisions(ty, 0);
+        json_deflate_type_set_field_table(ty, 1);
+    } else {
+        reorder_fields_by_hash(area, ty);
+    }
+
+    json_deflate_free(hashes);
+    json_deflate_free(slots);
+    json_deflate_free(displacements);
+    json_deflate_free(taken);
+    json_deflate_free(buckets);
+    json_deflate_free(arranged);
+    return success;
+}
+
+// Types already walked by json_deflate_schema_build_field_tables, open addressing on the type pointer.
+// Kept apart from the field table flag: types without fields (or whose table failed) never get the flag but can still be reached again.
+typedef struct visited_types_t {
+    const json_deflate_schema_type_t ** slots;
+    uint32_t capacity;
+    uint32_t count;
+} visited_types_t;
+
+static uint32_t visited_types_slot(const json_deflate_schema_type_t * const type, const uint32_t capacity) {
+    return (uint32_t)(((uintptr_t)type / sizeof(json_deflate_schema_type_t)) * 2654435761u) & (capacity - 1);
+}
+
+// returns false if `type` was visited before
+static bool visited_types_insert(visited_types_t * const visited, const json_deflate_schema_type_t * const type) {
+    if ((visited->count + 1) * 2 > visited->capacity) {
+        const json_deflate_schema_type_t ** const old_slots = visited->slots;
+        const uint32_t old_capacity = visited->capacity;
+        visited->capacity = old_capacity ? old_capacity * 2 : 64;
+        visited->slots = json_deflate_calloc(visited->capacity, sizeof(*visited->slots));
+        for (uint32_t i = 0; i < old_capacity; i++) {
+            if (old_slots[i]) {
+                uint32_t slot = visited_types_slot(old_slots[i], visited->capacity);
+                while (visited->slots[slot]) {
+                    slot = (slot + 1) & (visited->capacity - 1);
+                }
+                visited->slots[slot] = old_slots[i];
+            }
+        }
+        json_deflate_free((void *)old_slots);
+    }
+
+    uint32_t slot = visited_types_slot(type, visited->capacity);
+    while (visited->slots[slot]) {
+        if (visited->slots[slot] == type) {
+            return false;
+        }
+        slot = (slot + 1) & (visited->capacity - 1);
+    }
+    visited->slots[slot] = type;
+    visited->count++;
+    return true;
+}
+
+static void build_field_tables_rec(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const type, visited_types_t * const visited) {
+    if (!type || !visited_types_insert(visited, type)) {
+        return;
+    }
+
+    if (!json_deflate_type_has_field_table(type)) {
+        json_deflate_type_build_field_table(area, type);
+    }
+
+    json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(area, type->fields);
+    for (uint32_t i = 0; i < type->field_count; i++) {
+        build_field_tables_rec(area, json_deflate_bump_get_ptr(area, fields[i].type), visited);
+    }
+    build_field_tables_rec(area, json_deflate_bump_get_ptr(area, type->type_ctor), visited);
+    build_field_tables_rec(area, json_deflate_bump_get_ptr(area, type->rel_type), visited);
+}
+
+void json_deflate_schema_build_field_tables(json_deflate_bump_area_t * const area, const json_deflate_schema_context_t * const ctx) {
+    const json_deflate_bump_ptr_t roots[] = {
+        ctx->ty_root,
+        ctx->ty_ptr,
+        ctx->ty_size,
+        ctx->ty_unit,
+        ctx->ty_boolean,
+        ctx->ty_integer,
+        ctx->ty_number,
+        ctx->ty_char,
+        ctx->ty_string,
+        ctx->ty_array,
+        ctx->ty_option,
+        ctx->ty_struct,
+        ctx->ty_enum,
+        ctx->ty_result,
+        ctx->ty_map,
+    };
+
+    visited_types_t visited = {0};
+    for (int i = 0; i < ARRAY_SIZE(roots); i++) {
+        build_field_tables_rec(area, json_deflate_bump_get_ptr(area, roots[i]), &visited);
+    }
+    json_deflate_free((void *)visited.slots);
+}
+
+void reorder_fields_for_lookup(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const ty) {
+    if (json_deflate_type_has_field_table(ty)) {
+        json_deflate_type_set_field_table(ty, 0);
+        json_deflate_type_build_field_table(area, ty);
+    } else {
+        reorder_fields_by_hash(area, ty);
+    }
+}
+
 json_deflate_schema_type_t * json_deflate_type_construct(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const type_constructor, const json_deflate_schema_type_t * const type_arg) {
     if (!json_deflate_type_is_type_constructor(type_constructor)) {
         return type_constructor;
@@ -68,14 +68,14 @@ void json_deflate_schema_print_toml(FILE * const toml_file, json_deflate_bump_ar
                 json_deflate_write_int(toml_file, field->offset);
                 json_deflate_write_string(toml_file, "\n  Size = ");
                 json_deflate_write_int(toml_file, field_type->var);
-                json_deflate_write_string(toml_file, "\n  CRC32 = \"");
+                json_deflate_write_string(toml_file, json_deflate_type_has_field_table(type) ? "\n  Hash = \"" : "\n  CRC32 = \"");
                 json_deflate_write_hex(toml_file, field->hash);
                 json_deflate_write_string(toml_file, "\"\n  Activation = ");
                 json_deflate_write_int(toml_file, field->choice_value);
                 json_deflate_write_string(toml_file, "\n");
             }
 
-            reorder_fields_by_hash(area, type);
+            reorder_fields_for_lookup(area, type);
         }
 
         json_deflate_write_string(toml_file, "\n");
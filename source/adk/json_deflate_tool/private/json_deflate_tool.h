@@ -95,6 +95,9 @@ void reorder_fields_by_offset(json_deflate_bump_area_t * const area, json_deflat
 void reorder_fields_by_offset_then_by_original_order(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const ty);
 void reorder_fields_by_choice_value(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const ty);
 void reorder_fields_by_size(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const ty);
+void reorder_fields_for_lookup(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const ty);
+bool json_deflate_type_build_field_table(json_deflate_bump_area_t * const area, json_deflate_schema_type_t * const ty);
+void json_deflate_schema_build_field_tables(json_deflate_bump_area_t * const area, const json_deflate_schema_context_t * const ctx);
 void json_deflate_schema_type_arrange(json_deflate_bump_area_t * const area, const json_deflate_schema_context_t * const ctx, json_deflate_schema_type_t * const type);
 
 json_deflate_schema_type_t * json_deflate_type_register_builtin(json_deflate_bump_area_t * const area, const char * const name, const json_deflate_bump_size_t size, const json_deflate_bump_size_t ptr_size, const char ref);
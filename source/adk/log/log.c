@@ -14,6 +14,7 @@
 
 #include "source/adk/cncbus/cncbus.h"
 #include "source/adk/cncbus/cncbus_msg_types.h"
+#include "source/adk/log/private/log_binary.h"
 #include "source/adk/log/private/log_p.h"
 #include "source/adk/steamboat/sb_platform.h"
 
@@ -43,30 +44,22 @@ void log_shutdown() {
     ZEROMEM(&statics);
 }
 
-void log_message(const char * const file, const int line, const char * const func, const log_level_t level, const uint32_t fourcc_tag, const char * const msg, va_list args) {
-    ASSERT(level < num_log_levels);
-
-    if (statics.reporter != NULL) {
-        adk_reporting_key_val_t tags = {.key = "subsystem", .value = VAPRINTF("%*.*s", 4, 4, (const char *)&fourcc_tag)};
-        const adk_reporting_event_level_e event_level = level >= log_level_always ? event_level_debug : level + 1;
-        adk_reporting_report_msg(statics.reporter, file, line, func, event_level, &tags, msg, args);
-    }
-
-    const log_header_t log_header = {
-        .time_since_epoch = sb_get_time_since_epoch(),
-        .fourcc_tag = fourcc_tag,
-        .func = func,
-        .file = file,
-        .line = (uint16_t)line,
-        .level = level,
-    };
+static void log_report(const char * const file, const int line, const char * const func, const log_level_t level, const uint32_t fourcc_tag, const char * const msg, va_list args) {
+    adk_reporting_key_val_t tags = {.key = "subsystem", .value = VAPRINTF("%*.*s", 4, 4, (const char *)&fourcc_tag)};
+    const adk_reporting_event_level_e event_level = level >= log_level_always ? event_level_debug : level + 1;
+    adk_reporting_report_msg(statics.reporter, file, line, func, event_level, &tags, msg, args);
+}
 
+static void log_send_text(const log_header_t * const log_header, const char * const msg, va_list args) {
     enum { max_log_msg_stack_len = 8192 };
     char log_msg[max_log_msg_stack_len];
     char * p_log_msg = log_msg;
 
     // future TODO, write directly to cncbus msg data buf of reserved size if can be guaranteed to occupy within a single cnc bus memory fragment
 
+    va_list slow_args;
+    va_copy(slow_args, args);
+
     int message_size = vsnprintf(log_msg, max_log_msg_stack_len, msg, args) + 1; // vsnprintf will null-terminate even on truncate, but the null terminator is not included in the returned count
 
     // required message size exceeds our stack buffer len (including the null terminator)
@@ -75,11 +68,13 @@ void log_message(const char * const file, const int line, const char * const fun
         while (sb_atomic_cas(&statics.slow_buffer_hazard, 1, 0, memory_order_relaxed) != 0) {
         }
 
-        message_size = vsnprintf(statics.slow_buffer, max_log_msg_length, msg, args) + 1; // vsnprintf will null-terminate even on truncate, but the null terminator is not included in the returned count
+        message_size = vsnprintf(statics.slow_buffer, max_log_msg_length, msg, slow_args) + 1; // vsnprintf will null-terminate even on truncate, but the null terminator is not included in the returned count
 
         p_log_msg = statics.slow_buffer;
     }
 
+    va_end(slow_args);
+
     if (statics.bus) {
         // vsnprintf will return the number of character which would have been written given enough space, so clamp to the max length.
         if (message_size > max_log_msg_length) {
@@ -88,7 +83,7 @@ void log_message(const char * const file, const int line, const char * const fun
 
         cncbus_msg_t * const cncbus_msg = cncbus_msg_begin_unchecked(statics.bus, cncbus_msg_type_log_v1);
         // Write message metadata followed by the message contents
-        cncbus_msg_write_checked(cncbus_msg, &log_header, sizeof(log_header));
+        cncbus_msg_write_checked(cncbus_msg, log_header, sizeof(*log_header));
         cncbus_msg_write_checked(cncbus_msg, p_log_msg, (int)message_size);
 
         if (p_log_msg != log_msg) {
@@ -98,7 +93,7 @@ void log_message(const char * const file, const int line, const char * const fun
 
         cncbus_send_async(cncbus_msg, CNCBUS_INVALID_ADDRESS, statics.address, statics.subnet_mask, NULL);
     } else {
-        log_msg_print_basic(&log_header, p_log_msg);
+        log_msg_print_basic(log_header, p_log_msg);
         if (p_log_msg != log_msg) {
             // release the hazard, we are done with the buffer
             sb_atomic_store(&statics.slow_buffer_hazard, 0, memory_order_relaxed);
@@ -106,6 +101,71 @@ void log_message(const char * const file, const int line, const char * const fun
     }
 }
 
+static log_header_t log_make_header(const char * const file, const int line, const char * const func, const log_level_t level, const uint32_t fourcc_tag) {
+    return (log_header_t){
+        .time_since_epoch = sb_get_time_since_epoch(),
+        .fourcc_tag = fourcc_tag,
+        .func = func,
+        .file = file,
+        .line = (uint16_t)line,
+        .level = level,
+    };
+}
+
+void log_message(const char * const file, const int line, const char * const func, const log_level_t level, const uint32_t fourcc_tag, const char * const msg, va_list args) {
+    ASSERT(level < num_log_levels);
+
+    va_list text_args;
+    va_copy(text_args, args);
+
+    if (statics.reporter != NULL) {
+        log_report(file, line, func, level, fourcc_tag, msg, args);
+    }
+
+    const log_header_t log_header = log_make_header(file, line, func, level, fourcc_tag);
+    log_send_text(&log_header, msg, text_args);
+    va_end(text_args);
+}
+
+void log_message_deferred(const char * const file, const int line, const char * const func, const log_level_t level, const uint32_t fourcc_tag, const char * const msg, va_list args) {
+    ASSERT(level < num_log_levels);
+
+    va_list encode_args, text_args;
+    va_copy(encode_args, args);
+    va_copy(text_args, args);
+
+    if (statics.reporter != NULL) {
+        log_report(file, line, func, level, fourcc_tag, msg, args);
+    }
+
+    const log_header_t log_header = log_make_header(file, line, func, level, fourcc_tag);
+
+    // without a bus the message is printed right away and there's nothing to defer
+    if (statics.bus) {
+        uint8_t encoded_args[log_binary_max_args_size];
+        const int args_size = log_binary_encode_args(encoded_args, sizeof(encoded_args), msg, encode_args);
+
+        if (args_size >= 0) {
+            const log_deferred_header_t deferred_header = {.format = msg, .args_size = args_size};
+
+            cncbus_msg_t * const cncbus_msg = cncbus_msg_begin_unchecked(statics.bus, cncbus_msg_type_log_v2);
+            cncbus_msg_write_checked(cncbus_msg, &log_header, sizeof(log_header));
+            cncbus_msg_write_checked(cncbus_msg, &deferred_header, sizeof(deferred_header));
+            cncbus_msg_write_checked(cncbus_msg, encoded_args, args_size);
+            cncbus_send_async(cncbus_msg, CNCBUS_INVALID_ADDRESS, statics.address, statics.subnet_mask, NULL);
+
+            va_end(encode_args);
+            va_end(text_args);
+            return;
+        }
+    }
+
+    va_end(encode_args);
+
+    log_send_text(&log_header, msg, text_args);
+    va_end(text_args);
+}
+
 static const char * const log_level_names[num_log_levels] = {
     "DEBUG",
     "INFO",
@@ -171,5 +231,5 @@ void log_msg_print_basic(const log_header_t * const log_header, const char * log
 }
 
 void adk_log_app_msg(const char * const file, const uint32_t line, const char * const func, const log_level_e level, const uint32_t tag, const char * const msg) {
-    log_message_va(file, line, func, level, tag, "%s", msg);
+    log_message_deferred_va(file, line, func, level, tag, "%s", msg);
 }
@@ -48,11 +48,26 @@ FFI_EXPORT EXT_EXPORT log_level_e log_get_min_level();
 
 void log_set_min_level(const log_level_e level);
 
-#define LOG(log_level, fourcc_tag, ...)                                                         \
-    do {                                                                                        \
-        if (log_level >= log_get_min_level()) {                                                 \
-            log_message_va(__FILE__, __LINE__, __func__, log_level, fourcc_tag, ##__VA_ARGS__); \
-        }                                                                                       \
+// String literal formats outlive any queued log message, so the LOG macros send them by address with the
+// unformatted arguments and leave the formatting to the log receiver. Extensions only link the exported
+// log_message and can be unloaded while their messages are still queued, so they always format eagerly.
+#if defined(__GNUC__) && !defined(_SAMPLE_EXTENSION_NAME)
+#define LOG_IS_STATIC_FORMAT(_msg) __builtin_constant_p(_msg)
+#else
+#define LOG_IS_STATIC_FORMAT(_msg) 0
+#endif
+#define LOG_FORMAT_ARG(...) LOG_FORMAT_ARG_(__VA_ARGS__, 0)
+#define LOG_FORMAT_ARG_(_msg, ...) _msg
+
+#define LOG(log_level, fourcc_tag, ...)                                                                      \
+    do {                                                                                                     \
+        if (log_level >= log_get_min_level()) {                                                              \
+            if (LOG_IS_STATIC_FORMAT(LOG_FORMAT_ARG(__VA_ARGS__))) {                                         \
+                log_message_deferred_va(__FILE__, __LINE__, __func__, log_level, fourcc_tag, ##__VA_ARGS__); \
+            } else {                                                                                         \
+                log_message_va(__FILE__, __LINE__, __func__, log_level, fourcc_tag, ##__VA_ARGS__);          \
+            }                                                                                                \
+        }                                                                                                    \
     } while (0)
 
 #ifdef NDEBUG
@@ -102,6 +117,31 @@ static inline void log_message_va(
     va_end(args);
 }
 
+// Like log_message, but `msg` must stay valid until the log receiver processed the message (e.g. a string literal).
+// The arguments are copied without formatting them, the log receiver formats the message only if a sink needs the text.
+void log_message_deferred(
+    const char * const file,
+    const int line,
+    const char * const func,
+    const log_level_t level,
+    const uint32_t fourcc_tag,
+    const char * const msg,
+    va_list args);
+
+static inline void log_message_deferred_va(
+    const char * const file,
+    const int line,
+    const char * const func,
+    const log_level_t level,
+    const uint32_t fourcc_tag,
+    const char * const msg,
+    ...) {
+    va_list args;
+    va_start(args, msg);
+    log_message_deferred(file, line, func, level, fourcc_tag, msg, args);
+    va_end(args);
+}
+
 FFI_EXPORT void adk_log_app_msg(
     FFI_PTR_WASM const char * const file,
     const uint32_t line,
@@ -14,6 +14,7 @@
 
 #include "source/adk/log/private/event_logger.h"
 
+#include "source/adk/cncbus/cncbus_addresses.h"
 #include "source/adk/cncbus/cncbus_msg_types.h"
 #include "source/adk/log/log.h"
 #include "source/adk/runtime/app/events.h"
@@ -63,6 +64,7 @@ void event_logger_init(cncbus_t * const bus, const cncbus_address_t address) {
 
     cncbus_init_receiver(&event_logger.receiver, &event_logger.vtable, address);
     cncbus_connect(bus, &event_logger.receiver);
+    cncbus_join_group(bus, &event_logger.receiver, CNCBUS_GROUP_EVENTS);
 }
 
 void event_logger_shutdown(cncbus_t * const bus) {
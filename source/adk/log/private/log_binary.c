@@ -0,0 +1,656 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+ private/log_binary.c
+
+ Core Logging
+
+ Binary encoding of log message arguments for deferred formatting, and the
+ compact binary log file format.
+ */
+
+#include "source/adk/log/private/log_binary.h"
+
+#include <stddef.h>
+
+/*
+===============================================================================
+Format specs
+===============================================================================
+*/
+
+typedef enum log_arg_e {
+    // %%
+    log_arg_none,
+    log_arg_int,
+    log_arg_long,
+    log_arg_long_long,
+    log_arg_intmax,
+    log_arg_size,
+    log_arg_ptrdiff,
+    log_arg_double,
+    log_arg_string,
+    log_arg_pointer,
+    log_arg_unsupported
+} log_arg_e;
+
+typedef struct log_format_spec_t {
+    // from the '%' to one past the conversion character
+    const char * begin;
+    const char * end;
+    log_arg_e arg;
+    // -1 if not specified or passed as an argument
+    int precision;
+    bool star_width;
+    bool star_precision;
+} log_format_spec_t;
+
+static bool is_digit(const char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+static log_arg_e log_int_arg(const char length) {
+    switch (length) {
+        case 0:
+        case 'h':
+            return log_arg_int;
+        case 'l':
+            return log_arg_long;
+        case 'q':
+            return log_arg_long_long;
+        case 'j':
+            return log_arg_intmax;
+        case 'z':
+            return log_arg_size;
+        case 't':
+            return log_arg_ptrdiff;
+        default:
+            return log_arg_unsupported;
+    }
+}
+
+// parses the conversion spec starting at `format`, which must point at a '%'
+static void log_parse_format_spec(const char * const format, log_format_spec_t * const spec) {
+    ASSERT(*format == '%');
+
+    spec->begin = format;
+    spec->precision = -1;
+    spec->star_width = false;
+    spec->star_precision = false;
+
+    const char * p = format + 1;
+    if (*p == '%') {
+        spec->arg = log_arg_none;
+        spec->end = p + 1;
+        return;
+    }
+
+    spec->arg = log_arg_unsupported;
+
+    // positional arguments
+    {
+        const char * digits = p;
+        while (is_digit(*digits)) {
+            ++digits;
+        }
+        if ((*digits == '$') && (digits != p)) {
+            spec->end = digits + 1;
+            return;
+        }
+    }
+
+    while ((*p == '-') || (*p == '+') || (*p == ' ') || (*p == '#') || (*p == '0') || (*p == '\'')) {
+        ++p;
+    }
+
+    if (*p == '*') {
+        spec->star_width = true;
+        ++p;
+    } else {
+        while (is_digit(*p)) {
+            ++p;
+        }
+    }
+
+    if (*p == '.') {
+        ++p;
+        if (*p == '*') {
+            spec->star_precision = true;
+            ++p;
+        } else {
+            spec->precision = 0;
+            while (is_digit(*p)) {
+                spec->precision = spec->precision * 10 + (*p - '0');
+                ++p;
+            }
+        }
+    }
+
+    char length = 0;
+    if ((p[0] == 'h') && (p[1] == 'h')) {
+        length = 'h';
+        p += 2;
+    } else if ((p[0] == 'l') && (p[1] == 'l')) {
+        length = 'q';
+        p += 2;
+    } else if ((*p == 'h') || (*p == 'l') || (*p == 'q') || (*p == 'j') || (*p == 'z') || (*p == 't') || (*p == 'L')) {
+        length = *p++;
+    }
+
+    if (*p == 0) {
+        spec->end = p;
+        return;
+    }
+
+    const char conversion = *p;
+    spec->end = p + 1;
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            spec->arg = log_int_arg(length);
+            break;
+        case 'c':
+            spec->arg = (length == 0) ? log_arg_int : log_arg_unsupported;
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            // %lf is a double, %Lf a long double
+            spec->arg = ((length == 0) || (length == 'l')) ? log_arg_double : log_arg_unsupported;
+            break;
+        case 's':
+            spec->arg = (length == 0) ? log_arg_string : log_arg_unsupported;
+            break;
+        case 'p':
+            spec->arg = (length == 0) ? log_arg_pointer : log_arg_unsupported;
+            break;
+        default:
+            // %n and anything unknown
+            break;
+    }
+}
+
+/*
+===============================================================================
+Argument encoding
+===============================================================================
+*/
+
+typedef struct log_args_writer_t {
+    uint8_t * pos;
+    uint8_t * end;
+} log_args_writer_t;
+
+static bool log_args_put(log_args_writer_t * const writer, const void * const src, const int size) {
+    if (writer->end - writer->pos < size) {
+        return false;
+    }
+    memcpy(writer->pos, src, size);
+    writer->pos += size;
+    return true;
+}
+
+#define LOG_ARGS_PUT_VALUE(_writer, _type, _args)              \
+    do {                                                       \
+        const _type _value = va_arg(_args, _type);             \
+        if (!log_args_put(_writer, &_value, sizeof(_value))) { \
+            return -1;                                         \
+        }                                                      \
+    } while (0)
+
+int log_binary_encode_args(uint8_t * const dst, const int dst_size, const char * const format, va_list args) {
+    log_args_writer_t writer = {.pos = dst, .end = dst + dst_size};
+
+    for (const char * p = strchr(format, '%'); p; p = strchr(p, '%')) {
+        log_format_spec_t spec;
+        log_parse_format_spec(p, &spec);
+        p = spec.end;
+
+        if (spec.arg == log_arg_none) {
+            continue;
+        }
+        if (spec.arg == log_arg_unsupported) {
+            return -1;
+        }
+
+        if (spec.star_width) {
+            LOG_ARGS_PUT_VALUE(&writer, int, args);
+        }
+        if (spec.star_precision) {
+            const int precision = va_arg(args, int);
+            if (!log_args_put(&writer, &precision, sizeof(precision))) {
+                return -1;
+            }
+            spec.precision = (precision < 0) ? -1 : precision;
+        }
+
+        switch (spec.arg) {
+            case log_arg_int:
+                LOG_ARGS_PUT_VALUE(&writer, int, args);
+                break;
+            case log_arg_long:
+                LOG_ARGS_PUT_VALUE(&writer, long, args);
+                break;
+            case log_arg_long_long:
+                LOG_ARGS_PUT_VALUE(&writer, long long, args);
+                break;
+            case log_arg_intmax:
+                LOG_ARGS_PUT_VALUE(&writer, intmax_t, args);
+                break;
+            case log_arg_size:
+                LOG_ARGS_PUT_VALUE(&writer, size_t, args);
+                break;
+            case log_arg_ptrdiff:
+                LOG_ARGS_PUT_VALUE(&writer, ptrdiff_t, args);
+                break;
+            case log_arg_double:
+                LOG_ARGS_PUT_VALUE(&writer, double, args);
+                break;
+            case log_arg_pointer:
+                LOG_ARGS_PUT_VALUE(&writer, void *, args);
+                break;
+            case log_arg_string: {
+                const char * str = va_arg(args, const char *);
+                if (!str) {
+                    str = "(null)";
+                }
+                // a precision bounds the read, the string need not be terminated
+                size_t length = 0;
+                while (((spec.precision < 0) || (length < (size_t)spec.precision)) && str[length]) {
+                    ++length;
+                }
+                if (length >= UINT16_MAX) {
+                    return -1;
+                }
+                const uint16_t length16 = (uint16_t)length;
+                const char terminator = 0;
+                if (!log_args_put(&writer, &length16, sizeof(length16)) || !log_args_put(&writer, str, (int)length) || !log_args_put(&writer, &terminator, 1)) {
+                    return -1;
+                }
+                break;
+            }
+            default:
+                return -1;
+        }
+    }
+
+    return (int)(writer.pos - dst);
+}
+
+/*
+===============================================================================
+Deferred formatting
+===============================================================================
+*/
+
+typedef struct log_args_reader_t {
+    const uint8_t * pos;
+    const uint8_t * end;
+} log_args_reader_t;
+
+static bool log_args_get(log_args_reader_t * const reader, void * const dst, const int size) {
+    if (reader->end - reader->pos < size) {
+        return false;
+    }
+    memcpy(dst, reader->pos, size);
+    reader->pos += size;
+    return true;
+}
+
+typedef struct log_text_writer_t {
+    char * dst;
+    int dst_size;
+    int length;
+} log_text_writer_t;
+
+static void log_text_append(log_text_writer_t * const writer, const char * const src, const int size) {
+    const int space = writer->dst_size - writer->length - 1;
+    if (space > 0) {
+        memcpy(writer->dst + writer->length, src, min_int(space, size));
+    }
+    writer->length += size;
+}
+
+// remaining space of `writer` for snprintf
+static char * log_text_tail(const log_text_writer_t * const writer, size_t * const out_space) {
+    if (writer->length < writer->dst_size) {
+        *out_space = (size_t)(writer->dst_size - writer->length);
+        return writer->dst + writer->length;
+    }
+    *out_space = 0;
+    return NULL;
+}
+
+#define LOG_TEXT_FORMAT_VALUE(_writer, _spec, _type, _reader)        \
+    do {                                                             \
+        _type _value;                                                \
+        if (!log_args_get(_reader, &_value, sizeof(_value))) {       \
+            return -1;                                               \
+        }                                                            \
+        size_t _space;                                               \
+        char * const _tail = log_text_tail(_writer, &_space);        \
+        (_writer)->length += snprintf(_tail, _space, _spec, _value); \
+    } while (0)
+
+int log_binary_format(char * const dst, const int dst_size, const char * const format, const uint8_t * const args, const int args_size) {
+    log_text_writer_t writer = {.dst = dst, .dst_size = dst_size};
+    log_args_reader_t reader = {.pos = args, .end = args + args_size};
+
+    const char * p = format;
+    for (;;) {
+        const char * const percent = strchr(p, '%');
+        log_text_append(&writer, p, percent ? (int)(percent - p) : (int)strlen(p));
+        if (!percent) {
+            break;
+        }
+
+        log_format_spec_t spec;
+        log_parse_format_spec(percent, &spec);
+        p = spec.end;
+
+        if (spec.arg == log_arg_none) {
+            log_text_append(&writer, "%", 1);
+            continue;
+        }
+        if (spec.arg == log_arg_unsupported) {
+            return -1;
+        }
+
+        // rebuild the spec with '*' replaced by the recorded width and precision
+        char spec_str[64];
+        int spec_len = 0;
+        for (const char * s = spec.begin; s < spec.end; ++s) {
+            if (spec_len + 16 > ARRAY_SIZE(spec_str)) {
+                return -1;
+            }
+            if ((*s == '*') && (s[-1] == '.')) {
+                int precision;
+                if (!log_args_get(&reader, &precision, sizeof(precision))) {
+                    return -1;
+                }
+                if (precision < 0) {
+                    // a negative precision is taken as if the precision were omitted
+                    --spec_len;
+                } else {
+                    spec_len += sprintf(spec_str + spec_len, "%d", precision);
+                }
+            } else if (*s == '*') {
+                int width;
+                if (!log_args_get(&reader, &width, sizeof(width))) {
+                    return -1;
+                }
+                spec_len += sprintf(spec_str + spec_len, "%d", width);
+            } else {
+                spec_str[spec_len++] = *s;
+            }
+        }
+        spec_str[spec_len] = 0;
+
+        switch (spec.arg) {
+            case log_arg_int:
+                LOG_TEXT_FORMAT_VALUE(&writer, spec_str, int, &reader);
+                break;
+            case log_arg_long:
+                LOG_TEXT_FORMAT_VALUE(&writer, spec_str, long, &reader);
+                break;
+            case log_arg_long_long:
+                LOG_TEXT_FORMAT_VALUE(&writer, spec_str, long long, &reader);
+                break;
+            case log_arg_intmax:
+                LOG_TEXT_FORMAT_VALUE(&writer, spec_str, intmax_t, &reader);
+                break;
+            case log_arg_size:
+                LOG_TEXT_FORMAT_VALUE(&writer, spec_str, size_t, &reader);
+                break;
+            case log_arg_ptrdiff:
+                LOG_TEXT_FORMAT_VALUE(&writer, spec_str, ptrdiff_t, &reader);
+                break;
+            case log_arg_double:
+                LOG_TEXT_FORMAT_VALUE(&writer, spec_str, double, &reader);
+                break;
+            case log_arg_pointer:
+                LOG_TEXT_FORMAT_VALUE(&writer, spec_str, void *, &reader);
+                break;
+            case log_arg_string: {
+                uint16_t length;
+                if (!log_args_get(&reader, &length, sizeof(length)) || (reader.end - reader.pos < length + 1) || reader.pos[length]) {
+                    return -1;
+                }
+                const char * const str = (const char *)reader.pos;
+                reader.pos += length + 1;
+                size_t space;
+                char * const tail = log_text_tail(&writer, &space);
+                writer.length += snprintf(tail, space, spec_str, str);
+                break;
+            }
+            default:
+                return -1;
+        }
+    }
+
+    if (dst_size > 0) {
+        dst[min_int(writer.length, dst_size - 1)] = 0;
+    }
+
+    return writer.length;
+}
+
+/*
+===============================================================================
+Binary log file
+===============================================================================
+*/
+
+typedef enum log_binary_record_e {
+    // u16 id, u16 size, size bytes including the terminator
+    log_binary_record_string = 1,
+    // message header, u16 format id, u32 size, encoded arguments
+    log_binary_record_message,
+    // message header, u32 size, text without terminator
+    log_binary_record_text,
+    // all string ids are released
+    log_binary_record_reset_strings
+} log_binary_record_e;
+
+typedef struct log_binary_file_header_t {
+    uint32_t magic;
+    uint32_t version;
+} log_binary_file_header_t;
+
+static void log_binary_writer_put(log_binary_writer_t * const writer, const void * const src, const int size) {
+    if (writer->buffer_size + size > ARRAY_SIZE(writer->buffer)) {
+        log_binary_writer_flush(writer);
+    }
+
+    if (size > ARRAY_SIZE(writer->buffer)) {
+        sb_fwrite(src, 1, size, writer->file);
+    } else {
+        memcpy(writer->buffer + writer->buffer_size, src, size);
+        writer->buffer_size += size;
+    }
+}
+
+static void log_binary_writer_put_u8(log_binary_writer_t * const writer, const uint8_t value) {
+    log_binary_writer_put(writer, &value, sizeof(value));
+}
+
+static void log_binary_writer_put_u16(log_binary_writer_t * const writer, const uint16_t value) {
+    log_binary_writer_put(writer, &value, sizeof(value));
+}
+
+static void log_binary_writer_put_u32(log_binary_writer_t * const writer, const uint32_t value) {
+    log_binary_writer_put(writer, &value, sizeof(value));
+}
+
+static uint16_t log_binary_writer_intern(log_binary_writer_t * const writer, const char * str) {
+    if (!str) {
+        str = "";
+    }
+
+    const uintptr_t adr = (uintptr_t)str;
+    uint32_t slot = (uint32_t)((adr ^ (adr >> 15)) * 0x9e3779b1u) & (log_binary_max_strings - 1);
+    for (;; slot = (slot + 1) & (log_binary_max_strings - 1)) {
+        if (writer->strings[slot] == str) {
+            return (uint16_t)slot;
+        }
+
+        if (!writer->strings[slot]) {
+            writer->strings[slot] = str;
+            ++writer->num_strings;
+
+            const size_t size = strlen(str) + 1;
+            const uint16_t size16 = (uint16_t)min_int((int)size, UINT16_MAX);
+            log_binary_writer_put_u8(writer, log_binary_record_string);
+            log_binary_writer_put_u16(writer, (uint16_t)slot);
+            log_binary_writer_put_u16(writer, size16);
+            log_binary_writer_put(writer, str, size16 - 1);
+            log_binary_writer_put_u8(writer, 0);
+            return (uint16_t)slot;
+        }
+    }
+}
+
+void log_binary_writer_init(log_binary_writer_t * const writer, sb_file_t * const file) {
+    ZEROMEM(writer);
+    writer->file = file;
+
+    const log_binary_file_header_t header = {.magic = log_binary_file_magic, .version = log_binary_file_version};
+    log_binary_writer_put(writer, &header, sizeof(header));
+}
+
+void log_binary_writer_write(log_binary_writer_t * const writer, const log_header_t * const header, const char * const format, const uint8_t * const args, const int args_size) {
+    // a message interns at most three strings, keep the table at most 3/4 full so probes stay short
+    if (writer->num_strings + 3 > (log_binary_max_strings * 3) / 4) {
+        ZEROMEM(&writer->strings);
+        writer->num_strings = 0;
+        log_binary_writer_put_u8(writer, log_binary_record_reset_strings);
+    }
+
+    const uint16_t file_id = log_binary_writer_intern(writer, header->file);
+    const uint16_t func_id = log_binary_writer_intern(writer, header->func);
+    const uint16_t format_id = format ? log_binary_writer_intern(writer, format) : 0;
+
+    log_binary_writer_put_u8(writer, format ? log_binary_record_message : log_binary_record_text);
+    log_binary_writer_put_u32(writer, header->time_since_epoch.seconds);
+    log_binary_writer_put_u32(writer, header->time_since_epoch.microseconds);
+    log_binary_writer_put_u32(writer, header->fourcc_tag);
+    log_binary_writer_put_u16(writer, header->line);
+    log_binary_writer_put_u8(writer, header->level);
+    log_binary_writer_put_u16(writer, file_id);
+    log_binary_writer_put_u16(writer, func_id);
+    if (format) {
+        log_binary_writer_put_u16(writer, format_id);
+    }
+    log_binary_writer_put_u32(writer, (uint32_t)args_size);
+    log_binary_writer_put(writer, args, args_size);
+}
+
+void log_binary_writer_flush(log_binary_writer_t * const writer) {
+    if (writer->buffer_size > 0) {
+        sb_fwrite(writer->buffer, 1, writer->buffer_size, writer->file);
+        writer->buffer_size = 0;
+    }
+}
+
+static bool log_binary_reader_get(log_binary_reader_t * const reader, void * const dst, const int size) {
+    if (reader->end - reader->pos < size) {
+        return false;
+    }
+    memcpy(dst, reader->pos, size);
+    reader->pos += size;
+    return true;
+}
+
+static const char * log_binary_reader_get_string(log_binary_reader_t * const reader) {
+    uint16_t id;
+    if (!log_binary_reader_get(reader, &id, sizeof(id)) || (id >= log_binary_max_strings)) {
+        return NULL;
+    }
+    return reader->strings[id];
+}
+
+bool log_binary_reader_init(log_binary_reader_t * const reader, const const_mem_region_t contents) {
+    ZEROMEM(reader);
+    reader->pos = contents.byte_ptr;
+    reader->end = contents.byte_ptr + contents.size;
+
+    log_binary_file_header_t header;
+    return log_binary_reader_get(reader, &header, sizeof(header)) && (header.magic == log_binary_file_magic) && (header.version == log_binary_file_version);
+}
+
+bool log_binary_reader_next(log_binary_reader_t * const reader, log_header_t * const out_header, char * const text, const int text_size) {
+    for (;;) {
+        uint8_t record;
+        if (!log_binary_reader_get(reader, &record, sizeof(record))) {
+            return false;
+        }
+
+        switch (record) {
+            case log_binary_record_string: {
+                uint16_t id, size;
+                if (!log_binary_reader_get(reader, &id, sizeof(id)) || !log_binary_reader_get(reader, &size, sizeof(size))) {
+                    return false;
+                }
+                if ((id >= log_binary_max_strings) || (size < 1) || (reader->end - reader->pos < size) || reader->pos[size - 1]) {
+                    return false;
+                }
+                reader->strings[id] = (const char *)reader->pos;
+                reader->pos += size;
+                break;
+            }
+            case log_binary_record_reset_strings:
+                ZEROMEM(&reader->strings);
+                break;
+            case log_binary_record_message:
+            case log_binary_record_text: {
+                ZEROMEM(out_header);
+                uint8_t level;
+                if (!log_binary_reader_get(reader, &out_header->time_since_epoch.seconds, sizeof(uint32_t))
+                    || !log_binary_reader_get(reader, &out_header->time_since_epoch.microseconds, sizeof(uint32_t))
+                    || !log_binary_reader_get(reader, &out_header->fourcc_tag, sizeof(uint32_t))
+                    || !log_binary_reader_get(reader, &out_header->line, sizeof(uint16_t))
+                    || !log_binary_reader_get(reader, &level, sizeof(level))) {
+                    return false;
+                }
+                out_header->level = level;
+                out_header->file = log_binary_reader_get_string(reader);
+                out_header->func = log_binary_reader_get_string(reader);
+                const char * const format = (record == log_binary_record_message) ? log_binary_reader_get_string(reader) : NULL;
+                uint32_t size;
+                if (!out_header->file || !out_header->func || ((record == log_binary_record_message) && !format) || !log_binary_reader_get(reader, &size, sizeof(size)) || ((size_t)(reader->end - reader->pos) < size)) {
+                    return false;
+                }
+
+                const uint8_t * const payload = reader->pos;
+                reader->pos += size;
+
+                if (format) {
+                    return log_binary_format(text, text_size, format, payload, (int)size) >= 0;
+                }
+
+                if (text_size > 0) {
+                    const int length = min_int((int)size, text_size - 1);
+                    memcpy(text, payload, length);
+                    text[length] = 0;
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+}
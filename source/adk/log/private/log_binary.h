@@ -0,0 +1,102 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+ private/log_binary.h
+
+ Core Logging
+
+ Binary encoding of log message arguments for deferred formatting, and the
+ compact binary log file format.
+ */
+
+#pragma once
+
+#include "source/adk/log/private/log_p.h"
+#include "source/adk/steamboat/sb_file.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+===============================================================================
+Deferred formatting
+
+The logging thread walks the format string once to copy its arguments out of
+the va_list, the log receiver walks it again to format them. Integers, floats
+and pointers are copied by value and strings are copied by content, so only
+the format string itself must outlive the message.
+
+Formats using positional arguments, %n, wide characters or long double are
+not encoded and must be formatted eagerly.
+===============================================================================
+*/
+
+enum {
+    // encoded arguments larger than this are formatted eagerly
+    log_binary_max_args_size = 1024
+};
+
+// Writes the arguments referenced by `format` to `dst`.
+// Returns the encoded size, or -1 if the format is not supported or the arguments don't fit.
+int log_binary_encode_args(uint8_t * const dst, const int dst_size, const char * const format, va_list args);
+
+// Formats `format` with arguments written by log_binary_encode_args, follows snprintf semantics.
+// Returns the length of the full output or -1 if the arguments don't match the format.
+int log_binary_format(char * const dst, const int dst_size, const char * const format, const uint8_t * const args, const int args_size);
+
+/*
+===============================================================================
+Binary log file
+
+A file header followed by records. File, function and format strings are
+written once and then referenced by id, messages carry the encoded arguments
+instead of text. Records use native byte order.
+===============================================================================
+*/
+
+enum {
+    log_binary_file_magic = FOURCC('A', 'D', 'K', 'L'),
+    log_binary_file_version = 1,
+    // strings remembered before the string table is reset, must be a power of two
+    log_binary_max_strings = 512,
+    log_binary_writer_buffer_size = 16 * 1024
+};
+
+typedef struct log_binary_writer_t {
+    sb_file_t * file;
+    // hashed by address, the slot index is the string id
+    const char * strings[log_binary_max_strings];
+    int num_strings;
+    int buffer_size;
+    uint8_t buffer[log_binary_writer_buffer_size];
+} log_binary_writer_t;
+
+// writes the file header, the writer does not own `file`
+void log_binary_writer_init(log_binary_writer_t * const writer, sb_file_t * const file);
+
+// `format` and `args` from log_binary_encode_args, or a NULL `format` to write preformatted text of `args_size` bytes
+void log_binary_writer_write(log_binary_writer_t * const writer, const log_header_t * const header, const char * const format, const uint8_t * const args, const int args_size);
+
+void log_binary_writer_flush(log_binary_writer_t * const writer);
+
+typedef struct log_binary_reader_t {
+    const uint8_t * pos;
+    const uint8_t * end;
+    const char * strings[log_binary_max_strings];
+} log_binary_reader_t;
+
+// returns false if `contents` is not a binary log file
+bool log_binary_reader_init(log_binary_reader_t * const reader, const const_mem_region_t contents);
+
+// Decodes the next message and formats its text. `out_header` points into `contents`.
+// Returns false at the end of the file or on a truncated or malformed record.
+bool log_binary_reader_next(log_binary_reader_t * const reader, log_header_t * const out_header, char * const text, const int text_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -33,6 +33,12 @@ typedef struct log_header_t {
     log_level_t level;
 } log_header_t;
 
+// follows the log header of cncbus_msg_type_log_v2 messages, the encoded arguments follow
+typedef struct log_deferred_header_t {
+    const char * format;
+    int32_t args_size;
+} log_deferred_header_t;
+
 EXT_EXPORT void log_init(cncbus_t * const bus, const cncbus_address_t address, const cncbus_address_t subnet_mask, adk_reporting_instance_t * const reporting_instance);
 
 // Shuts down the publishing of logs to the bus, but still allows 'basic' logging
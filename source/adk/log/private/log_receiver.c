@@ -15,7 +15,9 @@
 #include "source/adk/log/private/log_receiver.h"
 
 #include "source/adk/cncbus/cncbus.h"
+#include "source/adk/cncbus/cncbus_addresses.h"
 #include "source/adk/cncbus/cncbus_msg_types.h"
+#include "source/adk/log/private/log_binary.h"
 #include "source/adk/log/private/log_p.h"
 #include "source/adk/steamboat/sb_file.h"
 
@@ -61,11 +63,11 @@ static struct {
         tty_tag_options_t default_tag;
         tty_tag_options_t custom_tags[log_receiver_max_customized_tags];
     } tty_options;
-
+    log_binary_writer_t * binary_sink;
 } log_receiver = {0};
 
 static int on_log_msg_received(cncbus_receiver_t * const self, const cncbus_msg_header_t header, cncbus_msg_t * const msg) {
-    if (header.msg_type != cncbus_msg_type_log_v1) {
+    if ((header.msg_type != cncbus_msg_type_log_v1) && (header.msg_type != cncbus_msg_type_log_v2)) {
         return 1;
     }
 
@@ -77,13 +79,32 @@ static int on_log_msg_received(cncbus_receiver_t * const self, const cncbus_msg_
     log_header_t log_header;
     cncbus_msg_read(msg, &log_header, sizeof(log_header_t));
 
-    // The rest of the cncbus msg is the text of the log message
     char log_msg[max_log_msg_length];
-    int message_size = header.msg_size - sizeof(log_header_t);
-    cncbus_msg_read(msg, log_msg, message_size);
-    log_msg[message_size - 1] = 0;
+    log_deferred_header_t deferred_header = {0};
+    uint8_t encoded_args[log_binary_max_args_size];
+
+    if (header.msg_type == cncbus_msg_type_log_v2) {
+        // The format and its unformatted arguments follow, the text is only produced if a sink needs it
+        if ((header.msg_size < sizeof(log_header_t) + sizeof(log_deferred_header_t)) || (cncbus_msg_read(msg, &deferred_header, sizeof(deferred_header)) != sizeof(deferred_header))) {
+            return 1;
+        }
+        if ((deferred_header.args_size < 0) || (deferred_header.args_size > ARRAY_SIZE(encoded_args)) || (cncbus_msg_read(msg, encoded_args, deferred_header.args_size) != deferred_header.args_size)) {
+            return 1;
+        }
+
+        if (log_receiver.binary_sink) {
+            log_binary_writer_write(log_receiver.binary_sink, &log_header, deferred_header.format, encoded_args, deferred_header.args_size);
+        }
+    } else {
+        // The rest of the cncbus msg is the text of the log message
+        int message_size = header.msg_size - sizeof(log_header_t);
+        cncbus_msg_read(msg, log_msg, message_size);
+        log_msg[message_size - 1] = 0;
 
-    // TODO future, this is where file logging output will likely be inserted
+        if (log_receiver.binary_sink) {
+            log_binary_writer_write(log_receiver.binary_sink, &log_header, NULL, (const uint8_t *)log_msg, message_size - 1);
+        }
+    }
 
     tty_tag_options_t * tty_tag_options;
     int i = 0;
@@ -102,6 +123,10 @@ static int on_log_msg_received(cncbus_receiver_t * const self, const cncbus_msg_
         return 0;
     }
 
+    if ((header.msg_type == cncbus_msg_type_log_v2) && (log_binary_format(log_msg, ARRAY_SIZE(log_msg), deferred_header.format, encoded_args, deferred_header.args_size) < 0)) {
+        return 1;
+    }
+
     struct tm time_info;
     sb_seconds_since_epoch_to_localtime(log_header.time_since_epoch.seconds, &time_info);
 
@@ -143,15 +168,34 @@ void log_receiver_init(cncbus_t * const bus, const cncbus_address_t address) {
         log_receiver.vtable.on_msg_recv = on_log_msg_received;
 
         cncbus_init_receiver(&log_receiver.bus_receiver, &log_receiver.vtable, address);
+        // a log storm must not stall the threads that are logging, shed the oldest lines instead
+        cncbus_receiver_set_backpressure_policy(&log_receiver.bus_receiver, cncbus_backpressure_drop_oldest);
 
         cncbus_connect(bus, &log_receiver.bus_receiver);
+        cncbus_join_group(bus, &log_receiver.bus_receiver, CNCBUS_GROUP_LOGGER);
     }
 }
 
 void log_receiver_shutdown(cncbus_t * const bus) {
     if (bus) {
         cncbus_disconnect(bus, &log_receiver.bus_receiver);
+
+        if (log_receiver.binary_sink) {
+            log_binary_writer_flush(log_receiver.binary_sink);
+        }
+
+        const cncbus_receiver_stats_t stats = cncbus_receiver_get_stats(&log_receiver.bus_receiver);
+        if (stats.num_dropped > 0) {
+            debug_write_line("log receiver dropped [%u] messages, max pending [%i]", stats.num_dropped, stats.max_pending);
+        }
+    }
+}
+
+void log_receiver_set_binary_sink(log_binary_writer_t * const writer) {
+    if (log_receiver.binary_sink) {
+        log_binary_writer_flush(log_receiver.binary_sink);
     }
+    log_receiver.binary_sink = writer;
 }
 
 void log_receiver_reload_tty_options() {
@@ -27,6 +27,13 @@ EXT_EXPORT void log_receiver_shutdown(cncbus_t * const bus);
 
 void log_receiver_reload_tty_options();
 
+struct log_binary_writer_t;
+
+// Also records every message to a binary log file, without formatting deferred messages (NULL to stop).
+// The writer is flushed when it's replaced and on shutdown. Not thread-safe with bus dispatch: set it
+// before connecting the receiver to a bus that is dispatching or while dispatch is paused.
+void log_receiver_set_binary_sink(struct log_binary_writer_t * const writer);
+
 #ifdef __cplusplus
 }
 #endif
@@ -70,6 +70,7 @@ DECL_CONST_STR(wasm_memory_size);
 DECL_CONST_STR(log_input_events);
 DECL_CONST_STR(network_pump_fragment_size);
 DECL_CONST_STR(network_pump_sleep_period_ms);
+DECL_CONST_STR(network_pump_fragment_budget);
 DECL_CONST_STR(watchdog);
 DECL_CONST_STR(low);
 DECL_CONST_STR(high);
@@ -706,7 +707,7 @@ static void manifest_parse_adk_websocket(const cJSON * const sys_params_obj, run
     MANIFEST_TRACE_POP();
 }
 
-static void manifest_get_canvas_font_atlas_dims(const cJSON * const canvas_obj, int32_t * const width, int32_t * const height) {
+static void manifest_get_canvas_font_atlas_dims(const cJSON * const canvas_obj, int32_t * const width, int32_t * const height, int32_t * const num_pages) {
     MANIFEST_TRACE_PUSH_FN();
     const cJSON * const font_atlas_obj = cJSON_GetObjectItem(canvas_obj, "font_atlas");
     if (!font_atlas_obj) {
@@ -721,6 +722,10 @@ static void manifest_get_canvas_font_atlas_dims(const cJSON * const canvas_obj,
     if (height_obj && cJSON_IsNumber(height_obj)) {
         *height = height_obj->valueint;
     }
+    const cJSON * const num_pages_obj = cJSON_GetObjectItem(font_atlas_obj, "num_pages");
+    if (num_pages_obj && cJSON_IsNumber(num_pages_obj) && (num_pages_obj->valueint > 0)) {
+        *num_pages = num_pages_obj->valueint;
+    }
     MANIFEST_TRACE_POP();
 }
 
@@ -732,6 +737,16 @@ static void manifest_parse_canvas_gl(const cJSON * const canvas_obj, runtime_con
         return;
     }
     {
+        const cJSON * const enable_draw_batching_obj = cJSON_GetObjectItem(gl_obj, "enable_draw_batching");
+        if (enable_draw_batching_obj && cJSON_IsBool(enable_draw_batching_obj)) {
+            runtime_config->canvas.gl.enable_draw_batching = (bool)enable_draw_batching_obj->valueint;
+        }
+
+        const cJSON * const enable_streaming_vertices_obj = cJSON_GetObjectItem(gl_obj, "enable_streaming_vertices");
+        if (enable_streaming_vertices_obj && cJSON_IsBool(enable_streaming_vertices_obj)) {
+            runtime_config->canvas.gl.enable_streaming_vertices = (bool)enable_streaming_vertices_obj->valueint;
+        }
+
         const cJSON * const internal_limits_obj = cJSON_GetObjectItem(gl_obj, "internal_limits");
         if (internal_limits_obj && cJSON_IsObject(internal_limits_obj)) {
             const cJSON * const max_verts_per_vertex_bank_obj = cJSON_GetObjectItem(internal_limits_obj, "max_verts_per_vertex_bank");
@@ -791,6 +806,19 @@ static void manifest_parse_canvas(const cJSON * const sys_params_obj, runtime_co
             if (size_obj && cJSON_IsNumber(size_obj)) {
                 runtime_config->canvas.text_mesh_cache.size = (uint32_t)size_obj->valueint;
             }
+            const cJSON * const max_bytes_obj = cJSON_GetObjectItem(text_mesh_cache_obj, "max_bytes");
+            if (max_bytes_obj && cJSON_IsNumber(max_bytes_obj)) {
+                runtime_config->canvas.text_mesh_cache.max_bytes = (uint32_t)max_bytes_obj->valueint;
+            }
+        }
+    }
+    {
+        const cJSON * const thread_cache_obj = cJSON_GetObjectItem(canvas_obj, "thread_cache");
+        if (thread_cache_obj && cJSON_IsObject(thread_cache_obj)) {
+            const cJSON * const enabled_obj = cJSON_GetObjectItem(thread_cache_obj, "enabled");
+            if (enabled_obj && cJSON_IsBool(enabled_obj)) {
+                runtime_config->canvas.thread_cache.enabled = (bool)enabled_obj->valueint;
+            }
         }
     }
     {
@@ -802,7 +830,7 @@ static void manifest_parse_canvas(const cJSON * const sys_params_obj, runtime_co
             }
         }
     }
-    manifest_get_canvas_font_atlas_dims(canvas_obj, &runtime_config->canvas.font_atlas.width, &runtime_config->canvas.font_atlas.height);
+    manifest_get_canvas_font_atlas_dims(canvas_obj, &runtime_config->canvas.font_atlas.width, &runtime_config->canvas.font_atlas.height, &runtime_config->canvas.font_atlas.num_pages);
     manifest_parse_canvas_gl(canvas_obj, runtime_config);
     MANIFEST_TRACE_POP();
 }
@@ -823,6 +851,11 @@ static void manifest_parse_renderer(const cJSON * const sys_params_obj, runtime_
             if (cmd_buf_size_obj && cJSON_IsNumber(cmd_buf_size_obj)) {
                 runtime_config->renderer.device.cmd_buf_size = cmd_buf_size_obj->valueint;
             }
+
+            const cJSON * const max_pending_frames_obj = cJSON_GetObjectItem(device_obj, "max_pending_frames");
+            if (max_pending_frames_obj && cJSON_IsNumber(max_pending_frames_obj)) {
+                runtime_config->renderer.device.max_pending_frames = max_pending_frames_obj->valueint;
+            }
         }
 
         const cJSON * const rhi_command_diffing_obj = cJSON_GetObjectItem(renderer_obj, "rhi_command_diffing");
@@ -849,12 +882,35 @@ static void manifest_parse_renderer(const cJSON * const sys_params_obj, runtime_
                     runtime_config->renderer.rhi_command_diffing.tracking.buffer_size = (size_t)buffer_size_obj->valueint;
                 }
             }
+
+            const cJSON * const dirty_regions_obj = cJSON_GetObjectItem(rhi_command_diffing_obj, "dirty_regions");
+            if ((dirty_regions_obj != NULL) && cJSON_IsObject(dirty_regions_obj)) {
+                const cJSON * const dirty_regions_enabled_obj = cJSON_GetObjectItem(dirty_regions_obj, "enabled");
+                if (dirty_regions_enabled_obj && cJSON_IsBool(dirty_regions_enabled_obj)) {
+                    runtime_config->renderer.rhi_command_diffing.dirty_regions.enabled = (bool)dirty_regions_enabled_obj->valueint;
+                }
+
+                const cJSON * const tile_size_obj = cJSON_GetObjectItem(dirty_regions_obj, "tile_size");
+                if (tile_size_obj && cJSON_IsNumber(tile_size_obj) && (tile_size_obj->valueint > 0)) {
+                    runtime_config->renderer.rhi_command_diffing.dirty_regions.tile_size = tile_size_obj->valueint;
+                }
+
+                const cJSON * const back_buffer_age_obj = cJSON_GetObjectItem(dirty_regions_obj, "back_buffer_age");
+                if (back_buffer_age_obj && cJSON_IsNumber(back_buffer_age_obj) && (back_buffer_age_obj->valueint >= 0)) {
+                    runtime_config->renderer.rhi_command_diffing.dirty_regions.back_buffer_age = back_buffer_age_obj->valueint;
+                }
+            }
         }
 
         const cJSON * const render_resource_tracking_obj = cJSON_GetObjectItem(renderer_obj, "render_resource_tracking");
         if (render_resource_tracking_obj && cJSON_IsObject(render_resource_tracking_obj)) {
             manifest_read_logging_mode(cJSON_GetObjectItem(render_resource_tracking_obj, "periodic_logging"), &runtime_config->renderer.render_resource_tracking.periodic_logging);
         }
+
+        const cJSON * const frame_metrics_obj = cJSON_GetObjectItem(renderer_obj, "frame_metrics");
+        if (frame_metrics_obj && cJSON_IsObject(frame_metrics_obj)) {
+            manifest_read_logging_mode(cJSON_GetObjectItem(frame_metrics_obj, "periodic_logging"), &runtime_config->renderer.frame_metrics.periodic_logging);
+        }
     }
 
     MANIFEST_TRACE_POP();
@@ -905,13 +961,22 @@ static runtime_configuration_renderer_t renderer_get_default_config() {
         .device = {
             .num_cmd_buffers = 32,
             .cmd_buf_size = 64 * 1024,
+            .max_pending_frames = 1,
         },
         .rhi_command_diffing = {.enabled = false, .verbose = false, .tracking = {
                                                                         .enabled = false,
                                                                         .buffer_size = 4096,
-                                                                    }},
+                                                                    },
+                                .dirty_regions = {
+                                    .enabled = false,
+                                    .tile_size = 64,
+                                    .back_buffer_age = 0,
+                                }},
         .render_resource_tracking = {
             .periodic_logging = logging_disabled,
+        },
+        .frame_metrics = {
+            .periodic_logging = logging_disabled,
         }};
 }
 
@@ -958,6 +1023,7 @@ runtime_configuration_t get_default_runtime_configuration(void) {
         .log_input_events = false,
         .network_pump_fragment_size = 4096,
         .network_pump_sleep_period = 1,
+        .network_pump_fragment_budget = 0,
         .watchdog = {
             .enabled = false,
             .suspend_threshold = 30,
@@ -976,15 +1042,22 @@ runtime_configuration_t get_default_runtime_configuration(void) {
                    .font_atlas = {
                        .width = 0,
                        .height = 0,
+                       .num_pages = cg_default_font_atlas_num_pages,
                    },
                    .text_mesh_cache = {
                        .size = cg_default_max_text_mesh_cache_size,
+                       .max_bytes = cg_default_text_mesh_cache_max_bytes,
+                       .enabled = false,
+                   },
+                   .thread_cache = {
                        .enabled = false,
                    },
                    .gzip_limits = {
                        .working_space = cg_gzip_default_working_space,
                    },
                    .gl = {
+                       .enable_draw_batching = true,
+                       .enable_streaming_vertices = true,
                        .internal_limits = {
                            .max_verts_per_vertex_bank = cg_gl_default_max_verts_per_vertex_bank,
                            .num_vertex_banks = cg_gl_default_vertex_banks,
@@ -1082,6 +1155,11 @@ static void process_runtime_configuration(const cJSON * const runtime_config_obj
             config->network_pump_sleep_period = net_pump_sleep_period->valueint;
         }
 
+        const cJSON * const net_pump_fragment_budget = cJSON_GetObjectItem(system_params_obj, c_network_pump_fragment_budget);
+        if (cJSON_IsNumber(net_pump_fragment_budget)) {
+            config->network_pump_fragment_budget = net_pump_fragment_budget->valueint;
+        }
+
         const cJSON * const watchdog_value = cJSON_GetObjectItem(system_params_obj, c_watchdog);
         if (cJSON_IsObject(watchdog_value)) {
             const cJSON * const enabled_value = cJSON_GetObjectItem(watchdog_value, "enabled");
@@ -59,6 +59,10 @@ typedef struct fetch_retry_context_t {
 } fetch_retry_context_t;
 
 typedef struct runtime_configuration_canvas_gl_t {
+    // merge consecutive draws sharing the same render state into one upload and draw call
+    bool enable_draw_batching;
+    // draw canvas vertices straight from a persistently mapped buffer where the device supports it
+    bool enable_streaming_vertices;
     struct {
         uint32_t max_verts_per_vertex_bank;
         uint32_t num_vertex_banks;
@@ -73,13 +77,22 @@ typedef struct runtime_configuration_canvas_t {
         uint32_t max_tessellation_steps;
     } internal_limits;
     struct {
+        // dimensions of a single atlas page, 0 uses the virtual display size
         int32_t width;
         int32_t height;
+        // number of pages stacked in the atlas texture, the least recently used page is evicted when a glyph does not fit
+        int32_t num_pages;
     } font_atlas;
     struct {
+        // maximum number of cached meshes
         uint32_t size;
+        // vertex bytes the cached meshes may hold before least recently used ones are dropped, 0 for no limit
+        uint32_t max_bytes;
         bool enabled;
     } text_mesh_cache;
+    struct {
+        bool enabled;
+    } thread_cache;
     struct {
         uint32_t working_space;
     } gzip_limits;
@@ -91,6 +104,8 @@ typedef struct runtime_configuration_renderer_t {
     struct {
         size_t num_cmd_buffers;
         size_t cmd_buf_size;
+        // number of frames that may be in flight before the main thread blocks on the renderer (1-3)
+        int max_pending_frames;
     } device;
 
     struct {
@@ -100,11 +115,20 @@ typedef struct runtime_configuration_renderer_t {
             bool enabled;
             size_t buffer_size;
         } tracking;
+        struct {
+            bool enabled;
+            int tile_size;
+            int back_buffer_age;
+        } dirty_regions;
     } rhi_command_diffing;
 
     struct {
         logging_mode_e periodic_logging;
     } render_resource_tracking;
+
+    struct {
+        logging_mode_e periodic_logging;
+    } frame_metrics;
 } runtime_configuration_renderer_t;
 
 typedef struct runtime_configuration_t {
@@ -116,6 +140,8 @@ typedef struct runtime_configuration_t {
     uint32_t wasm_heap_allocation_threshold;
     uint32_t network_pump_fragment_size;
     uint32_t network_pump_sleep_period;
+    // bytes of fragments the httpx network pump may map on top of its fragment buffers before stalling
+    uint32_t network_pump_fragment_budget;
     struct {
         bool enabled;
         uint32_t suspend_threshold;
@@ -1007,12 +1007,13 @@ void verify_wasm_call_and_halt_on_failure(const wasm_call_result_t call_result)
 static int tick(const uint32_t abstime, const float dt, void * arg) {
     MERLIN_TRACE_PUSH_FN();
 
-    uint32_t ret = 0;
-    const wasm_call_result_t tick_call_result = get_active_wasm_interpreter()->call_ri_ifp("app_tick", &ret, abstime, dt, arg);
+    const wasm_call_slot_t args[] = {{.i = abstime}, {.f = dt}, {.I = (uint64_t)(uintptr_t)arg}};
+    wasm_call_slot_t ret = {0};
+    const wasm_call_result_t tick_call_result = wasm_call_export(wasm_export_app_tick, &ret, ARRAY_SIZE(args), args);
     verify_wasm_call_and_halt_on_failure(tick_call_result);
 
     MERLIN_TRACE_POP();
-    return ret && !tick_call_result.status;
+    return ret.i && !tick_call_result.status;
 }
 
 void adk_runtime_override_system_metrics(adk_system_metrics_t * const out) {
@@ -39,6 +39,16 @@ typedef struct metrics_render_memory_usage_t {
     uint64_t uniform_buffer_memory;
 } metrics_render_memory_usage_t;
 
+typedef struct metrics_render_frame_times_t {
+    uint32_t num_frames;
+    int32_t max_pending_frames;
+    float mean_frame_time_ms;
+    float frame_time_stddev_ms;
+    float max_frame_time_ms;
+    float mean_wait_time_ms;
+    float max_wait_time_ms;
+} metrics_render_frame_times_t;
+
 typedef enum metric_types_e {
     metric_type_int,
     metric_type_float,
@@ -46,6 +56,7 @@ typedef enum metric_types_e {
     metric_type_time_to_first_interaction, // metric_time_to_first_interaction_t
     metric_type_memory_footprint, // metric_memory_footprint_t
     metric_type_metrics_render_memory_usage_t,
+    metric_type_metrics_render_frame_times_t,
     metric_types_last, // this must be the last element in the enum
     FORCE_ENUM_INT32(metric_types_e)
 } metric_types_e;
@@ -28,15 +28,26 @@ typedef struct rhi_hashed_cmd_t {
     render_cmd_e cmd_id;
 } rhi_hashed_cmd_t;
 
+enum {
+    rbcmd_dirty_max_rasterizer_states = 32,
+    // power of 2
+    rbcmd_dirty_content_table_size = 512,
+    rbcmd_dirty_max_back_buffer_age = 4,
+};
+
+// last content hash of a mesh, uniform buffer or texture uploaded this frame
+typedef struct rbcmd_dirty_content_t {
+    const void * key;
+    uint32_t hash;
+    uint32_t frame;
+} rbcmd_dirty_content_t;
+
 static struct {
     uint32_t hash;
 
     render_cmd_config_t config;
 
-    struct {
-        uint32_t matched_count;
-        uint32_t mismatched_count;
-    } metrics;
+    render_cmd_metrics_t metrics;
 
     struct {
         bool enabled;
@@ -46,11 +57,80 @@ static struct {
         bool is_commands_mismatched;
     } diff_tracking;
 
+    struct {
+        bool enabled;
+        int tile_size;
+        int back_buffer_age;
+
+        int display_width;
+        int display_height;
+        int num_tiles_x;
+        int num_tiles_y;
+        mem_region_t tiles_region;
+        // hash of everything drawn over each tile this frame and last frame
+        uint32_t * cur_tiles;
+        uint32_t * prev_tiles;
+        bool prev_tiles_valid;
+
+        uint32_t frame;
+        // this frame has to be redrawn in full (render targets, display resize, table overflow)
+        bool frame_full;
+        // the tile hashes of this frame are incomplete and can't be compared against next frame
+        bool frame_untracked;
+        // draws of this frame were already executed by an earlier command buffer
+        bool frame_split;
+        // draws of this frame were mixed into the tiles
+        bool frame_has_draws;
+
+        rhi_rect_t scissor;
+        bool scissor_test;
+        uint32_t program_hash;
+        uint32_t render_state_hash;
+        uint32_t viewport_hash;
+        uint32_t texture_bindings_hash;
+        const void * textures[rhi_program_num_textures];
+        int num_textures;
+        struct {
+            const void * buffer;
+            uint32_t hash;
+        } uniform_bindings[rhi_program_num_uniforms];
+
+        struct {
+            const void * rasterizer_state;
+            bool scissor_test;
+        } rasterizer_states[rbcmd_dirty_max_rasterizer_states];
+        int num_rasterizer_states;
+
+        rbcmd_dirty_content_t content[rbcmd_dirty_content_table_size];
+
+        // screen area of each draw and clear in the buffer being executed
+        rhi_rect_t * draw_rects;
+        // dirty areas of the last presented frames, most recent first
+        rhi_rect_t history[rbcmd_dirty_max_back_buffer_age];
+
+        double dirty_area_percent_sum;
+        uint32_t num_measured_frames;
+    } dirty_regions;
 } statics;
 
 void render_cmd_init(const render_cmd_config_t config) {
+    ZEROMEM(&statics);
     statics.config = config;
 
+    if (config.rhi_command_diffing.dirty_regions.enabled) {
+        if (!config.rhi_command_diffing.enabled) {
+            LOG_WARN(TAG_RBCMD, "RHI dirty region tracking requires RHI command diffing to be enabled");
+        } else {
+            statics.dirty_regions.enabled = true;
+            const int tile_size = config.rhi_command_diffing.dirty_regions.tile_size;
+            const int back_buffer_age = config.rhi_command_diffing.dirty_regions.back_buffer_age;
+            statics.dirty_regions.tile_size = (tile_size < 8) ? 8 : tile_size;
+            statics.dirty_regions.back_buffer_age = (back_buffer_age > rbcmd_dirty_max_back_buffer_age) ? rbcmd_dirty_max_back_buffer_age : back_buffer_age;
+            // content table entries stamped with frame 0 read as empty
+            statics.dirty_regions.frame = 1;
+        }
+    }
+
     if (config.rhi_command_diffing.tracking.enabled) {
 #ifndef _SHIP
         statics.diff_tracking.enabled = true;
@@ -67,6 +147,12 @@ void render_cmd_shutdown() {
         statics.diff_tracking.hash_commands = NULL;
         sb_unmap_pages(statics.diff_tracking.hash_commands_region);
     }
+
+    if (statics.dirty_regions.tiles_region.ptr) {
+        sb_unmap_pages(statics.dirty_regions.tiles_region);
+        statics.dirty_regions.tiles_region = (mem_region_t){0};
+    }
+    arrfree(statics.dirty_regions.draw_rects);
 }
 
 void render_cmd_log_metrics() {
@@ -75,6 +161,21 @@ void render_cmd_log_metrics() {
     }
 
     LOG_ALWAYS(TAG_RBCMD, "RHI diff: match: %lu, mismatch: %lu", statics.metrics.matched_count, statics.metrics.mismatched_count);
+
+    if (statics.dirty_regions.enabled) {
+        LOG_ALWAYS(
+            TAG_RBCMD,
+            "RHI dirty regions: full: %u, partial: %u, skipped: %u, dirty area: %.1f%% (avg %.1f%%)",
+            statics.metrics.dirty_regions.full_frames,
+            statics.metrics.dirty_regions.partial_frames,
+            statics.metrics.dirty_regions.skipped_frames,
+            statics.metrics.dirty_regions.last_dirty_area_percent,
+            statics.metrics.dirty_regions.average_dirty_area_percent);
+    }
+}
+
+void render_cmd_get_metrics(render_cmd_metrics_t * const out_metrics) {
+    *out_metrics = statics.metrics;
 }
 
 bool render_cmd_get_is_rhi_command_diffing_enabled() {
@@ -145,6 +246,15 @@ bool render_cmd_buf_write_render_command(
         return false;
     }
 
+    // dirty region tracking keeps each command's hash between the command id and its arguments
+    uint32_t * cmd_hash = NULL;
+    if (statics.dirty_regions.enabled) {
+        cmd_hash = (uint32_t *)hlba_allocate_low(&cmd_buf->hlba, 4, sizeof(uint32_t));
+        if (!cmd_hash) {
+            return false;
+        }
+    }
+
     // write the command before updating the cmd_ptr's so if we fail
     // we still have a valid command buffer
     void * const cmdblock = hlba_allocate_low(&cmd_buf->hlba, alignment, size);
@@ -165,6 +275,10 @@ bool render_cmd_buf_write_render_command(
             const uint32_t hash = render_cmd_hash_fn(cmd, size);
             cmd_buf->hash = rbcmd_hash_bytes(cmd_buf->hash, (void *)&hash, sizeof(hash));
 
+            if (cmd_hash) {
+                *cmd_hash = hash;
+            }
+
             RHI_TRACE_POP();
         }
 
@@ -271,6 +385,417 @@ enum render_cmd_order_check_e {
 
 #undef RENDER_COMMAND_FUNC
 
+/*
+=======================================
+Dirty region tracking
+
+Each draw and clear is hashed together with the state and the content
+(uploads this frame) it depends on and mixed into the hash of every screen
+tile it covers. Tiles that hash differently from the last frame are redrawn,
+everything else is left as it is in the back buffer.
+=======================================
+*/
+
+typedef enum rbcmd_dirty_mode_e {
+    rbcmd_dirty_mode_full,
+    rbcmd_dirty_mode_partial,
+    rbcmd_dirty_mode_skip
+} rbcmd_dirty_mode_e;
+
+static uint32_t rbcmd_dirty_mix(const uint32_t hash, const uint32_t value) {
+    return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
+static rbcmd_dirty_content_t * rbcmd_dirty_find_content(const void * const key, const bool insert) {
+    uint32_t slot = ((uint32_t)((uintptr_t)key >> 3) * 2654435761u) & (rbcmd_dirty_content_table_size - 1);
+    for (int i = 0; i < rbcmd_dirty_content_table_size; ++i) {
+        rbcmd_dirty_content_t * const entry = &statics.dirty_regions.content[slot];
+        if (entry->frame != statics.dirty_regions.frame) {
+            // entries are never removed during a frame, the first stale slot ends the probe
+            if (!insert) {
+                return NULL;
+            }
+            entry->key = key;
+            entry->hash = 0;
+            entry->frame = statics.dirty_regions.frame;
+            return entry;
+        }
+        if (entry->key == key) {
+            return entry;
+        }
+        slot = (slot + 1) & (rbcmd_dirty_content_table_size - 1);
+    }
+    return NULL;
+}
+
+static void rbcmd_dirty_update_content(const void * const key, const uint32_t hash) {
+    rbcmd_dirty_content_t * const entry = rbcmd_dirty_find_content(key, true);
+    if (entry) {
+        entry->hash = rbcmd_dirty_mix(entry->hash, hash);
+    } else {
+        statics.dirty_regions.frame_full = true;
+        statics.dirty_regions.frame_untracked = true;
+    }
+}
+
+static uint32_t rbcmd_dirty_content_hash(const void * const key) {
+    const rbcmd_dirty_content_t * const entry = key ? rbcmd_dirty_find_content(key, false) : NULL;
+    return entry ? entry->hash : 0;
+}
+
+static void rbcmd_dirty_set_display_size(const int width, const int height) {
+    if ((width == statics.dirty_regions.display_width) && (height == statics.dirty_regions.display_height)) {
+        return;
+    }
+
+    statics.dirty_regions.display_width = width;
+    statics.dirty_regions.display_height = height;
+    statics.dirty_regions.frame_full = true;
+    // the tiles start over, draws before the resize are lost from them
+    statics.dirty_regions.frame_untracked = statics.dirty_regions.frame_untracked || statics.dirty_regions.frame_has_draws;
+
+    if (statics.dirty_regions.tiles_region.ptr) {
+        sb_unmap_pages(statics.dirty_regions.tiles_region);
+        statics.dirty_regions.tiles_region = (mem_region_t){0};
+        statics.dirty_regions.cur_tiles = NULL;
+        statics.dirty_regions.prev_tiles = NULL;
+    }
+
+    const int tile_size = statics.dirty_regions.tile_size;
+    statics.dirty_regions.num_tiles_x = (width > 0) ? (width + tile_size - 1) / tile_size : 0;
+    statics.dirty_regions.num_tiles_y = (height > 0) ? (height + tile_size - 1) / tile_size : 0;
+
+    const size_t num_tiles = (size_t)statics.dirty_regions.num_tiles_x * (size_t)statics.dirty_regions.num_tiles_y;
+    if (num_tiles > 0) {
+        statics.dirty_regions.tiles_region = sb_map_pages(PAGE_ALIGN_PTR(sizeof(uint32_t) * num_tiles * 2), system_page_protect_read_write);
+        statics.dirty_regions.cur_tiles = (uint32_t *)statics.dirty_regions.tiles_region.ptr;
+        statics.dirty_regions.prev_tiles = statics.dirty_regions.cur_tiles + num_tiles;
+        memset(statics.dirty_regions.cur_tiles, 0, sizeof(uint32_t) * num_tiles);
+    }
+}
+
+static rhi_rect_t rbcmd_dirty_display_rect() {
+    return (rhi_rect_t){0, 0, statics.dirty_regions.display_width, statics.dirty_regions.display_height};
+}
+
+static bool rbcmd_dirty_lookup_scissor_test(const void * const rasterizer_state) {
+    for (int i = 0; i < statics.dirty_regions.num_rasterizer_states; ++i) {
+        if (statics.dirty_regions.rasterizer_states[i].rasterizer_state == rasterizer_state) {
+            return statics.dirty_regions.rasterizer_states[i].scissor_test;
+        }
+    }
+    // unknown states count as unscissored, which can only grow the area of a draw
+    return false;
+}
+
+static void rbcmd_dirty_add_rasterizer_state(const void * const rasterizer_state, const bool scissor_test) {
+    int i = 0;
+    while ((i < statics.dirty_regions.num_rasterizer_states) && (statics.dirty_regions.rasterizer_states[i].rasterizer_state != rasterizer_state)) {
+        ++i;
+    }
+    if (i == rbcmd_dirty_max_rasterizer_states) {
+        return;
+    }
+    if (i == statics.dirty_regions.num_rasterizer_states) {
+        ++statics.dirty_regions.num_rasterizer_states;
+    }
+    statics.dirty_regions.rasterizer_states[i].rasterizer_state = rasterizer_state;
+    statics.dirty_regions.rasterizer_states[i].scissor_test = scissor_test;
+}
+
+static void rbcmd_dirty_mark_tiles(const rhi_rect_t area, const uint32_t hash) {
+    if (!statics.dirty_regions.cur_tiles || rhi_rect_is_empty(area)) {
+        return;
+    }
+
+    const int tile_size = statics.dirty_regions.tile_size;
+    const int tx1 = (area.x1 - 1) / tile_size;
+    const int ty1 = (area.y1 - 1) / tile_size;
+    for (int ty = area.y0 / tile_size; ty <= ty1; ++ty) {
+        uint32_t * const row = statics.dirty_regions.cur_tiles + ty * statics.dirty_regions.num_tiles_x;
+        for (int tx = area.x0 / tile_size; tx <= tx1; ++tx) {
+            row[tx] = rbcmd_dirty_mix(row[tx], hash);
+        }
+    }
+}
+
+static uint32_t rbcmd_dirty_draw_hash(const uint32_t cmd_hash, const rhi_draw_params_indirect_t * const params) {
+    uint32_t hash = cmd_hash;
+    hash = rbcmd_dirty_mix(hash, statics.dirty_regions.program_hash);
+    hash = rbcmd_dirty_mix(hash, statics.dirty_regions.render_state_hash);
+    hash = rbcmd_dirty_mix(hash, statics.dirty_regions.viewport_hash);
+    hash = rbcmd_dirty_mix(hash, statics.dirty_regions.texture_bindings_hash);
+
+    for (int i = 0; i < statics.dirty_regions.num_textures; ++i) {
+        hash = rbcmd_dirty_mix(hash, rbcmd_dirty_content_hash(statics.dirty_regions.textures[i]));
+    }
+
+    for (int i = 0; i < rhi_program_num_uniforms; ++i) {
+        if (statics.dirty_regions.uniform_bindings[i].buffer) {
+            hash = rbcmd_dirty_mix(hash, statics.dirty_regions.uniform_bindings[i].hash);
+            hash = rbcmd_dirty_mix(hash, rbcmd_dirty_content_hash(statics.dirty_regions.uniform_bindings[i].buffer));
+        }
+    }
+
+    for (int i = 0; i < params->num_meshes; ++i) {
+        hash = rbcmd_dirty_mix(hash, rbcmd_dirty_content_hash(params->mesh_list[i]));
+    }
+
+    if (params->dynamic_content) {
+        hash = rbcmd_dirty_mix(hash, statics.dirty_regions.frame);
+    }
+
+    return hash;
+}
+
+static void rbcmd_dirty_add_draw(const rhi_rect_t area, const uint32_t hash) {
+    rbcmd_dirty_mark_tiles(area, hash);
+    statics.dirty_regions.frame_has_draws = true;
+    arrpush(statics.dirty_regions.draw_rects, area);
+}
+
+static bool rbcmd_dirty_is_draw_cmd(const render_cmd_e cmd_id) {
+    switch (cmd_id) {
+        case render_cmd_draw_indirect:
+        case render_cmd_clear_screen_cds:
+        case render_cmd_clear_screen_ds:
+        case render_cmd_clear_screen_c:
+        case render_cmd_clear_screen_d:
+        case render_cmd_clear_screen_s:
+            return true;
+        default:
+            return false;
+    }
+}
+
+#define RBCMD_DIRTY_CMD_ARGS(_type) ((const _type *)FWD_ALIGN_PTR(cmd_args, ALIGN_OF(_type)))
+
+// Updates the tracked state and tile hashes from the commands in `cmd_buf`, returns true if it presents.
+static bool rbcmd_dirty_scan(const rb_cmd_buf_t * const cmd_buf, bool * const out_has_draws) {
+    RHI_TRACE_PUSH_FN();
+
+    // arrsetlen(a, 0) trips -Wtype-limits on its unsigned capacity check
+    if (statics.dirty_regions.draw_rects) {
+        stbds_header(statics.dirty_regions.draw_rects)->length = 0;
+    }
+
+    const uint8_t * const block_base = cmd_buf->hlba.block;
+    const uint32_t * cmd_ptr = (const uint32_t *)block_base;
+    bool has_present = false;
+    bool has_draws = false;
+
+    for (int i = 0; i < cmd_buf->num_cmds; ++i) {
+        const render_cmd_e cmd_id = cmd_ptr[0] & RB_CMD_ID_MASK;
+        const uint32_t cmd_hash = cmd_ptr[1];
+        const void * const cmd_args = cmd_ptr + 2;
+
+        if (has_present && rbcmd_dirty_is_draw_cmd(cmd_id)) {
+            // next frame started in the same buffer, its draws can't be told apart from this frame's
+            statics.dirty_regions.frame_full = true;
+            statics.dirty_regions.frame_untracked = true;
+        }
+
+        switch (cmd_id) {
+            case render_cmd_set_display_size: {
+                const render_cmd_set_display_size_t * const rc = RBCMD_DIRTY_CMD_ARGS(render_cmd_set_display_size_t);
+                rbcmd_dirty_set_display_size(rc->w, rc->h);
+                break;
+            }
+            case render_cmd_set_viewport:
+                statics.dirty_regions.viewport_hash = cmd_hash;
+                break;
+            case render_cmd_set_scissor_rect: {
+                const render_cmd_set_scissor_rect_t * const rc = RBCMD_DIRTY_CMD_ARGS(render_cmd_set_scissor_rect_t);
+                statics.dirty_regions.scissor = (rhi_rect_t){rc->x0, rc->y0, rc->x1, rc->y1};
+                break;
+            }
+            case render_cmd_set_program_indirect:
+                statics.dirty_regions.program_hash = cmd_hash;
+                break;
+            case render_cmd_set_render_state_indirect: {
+                const render_cmd_set_render_state_indirect_t * const rc = RBCMD_DIRTY_CMD_ARGS(render_cmd_set_render_state_indirect_t);
+                statics.dirty_regions.render_state_hash = cmd_hash;
+                statics.dirty_regions.scissor_test = rbcmd_dirty_lookup_scissor_test(rc->rs);
+                break;
+            }
+            case render_cmd_create_rasterizer_state: {
+                const render_cmd_create_rasterizer_state_t * const rc = RBCMD_DIRTY_CMD_ARGS(render_cmd_create_rasterizer_state_t);
+                rbcmd_dirty_add_rasterizer_state(rc->out_rasterizer_state, rc->rasterizer_state_desc.scissor_test);
+                break;
+            }
+            case render_cmd_set_uniform_binding_indirect: {
+                const render_cmd_set_uniform_binding_indirect_t * const rc = RBCMD_DIRTY_CMD_ARGS(render_cmd_set_uniform_binding_indirect_t);
+                const int index = rc->uniform_binding.index;
+                if ((index >= 0) && (index < rhi_program_num_uniforms)) {
+                    statics.dirty_regions.uniform_bindings[index].buffer = rc->uniform_binding.buffer;
+                    statics.dirty_regions.uniform_bindings[index].hash = cmd_hash;
+                } else {
+                    statics.dirty_regions.frame_full = true;
+                }
+                break;
+            }
+            case render_cmd_set_texture_bindings_indirect: {
+                const render_cmd_set_texture_bindings_indirect_t * const rc = RBCMD_DIRTY_CMD_ARGS(render_cmd_set_texture_bindings_indirect_t);
+                statics.dirty_regions.texture_bindings_hash = cmd_hash;
+                statics.dirty_regions.num_textures = (rc->texture_bindings.num_textures < rhi_program_num_textures) ? rc->texture_bindings.num_textures : rhi_program_num_textures;
+                for (int t = 0; t < statics.dirty_regions.num_textures; ++t) {
+                    statics.dirty_regions.textures[t] = rc->texture_bindings.textures[t];
+                }
+                break;
+            }
+            case render_cmd_upload_mesh_channel_data_indirect:
+                rbcmd_dirty_update_content(RBCMD_DIRTY_CMD_ARGS(render_cmd_upload_mesh_channel_data_indirect_t)->mesh, cmd_hash);
+                break;
+            case render_cmd_upload_mesh_indices_indirect:
+                rbcmd_dirty_update_content(RBCMD_DIRTY_CMD_ARGS(render_cmd_upload_mesh_indices_indirect_t)->mesh, cmd_hash);
+                break;
+            case render_cmd_upload_uniform_data_indirect:
+                rbcmd_dirty_update_content(RBCMD_DIRTY_CMD_ARGS(render_cmd_upload_uniform_data_indirect_t)->uniform_buffer, cmd_hash);
+                break;
+            case render_cmd_upload_texture_indirect:
+                rbcmd_dirty_update_content(RBCMD_DIRTY_CMD_ARGS(render_cmd_upload_texture_indirect_t)->texture, cmd_hash);
+                break;
+#if !(defined(_VADER) || defined(_LEIA))
+            case render_cmd_upload_sub_texture_indirect:
+                rbcmd_dirty_update_content(RBCMD_DIRTY_CMD_ARGS(render_cmd_upload_sub_texture_indirect_t)->texture, cmd_hash);
+                break;
+#endif
+#if defined(_LEIA) || defined(_VADER)
+            case render_cmd_bind_texture_address:
+                rbcmd_dirty_update_content(RBCMD_DIRTY_CMD_ARGS(render_cmd_bind_texture_address_t)->texture, cmd_hash);
+                break;
+#endif
+            case render_cmd_set_texture_sampler_state_indirect:
+                rbcmd_dirty_update_content(RBCMD_DIRTY_CMD_ARGS(render_cmd_set_texture_sampler_state_indirect_t)->texture, cmd_hash);
+                break;
+            case render_cmd_set_render_target_color_buffer_indirect:
+            case render_cmd_discard_render_target_data_indirect:
+            case render_cmd_set_render_target_indirect:
+            case render_cmd_clear_render_target_color_buffers_indirect:
+            case render_cmd_copy_render_target_buffers_indirect:
+                // render target contents aren't tracked and draws into them aren't in screen space
+                statics.dirty_regions.frame_full = true;
+                break;
+            case render_cmd_draw_indirect: {
+                const render_cmd_draw_indirect_t * const rc = RBCMD_DIRTY_CMD_ARGS(render_cmd_draw_indirect_t);
+                const rhi_rect_t display = rbcmd_dirty_display_rect();
+                rhi_rect_t area = rhi_rect_is_empty(rc->params.bounds) ? display : rhi_rect_intersect(rc->params.bounds, display);
+                if (statics.dirty_regions.scissor_test) {
+                    area = rhi_rect_intersect(area, statics.dirty_regions.scissor);
+                }
+                rbcmd_dirty_add_draw(area, rbcmd_dirty_draw_hash(cmd_hash, &rc->params));
+                has_draws = true;
+                break;
+            }
+            case render_cmd_clear_screen_cds:
+            case render_cmd_clear_screen_ds:
+            case render_cmd_clear_screen_c:
+            case render_cmd_clear_screen_d:
+            case render_cmd_clear_screen_s:
+                // clears ignore the scissor rect
+                rbcmd_dirty_add_draw(rbcmd_dirty_display_rect(), rbcmd_dirty_mix(cmd_hash, cmd_id));
+                has_draws = true;
+                break;
+            case render_cmd_present:
+                has_present = true;
+                break;
+            default:
+                break;
+        }
+
+        cmd_ptr = (const uint32_t *)(block_base + ((cmd_ptr[0] >> NUM_RB_CMD_ID_BITS) & MAX_RB_CMD_JUMP_MASK));
+    }
+
+    *out_has_draws = has_draws;
+
+    RHI_TRACE_POP();
+    return has_present;
+}
+
+#undef RBCMD_DIRTY_CMD_ARGS
+
+static int64_t rbcmd_dirty_rect_area(const rhi_rect_t rect) {
+    return rhi_rect_is_empty(rect) ? 0 : (int64_t)(rect.x1 - rect.x0) * (int64_t)(rect.y1 - rect.y0);
+}
+
+// Decides how the frame presented by the scanned buffer is drawn, `out_clip` is set for partial frames.
+static rbcmd_dirty_mode_e rbcmd_dirty_begin_present(rhi_rect_t * const out_clip) {
+    const rhi_rect_t display = rbcmd_dirty_display_rect();
+    const int num_tiles_x = statics.dirty_regions.num_tiles_x;
+    const int num_tiles_y = statics.dirty_regions.num_tiles_y;
+    const int tile_size = statics.dirty_regions.tile_size;
+
+    const bool is_tracked = statics.dirty_regions.cur_tiles && statics.dirty_regions.prev_tiles_valid && !statics.dirty_regions.frame_full;
+
+    rhi_rect_t dirty = {0};
+    if (is_tracked) {
+        for (int ty = 0; ty < num_tiles_y; ++ty) {
+            for (int tx = 0; tx < num_tiles_x; ++tx) {
+                const int tile = ty * num_tiles_x + tx;
+                if (statics.dirty_regions.cur_tiles[tile] != statics.dirty_regions.prev_tiles[tile]) {
+                    const rhi_rect_t tile_rect = {tx * tile_size, ty * tile_size, (tx + 1) * tile_size, (ty + 1) * tile_size};
+                    dirty = rhi_rect_union(dirty, rhi_rect_intersect(tile_rect, display));
+                }
+            }
+        }
+    } else {
+        dirty = display;
+    }
+
+    const int64_t display_area = rbcmd_dirty_rect_area(display);
+    const float dirty_area_percent = (display_area > 0) ? (float)(100.0 * (double)rbcmd_dirty_rect_area(dirty) / (double)display_area) : 100.f;
+    statics.dirty_regions.dirty_area_percent_sum += dirty_area_percent;
+    ++statics.dirty_regions.num_measured_frames;
+    statics.metrics.dirty_regions.last_dirty_area_percent = dirty_area_percent;
+    statics.metrics.dirty_regions.average_dirty_area_percent = (float)(statics.dirty_regions.dirty_area_percent_sum / statics.dirty_regions.num_measured_frames);
+
+    const int back_buffer_age = statics.dirty_regions.back_buffer_age;
+    bool is_full = !is_tracked || statics.dirty_regions.frame_split || (back_buffer_age == 0);
+
+    // the back buffer misses the changes of the frames presented since it was last drawn
+    rhi_rect_t clip = dirty;
+    for (int i = 0; i < back_buffer_age - 1; ++i) {
+        clip = rhi_rect_union(clip, statics.dirty_regions.history[i]);
+    }
+    is_full = is_full || ((clip.x0 <= 0) && (clip.y0 <= 0) && (clip.x1 >= display.x1) && (clip.y1 >= display.y1));
+
+    // skipped frames are still presented, so they take an empty history slot
+    for (int i = rbcmd_dirty_max_back_buffer_age - 1; i > 0; --i) {
+        statics.dirty_regions.history[i] = statics.dirty_regions.history[i - 1];
+    }
+    statics.dirty_regions.history[0] = is_full ? display : dirty;
+
+    if (!is_full && rhi_rect_is_empty(clip)) {
+        ++statics.metrics.dirty_regions.skipped_frames;
+        return rbcmd_dirty_mode_skip;
+    }
+
+    if (is_full) {
+        ++statics.metrics.dirty_regions.full_frames;
+        return rbcmd_dirty_mode_full;
+    }
+
+    ++statics.metrics.dirty_regions.partial_frames;
+    *out_clip = clip;
+    return rbcmd_dirty_mode_partial;
+}
+
+static void rbcmd_dirty_end_frame() {
+    uint32_t * const tiles = statics.dirty_regions.prev_tiles;
+    statics.dirty_regions.prev_tiles = statics.dirty_regions.cur_tiles;
+    statics.dirty_regions.cur_tiles = tiles;
+    if (tiles) {
+        memset(tiles, 0, sizeof(uint32_t) * statics.dirty_regions.num_tiles_x * statics.dirty_regions.num_tiles_y);
+    }
+
+    statics.dirty_regions.prev_tiles_valid = (tiles != NULL) && !statics.dirty_regions.frame_untracked;
+    statics.dirty_regions.frame_full = false;
+    statics.dirty_regions.frame_untracked = false;
+    statics.dirty_regions.frame_split = false;
+    statics.dirty_regions.frame_has_draws = false;
+    ++statics.dirty_regions.frame;
+}
+
 static bool rb_cmd_buf_test_hash(rb_cmd_buf_t * const cmd_buf, int num_cmds) {
     bool is_command_buffer_match = false;
 
@@ -306,7 +831,28 @@ void rb_cmd_buf_execute(rhi_device_t * device, rb_cmd_buf_t * const cmd_buf) {
     const uint32_t * cmd_ptr = (const uint32_t *)block_base;
     int num_cmds = cmd_buf->num_cmds;
 
-    const bool is_command_buffer_match = rb_cmd_buf_test_hash(cmd_buf, num_cmds);
+    // dirty region tracking decides what to skip per draw instead of per buffer
+    const bool is_command_buffer_match = rb_cmd_buf_test_hash(cmd_buf, num_cmds) && !statics.dirty_regions.enabled;
+
+    rbcmd_dirty_mode_e dirty_mode = rbcmd_dirty_mode_full;
+    rhi_rect_t dirty_clip = {0};
+    bool has_present = false;
+    if (statics.dirty_regions.enabled && !is_command_buffer_match) {
+        bool has_draws = false;
+        has_present = rbcmd_dirty_scan(cmd_buf, &has_draws);
+        if (has_present) {
+            dirty_mode = rbcmd_dirty_begin_present(&dirty_clip);
+        } else if (has_draws) {
+            statics.dirty_regions.frame_split = true;
+        }
+
+        if (dirty_mode == rbcmd_dirty_mode_partial) {
+            rhi_set_clip_rect(device, &dirty_clip);
+        }
+    }
+    // command arguments follow the command id, and the command hash when tracking dirty regions
+    const int cmd_args_ofs = statics.dirty_regions.enabled ? 2 : 1;
+    int draw_index = 0;
 
 #if ENABLE_RENDER_TAGS
     const char * last_cmd_tag = NULL;
@@ -328,15 +874,31 @@ void rb_cmd_buf_execute(rhi_device_t * device, rb_cmd_buf_t * const cmd_buf) {
             ASSERT(next_cmd_jump >= 0);
             ASSERT(next_cmd_jump < cmd_buf->hlba.size);
 
+            // only draws are dropped, skipped frames are still presented to keep the swap chain and frame pacing going
+            bool should_execute = true;
+            if ((dirty_mode != rbcmd_dirty_mode_full) && rbcmd_dirty_is_draw_cmd(cmd_id)) {
+                should_execute = (dirty_mode == rbcmd_dirty_mode_partial) && !rhi_rect_is_empty(rhi_rect_intersect(statics.dirty_regions.draw_rects[draw_index], dirty_clip));
+                ++draw_index;
+            }
+
+            if (should_execute) {
 #if ENABLE_RENDER_TAGS
-            last_cmd_tag =
+                last_cmd_tag =
 #endif
-                s_rb_render_cmd_func_table[cmd_id](device, cmd_ptr + 1);
+                    s_rb_render_cmd_func_table[cmd_id](device, cmd_ptr + cmd_args_ofs);
+            }
 
             cmd_ptr = (const uint32_t *)(block_base + next_cmd_jump);
         }
     }
 
+    if (dirty_mode == rbcmd_dirty_mode_partial) {
+        rhi_set_clip_rect(device, NULL);
+    }
+    if (has_present) {
+        rbcmd_dirty_end_frame();
+    }
+
     sb_atomic_fetch_add(&cmd_buf->retire_counter, 1, memory_order_relaxed);
 
     cmd_buf->next_cmd_ptr = NULL;
@@ -88,13 +88,38 @@ typedef struct render_cmd_config_t {
             bool enabled;
             size_t buffer_size;
         } tracking;
+        // Hashes the commands of each frame per screen tile and only redraws the tiles that changed.
+        // Needs the whole frame in one command buffer, anything else is redrawn in full.
+        struct {
+            bool enabled;
+            // width and height of a tile in pixels
+            int tile_size;
+            // number of frames old the back buffer is after a present: 1 when the platform preserves it,
+            // 2 for a double buffered swap chain, 0 when its contents are undefined (always redraw in full)
+            int back_buffer_age;
+        } dirty_regions;
     } rhi_command_diffing;
 } render_cmd_config_t;
 
+typedef struct render_cmd_metrics_t {
+    uint32_t matched_count;
+    uint32_t mismatched_count;
+    struct {
+        uint32_t full_frames;
+        uint32_t partial_frames;
+        // frames where nothing changed, presented without drawing
+        uint32_t skipped_frames;
+        // share of the display that changed, 0 to 100
+        float last_dirty_area_percent;
+        float average_dirty_area_percent;
+    } dirty_regions;
+} render_cmd_metrics_t;
+
 void render_cmd_init(const render_cmd_config_t config);
 void render_cmd_shutdown();
 
 void render_cmd_log_metrics();
+void render_cmd_get_metrics(render_cmd_metrics_t * const out_metrics);
 bool render_cmd_get_is_rhi_command_diffing_enabled();
 
 /*
@@ -175,6 +200,8 @@ typedef enum render_cmd_e {
     render_cmd_release_rhi_resource_indirect,
     render_cmd_upload_mesh_channel_data_indirect,
     render_cmd_upload_mesh_indices_indirect,
+    render_cmd_map_mesh_channel_indirect,
+    render_cmd_fence_mesh_stream_indirect,
     render_cmd_upload_uniform_data_indirect,
     render_cmd_upload_texture_indirect,
 #if !(defined(_VADER) || defined(_LEIA))
@@ -204,6 +231,8 @@ typedef enum render_cmd_e {
     render_cmd_clear_screen_s,
     render_cmd_present,
     render_cmd_screenshot,
+    render_cmd_screenshot_async,
+    render_cmd_poll_screenshots,
 
     render_cmd_create_mesh_data_layout,
     render_cmd_create_mesh_indirect,
@@ -343,6 +372,52 @@ static inline bool render_cmd_buf_write_upload_mesh_indices_indirect(rb_cmd_buf_
     return render_cmd_buf_write_render_command(cmd_buf, render_cmd_upload_mesh_indices_indirect, &cmd, ALIGN_OF(cmd), sizeof(cmd), render_cmd_random_hash);
 }
 
+/*
+=======================================
+render_cmd_buf_write_map_mesh_channel_indirect
+=======================================
+*/
+
+typedef struct render_cmd_map_mesh_channel_indirect_t {
+    rhi_mesh_t * const * mesh;
+    int channel_index;
+    void ** out;
+    DECL_RENDER_TAG
+} render_cmd_map_mesh_channel_indirect_t;
+
+static inline bool render_cmd_buf_write_map_mesh_channel_indirect(rb_cmd_buf_t * const cmd_buf, rhi_mesh_t * const * const mesh, const int channel_index, void ** const out, const char * const tag) {
+    const render_cmd_map_mesh_channel_indirect_t cmd = {
+        mesh,
+        channel_index,
+        out,
+        ASSIGN_RENDER_TAG};
+
+    return render_cmd_buf_write_render_command(cmd_buf, render_cmd_map_mesh_channel_indirect, &cmd, ALIGN_OF(cmd), sizeof(cmd), render_cmd_random_hash);
+}
+
+/*
+=======================================
+render_cmd_buf_write_fence_mesh_stream_indirect
+=======================================
+*/
+
+typedef struct render_cmd_fence_mesh_stream_indirect_t {
+    rhi_mesh_t * const * mesh;
+    int signal_slot;
+    int wait_slot;
+    DECL_RENDER_TAG
+} render_cmd_fence_mesh_stream_indirect_t;
+
+static inline bool render_cmd_buf_write_fence_mesh_stream_indirect(rb_cmd_buf_t * const cmd_buf, rhi_mesh_t * const * const mesh, const int signal_slot, const int wait_slot, const char * const tag) {
+    const render_cmd_fence_mesh_stream_indirect_t cmd = {
+        mesh,
+        signal_slot,
+        wait_slot,
+        ASSIGN_RENDER_TAG};
+
+    return render_cmd_buf_write_render_command(cmd_buf, render_cmd_fence_mesh_stream_indirect, &cmd, ALIGN_OF(cmd), sizeof(cmd), render_cmd_random_hash);
+}
+
 /*
 =======================================
 render_cmd_buf_write_upload_uniform_data_indirect
@@ -995,6 +1070,50 @@ static inline bool render_cmd_buf_screenshot(rb_cmd_buf_t * const cmd_buf, image
     return render_cmd_buf_write_render_command(cmd_buf, render_cmd_screenshot, &cmd, ALIGN_OF(cmd), sizeof(cmd), render_cmd_random_hash);
 }
 
+/*
+=======================================
+render_cmd_buf_screenshot_async
+=======================================
+*/
+
+typedef struct render_cmd_screenshot_async_t {
+    image_t * image;
+    const mem_region_t mem_region;
+    rhi_screenshot_callback_t callback;
+    void * user;
+    DECL_RENDER_TAG
+} render_cmd_screenshot_async_t;
+
+static inline bool render_cmd_buf_screenshot_async(rb_cmd_buf_t * const cmd_buf, image_t * const out_image, const mem_region_t mem_region, const rhi_screenshot_callback_t callback, void * const user, const char * const tag) {
+    render_cmd_screenshot_async_t cmd = {
+        out_image,
+        mem_region,
+        callback,
+        user,
+        ASSIGN_RENDER_TAG};
+
+    return render_cmd_buf_write_render_command(cmd_buf, render_cmd_screenshot_async, &cmd, ALIGN_OF(cmd), sizeof(cmd), render_cmd_random_hash);
+}
+
+/*
+=======================================
+render_cmd_buf_poll_screenshots
+=======================================
+*/
+
+typedef struct render_cmd_poll_screenshots_t {
+    bool wait;
+    DECL_RENDER_TAG
+} render_cmd_poll_screenshots_t;
+
+static inline bool render_cmd_buf_poll_screenshots(rb_cmd_buf_t * const cmd_buf, const bool wait, const char * const tag) {
+    render_cmd_poll_screenshots_t cmd = {
+        wait,
+        ASSIGN_RENDER_TAG};
+
+    return render_cmd_buf_write_render_command(cmd_buf, render_cmd_poll_screenshots, &cmd, ALIGN_OF(cmd), sizeof(cmd), render_cmd_random_hash);
+}
+
 /*
 =======================================
 render_cmd_buf_write_create_mesh_data_layout
@@ -29,6 +29,12 @@ RENDER_COMMAND_FUNC(render_cmd_upload_mesh_channel_data_indirect,
 RENDER_COMMAND_FUNC(render_cmd_upload_mesh_indices_indirect,
                     rhi_upload_mesh_indices(device, *cmd_args->mesh, cmd_args->first_index, cmd_args->num_indices, cmd_args->indices);)
 
+RENDER_COMMAND_FUNC(render_cmd_map_mesh_channel_indirect,
+                    *cmd_args->out = rhi_map_mesh_channel(device, *cmd_args->mesh, cmd_args->channel_index);)
+
+RENDER_COMMAND_FUNC(render_cmd_fence_mesh_stream_indirect,
+                    rhi_fence_mesh_stream(device, *cmd_args->mesh, cmd_args->signal_slot, cmd_args->wait_slot);)
+
 RENDER_COMMAND_FUNC(render_cmd_upload_uniform_data_indirect,
                     rhi_upload_uniform_data(device, *cmd_args->uniform_buffer, cmd_args->data, cmd_args->ofs);)
 
@@ -107,6 +113,12 @@ RENDER_COMMAND_FUNC(render_cmd_present,
 RENDER_COMMAND_FUNC(render_cmd_screenshot,
                     rhi_screenshot(device, cmd_args->image, cmd_args->mem_region);)
 
+RENDER_COMMAND_FUNC(render_cmd_screenshot_async,
+                    rhi_screenshot_async(device, cmd_args->image, cmd_args->mem_region, cmd_args->callback, cmd_args->user);)
+
+RENDER_COMMAND_FUNC(render_cmd_poll_screenshots,
+                    rhi_poll_screenshots(device, cmd_args->wait);)
+
 RENDER_COMMAND_FUNC(render_cmd_create_mesh_data_layout,
                     *cmd_args->out = rhi_create_mesh_data_layout(device, &cmd_args->layout_desc, cmd_args->tag);)
 
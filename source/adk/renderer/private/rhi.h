@@ -41,6 +41,8 @@ typedef struct rhi_device_caps_t {
 enum {
     rhi_program_input_max_textures = 4,
     rhi_program_input_max_uniforms = 10,
+    // gpu fence slots per mesh for regions of a rhi_usage_stream channel
+    rhi_max_mesh_stream_fences = 8,
 #if defined(_RPI) || defined(_STB_NATIVE)
     rhi_max_devices = 1,
     rhi_max_render_target_color_buffers = 1
@@ -161,7 +163,9 @@ typedef enum rhi_vertex_index_format_e {
 typedef enum rhi_usage_e {
     rhi_usage_default,
     rhi_usage_dynamic,
-    rhi_usage_rendertarget
+    rhi_usage_rendertarget,
+    // written by the cpu through a persistent mapping (see map_mesh_channel), behaves like rhi_usage_dynamic where unsupported
+    rhi_usage_stream
 } rhi_usage_e;
 
 typedef enum rhi_pixel_format_e {
@@ -376,6 +380,35 @@ typedef struct rhi_render_target_color_buffer_indirect_t {
     int index;
 } rhi_render_target_color_buffer_indirect_t;
 
+typedef struct rhi_rect_t {
+    int x0, y0, x1, y1;
+} rhi_rect_t;
+
+static inline bool rhi_rect_is_empty(const rhi_rect_t rect) {
+    return (rect.x1 <= rect.x0) || (rect.y1 <= rect.y0);
+}
+
+static inline rhi_rect_t rhi_rect_intersect(const rhi_rect_t a, const rhi_rect_t b) {
+    return (rhi_rect_t){
+        .x0 = (a.x0 > b.x0) ? a.x0 : b.x0,
+        .y0 = (a.y0 > b.y0) ? a.y0 : b.y0,
+        .x1 = (a.x1 < b.x1) ? a.x1 : b.x1,
+        .y1 = (a.y1 < b.y1) ? a.y1 : b.y1};
+}
+
+static inline rhi_rect_t rhi_rect_union(const rhi_rect_t a, const rhi_rect_t b) {
+    if (rhi_rect_is_empty(a)) {
+        return b;
+    } else if (rhi_rect_is_empty(b)) {
+        return a;
+    }
+    return (rhi_rect_t){
+        .x0 = (a.x0 < b.x0) ? a.x0 : b.x0,
+        .y0 = (a.y0 < b.y0) ? a.y0 : b.y0,
+        .x1 = (a.x1 > b.x1) ? a.x1 : b.x1,
+        .y1 = (a.y1 > b.y1) ? a.y1 : b.y1};
+}
+
 typedef struct rhi_draw_params_indirect_t {
     struct rhi_mesh_t * const * const * mesh_list;
     const int * idx_ofs;
@@ -383,12 +416,20 @@ typedef struct rhi_draw_params_indirect_t {
     const uint32_t * hashes;
     int num_meshes;
     rhi_draw_mode_e mode;
+    // number of draws a front end merged into this one, 0 if it was not batched
+    int num_batched_draws;
+    // screen area the draw touches (same space as the scissor rect), empty when unknown
+    rhi_rect_t bounds;
+    // reads textures that change outside the command stream (video), always redrawn by dirty region tracking
+    bool dynamic_content;
 } rhi_draw_params_indirect_t;
 
 typedef struct rhi_counters_t {
     uint32_t num_tris;
     uint32_t num_draw_calls;
     uint32_t num_api_calls;
+    // api calls the device dropped because its shadow of the api state showed they wouldn't change anything
+    uint32_t num_redundant_api_calls;
     uint32_t num_upload_verts;
     uint32_t upload_vert_size;
     uint32_t num_upload_indices;
@@ -397,6 +438,9 @@ typedef struct rhi_counters_t {
     uint32_t upload_uniform_size;
     uint32_t num_upload_textures;
     uint32_t upload_texture_size;
+    // draw calls built by batching several draws together, and the number of draws they replaced
+    uint32_t num_batches;
+    uint32_t num_batched_draws;
 } rhi_counters_t;
 
 static inline rhi_counters_t rhi_add_counters(const rhi_counters_t * a, const rhi_counters_t * b) {
@@ -404,6 +448,7 @@ static inline rhi_counters_t rhi_add_counters(const rhi_counters_t * a, const rh
         /*.num_tris =*/a->num_tris + b->num_tris,
         /*.num_draw_calls =*/a->num_draw_calls + b->num_draw_calls,
         /*.num_api_calls =*/a->num_api_calls + b->num_api_calls,
+        /*.num_redundant_api_calls =*/a->num_redundant_api_calls + b->num_redundant_api_calls,
         /*.num_upload_verts =*/a->num_upload_verts + b->num_upload_verts,
         /*.upload_vert_size =*/a->upload_vert_size + b->upload_vert_size,
         /*.num_upload_indices =*/a->num_upload_indices + b->num_upload_indices,
@@ -411,7 +456,9 @@ static inline rhi_counters_t rhi_add_counters(const rhi_counters_t * a, const rh
         /*.num_upload_uniforms =*/a->num_upload_uniforms + b->num_upload_uniforms,
         /*.upload_uniform_size =*/a->upload_uniform_size + b->upload_uniform_size,
         /*.num_upload_textures =*/a->num_upload_textures + b->num_upload_textures,
-        /*.upload_texture_size =*/a->upload_texture_size + b->upload_texture_size};
+        /*.upload_texture_size =*/a->upload_texture_size + b->upload_texture_size,
+        /*.num_batches =*/a->num_batches + b->num_batches,
+        /*.num_batched_draws =*/a->num_batched_draws + b->num_batched_draws};
     return counter;
 }
 
@@ -655,6 +702,11 @@ Devices contain a rendering context and state
 */
 
 struct rhi_device_vtable_t;
+struct image_t;
+
+/// Completion callback for asynchronous screenshots, runs on the thread executing render commands
+/// once the pixels have been read back into `image`.
+typedef void (*rhi_screenshot_callback_t)(void * const user, struct image_t * const image);
 
 /// The Rendering Hardware Interface device
 typedef struct rhi_device_t {
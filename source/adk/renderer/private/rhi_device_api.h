@@ -38,6 +38,10 @@ typedef struct rhi_device_vtable_t {
     void (*thread_device_done_current)(rhi_device_t * const device);
     void (*upload_mesh_channel_data)(rhi_device_t * const device, rhi_mesh_t * const mesh, const int channel_index, const int first_elem, const int num_elems, const void * const data);
     void (*upload_mesh_indices)(rhi_device_t * const device, rhi_mesh_t * const mesh, const int first_index, const int num_indices, const void * const indices);
+    // Returns a pointer the cpu can write a rhi_usage_stream channel through for the life of the mesh, NULL if the device can't map it
+    void * (*map_mesh_channel)(rhi_device_t * const device, rhi_mesh_t * const mesh, const int channel_index);
+    // Fences gpu reads of the stream region `signal_slot` and then waits for the gpu to finish with region `wait_slot` (-1 for none)
+    void (*fence_mesh_stream)(rhi_device_t * const device, rhi_mesh_t * const mesh, const int signal_slot, const int wait_slot);
     void (*upload_uniform_data)(rhi_device_t * const device, rhi_uniform_buffer_t * const uniform_buffer, const const_mem_region_t data, const int ofs);
     void (*upload_texture)(rhi_device_t * const device, rhi_texture_t * const texture, const image_mips_t * const mipmaps);
 #if !(defined(_VADER) || defined(_LEIA))
@@ -49,6 +53,8 @@ typedef struct rhi_device_vtable_t {
     void (*set_display_size)(rhi_device_t * const device, const int w, const int h);
     void (*set_viewport)(rhi_device_t * const device, const int x0, const int y0, const int x1, const int y1);
     void (*set_scissor_rect)(rhi_device_t * const device, const int x0, const int y0, const int x1, const int y1);
+    // Restricts all rendering to the screen, including clears, to `rect` until called with NULL
+    void (*set_clip_rect)(rhi_device_t * const device, const rhi_rect_t * const rect);
     void (*set_program)(rhi_device_t * const device, rhi_program_t * const program);
     void (*set_render_state)(rhi_device_t * const device, rhi_rasterizer_state_t * const rs, rhi_depth_stencil_state_t * const dss, rhi_blend_state_t * const bs, const uint32_t stencil_ref);
     void (*set_render_target_color_buffer)(rhi_device_t * const device, rhi_render_target_t * const render_target, rhi_texture_t * const color_buffer, const int index);
@@ -67,6 +73,8 @@ typedef struct rhi_device_vtable_t {
     void (*clear_screen_s)(rhi_device_t * const device, const uint8_t s);
     void (*present)(rhi_device_t * const device, const rhi_swap_interval_t swap_interval);
     void (*screenshot)(rhi_device_t * const device, image_t * const image, const mem_region_t mem_region);
+    void (*screenshot_async)(rhi_device_t * const device, image_t * const image, const mem_region_t mem_region, const rhi_screenshot_callback_t callback, void * const user);
+    void (*poll_screenshots)(rhi_device_t * const device, const bool wait);
     void (*read_and_clear_counters)(rhi_device_t * const device, rhi_counters_t * const counters);
 
     rhi_mesh_data_layout_t * (*create_mesh_data_layout)(rhi_device_t * const device, const rhi_mesh_data_layout_desc_t * const mesh_data_layout, const char * const tag);
@@ -111,6 +119,20 @@ static inline void rhi_upload_mesh_indices(rhi_device_t * device, rhi_mesh_t * c
 #endif
 }
 
+static inline void * rhi_map_mesh_channel(rhi_device_t * const device, rhi_mesh_t * const mesh, const int channel_index) {
+#ifdef RHI_NULL_DEVICE
+    return NULL;
+#else
+    return device->vtable->map_mesh_channel(device, mesh, channel_index);
+#endif
+}
+
+static inline void rhi_fence_mesh_stream(rhi_device_t * const device, rhi_mesh_t * const mesh, const int signal_slot, const int wait_slot) {
+#ifndef RHI_NULL_DEVICE
+    device->vtable->fence_mesh_stream(device, mesh, signal_slot, wait_slot);
+#endif
+}
+
 static inline void rhi_upload_uniform_data(rhi_device_t * const device, rhi_uniform_buffer_t * const uniform_buffer, const const_mem_region_t data, const int ofs) {
 #ifndef RHI_NULL_DEVICE
     device->vtable->upload_uniform_data(device, uniform_buffer, data, ofs);
@@ -157,6 +179,12 @@ static inline void rhi_set_scissor_rect(rhi_device_t * const device, const int x
 #endif
 }
 
+static inline void rhi_set_clip_rect(rhi_device_t * const device, const rhi_rect_t * const rect) {
+#ifndef RHI_NULL_DEVICE
+    device->vtable->set_clip_rect(device, rect);
+#endif
+}
+
 static inline void rhi_set_program(rhi_device_t * const device, rhi_program_t * const program) {
 #ifndef RHI_NULL_DEVICE
     device->vtable->set_program(device, program);
@@ -265,6 +293,18 @@ static inline void rhi_screenshot(rhi_device_t * const device, image_t * const o
 #endif
 }
 
+static inline void rhi_screenshot_async(rhi_device_t * const device, image_t * const out_image, const mem_region_t mem_region, const rhi_screenshot_callback_t callback, void * const user) {
+#ifndef RHI_NULL_DEVICE
+    device->vtable->screenshot_async(device, out_image, mem_region, callback, user);
+#endif
+}
+
+static inline void rhi_poll_screenshots(rhi_device_t * const device, const bool wait) {
+#ifndef RHI_NULL_DEVICE
+    device->vtable->poll_screenshots(device, wait);
+#endif
+}
+
 static inline void rhi_read_and_clear_counters(rhi_device_t * const device, rhi_counters_t * const counter) {
 #ifndef RHI_NULL_DEVICE
     device->vtable->read_and_clear_counters(device, counter);
@@ -17,8 +17,11 @@ Render main
 #include "source/adk/log/log.h"
 #include "source/adk/metrics/metrics.h"
 #include "source/adk/renderer/renderer.h"
+#include "source/adk/runtime/time.h"
 #include "source/adk/steamboat/sb_thread.h"
 
+#include <math.h>
+
 #define RENDER_TAG FOURCC('R', 'N', 'D', 'R')
 
 /*
@@ -142,6 +145,16 @@ heap_metrics_t render_get_heap_metrics(const render_device_t * const device) {
 /*
 =======================================
 render threads and command buffer queue helpers
+
+Ordered command buffers are submitted lock-free: producers push them onto
+the `submitted_cmd_bufs` stack and the one thread executing ordered command
+buffers takes the whole stack at once, appending it to `ordered_cmd_buf_que`
+in submission order. Unordered command buffers and the free chain are
+guarded by the mutex.
+
+Threads only signal `queued_signal` and `retired_signal` while someone
+waits on them. Waiters register under the mutex before checking their
+wake condition so they can't miss a signal.
 =======================================
 */
 
@@ -169,6 +182,116 @@ static rb_cmd_buf_t * deque_next_cmd_buf(rb_cmd_buf_que_t * const que) {
     return NULL;
 }
 
+static void push_submitted_cmd_buf(render_device_t * const device, rb_cmd_buf_t * const buf) {
+    ASSERT(buf->next == NULL);
+    rb_cmd_buf_t * head = sb_atomic_load_ptr(&device->internal.submitted_cmd_bufs, memory_order_relaxed);
+    for (;;) {
+        buf->next = head;
+        rb_cmd_buf_t * const prev = sb_atomic_cas_ptr(&device->internal.submitted_cmd_bufs, buf, head, memory_order_seq_cst);
+        if (prev == head) {
+            return;
+        }
+        head = prev;
+    }
+}
+
+// Moves everything submitted so far into `ordered_cmd_buf_que`, only called by the thread executing ordered command buffers
+static void take_submitted_cmd_bufs(render_device_t * const device) {
+    rb_cmd_buf_t * head = sb_atomic_load_ptr(&device->internal.submitted_cmd_bufs, memory_order_acquire);
+    while (head) {
+        rb_cmd_buf_t * const prev = sb_atomic_cas_ptr(&device->internal.submitted_cmd_bufs, NULL, head, memory_order_seq_cst);
+        if (prev == head) {
+            break;
+        }
+        head = prev;
+    }
+
+    // the stack is newest first
+    rb_cmd_buf_t * const tail = head;
+    rb_cmd_buf_t * first = NULL;
+    while (head) {
+        rb_cmd_buf_t * const next = head->next;
+        head->next = first;
+        first = head;
+        head = next;
+    }
+
+    if (first) {
+        rb_cmd_buf_que_t * const que = &device->internal.ordered_cmd_buf_que;
+        if (que->tail) {
+            que->tail->next = first;
+        } else {
+            que->head = first;
+        }
+        que->tail = tail;
+    }
+}
+
+static rb_cmd_buf_t * deque_next_ordered_cmd_buf(render_device_t * const device) {
+    if (!device->internal.ordered_cmd_buf_que.head) {
+        take_submitted_cmd_bufs(device);
+    }
+    return deque_next_cmd_buf(&device->internal.ordered_cmd_buf_que);
+}
+
+static rb_cmd_buf_t * deque_next_unordered_cmd_buf(render_device_t * const device) {
+    if (sb_atomic_load(&device->internal.num_unordered_cmd_bufs, memory_order_relaxed) < 1) {
+        return NULL;
+    }
+
+    sb_lock_mutex(device->internal.mutex);
+    rb_cmd_buf_t * const buf = deque_next_cmd_buf(&device->internal.unordered_cmd_buf_que);
+    if (buf) {
+        sb_atomic_fetch_add(&device->internal.num_unordered_cmd_bufs, -1, memory_order_relaxed);
+    }
+    sb_unlock_mutex(device->internal.mutex);
+    return buf;
+}
+
+static bool has_queued_cmd_bufs(render_device_t * const device, const bool ordered) {
+    if (sb_atomic_load(&device->internal.num_unordered_cmd_bufs, memory_order_seq_cst) > 0) {
+        return true;
+    }
+    return ordered && (device->internal.ordered_cmd_buf_que.head || sb_atomic_load_ptr(&device->internal.submitted_cmd_bufs, memory_order_seq_cst));
+}
+
+static void signal_queued_cmd_buf(render_device_t * const device) {
+    if (sb_atomic_load(&device->internal.num_queue_waiters, memory_order_seq_cst) > 0) {
+        sb_lock_mutex(device->internal.mutex);
+        sb_condition_wake_all(device->internal.queued_signal);
+        sb_unlock_mutex(device->internal.mutex);
+    }
+}
+
+static void signal_retired_cmd_buf(render_device_t * const device) {
+    if (sb_atomic_load(&device->internal.num_retire_waiters, memory_order_seq_cst) > 0) {
+        sb_lock_mutex(device->internal.mutex);
+        sb_condition_wake_all(device->internal.retired_signal);
+        sb_unlock_mutex(device->internal.mutex);
+    }
+}
+
+// Returns an executed command buffer to the free chain
+static void retire_cmd_buf(render_device_t * const device, rb_cmd_buf_t * const buf) {
+    sb_lock_mutex(device->internal.mutex);
+    buf->next = device->internal.free_cmd_buf_chain;
+    device->internal.free_cmd_buf_chain = buf;
+    sb_unlock_mutex(device->internal.mutex);
+
+    sb_atomic_fetch_add(&device->internal.done_count, 1, memory_order_seq_cst);
+    signal_retired_cmd_buf(device);
+}
+
+// The mutex must be held, waits for a command buffer to retire.
+// Callers bracket their condition loop with begin/end so the retiring thread knows to signal.
+static void begin_wait_retired(render_device_t * const device) {
+    sb_atomic_fetch_add(&device->internal.num_retire_waiters, 1, memory_order_seq_cst);
+}
+
+static void end_wait_retired(render_device_t * const device) {
+    sb_atomic_fetch_add(&device->internal.num_retire_waiters, -1, memory_order_relaxed);
+}
+
 // see rbcmd.c for this function
 void rb_cmd_buf_execute(rhi_device_t * const device, rb_cmd_buf_t * const cmd_buf);
 
@@ -188,14 +311,14 @@ rb_cmd_buf_t * render_get_cmd_buf(render_device_t * const device, const render_w
     rb_cmd_buf_t * buf = NULL;
 
     sb_lock_mutex(device->internal.mutex);
+    begin_wait_retired(device);
 
     for (;;) {
         buf = device->internal.free_cmd_buf_chain;
         if (buf) {
             device->internal.free_cmd_buf_chain = buf->next;
             buf->next = NULL;
-            sb_unlock_mutex(device->internal.mutex);
-            return buf;
+            break;
         } else if (wait_mode == render_wait) {
             if (device->internal.num_device_threads > 0) {
                 // there is one or more rendering threads
@@ -206,17 +329,19 @@ rb_cmd_buf_t * render_get_cmd_buf(render_device_t * const device, const render_w
                 if (this_thread == device->internal.device_thread_id) {
                     // this is happening in the main() application thread
                     // so we can safely run command buffers here.
-                    buf = deque_next_cmd_buf(&device->internal.ordered_cmd_buf_que);
+                    end_wait_retired(device);
+                    sb_unlock_mutex(device->internal.mutex);
+
+                    buf = deque_next_ordered_cmd_buf(device);
                     if (!buf) {
-                        buf = deque_next_cmd_buf(&device->internal.unordered_cmd_buf_que);
+                        buf = deque_next_unordered_cmd_buf(device);
                     }
                     ASSERT(buf);
-                    sb_unlock_mutex(device->internal.mutex);
 
                     // if we have multiple devices make sure this one is current
                     rhi_thread_make_device_current(device->internal.device);
                     rb_cmd_buf_execute(device->internal.device, buf);
-                    sb_atomic_fetch_add(&device->internal.done_count, 1, memory_order_relaxed);
+                    sb_atomic_fetch_add(&device->internal.done_count, 1, memory_order_seq_cst);
                     // DO NOT SIGNAL retired_signal, we aren't queueing a free buffer here
                     return buf;
                 }
@@ -225,8 +350,14 @@ rb_cmd_buf_t * render_get_cmd_buf(render_device_t * const device, const render_w
                 // so wait for the main thread to do some work.
                 sb_wait_condition(device->internal.retired_signal, device->internal.mutex, sb_timeout_infinite);
             }
+        } else {
+            break;
         }
     }
+
+    end_wait_retired(device);
+    sb_unlock_mutex(device->internal.mutex);
+    return buf;
 }
 
 /*
@@ -252,31 +383,34 @@ static void link_cmd_buf(rb_cmd_buf_que_t * const q, rb_cmd_buf_t * const cmd_bu
 
 rb_fence_t render_submit_cmd_buf(render_device_t * const device, rb_cmd_buf_t * const cmd_buf, const rb_cmd_buf_order_e cmd_buf_order) {
     rb_fence_t fence = null_rb_fence;
-    sb_lock_mutex(device->internal.mutex);
 
     if (cmd_buf->num_cmds > 0) {
         fence.cmd_buf = cmd_buf;
         fence.counter = ++cmd_buf->submit_counter;
 
+        sb_atomic_fetch_add(&device->internal.submit_count, 1, memory_order_relaxed);
+
         switch (cmd_buf_order) {
             case cmd_buf_ordered:
-                link_cmd_buf(&device->internal.ordered_cmd_buf_que, cmd_buf);
+                push_submitted_cmd_buf(device, cmd_buf);
                 break;
             case cmd_buf_unordered:
+                sb_lock_mutex(device->internal.mutex);
                 link_cmd_buf(&device->internal.unordered_cmd_buf_que, cmd_buf);
+                sb_atomic_fetch_add(&device->internal.num_unordered_cmd_bufs, 1, memory_order_seq_cst);
+                sb_unlock_mutex(device->internal.mutex);
                 break;
             default:
                 TRAP("invalid cmd_buf_order");
         }
 
-        sb_unlock_mutex(device->internal.mutex);
-        sb_atomic_fetch_add(&device->internal.submit_count, 1, memory_order_relaxed);
-        sb_condition_wake_one(device->internal.queued_signal);
+        signal_queued_cmd_buf(device);
     } else {
+        sb_lock_mutex(device->internal.mutex);
         cmd_buf->next = device->internal.free_cmd_buf_chain;
         device->internal.free_cmd_buf_chain = cmd_buf;
         sb_unlock_mutex(device->internal.mutex);
-        sb_condition_wake_all(device->internal.retired_signal);
+        signal_retired_cmd_buf(device);
     }
 
     return fence;
@@ -284,29 +418,23 @@ rb_fence_t render_submit_cmd_buf(render_device_t * const device, rb_cmd_buf_t *
 
 /*
 =======================================
-render_proc_exec_cmd_buf
+render_proc_wait_queued
 
-Executes a specific command queue, called from
-a rendering thread
+Blocks a rendering thread until command buffers
+are queued, returns false if the device is quitting
 =======================================
 */
 
-static int render_proc_exec_cmd_buf(render_device_t * const device, rhi_device_t * const rhi_device, rb_cmd_buf_t * const buf, const int order) {
-    if (buf) {
-        sb_unlock_mutex(device->internal.mutex);
-        rb_cmd_buf_execute(rhi_device, buf);
-        sb_lock_mutex(device->internal.mutex);
-        sb_atomic_fetch_add(&device->internal.done_count, 1, memory_order_relaxed);
-        buf->next = device->internal.free_cmd_buf_chain;
-        device->internal.free_cmd_buf_chain = buf;
-        sb_condition_wake_all(device->internal.retired_signal);
-
-        return order + 1;
+static bool render_proc_wait_queued(render_device_t * const device, const bool ordered) {
+    sb_lock_mutex(device->internal.mutex);
+    sb_atomic_fetch_add(&device->internal.num_queue_waiters, 1, memory_order_seq_cst);
+    while (!device->internal.quit && !has_queued_cmd_bufs(device, ordered)) {
+        sb_wait_condition(device->internal.queued_signal, device->internal.mutex, sb_timeout_infinite);
     }
-
-    // wait for queued signal
-    sb_wait_condition(device->internal.queued_signal, device->internal.mutex, sb_timeout_infinite);
-    return order;
+    sb_atomic_fetch_add(&device->internal.num_queue_waiters, -1, memory_order_relaxed);
+    const bool quit = device->internal.quit;
+    sb_unlock_mutex(device->internal.mutex);
+    return !quit;
 }
 
 /*
@@ -327,28 +455,33 @@ static int render_proc_any_order(void * const arg) {
 
     rhi_thread_make_device_current(rhi_device);
 
-    sb_lock_mutex(device->internal.mutex);
-    while (!device->internal.quit) {
+    for (;;) {
         rb_cmd_buf_t * buf;
 
         // deque next command buffer
         // swap buffer order so we service both queues
 
         if (order & 1) {
-            buf = deque_next_cmd_buf(&device->internal.unordered_cmd_buf_que);
+            buf = deque_next_unordered_cmd_buf(device);
             if (!buf) {
-                buf = deque_next_cmd_buf(&device->internal.ordered_cmd_buf_que);
+                buf = deque_next_ordered_cmd_buf(device);
             }
         } else {
-            buf = deque_next_cmd_buf(&device->internal.ordered_cmd_buf_que);
+            buf = deque_next_ordered_cmd_buf(device);
             if (!buf) {
-                buf = deque_next_cmd_buf(&device->internal.unordered_cmd_buf_que);
+                buf = deque_next_unordered_cmd_buf(device);
             }
         }
 
-        order = render_proc_exec_cmd_buf(device, rhi_device, buf, order);
+        if (buf) {
+            rb_cmd_buf_execute(rhi_device, buf);
+            retire_cmd_buf(device, buf);
+            ++order;
+        } else if (!render_proc_wait_queued(device, true)) {
+            break;
+        }
     }
-    sb_unlock_mutex(device->internal.mutex);
+
     rhi_thread_device_done_current(rhi_device);
     return 0;
 }
@@ -369,12 +502,15 @@ static int render_proc_only_out_of_order(void * const arg) {
 
     rhi_thread_make_device_current(rhi_device);
 
-    sb_lock_mutex(device->internal.mutex);
-    while (!device->internal.quit) {
-        rb_cmd_buf_t * const buf = deque_next_cmd_buf(&device->internal.unordered_cmd_buf_que);
-        render_proc_exec_cmd_buf(device, rhi_device, buf, 0);
+    for (;;) {
+        rb_cmd_buf_t * const buf = deque_next_unordered_cmd_buf(device);
+        if (buf) {
+            rb_cmd_buf_execute(rhi_device, buf);
+            retire_cmd_buf(device, buf);
+        } else if (!render_proc_wait_queued(device, false)) {
+            break;
+        }
     }
-    sb_unlock_mutex(device->internal.mutex);
 
     rhi_thread_device_done_current(rhi_device);
     return 0;
@@ -495,6 +631,7 @@ render_device_t * create_render_device(rhi_api_t * const api, struct sb_window_t
     render_resource_init(&device->resource, NULL, &render_device_vtable, render_resource_type_render_device_t, tag);
 
     device->api = api;
+    device->caps = caps;
     device->internal.device = rhi_device;
     device->internal.mutex = sb_create_mutex(MALLOC_TAG);
     device->internal.queued_signal = sb_create_condition_variable(MALLOC_TAG);
@@ -502,6 +639,7 @@ render_device_t * create_render_device(rhi_api_t * const api, struct sb_window_t
     device->internal.device_thread_id = sb_get_current_thread_id();
     device->internal.num_device_threads = num_device_threads;
     device->internal.guard_page_mode = guard_page_mode;
+    device->internal.max_pending_frames = render_default_pending_frames;
 
     uint8_t * const cmd_buf_block_start = block.byte_ptr + aligned_render_device_size + (aligned_render_thread_size * num_device_threads);
 
@@ -628,15 +766,7 @@ static void flush_cmd_buf_que(render_device_t * const device, rhi_device_t * con
 
     while (buf) {
         rb_cmd_buf_execute(rhi_device, buf);
-
-        sb_lock_mutex(device->internal.mutex);
-        buf->next = device->internal.free_cmd_buf_chain;
-        device->internal.free_cmd_buf_chain = buf;
-        sb_unlock_mutex(device->internal.mutex);
-
-        sb_atomic_fetch_add(&device->internal.done_count, 1, memory_order_relaxed);
-        sb_condition_wake_one(device->internal.retired_signal);
-
+        retire_cmd_buf(device, buf);
         buf = deque_next_cmd_buf(&que);
     }
     RHI_TRACE_POP();
@@ -648,10 +778,12 @@ static void async_wait_render_device(render_device_t * const device) {
     // wait until complete count passes submit count
     if (wrap_is_less(sb_atomic_load(&device->internal.done_count, memory_order_relaxed), submit_count)) {
         sb_lock_mutex(device->internal.mutex);
-        do {
+        begin_wait_retired(device);
+        while (wrap_is_less(sb_atomic_load(&device->internal.done_count, memory_order_seq_cst), submit_count)) {
             // wait until a command queue has been retired
             sb_wait_condition(device->internal.retired_signal, device->internal.mutex, sb_timeout_infinite);
-        } while (wrap_is_less(sb_atomic_load(&device->internal.done_count, memory_order_relaxed), submit_count));
+        }
+        end_wait_retired(device);
         sb_unlock_mutex(device->internal.mutex);
     }
     RHI_TRACE_POP();
@@ -659,12 +791,15 @@ static void async_wait_render_device(render_device_t * const device) {
 
 static void flush_device_command_buffers(render_device_t * const device) {
     RHI_TRACE_PUSH_FN();
-    sb_lock_mutex(device->internal.mutex);
+    // only the device thread of a non-threaded device gets here, so it owns the ordered queue
+    take_submitted_cmd_bufs(device);
     const rb_cmd_buf_que_t ordered = device->internal.ordered_cmd_buf_que;
-    const rb_cmd_buf_que_t unordered = device->internal.unordered_cmd_buf_que;
-
     ZEROMEM(&device->internal.ordered_cmd_buf_que);
+
+    sb_lock_mutex(device->internal.mutex);
+    const rb_cmd_buf_que_t unordered = device->internal.unordered_cmd_buf_que;
     ZEROMEM(&device->internal.unordered_cmd_buf_que);
+    sb_atomic_store(&device->internal.num_unordered_cmd_bufs, 0, memory_order_relaxed);
     sb_unlock_mutex(device->internal.mutex);
 
     // make sure this device is current
@@ -676,6 +811,121 @@ static void flush_device_command_buffers(render_device_t * const device) {
     RHI_TRACE_POP();
 }
 
+/*
+=======================================
+render_set_max_pending_frames
+=======================================
+*/
+
+void render_set_max_pending_frames(render_device_t * const device, const int max_pending_frames) {
+    ASSERT_IS_MAIN_THREAD();
+    const int clamped_pending_frames = clamp_int(max_pending_frames, 1, render_max_pending_frames);
+    if (clamped_pending_frames == device->internal.max_pending_frames) {
+        return;
+    }
+
+    // frame slots are indexed modulo the limit, drain them before it changes
+    for (int i = 0; i < ARRAY_SIZE(device->internal.frame_fences); ++i) {
+        render_wait_fence(device, device->internal.frame_fences[i]);
+        device->internal.frame_fences[i] = null_rb_fence;
+    }
+
+    device->internal.max_pending_frames = clamped_pending_frames;
+}
+
+/*
+=======================================
+render_get_max_pending_frames
+=======================================
+*/
+
+int render_get_max_pending_frames(const render_device_t * const device) {
+    return device->internal.max_pending_frames;
+}
+
+/*
+=======================================
+render frame metrics
+=======================================
+*/
+
+render_frame_metrics_t render_get_frame_metrics(const render_device_t * const device) {
+    render_frame_metrics_t metrics = {
+        .num_frames = device->internal.frame_timing.num_frames,
+        .max_pending_frames = device->internal.max_pending_frames,
+        .max_frame_time_ms = (float)device->internal.frame_timing.max_frame_time_ms,
+        .max_wait_time_ms = (float)device->internal.frame_timing.max_wait_time_ms};
+
+    if (metrics.num_frames > 0) {
+        const double n = (double)metrics.num_frames;
+        const double mean = device->internal.frame_timing.sum_frame_time_ms / n;
+        const double variance = (device->internal.frame_timing.sum_frame_time_sq_ms / n) - (mean * mean);
+        metrics.mean_frame_time_ms = (float)mean;
+        metrics.frame_time_stddev_ms = (variance > 0.0) ? (float)sqrt(variance) : 0.0f;
+        metrics.mean_wait_time_ms = (float)(device->internal.frame_timing.sum_wait_time_ms / n);
+    }
+
+    return metrics;
+}
+
+void render_reset_frame_metrics(render_device_t * const device) {
+    const uint64_t last_frame_time = device->internal.frame_timing.last_frame_time;
+    ZEROMEM(&device->internal.frame_timing);
+    device->internal.frame_timing.last_frame_time = last_frame_time;
+}
+
+void render_device_log_frame_metrics(render_device_t * const device, const logging_mode_e logging_mode) {
+    const render_frame_metrics_t frame_metrics = render_get_frame_metrics(device);
+
+    if (logging_mode == logging_tty || logging_mode == logging_tty_and_metrics) {
+        LOG_ALWAYS(RENDER_TAG,
+                   "Render frames:\n"
+                   "\tframes:            [%u]\n"
+                   "\tpending frames:    [%i]\n"
+                   "\tframe time:        [%.3f ms mean, %.3f ms stddev, %.3f ms max]\n"
+                   "\tframe wait:        [%.3f ms mean, %.3f ms max]",
+                   frame_metrics.num_frames,
+                   frame_metrics.max_pending_frames,
+                   frame_metrics.mean_frame_time_ms,
+                   frame_metrics.frame_time_stddev_ms,
+                   frame_metrics.max_frame_time_ms,
+                   frame_metrics.mean_wait_time_ms,
+                   frame_metrics.max_wait_time_ms);
+    }
+    if (logging_mode == logging_metrics || logging_mode == logging_tty_and_metrics) {
+        STATIC_ASSERT(sizeof(metrics_render_frame_times_t) == sizeof(render_frame_metrics_t));
+
+        metrics_render_frame_times_t frame_times_metric;
+        memcpy(&frame_times_metric, &frame_metrics, sizeof(frame_metrics));
+        publish_metric(metric_type_metrics_render_frame_times_t, &frame_times_metric, sizeof(frame_times_metric));
+    }
+
+    render_reset_frame_metrics(device);
+}
+
+static void render_track_frame_time(render_device_t * const device, const uint64_t frame_start_time, const uint64_t wait_start_time, const uint64_t wait_end_time) {
+    const double wait_time_ms = (double)(wait_end_time - wait_start_time) / 1000.0;
+    device->internal.frame_timing.sum_wait_time_ms += wait_time_ms;
+    if (wait_time_ms > device->internal.frame_timing.max_wait_time_ms) {
+        device->internal.frame_timing.max_wait_time_ms = wait_time_ms;
+    }
+
+    // frame time is measured between successive render_device_frame() calls
+    const uint64_t last_frame_time = device->internal.frame_timing.last_frame_time;
+    device->internal.frame_timing.last_frame_time = frame_start_time;
+    if (last_frame_time == 0) {
+        return;
+    }
+
+    const double frame_time_ms = (double)(frame_start_time - last_frame_time) / 1000.0;
+    ++device->internal.frame_timing.num_frames;
+    device->internal.frame_timing.sum_frame_time_ms += frame_time_ms;
+    device->internal.frame_timing.sum_frame_time_sq_ms += frame_time_ms * frame_time_ms;
+    if (frame_time_ms > device->internal.frame_timing.max_frame_time_ms) {
+        device->internal.frame_timing.max_frame_time_ms = frame_time_ms;
+    }
+}
+
 /*
 =======================================
 render_device_frame
@@ -687,11 +937,16 @@ void render_device_frame(render_device_t * const device) {
     ASSERT_IS_MAIN_THREAD();
     STATIC_ASSERT(ARRAY_SIZE(device->internal.frame_fences) == render_max_pending_frames + 1);
 
+    const uint64_t frame_start_time = adk_read_microsecond_clock().us;
+
+    // frames cycle through max_pending_frames + 1 slots, the slot after
+    // the next one holds the oldest frame still allowed to be in flight
+    const uint32_t num_frame_slots = (uint32_t)device->internal.max_pending_frames + 1;
     const uint32_t next_frame = sb_atomic_load(&device->internal.num_frames, memory_order_relaxed) + 1;
-    const uint32_t next_frame_slot = next_frame % (render_max_pending_frames + 1);
+    const uint32_t next_frame_slot = next_frame % num_frame_slots;
     ASSERT(next_frame_slot <= render_max_pending_frames);
 
-    const uint32_t tail_frame_slot = (next_frame_slot + render_max_pending_frames) % (render_max_pending_frames + 1);
+    const uint32_t tail_frame_slot = (next_frame_slot + 1) % num_frame_slots;
     ASSERT(tail_frame_slot <= render_max_pending_frames);
 
     const rb_fence_t fence = render_flush_cmd_stream(&device->default_cmd_stream, render_no_wait);
@@ -703,9 +958,12 @@ void render_device_frame(render_device_t * const device) {
     }
 
     // wait on tail frame
+    const uint64_t wait_start_time = adk_read_microsecond_clock().us;
     render_wait_fence(device, device->internal.frame_fences[tail_frame_slot]);
     device->internal.frame_fences[next_frame_slot] = fence;
 
+    render_track_frame_time(device, frame_start_time, wait_start_time, adk_read_microsecond_clock().us);
+
     sb_atomic_store(&device->internal.num_frames, (int)next_frame, memory_order_relaxed);
     RHI_TRACE_POP();
 }
@@ -776,9 +1034,11 @@ void render_wait_fence(render_device_t * const device, const rb_fence_t fence) {
         if (wrap_is_less(sb_atomic_load(&fence.cmd_buf->retire_counter, memory_order_relaxed), fence.counter)) {
             if (device->internal.num_device_threads > 0) {
                 sb_lock_mutex(device->internal.mutex);
-                while (wrap_is_less(sb_atomic_load(&fence.cmd_buf->retire_counter, memory_order_relaxed), fence.counter)) {
+                begin_wait_retired(device);
+                while (wrap_is_less(sb_atomic_load(&fence.cmd_buf->retire_counter, memory_order_seq_cst), fence.counter)) {
                     sb_wait_condition(device->internal.retired_signal, device->internal.mutex, sb_timeout_infinite);
                 }
+                end_wait_retired(device);
                 sb_unlock_mutex(device->internal.mutex);
             } else {
                 flush_device_command_buffers(device);
@@ -1374,3 +1634,35 @@ uint32_t render_cmd_stream_upload_mesh_channel_data(
 
     return hash;
 }
+
+/* streamed mesh channels */
+
+void * render_map_mesh_channel(render_device_t * const device, r_mesh_t * const mesh, const int channel_index, const char * const tag) {
+    ASSERT_IS_MAIN_THREAD();
+
+    void * mapped = NULL;
+
+    RENDER_ENSURE_WRITE_CMD_STREAM(
+        &device->default_cmd_stream,
+        render_cmd_buf_write_map_mesh_channel_indirect,
+        &mesh->mesh,
+        channel_index,
+        &mapped,
+        tag);
+
+    render_flush_cmd_stream(&device->default_cmd_stream, render_wait);
+    return mapped;
+}
+
+void render_cmd_stream_fence_mesh_stream(render_cmd_stream_t * const cmd_stream, r_mesh_t * const mesh, const int signal_slot, const int wait_slot, const char * const tag) {
+    ASSERT((signal_slot >= 0) && (signal_slot < rhi_max_mesh_stream_fences));
+    ASSERT((wait_slot >= -1) && (wait_slot < rhi_max_mesh_stream_fences));
+
+    RENDER_ENSURE_WRITE_CMD_STREAM(
+        cmd_stream,
+        render_cmd_buf_write_fence_mesh_stream_indirect,
+        &mesh->mesh,
+        signal_slot,
+        wait_slot,
+        tag);
+}
@@ -31,8 +31,12 @@ processing by the backend.
 #include "source/adk/runtime/runtime.h"
 #include "source/adk/steamboat/sb_thread.h"
 
-// the number of frames that can be queued to render before we block on the gpu
-enum { render_max_pending_frames = 1 };
+// the maximum number of frames that can be queued to render before we block on the gpu,
+// the active limit is set with render_set_max_pending_frames() and defaults to render_default_pending_frames
+enum {
+    render_max_pending_frames = 3,
+    render_default_pending_frames = 1
+};
 
 /*
 ===============================================================================
@@ -139,6 +143,21 @@ typedef struct render_device_internal_t {
     int num_device_threads;
     sb_atomic_int32_t num_frames;
     rb_fence_t frame_fences[render_max_pending_frames + 1];
+    int max_pending_frames;
+    // lock-free stack of submitted ordered command buffers, newest first
+    sb_atomic_ptr_t submitted_cmd_bufs;
+    sb_atomic_int32_t num_unordered_cmd_bufs;
+    sb_atomic_int32_t num_queue_waiters;
+    sb_atomic_int32_t num_retire_waiters;
+    struct {
+        uint64_t last_frame_time;
+        uint32_t num_frames;
+        double sum_frame_time_ms;
+        double sum_frame_time_sq_ms;
+        double max_frame_time_ms;
+        double sum_wait_time_ms;
+        double max_wait_time_ms;
+    } frame_timing;
     system_guard_page_mode_e guard_page_mode;
     bool quit;
 #ifdef GUARD_PAGE_SUPPORT
@@ -154,6 +173,17 @@ typedef struct render_memory_usage_t {
     uint64_t uniform_buffer_memory;
 } render_memory_usage_t;
 
+typedef struct render_frame_metrics_t {
+    uint32_t num_frames;
+    int32_t max_pending_frames;
+    float mean_frame_time_ms;
+    float frame_time_stddev_ms;
+    float max_frame_time_ms;
+    // time render_device_frame() spent blocked on the oldest frame in flight
+    float mean_wait_time_ms;
+    float max_wait_time_ms;
+} render_frame_metrics_t;
+
 typedef struct render_resource_tracking_t {
     bool enabled;
     render_memory_usage_t memory_usage;
@@ -213,6 +243,52 @@ Log tracked resource metrics to TTY
 
 void render_device_log_resource_tracking(const render_device_t * const render_device, const logging_mode_e logging_mode);
 
+/*
+=======================================
+render_set_max_pending_frames
+
+Sets how many frames may be in flight before render_device_frame()
+blocks on the oldest one, clamped to [1, render_max_pending_frames].
+Waits for all pending frames before changing the limit.
+Must be called from the main thread, before canvas is initialized since
+canvas sizes its vertex banks from the limit.
+=======================================
+*/
+
+void render_set_max_pending_frames(render_device_t * const device, const int max_pending_frames);
+
+/*
+=======================================
+render_get_max_pending_frames
+
+Returns the limit set with render_set_max_pending_frames().
+=======================================
+*/
+
+int render_get_max_pending_frames(const render_device_t * const device);
+
+/*
+=======================================
+render_get_frame_metrics
+
+Returns frame time and frame wait statistics gathered by
+render_device_frame() since the last call to render_reset_frame_metrics()
+=======================================
+*/
+
+render_frame_metrics_t render_get_frame_metrics(const render_device_t * const device);
+void render_reset_frame_metrics(render_device_t * const device);
+
+/*
+=======================================
+render_device_log_frame_metrics
+
+Log frame timing metrics to TTY and/or metrics and reset them
+=======================================
+*/
+
+void render_device_log_frame_metrics(render_device_t * const device, const logging_mode_e logging_mode);
+
 /*
 =======================================
 render_device_frame
@@ -606,6 +682,37 @@ uint32_t render_cmd_stream_upload_mesh_channel_data(
     const void * const data,
     const char * const tag);
 
+/*
+=======================================
+render_map_mesh_channel
+
+Returns a pointer the main thread can write the rhi_usage_stream
+channel of `mesh` through for the life of the mesh, or NULL if the
+device can't map it and the channel must be uploaded instead.
+Blocks until the render device has mapped the channel.
+
+Streamed vertices are read by the gpu straight from this memory, so
+regions of it must be fenced with render_cmd_stream_fence_mesh_stream()
+before they are rewritten. Their content is not visible to rhi command
+diffing.
+=======================================
+*/
+
+void * render_map_mesh_channel(render_device_t * const device, r_mesh_t * const mesh, const int channel_index, const char * const tag);
+
+/*
+=======================================
+render_cmd_stream_fence_mesh_stream
+
+Fences gpu reads of the stream region `signal_slot` of `mesh` issued so
+far, then makes the render device wait until the gpu is done with
+region `wait_slot` (-1 for none). Once this command's fence has passed
+the cpu may rewrite region `wait_slot`.
+=======================================
+*/
+
+void render_cmd_stream_fence_mesh_stream(render_cmd_stream_t * const cmd_stream, r_mesh_t * const mesh, const int signal_slot, const int wait_slot, const char * const tag);
+
 #ifdef __cplusplus
 }
 #endif
@@ -241,15 +241,12 @@ static const uint64_t heap_block_id_free = 0xfc1bdae0fc1bdae0ull;
 typedef struct heap_block_header_t {
     size_t id;
     const char * tag;
+    // blocks in memory-address-order (allocation order in guard page mode)
     struct heap_block_header_t * next;
-#ifdef GUARD_PAGE_SUPPORT
-    union {
-        struct heap_block_header_t * next_on_free;
-        struct heap_block_header_t * prev;
-    };
-#else
+    struct heap_block_header_t * prev;
+    // free blocks in the same size class
     struct heap_block_header_t * next_on_free;
-#endif
+    struct heap_block_header_t * prev_on_free;
     size_t size;
 #ifdef GUARD_PAGE_SUPPORT
     size_t guard_page_total_size;
@@ -273,10 +270,39 @@ typedef struct heap_metrics_t {
     uint64_t max_used_size;
 } heap_metrics_t;
 
+typedef struct heap_fragmentation_metrics_t {
+    uint64_t free_block_size;
+    uint64_t num_free_blocks;
+    uint64_t largest_free_block_size;
+    // 0 when all free space is in a single block, approaches 1 as free space is scattered into small blocks
+    float fragmentation;
+} heap_fragmentation_metrics_t;
+
+/*
+Free blocks are indexed by a two-level segregated fit table (TLSF):
+the first level splits block sizes by power of two, the second level
+linearly subdivides each power of two range. Blocks smaller than
+1 << heap_free_list_fl_index_shift are all tracked by the first row.
+*/
+
+enum {
+    heap_free_list_sl_index_count_log2 = 3,
+    heap_free_list_sl_index_count = 1 << heap_free_list_sl_index_count_log2,
+    heap_free_list_fl_index_shift = 7,
+    heap_free_list_fl_index_max = 32,
+    heap_free_list_fl_index_count = heap_free_list_fl_index_max - heap_free_list_fl_index_shift + 1
+};
+
+typedef struct heap_free_lists_t {
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[heap_free_list_fl_index_count];
+    heap_block_header_t * blocks[heap_free_list_fl_index_count][heap_free_list_sl_index_count];
+} heap_free_lists_t;
+
 typedef struct heap_t {
     char name[memory_name_tag_max_size];
     struct {
-        heap_block_header_t * free;
+        heap_free_lists_t free_lists;
         heap_block_header_t * head;
         size_t alignment;
         size_t ptr_ofs;
@@ -330,6 +356,7 @@ EXT_EXPORT void heap_debug_print_leaks(const heap_t * const heap);
 void heap_dump_usage(const heap_t * const heap);
 
 heap_metrics_t heap_get_metrics(const heap_t * const heap);
+heap_fragmentation_metrics_t heap_get_fragmentation_metrics(const heap_t * const heap);
 
 static inline void heap_enable_debug_checks(heap_t * const heap, const bool enable) {
     ASSERT(heap->internal.init);
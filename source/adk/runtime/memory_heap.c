@@ -55,67 +55,200 @@ static heap_block_header_t * heap_emplace_free_block(void * const ptr, const siz
     return block;
 }
 
-static bool heap_merge_free_blocks(heap_t * const heap, heap_block_header_t * const block) {
-    bool merged = false;
+static int heap_size_log2(const size_t size) {
+    ASSERT(size > 0);
+#if _MACHINE_SIZE == 64
+    return 63 - (int)__builtin_clzll(size);
+#else
+    return 31 - (int)__builtin_clz(size);
+#endif
+}
 
-    while (block->next != NULL) {
-        heap_block_header_t * const next = block->next;
-        ASSERT(heap_is_valid_block(next));
+typedef struct heap_free_list_index_t {
+    int fl;
+    int sl;
+} heap_free_list_index_t;
 
-        if (next != block->next_on_free) {
-            ASSERT(heap_is_used_block(next));
-            break;
-        }
+// maps a block size to the free list that holds blocks of that size
+static heap_free_list_index_t heap_free_list_index(const size_t size) {
+    const size_t small_block_size = (size_t)1 << heap_free_list_fl_index_shift;
 
-        ASSERT(next->id == heap_block_id_free);
-        block->size += next->size;
-        block->next = next->next;
-        block->next_on_free = next->next_on_free;
-        merged = true;
+    if (size < small_block_size) {
+        return (heap_free_list_index_t){
+            .fl = 0,
+            .sl = (int)(size / (small_block_size / heap_free_list_sl_index_count))};
+    }
 
-        ASSERT(heap->internal.num_free_blocks > 0);
-        --heap->internal.num_free_blocks;
-        ++heap->internal.num_merged_blocks;
+    const int fl = heap_size_log2(size);
+    if (fl >= heap_free_list_fl_index_max) {
+        // everything too large to classify shares the last list
+        return (heap_free_list_index_t){
+            .fl = heap_free_list_fl_index_count - 1,
+            .sl = heap_free_list_sl_index_count - 1};
     }
 
-    return merged;
+    return (heap_free_list_index_t){
+        .fl = fl - (heap_free_list_fl_index_shift - 1),
+        .sl = (int)(size >> (fl - heap_free_list_sl_index_count_log2)) ^ heap_free_list_sl_index_count};
 }
 
-void heap_insert_free_block(heap_t * const heap, heap_block_header_t * const free_block) {
-    heap_block_header_t * block = NULL;
-    heap_block_header_t * prev = NULL;
+// maps a requested size to the first free list whose blocks are all guaranteed to fit it
+static heap_free_list_index_t heap_free_list_search_index(const size_t size) {
+    const size_t small_block_size = (size_t)1 << heap_free_list_fl_index_shift;
 
-    free_block->id = heap_block_id_free;
+    if (size < small_block_size) {
+        // small lists are linear, round up to the next list boundary unless already on one
+        const size_t small_list_size = small_block_size / heap_free_list_sl_index_count;
+        return heap_free_list_index(size + small_list_size - 1);
+    }
+
+    const size_t round = ((size_t)1 << (heap_size_log2(size) - heap_free_list_sl_index_count_log2)) - 1;
+    if (size + round < size) {
+        return heap_free_list_index(SIZE_MAX);
+    }
+
+    return heap_free_list_index(size + round);
+}
+
+static void heap_free_list_insert(heap_t * const heap, heap_block_header_t * const block) {
+    ASSERT(block->id == heap_block_id_free);
+    heap_free_lists_t * const lists = &heap->internal.free_lists;
+    const heap_free_list_index_t index = heap_free_list_index(block->size);
+    heap_block_header_t * const head = lists->blocks[index.fl][index.sl];
+
+    block->prev_on_free = NULL;
+    block->next_on_free = head;
+    if (head) {
+        head->prev_on_free = block;
+    }
+
+    lists->blocks[index.fl][index.sl] = block;
+    lists->sl_bitmap[index.fl] |= 1u << index.sl;
+    lists->fl_bitmap |= 1u << index.fl;
+}
+
+static void heap_free_list_remove(heap_t * const heap, heap_block_header_t * const block) {
+    ASSERT(block->id == heap_block_id_free);
+    heap_free_lists_t * const lists = &heap->internal.free_lists;
 
-    // walk the free block list and find the first free block _after_ "free_block"
-    // in memory-address-order.
+    if (block->next_on_free) {
+        block->next_on_free->prev_on_free = block->prev_on_free;
+    }
 
-    for (heap_block_header_t * it = heap->internal.free; it; it = it->next_on_free) {
-        if (free_block < it) {
-            block = it;
-            break;
+    if (block->prev_on_free) {
+        block->prev_on_free->next_on_free = block->next_on_free;
+    } else {
+        const heap_free_list_index_t index = heap_free_list_index(block->size);
+        ASSERT(lists->blocks[index.fl][index.sl] == block);
+        lists->blocks[index.fl][index.sl] = block->next_on_free;
+        if (!block->next_on_free) {
+            lists->sl_bitmap[index.fl] &= ~(1u << index.sl);
+            if (!lists->sl_bitmap[index.fl]) {
+                lists->fl_bitmap &= ~(1u << index.fl);
+            }
         }
-        prev = it;
     }
 
-    // link it in.
+    block->next_on_free = NULL;
+    block->prev_on_free = NULL;
+}
 
-    free_block->next_on_free = block;
-    if (prev) {
-        // there is a block preceding the block we are linking in.
-        // link the new block in and try to merge free blocks.
-        prev->next_on_free = free_block;
-        if (prev->next == free_block) {
-            //  next block is the free block, merge has to succeed
-            VERIFY(heap_merge_free_blocks(heap, prev));
-        } else {
-            // try and merge free blocks forward
-            heap_merge_free_blocks(heap, free_block);
+static heap_block_header_t * heap_free_list_find(const heap_t * const heap, const size_t needed) {
+    const heap_free_lists_t * const lists = &heap->internal.free_lists;
+    const heap_free_list_index_t index = heap_free_list_index(needed);
+
+    // prefer reusing a block of the same size class, this keeps
+    // larger blocks intact when a hole of the right size exists.
+
+    heap_block_header_t * const head = lists->blocks[index.fl][index.sl];
+    if (head && (head->size >= needed)) {
+        return head;
+    }
+
+    // any block in a list at or above the rounded up size class fits
+
+    const heap_free_list_index_t search = heap_free_list_search_index(needed);
+
+    uint32_t sl_map = lists->sl_bitmap[search.fl] & (~0u << search.sl);
+    int fl = search.fl;
+
+    if (!sl_map) {
+        const uint32_t fl_map = (fl + 1 < heap_free_list_fl_index_count) ? (lists->fl_bitmap & (~0u << (fl + 1))) : 0;
+        if (fl_map) {
+            fl = (int)__builtin_ctz(fl_map);
+            sl_map = lists->sl_bitmap[fl];
         }
-    } else {
-        heap->internal.free = free_block;
-        heap_merge_free_blocks(heap, free_block);
     }
+
+    if (sl_map) {
+        heap_block_header_t * const block = lists->blocks[fl][__builtin_ctz(sl_map)];
+        if (block->size >= needed) {
+            return block;
+        }
+    }
+
+    // nothing in the guaranteed-fit lists: blocks in the needed size class
+    // itself may still be large enough, check those before giving up.
+
+    for (heap_block_header_t * it = head; it; it = it->next_on_free) {
+        ASSERT(it->id == heap_block_id_free);
+        if (it->size >= needed) {
+            return it;
+        }
+    }
+
+    return NULL;
+}
+
+// links block after prev in address order
+static void heap_link_block_after(heap_block_header_t * const prev, heap_block_header_t * const block) {
+    block->prev = prev;
+    block->next = prev->next;
+    if (block->next) {
+        block->next->prev = block;
+    }
+    prev->next = block;
+}
+
+// unlinks block, which must directly follow prev in address order, and gives its space to prev
+static void heap_absorb_next_block(heap_block_header_t * const prev, heap_block_header_t * const block) {
+    ASSERT(prev->next == block);
+    prev->size += block->size;
+    prev->next = block->next;
+    if (prev->next) {
+        prev->next->prev = prev;
+    }
+}
+
+static void heap_insert_free_block(heap_t * const heap, heap_block_header_t * free_block) {
+    free_block->id = heap_block_id_free;
+
+    // coalesce with free neighbors in address order, by construction
+    // there are never two adjacent free blocks so one merge in each
+    // direction is all that's needed.
+
+    heap_block_header_t * const prev = free_block->prev;
+    if (prev && heap_is_free_block(prev)) {
+        heap_free_list_remove(heap, prev);
+        heap_absorb_next_block(prev, free_block);
+        free_block = prev;
+
+        ASSERT(heap->internal.num_free_blocks > 0);
+        --heap->internal.num_free_blocks;
+        ++heap->internal.num_merged_blocks;
+    }
+
+    heap_block_header_t * const next = free_block->next;
+    if (next && heap_is_free_block(next)) {
+        heap_free_list_remove(heap, next);
+        heap_absorb_next_block(free_block, next);
+
+        ASSERT(heap->internal.num_free_blocks > 0);
+        --heap->internal.num_free_blocks;
+        ++heap->internal.num_merged_blocks;
+    }
+
+    heap_free_list_insert(heap, free_block);
 }
 
 #ifdef DEBUG_PAGE_MEMORY_SERVICES
@@ -243,8 +376,9 @@ void heap_init_with_region(heap_t * const heap, const mem_region_t region, const
 
     ASSERT(heap->internal.min_block_size <= region.size);
 
-    heap->internal.head = heap->internal.free = heap_emplace_free_block(region.ptr, region.size);
-    zero_extra_header_bytes(heap->internal.extra_header_bytes, heap->internal.free);
+    heap->internal.head = heap_emplace_free_block(region.ptr, region.size);
+    zero_extra_header_bytes(heap->internal.extra_header_bytes, heap->internal.head);
+    heap_free_list_insert(heap, heap->internal.head);
     heap->internal.num_free_blocks = 1;
     heap->internal.free_block_size = region.size;
     heap->internal.heap_size = region.size;
@@ -379,23 +513,7 @@ void * heap_unchecked_alloc(heap_t * const heap, const size_t size, const char *
     } else
 #endif
     {
-        heap_block_header_t * block = NULL;
-        heap_block_header_t * block_prev = NULL;
-
-        {
-            heap_block_header_t * prev = NULL;
-            for (heap_block_header_t * it = heap->internal.free; it; it = it->next_on_free) {
-                ASSERT(it->id == heap_block_id_free);
-
-                if (it->size >= needed) {
-                    block = it;
-                    block_prev = prev;
-                    break;
-                }
-
-                prev = it;
-            }
-        }
+        heap_block_header_t * const block = heap_free_list_find(heap, needed);
 
         if (block) {
             const uintptr_t ptr = (uintptr_t)block;
@@ -404,6 +522,8 @@ void * heap_unchecked_alloc(heap_t * const heap, const size_t size, const char *
             const size_t min_block_size = heap->internal.min_block_size;
             const size_t extra_header_bytes = heap->internal.extra_header_bytes;
 
+            heap_free_list_remove(heap, block);
+
             // if the remaining space in this free block after allocation
             // is at least as big as our minimum block size then convert
             // the remaining free space into another free block.
@@ -411,15 +531,8 @@ void * heap_unchecked_alloc(heap_t * const heap, const size_t size, const char *
             if (free_space >= min_block_size) {
                 block->size = needed;
                 heap_block_header_t * const free_block = heap_emplace_free_block((void *)end, free_space);
-                free_block->next = block->next;
-                free_block->next_on_free = block->next_on_free;
-                block->next = free_block;
-
-                if (block_prev) {
-                    block_prev->next_on_free = free_block;
-                } else {
-                    heap->internal.free = free_block;
-                }
+                heap_link_block_after(block, free_block);
+                heap_free_list_insert(heap, free_block);
 
                 copy_extra_header_bytes(extra_header_bytes, block, free_block);
                 ASSERT(heap->internal.free_block_size >= needed);
@@ -432,12 +545,6 @@ void * heap_unchecked_alloc(heap_t * const heap, const size_t size, const char *
                 --heap->internal.num_free_blocks;
                 ASSERT(heap->internal.free_block_size >= block->size);
                 heap->internal.free_block_size -= block->size;
-
-                if (block_prev) {
-                    block_prev->next_on_free = block->next_on_free;
-                } else {
-                    heap->internal.free = block->next_on_free;
-                }
             }
 
             block->id = heap_block_id_used;
@@ -598,11 +705,7 @@ void * heap_unchecked_realloc(heap_t * const heap, void * const ptr, const size_
                 // and grow it to consume the newly unused space
 
                 block->size = needed;
-
-                heap_block_header_t * prev_free = NULL;
-                for (heap_block_header_t * it = heap->internal.free; it != next_free; it = it->next_on_free) {
-                    prev_free = it;
-                }
+                heap_free_list_remove(heap, next_free);
 
                 const uintptr_t start = (uintptr_t)block;
                 const uintptr_t end = start + needed;
@@ -614,13 +717,12 @@ void * heap_unchecked_realloc(heap_t * const heap, void * const ptr, const size_
                 next_free->size += delta;
 
                 block->next = next_free;
-
-                if (prev_free) {
-                    prev_free->next_on_free = next_free;
-                } else {
-                    heap->internal.free = next_free;
+                if (next_free->next) {
+                    next_free->next->prev = next_free;
                 }
 
+                heap_free_list_insert(heap, next_free);
+
                 ASSERT(heap->internal.used_block_size >= delta);
                 heap->internal.used_block_size -= delta;
                 heap->internal.free_block_size += delta;
@@ -645,13 +747,11 @@ void * heap_unchecked_realloc(heap_t * const heap, void * const ptr, const size_
 
                     block->size = needed;
                     heap_block_header_t * const free_block = heap_emplace_free_block((void *)end, free_space);
-                    free_block->next = block->next;
-                    free_block->next_on_free = NULL;
-                    block->next = free_block;
-                    heap_insert_free_block(heap, free_block);
+                    heap_link_block_after(block, free_block);
                     zero_extra_header_bytes(extra_header_bytes, free_block);
 
                     ++heap->internal.num_free_blocks;
+                    heap_insert_free_block(heap, free_block);
                     ASSERT(heap->internal.used_block_size >= free_space);
                     heap->internal.used_block_size -= free_space;
                     heap->internal.free_block_size += free_space;
@@ -676,10 +776,7 @@ void * heap_unchecked_realloc(heap_t * const heap, void * const ptr, const size_
             // and it is large enough to consume the necessary
             // size delta
 
-            heap_block_header_t * prev_free = NULL;
-            for (heap_block_header_t * it = heap->internal.free; it != next_free; it = it->next_on_free) {
-                prev_free = it;
-            }
+            heap_free_list_remove(heap, next_free);
 
             const size_t free_space = next_free->size - delta;
 
@@ -694,13 +791,12 @@ void * heap_unchecked_realloc(heap_t * const heap, void * const ptr, const size_
                 block->next = next_free;
                 block->size += delta;
                 next_free->size = free_space;
-
-                if (prev_free) {
-                    prev_free->next_on_free = next_free;
-                } else {
-                    heap->internal.free = next_free;
+                if (next_free->next) {
+                    next_free->next->prev = next_free;
                 }
 
+                heap_free_list_insert(heap, next_free);
+
                 ASSERT(heap->internal.free_block_size >= delta);
                 heap->internal.free_block_size -= delta;
                 heap->internal.used_block_size += delta;
@@ -714,20 +810,14 @@ void * heap_unchecked_realloc(heap_t * const heap, void * const ptr, const size_
                 // this free block is totally consumed by the resize operation
                 // unlink it
 
-                if (prev_free) {
-                    prev_free->next_on_free = next_free->next_on_free;
-                } else {
-                    heap->internal.free = next_free->next_on_free;
-                }
-
-                block->next = next_free->next;
-                block->size += next_free->size;
+                const size_t consumed_size = next_free->size;
+                heap_absorb_next_block(block, next_free);
 
                 ASSERT(heap->internal.num_free_blocks > 0);
                 --heap->internal.num_free_blocks;
-                ASSERT(heap->internal.free_block_size >= next_free->size);
-                heap->internal.free_block_size -= next_free->size;
-                heap->internal.used_block_size += next_free->size;
+                ASSERT(heap->internal.free_block_size >= consumed_size);
+                heap->internal.free_block_size -= consumed_size;
+                heap->internal.used_block_size += consumed_size;
 
                 if (debug) {
                     heap_verify_ptr(heap, ptr);
@@ -812,6 +902,30 @@ void heap_walk(const heap_t * const heap, void (*const callback)(const heap_t *
     }
 }
 
+static void heap_verify_free_lists(const heap_t * const heap, const size_t num_free_blocks) {
+    const heap_free_lists_t * const lists = &heap->internal.free_lists;
+    size_t num_listed = 0;
+
+    for (int fl = 0; fl < heap_free_list_fl_index_count; ++fl) {
+        VERIFY(!!(lists->fl_bitmap & (1u << fl)) == !!lists->sl_bitmap[fl]);
+        for (int sl = 0; sl < heap_free_list_sl_index_count; ++sl) {
+            const heap_block_header_t * const head = lists->blocks[fl][sl];
+            VERIFY(!!(lists->sl_bitmap[fl] & (1u << sl)) == !!head);
+            VERIFY((head == NULL) || (head->prev_on_free == NULL));
+
+            for (const heap_block_header_t * it = head; it; it = it->next_on_free) {
+                VERIFY(heap_is_free_block(it));
+                VERIFY((it->next_on_free == NULL) || (it->next_on_free->prev_on_free == it));
+                const heap_free_list_index_t index = heap_free_list_index(it->size);
+                VERIFY_MSG((index.fl == fl) && (index.sl == sl), "Mislinked free block");
+                ++num_listed;
+            }
+        }
+    }
+
+    VERIFY(num_listed == num_free_blocks);
+}
+
 void heap_verify(const heap_t * const heap) {
     VERIFY(heap->internal.init);
 
@@ -825,37 +939,38 @@ void heap_verify(const heap_t * const heap) {
     if (guard_pages) {
         free_size = heap->internal.free_block_size;
     }
+#else
+    const bool guard_pages = false;
 #endif
 
+    VERIFY((heap->internal.head == NULL) || (heap->internal.head->prev == NULL));
+
     for (heap_block_header_t * block = heap->internal.head; block; block = block->next) {
         VERIFY(heap_is_valid_block(block));
+        VERIFY((block->next == NULL) || (block->next->prev == block));
         if (heap_is_free_block(block)) {
-#ifdef GUARD_PAGE_SUPPORT
             VERIFY(!guard_pages);
-#endif
+            // free blocks are always coalesced
+            VERIFY((block->next == NULL) || heap_is_used_block(block->next));
             ++num_free;
             free_size += block->size;
-            heap_block_header_t * search;
-            for (search = heap->internal.free; search && (search != block); search = search->next_on_free) {
-                VERIFY((search->next_on_free == NULL) || (search < search->next_on_free));
-            }
-            VERIFY_MSG(search, "Mislinked free block");
         } else {
             ++num_used;
             used_size += block->size;
         }
-#ifdef GUARD_PAGE_SUPPORT
         if (!guard_pages) {
-            VERIFY((block->next == NULL) || (block < block->next));
-            VERIFY((block->next_on_free == NULL) || (block < block->next_on_free));
+            VERIFY((block->next == NULL) || ((uintptr_t)block + block->size == (uintptr_t)block->next));
         }
-#endif
     }
 
     VERIFY(num_used == heap->internal.num_used_blocks);
     VERIFY(num_free == heap->internal.num_free_blocks);
     VERIFY(used_size == heap->internal.used_block_size);
     VERIFY(free_size == heap->internal.free_block_size);
+
+    if (!guard_pages) {
+        heap_verify_free_lists(heap, num_free);
+    }
 }
 
 void heap_verify_ptr(const heap_t * const heap, const void * const ptr) {
@@ -888,7 +1003,8 @@ void heap_debug_print_leaks(const heap_t * const heap) {
 void heap_dump_usage(const heap_t * const heap) {
     if (heap->internal.init) { // temporary fix: do not crash under wasm3
         ASSERT(heap->internal.init);
-        LOG_ALWAYS(TAG_MEMORY_HEAP, "[%s]: Heap statistics:\nheap_size: %zu\nheap_used : %zu\nheap_free: %zu\nmax_used_size: %zu\n", heap->name, heap->internal.heap_size, heap->internal.used_block_size, heap->internal.free_block_size, heap->internal.max_used_size);
+        const heap_fragmentation_metrics_t fragmentation = heap_get_fragmentation_metrics(heap);
+        LOG_ALWAYS(TAG_MEMORY_HEAP, "[%s]: Heap statistics:\nheap_size: %zu\nheap_used : %zu\nheap_free: %zu\nmax_used_size: %zu\nlargest_free_block: %zu\nfragmentation: %.3f\n", heap->name, heap->internal.heap_size, heap->internal.used_block_size, heap->internal.free_block_size, heap->internal.max_used_size, (size_t)fragmentation.largest_free_block_size, fragmentation.fragmentation);
     }
 }
 
@@ -908,3 +1024,36 @@ heap_metrics_t heap_get_metrics(const heap_t * const heap) {
         .max_used_size = heap->internal.max_used_size,
     };
 }
+
+heap_fragmentation_metrics_t heap_get_fragmentation_metrics(const heap_t * const heap) {
+    ASSERT(heap->internal.init);
+
+    size_t largest_free_block_size = 0;
+
+#ifdef GUARD_PAGE_SUPPORT
+    if (heap->internal.guard_pages) {
+        // every allocation maps its own pages, there are no free blocks to fragment
+        largest_free_block_size = heap->internal.guard_pages_max_heap_size - heap->internal.used_block_size;
+    } else
+#endif
+    {
+        // the largest block lives in the highest populated size class
+        const heap_free_lists_t * const lists = &heap->internal.free_lists;
+        if (lists->fl_bitmap) {
+            const int fl = 31 - (int)__builtin_clz(lists->fl_bitmap);
+            const int sl = 31 - (int)__builtin_clz(lists->sl_bitmap[fl]);
+            for (const heap_block_header_t * it = lists->blocks[fl][sl]; it; it = it->next_on_free) {
+                largest_free_block_size = max_size_t(largest_free_block_size, it->size);
+            }
+        }
+    }
+
+    const size_t free_block_size = heap->internal.free_block_size;
+
+    return (heap_fragmentation_metrics_t){
+        .free_block_size = free_block_size,
+        .num_free_blocks = heap->internal.num_free_blocks,
+        .largest_free_block_size = largest_free_block_size,
+        .fragmentation = free_block_size ? 1.f - (float)((double)min_size_t(largest_free_block_size, free_block_size) / (double)free_block_size) : 0.f,
+    };
+}
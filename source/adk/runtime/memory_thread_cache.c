@@ -0,0 +1,345 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+memory_thread_cache.c
+
+per-thread magazines of small blocks in front of a shared heap_t or memory_pool_t
+*/
+
+#include _PCH
+
+#include "memory_thread_cache.h"
+
+/* ===========================================================================
+ * thread slots
+ * ==========================================================================*/
+
+STATIC_ASSERT(heap_thread_cache_max_threads <= 31);
+
+static sb_atomic_int32_t heap_thread_cache_slot_mask;
+static sb_atomic_ptr_t heap_thread_cache_registry[heap_thread_cache_max_caches];
+// exiting threads flushing the cache in each registry entry, destroy waits for these before touching the cache
+static sb_atomic_int32_t heap_thread_cache_registry_flushers[heap_thread_cache_max_caches];
+
+// slot index + 1, 0 when the thread has not asked for a slot yet, -1 when none was available
+static THREAD_LOCAL int heap_thread_cache_thread_slot;
+
+static int heap_thread_cache_acquire_slot() {
+    int mask = sb_atomic_load(&heap_thread_cache_slot_mask, memory_order_relaxed);
+    for (;;) {
+        const int free_bits = ~mask & ((1 << heap_thread_cache_max_threads) - 1);
+        if (!free_bits) {
+            return -1;
+        }
+        const int slot = __builtin_ctz(free_bits);
+        const int prev = sb_atomic_cas(&heap_thread_cache_slot_mask, mask | (1 << slot), mask, memory_order_acquire);
+        if (prev == mask) {
+            return slot;
+        }
+        mask = prev;
+    }
+}
+
+static void heap_thread_cache_release_slot(const int slot) {
+    sb_atomic_fetch_and(&heap_thread_cache_slot_mask, ~(1 << slot), memory_order_release);
+}
+
+static heap_thread_cache_slot_t * heap_thread_cache_get_slot(heap_thread_cache_t * const cache) {
+    if (heap_thread_cache_thread_slot == 0) {
+        const int slot = heap_thread_cache_acquire_slot();
+        heap_thread_cache_thread_slot = (slot < 0) ? -1 : slot + 1;
+    }
+    return (heap_thread_cache_thread_slot > 0) ? &cache->internal.slots[heap_thread_cache_thread_slot - 1] : NULL;
+}
+
+/* ===========================================================================
+ * backing allocator
+ * ==========================================================================*/
+
+static void * heap_thread_cache_backing_alloc(heap_thread_cache_t * const cache, const size_t size, const char * const tag) {
+    if (cache->internal.heap) {
+        heap_t * const heap = cache->internal.heap;
+        void * const ptr = heap_unchecked_alloc(heap, size, tag);
+        heap->internal.max_used_size = max_size_t(heap->internal.max_used_size, heap->internal.used_block_size);
+        return ptr;
+    }
+    ASSERT(size <= cache->internal.pool->internal.user_size);
+    return memory_pool_unchecked_alloc(cache->internal.pool, tag);
+}
+
+static void heap_thread_cache_backing_free(heap_thread_cache_t * const cache, void * const ptr, const char * const tag) {
+    if (cache->internal.heap) {
+        heap_free(cache->internal.heap, ptr, tag);
+    } else {
+        memory_pool_free(cache->internal.pool, ptr, tag);
+    }
+}
+
+static size_t heap_thread_cache_block_size(const heap_thread_cache_t * const cache, void * const ptr) {
+    return cache->internal.heap ? heap_get_block_size(cache->internal.heap, ptr) : cache->internal.pool->internal.user_size;
+}
+
+static void heap_thread_cache_set_block_tag(heap_thread_cache_t * const cache, void * const ptr, const char * const tag) {
+    if (cache->internal.heap) {
+        heap_get_block_header(cache->internal.heap, ptr)->tag = tag;
+    } else {
+        memory_pool_get_block_header(cache->internal.pool, ptr)->tag = tag;
+    }
+}
+
+/* ===========================================================================
+ * size classes
+ * ==========================================================================*/
+
+// smallest class that satisfies `size`, -1 if the request is too large to cache
+static int heap_thread_cache_alloc_class(const heap_thread_cache_t * const cache, const size_t size) {
+    for (int i = 0; i < heap_thread_cache_num_size_classes; ++i) {
+        if (cache->internal.class_sizes[i] && (size <= cache->internal.class_sizes[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// largest class a block of `block_size` usable bytes can serve, -1 if it is too small or far too large to keep around
+static int heap_thread_cache_free_class(const heap_thread_cache_t * const cache, const size_t block_size) {
+    for (int i = heap_thread_cache_num_size_classes - 1; i >= 0; --i) {
+        const size_t class_size = cache->internal.class_sizes[i];
+        if (class_size && (block_size >= class_size)) {
+            return (block_size < class_size * 2) ? i : -1;
+        }
+    }
+    return -1;
+}
+
+/* ===========================================================================
+ * magazines
+ * ==========================================================================*/
+
+// returns up to `count` blocks from the top of the magazine, caller holds the backing allocator's lock
+static void heap_thread_cache_drain_magazine(heap_thread_cache_t * const cache, heap_thread_cache_slot_t * const slot, heap_thread_cache_magazine_t * const magazine, const int count, const char * const tag) {
+    for (int i = 0; (i < count) && (magazine->count > 0); ++i) {
+        void * const ptr = magazine->blocks[--magazine->count];
+        ASSERT(slot->stats.num_cached_blocks > 0);
+        --slot->stats.num_cached_blocks;
+        slot->stats.cached_bytes -= heap_thread_cache_block_size(cache, ptr);
+        heap_thread_cache_backing_free(cache, ptr, tag);
+    }
+}
+
+static void heap_thread_cache_flush_slot(heap_thread_cache_t * const cache, heap_thread_cache_slot_t * const slot) {
+    sb_lock_mutex(cache->internal.mutex);
+    for (int i = 0; i < heap_thread_cache_num_size_classes; ++i) {
+        heap_thread_cache_drain_magazine(cache, slot, &slot->magazines[i], heap_thread_cache_magazine_size, MALLOC_TAG);
+    }
+    sb_unlock_mutex(cache->internal.mutex);
+    ++slot->stats.flushes;
+}
+
+/* ===========================================================================
+ * heap_thread_cache_t
+ * ==========================================================================*/
+
+static void heap_thread_cache_register(heap_thread_cache_t * const cache) {
+    for (int i = 0; i < heap_thread_cache_max_caches; ++i) {
+        if (sb_atomic_cas_ptr(&heap_thread_cache_registry[i], cache, NULL, memory_order_release) == NULL) {
+            cache->internal.registry_index = i;
+            return;
+        }
+    }
+    TRAP("heap_thread_cache: too many live caches (max %i)", heap_thread_cache_max_caches);
+}
+
+static void heap_thread_cache_init(heap_thread_cache_t * const cache, heap_t * const heap, memory_pool_t * const pool, sb_mutex_t * const mutex) {
+    ZEROMEM(cache);
+    ASSERT(mutex);
+    cache->internal.heap = heap;
+    cache->internal.pool = pool;
+    cache->internal.mutex = mutex;
+
+#ifdef GUARD_PAGE_SUPPORT
+    // every block owns its own pages in guard page mode, recycling them would hide use-after-free
+    const bool guard_pages = heap ? heap->internal.guard_pages : (pool->internal.pages.ptr != NULL);
+#else
+    const bool guard_pages = false;
+#endif
+
+    if (!guard_pages) {
+        if (heap) {
+            for (int i = 0; i < heap_thread_cache_num_size_classes; ++i) {
+                cache->internal.class_sizes[i] = ALIGN_INT((size_t)heap_thread_cache_min_class_size << i, heap->internal.alignment);
+            }
+        } else {
+            // pools only ever hand out one size
+            cache->internal.class_sizes[0] = pool->internal.user_size;
+        }
+    }
+
+    heap_thread_cache_register(cache);
+    cache->internal.init = true;
+}
+
+void heap_thread_cache_init_with_heap(heap_thread_cache_t * const cache, heap_t * const heap, sb_mutex_t * const mutex) {
+    ASSERT(heap->internal.init);
+    heap_thread_cache_init(cache, heap, NULL, mutex);
+}
+
+void heap_thread_cache_init_with_pool(heap_thread_cache_t * const cache, memory_pool_t * const pool, sb_mutex_t * const mutex) {
+    ASSERT(pool->internal.init);
+    heap_thread_cache_init(cache, NULL, pool, mutex);
+}
+
+void heap_thread_cache_flush(heap_thread_cache_t * const cache) {
+    ASSERT(cache->internal.init);
+    for (int i = 0; i < heap_thread_cache_max_threads; ++i) {
+        heap_thread_cache_flush_slot(cache, &cache->internal.slots[i]);
+    }
+}
+
+void heap_thread_cache_destroy(heap_thread_cache_t * const cache) {
+    ASSERT(cache->internal.init);
+    // unregister first so no new per-thread flush picks the cache up, then wait out the ones already running:
+    // a flusher announces itself before it loads the entry, so either it sees NULL or we see its count
+    const int index = cache->internal.registry_index;
+    sb_atomic_store_ptr(&heap_thread_cache_registry[index], NULL, memory_order_seq_cst);
+    while (sb_atomic_load(&heap_thread_cache_registry_flushers[index], memory_order_seq_cst) != 0) {
+        sb_thread_sleep((milliseconds_t){0});
+    }
+
+    heap_thread_cache_flush(cache);
+    ZEROMEM(cache);
+}
+
+void heap_thread_cache_flush_current_thread() {
+    if (heap_thread_cache_thread_slot <= 0) {
+        heap_thread_cache_thread_slot = 0;
+        return;
+    }
+
+    const int slot = heap_thread_cache_thread_slot - 1;
+    for (int i = 0; i < heap_thread_cache_max_caches; ++i) {
+        sb_atomic_fetch_add(&heap_thread_cache_registry_flushers[i], 1, memory_order_seq_cst);
+        heap_thread_cache_t * const cache = sb_atomic_load_ptr(&heap_thread_cache_registry[i], memory_order_seq_cst);
+        if (cache) {
+            heap_thread_cache_flush_slot(cache, &cache->internal.slots[slot]);
+        }
+        sb_atomic_fetch_add(&heap_thread_cache_registry_flushers[i], -1, memory_order_seq_cst);
+    }
+
+    heap_thread_cache_thread_slot = 0;
+    heap_thread_cache_release_slot(slot);
+}
+
+void * heap_thread_cache_unchecked_alloc(heap_thread_cache_t * const cache, const size_t size, const char * const tag) {
+    ASSERT(cache->internal.init);
+    ASSERT(tag);
+
+    const int size_class = heap_thread_cache_alloc_class(cache, size);
+    heap_thread_cache_slot_t * const slot = (size_class >= 0) ? heap_thread_cache_get_slot(cache) : NULL;
+
+    if (!slot) {
+        sb_lock_mutex(cache->internal.mutex);
+        void * const ptr = heap_thread_cache_backing_alloc(cache, size, tag);
+        sb_unlock_mutex(cache->internal.mutex);
+        return ptr;
+    }
+
+    heap_thread_cache_magazine_t * const magazine = &slot->magazines[size_class];
+    if (magazine->count > 0) {
+        ++slot->stats.hits;
+    } else {
+        ++slot->stats.misses;
+        ++slot->stats.refills;
+
+        const size_t class_size = cache->internal.class_sizes[size_class];
+        sb_lock_mutex(cache->internal.mutex);
+        while (magazine->count < heap_thread_cache_batch_size) {
+            void * const ptr = heap_thread_cache_backing_alloc(cache, class_size, tag);
+            if (!ptr) {
+                break;
+            }
+            magazine->blocks[magazine->count++] = ptr;
+            ++slot->stats.num_cached_blocks;
+            slot->stats.cached_bytes += heap_thread_cache_block_size(cache, ptr);
+        }
+        sb_unlock_mutex(cache->internal.mutex);
+
+        if (magazine->count == 0) {
+            // the backing allocator is exhausted, give back what this thread is hoarding and try once more
+            heap_thread_cache_flush_slot(cache, slot);
+            sb_lock_mutex(cache->internal.mutex);
+            void * const ptr = heap_thread_cache_backing_alloc(cache, size, tag);
+            sb_unlock_mutex(cache->internal.mutex);
+            return ptr;
+        }
+    }
+
+    void * const ptr = magazine->blocks[--magazine->count];
+    ASSERT(slot->stats.num_cached_blocks > 0);
+    --slot->stats.num_cached_blocks;
+    slot->stats.cached_bytes -= heap_thread_cache_block_size(cache, ptr);
+    heap_thread_cache_set_block_tag(cache, ptr, tag);
+    return ptr;
+}
+
+void heap_thread_cache_free(heap_thread_cache_t * const cache, void * const ptr, const char * const tag) {
+    ASSERT(cache->internal.init);
+    ASSERT_MSG(ptr, "tried to free NULL ptr (%s)", tag);
+
+    const size_t block_size = heap_thread_cache_block_size(cache, ptr);
+    const int size_class = heap_thread_cache_free_class(cache, block_size);
+    heap_thread_cache_slot_t * const slot = (size_class >= 0) ? heap_thread_cache_get_slot(cache) : NULL;
+
+    if (!slot) {
+        sb_lock_mutex(cache->internal.mutex);
+        heap_thread_cache_backing_free(cache, ptr, tag);
+        sb_unlock_mutex(cache->internal.mutex);
+        return;
+    }
+
+    heap_thread_cache_magazine_t * const magazine = &slot->magazines[size_class];
+    if (magazine->count == heap_thread_cache_magazine_size) {
+        sb_lock_mutex(cache->internal.mutex);
+        heap_thread_cache_drain_magazine(cache, slot, magazine, heap_thread_cache_batch_size, tag);
+        sb_unlock_mutex(cache->internal.mutex);
+        ++slot->stats.flushes;
+    }
+
+    heap_thread_cache_set_block_tag(cache, ptr, tag);
+    magazine->blocks[magazine->count++] = ptr;
+    ++slot->stats.num_cached_blocks;
+    slot->stats.cached_bytes += block_size;
+}
+
+heap_thread_cache_metrics_t heap_thread_cache_get_metrics(const heap_thread_cache_t * const cache) {
+    heap_thread_cache_metrics_t metrics = {0};
+    if (!cache->internal.init) {
+        return metrics;
+    }
+
+    for (int i = 0; i < heap_thread_cache_max_threads; ++i) {
+        const heap_thread_cache_stats_t stats = cache->internal.slots[i].stats;
+        metrics.threads[i] = stats;
+        metrics.total.hits += stats.hits;
+        metrics.total.misses += stats.misses;
+        metrics.total.refills += stats.refills;
+        metrics.total.flushes += stats.flushes;
+        metrics.total.num_cached_blocks += stats.num_cached_blocks;
+        metrics.total.cached_bytes += stats.cached_bytes;
+    }
+    return metrics;
+}
+
+heap_thread_cache_metrics_t heap_get_thread_cache_metrics(const heap_t * const heap) {
+    for (int i = 0; i < heap_thread_cache_max_caches; ++i) {
+        const heap_thread_cache_t * const cache = sb_atomic_load_ptr(&heap_thread_cache_registry[i], memory_order_acquire);
+        if (cache && (cache->internal.heap == heap)) {
+            return heap_thread_cache_get_metrics(cache);
+        }
+    }
+    return (heap_thread_cache_metrics_t){0};
+}
@@ -0,0 +1,118 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+memory_thread_cache.h
+
+per-thread magazines of small blocks in front of a shared heap_t or memory_pool_t
+*/
+
+#pragma once
+
+#include "memory.h"
+#include "source/adk/steamboat/sb_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+===============================================================================
+heap_thread_cache_t
+
+Each thread that touches a cache is assigned a process wide slot on first use.
+Small allocations are served from (and small frees returned to) that slot's
+magazines without taking the backing allocator's mutex; empty or full
+magazines are refilled/drained in batches under a single lock.
+
+Blocks sitting in a magazine are still accounted as used by the backing
+allocator, flush them (heap_thread_cache_flush) before leak checks.
+
+Threads must call heap_thread_cache_flush_current_thread() before exiting to
+return their blocks and release their slot (thread_pool workers do this on
+thread_pool_shutdown). Threads that could not get a slot bypass the cache.
+===============================================================================
+*/
+
+enum {
+    heap_thread_cache_max_threads = 16,
+    heap_thread_cache_max_caches = 16,
+    heap_thread_cache_num_size_classes = 4,
+    heap_thread_cache_min_class_size = 32,
+    heap_thread_cache_magazine_size = 16,
+    heap_thread_cache_batch_size = heap_thread_cache_magazine_size / 2
+};
+
+typedef struct heap_thread_cache_stats_t {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t refills;
+    uint32_t flushes;
+    uint32_t num_cached_blocks;
+    size_t cached_bytes;
+} heap_thread_cache_stats_t;
+
+typedef struct heap_thread_cache_metrics_t {
+    heap_thread_cache_stats_t threads[heap_thread_cache_max_threads];
+    heap_thread_cache_stats_t total;
+} heap_thread_cache_metrics_t;
+
+typedef struct heap_thread_cache_magazine_t {
+    void * blocks[heap_thread_cache_magazine_size];
+    int count;
+} heap_thread_cache_magazine_t;
+
+typedef struct heap_thread_cache_slot_t {
+    heap_thread_cache_magazine_t magazines[heap_thread_cache_num_size_classes];
+    heap_thread_cache_stats_t stats;
+} heap_thread_cache_slot_t;
+
+typedef struct heap_thread_cache_t {
+    struct {
+        heap_t * heap;
+        memory_pool_t * pool;
+        sb_mutex_t * mutex;
+        size_t class_sizes[heap_thread_cache_num_size_classes];
+        heap_thread_cache_slot_t slots[heap_thread_cache_max_threads];
+        int registry_index;
+        bool init;
+    } internal;
+} heap_thread_cache_t;
+
+// `mutex` is the lock callers already hold around the backing allocator, it is taken for batch refills/returns.
+void heap_thread_cache_init_with_heap(heap_thread_cache_t * const cache, heap_t * const heap, sb_mutex_t * const mutex);
+void heap_thread_cache_init_with_pool(heap_thread_cache_t * const cache, memory_pool_t * const pool, sb_mutex_t * const mutex);
+
+// returns every cached block to the backing allocator, all threads using the cache must be idle
+// (threads exiting through heap_thread_cache_flush_current_thread may race it, it waits for their flush)
+void heap_thread_cache_destroy(heap_thread_cache_t * const cache);
+void heap_thread_cache_flush(heap_thread_cache_t * const cache);
+
+// flushes the calling thread's magazines in every live cache and releases its slot
+void heap_thread_cache_flush_current_thread();
+
+void * heap_thread_cache_unchecked_alloc(heap_thread_cache_t * const cache, const size_t size, const char * const tag);
+void heap_thread_cache_free(heap_thread_cache_t * const cache, void * const ptr, const char * const tag);
+
+// statistics are sampled without synchronizing against the owning threads
+heap_thread_cache_metrics_t heap_thread_cache_get_metrics(const heap_thread_cache_t * const cache);
+heap_thread_cache_metrics_t heap_get_thread_cache_metrics(const heap_t * const heap);
+
+static inline void * heap_thread_cache_alloc(heap_thread_cache_t * const cache, const size_t size, const char * const tag) {
+    void * const p = heap_thread_cache_unchecked_alloc(cache, size, tag);
+    TRAP_OUT_OF_MEMORY(p);
+    return p;
+}
+
+static inline void * heap_thread_cache_calloc(heap_thread_cache_t * const cache, const size_t size, const char * const tag) {
+    void * const p = heap_thread_cache_alloc(cache, size, tag);
+    memset(p, 0, size);
+    return p;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -20,10 +20,39 @@ support for capturing, comparing, saving, and loading screenshots
 #include "source/adk/app_thunk/app_thunk.h"
 #include "source/adk/log/log.h"
 #include "source/adk/renderer/renderer.h"
+#include "source/adk/runtime/thread_pool.h"
 #include "stb/stb_image_write.h"
 
 #define SCREENSHOT_TAG FOURCC('S', 'C', 'R', 'N')
 
+enum {
+    // frames that can be read back or encoded at the same time during continuous capture
+    continuous_capture_num_slots = 4
+};
+
+typedef struct continuous_capture_slot_t {
+    image_t image;
+    mem_region_t region;
+    uint32_t frame;
+    // owned by the capture from the readback request until the encode job completed
+    bool busy;
+} continuous_capture_slot_t;
+
+static struct {
+    struct {
+        adk_continuous_capture_options_t options;
+        char path_prefix[sb_max_path_length];
+        continuous_capture_slot_t slots[continuous_capture_num_slots];
+        size_t frame_size;
+        uint32_t frame_counter;
+        adk_continuous_capture_stats_t stats;
+        // raw stream, shared by the encode jobs
+        sb_file_t * raw_file;
+        sb_mutex_t * raw_file_mutex;
+        bool running;
+    } capture;
+} statics;
+
 typedef struct stb_image_write_mem_user_t {
     mem_region_t region;
     size_t offset;
@@ -95,6 +124,19 @@ void adk_take_screenshot(image_t * const out_screenshot, const mem_region_t scre
         MALLOC_TAG);
 }
 
+void adk_take_screenshot_async(image_t * const out_screenshot, const mem_region_t screenshot_mem_region, const rhi_screenshot_callback_t callback, void * const user) {
+    ASSERT(screenshot_mem_region.size >= (size_t)adk_get_screenshot_required_memory());
+
+    RENDER_ENSURE_WRITE_CMD_STREAM(
+        &the_app.render_device->default_cmd_stream,
+        render_cmd_buf_screenshot_async,
+        out_screenshot,
+        screenshot_mem_region,
+        callback,
+        user,
+        MALLOC_TAG);
+}
+
 void adk_take_screenshot_flush(image_t * const out_screenshot, const mem_region_t screenshot_mem_region) {
     adk_take_screenshot(out_screenshot, screenshot_mem_region);
 
@@ -292,3 +334,162 @@ void adk_screenshot_dump_deltas(adk_screenshot_t * const testcase_screenshot, ad
     image_save_as_type(directory, failure_filename, testcase, file_type);
     image_save_as_type(directory, delta_filename, baseline, file_type);
 }
+
+/*
+===============================================================================
+Continuous capture
+===============================================================================
+*/
+
+static void continuous_capture_encode_job(void * const user, thread_pool_t * const pool) {
+    const continuous_capture_slot_t * const slot = user;
+    const adk_continuous_capture_options_t * const options = &statics.capture.options;
+
+    if (options->format == adk_capture_format_raw) {
+        const adk_capture_raw_frame_header_t header = {
+            .magic = ADK_CAPTURE_RAW_FRAME_MAGIC,
+            .frame = slot->frame,
+            .width = (uint32_t)slot->image.width,
+            .height = (uint32_t)slot->image.height,
+            .pitch = (uint32_t)slot->image.pitch};
+
+        // frames may finish encoding out of order on a multi-threaded pool, readers go by `header.frame`
+        sb_lock_mutex(statics.capture.raw_file_mutex);
+        sb_fwrite(&header, sizeof(header), 1, statics.capture.raw_file);
+        sb_fwrite(slot->image.data, (size_t)slot->image.data_len, 1, statics.capture.raw_file);
+        sb_unlock_mutex(statics.capture.raw_file_mutex);
+    } else {
+        const bool is_png = options->format == adk_capture_format_png;
+        char filename[sb_max_path_length];
+        sprintf_s(filename, ARRAY_SIZE(filename), "%s_%06u%s", statics.capture.path_prefix, slot->frame, is_png ? ".png" : ".tga");
+        if (!image_save_as_type(options->directory, filename, &slot->image, is_png ? image_save_png : image_save_tga)) {
+            LOG_WARN(SCREENSHOT_TAG, "Failed to write captured frame [%s]", filename);
+        }
+    }
+}
+
+static void continuous_capture_encode_complete(void * const user, thread_pool_t * const pool) {
+    continuous_capture_slot_t * const slot = user;
+    slot->busy = false;
+}
+
+// Runs on the render thread, hands the frame to the thread pool so neither the render nor the main thread encode it.
+static void continuous_capture_readback_complete(void * const user, image_t * const image) {
+    thread_pool_enqueue(&the_app.default_thread_pool, continuous_capture_encode_job, continuous_capture_encode_complete, user);
+}
+
+void adk_start_continuous_capture(const adk_continuous_capture_options_t * const options) {
+    ASSERT(!statics.capture.running);
+    ASSERT(options->frame_interval > 0);
+    ASSERT(options->path_prefix);
+
+    ZEROMEM(&statics.capture);
+    statics.capture.options = *options;
+    strcpy_s(statics.capture.path_prefix, ARRAY_SIZE(statics.capture.path_prefix), options->path_prefix);
+    statics.capture.options.path_prefix = statics.capture.path_prefix;
+    statics.capture.frame_size = adk_get_screenshot_required_memory();
+
+    for (int i = 0; i < continuous_capture_num_slots; ++i) {
+        continuous_capture_slot_t * const slot = &statics.capture.slots[i];
+        slot->region = MEM_REGION(.ptr = ffi_screenshot_alloc(statics.capture.frame_size), .size = statics.capture.frame_size);
+        VERIFY(slot->region.ptr);
+    }
+
+    if (options->format == adk_capture_format_raw) {
+        char filename[sb_max_path_length];
+        sprintf_s(filename, ARRAY_SIZE(filename), "%s.raw", statics.capture.path_prefix);
+        statics.capture.raw_file = sb_fopen(options->directory, filename, "wb");
+        VERIFY_MSG(statics.capture.raw_file, "Could not open capture stream at:\n%s\nnote: directory: [%i]", filename, options->directory);
+        statics.capture.raw_file_mutex = sb_create_mutex(MALLOC_TAG);
+    }
+
+    statics.capture.running = true;
+    LOG_ALWAYS(SCREENSHOT_TAG, "Continuous capture started: every [%u] frames to [%s]", options->frame_interval, statics.capture.path_prefix);
+}
+
+static bool continuous_capture_has_busy_slots() {
+    for (int i = 0; i < continuous_capture_num_slots; ++i) {
+        if (statics.capture.slots[i].busy) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void adk_stop_continuous_capture() {
+    if (!statics.capture.running) {
+        return;
+    }
+
+    // complete outstanding readbacks, their encode jobs are queued once the render thread ran the poll
+    RENDER_ENSURE_WRITE_CMD_STREAM(
+        &the_app.render_device->default_cmd_stream,
+        render_cmd_buf_poll_screenshots,
+        true,
+        MALLOC_TAG);
+    render_flush_cmd_stream(&the_app.render_device->default_cmd_stream, render_wait);
+
+    while (continuous_capture_has_busy_slots()) {
+        thread_pool_run_completion_callbacks(&the_app.default_thread_pool);
+        sb_thread_sleep((milliseconds_t){1});
+    }
+
+    if (statics.capture.raw_file) {
+        sb_fclose(statics.capture.raw_file);
+        sb_destroy_mutex(statics.capture.raw_file_mutex, MALLOC_TAG);
+        statics.capture.raw_file = NULL;
+        statics.capture.raw_file_mutex = NULL;
+    }
+
+    for (int i = 0; i < continuous_capture_num_slots; ++i) {
+        ffi_screenshot_free(statics.capture.slots[i].region.ptr);
+        statics.capture.slots[i].region = (mem_region_t){0};
+    }
+
+    statics.capture.running = false;
+    LOG_ALWAYS(SCREENSHOT_TAG, "Continuous capture stopped: captured [%u] frames, dropped [%u] frames", statics.capture.stats.frames_captured, statics.capture.stats.frames_dropped);
+}
+
+bool adk_is_continuous_capture_running() {
+    return statics.capture.running;
+}
+
+adk_continuous_capture_stats_t adk_get_continuous_capture_stats() {
+    return statics.capture.stats;
+}
+
+void adk_continuous_capture_tick() {
+    if (!statics.capture.running) {
+        return;
+    }
+
+    const uint32_t frame = statics.capture.frame_counter++;
+    continuous_capture_slot_t * free_slot = NULL;
+    bool has_busy_slots = false;
+    for (int i = 0; i < continuous_capture_num_slots; ++i) {
+        continuous_capture_slot_t * const slot = &statics.capture.slots[i];
+        if (slot->busy) {
+            has_busy_slots = true;
+        } else if (!free_slot) {
+            free_slot = slot;
+        }
+    }
+
+    if ((frame % statics.capture.options.frame_interval) == 0) {
+        if (free_slot && (adk_get_screenshot_required_memory() <= statics.capture.frame_size)) {
+            free_slot->busy = true;
+            free_slot->frame = frame;
+            ++statics.capture.stats.frames_captured;
+            adk_take_screenshot_async(&free_slot->image, free_slot->region, continuous_capture_readback_complete, free_slot);
+        } else {
+            ++statics.capture.stats.frames_dropped;
+        }
+    } else if (has_busy_slots) {
+        // readbacks also complete on present, this covers frames that skip presenting
+        RENDER_ENSURE_WRITE_CMD_STREAM(
+            &the_app.render_device->default_cmd_stream,
+            render_cmd_buf_poll_screenshots,
+            false,
+            MALLOC_TAG);
+    }
+}
@@ -16,6 +16,7 @@
 
 #include "source/adk/log/log.h"
 #include "source/adk/runtime/memory.h"
+#include "source/adk/runtime/memory_thread_cache.h"
 #include "source/adk/runtime/runtime.h"
 #include "source/adk/steamboat/sb_thread.h"
 
@@ -36,6 +37,18 @@ typedef union job_callback_t {
     thread_pool_ext_call_fn_t ext;
 } job_callback_t;
 
+typedef enum job_state_e {
+    job_state_free,
+    // waiting on prerequisites
+    job_state_parked,
+    // in a shared queue lane
+    job_state_queued,
+    // in a worker deque or running
+    job_state_taken,
+    // job callback returned, completion call may still be pending
+    job_state_finished,
+} job_state_e;
+
 struct job_t {
     job_callback_t job;
     thread_pool_call_fn_t completion_call;
@@ -43,50 +56,106 @@ struct job_t {
     struct job_t * next;
     job_timings_t job_timings;
     int id;
+    thread_pool_priority_e priority;
+    job_state_e state;
+    sb_atomic_int32_t cancelled;
+    // the fields below are guarded by the pool's `mutex`
+    int num_pending_prerequisites;
+    int num_dependents;
+    struct job_t * dependents[thread_pool_max_dependents];
 };
 
-static void thread_pool_enqueue_impl(thread_pool_t * const pool, const job_callback_t new_job, const thread_pool_call_fn_t completion_call, void * const user) {
-    const microseconds_t enque_timestamp = adk_read_microsecond_clock();
+// the worker running on the calling thread, NULL outside of pool threads
+static THREAD_LOCAL thread_pool_worker_t * thread_pool_current_worker;
 
-    sb_lock_mutex(pool->mutex);
-    job_t * const job = pool->free_head;
-    if (!job) {
-        sb_unlock_mutex(pool->mutex);
-        TRAP("Thread pool exhausted max queued jobs limit: [%i]", pool->max_pending_jobs);
+/* ===========================================================================
+ * Chase-Lev deque
+ *
+ * Fixed capacity, indices are free running and compared by difference so
+ * they may wrap.
+ * ==========================================================================*/
+
+static int thread_pool_deque_size(thread_pool_deque_t * const deque) {
+    const uint32_t bottom = (uint32_t)sb_atomic_load(&deque->bottom, memory_order_relaxed);
+    const uint32_t top = (uint32_t)sb_atomic_load(&deque->top, memory_order_relaxed);
+    return (int32_t)(bottom - top);
+}
+
+// owner only
+static bool thread_pool_deque_push(thread_pool_deque_t * const deque, job_t * const job) {
+    const uint32_t bottom = (uint32_t)sb_atomic_load(&deque->bottom, memory_order_relaxed);
+    const uint32_t top = (uint32_t)sb_atomic_load(&deque->top, memory_order_acquire);
+    if ((int32_t)(bottom - top) >= thread_pool_deque_capacity) {
+        return false;
     }
+    sb_atomic_store_ptr(&deque->jobs[bottom & (thread_pool_deque_capacity - 1)], job, memory_order_relaxed);
+    sb_atomic_thread_fence(memory_order_release);
+    sb_atomic_store(&deque->bottom, (int32_t)(bottom + 1), memory_order_relaxed);
+    return true;
+}
 
-    pool->free_head = pool->free_head->next;
-    if (pool->free_head == NULL) {
-        pool->free_tail = NULL;
+// owner only
+static job_t * thread_pool_deque_take(thread_pool_deque_t * const deque) {
+    const uint32_t bottom = (uint32_t)sb_atomic_load(&deque->bottom, memory_order_relaxed) - 1;
+    sb_atomic_store(&deque->bottom, (int32_t)bottom, memory_order_relaxed);
+    sb_atomic_thread_fence(memory_order_seq_cst);
+    const uint32_t top = (uint32_t)sb_atomic_load(&deque->top, memory_order_relaxed);
+
+    if ((int32_t)(bottom - top) < 0) {
+        // empty
+        sb_atomic_store(&deque->bottom, (int32_t)(bottom + 1), memory_order_relaxed);
+        return NULL;
     }
-    job->next = NULL;
 
-    if (pool->queued_tail == NULL) {
-        pool->queued_head = pool->queued_tail = job;
-    } else {
-        pool->queued_tail->next = job;
-        pool->queued_tail = job;
+    job_t * job = sb_atomic_load_ptr(&deque->jobs[bottom & (thread_pool_deque_capacity - 1)], memory_order_relaxed);
+    if (bottom == top) {
+        // last job, race any thieves for it
+        if ((uint32_t)sb_atomic_cas(&deque->top, (int32_t)(top + 1), (int32_t)top, memory_order_seq_cst) != top) {
+            job = NULL;
+        }
+        sb_atomic_store(&deque->bottom, (int32_t)(bottom + 1), memory_order_relaxed);
     }
+    return job;
+}
 
-    job->job_timings.enqueue_timestamp = enque_timestamp;
-    job->job = new_job;
-    job->completion_call = completion_call;
-    job->user = user;
-    job->id = pool->job_id_counter++;
+// any thread, returns NULL when the deque is empty or another thread won the race
+static job_t * thread_pool_deque_steal(thread_pool_deque_t * const deque) {
+    const uint32_t top = (uint32_t)sb_atomic_load(&deque->top, memory_order_acquire);
+    sb_atomic_thread_fence(memory_order_seq_cst);
+    const uint32_t bottom = (uint32_t)sb_atomic_load(&deque->bottom, memory_order_acquire);
 
-    sb_unlock_mutex(pool->mutex);
-    sb_condition_wake_one(pool->cv);
+    if ((int32_t)(bottom - top) <= 0) {
+        return NULL;
+    }
+
+    job_t * const job = sb_atomic_load_ptr(&deque->jobs[top & (thread_pool_deque_capacity - 1)], memory_order_relaxed);
+    if ((uint32_t)sb_atomic_cas(&deque->top, (int32_t)(top + 1), (int32_t)top, memory_order_seq_cst) != top) {
+        return NULL;
+    }
+    return job;
 }
 
-void thread_pool_enqueue(thread_pool_t * const pool, const thread_pool_call_fn_t new_job, const thread_pool_call_fn_t completion_call, void * const user) {
-    job_callback_t job_callback = {.std = new_job};
-    thread_pool_enqueue_impl(pool, job_callback, completion_call, user);
+/* ===========================================================================
+ * enqueue
+ * ==========================================================================*/
+
+static void thread_pool_update_queue_depth(thread_pool_worker_t * const worker) {
+    worker->stats.queue_depth = thread_pool_deque_size(&worker->deque);
+    worker->stats.max_queue_depth = max_int(worker->stats.max_queue_depth, worker->stats.queue_depth);
 }
 
-void thread_pool_enqueue_front(thread_pool_t * const pool, const thread_pool_call_fn_t new_job, const thread_pool_call_fn_t completion_call, void * const user) {
-    const microseconds_t enque_timestamp = adk_read_microsecond_clock();
+// wakes a sleeping worker after a job was made visible outside of `mutex`
+static void thread_pool_wake_sleeper(thread_pool_t * const pool) {
+    if (sb_atomic_load(&pool->num_sleepers, memory_order_seq_cst) > 0) {
+        // sleepers re-check for work while holding the mutex, taking it here means the wake can't be missed
+        sb_lock_mutex(pool->mutex);
+        sb_unlock_mutex(pool->mutex);
+        sb_condition_wake_one(pool->cv);
+    }
+}
 
-    sb_lock_mutex(pool->mutex);
+// caller holds `mutex`
+static job_t * thread_pool_alloc_job(thread_pool_t * const pool, const job_callback_t new_job, const thread_pool_call_fn_t completion_call, void * const user, const thread_pool_priority_e priority) {
     job_t * const job = pool->free_head;
     if (!job) {
         sb_unlock_mutex(pool->mutex);
@@ -97,24 +166,127 @@ void thread_pool_enqueue_front(thread_pool_t * const pool, const thread_pool_cal
     if (pool->free_head == NULL) {
         pool->free_tail = NULL;
     }
+    // the job region isn't cleared on init
+    ZEROMEM(job);
+
+    job->job = new_job;
+    job->completion_call = completion_call;
+    job->user = user;
+    job->priority = priority;
+    // 0 is reserved so a zeroed handle never matches a job
+    if (++pool->job_id_counter == 0) {
+        ++pool->job_id_counter;
+    }
+    job->id = pool->job_id_counter;
+    return job;
+}
 
-    job->next = pool->queued_head;
-    pool->queued_head = job;
+// caller holds `mutex`
+static void thread_pool_release_job(thread_pool_t * const pool, job_t * const job) {
+    ZEROMEM(job);
+    if (pool->free_tail == NULL) {
+        pool->free_head = pool->free_tail = job;
+    } else {
+        pool->free_tail->next = job;
+        pool->free_tail = job;
+    }
+}
 
-    if (pool->queued_tail == NULL) {
-        pool->queued_tail = job;
+// pushes `job` on its priority lane of the shared queue, caller holds `mutex`
+static void thread_pool_queue_job(thread_pool_t * const pool, job_t * const job, const bool front) {
+    const int lane = job->priority;
+    job->state = job_state_queued;
+    if (front) {
+        job->next = pool->queued_head[lane];
+        pool->queued_head[lane] = job;
+        if (pool->queued_tail[lane] == NULL) {
+            pool->queued_tail[lane] = job;
+        }
+    } else {
+        job->next = NULL;
+        if (pool->queued_tail[lane] == NULL) {
+            pool->queued_head[lane] = pool->queued_tail[lane] = job;
+        } else {
+            pool->queued_tail[lane]->next = job;
+            pool->queued_tail[lane] = job;
+        }
+    }
+    if (lane == thread_pool_priority_high) {
+        sb_atomic_fetch_add(&pool->num_queued_high, 1, memory_order_release);
     }
+}
 
+// removes a queued `job` from its lane, caller holds `mutex`
+static void thread_pool_unqueue_job(thread_pool_t * const pool, job_t * const job) {
+    const int lane = job->priority;
+    job_t * prev = NULL;
+    for (job_t * curr = pool->queued_head[lane]; curr != job; curr = curr->next) {
+        ASSERT(curr);
+        prev = curr;
+    }
+    if (prev) {
+        prev->next = job->next;
+    } else {
+        pool->queued_head[lane] = job->next;
+    }
+    if (pool->queued_tail[lane] == job) {
+        pool->queued_tail[lane] = prev;
+    }
+    job->next = NULL;
+    if (lane == thread_pool_priority_high) {
+        sb_atomic_fetch_add(&pool->num_queued_high, -1, memory_order_relaxed);
+    }
+}
+
+// caller holds `mutex`
+static bool thread_pool_has_queued_jobs(const thread_pool_t * const pool) {
+    for (int i = 0; i < thread_pool_num_priorities; ++i) {
+        if (pool->queued_head[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void thread_pool_enqueue_impl(thread_pool_t * const pool, const job_callback_t new_job, const thread_pool_call_fn_t completion_call, void * const user, const bool front) {
+    const microseconds_t enque_timestamp = adk_read_microsecond_clock();
+
+    sb_lock_mutex(pool->mutex);
+    job_t * const job = thread_pool_alloc_job(pool, new_job, completion_call, user, front ? thread_pool_priority_high : thread_pool_priority_normal);
     job->job_timings.enqueue_timestamp = enque_timestamp;
-    job->job.std = new_job;
-    job->completion_call = completion_call;
-    job->user = user;
-    job->id = pool->job_id_counter++;
+
+    thread_pool_worker_t * const worker = thread_pool_current_worker;
+    if (front && worker && (worker->pool == pool)) {
+        // a worker's own front jobs run next on that worker, the others can still steal them
+        job->state = job_state_taken;
+        sb_unlock_mutex(pool->mutex);
+        sb_atomic_fetch_add(&pool->num_stealable, 1, memory_order_seq_cst);
+        if (thread_pool_deque_push(&worker->deque, job)) {
+            thread_pool_update_queue_depth(worker);
+            thread_pool_wake_sleeper(pool);
+            return;
+        }
+        // deque is full, fall back to the front of the shared queue
+        sb_atomic_fetch_add(&pool->num_stealable, -1, memory_order_seq_cst);
+        sb_lock_mutex(pool->mutex);
+    }
+
+    thread_pool_queue_job(pool, job, front);
 
     sb_unlock_mutex(pool->mutex);
     sb_condition_wake_one(pool->cv);
 }
 
+void thread_pool_enqueue(thread_pool_t * const pool, const thread_pool_call_fn_t new_job, const thread_pool_call_fn_t completion_call, void * const user) {
+    job_callback_t job_callback = {.std = new_job};
+    thread_pool_enqueue_impl(pool, job_callback, completion_call, user, false);
+}
+
+void thread_pool_enqueue_front(thread_pool_t * const pool, const thread_pool_call_fn_t new_job, const thread_pool_call_fn_t completion_call, void * const user) {
+    job_callback_t job_callback = {.std = new_job};
+    thread_pool_enqueue_impl(pool, job_callback, completion_call, user, true);
+}
+
 // No-op completion call to signify an extended job
 static void ext_completion_placeholder(void * const user, thread_pool_t * const pool) {
     (void)user;
@@ -123,7 +295,7 @@ static void ext_completion_placeholder(void * const user, thread_pool_t * const
 
 void thread_pool_enqueue_ext_job(thread_pool_t * const pool, const thread_pool_ext_call_fn_t new_job, void * const user) {
     job_callback_t new_callback = {.ext = new_job};
-    thread_pool_enqueue_impl(pool, new_callback, ext_completion_placeholder, user);
+    thread_pool_enqueue_impl(pool, new_callback, ext_completion_placeholder, user, false);
 }
 
 // The opaque one-time job token points to the currently executing job
@@ -154,64 +326,343 @@ void thread_pool_enqueue_completion(thread_pool_t * const pool, const thread_poo
     sb_unlock_mutex(pool->mutex);
 }
 
+/* ===========================================================================
+ * job handles
+ * ==========================================================================*/
+
+// caller holds `mutex`
+static bool thread_pool_is_live_handle(const thread_pool_job_handle_t handle) {
+    return handle.job && (handle.id != 0) && (handle.job->id == handle.id);
+}
+
+thread_pool_job_handle_t thread_pool_submit(thread_pool_t * const pool, const thread_pool_job_desc_t * const desc) {
+    ASSERT(desc->job);
+    ASSERT((desc->priority >= 0) && (desc->priority < thread_pool_num_priorities));
+    ASSERT((desc->num_prerequisites == 0) || desc->prerequisites);
+
+    const microseconds_t enque_timestamp = adk_read_microsecond_clock();
+    const job_callback_t job_callback = {.std = desc->job};
+
+    sb_lock_mutex(pool->mutex);
+    job_t * const job = thread_pool_alloc_job(pool, job_callback, desc->completion_call, desc->user, desc->priority);
+    job->job_timings.enqueue_timestamp = enque_timestamp;
+
+    for (int i = 0; i < desc->num_prerequisites; ++i) {
+        const thread_pool_job_handle_t prerequisite = desc->prerequisites[i];
+        if (!thread_pool_is_live_handle(prerequisite) || (prerequisite.job->state == job_state_finished)) {
+            continue;
+        }
+        job_t * const parent = prerequisite.job;
+        if (parent->num_dependents >= thread_pool_max_dependents) {
+            sb_unlock_mutex(pool->mutex);
+            TRAP("Thread pool job exceeded max dependents limit: [%i]", thread_pool_max_dependents);
+        }
+        parent->dependents[parent->num_dependents++] = job;
+        ++job->num_pending_prerequisites;
+    }
+
+    const thread_pool_job_handle_t handle = {.job = job, .id = job->id};
+    if (job->num_pending_prerequisites > 0) {
+        job->state = job_state_parked;
+        ++pool->num_parked;
+        sb_unlock_mutex(pool->mutex);
+    } else {
+        thread_pool_queue_job(pool, job, false);
+        sb_unlock_mutex(pool->mutex);
+        sb_condition_wake_one(pool->cv);
+    }
+
+    return handle;
+}
+
+void thread_pool_cancel(thread_pool_t * const pool, const thread_pool_job_handle_t handle) {
+    sb_lock_mutex(pool->mutex);
+    if (thread_pool_is_live_handle(handle)) {
+        job_t * const job = handle.job;
+        sb_atomic_store(&job->cancelled, 1, memory_order_release);
+        if ((job->state == job_state_queued) && (job->priority != thread_pool_priority_high)) {
+            // it will be skipped, move it up so its completion call isn't stuck behind real work
+            thread_pool_unqueue_job(pool, job);
+            job->priority = thread_pool_priority_high;
+            thread_pool_queue_job(pool, job, false);
+        }
+    }
+    sb_unlock_mutex(pool->mutex);
+}
+
+thread_pool_job_handle_t thread_pool_get_current_job(thread_pool_t * const pool) {
+    const thread_pool_worker_t * const worker = thread_pool_current_worker;
+    const job_t * job = NULL;
+    if (worker) {
+        job = (worker->pool == pool) ? worker->current_job : NULL;
+    } else if (sb_is_main_thread()) {
+        job = pool->current_completion;
+    }
+    return job ? (thread_pool_job_handle_t){.job = (job_t *)job, .id = job->id} : (thread_pool_job_handle_t){0};
+}
+
+bool thread_pool_is_cancelled(thread_pool_t * const pool, const thread_pool_job_handle_t handle) {
+    if (!handle.job) {
+        return false;
+    }
+
+    // a job polling itself (or its completion call) can't race its own release
+    const thread_pool_job_handle_t current = thread_pool_get_current_job(pool);
+    if ((current.job == handle.job) && (current.id == handle.id)) {
+        return sb_atomic_load(&handle.job->cancelled, memory_order_acquire) != 0;
+    }
+
+    sb_lock_mutex(pool->mutex);
+    const bool cancelled = thread_pool_is_live_handle(handle) && (sb_atomic_load(&handle.job->cancelled, memory_order_acquire) != 0);
+    sb_unlock_mutex(pool->mutex);
+    return cancelled;
+}
+
+void thread_pool_set_priority(thread_pool_t * const pool, const thread_pool_job_handle_t handle, const thread_pool_priority_e priority) {
+    ASSERT((priority >= 0) && (priority < thread_pool_num_priorities));
+
+    sb_lock_mutex(pool->mutex);
+    bool requeued = false;
+    if (thread_pool_is_live_handle(handle) && (handle.job->priority != priority)) {
+        job_t * const job = handle.job;
+        if (job->state == job_state_queued) {
+            thread_pool_unqueue_job(pool, job);
+            job->priority = priority;
+            thread_pool_queue_job(pool, job, false);
+            requeued = true;
+        } else if (job->state == job_state_parked) {
+            job->priority = priority;
+        }
+    }
+    sb_unlock_mutex(pool->mutex);
+
+    if (requeued) {
+        sb_condition_wake_one(pool->cv);
+    }
+}
+
+/* ===========================================================================
+ * workers
+ * ==========================================================================*/
+
+// takes the head of the highest non-empty lane to run and moves a few of the following jobs into the worker's deque, caller holds `mutex`
+static job_t * thread_pool_take_queued(thread_pool_worker_t * const worker) {
+    thread_pool_t * const pool = worker->pool;
+
+    static const thread_pool_priority_e drain_order[thread_pool_num_priorities] = {thread_pool_priority_high, thread_pool_priority_normal, thread_pool_priority_low};
+
+    int order = 0;
+    while ((order < thread_pool_num_priorities) && (pool->queued_head[drain_order[order]] == NULL)) {
+        ++order;
+    }
+    if (order == thread_pool_num_priorities) {
+        return NULL;
+    }
+    const thread_pool_priority_e lane = drain_order[order];
+
+    job_t * batch[thread_pool_queue_batch_size];
+    // the head runs right away and needs no deque slot, so a full deque never stops the queue from draining
+    const int max_batch = (lane == thread_pool_priority_low) ? 1 : 1 + min_int(thread_pool_queue_batch_size - 1, thread_pool_deque_capacity - thread_pool_deque_size(&worker->deque));
+    int count = 0;
+    while (pool->queued_head[lane] && (count < max_batch)) {
+        job_t * const job = pool->queued_head[lane];
+        pool->queued_head[lane] = job->next;
+        job->state = job_state_taken;
+        batch[count++] = job;
+    }
+    if (pool->queued_head[lane] == NULL) {
+        pool->queued_tail[lane] = NULL;
+    }
+    if (lane == thread_pool_priority_high) {
+        sb_atomic_fetch_add(&pool->num_queued_high, -count, memory_order_relaxed);
+    }
+
+    if (count == 0) {
+        return NULL;
+    }
+
+    // counters change before the shared queue is released so observers never see the work vanish
+    sb_atomic_fetch_add(&pool->busy_counter, 1, memory_order_seq_cst);
+    sb_atomic_fetch_add(&pool->num_stealable, count - 1, memory_order_seq_cst);
+
+    // push newest first so the deque hands the rest back in queue order
+    for (int i = count - 1; i > 0; --i) {
+        VERIFY(thread_pool_deque_push(&worker->deque, batch[i]));
+    }
+    thread_pool_update_queue_depth(worker);
+    return batch[0];
+}
+
+static job_t * thread_pool_steal(thread_pool_worker_t * const worker) {
+    thread_pool_t * const pool = worker->pool;
+    if (pool->thread_count < 2) {
+        return NULL;
+    }
+
+    // xorshift, pick a random victim and walk the others from there
+    uint32_t x = worker->rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->rand_state = x;
+
+    const int first = (int)(x % pool->thread_count);
+    for (int i = 0; i < pool->thread_count; ++i) {
+        thread_pool_worker_t * const victim = &pool->workers[(first + i) % pool->thread_count];
+        if (victim == worker) {
+            continue;
+        }
+        job_t * const job = thread_pool_deque_steal(&victim->deque);
+        if (job) {
+            sb_atomic_fetch_add(&pool->busy_counter, 1, memory_order_seq_cst);
+            sb_atomic_fetch_add(&pool->num_stealable, -1, memory_order_seq_cst);
+            ++worker->stats.steals;
+            return job;
+        }
+    }
+
+    ++worker->stats.failed_steals;
+    return NULL;
+}
+
+static job_t * thread_pool_take_local(thread_pool_worker_t * const worker) {
+    thread_pool_t * const pool = worker->pool;
+    job_t * const job = thread_pool_deque_take(&worker->deque);
+    if (job) {
+        sb_atomic_fetch_add(&pool->busy_counter, 1, memory_order_seq_cst);
+        sb_atomic_fetch_add(&pool->num_stealable, -1, memory_order_seq_cst);
+        thread_pool_update_queue_depth(worker);
+    }
+    return job;
+}
+
+static job_t * thread_pool_find_job(thread_pool_worker_t * const worker) {
+    thread_pool_t * const pool = worker->pool;
+
+    // high priority jobs submitted from outside the pool jump ahead of local work
+    const bool high_queued = sb_atomic_load(&pool->num_queued_high, memory_order_acquire) != 0;
+    if (!high_queued) {
+        job_t * const job = thread_pool_take_local(worker);
+        if (job) {
+            return job;
+        }
+    }
+
+    sb_lock_mutex(pool->mutex);
+    job_t * job = thread_pool_take_queued(worker);
+    sb_unlock_mutex(pool->mutex);
+    if (job) {
+        return job;
+    }
+
+    // another worker took the high priority jobs first
+    if (high_queued) {
+        job = thread_pool_take_local(worker);
+        if (job) {
+            return job;
+        }
+    }
+
+    return thread_pool_steal(worker);
+}
+
+// blocks until there may be work to do or the pool is shutting down
+static void thread_pool_wait_for_work(thread_pool_worker_t * const worker) {
+    thread_pool_t * const pool = worker->pool;
+    const microseconds_t idle_start = adk_read_microsecond_clock();
+
+    sb_lock_mutex(pool->mutex);
+    sb_atomic_fetch_add(&pool->num_sleepers, 1, memory_order_seq_cst);
+    while (!pool->should_quit && !thread_pool_has_queued_jobs(pool) && (sb_atomic_load(&pool->num_stealable, memory_order_seq_cst) == 0)) {
+        sb_wait_condition(pool->cv, pool->mutex, sb_timeout_infinite);
+    }
+    sb_atomic_fetch_add(&pool->num_sleepers, -1, memory_order_seq_cst);
+    sb_unlock_mutex(pool->mutex);
+
+    worker->stats.idle_time.us += adk_read_microsecond_clock().us - idle_start.us;
+}
+
+// releases the job's dependents and hands it to the completion list or the free list
+static void thread_pool_retire_job(thread_pool_t * const pool, job_t * const job) {
+    sb_lock_mutex(pool->mutex);
+    job->state = job_state_finished;
+
+    int num_released = 0;
+    for (int i = 0; i < job->num_dependents; ++i) {
+        job_t * const dependent = job->dependents[i];
+        ASSERT(dependent->num_pending_prerequisites > 0);
+        if (--dependent->num_pending_prerequisites == 0) {
+            --pool->num_parked;
+            thread_pool_queue_job(pool, dependent, false);
+            ++num_released;
+        }
+    }
+    job->num_dependents = 0;
+
+    if (job->completion_call) {
+        job->next = NULL;
+        if (pool->completion_call_tail == NULL) {
+            pool->completion_call_head = pool->completion_call_tail = job;
+        } else {
+            pool->completion_call_tail->next = job;
+            pool->completion_call_tail = job;
+        }
+    } else {
+        // Job is done, no completion call, return to free list
+        thread_pool_release_job(pool, job);
+    }
+    sb_atomic_fetch_add(&pool->busy_counter, -1, memory_order_seq_cst);
+    sb_unlock_mutex(pool->mutex);
+
+    if (num_released > 1) {
+        sb_condition_wake_all(pool->cv);
+    } else if (num_released == 1) {
+        sb_condition_wake_one(pool->cv);
+    }
+}
+
 static int thread_pool_proc(void * const args) {
-    thread_pool_t * const owning_pool = args;
-    sb_lock_mutex(owning_pool->mutex);
+    thread_pool_worker_t * const worker = args;
+    thread_pool_t * const owning_pool = worker->pool;
+    thread_pool_current_worker = worker;
+
     while (!owning_pool->should_quit) {
-        job_t * const job = owning_pool->queued_head;
-        if (job) {
-            owning_pool->queued_head = job->next;
-            if (owning_pool->queued_head == NULL) {
-                owning_pool->queued_tail = NULL;
-            }
-            ++owning_pool->busy_counter;
-            sb_unlock_mutex(owning_pool->mutex);
-
-            job->job_timings.start_timestamp = adk_read_microsecond_clock();
-            if (job->completion_call == ext_completion_placeholder) {
-                // Call extended job callback
-                job->completion_call = NULL;
-                job_token_t one_time_tok = {job};
-                job->job.ext(job->user, owning_pool, &one_time_tok);
-                if (one_time_tok.job == NULL) {
-                    // Completion call has been scheduled, 'job' is no longer valid
-                    sb_lock_mutex(owning_pool->mutex);
-                    --owning_pool->busy_counter;
-                    continue;
-                }
-            } else {
-                // Call standard job callback
-                job->job.std(job->user, owning_pool);
-                if (job->completion_call) {
-                    job->job_timings.end_timestamp = adk_read_microsecond_clock();
-                    sb_lock_mutex(owning_pool->mutex);
-                    --owning_pool->busy_counter;
-                    job->next = NULL;
-                    if (owning_pool->completion_call_tail == NULL) {
-                        owning_pool->completion_call_head = owning_pool->completion_call_tail = job;
-                    } else {
-                        owning_pool->completion_call_tail->next = job;
-                        owning_pool->completion_call_tail = job;
-                    }
-                    continue;
-                }
-            }
+        job_t * const job = thread_pool_find_job(worker);
+        if (!job) {
+            thread_pool_wait_for_work(worker);
+            continue;
+        }
 
-            // Job is done, no completion call, return to free list
-            ZEROMEM(job);
-            sb_lock_mutex(owning_pool->mutex);
-            --owning_pool->busy_counter;
-            if (owning_pool->free_tail == NULL) {
-                owning_pool->free_head = owning_pool->free_tail = job;
-            } else {
-                owning_pool->free_tail->next = job;
-                owning_pool->free_tail = job;
+        ++worker->stats.jobs_executed;
+        job->job_timings.start_timestamp = adk_read_microsecond_clock();
+        worker->current_job = job;
+        if (job->completion_call == ext_completion_placeholder) {
+            // Call extended job callback
+            job->completion_call = NULL;
+            job_token_t one_time_tok = {job};
+            job->job.ext(job->user, owning_pool, &one_time_tok);
+            if (one_time_tok.job == NULL) {
+                // Completion call has been scheduled, 'job' is no longer valid
+                worker->current_job = NULL;
+                sb_atomic_fetch_add(&owning_pool->busy_counter, -1, memory_order_seq_cst);
+                continue;
             }
+        } else if (sb_atomic_load(&job->cancelled, memory_order_acquire) == 0) {
+            // Call standard job callback
+            job->job.std(job->user, owning_pool);
         } else {
-            sb_wait_condition(owning_pool->cv, owning_pool->mutex, sb_timeout_infinite);
+            ++worker->stats.jobs_cancelled;
         }
+
+        job->job_timings.end_timestamp = adk_read_microsecond_clock();
+        worker->current_job = NULL;
+        thread_pool_retire_job(owning_pool, job);
     }
-    sb_unlock_mutex(owning_pool->mutex);
+
+    thread_pool_current_worker = NULL;
+
+    // hand any blocks this worker cached back to their heaps before the thread goes away
+    heap_thread_cache_flush_current_thread();
     return 0;
 }
 
@@ -233,7 +684,7 @@ void thread_pool_init(thread_pool_t * const pool, const mem_region_t _region, co
         region = _region;
     }
 #else
-    const mem_region_t region = _region;
+    mem_region_t region = _region;
 #endif
 
     ASSERT(region.ptr);
@@ -245,10 +696,24 @@ void thread_pool_init(thread_pool_t * const pool, const mem_region_t _region, co
     pool->cv = sb_create_condition_variable(tag);
     pool->thread_count = num_threads;
 
+    // worker deques are carved from the front of the job region
+    STATIC_ASSERT((thread_pool_deque_capacity & (thread_pool_deque_capacity - 1)) == 0);
+    const size_t deques_size = ALIGN_INT(sizeof(sb_atomic_ptr_t) * thread_pool_deque_capacity * pool->thread_count, ALIGN_OF(job_t));
+    VERIFY(region.size > deques_size);
+    for (uint8_t i = 0; i < pool->thread_count; ++i) {
+        thread_pool_worker_t * const worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        worker->rand_state = 0x9E3779B9u * (i + 1);
+        worker->deque.jobs = (sb_atomic_ptr_t *)region.byte_ptr + (size_t)i * thread_pool_deque_capacity;
+    }
+    region.byte_ptr += deques_size;
+    region.size -= deques_size;
+
     char thread_name[posix_thread_name_max_length];
     for (uint8_t i = 0; i < pool->thread_count; ++i) {
         sprintf_s(thread_name, ARRAY_SIZE(thread_name), "m5_%s_%i", pool_name, i);
-        pool->threads[i] = sb_create_thread(thread_name, sb_thread_default_options, thread_pool_proc, pool, tag);
+        pool->threads[i] = sb_create_thread(thread_name, sb_thread_default_options, thread_pool_proc, &pool->workers[i], tag);
     }
 
     const size_t job_aligned_size = ALIGN_INT(sizeof(job_t), ALIGN_OF(job_t));
@@ -295,7 +760,12 @@ void thread_pool_shutdown(thread_pool_t * const pool, const char * const tag) {
     sb_destroy_condition_variable(pool->cv, tag);
     sb_destroy_mutex(pool->mutex, tag);
 
-    if (pool->queued_head != NULL) {
+    for (int i = 0; i < pool->thread_count; ++i) {
+        const thread_pool_worker_stats_t stats = pool->workers[i].stats;
+        LOG_DEBUG(THREAD_POOL_TAG, "thread pool [%s] worker %i: jobs: %u cancelled: %u steals: %u failed steals: %u max queue depth: %i idle: %" PRIu64 "us", pool->name, i, stats.jobs_executed, stats.jobs_cancelled, stats.steals, stats.failed_steals, stats.max_queue_depth, stats.idle_time.us);
+    }
+
+    if (thread_pool_has_queued_jobs(pool) || (pool->num_parked != 0) || (sb_atomic_load(&pool->num_stealable, memory_order_acquire) != 0)) {
         LOG_WARN(THREAD_POOL_TAG, "thread pool [%s] shutdown with jobs still in queue", pool->name);
         ASSERT(false); // this should be handled appropriately in a debug build, and never occur in the wild..
     }
@@ -316,29 +786,26 @@ thread_pool_status_e thread_pool_run_completion_callbacks(thread_pool_t * const
 
     sb_lock_mutex(pool->mutex);
     job_t * const completion_head = pool->completion_call_head;
-    job_t * const completion_tail = pool->completion_call_tail;
     pool->completion_call_tail = pool->completion_call_head = NULL;
     sb_unlock_mutex(pool->mutex);
 
     job_t * curr_call = completion_head;
     while (curr_call) {
+        pool->current_completion = curr_call;
         curr_call->completion_call(curr_call->user, pool);
         curr_call = curr_call->next;
     }
-    if (completion_head != NULL) {
-        sb_lock_mutex(pool->mutex);
-        if (pool->free_tail) {
-            pool->free_tail->next = completion_head;
-            pool->free_tail = completion_tail;
-        } else {
-            pool->free_head = completion_head;
-            pool->free_tail = completion_tail;
-        }
-        sb_unlock_mutex(pool->mutex);
-    }
+    pool->current_completion = NULL;
 
     sb_lock_mutex(pool->mutex);
-    const bool busy = pool->queued_head || pool->busy_counter;
+    // jobs are cleared individually so stale handles stop matching
+    for (job_t * job = completion_head; job != NULL;) {
+        job_t * const next = job->next;
+        thread_pool_release_job(pool, job);
+        job = next;
+    }
+
+    const bool busy = thread_pool_has_queued_jobs(pool) || (pool->num_parked != 0) || sb_atomic_load(&pool->busy_counter, memory_order_seq_cst) || sb_atomic_load(&pool->num_stealable, memory_order_seq_cst);
     sb_unlock_mutex(pool->mutex);
 
     return busy ? thread_pool_busy : thread_pool_idle;
@@ -349,3 +816,8 @@ void thread_pool_drain(thread_pool_t * const pool) {
         sb_thread_sleep((milliseconds_t){1});
     }
 }
+
+thread_pool_worker_stats_t thread_pool_get_worker_stats(const thread_pool_t * const pool, const int worker_index) {
+    ASSERT((worker_index >= 0) && (worker_index < pool->thread_count));
+    return pool->workers[worker_index].stats;
+}
@@ -35,6 +35,62 @@ EXT_EXPORT size_t adk_get_screenshot_required_memory();
 EXT_EXPORT void adk_take_screenshot_flush(image_t * const out_screenshot, const mem_region_t screenshot_mem_region);
 void adk_take_screenshot(image_t * const out_screenshot, const mem_region_t screenshot_mem_region);
 
+// Captures the back buffer without stalling the render thread on the GPU. `callback` runs on the render thread once
+// `out_screenshot` holds the pixels, `out_screenshot` and `screenshot_mem_region` must stay valid until then.
+void adk_take_screenshot_async(image_t * const out_screenshot, const mem_region_t screenshot_mem_region, const rhi_screenshot_callback_t callback, void * const user);
+
+/*
+===============================================================================
+Continuous capture
+
+Captures every Nth presented frame for visual regression runs. Readbacks are
+asynchronous and encoding/writing happens on the default thread pool, frames
+are dropped rather than stalling the app when all capture buffers are busy.
+===============================================================================
+*/
+
+typedef enum adk_capture_format_e {
+    // one numbered file per captured frame: `<path_prefix>_<frame>.png`
+    adk_capture_format_png,
+    // one numbered file per captured frame: `<path_prefix>_<frame>.tga`
+    adk_capture_format_tga,
+    // all captured frames appended to `<path_prefix>.raw`, each as an adk_capture_raw_frame_header_t followed by top-down RGBA8 pixels
+    adk_capture_format_raw
+} adk_capture_format_e;
+
+typedef struct adk_capture_raw_frame_header_t {
+    uint32_t magic;
+    uint32_t frame;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+} adk_capture_raw_frame_header_t;
+
+#define ADK_CAPTURE_RAW_FRAME_MAGIC FOURCC('A', 'C', 'F', 'R')
+
+typedef struct adk_continuous_capture_options_t {
+    // capture one frame out of every `frame_interval` presented frames
+    uint32_t frame_interval;
+    adk_capture_format_e format;
+    sb_file_directory_e directory;
+    const char * path_prefix;
+} adk_continuous_capture_options_t;
+
+typedef struct adk_continuous_capture_stats_t {
+    uint32_t frames_captured;
+    // frames that were due for capture while all capture buffers were busy
+    uint32_t frames_dropped;
+} adk_continuous_capture_stats_t;
+
+void adk_start_continuous_capture(const adk_continuous_capture_options_t * const options);
+// Waits for pending captures to be written, does nothing if no capture is running.
+void adk_stop_continuous_capture();
+bool adk_is_continuous_capture_running();
+adk_continuous_capture_stats_t adk_get_continuous_capture_stats();
+
+// Called once per frame before present is written to the command stream.
+void adk_continuous_capture_tick();
+
 void adk_save_screenshot(const image_t * const screenshot, const image_save_file_type_e file_type, const sb_file_directory_e directory, const char * const filename);
 
 void adk_get_screenshot_file_required_memory(const const_mem_region_t screenshot_file_region, image_t * const screenshot, size_t * const out_required_pixel_buffer_size, size_t * const out_required_working_space_size);
@@ -10,6 +10,13 @@
  thread_pool.h
 
  multi consumer, multi producer work stealing thread pool with basic job timing information
+
+ Jobs enqueued from outside the pool go to a shared queue that workers pull from in small batches.
+ Each worker runs jobs from its own deque and steals from the other workers' deques when it runs dry.
+ Jobs a worker enqueues at the front go straight to its own deque.
+
+ Jobs submitted through thread_pool_submit return a handle that can be used to cancel or reprioritize the job,
+ and to make other jobs wait for it to finish.
  */
 
 #include "runtime.h"
@@ -29,22 +36,83 @@ enum {
 #endif
 };
 
+enum {
+    // capacity of each worker's deque, must be a power of two
+    thread_pool_deque_capacity = 64,
+    // max jobs a worker moves from the shared queue into its deque at once
+    thread_pool_queue_batch_size = 4,
+    // max jobs that can wait on a single prerequisite
+    thread_pool_max_dependents = 8,
+};
+
+// Shared queue lanes, workers always drain higher lanes first.
+// Low priority jobs are never batched into a worker's deque so they can still be reprioritized or skipped.
+// Normal is the zero value so zero-initialized descs don't jump ahead of local work.
+typedef enum thread_pool_priority_e {
+    thread_pool_priority_normal,
+    thread_pool_priority_high,
+    thread_pool_priority_low,
+    thread_pool_num_priorities
+} thread_pool_priority_e;
+
 typedef struct job_t job_t;
 
+// Per-worker counters, written only by the owning worker and sampled without synchronization
+typedef struct thread_pool_worker_stats_t {
+    uint32_t jobs_executed;
+    // jobs skipped because they were cancelled before they started
+    uint32_t jobs_cancelled;
+    uint32_t steals;
+    uint32_t failed_steals;
+    int32_t queue_depth;
+    int32_t max_queue_depth;
+    microseconds_t idle_time;
+} thread_pool_worker_stats_t;
+
+// Chase-Lev deque: the owning worker pushes and takes at `bottom`, other workers steal from `top`
+typedef struct thread_pool_deque_t {
+    sb_atomic_int32_t top;
+    sb_atomic_int32_t bottom;
+    sb_atomic_ptr_t * jobs;
+} thread_pool_deque_t;
+
+typedef struct thread_pool_worker_t {
+    struct thread_pool_t * pool;
+    thread_pool_deque_t deque;
+    thread_pool_worker_stats_t stats;
+    job_t * current_job;
+    uint32_t rand_state;
+    int index;
+} thread_pool_worker_t;
+
 typedef struct thread_pool_t {
     char name[thread_pool_name_length];
     sb_thread_id_t threads[thread_pool_max_threads];
+    thread_pool_worker_t workers[thread_pool_max_threads];
     uint8_t thread_count;
     int job_id_counter;
     int max_pending_jobs;
-    int busy_counter;
 
+    // jobs taken by a worker and not yet finished
+    sb_atomic_int32_t busy_counter;
+    // jobs sitting in worker deques
+    sb_atomic_int32_t num_stealable;
+    // workers blocked on `cv`
+    sb_atomic_int32_t num_sleepers;
+    // jobs in the high priority lane of the shared queue, these jump ahead of the workers' deques
+    sb_atomic_int32_t num_queued_high;
+
+    // `mutex` guards the free list, the shared queue lanes, parked jobs and the completion list
     job_t * free_head;
     job_t * free_tail;
-    job_t * queued_head;
-    job_t * queued_tail;
+    job_t * queued_head[thread_pool_num_priorities];
+    job_t * queued_tail[thread_pool_num_priorities];
     job_t * completion_call_head;
     job_t * completion_call_tail;
+    // jobs waiting on prerequisites
+    int num_parked;
+    // job whose completion callback is running on the main thread
+    job_t * current_completion;
 
     sb_mutex_t * mutex;
     sb_condition_variable_t * cv;
@@ -89,9 +157,54 @@ typedef enum thread_pool_status_e {
     thread_pool_busy
 } thread_pool_status_e;
 
+/*
+===============================================================================
+Job handles
+
+A handle stays safe to use after its job finished, it just no longer refers to
+a live job: cancelling or reprioritizing it is a no-op and jobs depending on it
+don't wait.
+===============================================================================
+*/
+
+typedef struct thread_pool_job_handle_t {
+    job_t * job;
+    int id;
+} thread_pool_job_handle_t;
+
+typedef struct thread_pool_job_desc_t {
+    thread_pool_call_fn_t job;
+    // optional, runs on the main thread from thread_pool_run_completion_callbacks, also for cancelled jobs
+    thread_pool_call_fn_t completion_call;
+    void * user;
+    thread_pool_priority_e priority;
+    // the job is held back until all of these finished running (cancelled prerequisites count as finished)
+    const thread_pool_job_handle_t * prerequisites;
+    int num_prerequisites;
+} thread_pool_job_desc_t;
+
+thread_pool_job_handle_t thread_pool_submit(thread_pool_t * const pool, const thread_pool_job_desc_t * const desc);
+
+// Cooperative cancellation: a job that has not started yet is skipped (its completion callback still runs), a running
+// job can poll thread_pool_is_cancelled to bail out early.
+void thread_pool_cancel(thread_pool_t * const pool, const thread_pool_job_handle_t handle);
+bool thread_pool_is_cancelled(thread_pool_t * const pool, const thread_pool_job_handle_t handle);
+
+// Moves a job that is still waiting in the shared queue (or on prerequisites) to another lane.
+void thread_pool_set_priority(thread_pool_t * const pool, const thread_pool_job_handle_t handle, const thread_pool_priority_e priority);
+
+// The job running on the calling worker, or on the main thread the job whose completion callback is running.
+thread_pool_job_handle_t thread_pool_get_current_job(thread_pool_t * const pool);
+
+static inline bool thread_pool_current_job_is_cancelled(thread_pool_t * const pool) {
+    return thread_pool_is_cancelled(pool, thread_pool_get_current_job(pool));
+}
+
 thread_pool_status_e thread_pool_run_completion_callbacks(thread_pool_t * const pool);
 void thread_pool_drain(thread_pool_t * const pool);
 
+thread_pool_worker_stats_t thread_pool_get_worker_stats(const thread_pool_t * const pool, const int worker_index);
+
 #ifdef __cplusplus
 }
 #endif
@@ -84,7 +84,7 @@ LOAD(glBlendColor, GLBLENDCOLOR)
 /*LOAD(glGetQueryiv, GLGETQUERYIV)*/
 /*LOAD(glGetQueryObjectiv, GLGETQUERYOBJECTIV)*/
 /*LOAD(glGetQueryObjectuiv, GLGETQUERYOBJECTUIV)*/
-#if !(defined(GL_DSA) && defined(GL_VAOS))
+#if !(defined(GL_DSA) && defined(GL_VAOS)) || defined(GL_ASYNC_READBACK)
 LOAD(glBindBuffer, GLBINDBUFFER)
 #endif
 #ifndef GL_DSA
@@ -92,6 +92,9 @@ LOAD(glGenBuffers, GLGENBUFFERS)
 LOAD(glIsBuffer, GLISBUFFER)
 LOAD(glBufferData, GLBUFFERDATA)
 LOAD(glBufferSubData, GLBUFFERSUBDATA)
+#ifdef GL_ASYNC_READBACK
+LOAD(glUnmapBuffer, GLUNMAPBUFFER)
+#endif
 #endif
 LOAD(glDeleteBuffers, GLDELETEBUFFERS)
 
@@ -216,7 +219,11 @@ LOAD(glBlitFramebuffer, GLBLITFRAMEBUFFER)
 #endif
 /*LOAD(glRenderbufferStorageMultisample, GLRENDERBUFFERSTORAGEMULTISAMPLE)*/
 /*LOAD(glFramebufferTextureLayer, GLFRAMEBUFFERTEXTURELAYER)*/
+#if defined(GL_ASYNC_READBACK) && !defined(GL_DSA)
+LOAD(glMapBufferRange, GLMAPBUFFERRANGE)
+#else
 /*LOAD(glMapBufferRange, GLMAPBUFFERRANGE)*/
+#endif
 /*LOAD(glFlushMappedBufferRange, GLFLUSHMAPPEDBUFFERRANGE)*/
 
 LOAD(glBindVertexArray, GLBINDVERTEXARRAY)
@@ -250,10 +257,17 @@ LOAD(glGenVertexArrays, GLGENVERTEXARRAYS)
 /*LOAD(glDrawElementsInstancedBaseVertex, GLDRAWELEMENTSINSTANCEDBASEVERTEX)*/
 /*LOAD(glMultiDrawElementsBaseVertex, GLMULTIDRAWELEMENTSBASEVERTEX)*/
 /*LOAD(glProvokingVertex, GLPROVOKINGVERTEX)*/
+#ifdef GL_ASYNC_READBACK
+LOAD(glFenceSync, GLFENCESYNC)
+/*LOAD(glIsSync, GLISSYNC)*/
+LOAD(glDeleteSync, GLDELETESYNC)
+LOAD(glClientWaitSync, GLCLIENTWAITSYNC)
+#else
 /*LOAD(glFenceSync, GLFENCESYNC)*/
 /*LOAD(glIsSync, GLISSYNC)*/
 /*LOAD(glDeleteSync, GLDELETESYNC)*/
 /*LOAD(glClientWaitSync, GLCLIENTWAITSYNC)*/
+#endif
 /*LOAD(glWaitSync, GLWAITSYNC)*/
 /*LOAD(glGetInteger64v, GLGETINTEGER64V)*/
 /*LOAD(glGetSynciv, GLGETSYNCIV)*/
@@ -741,6 +755,10 @@ END
 /*REQUIRE(EXT_texture_filter_anisotropic)*/
 
 #if GLVERSION < 440
+#ifdef GL_STREAMING_BUFFERS
+// persistent mappings through glNamedBufferStorage
+CHECK(ARB_buffer_storage)
+#endif
 /*OPTIONAL(ARB_buffer_storage)*/
 /*LOAD(glBufferStorage, GLBUFFERSTORAGE)*/
 /*END*/
@@ -1039,8 +1057,13 @@ END
     /*LOAD(glCopyNamedBufferSubData, GLCOPYNAMEDBUFFERSUBDATA)*/
     /*LOAD(glClearNamedBufferData, GLCLEARNAMEDBUFFERDATA)*/
     /*LOAD(glClearNamedBufferSubData, GLCLEARNAMEDBUFFERSUBDATA)*/
+#ifdef GL_ASYNC_READBACK
+    LOAD(glMapNamedBufferRange, GLMAPNAMEDBUFFERRANGE)
+    LOAD(glUnmapNamedBuffer, GLUNMAPNAMEDBUFFER)
+#else
     /*LOAD(glMapNamedBufferRange, GLMAPNAMEDBUFFERRANGE)*/
     /*LOAD(glUnmapNamedBuffer, GLUNMAPNAMEDBUFFER)*/
+#endif
     /*LOAD(glFlushMappedNamedBufferRange, GLFLUSHMAPPEDNAMEDBUFFERRANGE)*/
     /*LOAD(glGetNamedBufferParameteriv, GLGETNAMEDBUFFERPARAMETERIV)*/
     /*LOAD(glGetNamedBufferParameteri64v, GLGETNAMEDBUFFERPARAMETERI64V)*/
@@ -25,6 +25,8 @@ OpenGL rendering device configuration
 #define GL_DSA
 #define GL_CORE
 #define GL_DEBUG_CONTEXT
+#define GL_ASYNC_READBACK
+#define GL_STREAMING_BUFFERS
 #if !defined(_NDEBUG) && defined(_ENABLE_GL_CHECK_ERRORS)
 #define GL_CHECK_ERRORS
 #endif
@@ -32,4 +34,9 @@ OpenGL rendering device configuration
 #define GL_VAOS
 #define GL_CORE
 #define GL_DEBUG_CONTEXT
+#define GL_ASYNC_READBACK
+#endif
+
+#if defined(GL_STREAMING_BUFFERS) && !(defined(GL_DSA) && defined(GL_ASYNC_READBACK))
+#error "GL_STREAMING_BUFFERS maps through GL_DSA and fences with the GL_ASYNC_READBACK entry points"
 #endif
@@ -328,8 +328,63 @@ typedef struct gl_mesh_t {
     const char * tag;
     GLuint index_buffer;
     int index_buffer_id;
+#ifdef GL_STREAMING_BUFFERS
+    // persistent mapping of the rhi_usage_stream channel and the fences of its regions
+    void * stream_mapping;
+    int stream_channel;
+    GLsync stream_fences[rhi_max_mesh_stream_fences];
+#endif
 } gl_mesh_t;
 
+#ifdef GL_STREAMING_BUFFERS
+enum {
+    gl_stream_map_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT,
+    // granularity of blocking waits on a stream region fence
+    gl_stream_wait_timeout_ns = 100 * 1000 * 1000
+};
+
+static void gl_free_stream_buffer(gl_context_t * const context, gl_mesh_t * const mesh) {
+    for (int i = 0; i < ARRAY_SIZE(mesh->stream_fences); ++i) {
+        if (mesh->stream_fences[i]) {
+            glf.glDeleteSync(mesh->stream_fences[i]);
+            mesh->stream_fences[i] = NULL;
+        }
+    }
+
+    if (mesh->stream_mapping) {
+        glf.glUnmapNamedBuffer(mesh->vertex_buffers[mesh->stream_channel]);
+        CHECK_GL_ERRORS();
+        ++context->counters.num_api_calls;
+        mesh->stream_mapping = NULL;
+    }
+}
+#endif
+
+// Allocates immutable storage for a rhi_usage_stream channel and maps it for the life of the mesh,
+// returns false if persistent mappings aren't supported and the channel should be treated as dynamic.
+static bool gl_create_stream_buffer(gl_context_t * const context, gl_mesh_t * const mesh, const int channel_index, const const_mem_region_t data) {
+#ifdef GL_STREAMING_BUFFERS
+    if (!glf.ARB_buffer_storage || mesh->stream_mapping || !data.size) {
+        return false;
+    }
+
+    const GLuint vertex_buffer = mesh->vertex_buffers[channel_index];
+    glf.glNamedBufferStorage(vertex_buffer, data.size, data.ptr, gl_stream_map_flags);
+    CHECK_GL_ERRORS();
+    ++context->counters.num_api_calls;
+
+    mesh->stream_mapping = glf.glMapNamedBufferRange(vertex_buffer, 0, data.size, gl_stream_map_flags);
+    CHECK_GL_ERRORS();
+    ++context->counters.num_api_calls;
+
+    VERIFY_MSG(mesh->stream_mapping, "failed to map stream buffer [%s]", mesh->tag);
+    mesh->stream_channel = channel_index;
+    return true;
+#else
+    return false;
+#endif
+}
+
 static void gl_destroy_mesh(gl_resource_t * const resource, const char * const tag) {
     BIND_THREAD_CONTEXT(context);
     gl_mesh_t * const mesh = (gl_mesh_t *)resource;
@@ -348,6 +403,10 @@ static void gl_destroy_mesh(gl_resource_t * const resource, const char * const t
         glc_delete_buffers(context, 1, &mesh->index_buffer);
     }
 
+#ifdef GL_STREAMING_BUFFERS
+    gl_free_stream_buffer(context, mesh);
+#endif
+
     if (mesh->vertex_buffers && !mesh->shared_verts) {
         // we own these vertex buffers
         glc_delete_buffers(context, mesh->layout->desc.num_channels, mesh->vertex_buffers);
@@ -405,6 +464,8 @@ static inline void glc_use_program(gl_context_t * const context, gl_program_t *
         GL_CALL(glUseProgram(program->program));
         CHECK_GL_ERRORS();
         ++context->counters.num_api_calls;
+    } else {
+        ++context->counters.num_redundant_api_calls;
     }
 }
 
@@ -488,9 +549,14 @@ static inline void glc_sync_program_uniform_data(gl_context_t * const context) {
             const int uniform_location = program->uniform_locations[i];
             if (uniform_location != -1) {
                 gl_uniform_buffer_t * const ub = context->ubuffers[i];
-                if (ub && ub->data.ptr && (ub->crc != program->uniform_crcs[i])) {
-                    program->uniform_crcs[i] = ub->crc;
-                    gl_upload_uniform_funcs[i](uniform_location, ub);
+                if (ub && ub->data.ptr) {
+                    if (ub->crc != program->uniform_crcs[i]) {
+                        program->uniform_crcs[i] = ub->crc;
+                        gl_upload_uniform_funcs[i](uniform_location, ub);
+                        ++context->counters.num_api_calls;
+                    } else {
+                        ++context->counters.num_redundant_api_calls;
+                    }
                 }
             }
         }
@@ -613,17 +679,7 @@ static void glc_set_rasterizer_state(gl_context_t * const context, const gl_rast
             }
         }
 
-        if (rs->desc.scissor_test != context->rs_desc.scissor_test) {
-            if (rs->desc.scissor_test) {
-                glEnable(GL_SCISSOR_TEST);
-                CHECK_GL_ERRORS();
-                ++context->counters.num_api_calls;
-            } else {
-                glDisable(GL_SCISSOR_TEST);
-                CHECK_GL_ERRORS();
-                ++context->counters.num_api_calls;
-            }
-        }
+        glc_enable_scissor(context, rs->desc.scissor_test);
 
         context->rs_desc = rs->desc;
         context->active_rs = rs;
@@ -889,6 +945,9 @@ static void gld_upload_mesh_channel_data(rhi_device_t * const device, rhi_mesh_t
 
     ASSERT(channel_index >= 0);
     ASSERT(channel_index < gl_mesh->layout->desc.num_channels);
+#ifdef GL_STREAMING_BUFFERS
+    ASSERT_MSG(!gl_mesh->stream_mapping || (gl_mesh->stream_channel != channel_index), "mapped stream channels are written through their mapping");
+#endif
 
     const GLuint vertex_buffer = gl_mesh->vertex_buffers[channel_index];
     const int vertex_buffer_id = gl_mesh->vertex_buffer_ids[channel_index];
@@ -909,6 +968,72 @@ static void gld_upload_mesh_channel_data(rhi_device_t * const device, rhi_mesh_t
     DC->counters.upload_vert_size += len;
 }
 
+/*
+=======================================
+gld_map_mesh_channel
+=======================================
+*/
+
+static void * gld_map_mesh_channel(rhi_device_t * const device, rhi_mesh_t * const mesh, const int channel_index) {
+    gl_mesh_t * const gl_mesh = (gl_mesh_t *)mesh;
+    ASSERT(channel_index >= 0);
+    ASSERT(channel_index < gl_mesh->layout->desc.num_channels);
+    ASSERT(gl_mesh->layout->desc.channels[channel_index].usage == rhi_usage_stream);
+
+#ifdef GL_STREAMING_BUFFERS
+    if (gl_mesh->stream_mapping && (gl_mesh->stream_channel == channel_index)) {
+        return gl_mesh->stream_mapping;
+    }
+#endif
+
+    // not mapped, the channel is uploaded like a rhi_usage_dynamic one
+    return NULL;
+}
+
+/*
+=======================================
+gld_fence_mesh_stream
+
+The cpu writes stream regions while the gpu may still be drawing
+from them, so each region is fenced once it has been drawn from and
+the fence is waited on here, on the render thread, before the region
+is handed back to the cpu.
+=======================================
+*/
+
+static void gld_fence_mesh_stream(rhi_device_t * const device, rhi_mesh_t * const mesh, const int signal_slot, const int wait_slot) {
+#ifdef GL_STREAMING_BUFFERS
+    gl_mesh_t * const gl_mesh = (gl_mesh_t *)mesh;
+    if (!gl_mesh->stream_mapping) {
+        // uploads are ordered by the driver
+        return;
+    }
+
+    ASSERT((signal_slot >= 0) && (signal_slot < ARRAY_SIZE(gl_mesh->stream_fences)));
+    if (gl_mesh->stream_fences[signal_slot]) {
+        // an older fence of this region, the new one covers it
+        glf.glDeleteSync(gl_mesh->stream_fences[signal_slot]);
+    }
+    gl_mesh->stream_fences[signal_slot] = glf.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    CHECK_GL_ERRORS();
+    ++DC->counters.num_api_calls;
+
+    if ((wait_slot >= 0) && gl_mesh->stream_fences[wait_slot]) {
+        ASSERT(wait_slot < ARRAY_SIZE(gl_mesh->stream_fences));
+        GLenum status;
+        do {
+            status = glf.glClientWaitSync(gl_mesh->stream_fences[wait_slot], GL_SYNC_FLUSH_COMMANDS_BIT, gl_stream_wait_timeout_ns);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        CHECK_GL_ERRORS();
+        ++DC->counters.num_api_calls;
+        ASSERT(status != GL_WAIT_FAILED);
+
+        glf.glDeleteSync(gl_mesh->stream_fences[wait_slot]);
+        gl_mesh->stream_fences[wait_slot] = NULL;
+    }
+#endif
+}
+
 /*
 =======================================
 gld_upload_mesh_indices
@@ -1136,6 +1261,22 @@ static void gld_set_scissor_rect(rhi_device_t * const device, const int x0, cons
     }
 }
 
+/*
+=======================================
+gld_set_clip_rect
+=======================================
+*/
+
+static void gld_set_clip_rect(rhi_device_t * const device, const rhi_rect_t * const rect) {
+    if (rect) {
+        DC->clip.rect = (gl_rect_t){rect->x0, D->display_height - rect->y1, rect->x1 - rect->x0, rect->y1 - rect->y0};
+        DC->clip.enabled = true;
+    } else {
+        DC->clip.enabled = false;
+    }
+    glc_apply_scissor(DC);
+}
+
 /*
 =======================================
 gld_set_program
@@ -1259,21 +1400,63 @@ gld_set_texture_sampler_state_indirect
 static inline void gld_set_texture_sampler_state(rhi_device_t * const device, rhi_texture_t * const texture, const rhi_sampler_state_desc_t sampler_state) {
     gl_texture_t * const gl_texture = (gl_texture_t *)texture;
 
+    // only parameters that differ from the ones GL has are sent
+    const bool all = !gl_texture->has_sampler_state;
+    const rhi_sampler_state_desc_t current = gl_texture->sampler_state;
+    const bool min_filter = all || (sampler_state.min_filter != current.min_filter);
+    const bool max_filter = all || (sampler_state.max_filter != current.max_filter);
+    const bool u_wrap_mode = all || (sampler_state.u_wrap_mode != current.u_wrap_mode);
+    const bool v_wrap_mode = all || (sampler_state.v_wrap_mode != current.v_wrap_mode);
+
+    gl_texture->sampler_state = sampler_state;
+    gl_texture->has_sampler_state = true;
+
 #ifdef GL_CORE
-    glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_MIN_FILTER, get_gl_min_filter(sampler_state.min_filter));
-    glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_MAG_FILTER, get_gl_max_filter(sampler_state.max_filter));
-    glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_WRAP_S, get_gl_wrap_mode(sampler_state.u_wrap_mode));
-    glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_WRAP_T, get_gl_wrap_mode(sampler_state.v_wrap_mode));
-    glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_WRAP_R, get_gl_wrap_mode(sampler_state.w_wrap_mode));
-    glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, sampler_state.max_anisotropy ? sampler_state.max_anisotropy : DC->caps.max_anisotropy);
+    const bool w_wrap_mode = all || (sampler_state.w_wrap_mode != current.w_wrap_mode);
+    const bool max_anisotropy = all || (sampler_state.max_anisotropy != current.max_anisotropy);
+
+    if (min_filter) {
+        glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_MIN_FILTER, get_gl_min_filter(sampler_state.min_filter));
+    }
+    if (max_filter) {
+        glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_MAG_FILTER, get_gl_max_filter(sampler_state.max_filter));
+    }
+    if (u_wrap_mode) {
+        glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_WRAP_S, get_gl_wrap_mode(sampler_state.u_wrap_mode));
+    }
+    if (v_wrap_mode) {
+        glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_WRAP_T, get_gl_wrap_mode(sampler_state.v_wrap_mode));
+    }
+    if (w_wrap_mode) {
+        glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_WRAP_R, get_gl_wrap_mode(sampler_state.w_wrap_mode));
+    }
+    if (max_anisotropy) {
+        glc_sampler_parameter_i(DC, gl_texture->sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, sampler_state.max_anisotropy ? sampler_state.max_anisotropy : DC->caps.max_anisotropy);
+    }
+
+    DC->counters.num_redundant_api_calls += 6 - (min_filter + max_filter + u_wrap_mode + v_wrap_mode + w_wrap_mode + max_anisotropy);
 #else // GL_ES
+    DC->counters.num_redundant_api_calls += 4 - (min_filter + max_filter + u_wrap_mode + v_wrap_mode);
+
+    if (!(min_filter || max_filter || u_wrap_mode || v_wrap_mode)) {
+        return;
+    }
+
     const GLuint t = DC->textures[0];
     const int tid = DC->texture_ids[0];
 
-    glc_tex_parameter_i(DC, GL_TEXTURE0, gl_texture->target, gl_texture->texture, gl_texture->resource.resource.instance_id, GL_TEXTURE_MIN_FILTER, get_gl_min_filter(sampler_state.min_filter));
-    glc_tex_parameter_i(DC, GL_TEXTURE0, gl_texture->target, gl_texture->texture, gl_texture->resource.resource.instance_id, GL_TEXTURE_MAG_FILTER, get_gl_max_filter(sampler_state.max_filter));
-    glc_tex_parameter_i(DC, GL_TEXTURE0, gl_texture->target, gl_texture->texture, gl_texture->resource.resource.instance_id, GL_TEXTURE_WRAP_S, get_gl_wrap_mode(sampler_state.u_wrap_mode));
-    glc_tex_parameter_i(DC, GL_TEXTURE0, gl_texture->target, gl_texture->texture, gl_texture->resource.resource.instance_id, GL_TEXTURE_WRAP_T, get_gl_wrap_mode(sampler_state.v_wrap_mode));
+    if (min_filter) {
+        glc_tex_parameter_i(DC, GL_TEXTURE0, gl_texture->target, gl_texture->texture, gl_texture->resource.resource.instance_id, GL_TEXTURE_MIN_FILTER, get_gl_min_filter(sampler_state.min_filter));
+    }
+    if (max_filter) {
+        glc_tex_parameter_i(DC, GL_TEXTURE0, gl_texture->target, gl_texture->texture, gl_texture->resource.resource.instance_id, GL_TEXTURE_MAG_FILTER, get_gl_max_filter(sampler_state.max_filter));
+    }
+    if (u_wrap_mode) {
+        glc_tex_parameter_i(DC, GL_TEXTURE0, gl_texture->target, gl_texture->texture, gl_texture->resource.resource.instance_id, GL_TEXTURE_WRAP_S, get_gl_wrap_mode(sampler_state.u_wrap_mode));
+    }
+    if (v_wrap_mode) {
+        glc_tex_parameter_i(DC, GL_TEXTURE0, gl_texture->target, gl_texture->texture, gl_texture->resource.resource.instance_id, GL_TEXTURE_WRAP_T, get_gl_wrap_mode(sampler_state.v_wrap_mode));
+    }
 
     if (tid) {
         // restore prior texture bindings
@@ -1297,12 +1480,15 @@ static void gld_set_texture_bindings_indirect(rhi_device_t * const device, const
             if (tex && (tex->resource.resource.instance_id != dst)) {
                 // bound texture change
                 glc_bind_texture(DC, GL_TEXTURE0 + i, tex->target, tex->texture, tex->resource.resource.instance_id);
+            } else if (tex) {
+                ++DC->counters.num_redundant_api_calls;
+            }
 #ifdef GL_CORE
-                glf.glBindSampler(i, tex->sampler);
-#endif
-                CHECK_GL_ERRORS();
-                ++DC->counters.num_api_calls;
+            if (tex) {
+                // the unit may hold another sampler after a framebuffer blit
+                glc_bind_sampler(DC, i, tex->sampler);
             }
+#endif
         }
     }
 }
@@ -1416,12 +1602,15 @@ static void glc_framebuffer_blit(gl_context_t * const context, const gl_render_t
     glf.glVertexArrayAttribBinding(glcore_default_vertex_array_id, 0, 0);
     CHECK_GL_ERRORS();
     context->counters.num_api_calls += 4;
-#else
+#elif defined(GL_VAOS)
     GL_CALL(glEnableVertexAttribArray(0));
     CHECK_GL_ERRORS();
     GL_CALL(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL));
     CHECK_GL_ERRORS();
     context->counters.num_api_calls += 2;
+#else
+    glc_enable_vertex_attribs(context, 1u << 0);
+    glc_vertex_attrib_pointer(context, 0, (gl_vertex_attrib_t){.buffer_id = gl_framebuffer_blit_program.vbid, .count = 2, .type = GL_FLOAT, .normalized = GL_FALSE});
 #endif
 
     // bind target framebuffer
@@ -1438,8 +1627,7 @@ static void glc_framebuffer_blit(gl_context_t * const context, const gl_render_t
 
     glc_bind_texture(context, GL_TEXTURE0, GL_TEXTURE_2D, src->color_buffers[0]->texture, src->color_buffer_ids[0]);
 #ifdef GL_CORE
-    glf.glBindSampler(0, src->color_buffers[0]->sampler);
-    CHECK_GL_ERRORS();
+    glc_bind_sampler(context, 0, src->color_buffers[0]->sampler);
 #endif
 
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
@@ -1505,6 +1693,11 @@ static void gld_draw_indirect(rhi_device_t * const device, const rhi_draw_params
         glc_bind_framebuffer(DC, GL_FRAMEBUFFER, D->active_render_target->framebuffer, D->active_render_target->resource.resource.instance_id);
     }
 
+    if (params->num_batched_draws > 0) {
+        ++DC->counters.num_batches;
+        DC->counters.num_batched_draws += params->num_batched_draws;
+    }
+
     for (int i = 0; i < params->num_meshes; ++i) {
         gl_mesh_t * const mesh = (gl_mesh_t *)(*params->mesh_list[i]);
         const int idx_ofs = params->idx_ofs ? params->idx_ofs[i] : 0;
@@ -1555,7 +1748,7 @@ static void gld_draw_indirect(rhi_device_t * const device, const rhi_draw_params
 #endif
             }
 
-#if !defined(GL_DSA) || !defined(GL_VAOS)
+#if defined(GL_VAOS) && !defined(GL_DSA)
             {
                 const int max_inputs = min_int(rhi_program_input_num_semantics, DC->caps.max_vertex_inputs);
                 for (int j = 0; j < max_inputs; ++j) {
@@ -1563,6 +1756,17 @@ static void gld_draw_indirect(rhi_device_t * const device, const rhi_draw_params
                     CHECK_GL_ERRORS();
                 }
             }
+#elif !defined(GL_VAOS)
+            {
+                // without vaos the arrays are context state, only touch the ones that differ from the last draw
+                uint32_t attrib_mask = 0;
+                for (int j = 0; j < layout.num_channels; ++j) {
+                    for (int jj = 0; jj < layout.channels[j].num_elements; ++jj) {
+                        attrib_mask |= 1u << (int)layout.channels[j].elements[jj].semantic;
+                    }
+                }
+                glc_enable_vertex_attribs(DC, attrib_mask);
+            }
 #endif
 
             for (int j = 0; j < layout.num_channels; ++j) {
@@ -1592,11 +1796,11 @@ static void gld_draw_indirect(rhi_device_t * const device, const rhi_draw_params
 #if defined(GL_DSA) && defined(GL_VAOS)
                         glf.glVertexArrayVertexBuffer(vao->vao_id, j, mesh->vertex_buffers[j], 0, channel.stride);
                         CHECK_GL_ERRORS();
+                        ++DC->counters.num_api_calls;
 #else
                         glc_bind_buffer(DC, GL_ARRAY_BUFFER, mesh->vertex_buffers[j], mesh->vertex_buffer_ids[j], false);
 #endif
                         bound = true;
-                        ++DC->counters.num_api_calls;
                     }
 
 #if defined(GL_DSA) && defined(GL_VAOS)
@@ -1607,12 +1811,23 @@ static void gld_draw_indirect(rhi_device_t * const device, const rhi_draw_params
                     glf.glVertexArrayAttribBinding(vao->vao_id, (int)element.semantic, j);
                     CHECK_GL_ERRORS();
                     DC->counters.num_api_calls += 3;
-#else
+#elif defined(GL_VAOS)
                     GL_CALL(glEnableVertexAttribArray((int)element.semantic));
                     CHECK_GL_ERRORS();
                     GL_CALL(glVertexAttribPointer((int)element.semantic, element.count, type, normalized ? GL_TRUE : GL_FALSE, channel.stride, (const void *)(size_t)element.offset));
                     CHECK_GL_ERRORS();
                     DC->counters.num_api_calls += 2;
+#else
+                    glc_vertex_attrib_pointer(
+                        DC,
+                        (int)element.semantic,
+                        (gl_vertex_attrib_t){
+                            .buffer_id = mesh->vertex_buffer_ids[j],
+                            .count = element.count,
+                            .type = type,
+                            .normalized = normalized ? GL_TRUE : GL_FALSE,
+                            .stride = channel.stride,
+                            .offset = (size_t)element.offset});
 #endif
                 }
             }
@@ -1635,6 +1850,7 @@ static void gld_draw_indirect(rhi_device_t * const device, const rhi_draw_params
         }
 
         ++DC->counters.num_api_calls;
+        ++DC->counters.num_draw_calls;
 
         if (draw_mode == GL_LINES) {
             DC->counters.num_tris += elm_count / 2;
@@ -1798,6 +2014,112 @@ static void gld_clear_screen_s(rhi_device_t * const device, const uint8_t s) {
     glc_enable_scissor(DC, old_scissor);
 }
 
+/*
+=======================================
+gl_screenshot_readback_t
+
+Asynchronous screenshots read the back buffer into a ring of pixel pack buffers
+and copy the pixels out once their fence signaled.
+=======================================
+*/
+
+#ifdef GL_ASYNC_READBACK
+enum {
+    // granularity of blocking waits on a readback fence
+    gl_screenshot_wait_timeout_ns = 100 * 1000 * 1000
+};
+
+static void gl_bind_pixel_pack_buffer(gl_context_t * const context, const GLuint b) {
+    glf.glBindBuffer(GL_PIXEL_PACK_BUFFER, b);
+    CHECK_GL_ERRORS();
+    ++context->counters.num_api_calls;
+}
+
+// Maps a finished readback and copies it into its image, flipping the rows on the way since GL reads bottom-up.
+static void gl_resolve_screenshot_readback(gl_context_t * const context, gl_screenshot_readback_t * const readback) {
+    image_t * const image = readback->image;
+
+#ifdef GL_DSA
+    const uint8_t * const pixels = glf.glMapNamedBufferRange(readback->pbo, 0, image->data_len, GL_MAP_READ_BIT);
+#else
+    gl_bind_pixel_pack_buffer(context, readback->pbo);
+    const uint8_t * const pixels = glf.glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, image->data_len, GL_MAP_READ_BIT);
+#endif
+    CHECK_GL_ERRORS();
+    ++context->counters.num_api_calls;
+
+    VERIFY_MSG(pixels, "failed to map screenshot pixel pack buffer");
+
+    uint8_t * const dst = image->data;
+    for (int y = 0; y < image->height; ++y) {
+        memcpy(dst + y * image->pitch, pixels + (image->height - 1 - y) * image->pitch, image->pitch);
+    }
+
+#ifdef GL_DSA
+    glf.glUnmapNamedBuffer(readback->pbo);
+#else
+    glf.glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    gl_bind_pixel_pack_buffer(context, 0);
+#endif
+    CHECK_GL_ERRORS();
+    ++context->counters.num_api_calls;
+}
+
+// Completes the oldest pending readback, returns false if `wait` is false and its fence hasn't signaled yet.
+static bool gl_complete_oldest_screenshot_readback(gl_device_and_context_t * const device, const bool wait) {
+    ASSERT(device->screenshot_ring.num_pending > 0);
+    gl_screenshot_readback_t * const readback = &device->screenshot_ring.readbacks[device->screenshot_ring.head];
+
+    GLenum status;
+    if (wait) {
+        do {
+            status = glf.glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, gl_screenshot_wait_timeout_ns);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    } else {
+        status = glf.glClientWaitSync(readback->fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return false;
+        }
+    }
+    if (status == GL_WAIT_FAILED) {
+        // the map below isn't unsynchronized and waits for the readback on its own, so a failed wait only costs a stall.
+        // drop the error the wait raised so it isn't blamed on a later call.
+        glGetError();
+    }
+    CHECK_GL_ERRORS();
+
+    glf.glDeleteSync(readback->fence);
+    readback->fence = NULL;
+
+    gl_resolve_screenshot_readback(&device->context, readback);
+
+    device->screenshot_ring.head = (device->screenshot_ring.head + 1) % gl_screenshot_ring_size;
+    --device->screenshot_ring.num_pending;
+
+    // the callback may issue another screenshot, so the ring has to be consistent before calling it
+    readback->callback(readback->user, readback->image);
+    return true;
+}
+
+static void gl_poll_screenshot_readbacks(gl_device_and_context_t * const device, const bool wait) {
+    while ((device->screenshot_ring.num_pending > 0) && gl_complete_oldest_screenshot_readback(device, wait)) {
+    }
+}
+
+static void gl_free_screenshot_readbacks(gl_device_and_context_t * const device) {
+    gl_poll_screenshot_readbacks(device, true);
+
+    for (int i = 0; i < gl_screenshot_ring_size; ++i) {
+        gl_screenshot_readback_t * const readback = &device->screenshot_ring.readbacks[i];
+        if (readback->pbo) {
+            glc_delete_buffers(&device->context, 1, &readback->pbo);
+            readback->pbo = 0;
+            readback->pbo_size = 0;
+        }
+    }
+}
+#endif
+
 /*
 =======================================
 gld_present
@@ -1809,6 +2131,9 @@ static void gld_present(rhi_device_t * const device, const rhi_swap_interval_t s
 #ifdef GL_VAOS
     gl_free_vao_chain(DC, &D->vao_pending_destroy_chain, MALLOC_TAG);
 #endif
+#ifdef GL_ASYNC_READBACK
+    gl_poll_screenshot_readbacks(D, false);
+#endif
 }
 
 /*
@@ -1817,7 +2142,7 @@ gld_screenshot
 =======================================
 */
 
-static void gld_screenshot(rhi_device_t * const device, image_t * const out_image, const mem_region_t mem_region) {
+static void gl_init_screenshot_image(rhi_device_t * const device, image_t * const out_image, const mem_region_t mem_region) {
     ZEROMEM(out_image);
 
     out_image->bpp = 4;
@@ -1830,6 +2155,10 @@ static void gld_screenshot(rhi_device_t * const device, image_t * const out_imag
     out_image->data = mem_region.ptr;
 
     ASSERT_MSG((size_t)out_image->data_len <= mem_region.size, "insufficient space for screenshot, size required: %i", out_image->data_len);
+}
+
+static void gld_screenshot(rhi_device_t * const device, image_t * const out_image, const mem_region_t mem_region) {
+    gl_init_screenshot_image(device, out_image, mem_region);
 
 #ifdef GL_CORE
     glReadBuffer(GL_BACK);
@@ -1841,6 +2170,75 @@ static void gld_screenshot(rhi_device_t * const device, image_t * const out_imag
     image_vertical_flip_in_place(out_image);
 }
 
+/*
+=======================================
+gld_screenshot_async
+
+Readbacks are completed in order when polled on present, the render thread only waits
+when the ring is full. Without pixel pack buffers this is a synchronous screenshot.
+=======================================
+*/
+
+static void gld_screenshot_async(rhi_device_t * const device, image_t * const out_image, const mem_region_t mem_region, const rhi_screenshot_callback_t callback, void * const user) {
+#ifdef GL_ASYNC_READBACK
+    gl_init_screenshot_image(device, out_image, mem_region);
+
+    gl_poll_screenshot_readbacks(D, false);
+    if (D->screenshot_ring.num_pending == gl_screenshot_ring_size) {
+        gl_complete_oldest_screenshot_readback(D, true);
+    }
+
+    const int index = (D->screenshot_ring.head + D->screenshot_ring.num_pending) % gl_screenshot_ring_size;
+    gl_screenshot_readback_t * const readback = &D->screenshot_ring.readbacks[index];
+
+    if (!readback->pbo) {
+        glc_gen_buffers(DC, 1, &readback->pbo);
+    }
+
+    gl_bind_pixel_pack_buffer(DC, readback->pbo);
+
+    if (readback->pbo_size != out_image->data_len) {
+        readback->pbo_size = out_image->data_len;
+#ifdef GL_DSA
+        glf.glNamedBufferData(readback->pbo, readback->pbo_size, NULL, GL_STREAM_READ);
+#else
+        glf.glBufferData(GL_PIXEL_PACK_BUFFER, readback->pbo_size, NULL, GL_STREAM_READ);
+#endif
+        CHECK_GL_ERRORS();
+        ++DC->counters.num_api_calls;
+    }
+
+    glReadBuffer(GL_BACK);
+    CHECK_GL_ERRORS();
+    glReadPixels(0, 0, D->display_width, D->display_height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    CHECK_GL_ERRORS();
+
+    gl_bind_pixel_pack_buffer(DC, 0);
+
+    readback->fence = glf.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    CHECK_GL_ERRORS();
+    readback->image = out_image;
+    readback->callback = callback;
+    readback->user = user;
+    ++D->screenshot_ring.num_pending;
+#else
+    gld_screenshot(device, out_image, mem_region);
+    callback(user, out_image);
+#endif
+}
+
+/*
+=======================================
+gld_poll_screenshots
+=======================================
+*/
+
+static void gld_poll_screenshots(rhi_device_t * const device, const bool wait) {
+#ifdef GL_ASYNC_READBACK
+    gl_poll_screenshot_readbacks(D, wait);
+#endif
+}
+
 /*
 =======================================
 gld_read_and_clear_counters
@@ -1935,8 +2333,10 @@ static rhi_mesh_t * gld_create_mesh(rhi_device_t * const device, const rhi_mesh_
         if (channel_layout.usage == rhi_usage_default) {
             ASSERT(channel_data.size);
             glc_static_buffer_storage(DC, GL_ARRAY_BUFFER, vertex_buffer, vertex_buffer_id, channel_data.size, channel_data.ptr);
+        } else if ((channel_layout.usage == rhi_usage_stream) && gl_create_stream_buffer(DC, new_mesh, i, channel_data)) {
+            // written through its mapping from now on, see gld_map_mesh_channel
         } else if (channel_data.size) {
-            ASSERT(channel_layout.usage == rhi_usage_dynamic);
+            ASSERT((channel_layout.usage == rhi_usage_dynamic) || (channel_layout.usage == rhi_usage_stream));
             glc_dynamic_buffer_data(DC, GL_ARRAY_BUFFER, vertex_buffer, vertex_buffer_id, channel_data.size, channel_data.ptr);
         }
 
@@ -2280,6 +2680,8 @@ static rhi_texture_t * gld_create_texture_2d(rhi_device_t * const device, const
     glc_tex_parameter_i(DC, GL_TEXTURE0, texture->target, texture->texture, texture->resource.resource.instance_id, GL_TEXTURE_WRAP_S, get_gl_wrap_mode(sampler_state.u_wrap_mode));
     glc_tex_parameter_i(DC, GL_TEXTURE0, texture->target, texture->texture, texture->resource.resource.instance_id, GL_TEXTURE_WRAP_T, get_gl_wrap_mode(sampler_state.v_wrap_mode));
 #endif
+    texture->sampler_state = sampler_state;
+    texture->has_sampler_state = true;
 
     return (rhi_texture_t *)texture;
 }
@@ -2306,12 +2708,15 @@ static const rhi_device_vtable_t gl_rhi_device_vtable = {
     .thread_device_done_current = gld_thread_device_done_current,
     .upload_mesh_channel_data = gld_upload_mesh_channel_data,
     .upload_mesh_indices = gld_upload_mesh_indices,
+    .map_mesh_channel = gld_map_mesh_channel,
+    .fence_mesh_stream = gld_fence_mesh_stream,
     .upload_uniform_data = gld_upload_uniform_data,
     .upload_texture = gld_upload_texture,
     .upload_sub_texture = gld_upload_sub_texture,
     .set_display_size = gld_set_display_size,
     .set_viewport = gld_set_viewport,
     .set_scissor_rect = gld_set_scissor_rect,
+    .set_clip_rect = gld_set_clip_rect,
     .set_program = gld_set_program,
     .set_render_state = gld_set_render_state,
     .set_render_target_color_buffer = gld_set_render_target_color_buffer,
@@ -2330,6 +2735,8 @@ static const rhi_device_vtable_t gl_rhi_device_vtable = {
     .clear_screen_s = gld_clear_screen_s,
     .present = gld_present,
     .screenshot = gld_screenshot,
+    .screenshot_async = gld_screenshot_async,
+    .poll_screenshots = gld_poll_screenshots,
     .read_and_clear_counters = gld_read_and_clear_counters,
     .create_mesh_data_layout = gld_create_mesh_data_layout,
     .create_mesh = gld_create_mesh,
@@ -2375,6 +2782,10 @@ static int gl_device_release(rhi_resource_t * const resource, const char * const
         CHECK_GL_ERRORS();
         gl_free_vao_chain(&device->context, &device->vao_pending_destroy_chain, tag);
         CHECK_GL_ERRORS();
+#endif
+#ifdef GL_ASYNC_READBACK
+        gl_free_screenshot_readbacks(device);
+        CHECK_GL_ERRORS();
 #endif
         glc_destroy(&device->context, tag);
         CHECK_GL_ERRORS();
@@ -231,6 +231,17 @@ Encapsulates a rendering context's current opengl pipeline state
 =======================================
 */
 
+#ifndef GL_VAOS
+typedef struct gl_vertex_attrib_t {
+    int buffer_id;
+    GLint count;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei stride;
+    size_t offset;
+} gl_vertex_attrib_t;
+#endif
+
 struct gl_blend_state_t;
 struct gl_depth_stencil_state_t;
 struct gl_rasterizer_state_t;
@@ -249,6 +260,9 @@ typedef struct gl_context_t {
     int textures[rhi_program_num_textures];
 #endif
     int texture_ids[rhi_program_num_textures];
+#ifdef GL_CORE
+    GLuint samplers[rhi_program_num_textures];
+#endif
     struct gl_uniform_buffer_t * ubuffers[rhi_program_num_uniforms];
     rhi_rasterizer_state_desc_t rs_desc;
     rhi_depth_stencil_state_desc_t dss_desc;
@@ -276,10 +290,22 @@ typedef struct gl_context_t {
 #endif
     gl_rect_t viewport;
     gl_rect_t scissor;
+    // dirty region clip in window coordinates, intersected with the scissor and kept enabled while set
+    struct {
+        gl_rect_t rect;
+        bool enabled;
+    } clip;
+    // the scissor box and test last sent to GL, differ from scissor/rs_desc while clipping
+    gl_rect_t gl_scissor;
+    bool gl_scissor_test;
     rhi_cull_face_e cull_mode;
     rhi_swap_interval_t swap_interval;
 #ifdef GL_VAOS
     int active_vao;
+#else
+    // vertex attribute arrays as last specified to GL, one bit per enabled array
+    uint32_t vertex_attrib_mask;
+    gl_vertex_attrib_t vertex_attribs[rhi_program_input_num_semantics];
 #endif
 #if !(defined(GL_DSA) && defined(GL_VAOS))
     int array_buffer;
@@ -298,6 +324,22 @@ struct gl_render_target_t;
 struct gl_vao_t;
 #endif
 
+#ifdef GL_ASYNC_READBACK
+enum {
+    // screenshots that can be in flight before a new one waits on the oldest
+    gl_screenshot_ring_size = 3
+};
+
+typedef struct gl_screenshot_readback_t {
+    GLuint pbo;
+    GLsizeiptr pbo_size;
+    GLsync fence;
+    image_t * image;
+    rhi_screenshot_callback_t callback;
+    void * user;
+} gl_screenshot_readback_t;
+#endif
+
 typedef struct gl_device_and_context_t {
     rhi_device_t device;
     gl_context_t context;
@@ -305,6 +347,14 @@ typedef struct gl_device_and_context_t {
 #ifdef GL_VAOS
     struct gl_vao_t * vao_used_chain;
     struct gl_vao_t * vao_pending_destroy_chain;
+#endif
+#ifdef GL_ASYNC_READBACK
+    // pixel pack buffers read back in order, the oldest pending one is at `head`
+    struct {
+        gl_screenshot_readback_t readbacks[gl_screenshot_ring_size];
+        int head;
+        int num_pending;
+    } screenshot_ring;
 #endif
     int display_width;
     int display_height;
@@ -341,6 +391,9 @@ typedef struct gl_texture_t {
 #ifdef GL_ES
     bool mipmaps;
 #endif
+    // sampler parameters last sent to GL, valid once `has_sampler_state` is set
+    rhi_sampler_state_desc_t sampler_state;
+    bool has_sampler_state;
     void * user; // for starboard usage
 } gl_texture_t;
 
@@ -378,6 +431,8 @@ static inline void glc_bind_buffer(gl_context_t * const context, const GLenum ta
                 GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, b));
                 CHECK_GL_ERRORS();
                 ++context->counters.num_api_calls;
+            } else {
+                ++context->counters.num_redundant_api_calls;
             }
         } break;
         case GL_ELEMENT_ARRAY_BUFFER: {
@@ -386,6 +441,8 @@ static inline void glc_bind_buffer(gl_context_t * const context, const GLenum ta
                 GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, b));
                 CHECK_GL_ERRORS();
                 ++context->counters.num_api_calls;
+            } else {
+                ++context->counters.num_redundant_api_calls;
             }
         } break;
 #ifdef GL_CORE
@@ -395,6 +452,8 @@ static inline void glc_bind_buffer(gl_context_t * const context, const GLenum ta
                 glf.glBindBuffer(GL_UNIFORM_BUFFER, b);
                 CHECK_GL_ERRORS();
                 ++context->counters.num_api_calls;
+            } else {
+                ++context->counters.num_redundant_api_calls;
             }
         } break;
 #endif
@@ -582,6 +641,15 @@ static inline void glc_gen_samplers(gl_context_t * const context, const int coun
 static inline void glc_delete_samplers(gl_context_t * const context, const int count, GLuint * const samplers) {
     glf.glDeleteSamplers(count, samplers);
 
+    // GL unbinds deleted samplers, and may hand their names out again
+    for (int i = 0; i < count; ++i) {
+        for (int unit = 0; unit < rhi_program_num_textures; ++unit) {
+            if (context->samplers[unit] == samplers[i]) {
+                context->samplers[unit] = 0;
+            }
+        }
+    }
+
     CHECK_GL_ERRORS();
     ++context->counters.num_api_calls;
 }
@@ -629,6 +697,7 @@ static inline void glc_bind_texture(gl_context_t * const context, const GLenum t
 #ifdef GL_DSA
         glf.glBindTextureUnit(idx, texture);
         CHECK_GL_ERRORS();
+        ++context->counters.num_api_calls;
 #else
         if (context->active_texture != texture_unit) {
             context->active_texture = texture_unit;
@@ -640,8 +709,24 @@ static inline void glc_bind_texture(gl_context_t * const context, const GLenum t
         CHECK_GL_ERRORS();
         ++context->counters.num_api_calls;
 #endif
+    } else {
+        ++context->counters.num_redundant_api_calls;
+    }
+}
+
+#ifdef GL_CORE
+static inline void glc_bind_sampler(gl_context_t * const context, const int unit, const GLuint sampler) {
+    ASSERT((unit >= 0) && (unit < rhi_program_num_textures));
+    if (context->samplers[unit] != sampler) {
+        context->samplers[unit] = sampler;
+        glf.glBindSampler(unit, sampler);
+        CHECK_GL_ERRORS();
+        ++context->counters.num_api_calls;
+    } else {
+        ++context->counters.num_redundant_api_calls;
     }
 }
+#endif
 
 static inline void glc_tex_parameter_i(gl_context_t * const context, const GLenum tunit, const GLenum target, const GLuint texture, const int id, const GLenum pname, const GLint param) {
 #ifdef GL_DSA
@@ -738,9 +823,46 @@ static inline void glc_bind_vertex_array(gl_context_t * const context, const GLu
         context->active_vao = vaid;
         glf.glBindVertexArray(va);
         ++context->counters.num_api_calls;
+    } else {
+        ++context->counters.num_redundant_api_calls;
     }
     CHECK_GL_ERRORS();
 }
+#else
+// Enables exactly the vertex attribute arrays in `mask`
+static inline void glc_enable_vertex_attribs(gl_context_t * const context, const uint32_t mask) {
+    const uint32_t changed = context->vertex_attrib_mask ^ mask;
+    for (int i = 0; i < rhi_program_input_num_semantics; ++i) {
+        const uint32_t bit = 1u << i;
+        if (changed & bit) {
+            if (mask & bit) {
+                GL_CALL(glEnableVertexAttribArray(i));
+            } else {
+                GL_CALL(glDisableVertexAttribArray(i));
+            }
+            CHECK_GL_ERRORS();
+            ++context->counters.num_api_calls;
+        } else {
+            ++context->counters.num_redundant_api_calls;
+        }
+    }
+    context->vertex_attrib_mask = mask;
+}
+
+// Points an attribute array into the bound GL_ARRAY_BUFFER, which must be `buffer_id`
+static inline void glc_vertex_attrib_pointer(gl_context_t * const context, const int index, const gl_vertex_attrib_t attrib) {
+    ASSERT((index >= 0) && (index < rhi_program_input_num_semantics));
+    ASSERT(context->array_buffer == attrib.buffer_id);
+    gl_vertex_attrib_t * const current = &context->vertex_attribs[index];
+    if ((current->buffer_id != attrib.buffer_id) || (current->count != attrib.count) || (current->type != attrib.type) || (current->normalized != attrib.normalized) || (current->stride != attrib.stride) || (current->offset != attrib.offset)) {
+        *current = attrib;
+        GL_CALL(glVertexAttribPointer(index, attrib.count, attrib.type, attrib.normalized, attrib.stride, (const void *)attrib.offset));
+        CHECK_GL_ERRORS();
+        ++context->counters.num_api_calls;
+    } else {
+        ++context->counters.num_redundant_api_calls;
+    }
+}
 #endif
 
 static inline void glc_gen_framebuffers(gl_context_t * const context, const int size, GLuint * const out_fbs) {
@@ -785,6 +907,8 @@ static inline void glc_bind_framebuffer(gl_context_t * const context, const GLen
         }
         CHECK_GL_ERRORS();
         ++context->counters.num_api_calls;
+    } else {
+        ++context->counters.num_redundant_api_calls;
     }
 #else // GL_ES
     ASSERT(target == GL_FRAMEBUFFER);
@@ -797,6 +921,8 @@ static inline void glc_bind_framebuffer(gl_context_t * const context, const GLen
 
         CHECK_GL_ERRORS();
         ++context->counters.num_api_calls;
+    } else {
+        ++context->counters.num_redundant_api_calls;
     }
 #endif
 }
@@ -905,15 +1031,51 @@ static inline void glc_discard_framebuffer(gl_context_t * const context, GLenum
 #endif
 }
 
+// Sends the scissor state to GL, restricted to the clip rect when one is set
+static inline void glc_apply_scissor(gl_context_t * const context) {
+    gl_rect_t box = context->scissor;
+    bool test = context->rs_desc.scissor_test;
+
+    if (context->clip.enabled) {
+        const gl_rect_t clip = context->clip.rect;
+        if (test) {
+            const GLint x0 = (box.x1 > clip.x1) ? box.x1 : clip.x1;
+            const GLint y0 = (box.y1 > clip.y1) ? box.y1 : clip.y1;
+            const GLint x1 = ((box.x1 + box.x2) < (clip.x1 + clip.x2)) ? (box.x1 + box.x2) : (clip.x1 + clip.x2);
+            const GLint y1 = ((box.y1 + box.y2) < (clip.y1 + clip.y2)) ? (box.y1 + box.y2) : (clip.y1 + clip.y2);
+            box = (gl_rect_t){x0, y0, (x1 > x0) ? x1 - x0 : 0, (y1 > y0) ? y1 - y0 : 0};
+        } else {
+            box = clip;
+        }
+        test = true;
+    }
+
+    if (context->gl_scissor_test != test) {
+        context->gl_scissor_test = test;
+        if (test) {
+            glEnable(GL_SCISSOR_TEST);
+        } else {
+            glDisable(GL_SCISSOR_TEST);
+        }
+        CHECK_GL_ERRORS();
+        ++context->counters.num_api_calls;
+    }
+
+    if ((context->gl_scissor.x1 != box.x1) || (context->gl_scissor.y1 != box.y1) || (context->gl_scissor.x2 != box.x2) || (context->gl_scissor.y2 != box.y2)) {
+        context->gl_scissor = box;
+        glScissor(box.x1, box.y1, box.x2, box.y2);
+        CHECK_GL_ERRORS();
+        ++context->counters.num_api_calls;
+    }
+}
+
 static inline void glc_scissor(gl_context_t * const context, const GLint x, const GLint y, const GLsizei w, const GLsizei h) {
     if ((context->scissor.x1 != x) || (context->scissor.y1 != y) || (context->scissor.x2 != w) || (context->scissor.y2 != h)) {
         context->scissor.x1 = x;
         context->scissor.y1 = y;
         context->scissor.x2 = w;
         context->scissor.y2 = h;
-        glScissor(x, y, w, h);
-        CHECK_GL_ERRORS();
-        ++context->counters.num_api_calls;
+        glc_apply_scissor(context);
     }
 }
 
@@ -926,6 +1088,8 @@ static inline void glc_viewport(gl_context_t * const context, const GLint x, con
         glViewport(x, y, w, h);
         CHECK_GL_ERRORS();
         ++context->counters.num_api_calls;
+    } else {
+        ++context->counters.num_redundant_api_calls;
     }
 }
 
@@ -978,12 +1142,7 @@ static inline void glc_depth_mask(gl_context_t * const context, const bool mask)
 static inline void glc_enable_scissor(gl_context_t * const context, const bool enabled) {
     if (context->rs_desc.scissor_test != enabled) {
         context->rs_desc.scissor_test = enabled;
-        if (enabled) {
-            glEnable(GL_SCISSOR_TEST);
-        } else {
-            glDisable(GL_SCISSOR_TEST);
-        }
-        CHECK_GL_ERRORS();
+        glc_apply_scissor(context);
     }
 }
 
@@ -6,29 +6,17 @@
 
 #include "source/adk/telemetry/telemetry.h"
 
+#ifdef _TELEMETRY
+
 #include "source/adk/log/log.h"
 #include "source/adk/runtime/app/app.h"
 #include "source/adk/runtime/memory.h"
 #include "source/adk/runtime/runtime.h"
 #include "source/adk/steamboat/sb_platform.h"
+#include "source/adk/telemetry/private/telemetry_p.h"
 
 #include <stdint.h>
 
-#define TAG_TELEMETRY FOURCC(' ', 'T', 'L', 'M')
-
-enum {
-    telemetry_region_size = 8 * 1024 * 1024,
-};
-
-static struct {
-    mem_region_t telemetry_region;
-#ifdef GUARD_PAGE_SUPPORT
-    mem_region_t guard_pages;
-#endif
-} statics;
-
-typedef uint64_t telemetry_capture_mask_t;
-
 typedef struct telemetry_system_name_to_mask_t {
     const char * name;
     telemetry_capture_mask_t mask;
@@ -62,36 +50,38 @@ static const telemetry_system_name_to_mask_t telemetry_system_name_to_mask_dicti
     {"gfx", RHI_TRACE_MASK},
 };
 
-static void telemetry_set_capture_mask(const char * const telemetry_groups) {
+telemetry_capture_mask_t telemetry_parse_capture_mask(const char * const telemetry_groups) {
     static const char * const delimiters = ", ";
 
-    if (telemetry_groups != NULL) {
-        telemetry_capture_mask_t capture_mask = 0;
-
-        const char * p = telemetry_groups;
-        while (*p != '\0') {
-            const size_t length = strcspn(p, delimiters);
-
-            for (size_t i = 0; i < ARRAY_SIZE(telemetry_system_name_to_mask_dictionary); ++i) {
-                const telemetry_system_name_to_mask_t * const name_to_mask = &telemetry_system_name_to_mask_dictionary[i];
-                if (strlen(name_to_mask->name) == length && memcmp(name_to_mask->name, p, length) == 0) {
-                    capture_mask |= name_to_mask->mask;
-                    break;
-                }
-            }
+    telemetry_capture_mask_t capture_mask = 0;
+
+    const char * p = telemetry_groups;
+    while (*p != '\0') {
+        const size_t length = strcspn(p, delimiters);
 
-            p += length;
-            p += strspn(p, delimiters);
+        for (size_t i = 0; i < ARRAY_SIZE(telemetry_system_name_to_mask_dictionary); ++i) {
+            const telemetry_system_name_to_mask_t * const name_to_mask = &telemetry_system_name_to_mask_dictionary[i];
+            if (strlen(name_to_mask->name) == length && memcmp(name_to_mask->name, p, length) == 0) {
+                capture_mask |= name_to_mask->mask;
+                break;
+            }
         }
 
-        tmSetCaptureMask(capture_mask);
+        p += length;
+        p += strspn(p, delimiters);
     }
+
+    return capture_mask;
 }
 
 void telemetry_print_help() {
     debug_write_line("\nCore telemetry:");
 
+#ifdef _TELEMETRY_TRACE
+    debug_write_line("\t--telemetry-file <trace file name, relative to the cache directory>");
+#else
     debug_write_line("\t--telemetry-server <IP:port>");
+#endif
     debug_write_line("\t--telemetry <comma-delimited list of systems>");
 
     debug_write_line("\n\tTelemetry systems:");
@@ -102,6 +92,25 @@ void telemetry_print_help() {
     }
 }
 
+#ifndef _TELEMETRY_TRACE
+
+enum {
+    telemetry_region_size = 8 * 1024 * 1024,
+};
+
+static struct {
+    mem_region_t telemetry_region;
+#ifdef GUARD_PAGE_SUPPORT
+    mem_region_t guard_pages;
+#endif
+} statics;
+
+static void telemetry_set_capture_mask(const char * const telemetry_groups) {
+    if (telemetry_groups != NULL) {
+        tmSetCaptureMask(telemetry_parse_capture_mask(telemetry_groups));
+    }
+}
+
 void telemetry_init(const char * const address, const int port, const char * const telemetry_groups) {
     {
         const size_t needed = ALIGN_INT(telemetry_region_size, 8);
@@ -186,3 +195,7 @@ void app_telemetry_span_begin(const uint64_t id, const char * const str) {
 void app_telemetry_span_end(const uint64_t id) {
     tmEndTimeSpan(APP_TRACE_MASK, (tm_uint64)id);
 }
+
+#endif // _TELEMETRY_TRACE
+
+#endif // _TELEMETRY
@@ -0,0 +1,30 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+private/telemetry_p.h
+
+Private API shared by the telemetry backends
+*/
+
+#pragma once
+
+#include "source/adk/runtime/runtime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TAG_TELEMETRY FOURCC(' ', 'T', 'L', 'M')
+
+typedef uint64_t telemetry_capture_mask_t;
+
+// Parses a comma or space delimited list of telemetry systems (see telemetry_print_help), unknown names are ignored.
+telemetry_capture_mask_t telemetry_parse_capture_mask(const char * const telemetry_groups);
+
+#ifdef __cplusplus
+}
+#endif
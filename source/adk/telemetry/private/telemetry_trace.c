@@ -0,0 +1,460 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+private/telemetry_trace.c
+
+Built-in trace capture backend for the telemetry macros
+*/
+
+#include "source/adk/telemetry/telemetry.h"
+
+#if defined(_TELEMETRY) && defined(_TELEMETRY_TRACE)
+
+#include "source/adk/log/log.h"
+#include "source/adk/runtime/memory.h"
+#include "source/adk/steamboat/sb_file.h"
+#include "source/adk/steamboat/sb_platform.h"
+#include "source/adk/telemetry/private/telemetry_p.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+
+enum {
+    // events per thread, must be a power of two
+    telemetry_trace_ring_size = 4096,
+    telemetry_trace_max_threads = 32,
+    // copied names and formatted span names are truncated to this length
+    telemetry_trace_max_text_length = 36,
+    telemetry_trace_write_buffer_size = 64 * 1024,
+    telemetry_trace_drain_interval_ms = 10,
+    // the JSON fields of an event without its name
+    telemetry_trace_max_event_overhead = 192,
+    telemetry_trace_cache_line_size = 64,
+};
+
+STATIC_ASSERT((telemetry_trace_ring_size & (telemetry_trace_ring_size - 1)) == 0);
+
+typedef enum telemetry_trace_event_type_e {
+    telemetry_trace_event_push,
+    telemetry_trace_event_pop,
+    telemetry_trace_event_span_begin,
+    telemetry_trace_event_span_end,
+    telemetry_trace_event_tick,
+    telemetry_trace_event_counter,
+    telemetry_trace_event_thread_name,
+} telemetry_trace_event_type_e;
+
+typedef struct telemetry_trace_event_t {
+    uint64_t time;
+    // span id or counter value
+    uint64_t value;
+    // names that outlive the capture are stored by address, NULL if the name was copied to `text`
+    const char * name;
+    int32_t type;
+    char text[telemetry_trace_max_text_length];
+} telemetry_trace_event_t;
+
+// Single producer ring: `head` is only written by the recording thread, `tail` only by the writer thread.
+typedef struct telemetry_trace_thread_t {
+    sb_atomic_int32_t head;
+    sb_atomic_int32_t tail;
+    // events lost because the writer fell behind
+    sb_atomic_int32_t num_dropped;
+    telemetry_trace_event_t events[telemetry_trace_ring_size];
+} telemetry_trace_thread_t;
+
+// Counts threads writing into a ring, kept outside of the mapped rings so telemetry_shutdown can wait on it before unmapping them.
+// A count rather than a flag since a thread left over from a previous capture may briefly touch the slot of the new owner.
+// Padded so recording threads don't share cache lines.
+typedef struct telemetry_trace_recorder_t {
+    sb_atomic_int32_t num_recording;
+    uint8_t pad[telemetry_trace_cache_line_size - sizeof(sb_atomic_int32_t)];
+} telemetry_trace_recorder_t;
+
+sb_atomic_int32_t telemetry_trace_capture_mask;
+
+static struct {
+    mem_region_t region;
+#ifdef GUARD_PAGE_SUPPORT
+    mem_region_t guard_pages;
+#endif
+    telemetry_trace_thread_t * threads;
+    // threads that recorded an event, may exceed telemetry_trace_max_threads
+    sb_atomic_int32_t num_threads;
+    // bumped by each telemetry_init so threads claim a new ring after a restart
+    sb_atomic_int32_t generation;
+    // set by telemetry_shutdown, threads that already passed the capture mask check back out instead of recording
+    sb_atomic_int32_t is_stopping;
+    telemetry_trace_recorder_t recorders[telemetry_trace_max_threads];
+
+    sb_thread_id_t writer_thread;
+    sb_atomic_int32_t should_quit;
+
+    sb_file_t * file;
+    uint64_t start_time;
+    int buffer_size;
+    char buffer[telemetry_trace_write_buffer_size];
+} statics;
+
+static THREAD_LOCAL telemetry_trace_thread_t * telemetry_trace_current_thread;
+static THREAD_LOCAL int32_t telemetry_trace_current_generation;
+static THREAD_LOCAL int32_t telemetry_trace_current_index;
+
+/*
+===============================================================================
+Recording
+===============================================================================
+*/
+
+static telemetry_trace_thread_t * telemetry_trace_get_thread() {
+    const int32_t generation = sb_atomic_load(&statics.generation, memory_order_acquire);
+    if (telemetry_trace_current_generation != generation) {
+        telemetry_trace_current_generation = generation;
+        const int index = sb_atomic_fetch_add(&statics.num_threads, 1, memory_order_relaxed);
+        // threads past the limit are not captured
+        telemetry_trace_current_thread = (index < telemetry_trace_max_threads) ? &statics.threads[index] : NULL;
+        telemetry_trace_current_index = index;
+    }
+    return telemetry_trace_current_thread;
+}
+
+static telemetry_trace_event_t * telemetry_trace_begin_event(const telemetry_trace_event_type_e type) {
+    telemetry_trace_thread_t * const thread = telemetry_trace_get_thread();
+    if (!thread) {
+        return NULL;
+    }
+
+    // pairs with telemetry_shutdown: either it sees this thread recording and waits, or this thread sees it stopping.
+    // A thread that last recorded before a restart still holds a ring of the unmapped capture, telemetry_init clears
+    // `is_stopping` only after bumping the generation so the generation check catches it.
+    telemetry_trace_recorder_t * const recorder = &statics.recorders[telemetry_trace_current_index];
+    sb_atomic_fetch_add(&recorder->num_recording, 1, memory_order_seq_cst);
+    if (sb_atomic_load(&statics.is_stopping, memory_order_seq_cst) || (sb_atomic_load(&statics.generation, memory_order_seq_cst) != telemetry_trace_current_generation)) {
+        sb_atomic_fetch_add(&recorder->num_recording, -1, memory_order_release);
+        return NULL;
+    }
+
+    const int32_t head = sb_atomic_load(&thread->head, memory_order_relaxed);
+    if ((uint32_t)(head - sb_atomic_load(&thread->tail, memory_order_acquire)) >= telemetry_trace_ring_size) {
+        sb_atomic_fetch_add(&thread->num_dropped, 1, memory_order_relaxed);
+        sb_atomic_fetch_add(&recorder->num_recording, -1, memory_order_release);
+        return NULL;
+    }
+
+    telemetry_trace_event_t * const event = &thread->events[head & (telemetry_trace_ring_size - 1)];
+    event->time = sb_read_nanosecond_clock().ns;
+    event->value = 0;
+    event->name = NULL;
+    event->type = type;
+    event->text[0] = '\0';
+    return event;
+}
+
+static void telemetry_trace_copy_text(telemetry_trace_event_t * const event, const char * const text) {
+    // truncates
+    snprintf(event->text, ARRAY_SIZE(event->text), "%s", text);
+}
+
+static void telemetry_trace_end_event() {
+    telemetry_trace_thread_t * const thread = telemetry_trace_current_thread;
+    sb_atomic_store(&thread->head, sb_atomic_load(&thread->head, memory_order_relaxed) + 1, memory_order_release);
+    sb_atomic_fetch_add(&statics.recorders[telemetry_trace_current_index].num_recording, -1, memory_order_release);
+}
+
+void telemetry_trace_record_push(const char * const name) {
+    telemetry_trace_event_t * const event = telemetry_trace_begin_event(telemetry_trace_event_push);
+    if (event) {
+        event->name = name;
+        telemetry_trace_end_event();
+    }
+}
+
+void telemetry_trace_record_push_copy(const char * const name) {
+    telemetry_trace_event_t * const event = telemetry_trace_begin_event(telemetry_trace_event_push);
+    if (event) {
+        telemetry_trace_copy_text(event, name);
+        telemetry_trace_end_event();
+    }
+}
+
+void telemetry_trace_record_pop() {
+    if (telemetry_trace_begin_event(telemetry_trace_event_pop)) {
+        telemetry_trace_end_event();
+    }
+}
+
+void telemetry_trace_record_tick() {
+    if (telemetry_trace_begin_event(telemetry_trace_event_tick)) {
+        telemetry_trace_end_event();
+    }
+}
+
+void telemetry_trace_record_thread_name(const char * const name) {
+    telemetry_trace_event_t * const event = telemetry_trace_begin_event(telemetry_trace_event_thread_name);
+    if (event) {
+        telemetry_trace_copy_text(event, name);
+        telemetry_trace_end_event();
+    }
+}
+
+void telemetry_trace_record_counter(const char * const name, const uint64_t value) {
+    telemetry_trace_event_t * const event = telemetry_trace_begin_event(telemetry_trace_event_counter);
+    if (event) {
+        telemetry_trace_copy_text(event, name ? name : "counter");
+        event->value = value;
+        telemetry_trace_end_event();
+    }
+}
+
+void telemetry_trace_record_span_begin(const uint64_t id, const char * const format, ...) {
+    telemetry_trace_event_t * const event = telemetry_trace_begin_event(telemetry_trace_event_span_begin);
+    if (event) {
+        va_list args;
+        va_start(args, format);
+        vsnprintf(event->text, ARRAY_SIZE(event->text), format, args);
+        va_end(args);
+        event->value = id;
+        telemetry_trace_end_event();
+    }
+}
+
+void telemetry_trace_record_span_end(const uint64_t id) {
+    telemetry_trace_event_t * const event = telemetry_trace_begin_event(telemetry_trace_event_span_end);
+    if (event) {
+        event->value = id;
+        telemetry_trace_end_event();
+    }
+}
+
+/*
+===============================================================================
+Chrome Trace Event JSON writer
+===============================================================================
+*/
+
+static void telemetry_trace_flush() {
+    if (statics.buffer_size > 0) {
+        sb_fwrite(statics.buffer, 1, (size_t)statics.buffer_size, statics.file);
+        statics.buffer_size = 0;
+    }
+}
+
+static void telemetry_trace_write(const char * const format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(statics.buffer + statics.buffer_size, (size_t)(telemetry_trace_write_buffer_size - statics.buffer_size), format, args);
+    va_end(args);
+    ASSERT(length >= 0);
+    statics.buffer_size = min_int(statics.buffer_size + length, telemetry_trace_write_buffer_size - 1);
+}
+
+static void telemetry_trace_write_string(const char * const str) {
+    // names are short, escaping stays well inside the per event reserve
+    char * out = statics.buffer + statics.buffer_size;
+    *out++ = '"';
+    for (const char * p = str; *p != '\0'; ++p) {
+        const unsigned char c = (unsigned char)*p;
+        if ((c == '"') || (c == '\\')) {
+            *out++ = '\\';
+            *out++ = (char)c;
+        } else if (c >= 0x20) {
+            *out++ = (char)c;
+        }
+    }
+    *out++ = '"';
+    statics.buffer_size = (int)(out - statics.buffer);
+}
+
+static void telemetry_trace_write_event(const int tid, const telemetry_trace_event_t * const event) {
+    const char * const name = event->name ? event->name : event->text;
+    const size_t name_reserve = (event->name ? strlen(event->name) : telemetry_trace_max_text_length) * 2;
+    if ((size_t)statics.buffer_size + name_reserve + telemetry_trace_max_event_overhead >= telemetry_trace_write_buffer_size) {
+        telemetry_trace_flush();
+    }
+
+    // timestamps are in microseconds
+    const uint64_t time = event->time - statics.start_time;
+    const uint64_t us = time / 1000;
+    const unsigned int ns = (unsigned int)(time % 1000);
+
+    switch ((telemetry_trace_event_type_e)event->type) {
+        case telemetry_trace_event_push:
+            telemetry_trace_write(",\n{\"ph\":\"B\",\"pid\":1,\"tid\":%i,\"ts\":%" PRIu64 ".%03u,\"name\":", tid, us, ns);
+            telemetry_trace_write_string(name);
+            telemetry_trace_write("}");
+            break;
+        case telemetry_trace_event_pop:
+            telemetry_trace_write(",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%i,\"ts\":%" PRIu64 ".%03u}", tid, us, ns);
+            break;
+        case telemetry_trace_event_span_begin:
+            telemetry_trace_write(",\n{\"ph\":\"b\",\"cat\":\"span\",\"id\":\"0x%" PRIx64 "\",\"pid\":1,\"tid\":%i,\"ts\":%" PRIu64 ".%03u,\"name\":", event->value, tid, us, ns);
+            telemetry_trace_write_string(name);
+            telemetry_trace_write("}");
+            break;
+        case telemetry_trace_event_span_end:
+            telemetry_trace_write(",\n{\"ph\":\"e\",\"cat\":\"span\",\"id\":\"0x%" PRIx64 "\",\"pid\":1,\"tid\":%i,\"ts\":%" PRIu64 ".%03u}", event->value, tid, us, ns);
+            break;
+        case telemetry_trace_event_tick:
+            telemetry_trace_write(",\n{\"ph\":\"i\",\"s\":\"g\",\"name\":\"tick\",\"pid\":1,\"tid\":%i,\"ts\":%" PRIu64 ".%03u}", tid, us, ns);
+            break;
+        case telemetry_trace_event_counter:
+            telemetry_trace_write(",\n{\"ph\":\"C\",\"pid\":1,\"tid\":%i,\"ts\":%" PRIu64 ".%03u,\"args\":{\"value\":%" PRIu64 "},\"name\":", tid, us, ns, event->value);
+            telemetry_trace_write_string(name);
+            telemetry_trace_write("}");
+            break;
+        case telemetry_trace_event_thread_name:
+            telemetry_trace_write(",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":", tid);
+            telemetry_trace_write_string(name);
+            telemetry_trace_write("}}");
+            break;
+        default:
+            TRAP("unknown trace event type [%i]", event->type);
+    }
+}
+
+static void telemetry_trace_drain() {
+    const int num_threads = min_int(sb_atomic_load(&statics.num_threads, memory_order_acquire), telemetry_trace_max_threads);
+    for (int i = 0; i < num_threads; ++i) {
+        telemetry_trace_thread_t * const thread = &statics.threads[i];
+        const int32_t head = sb_atomic_load(&thread->head, memory_order_acquire);
+        int32_t tail = sb_atomic_load(&thread->tail, memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            telemetry_trace_write_event(i + 1, &thread->events[tail & (telemetry_trace_ring_size - 1)]);
+        }
+        sb_atomic_store(&thread->tail, tail, memory_order_release);
+    }
+    telemetry_trace_flush();
+}
+
+static int telemetry_trace_writer_thread_proc(void * const arg) {
+    (void)arg;
+    while (!sb_atomic_load(&statics.should_quit, memory_order_acquire)) {
+        telemetry_trace_drain();
+        sb_thread_sleep((milliseconds_t){telemetry_trace_drain_interval_ms});
+    }
+    return 0;
+}
+
+/*
+===============================================================================
+Capture control
+===============================================================================
+*/
+
+void telemetry_init(const char * const trace_file_name, const char * const telemetry_groups) {
+    ASSERT(statics.file == NULL);
+
+    statics.file = sb_fopen(sb_app_cache_directory, trace_file_name, "wb");
+    if (!statics.file) {
+        LOG_ERROR(TAG_TELEMETRY, "Failed to open the trace file [%s]", trace_file_name);
+        return;
+    }
+
+    {
+        const size_t page_size = get_sys_page_size();
+        const size_t block_size = ALIGN_INT(sizeof(telemetry_trace_thread_t) * telemetry_trace_max_threads, page_size);
+#ifdef GUARD_PAGE_SUPPORT
+        const size_t total_size = block_size + page_size * 2;
+
+        statics.guard_pages = debug_sys_map_pages(total_size, system_page_protect_no_access, MALLOC_TAG);
+        VERIFY(statics.guard_pages.ptr);
+
+        const uintptr_t uptr = statics.guard_pages.adr;
+        statics.region = MEM_REGION(.adr = uptr + page_size, .size = block_size);
+        debug_sys_protect_pages(statics.region, system_page_protect_read_write);
+#else
+        statics.region = sb_map_pages(block_size, system_page_protect_read_write);
+        VERIFY(statics.region.ptr);
+#endif
+        // fresh pages are zeroed, every ring starts out empty
+        statics.threads = (telemetry_trace_thread_t *)statics.region.ptr;
+    }
+
+    statics.start_time = sb_read_nanosecond_clock().ns;
+    statics.buffer_size = 0;
+    telemetry_trace_write("{\"traceEvents\":[\n{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"m5\"}}");
+
+    const telemetry_capture_mask_t groups = telemetry_groups ? telemetry_parse_capture_mask(telemetry_groups) : ~(telemetry_capture_mask_t)0;
+
+    sb_atomic_store(&statics.num_threads, 0, memory_order_relaxed);
+    sb_atomic_store(&statics.should_quit, 0, memory_order_relaxed);
+    sb_atomic_fetch_add(&statics.generation, 1, memory_order_seq_cst);
+    sb_atomic_store(&statics.is_stopping, 0, memory_order_seq_cst);
+
+    statics.writer_thread = sb_create_thread("telemetry", sb_thread_default_options, telemetry_trace_writer_thread_proc, NULL, MALLOC_TAG);
+
+    sb_atomic_store(&telemetry_trace_capture_mask, (int32_t)(groups | telemetry_trace_capturing_mask), memory_order_release);
+
+    LOG_ALWAYS(TAG_TELEMETRY, "telemetry (built-in trace capture) is enabled and writing to [%s]", trace_file_name);
+}
+
+void telemetry_shutdown() {
+    if (!statics.file) {
+        return;
+    }
+
+    sb_atomic_store(&telemetry_trace_capture_mask, 0, memory_order_release);
+    sb_atomic_store(&statics.is_stopping, 1, memory_order_seq_cst);
+    sb_atomic_store(&statics.should_quit, 1, memory_order_release);
+    sb_join_thread(statics.writer_thread);
+
+    // threads that checked the capture mask before it was cleared may still be writing an event
+    const int num_rings = min_int(sb_atomic_load(&statics.num_threads, memory_order_acquire), telemetry_trace_max_threads);
+    for (int i = 0; i < num_rings; ++i) {
+        while (sb_atomic_load(&statics.recorders[i].num_recording, memory_order_seq_cst)) {
+            sb_thread_sleep((milliseconds_t){0});
+        }
+    }
+
+    telemetry_trace_drain();
+    telemetry_trace_write("\n]}\n");
+    telemetry_trace_flush();
+    sb_fclose(statics.file);
+    statics.file = NULL;
+
+    const int num_threads = sb_atomic_load(&statics.num_threads, memory_order_acquire);
+    int num_dropped = 0;
+    for (int i = 0; i < min_int(num_threads, telemetry_trace_max_threads); ++i) {
+        num_dropped += sb_atomic_load(&statics.threads[i].num_dropped, memory_order_relaxed);
+    }
+    const int num_dropped_threads = num_threads - min_int(num_threads, telemetry_trace_max_threads);
+    if ((num_dropped > 0) || (num_dropped_threads > 0)) {
+        LOG_WARN(TAG_TELEMETRY, "telemetry dropped [%i] events and [%i] threads", num_dropped, num_dropped_threads);
+    }
+
+#ifdef GUARD_PAGE_SUPPORT
+    debug_sys_unmap_pages(statics.guard_pages, MALLOC_TAG);
+#else
+    sb_unmap_pages(statics.region);
+#endif
+    statics.threads = NULL;
+}
+
+void app_telemetry_push(const char * const name) {
+    if (telemetry_trace_is_capturing(APP_TRACE_MASK)) {
+        // the name lives in wasm memory
+        telemetry_trace_record_push_copy(name);
+    }
+}
+
+void app_telemetry_pop(void) {
+    TRACE_POP(APP_TRACE_MASK);
+}
+
+void app_telemetry_span_begin(const uint64_t id, const char * const str) {
+    if (telemetry_trace_is_capturing(APP_TRACE_MASK)) {
+        telemetry_trace_record_span_begin(id, "%s", str);
+    }
+}
+
+void app_telemetry_span_end(const uint64_t id) {
+    if (telemetry_trace_is_capturing(APP_TRACE_MASK)) {
+        telemetry_trace_record_span_end(id);
+    }
+}
+
+#endif // _TELEMETRY && _TELEMETRY_TRACE
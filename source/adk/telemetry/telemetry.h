@@ -22,11 +22,30 @@ extern "C" {
 
 #ifdef _TELEMETRY
 void telemetry_print_help();
+#ifdef _TELEMETRY_TRACE
+// `trace_file_name` is relative to the app cache directory
+void telemetry_init(const char * const trace_file_name, const char * const telemetry_groups);
+#else
 void telemetry_init(const char * const address, const int port, const char * const telemetry_groups);
+#endif
 void telemetry_shutdown();
 #endif
 
-#ifdef _TELEMETRY
+#if defined(_TELEMETRY) && defined(_TELEMETRY_TRACE)
+#include "source/adk/telemetry/telemetry_trace.h"
+
+#define TRACE_PUSH_FN(_mask) (telemetry_trace_is_capturing(_mask) ? telemetry_trace_record_push(__func__) : (void)0)
+#define TRACE_PUSH(_mask, _name) (telemetry_trace_is_capturing(_mask) ? telemetry_trace_record_push(_name) : (void)0)
+#define TRACE_POP(_mask) (telemetry_trace_is_capturing(_mask) ? telemetry_trace_record_pop() : (void)0)
+#define TRACE_TICK() (telemetry_trace_is_capturing(0) ? telemetry_trace_record_tick() : (void)0)
+#define TRACE_NAME_THREAD(_name) (telemetry_trace_is_capturing(0) ? telemetry_trace_record_thread_name(_name) : (void)0)
+#define TRACE_HEAP(_heap) (telemetry_trace_is_capturing(0) ? telemetry_trace_record_counter((_heap)->name, (_heap)->internal.used_block_size) : (void)0)
+#define TRACE_TIME_SPAN_BEGIN(_id, span_name_fmt_str, ...) (telemetry_trace_is_capturing(0) ? telemetry_trace_record_span_begin((uint64_t)(uintptr_t)(_id), span_name_fmt_str, ##__VA_ARGS__) : (void)0)
+#define TRACE_TIME_SPAN_END(_id) (telemetry_trace_is_capturing(0) ? telemetry_trace_record_span_end((uint64_t)(uintptr_t)(_id)) : (void)0)
+// allocations are not captured by the built-in backend
+#define TRACE_ALLOC(_location, _ptr, _size, _ctx, ...)
+#define TRACE_FREE(_ptr)
+#elif defined(_TELEMETRY)
 #if defined(_VADER)
 #include "extern/private/rad-tools/telemetry/tm3/ps5/rad_tm_ps5_3.5.0.19/include/rad_tm.h"
 #else
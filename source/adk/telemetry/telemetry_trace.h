@@ -0,0 +1,57 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+telemetry_trace.h
+
+Built-in trace capture backend for the telemetry macros (--telemetry-trace builds)
+
+Each thread records events into its own lock-free ring, a writer thread drains
+the rings and streams them to a Chrome Trace Event JSON file that loads in
+chrome://tracing and the Perfetto UI. Events are only recorded for the groups
+selected by the capture mask, a disabled trace point costs a relaxed load and
+a branch.
+*/
+
+#pragma once
+
+#include "source/adk/runtime/runtime.h"
+#include "source/adk/steamboat/sb_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    // set in the capture mask while a capture is running, trace points without a group only test this bit
+    telemetry_trace_capturing_mask = 1 << 0
+};
+
+extern sb_atomic_int32_t telemetry_trace_capture_mask;
+
+static inline bool telemetry_trace_is_capturing(const uint32_t mask) {
+    const uint32_t capture_mask = (uint32_t)sb_atomic_load(&telemetry_trace_capture_mask, memory_order_relaxed);
+    return (capture_mask & (mask ? mask : telemetry_trace_capturing_mask)) != 0;
+}
+
+// Recording functions behind the TRACE_* macros, callers check telemetry_trace_is_capturing first.
+// `name` must outlive the capture (string literals, __func__) unless noted otherwise.
+
+void telemetry_trace_record_push(const char * const name);
+// copies `name`, for strings owned by the caller
+void telemetry_trace_record_push_copy(const char * const name);
+void telemetry_trace_record_pop(void);
+void telemetry_trace_record_tick(void);
+// copies `name`
+void telemetry_trace_record_thread_name(const char * const name);
+// copies `name`
+void telemetry_trace_record_counter(const char * const name, const uint64_t value);
+void telemetry_trace_record_span_begin(const uint64_t id, const char * const format, ...);
+void telemetry_trace_record_span_end(const uint64_t id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,6 +28,7 @@ M3Result m3_FindFunction(IM3Function * o_function, IM3Runtime i_runtime, const c
 M3Result m3_LinkRawFunction(IM3Module io_module, const char * const i_moduleName, const char * const i_functionName, const char * const i_signature, M3RawCall i_function);
 
 M3Result m3_CallIntoRunningProgram(IM3Function i_function, void * const ret, uint32_t argc, const void * const * const argv);
+M3Result m3_CallHandle(IM3Function i_function, wasm_call_slot_t * const ret, uint32_t argc, const wasm_call_slot_t * const args);
 M3Result m3_CallByName(IM3Runtime runtime, const char * const name, void * const ret, uint32_t argc, const void * const * const argv);
 
 uint8_t * m3_GetMemoryBase(IM3Runtime runtime);
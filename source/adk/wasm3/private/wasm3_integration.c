@@ -166,6 +166,20 @@ static wasm_call_result_t wasm3_call_rI(const char * const name, uint64_t * cons
     return wasm3_create_result(name, m3_Call_rI(wasm3_global_runtime, name, ret));
 }
 
+static wasm_call_result_t wasm3_find_function(const char * const name, wasm_function_handle_t * const out_handle) {
+    IM3Function function = NULL;
+    const M3Result result = m3_FindFunction(&function, wasm3_global_runtime, name);
+    *out_handle = (wasm_function_handle_t){.function = function, .name = name};
+    return wasm3_create_result(name, result);
+}
+
+static wasm_call_result_t wasm3_call_handle(const wasm_function_handle_t handle, wasm_call_slot_t * const ret, const uint32_t argc, const wasm_call_slot_t * const args) {
+    if (!handle.function) {
+        return wasm3_create_result(handle.name, m3Err_functionLookupFailed);
+    }
+    return wasm3_create_result(handle.name, m3_CallHandle(handle.function, ret, argc, args));
+}
+
 static void * wasm3_ptr_w2n(wasm_ptr_t ptr) {
     return m3_ConvertWasmPtrToNativePtr(wasm3_global_runtime, (uint32_t)ptr.ofs);
 }
@@ -191,6 +205,9 @@ wasm_interpreter_t wasm3_interpreter = {
     .translate_ptr_wasm_to_native = wasm3_ptr_w2n,
     .translate_ptr_native_to_wasm = wasm3_ptr_n2w,
 
+    .find_function = wasm3_find_function,
+    .call_handle = wasm3_call_handle,
+
 #define WASM_CALLEE_SIGNATURE(_sig) TOKENPASTE(.call_, _sig) = TOKENPASTE(wasm3_call_, _sig)
     WASM_CALLEE_REQUIRED_SIGNATURES
 #undef WASM_CALLEE_SIGNATURE
@@ -31,6 +31,38 @@ static inline m3ret_t vectorcall wasm3_call(d_m3OpSig) {
     return ((IM3Operation)(*_pc))(_pc + 1, d_m3OpArgs); // nextOpDirect()
 }
 
+// Runs a compiled function whose arguments are already in place at `stack`, the result is left in the first slot
+static M3Result m3_RunOnStack(IM3Function i_function, u64 * const stack) {
+    IM3Runtime runtime = i_function->module->runtime;
+
+    m3StackCheckInit();
+
+    const bool reentrant_ctx = runtime->ctx != NULL;
+
+    m3_exec_ctx ctx = {0};
+    if (!reentrant_ctx) {
+        runtime->ctx = &ctx;
+    }
+
+    const M3Result result = (M3Result)wasm3_call(i_function->compiled, (m3stack_t)stack, runtime->memory.mallocated, d_m3OpDefaultArgs, runtime->ctx);
+    if (result) {
+        return result;
+    }
+
+    if (!reentrant_ctx) {
+        runtime->ctx = NULL;
+    }
+
+    runtime->stackPointerAtLastRawFunctionCall = stack;
+    return m3Err_none;
+}
+
+static u64 * m3_GetCallStackBase(IM3Runtime runtime) {
+    return runtime->stackPointerAtLastRawFunctionCall
+               ? runtime->stackPointerAtLastRawFunctionCall
+               : runtime->stack;
+}
+
 /* custom entry point that will pick up the last saved stack pointer when calling from m5 callback */
 M3Result m3_CallIntoRunningProgram(IM3Function i_function, void * const ret, uint32_t argc, const void * const * const argv) {
     M3Result result = m3Err_none;
@@ -43,9 +75,7 @@ M3Result m3_CallIntoRunningProgram(IM3Function i_function, void * const ret, uin
         if (argc != ftype->numArgs)
             _throw(m3Err_argumentCountMismatch);
 
-        u64 * stack = runtime->stackPointerAtLastRawFunctionCall
-                          ? runtime->stackPointerAtLastRawFunctionCall
-                          : runtime->stack;
+        u64 * stack = m3_GetCallStackBase(runtime);
 
         for (u32 i = 0; i < ftype->numArgs; ++i) {
             u64 * s = &stack[i];
@@ -68,20 +98,7 @@ M3Result m3_CallIntoRunningProgram(IM3Function i_function, void * const ret, uin
             }
         }
 
-        m3StackCheckInit();
-
-        const bool reentrant_ctx = runtime->ctx != NULL;
-
-        m3_exec_ctx ctx = {0};
-        if (!reentrant_ctx) {
-            runtime->ctx = &ctx;
-        }
-
-        _((M3Result)wasm3_call(i_function->compiled, (m3stack_t)stack, runtime->memory.mallocated, d_m3OpDefaultArgs, runtime->ctx));
-
-        if (!reentrant_ctx) {
-            runtime->ctx = NULL;
-        }
+        _(m3_RunOnStack(i_function, stack));
 
         switch (ftype->returnType) {
             case c_m3Type_none:
@@ -101,8 +118,6 @@ M3Result m3_CallIntoRunningProgram(IM3Function i_function, void * const ret, uin
             default:
                 _throw("unknown return type");
         }
-
-        runtime->stackPointerAtLastRawFunctionCall = stack;
     } else
         _throw(m3Err_missingCompiledCode);
 
@@ -113,6 +128,36 @@ _catch:
     return result;
 }
 
+STATIC_ASSERT(sizeof(wasm_call_slot_t) == sizeof(u64));
+
+/* handle entry point: a slot holds its value at the same address the stack slot does, so arguments and
+   the result are copied whole instead of converted per type */
+M3Result m3_CallHandle(IM3Function i_function, wasm_call_slot_t * const ret, uint32_t argc, const wasm_call_slot_t * const args) {
+    M3Result result = m3Err_none;
+
+    if (!i_function->compiled)
+        _throw(m3Err_missingCompiledCode);
+    if (argc != i_function->funcType->numArgs)
+        _throw(m3Err_argumentCountMismatch);
+
+    u64 * stack = m3_GetCallStackBase(i_function->module->runtime);
+    if (argc) {
+        memcpy(stack, args, argc * sizeof(*args));
+    }
+
+    _(m3_RunOnStack(i_function, stack));
+
+    if (ret && (i_function->funcType->returnType != c_m3Type_none)) {
+        memcpy(ret, stack, sizeof(*ret));
+    }
+
+_catch:
+    if (result) {
+        LOG_ERROR(WASM3_TAG, "%s", result);
+    }
+    return result;
+}
+
 M3Result m3_CallByName(IM3Runtime runtime, const char * const name, void * const ret, uint32_t argc, const void * const * const argv) {
     IM3Function func = NULL;
     M3Result find_function_result = m3_FindFunction(&func, runtime, name);
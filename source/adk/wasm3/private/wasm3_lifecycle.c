@@ -56,6 +56,8 @@ wasm_memory_region_t load_wasm3_fp(
 }
 
 void unload_wasm3(wasm_memory_region_t wasm_memory) {
+    wasm_reset_exports();
+
     // Do not free the module. The runtime owns it.
     wasm3_app_module = NULL;
 
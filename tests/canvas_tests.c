@@ -14,6 +14,7 @@ canvas test fixture
 #include "source/adk/canvas/cg.h"
 #include "source/adk/canvas/private/cg_font.h"
 #include "source/adk/http/adk_http.h"
+#include "source/adk/renderer/private/rhi_device_api.h"
 #include "source/adk/runtime/private/file.h"
 #include "source/adk/runtime/screenshot.h"
 #include "source/adk/steamboat/sb_display.h"
@@ -397,6 +398,39 @@ static void cg_draw_face_test() {
     cg_context_stroke(MALLOC_TAG);
 }
 
+// retained paths must draw the same pixels as `cg_draw_rounded_rect_test` and `cg_draw_face_test`
+static void cg_draw_retained_rounded_rect_test(cg_image_t * const image_gif) {
+    cg_context_set_line_width(2.0);
+    cg_context_begin_path(MALLOC_TAG);
+    cg_context_stroke_style((cg_color_t){.r = 0, .g = 255, .b = 0, .a = 255});
+    cg_context_fill_style_image_hex(0xFFF, image_gif);
+    cg_context_rounded_rect((cg_rect_t){.x = 300, .y = 25, .width = 300, .height = 100}, 20, MALLOC_TAG);
+    cg_retained_path_t * const path = cg_context_create_retained_path(MALLOC_TAG);
+    cg_context_begin_path(MALLOC_TAG);
+    cg_context_fill_retained_path(path, cg_path_options_none);
+    cg_context_stroke_retained_path(path, cg_path_options_none);
+    cg_context_free_retained_path(path, MALLOC_TAG);
+}
+
+static void cg_draw_retained_face_test() {
+    cg_context_set_line_width(2.0);
+    cg_context_stroke_style((cg_color_t){.r = 255, .g = 255, .b = 255, .a = 255});
+    // captured without a transform, placed by the transform current when it's drawn
+    cg_context_begin_path(MALLOC_TAG);
+    cg_context_arc((cg_vec2_t){.x = 75, .y = 75}, 50, (cg_rads_t){.rads = 0}, (cg_rads_t){.rads = CG_TAU}, cg_rotation_counter_clock_wise, MALLOC_TAG); // face
+    cg_context_move_to((cg_vec2_t){.x = 110, .y = 75}, MALLOC_TAG);
+    cg_context_arc((cg_vec2_t){.x = 75, .y = 75}, 35, (cg_rads_t){.rads = 0}, (cg_rads_t){.rads = CG_PI}, cg_rotation_clock_wise, MALLOC_TAG); // mouth clockwise
+    cg_context_move_to((cg_vec2_t){.x = 65, .y = 65}, MALLOC_TAG);
+    cg_context_arc((cg_vec2_t){.x = 60, .y = 65}, 5, (cg_rads_t){.rads = 0}, (cg_rads_t){.rads = CG_TAU}, cg_rotation_counter_clock_wise, MALLOC_TAG); // left eye
+    cg_context_move_to((cg_vec2_t){.x = 95, .y = 65}, MALLOC_TAG);
+    cg_context_arc((cg_vec2_t){.x = 90, .y = 65}, 5, (cg_rads_t){.rads = 0}, (cg_rads_t){.rads = CG_TAU}, cg_rotation_counter_clock_wise, MALLOC_TAG); // right eye
+    cg_retained_path_t * const path = cg_context_create_retained_path(MALLOC_TAG);
+    cg_context_begin_path(MALLOC_TAG);
+    cg_context_translate((cg_vec2_t){.x = 150, .y = 0});
+    cg_context_stroke_retained_path(path, cg_path_options_none);
+    cg_context_free_retained_path(path, MALLOC_TAG);
+}
+
 static void cg_clear_rect_test() {
     cg_context_translate((cg_vec2_t){.x = 0, .y = 120});
     cg_context_fill_style_hex(0x09F);
@@ -1090,6 +1124,8 @@ static void cg_image_test(void ** ignored) {
     CG_PERFORM_TEST(cg_draw_bubble_test(images.image), "draw_bubble_test");
     CG_PERFORM_TEST(cg_draw_rounded_rect_test(images.image_gif), "draw_rounded_rect_test");
     CG_PERFORM_TEST(cg_draw_face_test(), "draw_face_test");
+    CG_PERFORM_TEST(cg_draw_retained_rounded_rect_test(images.image_gif), "draw_rounded_rect_test");
+    CG_PERFORM_TEST(cg_draw_retained_face_test(), "draw_face_test");
     CG_PERFORM_TEST(cg_clear_rect_test(), "draw_clear_rect_test");
     CG_PERFORM_TEST(cg_tris_test(), "draw_trist_test");
     CG_PERFORM_TEST(cg_global_alpha_test(), "draw_global_alpha_test");
@@ -1334,6 +1370,54 @@ static void cg_page_count_test(void ** ignored) {
     assert_int_equal(page_count, 4);
 }
 
+static int32_t kerning_test_codepoint(const int index) {
+    // printable ascii is precomputed at load, the others are looked up and memoized on first use
+    static const int32_t other_codepoints[] = {0xc0, 0xc5, 0xe9, 0x152, 0x2019, 0x201c};
+    const int num_ascii = 0x7e - 0x20 + 1;
+    return (index < num_ascii) ? 0x20 + index : other_codepoints[index - num_ascii];
+}
+
+static void cg_font_kerning_test(void ** ignored) {
+    enum {
+        num_codepoints = (0x7e - 0x20 + 1) + 6,
+        // fills up long before every kerning pair of the font is in it
+        full_kern_table_size = 16,
+    };
+    static int32_t expected[num_codepoints][num_codepoints];
+
+    int num_kerned_pairs = 0;
+    for (int font_ind = 0; font_ind < ARRAY_SIZE(font_files.files); ++font_ind) {
+        cg_font_file_t * const font = font_files.files[font_ind];
+
+        // without a table every pair comes straight from the font
+        cg_font_file_rebuild_metrics(font, cg_font_no_kern_table);
+        for (int left = 0; left < num_codepoints; ++left) {
+            for (int right = 0; right < num_codepoints; ++right) {
+                expected[left][right] = cg_font_file_get_kern_advance(font, kerning_test_codepoint(left), kerning_test_codepoint(right));
+                num_kerned_pairs += expected[left][right] != 0;
+            }
+        }
+
+        const int32_t kern_table_sizes[] = {cg_font_kern_table_size_from_font, full_kern_table_size};
+        for (int size_ind = 0; size_ind < ARRAY_SIZE(kern_table_sizes); ++size_ind) {
+            cg_font_file_rebuild_metrics(font, kern_table_sizes[size_ind]);
+            // the second pass reads the pairs memoized by the first
+            for (int pass = 0; pass < 2; ++pass) {
+                for (int left = 0; left < num_codepoints; ++left) {
+                    for (int right = 0; right < num_codepoints; ++right) {
+                        const int32_t kern_advance = cg_font_file_get_kern_advance(font, kerning_test_codepoint(left), kerning_test_codepoint(right));
+                        VERIFY_MSG(kern_advance == expected[left][right], "font %d, table size %d: kerning of U+%04X U+%04X is %d, expected %d", font_ind, kern_table_sizes[size_ind], kerning_test_codepoint(left), kerning_test_codepoint(right), kern_advance, expected[left][right]);
+                    }
+                }
+            }
+        }
+
+        cg_font_file_rebuild_metrics(font, cg_font_kern_table_size_from_font);
+    }
+
+    assert_true(num_kerned_pairs > 0);
+}
+
 static void cg_combined_tests_test(void ** ignored) {
     statics.num_failing_tests = 0;
     CG_PERFORM_TEST(cg_combined_test(fonts.font_ctx, images.image, images.image_gif, 0, 0, statics.display_mode.width), "draw_combined_test");
@@ -1342,6 +1426,395 @@ static void cg_combined_tests_test(void ** ignored) {
     assert_int_equal(statics.num_failing_tests, 0);
 }
 
+// Recreates the canvas gl state with `config`, the render thread must be done with the old one.
+static void reinit_canvas_gl_state(const runtime_configuration_canvas_gl_t config) {
+    cg_context_t * const ctx = cg_get_context();
+    wait_render_present();
+    cg_gl_state_free(ctx->gl);
+    cg_gl_state_init(ctx->gl, &ctx->cg_heap_low, the_app.render_device, config);
+}
+
+// Draws the combined test `repeat` times in one frame, on top of itself, with an unbatched sdf rect after each.
+static void draw_combined_test(const int repeat) {
+    render_canvas_begin();
+    for (int i = 0; i < repeat; ++i) {
+        cg_context_save();
+        cg_combined_test(fonts.font_ctx, images.image, images.image_gif, 0, 0, statics.display_mode.width);
+        cg_context_identity();
+        cg_context_fill_style((cg_color_t){.r = 255, .g = 64, .b = 0, .a = 255});
+        cg_context_sdf_fill_rect_rounded((cg_rect_t){.x = 40.f + (float)i * 40.f, .y = 600, .width = 120, .height = 80}, (cg_sdf_rect_params_t){.roundness = 20});
+        cg_context_restore();
+    }
+    cg_context_end(MALLOC_TAG);
+}
+
+// Same as `draw_combined_test` and takes a screenshot of the frame.
+static void capture_combined_test(const int repeat, image_t * const screenshot, const mem_region_t screenshot_region) {
+    draw_combined_test(repeat);
+    adk_take_screenshot(screenshot, screenshot_region);
+    render_and_swap();
+    wait_render_present();
+}
+
+static bool screenshots_are_equal(const image_t * const a, const image_t * const b) {
+    adk_screenshot_t lhs = {.image = *a}, rhs = {.image = *b};
+    log_set_min_level(log_level_error);
+    const bool equal = adk_screenshot_compare(&lhs, &rhs, 0);
+    log_set_min_level(log_level_warn);
+    return equal;
+}
+
+static void cg_streaming_vertices_test(void ** ignored) {
+    const runtime_configuration_canvas_gl_t default_config = cg_get_context()->gl->config;
+    assert_true(default_config.enable_streaming_vertices);
+
+    // small banks so the frame cycles through all of them several times
+    runtime_configuration_canvas_gl_t config = default_config;
+    config.internal_limits.max_verts_per_vertex_bank = 2048;
+
+    image_t streamed;
+    config.enable_streaming_vertices = true;
+    reinit_canvas_gl_state(config);
+    const bool is_streaming = cg_get_context()->gl->stream_mesh != NULL;
+    capture_combined_test(8, &streamed, statics.baseline_screenshot_region);
+
+    image_t uploaded;
+    config.enable_streaming_vertices = false;
+    reinit_canvas_gl_state(config);
+    assert_null(cg_get_context()->gl->stream_mesh);
+    capture_combined_test(8, &uploaded, statics.testcase_screenshot_region);
+
+    print_message("[canvas] streaming vertices %s\n", is_streaming ? "enabled" : "not supported by the device, compared uploads");
+    assert_true(screenshots_are_equal(&streamed, &uploaded));
+
+    // without batching every range is written straight into the streamed banks
+    image_t streamed_unbatched;
+    config.enable_streaming_vertices = true;
+    config.enable_draw_batching = false;
+    reinit_canvas_gl_state(config);
+    capture_combined_test(8, &streamed_unbatched, statics.baseline_screenshot_region);
+
+    reinit_canvas_gl_state(default_config);
+
+    assert_true(screenshots_are_equal(&streamed_unbatched, &uploaded));
+}
+
+// Rects in a grid that switch texture, blend and clip every few draws, then a run of identical rects.
+static void draw_batching_scene() {
+    cg_context_identity();
+    for (int i = 0; i < 64; ++i) {
+        if (i == 32) {
+            cg_context_set_clip_state(cg_clip_state_enabled);
+            cg_context_set_clip_rect((cg_rect_t){.x = 100, .y = 200, .width = 900, .height = 400});
+        }
+        const cg_rect_t rect = {.x = 20.f + (float)(i % 16) * 75.f, .y = 20.f + (float)(i / 16) * 150.f, .width = 65.f, .height = 140.f};
+        switch (i % 4) {
+            case 0:
+            case 1:
+                // the same state twice in a row
+                cg_context_fill_style((cg_color_t){.r = 0, .g = 128, .b = 255, .a = 255});
+                cg_context_fill_rect(rect, MALLOC_TAG);
+                break;
+            case 2:
+                cg_context_draw_image_scale((i & 8) ? images.image : images.image_gif, rect);
+                break;
+            default:
+                cg_context_fill_style((cg_color_t){.r = 255, .g = 64, .b = 0, .a = 128});
+                cg_context_fill_rect(rect, MALLOC_TAG);
+                break;
+        }
+    }
+    cg_context_set_clip_state(cg_clip_state_disabled);
+
+    cg_context_fill_style((cg_color_t){.r = 255, .g = 255, .b = 255, .a = 255});
+    for (int i = 0; i < 16; ++i) {
+        cg_context_fill_rect((cg_rect_t){.x = 20.f + (float)i * 75.f, .y = 640.f, .width = 65.f, .height = 60.f}, MALLOC_TAG);
+    }
+}
+
+static void cg_draw_batching_test(void ** ignored) {
+    const runtime_configuration_canvas_gl_t default_config = cg_get_context()->gl->config;
+    assert_true(default_config.enable_draw_batching);
+    runtime_configuration_canvas_gl_t config = default_config;
+
+    rhi_counters_t counters[2];
+    image_t screenshots[2];
+    const mem_region_t screenshot_regions[2] = {statics.baseline_screenshot_region, statics.testcase_screenshot_region};
+    for (int batching = 0; batching < 2; ++batching) {
+        config.enable_draw_batching = batching != 0;
+        reinit_canvas_gl_state(config);
+        // the render thread is idle, drop what earlier frames counted
+        rhi_read_and_clear_counters(the_app.render_device->internal.device, &counters[batching]);
+
+        render_canvas_begin();
+        draw_batching_scene();
+        cg_context_end(MALLOC_TAG);
+        adk_take_screenshot(&screenshots[batching], screenshot_regions[batching]);
+        render_and_swap();
+        wait_render_present();
+
+        rhi_read_and_clear_counters(the_app.render_device->internal.device, &counters[batching]);
+    }
+    reinit_canvas_gl_state(default_config);
+
+    const rhi_counters_t unbatched = counters[0];
+    const rhi_counters_t batched = counters[1];
+    print_message("[canvas] draw calls: %u unbatched, %u batched in %u batches of %u draws\n", unbatched.num_draw_calls, batched.num_draw_calls, batched.num_batches, batched.num_batched_draws);
+
+    assert_int_equal(unbatched.num_batches, 0);
+    assert_int_equal(unbatched.num_batched_draws, 0);
+    assert_true(batched.num_batches > 0);
+    // each batch is one draw call in place of the draws merged into it
+    assert_int_equal(batched.num_draw_calls, unbatched.num_draw_calls - (batched.num_batched_draws - batched.num_batches));
+    // at least the 16 identical rects and the 16 pairs of same state rects in the grid are merged
+    assert_true(unbatched.num_draw_calls - batched.num_draw_calls >= 15 + 16);
+
+    assert_true(screenshots_are_equal(&screenshots[0], &screenshots[1]));
+}
+
+static void cg_pending_frames_vertex_banks_test(void ** ignored) {
+    const runtime_configuration_canvas_gl_t default_config = cg_get_context()->gl->config;
+    runtime_configuration_canvas_gl_t config = default_config;
+    config.internal_limits.max_verts_per_vertex_bank = 2048;
+    config.internal_limits.num_vertex_banks = 2;
+
+    image_t single;
+    reinit_canvas_gl_state(config);
+    assert_int_equal(cg_get_context()->gl->config.internal_limits.num_vertex_banks, 2);
+    capture_combined_test(8, &single, statics.baseline_screenshot_region);
+
+    render_set_max_pending_frames(the_app.render_device, render_max_pending_frames);
+    reinit_canvas_gl_state(config);
+    assert_int_equal(cg_get_context()->gl->config.internal_limits.num_vertex_banks, render_max_pending_frames + 1);
+
+    // fill the pipeline with frames that cycle through all the banks before checking one
+    for (int i = 0; i < render_max_pending_frames * 2; ++i) {
+        draw_combined_test(8);
+        render_and_swap();
+        render_device_frame(the_app.render_device);
+    }
+    image_t pipelined;
+    capture_combined_test(8, &pipelined, statics.testcase_screenshot_region);
+
+    render_set_max_pending_frames(the_app.render_device, render_default_pending_frames);
+    reinit_canvas_gl_state(default_config);
+
+    assert_true(screenshots_are_equal(&single, &pipelined));
+}
+
+// Swaps the canvas onto its own font atlas, fonts created until `pop_font_atlas` pack their glyphs into it.
+static mosaic_context_t * push_font_atlas(const int32_t page_width, const int32_t page_height, const int32_t num_pages) {
+    cg_context_t * const ctx = cg_get_context();
+    mosaic_context_t * const default_mosaic_ctx = ctx->mosaic_ctx;
+    ctx->mosaic_ctx = mosaic_context_new(ctx, page_width, page_height, num_pages, the_app.api->mmap.canvas_font_scratchpad.region, system_guard_page_mode_disabled, MALLOC_TAG);
+    return default_mosaic_ctx;
+}
+
+static void pop_font_atlas(mosaic_context_t * const default_mosaic_ctx) {
+    wait_render_present();
+    cg_context_t * const ctx = cg_get_context();
+    mosaic_context_free(ctx->mosaic_ctx);
+    ctx->mosaic_ctx = default_mosaic_ctx;
+}
+
+static void draw_text_frame(cg_font_context_t * const font_ctx, const char * const text) {
+    render_canvas_begin();
+    cg_context_fill_text_with_options(font_ctx, (cg_vec2_t){.x = 100.f, .y = 100.f}, text, cg_font_fill_options_align_left | cg_font_fill_options_align_top);
+    cg_context_end(MALLOC_TAG);
+}
+
+static void capture_text_frame(cg_font_context_t * const font_ctx, const char * const text, image_t * const screenshot, const mem_region_t screenshot_region) {
+    draw_text_frame(font_ctx, text);
+    adk_take_screenshot(screenshot, screenshot_region);
+    render_and_swap();
+    wait_render_present();
+}
+
+static bool int16_rects_overlap(const cg_int16_rect_t a, const cg_int16_rect_t b) {
+    return (a.x < b.x + b.width) && (b.x < a.x + a.width) && (a.y < b.y + b.height) && (b.y < a.y + a.height);
+}
+
+// Every resident glyph has to sit on a single page without overlapping any other.
+static void verify_font_atlas_packing(const mosaic_context_t * const mosaic_ctx) {
+    enum {
+        max_glyph_rects = 256,
+    };
+    static cg_int16_rect_t rects[max_glyph_rects];
+
+    const mosaic_atlas_stats_t stats = mosaic_context_get_atlas_stats(mosaic_ctx);
+    const int32_t num_rects = mosaic_context_get_resident_glyph_rects(mosaic_ctx, rects, max_glyph_rects);
+    VERIFY(num_rects <= max_glyph_rects);
+    assert_int_equal(num_rects, stats.num_resident_glyphs);
+
+    for (int32_t i = 0; i < num_rects; ++i) {
+        const cg_int16_rect_t rect = rects[i];
+        assert_true((rect.x >= 0) && (rect.width > 0) && (rect.x + rect.width <= stats.page_width));
+        assert_true((rect.y >= 0) && (rect.height > 0) && (rect.y + rect.height <= stats.page_height * stats.num_pages));
+        assert_int_equal(rect.y / stats.page_height, (rect.y + rect.height - 1) / stats.page_height);
+        for (int32_t j = i + 1; j < num_rects; ++j) {
+            VERIFY_MSG(!int16_rects_overlap(rect, rects[j]), "glyphs %i and %i overlap in the font atlas", i, j);
+        }
+    }
+}
+
+static void cg_font_atlas_eviction_test(void ** ignored) {
+    enum {
+        // a page only holds a handful of 40px glyphs, so the alphabet cycles through the pages several times
+        page_width = 256,
+        page_height = 64,
+        num_pages = 2,
+    };
+
+    mosaic_context_t * const default_mosaic_ctx = push_font_atlas(page_width, page_height, num_pages);
+    mosaic_context_t * const mosaic_ctx = cg_get_context()->mosaic_ctx;
+    cg_font_context_t * const font_ctx = cg_context_create_font_context(font_files.avenir_roman_font, 40.f, 1, MALLOC_TAG);
+
+    image_t before;
+    capture_text_frame(font_ctx, "Dreamcast", &before, statics.baseline_screenshot_region);
+    verify_font_atlas_packing(mosaic_ctx);
+    assert_int_equal(mosaic_context_get_atlas_stats(mosaic_ctx).num_page_evictions, 0);
+
+    const char * const filler_text[] = {"ABCDEFG", "HIJKLMN", "OPQRSTU", "VWXYZ01", "2345678", "9bfghij", "klnopqu", "vwxyz"};
+    for (int i = 0; i < ARRAY_SIZE(filler_text); ++i) {
+        draw_text_frame(font_ctx, filler_text[i]);
+        render_and_swap();
+        wait_render_present();
+        verify_font_atlas_packing(mosaic_ctx);
+    }
+
+    // every page was reclaimed at least once, so "Dreamcast" is rasterized and uploaded again
+    const mosaic_atlas_stats_t stats = mosaic_context_get_atlas_stats(mosaic_ctx);
+    assert_int_equal(stats.num_pages, num_pages);
+    assert_true(stats.num_page_evictions >= num_pages * 2);
+
+    image_t after;
+    capture_text_frame(font_ctx, "Dreamcast", &after, statics.testcase_screenshot_region);
+    verify_font_atlas_packing(mosaic_ctx);
+
+    cg_context_font_context_free(font_ctx, MALLOC_TAG);
+    pop_font_atlas(default_mosaic_ctx);
+
+    assert_true(screenshots_are_equal(&before, &after));
+}
+
+static void cg_font_atlas_page_clamp_test(void ** ignored) {
+    const int32_t max_texture_size = the_app.render_device->caps.max_texture_size;
+    const int32_t max_atlas_height = (max_texture_size > 0) ? min_int32_t(max_texture_size, INT16_MAX) : INT16_MAX;
+
+    // two pages of just over half the max texture size only fit one
+    mosaic_context_t * const default_mosaic_ctx = push_font_atlas(64, max_atlas_height / 2 + 1, 2);
+    assert_int_equal(mosaic_context_get_atlas_stats(cg_get_context()->mosaic_ctx).num_pages, 1);
+    pop_font_atlas(default_mosaic_ctx);
+}
+
+static void draw_text_block_frame(cg_font_context_t * const font_ctx, const char * const text) {
+    render_canvas_begin();
+    cg_context_fill_text_block_with_options(font_ctx, (cg_rect_t){.x = 100.f, .y = 100.f, .width = 800.f, .height = 100.f}, 0.f, 0.f, text, NULL, cg_text_block_align_line_left);
+    cg_context_end(MALLOC_TAG);
+    render_and_swap();
+    wait_render_present();
+}
+
+// Runs the memoized text path with a text mesh cache of `max_bytes`.
+static mosaic_context_t * push_text_mesh_cache(const uint32_t max_bytes) {
+    runtime_configuration_canvas_t * const config = &cg_get_context()->config;
+    config->text_mesh_cache.enabled = true;
+    config->text_mesh_cache.size = cg_default_max_text_mesh_cache_size;
+    config->text_mesh_cache.max_bytes = max_bytes;
+    // one page that holds every glyph of the test, so no mesh is dropped by an atlas eviction
+    return push_font_atlas(1024, 256, 1);
+}
+
+static void cg_text_mesh_cache_byte_budget_test(void ** ignored) {
+    enum {
+        num_blocks = 8,
+        budget_in_meshes = 3,
+    };
+    // same glyph count, so every mesh has the same size
+    static const char * const blocks[num_blocks] = {"Text block 0", "Text block 1", "Text block 2", "Text block 3", "Text block 4", "Text block 5", "Text block 6", "Text block 7"};
+    cg_context_t * const ctx = cg_get_context();
+    const runtime_configuration_canvas_t default_config = ctx->config;
+
+    // measure a single mesh without a byte budget
+    mosaic_context_t * default_mosaic_ctx = push_text_mesh_cache(0);
+    cg_font_context_t * font_ctx = cg_context_create_font_context(font_files.avenir_roman_font, 24.f, 1, MALLOC_TAG);
+    draw_text_block_frame(font_ctx, blocks[0]);
+    const size_t mesh_bytes = cg_context_get_text_mesh_cache_metrics(ctx).bytes_used;
+    assert_true(mesh_bytes > 0);
+    cg_context_font_context_free(font_ctx, MALLOC_TAG);
+    pop_font_atlas(default_mosaic_ctx);
+
+    default_mosaic_ctx = push_text_mesh_cache((uint32_t)(mesh_bytes * budget_in_meshes));
+    font_ctx = cg_context_create_font_context(font_files.avenir_roman_font, 24.f, 1, MALLOC_TAG);
+
+    // far fewer blocks than cache nodes, only the byte budget evicts
+    for (int i = 0; i < num_blocks; ++i) {
+        draw_text_block_frame(font_ctx, blocks[i]);
+    }
+    cg_text_mesh_cache_metrics_t metrics = cg_context_get_text_mesh_cache_metrics(ctx);
+    assert_int_equal(metrics.misses, num_blocks);
+    assert_int_equal(metrics.hits, 0);
+    assert_int_equal(metrics.evictions, num_blocks - budget_in_meshes);
+    assert_int_equal(metrics.num_entries, budget_in_meshes);
+    assert_int_equal(metrics.bytes_used, mesh_bytes * budget_in_meshes);
+    assert_true(metrics.bytes_used <= metrics.max_bytes);
+
+    // the most recent block is still cached, the first one was dropped to make room
+    draw_text_block_frame(font_ctx, blocks[num_blocks - 1]);
+    metrics = cg_context_get_text_mesh_cache_metrics(ctx);
+    assert_int_equal(metrics.hits, 1);
+    assert_int_equal(metrics.misses, num_blocks);
+
+    draw_text_block_frame(font_ctx, blocks[0]);
+    metrics = cg_context_get_text_mesh_cache_metrics(ctx);
+    assert_int_equal(metrics.hits, 1);
+    assert_int_equal(metrics.misses, num_blocks + 1);
+    assert_int_equal(metrics.evictions, num_blocks - budget_in_meshes + 1);
+    assert_int_equal(metrics.num_entries, budget_in_meshes);
+
+    cg_context_font_context_free(font_ctx, MALLOC_TAG);
+    pop_font_atlas(default_mosaic_ctx);
+    ctx->config = default_config;
+}
+
+static void count_screenshot_completion(void * const user, image_t * const screenshot) {
+    ++*(int *)user;
+}
+
+static void cg_async_screenshot_test(void ** ignored) {
+    enum {
+        // more than the gl device's readback ring holds, so one readback has to complete before the last is issued
+        num_async_screenshots = 4,
+    };
+
+    image_t sync_screenshot;
+    image_t async_screenshots[num_async_screenshots];
+    mem_region_t async_regions[num_async_screenshots];
+    for (int i = 0; i < num_async_screenshots; ++i) {
+        async_regions[i] = MEM_REGION(.ptr = malloc(statics.testcase_screenshot_region.size), .size = statics.testcase_screenshot_region.size);
+    }
+
+    int num_completed = 0;
+    draw_combined_test(1);
+    adk_take_screenshot(&sync_screenshot, statics.baseline_screenshot_region);
+    for (int i = 0; i < num_async_screenshots; ++i) {
+        adk_take_screenshot_async(&async_screenshots[i], async_regions[i], count_screenshot_completion, &num_completed);
+    }
+    RENDER_ENSURE_WRITE_CMD_STREAM(
+        &the_app.render_device->default_cmd_stream,
+        render_cmd_buf_poll_screenshots,
+        true,
+        MALLOC_TAG);
+    render_and_swap();
+    wait_render_present();
+
+    assert_int_equal(num_completed, num_async_screenshots);
+    for (int i = 0; i < num_async_screenshots; ++i) {
+        assert_true(screenshots_are_equal(&sync_screenshot, &async_screenshots[i]));
+        free(async_regions[i].ptr);
+    }
+}
+
 static int canvas_empty_setup(void ** ignored) {
     // make sure that when we enter low memory, we can't succeed in loading an image with guard pages enabled.
     the_app.display_settings._720p_hack = true;
@@ -1492,6 +1965,14 @@ int test_canvas() {
         cmocka_unit_test(cg_combined_tests_test),
         cmocka_unit_test(cg_text_height_test),
         cmocka_unit_test(cg_page_count_test),
+        cmocka_unit_test(cg_font_kerning_test),
+        cmocka_unit_test(cg_streaming_vertices_test),
+        cmocka_unit_test(cg_draw_batching_test),
+        cmocka_unit_test(cg_pending_frames_vertex_banks_test),
+        cmocka_unit_test(cg_font_atlas_eviction_test),
+        cmocka_unit_test(cg_font_atlas_page_clamp_test),
+        cmocka_unit_test(cg_text_mesh_cache_byte_budget_test),
+        cmocka_unit_test(cg_async_screenshot_test),
     };
     return cmocka_run_group_tests(empty_setup_tests, canvas_empty_setup, canvas_empty_teardown) + cmocka_run_group_tests(tests, canvas_test_init, canvas_test_teardown);
 }
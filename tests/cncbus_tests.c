@@ -443,13 +443,209 @@ static void bus_test_threaded_send_and_dispatch(void ** state) {
     print_message("bandwidth = %0.2f msgs per second\n", messages_per_second);
 }
 
+static void bus_test_batched_dispatch(void ** state) {
+    enum { message_count = 10,
+           batch_size = 4 };
+    bus_test_data_t * const test_data = *state;
+    cncbus_t * const bus = &test_data->bus;
+    bus_test_receiver_t * const receiver = &test_data->receivers[0];
+
+    bus_connect_all(test_data);
+    cncbus_set_dispatch_batch_size(bus, batch_size);
+
+    for (int i = 0; i < message_count; ++i) {
+        bus_send_random_message_checked(bus, receiver->base.internal.address, CNCBUS_MAKE_ADDRESS(255, 255, 255, 255), NULL);
+    }
+
+    assert_int_equal(cncbus_receiver_get_stats(&receiver->base).num_pending, message_count);
+    assert_int_equal(cncbus_get_occupancy(bus).num_pending_messages, message_count);
+
+    // each pass hands a receiver at most one batch
+    assert_int_equal(cncbus_dispatch(bus, cncbus_dispatch_batch), cncbus_dispatch_ok);
+    assert_int_equal(receiver->recv_count, batch_size);
+    assert_int_equal(cncbus_dispatch(bus, cncbus_dispatch_batch), cncbus_dispatch_ok);
+    assert_int_equal(receiver->recv_count, batch_size * 2);
+    assert_int_equal(cncbus_dispatch(bus, cncbus_dispatch_batch), cncbus_dispatch_ok);
+    assert_int_equal(receiver->recv_count, message_count);
+    assert_int_equal(cncbus_dispatch(bus, cncbus_dispatch_batch), cncbus_dispatch_no_messages);
+
+    const cncbus_occupancy_t occupancy = cncbus_get_occupancy(bus);
+    assert_int_equal(occupancy.num_pending_messages, 0);
+    assert_int_equal(occupancy.num_free_msg_links, occupancy.num_msg_links);
+    assert_int_equal(occupancy.num_free_msg_frags, occupancy.num_msg_frags);
+
+    cncbus_set_dispatch_batch_size(bus, cncbus_default_dispatch_batch_size);
+    bus_disconnect_all(test_data);
+}
+
+static void bus_test_backpressure(void ** state) {
+    enum { overflow_count = 10 };
+    bus_test_data_t * const test_data = *state;
+    cncbus_t * const bus = &test_data->bus;
+    bus_test_receiver_t * const dropping = &test_data->receivers[0];
+    bus_test_receiver_t * const coalescing = &test_data->receivers[1];
+
+    cncbus_receiver_set_backpressure_policy(&dropping->base, cncbus_backpressure_drop_oldest);
+    cncbus_receiver_set_backpressure_policy(&coalescing->base, cncbus_backpressure_coalesce);
+    bus_connect_all(test_data);
+
+    const int num_links = cncbus_get_occupancy(bus).num_msg_links;
+
+    // nothing dispatches, sends past the link limit must not block
+    {
+        const cncbus_receiver_stats_t before = cncbus_receiver_get_stats(&dropping->base);
+        for (int i = 0; i < num_links + overflow_count; ++i) {
+            bus_send_random_message_checked(bus, dropping->base.internal.address, CNCBUS_MAKE_ADDRESS(255, 255, 255, 255), NULL);
+        }
+        const cncbus_receiver_stats_t after = cncbus_receiver_get_stats(&dropping->base);
+        assert_int_equal(after.num_pending, num_links);
+        assert_int_equal(after.num_dropped - before.num_dropped, overflow_count);
+        assert_int_equal(cncbus_get_occupancy(bus).min_free_msg_links, 0);
+
+        while (cncbus_dispatch(bus, cncbus_dispatch_flush) != cncbus_dispatch_no_messages) {
+        }
+        assert_int_equal(dropping->recv_count, num_links);
+    }
+
+    {
+        const cncbus_receiver_stats_t before = cncbus_receiver_get_stats(&coalescing->base);
+        for (int i = 0; i < num_links + overflow_count; ++i) {
+            bus_send_random_message_checked(bus, coalescing->base.internal.address, CNCBUS_MAKE_ADDRESS(255, 255, 255, 255), NULL);
+        }
+        const cncbus_receiver_stats_t after = cncbus_receiver_get_stats(&coalescing->base);
+        assert_int_equal(after.num_pending, num_links);
+        assert_int_equal(after.num_coalesced - before.num_coalesced, overflow_count);
+        assert_int_equal(after.num_dropped - before.num_dropped, 0);
+
+        while (cncbus_dispatch(bus, cncbus_dispatch_flush) != cncbus_dispatch_no_messages) {
+        }
+        assert_int_equal(coalescing->recv_count, num_links);
+    }
+
+    const cncbus_occupancy_t occupancy = cncbus_get_occupancy(bus);
+    assert_int_equal(occupancy.num_free_msg_links, occupancy.num_msg_links);
+    assert_int_equal(occupancy.num_free_msg_frags, occupancy.num_msg_frags);
+
+    bus_disconnect_all(test_data);
+    cncbus_receiver_set_backpressure_policy(&dropping->base, cncbus_backpressure_block);
+    cncbus_receiver_set_backpressure_policy(&coalescing->base, cncbus_backpressure_block);
+}
+
+static void bus_test_routing(void ** state) {
+    bus_test_data_t * const test_data = *state;
+    cncbus_t * const bus = &test_data->bus;
+    bus_test_receiver_t * const receivers = test_data->receivers;
+    const cncbus_address_t group = CNCBUS_MAKE_GROUP_ADDRESS(0, 1, 0);
+    const cncbus_address_t exact_mask = CNCBUS_MAKE_ADDRESS(255, 255, 255, 255);
+
+    bus_connect_all(test_data);
+
+    cncbus_join_group(bus, &receivers[2].base, group);
+    cncbus_join_group(bus, &receivers[5].base, group);
+    // joining twice is a no-op
+    cncbus_join_group(bus, &receivers[5].base, group);
+
+    // the second round of sends is served from the routing cache
+    for (int i = 0; i < 2; ++i) {
+        bus_send_random_message_checked(bus, group, exact_mask, NULL);
+        bus_send_random_message_checked(bus, receivers[7].base.internal.address, exact_mask, NULL);
+        bus_send_random_message_checked(bus, CNCBUS_MAKE_ADDRESS(10, 10, 0, 0), CNCBUS_MAKE_ADDRESS(255, 255, 0, 0), NULL);
+    }
+
+    while (cncbus_dispatch(bus, cncbus_dispatch_flush) != cncbus_dispatch_no_messages) {
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(test_data->receivers); ++i) {
+        const uint32_t expected = ((i == 2) || (i == 5) || (i == 7)) ? 4 : 2;
+        assert_int_equal(receivers[i].recv_count, expected);
+    }
+
+    // membership changes invalidate cached routes
+    cncbus_leave_group(bus, &receivers[2].base, group);
+    bus_send_random_message_checked(bus, group, exact_mask, NULL);
+    while (cncbus_dispatch(bus, cncbus_dispatch_flush) != cncbus_dispatch_no_messages) {
+    }
+    assert_int_equal(receivers[2].recv_count, 4);
+    assert_int_equal(receivers[5].recv_count, 5);
+
+    // disconnecting leaves all groups and shifts the receiver table under the cached routes
+    cncbus_disconnect(bus, &receivers[5].base);
+    bus_send_random_message_checked(bus, group, exact_mask, NULL);
+    bus_send_random_message_checked(bus, receivers[7].base.internal.address, exact_mask, NULL);
+    while (cncbus_dispatch(bus, cncbus_dispatch_flush) != cncbus_dispatch_no_messages) {
+    }
+    assert_int_equal(receivers[5].recv_count, 5);
+    assert_int_equal(receivers[7].recv_count, 5);
+
+    cncbus_connect(bus, &receivers[5].base);
+    bus_disconnect_all(test_data);
+
+    const cncbus_occupancy_t occupancy = cncbus_get_occupancy(bus);
+    assert_int_equal(occupancy.num_free_msg_links, occupancy.num_msg_links);
+    assert_int_equal(occupancy.num_free_msg_frags, occupancy.num_msg_frags);
+}
+
+static void bus_test_send_throughput_vs_receiver_count(void ** state) {
+    enum { message_count = 100000 };
+    bus_test_data_t * const test_data = *state;
+    cncbus_t * const bus = &test_data->bus;
+    const cncbus_address_t group = CNCBUS_MAKE_GROUP_ADDRESS(0, 2, 0);
+
+    for (int num_receivers = 1; num_receivers <= cncbus_max_receivers; ++num_receivers) {
+        for (int i = 0; i < num_receivers; ++i) {
+            cncbus_connect(bus, &test_data->receivers[i].base);
+        }
+        cncbus_join_group(bus, &test_data->receivers[0].base, group);
+
+        // unicast to the last receiver in the table, subnet and multicast to every receiver
+        const struct {
+            const char * name;
+            cncbus_address_t address;
+            cncbus_address_t subnet_mask;
+        } routes[] = {
+            {"unicast", test_data->receivers[num_receivers - 1].base.internal.address, CNCBUS_MAKE_ADDRESS(255, 255, 255, 255)},
+            {"subnet", CNCBUS_MAKE_ADDRESS(10, 10, 0, 0), CNCBUS_MAKE_ADDRESS(255, 255, 0, 0)},
+            {"group", group, CNCBUS_MAKE_ADDRESS(255, 255, 255, 255)},
+        };
+
+        for (int route = 0; route < ARRAY_SIZE(routes); ++route) {
+            // time the sends only, flush in between bursts small enough to never run out of message links
+            const int fanout = (route == 1) ? num_receivers : 1;
+            const int burst_size = cncbus_get_occupancy(bus).num_msg_links / fanout;
+            microseconds_t send_time = {0};
+
+            for (int i = 0; i < message_count; i += burst_size) {
+                const microseconds_t start = adk_read_microsecond_clock();
+                const int num_sends = min_int(burst_size, message_count - i);
+                for (int j = 0; j < num_sends; ++j) {
+                    cncbus_send_async(cncbus_msg_begin_checked(bus, 0), CNCBUS_INVALID_ADDRESS, routes[route].address, routes[route].subnet_mask, NULL);
+                }
+                send_time.us += adk_read_microsecond_clock().us - start.us;
+
+                while (cncbus_dispatch(bus, cncbus_dispatch_flush) != cncbus_dispatch_no_messages) {
+                }
+            }
+
+            print_message("%2d receivers, %-7s: %0.2f sends per second\n", num_receivers, routes[route].name, (float)((double)1000000 / (double)send_time.us) * (float)message_count);
+        }
+
+        for (int i = 0; i < num_receivers; ++i) {
+            cncbus_disconnect(bus, &test_data->receivers[i].base);
+        }
+    }
+}
+
 int test_cncbus() {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(bus_test_connect_disconnect, NULL, NULL),
         cmocka_unit_test_setup_teardown(bus_test_send_no_receivers, NULL, NULL),
         cmocka_unit_test_setup_teardown(bus_test_simple_pump, NULL, NULL),
         cmocka_unit_test_setup_teardown(bus_test_threaded_dispatch, NULL, NULL),
-        cmocka_unit_test_setup_teardown(bus_test_threaded_send_and_dispatch, NULL, NULL)
+        cmocka_unit_test_setup_teardown(bus_test_threaded_send_and_dispatch, NULL, NULL),
+        cmocka_unit_test_setup_teardown(bus_test_batched_dispatch, NULL, NULL),
+        cmocka_unit_test_setup_teardown(bus_test_backpressure, NULL, NULL),
+        cmocka_unit_test_setup_teardown(bus_test_routing, NULL, NULL),
+        cmocka_unit_test_setup_teardown(bus_test_send_throughput_vs_receiver_count, NULL, NULL)
 
     };
 
@@ -254,8 +254,8 @@ static void heap_test_with_parameters(
     ASSERT(!alignment || IS_POW2(alignment));
     const int clamped_alignment = max_int(alignment, sizeof(void *));
     const size_t aligned_heap_struct_size = ALIGN_INT(sizeof(heap_t), clamped_alignment);
-    assert_true(heap_size > aligned_heap_struct_size);
     const size_t page_aligned_heap_size = PAGE_ALIGN_INT(heap_size);
+    assert_true(page_aligned_heap_size > aligned_heap_struct_size);
 
 #ifdef DEBUG_PAGE_MEMORY_SERVICES
     static const char * guard_page_strings[] = {
@@ -313,7 +313,8 @@ static void heap_test_with_parameters(
     // non-page aligned heap memory test
     {
         const size_t aligned_heap_size = ALIGN_INT(heap_size, clamped_alignment);
-        const size_t emplace_heap_size = aligned_heap_size - aligned_heap_struct_size;
+        // the heap_t (and its free block index) may not fit in very small regions
+        const size_t emplace_heap_size = (aligned_heap_size > aligned_heap_struct_size) ? aligned_heap_size - aligned_heap_struct_size : 0;
         void * const p = malloc(aligned_heap_size + clamped_alignment - 1);
         TRAP_OUT_OF_MEMORY(p);
         void * const aligned_p = (void *)ALIGN_PTR(p, clamped_alignment);
@@ -395,8 +396,78 @@ static void heap_unit_test(void ** state) {
     }
 }
 
+static void heap_fragmentation_unit_test(void ** state) {
+    enum {
+        heap_size = 1024 * 1024,
+        num_blocks = 64,
+        block_size = 1024
+    };
+
+    void * const p = malloc(heap_size);
+    TRAP_OUT_OF_MEMORY(p);
+
+    heap_t heap;
+    heap_init_with_region(&heap, MEM_REGION(.ptr = p, .size = heap_size), 8, 0, "heap_fragmentation_tests");
+    heap_enable_debug_checks(&heap, true);
+
+    heap_fragmentation_metrics_t metrics = heap_get_fragmentation_metrics(&heap);
+    assert_true(metrics.largest_free_block_size == heap_size);
+    assert_true(metrics.fragmentation == 0.f);
+
+    void * blocks[num_blocks];
+    for (int i = 0; i < num_blocks; ++i) {
+        blocks[i] = heap_alloc(&heap, block_size, MALLOC_TAG);
+    }
+
+    // punch holes, none of them can merge with each other
+    for (int i = 0; i < num_blocks; i += 2) {
+        heap_free(&heap, blocks[i], MALLOC_TAG);
+        blocks[i] = NULL;
+    }
+
+    metrics = heap_get_fragmentation_metrics(&heap);
+    assert_true(metrics.num_free_blocks == num_blocks / 2 + 1);
+    assert_true(metrics.largest_free_block_size < heap_size - num_blocks * block_size);
+    assert_true(metrics.largest_free_block_size > heap_size - (num_blocks + 1) * estimate_block_cost(&heap, block_size));
+    assert_true(metrics.fragmentation > 0.f);
+
+    // a request that fits a hole exactly must not be carved from the large tail block
+    const size_t tail_size_before = metrics.largest_free_block_size;
+    blocks[0] = heap_alloc(&heap, block_size, MALLOC_TAG);
+    assert_true(heap_get_fragmentation_metrics(&heap).largest_free_block_size == tail_size_before);
+    assert_true(heap_get_fragmentation_metrics(&heap).num_free_blocks == num_blocks / 2);
+
+    for (int i = 0; i < num_blocks; ++i) {
+        if (blocks[i]) {
+            heap_free(&heap, blocks[i], MALLOC_TAG);
+        }
+    }
+
+    metrics = heap_get_fragmentation_metrics(&heap);
+    assert_true(metrics.num_free_blocks == 1);
+    assert_true(metrics.largest_free_block_size == heap_size);
+    assert_true(metrics.fragmentation == 0.f);
+
+    // a small hole that is slightly too small must not hide the large tail block
+    for (size_t size = 8; size <= 128; size += 8) {
+        void * const hole = heap_alloc(&heap, size, MALLOC_TAG);
+        void * const fence = heap_alloc(&heap, 8, MALLOC_TAG);
+        heap_free(&heap, hole, MALLOC_TAG);
+        void * const larger = heap_unchecked_alloc(&heap, size + 8, MALLOC_TAG);
+        assert_non_null(larger);
+        heap_free(&heap, larger, MALLOC_TAG);
+        heap_free(&heap, fence, MALLOC_TAG);
+    }
+
+    assert_true(heap_get_fragmentation_metrics(&heap).num_free_blocks == 1);
+
+    heap_destroy(&heap, MALLOC_TAG);
+    free(p);
+}
+
 int test_heap() {
     const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(heap_fragmentation_unit_test, NULL, NULL),
         cmocka_unit_test_setup_teardown(heap_unit_test, NULL, NULL),
     };
 
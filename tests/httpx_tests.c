@@ -189,6 +189,239 @@ static void test_http_request_callbacks(void ** _state) {
     adk_httpx_response_free(getter);
 }
 
+/*
+===============================================================================
+Loopback server answering each connection with a fixed response, lets the pump's
+wakeup and latency accounting be tested without network access.
+===============================================================================
+*/
+
+enum {
+    httpx_test_loopback_request_count = 8,
+    // far above the loopback round trip, but well below the pump's idle poll timeout
+    httpx_test_loopback_max_latency_ms = 250,
+    httpx_test_streamed_body_size = 256 * 1024,
+    // only room for a few fragments, the rest of the streamed body has to come from the fragment budget
+    httpx_test_small_fragment_buffers_size = 4 * network_pump_fragment_size,
+};
+
+static struct {
+    sb_socket_t server_sock;
+    sb_thread_id_t server_thread;
+    int num_connections;
+    const_mem_region_t body;
+} loopback;
+
+static uint16_t loopback_ntohs(const uint16_t num) {
+    static const int n = 1;
+    return (*(char *)&n == 1) ? __builtin_bswap16(num) : num;
+}
+
+static int loopback_server_proc(void * const arg) {
+    for (int i = 0; i < loopback.num_connections; ++i) {
+        sb_socket_t conn_sock;
+        if (sb_accept_socket(loopback.server_sock, NULL, &conn_sock).result != sb_socket_accept_success) {
+            break;
+        }
+        sb_enable_blocking_socket(conn_sock, sb_socket_blocking_enabled);
+
+        // read until the end of the request headers
+        char request[2048] = {0};
+        int request_size = 0;
+        while ((request_size < (int)sizeof(request) - 1) && !strstr(request, "\r\n\r\n")) {
+            int received = 0;
+            if ((sb_socket_receive(conn_sock, MEM_REGION(.ptr = request + request_size, .size = sizeof(request) - 1 - request_size), 0, &received).result != sb_socket_receive_success) || (received <= 0)) {
+                break;
+            }
+            request_size += received;
+            request[request_size] = '\0';
+        }
+
+        char response_header[128];
+        const int header_size = sprintf_s(response_header, ARRAY_SIZE(response_header), "HTTP/1.1 200 OK\r\nContent-Length: %" PRIu64 "\r\nConnection: close\r\n\r\n", (uint64_t)loopback.body.size);
+        int sent = 0;
+        sb_socket_send(conn_sock, CONST_MEM_REGION(.ptr = response_header, .size = header_size), 0, &sent);
+        for (size_t offset = 0; offset < loopback.body.size; offset += sent) {
+            if ((sb_socket_send(conn_sock, CONST_MEM_REGION(.byte_ptr = loopback.body.byte_ptr + offset, .size = loopback.body.size - offset), 0, &sent).result != sb_socket_send_success) || (sent <= 0)) {
+                break;
+            }
+        }
+        sb_close_socket(conn_sock);
+    }
+    return 0;
+}
+
+// Starts a server on an ephemeral loopback port answering `num_connections` requests with `body`, returns the port
+static uint16_t loopback_start(const int num_connections, const const_mem_region_t body) {
+    loopback.num_connections = num_connections;
+    loopback.body = body;
+
+    sb_create_socket(sb_socket_family_IPv4, sb_socket_type_stream, sb_socket_protocol_tcp, &loopback.server_sock);
+    sb_sockaddr_t addr = {0};
+    addr.sin_family = sb_socket_family_IPv4;
+    addr.sin_addr.ipv4_u8[0] = 127;
+    addr.sin_addr.ipv4_u8[3] = 1;
+    assert_int_equal(sb_bind_socket(loopback.server_sock, &addr).result, sb_socket_bind_success);
+    assert_int_equal(sb_listen_socket(loopback.server_sock, num_connections).result, sb_socket_listen_success);
+    sb_getsockname(loopback.server_sock, &addr);
+
+    loopback.server_thread = sb_create_thread("httpx_loopback", sb_thread_default_options, loopback_server_proc, NULL, MALLOC_TAG);
+    return loopback_ntohs(addr.sin_port);
+}
+
+static void loopback_stop() {
+    sb_join_thread(loopback.server_thread);
+    sb_close_socket(loopback.server_sock);
+}
+
+static void test_http_loopback_latency(void ** state) {
+    static const char body[] = "hello";
+    const uint16_t port = loopback_start(httpx_test_loopback_request_count, CONST_MEM_REGION(.ptr = body, .size = sizeof(body) - 1));
+
+    // A long sleep period shows up as request latency unless the pump is woken up for new requests
+    const mem_region_t region = MEM_REGION(malloc(httpx_test_heap_size), httpx_test_heap_size);
+    TRAP_OUT_OF_MEMORY(region.ptr);
+    const mem_region_t fragment_buffers_region = MEM_REGION(malloc(httpx_test_fragment_buffers_size), httpx_test_fragment_buffers_size);
+    TRAP_OUT_OF_MEMORY(fragment_buffers_region.ptr);
+
+    adk_httpx_client_t * const client = adk_httpx_client_create(
+        region,
+        fragment_buffers_region,
+        network_pump_fragment_size,
+        1000,
+        unit_test_guard_page_mode,
+        adk_httpx_init_normal,
+        "tests-httpx-loopback");
+
+    char url[64];
+    sprintf_s(url, ARRAY_SIZE(url), "http://127.0.0.1:%u/", port);
+
+    for (int i = 0; i < httpx_test_loopback_request_count; ++i) {
+        // let the pump go idle between requests
+        sb_thread_sleep((milliseconds_t){20});
+
+        adk_httpx_response_t * const response = adk_httpx_send(adk_httpx_client_request(client, adk_httpx_method_get, url));
+        while (adk_httpx_client_tick(client)) {
+            sb_thread_sleep((milliseconds_t){1});
+        }
+
+        assert_int_equal(adk_httpx_response_get_result(response), adk_httpx_ok);
+        assert_int_equal(adk_httpx_response_get_response_code(response), 200);
+        assert_int_equal(adk_httpx_response_get_body(response).size, 5);
+        adk_httpx_response_free(response);
+    }
+
+    const adk_httpx_client_latency_t latency = adk_httpx_client_get_latency(client);
+    assert_int_equal(latency.time_to_first_byte.count, httpx_test_loopback_request_count);
+    assert_int_equal(latency.time_to_complete.count, httpx_test_loopback_request_count);
+
+    uint32_t bucket_total = 0;
+    for (int i = 0; i < adk_httpx_latency_histogram_num_buckets; ++i) {
+        bucket_total += latency.time_to_first_byte.buckets[i];
+    }
+    assert_int_equal(bucket_total, httpx_test_loopback_request_count);
+    assert_true(latency.time_to_first_byte.min.us <= latency.time_to_first_byte.max.us);
+    assert_true(latency.time_to_first_byte.max.us <= latency.time_to_complete.max.us);
+
+    print_message(
+        "httpx loopback: time to first byte avg [%" PRIu64 "us] max [%" PRIu64 "us]\n",
+        latency.time_to_first_byte.total.us / latency.time_to_first_byte.count,
+        latency.time_to_first_byte.max.us);
+    assert_true(latency.time_to_first_byte.max.us < httpx_test_loopback_max_latency_ms * 1000);
+
+    adk_httpx_client_reset_latency(client);
+    assert_int_equal(adk_httpx_client_get_latency(client).time_to_first_byte.count, 0);
+
+    adk_httpx_client_free(client);
+    free(region.ptr);
+    free(fragment_buffers_region.ptr);
+
+    loopback_stop();
+}
+
+typedef struct httpx_test_fragment_consumer_t {
+    adk_httpx_body_fragment_t * fragments[httpx_test_streamed_body_size / 512];
+    int num_fragments;
+    size_t num_bytes;
+} httpx_test_fragment_consumer_t;
+
+static bool httpx_test_on_body_fragment(adk_httpx_response_t * const response, adk_httpx_body_fragment_t * const fragment, void * userdata) {
+    httpx_test_fragment_consumer_t * const consumer = userdata;
+    assert_true(consumer->num_fragments < (int)ARRAY_SIZE(consumer->fragments));
+    // hold on to every fragment until the request completes, which only works if the pump can grow its pool
+    consumer->fragments[consumer->num_fragments++] = fragment;
+    consumer->num_bytes += adk_httpx_body_fragment_get_data(fragment).size;
+    return true;
+}
+
+static void test_http_body_fragment_hand_off(void ** state) {
+    uint8_t * const body = malloc(httpx_test_streamed_body_size);
+    TRAP_OUT_OF_MEMORY(body);
+    for (int i = 0; i < httpx_test_streamed_body_size; ++i) {
+        body[i] = (uint8_t)(i * 7);
+    }
+    const uint16_t port = loopback_start(1, CONST_MEM_REGION(.ptr = body, .size = httpx_test_streamed_body_size));
+
+    const mem_region_t region = MEM_REGION(malloc(httpx_test_heap_size), httpx_test_heap_size);
+    TRAP_OUT_OF_MEMORY(region.ptr);
+    const mem_region_t fragment_buffers_region = MEM_REGION(malloc(httpx_test_small_fragment_buffers_size), httpx_test_small_fragment_buffers_size);
+    TRAP_OUT_OF_MEMORY(fragment_buffers_region.ptr);
+
+    adk_httpx_client_t * const client = adk_httpx_client_create(
+        region,
+        fragment_buffers_region,
+        network_pump_fragment_size,
+        network_pump_sleep_period,
+        unit_test_guard_page_mode,
+        adk_httpx_init_normal,
+        "tests-httpx-fragments");
+    adk_httpx_client_set_fragment_budget(client, 2 * httpx_test_streamed_body_size);
+
+    char url[64];
+    sprintf_s(url, ARRAY_SIZE(url), "http://127.0.0.1:%u/", port);
+
+    httpx_test_fragment_consumer_t consumer = {0};
+    adk_httpx_request_t * const request = adk_httpx_client_request(client, adk_httpx_method_get, url);
+    adk_httpx_request_set_on_body_fragment(request, httpx_test_on_body_fragment);
+    adk_httpx_request_set_userdata(request, &consumer);
+    adk_httpx_response_t * const response = adk_httpx_send(request);
+    while (adk_httpx_client_tick(client)) {
+        sb_thread_sleep((milliseconds_t){1});
+    }
+
+    assert_int_equal(adk_httpx_response_get_result(response), adk_httpx_ok);
+    assert_int_equal(adk_httpx_response_get_response_code(response), 200);
+    // streamed bodies are not buffered
+    assert_int_equal(adk_httpx_response_get_body(response).size, 0);
+    assert_int_equal(consumer.num_bytes, httpx_test_streamed_body_size);
+
+    adk_httpx_fragment_metrics_t metrics = adk_httpx_client_get_fragment_metrics(client);
+    assert_int_equal(metrics.num_held, consumer.num_fragments);
+    assert_int_equal(metrics.num_stalls, 0);
+    assert_true(metrics.grown_bytes > 0);
+    assert_true(metrics.grown_bytes <= metrics.budget);
+
+    size_t offset = 0;
+    for (int i = 0; i < consumer.num_fragments; ++i) {
+        const const_mem_region_t data = adk_httpx_body_fragment_get_data(consumer.fragments[i]);
+        assert_memory_equal(data.ptr, body + offset, data.size);
+        offset += data.size;
+        adk_httpx_body_fragment_release(consumer.fragments[i]);
+    }
+
+    metrics = adk_httpx_client_get_fragment_metrics(client);
+    assert_int_equal(metrics.num_held, 0);
+    assert_int_equal(metrics.num_free, metrics.num_fragments);
+
+    adk_httpx_response_free(response);
+    adk_httpx_client_free(client);
+    free(region.ptr);
+    free(fragment_buffers_region.ptr);
+
+    loopback_stop();
+    free(body);
+}
+
 static int setup(void ** state) {
     statics.region = MEM_REGION(malloc(httpx_test_heap_size), httpx_test_heap_size);
     TRAP_OUT_OF_MEMORY(statics.region.ptr);
@@ -222,6 +455,8 @@ int test_httpx() {
         cmocka_unit_test(test_http_requests),
         cmocka_unit_test(test_http_request_callbacks),
         cmocka_unit_test(test_concurrent_http_requests),
+        cmocka_unit_test(test_http_loopback_latency),
+        cmocka_unit_test(test_http_body_fragment_hand_off),
     };
 
     return cmocka_run_group_tests(tests, setup, teardown);
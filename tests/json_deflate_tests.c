@@ -17,8 +17,10 @@ json_deflate_tests.c
 #include "source/adk/json_deflate/json_deflate.h"
 #include "source/adk/json_deflate/private/json_deflate.h"
 #include "source/adk/json_deflate_tool/json_deflate_tool.h"
+#include "source/adk/json_deflate_tool/private/json_deflate_tool.h"
 #include "source/adk/steamboat/sb_platform.h"
 #include "source/adk/steamboat/sb_socket.h"
+#include "source/adk/steamboat/sb_thread.h"
 #include "testapi.h"
 
 #ifdef _WASM3
@@ -87,6 +89,7 @@ static void copy_file(const char * const target, const char * const source) {
 
 static size_t get_file_size_by_filename(const char * const filename) {
     sb_file_t * const file = sb_fopen(sb_app_root_directory, filename, "rb");
+    VERIFY_MSG(file, "failed to open test file: %s", filename);
     sb_fseek(file, 0, sb_seek_end);
     const size_t file_size = (size_t)sb_ftell(file);
     sb_fclose(file);
@@ -415,6 +418,822 @@ static void test_invalid_input() {
     json_deflate_free(layout.ptr);
 }
 
+static uint64_t read_deflated_uint(const json_deflate_schema_type_t * const type, const uint8_t * const src) {
+    if (type->var == sizeof(uint64_t)) {
+        return *(const uint64_t *)src;
+    } else {
+        assert_int_equal(type->var, sizeof(uint32_t));
+        return *(const uint32_t *)src;
+    }
+}
+
+// Walks the schema and compares two deflated (native) values, pointers are followed rather than compared
+static void assert_deflated_values_equal(const json_deflate_bump_area_t * const schema_area, const json_deflate_schema_type_t * const type, const uint8_t * const a, const uint8_t * const b) {
+    const json_deflate_schema_field_t * const fields = json_deflate_bump_get_ptr(schema_area, type->fields);
+    switch (json_deflate_type_get_class(type)) {
+        case schema_type_struct:
+        case schema_type_map:
+            // scalars are builtin structs without fields
+            if (!type->field_count) {
+                assert_memory_equal(a, b, type->var);
+            }
+            for (uint32_t i = 0; i < type->field_count; ++i) {
+                const json_deflate_schema_type_t * const field_type = json_deflate_bump_get_ptr(schema_area, fields[i].type);
+                assert_deflated_values_equal(schema_area, field_type, a + fields[i].offset, b + fields[i].offset);
+            }
+            break;
+        case schema_type_variant: {
+            const json_deflate_schema_field_t * const tag_field = json_deflate_type_lookup_field(schema_area, type, "tag");
+            assert_int_equal(a[tag_field->offset], b[tag_field->offset]);
+            for (uint32_t i = 0; i < type->field_count; ++i) {
+                if ((&fields[i] != tag_field) && (fields[i].choice_value == a[tag_field->offset])) {
+                    const json_deflate_schema_type_t * const choice_type = json_deflate_bump_get_ptr(schema_area, fields[i].type);
+                    assert_deflated_values_equal(schema_area, choice_type, a + fields[i].offset, b + fields[i].offset);
+                    break;
+                }
+            }
+            break;
+        }
+        case schema_type_array: {
+            const json_deflate_schema_field_t * const field_ptr = json_deflate_type_lookup_field(schema_area, type, "ptr");
+            const json_deflate_schema_field_t * const field_cap = json_deflate_type_lookup_field(schema_area, type, "cap");
+            const json_deflate_schema_field_t * const field_len = json_deflate_type_lookup_field(schema_area, type, "len");
+            const json_deflate_schema_type_t * const cap_type = json_deflate_bump_get_ptr(schema_area, field_cap->type);
+            const json_deflate_schema_type_t * const len_type = json_deflate_bump_get_ptr(schema_area, field_len->type);
+            const json_deflate_schema_type_t * const elem_type = json_deflate_bump_get_ptr(schema_area, type->rel_type);
+
+            const uint64_t length = read_deflated_uint(len_type, a + field_len->offset);
+            assert_int_equal(length, read_deflated_uint(len_type, b + field_len->offset));
+            assert_int_equal(read_deflated_uint(cap_type, a + field_cap->offset), read_deflated_uint(cap_type, b + field_cap->offset));
+
+            const uint8_t * const a_elems = *(uint8_t * const *)(a + field_ptr->offset);
+            const uint8_t * const b_elems = *(uint8_t * const *)(b + field_ptr->offset);
+            assert_int_equal(a_elems == NULL, b_elems == NULL);
+            for (uint64_t i = 0; i < length; ++i) {
+                assert_deflated_values_equal(schema_area, elem_type, a_elems + i * elem_type->var, b_elems + i * elem_type->var);
+            }
+            break;
+        }
+    }
+}
+
+static void deflate_stream_and_dom(const char * const name, const int iterations, microseconds_t * const out_stream_time, microseconds_t * const out_dom_time, size_t * const out_data_size) {
+    JD_TEST_CASE_FILE(binary_schema_file, "testcases", "schema.dat", name);
+    JD_TEST_CASE_FILE(json_data_file, "testcases", "data.json", name);
+
+    const mem_region_t layout = read_all_bytes(binary_schema_file);
+    const mem_region_t json_data = read_all_bytes(json_data_file);
+
+    json_deflate_bump_area_t schema_area;
+    ZEROMEM(&schema_area);
+    json_deflate_metadata_t metadata = {0};
+    json_deflate_schema_context_t wasm_ctx = {0};
+    json_deflate_schema_context_t native_ctx = {0};
+    assert_int_equal(json_deflate_binary_read_from_memory(layout.consted, &schema_area, &metadata, &wasm_ctx, &native_ctx), json_deflate_binary_read_success);
+    const json_deflate_schema_type_t * const root_type = json_deflate_bump_get_ptr(&schema_area, native_ctx.ty_root);
+
+    const size_t output_size = json_data.size * 16 + 1024 * 1024;
+    const mem_region_t stream_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+    const mem_region_t dom_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+    TRAP_OUT_OF_MEMORY(stream_output.ptr);
+    TRAP_OUT_OF_MEMORY(dom_output.ptr);
+
+    json_deflate_parse_data_result_t stream_result = {0};
+    json_deflate_parse_data_result_t dom_result = {0};
+
+    const microseconds_t stream_start = adk_read_microsecond_clock();
+    for (int i = 0; i < iterations; ++i) {
+        bool fallback = false;
+        stream_result = json_deflate_parse_data_stream(layout.consted, json_data.consted, stream_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash, &fallback);
+        assert_false(fallback);
+    }
+    const microseconds_t stream_end = adk_read_microsecond_clock();
+
+    for (int i = 0; i < iterations; ++i) {
+        dom_result = json_deflate_parse_data_dom(layout.consted, json_data.consted, dom_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash);
+    }
+    const microseconds_t dom_end = adk_read_microsecond_clock();
+
+    assert_int_equal(stream_result.result.status, dom_result.result.status);
+    assert_int_equal(stream_result.result.offset, dom_result.result.offset);
+    if (stream_result.result.status == json_deflate_parse_status_success) {
+        assert_deflated_values_equal(&schema_area, root_type, stream_output.byte_ptr + stream_result.result.offset, dom_output.byte_ptr + dom_result.result.offset);
+    }
+
+    *out_stream_time = (microseconds_t){stream_end.us - stream_start.us};
+    *out_dom_time = (microseconds_t){dom_end.us - stream_end.us};
+    *out_data_size = json_data.size;
+
+    free(stream_output.ptr);
+    free(dom_output.ptr);
+    json_deflate_free(json_data.ptr);
+    json_deflate_free(layout.ptr);
+}
+
+// every case with a checked in schema.dat, `zst-bottom` and `null-none` are left out since the schema tool rejects their uninstantiable types
+static const char * const deflate_compare_test_cases[] = {
+    "booleans",
+    "integers",
+    "numbers",
+    "strings",
+    "strings-alt",
+    "strings-alt-2",
+    "mismatch",
+    "keywords",
+    "snake_keys",
+    "variants",
+    "array-in-variant",
+    "object-in-variant",
+    "results",
+    "arrays",
+    "zst",
+    "groups",
+    "groups-collections",
+    "groups-inner",
+    "names",
+    "colon",
+    "field-name",
+    "tag-in-boolean",
+    "tag-in-vector",
+    "tag-in-boolean-or-vector",
+    "tag-in-option",
+    "tag-pool-1",
+    "wrong-enum",
+    "map",
+    "top-array",
+    "top-map",
+    "huge",
+    "real",
+    "real-2",
+    "real-2-groupped",
+    "real-2-groupped-alt",
+    "real-2-groupped-alt-2",
+    "real-2-groupped-alt-3",
+    "real-3",
+    "real-4",
+    "keys",
+    "slice",
+};
+
+static void test_deflate_stream_matches_dom(void ** state) {
+    for (int i = 0; i < ARRAY_SIZE(deflate_compare_test_cases); ++i) {
+        microseconds_t stream_time, dom_time;
+        size_t data_size;
+        deflate_stream_and_dom(deflate_compare_test_cases[i], 1, &stream_time, &dom_time, &data_size);
+    }
+}
+
+#ifdef HAS_DEFLATE_GEN
+static mem_region_t build_field_table_layout(const const_mem_region_t sorted_layout) {
+    json_deflate_bump_area_t sorted_area;
+    ZEROMEM(&sorted_area);
+    json_deflate_metadata_t metadata = {0};
+    json_deflate_schema_context_t wasm_ctx = {0};
+    json_deflate_schema_context_t native_ctx = {0};
+    assert_int_equal(json_deflate_binary_read_from_memory(sorted_layout, &sorted_area, &metadata, &wasm_ctx, &native_ctx), json_deflate_binary_read_success);
+
+    // writable copy of the schema blob with unchanged offsets: offset 0 is never allocated and the area keeps a spare byte at the end
+    const size_t blob_size = sorted_area.payload.borrowed.capacity;
+    json_deflate_bump_area_t schema_area;
+    ZEROMEM(&schema_area);
+    json_deflate_bump_owned_init(&schema_area, blob_size + 2, false);
+    assert_non_null(json_deflate_bump_alloc(&schema_area, blob_size - 1, 1));
+    memcpy(json_deflate_get_single_buffer(&schema_area), sorted_area.payload.borrowed.borrowed_buffer, blob_size);
+
+    json_deflate_schema_build_field_tables(&schema_area, &wasm_ctx);
+    json_deflate_schema_build_field_tables(&schema_area, &native_ctx);
+
+    FILE * const layout_file = tmpfile();
+    assert_non_null(layout_file);
+    json_deflate_binary_write(layout_file, &schema_area, &metadata, &wasm_ctx, &native_ctx);
+    const long layout_size = ftell(layout_file);
+    const mem_region_t layout = MEM_REGION(.ptr = json_deflate_calloc(layout_size, 1), .size = layout_size);
+    fseek(layout_file, 0, SEEK_SET);
+    assert_int_equal(fread(layout.ptr, 1, layout.size, layout_file), layout.size);
+    fclose(layout_file);
+
+    json_deflate_bump_owned_destroy(&schema_area);
+    return layout;
+}
+
+static void test_deflate_field_tables(void ** state) {
+    // the checked in schemas predate the field tables, so this also covers reading the previous version
+    for (int i = 0; i < ARRAY_SIZE(deflate_compare_test_cases); ++i) {
+        JD_TEST_CASE_FILE(binary_schema_file, "testcases", "schema.dat", deflate_compare_test_cases[i]);
+        JD_TEST_CASE_FILE(json_data_file, "testcases", "data.json", deflate_compare_test_cases[i]);
+
+        const mem_region_t sorted_layout = read_all_bytes(binary_schema_file);
+        const mem_region_t table_layout = build_field_table_layout(sorted_layout.consted);
+        const mem_region_t json_data = read_all_bytes(json_data_file);
+        assert_int_equal(((const json_deflate_binary_header_t *)table_layout.ptr)->version, json_deflate_binary_version);
+
+        json_deflate_bump_area_t schema_area;
+        ZEROMEM(&schema_area);
+        json_deflate_metadata_t metadata = {0};
+        json_deflate_schema_context_t wasm_ctx = {0};
+        json_deflate_schema_context_t native_ctx = {0};
+        assert_int_equal(json_deflate_binary_read_from_memory(sorted_layout.consted, &schema_area, &metadata, &wasm_ctx, &native_ctx), json_deflate_binary_read_success);
+        const json_deflate_schema_type_t * const root_type = json_deflate_bump_get_ptr(&schema_area, native_ctx.ty_root);
+
+        const size_t output_size = json_data.size * 16 + 1024 * 1024;
+        const mem_region_t sorted_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+        const mem_region_t table_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+        TRAP_OUT_OF_MEMORY(sorted_output.ptr);
+        TRAP_OUT_OF_MEMORY(table_output.ptr);
+
+        bool fallback = false;
+        const json_deflate_parse_data_result_t sorted_result = json_deflate_parse_data_stream(sorted_layout.consted, json_data.consted, sorted_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash, &fallback);
+        const json_deflate_parse_data_result_t table_result = json_deflate_parse_data_stream(table_layout.consted, json_data.consted, table_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash, &fallback);
+        assert_int_equal(sorted_result.result.status, table_result.result.status);
+        assert_int_equal(sorted_result.result.offset, table_result.result.offset);
+        if (sorted_result.result.status == json_deflate_parse_status_success) {
+            assert_deflated_values_equal(&schema_area, root_type, sorted_output.byte_ptr + sorted_result.result.offset, table_output.byte_ptr + table_result.result.offset);
+        }
+
+        memset(table_output.ptr, 0, table_output.size);
+        const json_deflate_parse_data_result_t table_dom_result = json_deflate_parse_data_dom(table_layout.consted, json_data.consted, table_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash);
+        assert_int_equal(sorted_result.result.status, table_dom_result.result.status);
+        if (sorted_result.result.status == json_deflate_parse_status_success) {
+            assert_deflated_values_equal(&schema_area, root_type, sorted_output.byte_ptr + sorted_result.result.offset, table_output.byte_ptr + table_dom_result.result.offset);
+        }
+
+        free(sorted_output.ptr);
+        free(table_output.ptr);
+        json_deflate_free(json_data.ptr);
+        json_deflate_free(table_layout.ptr);
+        json_deflate_free(sorted_layout.ptr);
+    }
+}
+
+static void test_deflate_field_tables_cycle(void ** state) {
+    // types without fields never get a field table, a cycle through them must still end
+    json_deflate_bump_area_t area;
+    ZEROMEM(&area);
+    json_deflate_bump_owned_init(&area, 4096, false);
+    json_deflate_schema_type_t * const wrapper = json_deflate_bump_alloc(&area, sizeof(json_deflate_schema_type_t), sizeof(json_deflate_schema_type_t));
+    json_deflate_schema_type_t * const inner = json_deflate_bump_alloc(&area, sizeof(json_deflate_schema_type_t), sizeof(json_deflate_schema_type_t));
+    json_deflate_type_init(wrapper);
+    json_deflate_type_init(inner);
+    wrapper->rel_type = json_deflate_bump_get_offset(&area, inner);
+    inner->rel_type = json_deflate_bump_get_offset(&area, wrapper);
+    inner->type_ctor = json_deflate_bump_get_offset(&area, inner);
+
+    json_deflate_schema_context_t ctx = {0};
+    ctx.ty_root = json_deflate_bump_get_offset(&area, wrapper);
+    ctx.ty_option = json_deflate_bump_get_offset(&area, inner);
+    json_deflate_schema_build_field_tables(&area, &ctx);
+    assert_false(json_deflate_type_has_field_table(wrapper));
+    assert_false(json_deflate_type_has_field_table(inner));
+
+    json_deflate_bump_owned_destroy(&area);
+}
+#endif
+
+static void test_deflate_scan(void ** state) {
+    // every length and position crosses the vector blocks and the scalar tail
+    uint8_t buffer[96];
+    for (size_t size = 0; size <= ARRAY_SIZE(buffer); ++size) {
+        for (size_t position = 0; position <= size; ++position) {
+            static const uint8_t specials[] = {'\"', '\\', 0x80, 0xFF};
+            for (int i = 0; i < ARRAY_SIZE(specials); ++i) {
+                memset(buffer, 'a', sizeof(buffer));
+                if (position < size) {
+                    buffer[position] = specials[i];
+                }
+                assert_int_equal(json_deflate_scan_string(buffer, size), position);
+            }
+
+            static const uint8_t non_whitespace[] = {'!', '{', 0x7F, 0x80, 0xFF};
+            for (int i = 0; i < ARRAY_SIZE(non_whitespace); ++i) {
+                for (size_t j = 0; j < sizeof(buffer); ++j) {
+                    buffer[j] = (uint8_t)(j % 33);
+                }
+                if (position < size) {
+                    buffer[position] = non_whitespace[i];
+                }
+                assert_int_equal(json_deflate_scan_whitespace(buffer, size), position);
+            }
+        }
+    }
+
+    static const char * const valid[] = {"\xC3\xA9", "\xC3\xA9\xE2\x82\xAC", "\xE2\x82\xAC", "\xED\x9F\xBF", "\xF0\x9F\x98\x80", "\xF4\x8F\xBF\xBF"};
+    for (int i = 0; i < ARRAY_SIZE(valid); ++i) {
+        const size_t length = strlen(valid[i]);
+        json_deflate_utf8_state_t utf8 = {0};
+        assert_int_equal(json_deflate_utf8_validate(&utf8, (const uint8_t *)valid[i], length), length);
+        assert_int_equal(utf8.remaining, 0);
+
+        // one byte at a time, as if split across fragments
+        ZEROMEM(&utf8);
+        for (size_t j = 0; j < length; ++j) {
+            assert_int_equal(json_deflate_utf8_validate(&utf8, (const uint8_t *)valid[i] + j, 1), 1);
+        }
+        assert_int_equal(utf8.remaining, 0);
+    }
+
+    static const char * const invalid[] = {"\x80", "\xC0\xAF", "\xC3(", "\xE0\x80\xAF", "\xED\xA0\x80", "\xF0\x80\x80\xAF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xE2\x82\""};
+    for (int i = 0; i < ARRAY_SIZE(invalid); ++i) {
+        json_deflate_utf8_state_t utf8 = {0};
+        assert_int_equal(json_deflate_utf8_validate(&utf8, (const uint8_t *)invalid[i], strlen(invalid[i])), JSON_DEFLATE_UTF8_INVALID);
+    }
+
+    // arrays are scanned from just past the opening bracket, brackets and commas in strings are not structural
+    static const char array[] = " 1, [2, 3], {\"a\": \"],\\\"\"}, \"4\" ] trailing";
+    json_deflate_array_scan_t scan;
+    assert_true(json_deflate_scan_array((const uint8_t *)array, strlen(array), SIZE_MAX, &scan));
+    assert_int_equal(scan.end, strchr(array, 't') - array - 2);
+    assert_int_equal(scan.count, 4);
+    assert_int_equal(scan.num_chunks, 1);
+
+    assert_true(json_deflate_scan_array((const uint8_t *)array, strlen(array), 1, &scan));
+    assert_int_equal(scan.num_chunks, 4);
+    static const char * const chunk_starts[] = {" 1", " [2", " {", " \"4"};
+    for (int i = 0; i < ARRAY_SIZE(chunk_starts); ++i) {
+        assert_int_equal(scan.chunk_first[i], i);
+        assert_memory_equal(array + scan.chunk_offsets[i], chunk_starts[i], strlen(chunk_starts[i]));
+    }
+
+    assert_true(json_deflate_scan_array((const uint8_t *)" ]", 2, 1, &scan));
+    assert_int_equal(scan.count, 0);
+    assert_false(json_deflate_scan_array((const uint8_t *)"1, [2]", 6, 1, &scan));
+    assert_false(json_deflate_scan_array((const uint8_t *)"\"]", 2, 1, &scan));
+    assert_false(json_deflate_scan_array((const uint8_t *)"1}", 2, 1, &scan));
+}
+
+static json_deflate_parse_result_t deflate_stream_in_fragments(const const_mem_region_t layout, const uint32_t expected_size, const uint32_t schema_hash, const const_mem_region_t json_data, const size_t fragment_size, const mem_region_t output) {
+    json_deflate_stream_t stream;
+    json_deflate_stream_init(&stream, layout, output, json_deflate_parse_target_native, expected_size, schema_hash);
+    for (size_t i = 0; i < json_data.size; i += fragment_size) {
+        json_deflate_stream_feed(&stream, CONST_MEM_REGION(json_data.byte_ptr + i, min_size_t(fragment_size, json_data.size - i)));
+    }
+
+    json_deflate_parse_result_t result;
+    assert_int_not_equal(json_deflate_stream_finish(&stream, &result), json_deflate_stream_status_fallback);
+    json_deflate_stream_destroy(&stream);
+    return result;
+}
+
+static void test_deflate_stream_utf8(void ** state) {
+    JD_TEST_CASE_FILE(binary_schema_file, "testcases", "schema.dat", "strings");
+    const mem_region_t layout = read_all_bytes(binary_schema_file);
+
+    json_deflate_bump_area_t schema_area;
+    ZEROMEM(&schema_area);
+    json_deflate_metadata_t metadata = {0};
+    json_deflate_schema_context_t wasm_ctx = {0};
+    json_deflate_schema_context_t native_ctx = {0};
+    assert_int_equal(json_deflate_binary_read_from_memory(layout.consted, &schema_area, &metadata, &wasm_ctx, &native_ctx), json_deflate_binary_read_success);
+    const json_deflate_schema_type_t * const root_type = json_deflate_bump_get_ptr(&schema_area, native_ctx.ty_root);
+
+    const size_t output_size = 64 * 1024;
+    const mem_region_t whole_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+    const mem_region_t split_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+    TRAP_OUT_OF_MEMORY(whole_output.ptr);
+    TRAP_OUT_OF_MEMORY(split_output.ptr);
+
+#define STRINGS_DOCUMENT(_value) \
+    "{\"regular-nonempty\": \"" _value "\", \"regular-empty\": \"\", \"optional-some\": \"30\", \"catch-ok\": \"40\", \"catch-err\": 50, \"optional-catch-some-ok\": \"60\", \"optional-catch-some-err\": 70}"
+
+    // escapes and multi-byte sequences decode the same whole and split at every byte
+    const char * const valid = STRINGS_DOCUMENT("caf\xC3\xA9 \\u00e9 \\ud83d\\ude00 \xF0\x9F\x98\x80 \\\"\\\\\\/\\b\\f\\n\\r\\t a long run of plain ASCII text that spans several vector blocks");
+    const json_deflate_parse_result_t whole_result = deflate_stream_in_fragments(layout.consted, root_type->var, metadata.rust_schema_hash, CONST_MEM_REGION(valid, strlen(valid)), strlen(valid), whole_output);
+    const json_deflate_parse_result_t split_result = deflate_stream_in_fragments(layout.consted, root_type->var, metadata.rust_schema_hash, CONST_MEM_REGION(valid, strlen(valid)), 1, split_output);
+    assert_int_equal(whole_result.status, json_deflate_parse_status_success);
+    assert_int_equal(split_result.status, json_deflate_parse_status_success);
+    assert_int_equal(whole_result.offset, split_result.offset);
+    assert_int_equal(whole_result.end, split_result.end);
+    assert_deflated_values_equal(&schema_area, root_type, whole_output.byte_ptr + whole_result.offset, split_output.byte_ptr + split_result.offset);
+
+    // the DOM parser decodes the same strings
+    const json_deflate_parse_data_result_t dom_result = json_deflate_parse_data_dom(layout.consted, CONST_MEM_REGION(valid, strlen(valid)), split_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash);
+    assert_int_equal(dom_result.result.status, json_deflate_parse_status_success);
+    assert_deflated_values_equal(&schema_area, root_type, whole_output.byte_ptr + whole_result.offset, split_output.byte_ptr + dom_result.result.offset);
+
+    static const char * const invalid[] = {
+        STRINGS_DOCUMENT("caf\xC3"),
+        STRINGS_DOCUMENT("\xC3("),
+        STRINGS_DOCUMENT("\xED\xA0\x80"),
+        STRINGS_DOCUMENT("\xFF"),
+        STRINGS_DOCUMENT("\\ude00"),
+        STRINGS_DOCUMENT("\\x"),
+    };
+#undef STRINGS_DOCUMENT
+
+    for (int i = 0; i < ARRAY_SIZE(invalid); ++i) {
+        assert_int_equal(deflate_stream_in_fragments(layout.consted, root_type->var, metadata.rust_schema_hash, CONST_MEM_REGION(invalid[i], strlen(invalid[i])), strlen(invalid[i]), whole_output).status, json_deflate_parse_status_invalid_json);
+        assert_int_equal(deflate_stream_in_fragments(layout.consted, root_type->var, metadata.rust_schema_hash, CONST_MEM_REGION(invalid[i], strlen(invalid[i])), 1, split_output).status, json_deflate_parse_status_invalid_json);
+        assert_int_equal(json_deflate_parse_data_dom(layout.consted, CONST_MEM_REGION(invalid[i], strlen(invalid[i])), split_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash).result.status, json_deflate_parse_status_invalid_json);
+    }
+
+    free(whole_output.ptr);
+    free(split_output.ptr);
+    json_deflate_free(layout.ptr);
+}
+
+// every case deflates the same when fed a byte at a time, in odd sized fragments and in page sized fragments
+static void test_deflate_stream_fragments(void ** state) {
+    static const size_t fragment_sizes[] = {1, 7, 4093};
+
+    for (int i = 0; i < ARRAY_SIZE(deflate_compare_test_cases); ++i) {
+        JD_TEST_CASE_FILE(binary_schema_file, "testcases", "schema.dat", deflate_compare_test_cases[i]);
+        JD_TEST_CASE_FILE(json_data_file, "testcases", "data.json", deflate_compare_test_cases[i]);
+
+        const mem_region_t layout = read_all_bytes(binary_schema_file);
+        const mem_region_t json_data = read_all_bytes(json_data_file);
+
+        json_deflate_bump_area_t schema_area;
+        ZEROMEM(&schema_area);
+        json_deflate_metadata_t metadata = {0};
+        json_deflate_schema_context_t wasm_ctx = {0};
+        json_deflate_schema_context_t native_ctx = {0};
+        assert_int_equal(json_deflate_binary_read_from_memory(layout.consted, &schema_area, &metadata, &wasm_ctx, &native_ctx), json_deflate_binary_read_success);
+        const json_deflate_schema_type_t * const root_type = json_deflate_bump_get_ptr(&schema_area, native_ctx.ty_root);
+
+        const size_t output_size = json_data.size * 16 + 1024 * 1024;
+        const mem_region_t whole_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+        const mem_region_t split_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+        TRAP_OUT_OF_MEMORY(whole_output.ptr);
+        TRAP_OUT_OF_MEMORY(split_output.ptr);
+
+        const json_deflate_parse_result_t whole_result = deflate_stream_in_fragments(layout.consted, root_type->var, metadata.rust_schema_hash, json_data.consted, max_size_t(json_data.size, 1), whole_output);
+
+        for (int j = 0; j < ARRAY_SIZE(fragment_sizes); ++j) {
+            memset(split_output.ptr, 0, split_output.size);
+            const json_deflate_parse_result_t split_result = deflate_stream_in_fragments(layout.consted, root_type->var, metadata.rust_schema_hash, json_data.consted, fragment_sizes[j], split_output);
+            assert_int_equal(whole_result.status, split_result.status);
+            assert_int_equal(whole_result.offset, split_result.offset);
+            assert_int_equal(whole_result.end, split_result.end);
+            if (whole_result.status == json_deflate_parse_status_success) {
+                assert_deflated_values_equal(&schema_area, root_type, whole_output.byte_ptr + whole_result.offset, split_output.byte_ptr + split_result.offset);
+            }
+        }
+
+        free(whole_output.ptr);
+        free(split_output.ptr);
+        json_deflate_free(json_data.ptr);
+        json_deflate_free(layout.ptr);
+    }
+}
+
+// TODO: Uncomment once Leia/Vader have httpx support
+#if !defined(_LEIA) && !defined(_VADER)
+enum {
+    deflate_httpx_heap_size = 8 * 1024 * 1024,
+    deflate_httpx_fragment_buffers_size = 4 * 1024 * 1024,
+};
+
+static struct {
+    sb_socket_t server_sock;
+    sb_thread_id_t server_thread;
+    const_mem_region_t body;
+} loopback;
+
+static uint16_t loopback_ntohs(const uint16_t num) {
+    static const int n = 1;
+    return (*(char *)&n == 1) ? __builtin_bswap16(num) : num;
+}
+
+static int loopback_server_proc(void * const arg) {
+    sb_socket_t conn_sock;
+    if (sb_accept_socket(loopback.server_sock, NULL, &conn_sock).result != sb_socket_accept_success) {
+        return 0;
+    }
+    sb_enable_blocking_socket(conn_sock, sb_socket_blocking_enabled);
+
+    // read until the end of the request headers
+    char request[2048] = {0};
+    int request_size = 0;
+    while ((request_size < (int)sizeof(request) - 1) && !strstr(request, "\r\n\r\n")) {
+        int received = 0;
+        if ((sb_socket_receive(conn_sock, MEM_REGION(.ptr = request + request_size, .size = sizeof(request) - 1 - request_size), 0, &received).result != sb_socket_receive_success) || (received <= 0)) {
+            break;
+        }
+        request_size += received;
+        request[request_size] = '\0';
+    }
+
+    char response_header[128];
+    const int header_size = sprintf_s(response_header, ARRAY_SIZE(response_header), "HTTP/1.1 200 OK\r\nContent-Length: %" PRIu64 "\r\nConnection: close\r\n\r\n", (uint64_t)loopback.body.size);
+    int sent = 0;
+    sb_socket_send(conn_sock, CONST_MEM_REGION(.ptr = response_header, .size = header_size), 0, &sent);
+    for (size_t offset = 0; offset < loopback.body.size; offset += sent) {
+        if ((sb_socket_send(conn_sock, CONST_MEM_REGION(.byte_ptr = loopback.body.byte_ptr + offset, .size = loopback.body.size - offset), 0, &sent).result != sb_socket_send_success) || (sent <= 0)) {
+            break;
+        }
+    }
+    sb_close_socket(conn_sock);
+    return 0;
+}
+
+// Starts a server on an ephemeral loopback port answering a single request with `body`, returns the port
+static uint16_t loopback_start(const const_mem_region_t body) {
+    loopback.body = body;
+
+    sb_create_socket(sb_socket_family_IPv4, sb_socket_type_stream, sb_socket_protocol_tcp, &loopback.server_sock);
+    sb_sockaddr_t addr = {0};
+    addr.sin_family = sb_socket_family_IPv4;
+    addr.sin_addr.ipv4_u8[0] = 127;
+    addr.sin_addr.ipv4_u8[3] = 1;
+    assert_int_equal(sb_bind_socket(loopback.server_sock, &addr).result, sb_socket_bind_success);
+    assert_int_equal(sb_listen_socket(loopback.server_sock, 1).result, sb_socket_listen_success);
+    sb_getsockname(loopback.server_sock, &addr);
+
+    loopback.server_thread = sb_create_thread("deflate_httpx", sb_thread_default_options, loopback_server_proc, NULL, MALLOC_TAG);
+    return loopback_ntohs(addr.sin_port);
+}
+
+static void loopback_stop() {
+    sb_join_thread(loopback.server_thread);
+    sb_close_socket(loopback.server_sock);
+}
+
+// bodies downloaded with httpx are deflated fragment by fragment as they arrive, the result matches deflating the whole document
+static void test_deflate_httpx_fragments(void ** state) {
+    static const char * const test_cases[] = {"real", "real-4"};
+
+    const mem_region_t region = MEM_REGION(malloc(deflate_httpx_heap_size), deflate_httpx_heap_size);
+    TRAP_OUT_OF_MEMORY(region.ptr);
+    const mem_region_t fragment_buffers_region = MEM_REGION(malloc(deflate_httpx_fragment_buffers_size), deflate_httpx_fragment_buffers_size);
+    TRAP_OUT_OF_MEMORY(fragment_buffers_region.ptr);
+
+    adk_httpx_client_t * const client = adk_httpx_client_create(
+        region,
+        fragment_buffers_region,
+        network_pump_fragment_size,
+        network_pump_sleep_period,
+        unit_test_guard_page_mode,
+        adk_httpx_init_normal,
+        "tests-json-deflate-httpx");
+
+    for (int i = 0; i < ARRAY_SIZE(test_cases); ++i) {
+        JD_TEST_CASE_FILE(binary_schema_file, "testcases", "schema.dat", test_cases[i]);
+        JD_TEST_CASE_FILE(json_data_file, "testcases", "data.json", test_cases[i]);
+
+        const mem_region_t layout = read_all_bytes(binary_schema_file);
+        const mem_region_t json_data = read_all_bytes(json_data_file);
+        // the body has to arrive in more than one fragment to exercise the streaming path
+        assert_true(json_data.size > network_pump_fragment_size);
+
+        json_deflate_bump_area_t schema_area;
+        ZEROMEM(&schema_area);
+        json_deflate_metadata_t metadata = {0};
+        json_deflate_schema_context_t wasm_ctx = {0};
+        json_deflate_schema_context_t native_ctx = {0};
+        assert_int_equal(json_deflate_binary_read_from_memory(layout.consted, &schema_area, &metadata, &wasm_ctx, &native_ctx), json_deflate_binary_read_success);
+        const json_deflate_schema_type_t * const root_type = json_deflate_bump_get_ptr(&schema_area, native_ctx.ty_root);
+
+        const size_t output_size = json_data.size * 16 + 1024 * 1024;
+        const mem_region_t whole_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+        const mem_region_t httpx_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+        TRAP_OUT_OF_MEMORY(whole_output.ptr);
+        TRAP_OUT_OF_MEMORY(httpx_output.ptr);
+
+        bool fallback = false;
+        const json_deflate_parse_data_result_t whole_result = json_deflate_parse_data_stream(layout.consted, json_data.consted, whole_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash, &fallback);
+        assert_false(fallback);
+        assert_int_equal(whole_result.result.status, json_deflate_parse_status_success);
+
+        const uint16_t port = loopback_start(json_data.consted);
+        char url[64];
+        sprintf_s(url, ARRAY_SIZE(url), "http://127.0.0.1:%u/", port);
+
+        json_deflate_http_future_t * const future = json_deflate_parse_httpx_async(
+            layout.byte_ptr,
+            layout.size,
+            adk_httpx_client_request(client, adk_httpx_method_get, url),
+            httpx_output.byte_ptr,
+            httpx_output.size,
+            json_deflate_parse_target_native,
+            root_type->var,
+            metadata.rust_schema_hash);
+
+        while (json_deflate_http_future_get_status(future) != adk_future_status_ready) {
+            adk_httpx_client_tick(client);
+            thread_pool_run_completion_callbacks(statics.thread_pool);
+            sb_thread_sleep((milliseconds_t){1});
+        }
+
+        adk_httpx_response_t * const response = json_deflate_http_future_get_response(future);
+        assert_int_equal(adk_httpx_response_get_result(response), adk_httpx_ok);
+        assert_int_equal(adk_httpx_response_get_response_code(response), 200);
+        assert_int_equal(adk_httpx_response_get_body(response).size, json_data.size);
+
+        const json_deflate_parse_result_t httpx_result = json_deflate_http_future_get_result(future);
+        assert_int_equal(httpx_result.status, whole_result.result.status);
+        assert_int_equal(httpx_result.offset, whole_result.result.offset);
+        assert_int_equal(httpx_result.end, whole_result.result.end);
+        assert_deflated_values_equal(&schema_area, root_type, whole_output.byte_ptr + whole_result.result.offset, httpx_output.byte_ptr + httpx_result.offset);
+
+        // frees the response as well
+        json_deflate_http_future_drop(future);
+        loopback_stop();
+
+        free(whole_output.ptr);
+        free(httpx_output.ptr);
+        json_deflate_free(json_data.ptr);
+        json_deflate_free(layout.ptr);
+    }
+
+    adk_httpx_client_free(client);
+    free(region.ptr);
+    free(fragment_buffers_region.ptr);
+}
+#endif
+
+static void test_deflate_stream_perf(void ** state) {
+    static const char * const test_cases[] = {"real", "real-2", "real-3", "real-4"};
+
+    enum {
+        iterations = 10,
+    };
+
+    for (int i = 0; i < ARRAY_SIZE(test_cases); ++i) {
+        microseconds_t stream_time, dom_time;
+        size_t data_size;
+        deflate_stream_and_dom(test_cases[i], iterations, &stream_time, &dom_time, &data_size);
+        const double megabytes = (double)data_size * iterations / (1024.0 * 1024.0);
+        print_message(
+            "[json_deflate] %-8s %8u bytes -- stream: %8.1f us (%6.1f MB/s), DOM: %8.1f us (%6.1f MB/s)\n",
+            test_cases[i],
+            (uint32_t)data_size,
+            (double)stream_time.us / iterations,
+            megabytes / ((double)max_uint64_t(stream_time.us, 1) / 1000000.0),
+            (double)dom_time.us / iterations,
+            megabytes / ((double)max_uint64_t(dom_time.us, 1) / 1000000.0));
+    }
+}
+
+// Deflates with split arrays and checks the result against the sequential stream, returns false if splitting fell back to it
+static bool deflate_split_matches_stream(const const_mem_region_t layout, const const_mem_region_t json_data, const json_deflate_split_options_t * const options) {
+    json_deflate_bump_area_t schema_area;
+    ZEROMEM(&schema_area);
+    json_deflate_metadata_t metadata = {0};
+    json_deflate_schema_context_t wasm_ctx = {0};
+    json_deflate_schema_context_t native_ctx = {0};
+    assert_int_equal(json_deflate_binary_read_from_memory(layout, &schema_area, &metadata, &wasm_ctx, &native_ctx), json_deflate_binary_read_success);
+    const json_deflate_schema_type_t * const root_type = json_deflate_bump_get_ptr(&schema_area, native_ctx.ty_root);
+
+    const size_t output_size = json_data.size * 16 + 1024 * 1024;
+    const mem_region_t stream_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+    const mem_region_t split_output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+    TRAP_OUT_OF_MEMORY(stream_output.ptr);
+    TRAP_OUT_OF_MEMORY(split_output.ptr);
+
+    bool fallback = false;
+    const json_deflate_parse_data_result_t stream_result = json_deflate_parse_data_stream(layout, json_data, stream_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash, &fallback);
+    assert_false(fallback);
+
+    json_deflate_stream_t stream;
+    json_deflate_stream_init(&stream, layout, split_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash);
+    stream.split = options;
+    json_deflate_stream_feed(&stream, json_data);
+    json_deflate_parse_result_t split_result;
+    const bool split = json_deflate_stream_finish(&stream, &split_result) != json_deflate_stream_status_fallback;
+    json_deflate_stream_destroy(&stream);
+    if (!split) {
+        split_result = json_deflate_parse_data_parallel(layout, json_data, split_output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash, options).result;
+    }
+
+    assert_int_equal(split_result.status, stream_result.result.status);
+    if (split_result.status == json_deflate_parse_status_success) {
+        assert_int_equal(split_result.offset, stream_result.result.offset);
+        assert_deflated_values_equal(&schema_area, root_type, split_output.byte_ptr + split_result.offset, stream_output.byte_ptr + stream_result.result.offset);
+    }
+
+    free(stream_output.ptr);
+    free(split_output.ptr);
+    return split;
+}
+
+static void test_deflate_parallel(void ** state) {
+    // splits every top-level array, one element per chunk
+    const json_deflate_split_options_t options = {
+        .pool = statics.thread_pool,
+        .num_helpers = statics.thread_pool->thread_count,
+        .min_array_size = 0,
+        .min_chunk_size = 1,
+    };
+
+    for (int i = 0; i < ARRAY_SIZE(deflate_compare_test_cases); ++i) {
+        JD_TEST_CASE_FILE(binary_schema_file, "testcases", "schema.dat", deflate_compare_test_cases[i]);
+        JD_TEST_CASE_FILE(json_data_file, "testcases", "data.json", deflate_compare_test_cases[i]);
+        const mem_region_t layout = read_all_bytes(binary_schema_file);
+        const mem_region_t json_data = read_all_bytes(json_data_file);
+        const bool split = deflate_split_matches_stream(layout.consted, json_data.consted, &options);
+        if (!strcmp(deflate_compare_test_cases[i], "real-3")) {
+            assert_true(split);
+        }
+        json_deflate_free(json_data.ptr);
+        json_deflate_free(layout.ptr);
+    }
+
+    JD_TEST_CASE_FILE(binary_schema_file, "testcases", "schema.dat", "top-array");
+    // documents the chunks cannot handle on their own are parsed again sequentially
+    static const struct {
+        const char * json;
+        bool split;
+    } documents[] = {
+        {"[0, 1, 2, 3]", true},
+        {"[]", true},
+        {"[0]", true},
+        {"[0, 1, x, 3]", false},
+        {"[0, 1, 2, 3", true},
+        {"[0, 1, 2,]", false},
+        {"[0, 1, \"2\", 3]", false},
+        {"[0, 1, [2], 3]", false},
+    };
+
+    const mem_region_t layout = read_all_bytes(binary_schema_file);
+    for (int i = 0; i < ARRAY_SIZE(documents); ++i) {
+        const char * const json = documents[i].json;
+        assert_int_equal(deflate_split_matches_stream(layout.consted, CONST_MEM_REGION(json, strlen(json)), &options), documents[i].split);
+    }
+    json_deflate_free(layout.ptr);
+}
+
+static void test_deflate_parallel_perf(void ** state) {
+    JD_TEST_CASE_FILE(binary_schema_file, "testcases", "schema.dat", "real-3");
+    JD_TEST_CASE_FILE(json_data_file, "testcases", "data.json", "real-3");
+    enum {
+        iterations = 5,
+        repeats = 8,
+    };
+
+    const mem_region_t layout = read_all_bytes(binary_schema_file);
+    const mem_region_t real_data = read_all_bytes(json_data_file);
+
+    // real-3 with the elements of its biggest top-level array repeated
+    const char * const containers = memchr(strstr(real_data.ptr, "\"containers\""), '[', real_data.size) + 1;
+    const size_t prefix_size = (size_t)(containers - (const char *)real_data.ptr);
+    json_deflate_array_scan_t scan;
+    assert_true(json_deflate_scan_array((const uint8_t *)containers, real_data.size - prefix_size, SIZE_MAX, &scan));
+    const size_t json_size = real_data.size + (scan.end + 1) * (repeats - 1);
+    char * const json = malloc(json_size);
+    TRAP_OUT_OF_MEMORY(json);
+    char * out = json;
+    memcpy(out, real_data.ptr, prefix_size);
+    out += prefix_size;
+    for (int i = 0; i < repeats; ++i) {
+        memcpy(out, containers, scan.end);
+        out += scan.end;
+        *out++ = (i == repeats - 1) ? ' ' : ',';
+    }
+    memcpy(out, containers + scan.end, real_data.size - prefix_size - scan.end);
+    const const_mem_region_t json_data = CONST_MEM_REGION(json, json_size);
+
+    json_deflate_bump_area_t schema_area;
+    ZEROMEM(&schema_area);
+    json_deflate_metadata_t metadata = {0};
+    json_deflate_schema_context_t wasm_ctx = {0};
+    json_deflate_schema_context_t native_ctx = {0};
+    assert_int_equal(json_deflate_binary_read_from_memory(layout.consted, &schema_area, &metadata, &wasm_ctx, &native_ctx), json_deflate_binary_read_success);
+    const json_deflate_schema_type_t * const root_type = json_deflate_bump_get_ptr(&schema_area, native_ctx.ty_root);
+
+    const size_t output_size = json_size * 16 + 1024 * 1024;
+    const mem_region_t output = MEM_REGION(.ptr = calloc(output_size, 1), .size = output_size);
+    TRAP_OUT_OF_MEMORY(output.ptr);
+
+    const microseconds_t stream_start = adk_read_microsecond_clock();
+    for (int i = 0; i < iterations; ++i) {
+        bool fallback = false;
+        assert_int_equal(json_deflate_parse_data_stream(layout.consted, json_data, output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash, &fallback).result.status, json_deflate_parse_status_success);
+    }
+    const double stream_time = (double)(adk_read_microsecond_clock().us - stream_start.us) / iterations;
+    print_message("[json_deflate] parallel %8u bytes -- sequential stream: %8.1f us\n", (uint32_t)json_size, stream_time);
+
+    adk_system_metrics_t system_metrics;
+    sb_get_system_metrics(&system_metrics);
+
+    // the calling thread parses chunks too, so N threads take a pool of N - 1 helpers
+    const mem_region_t pool_region = MEM_REGION(.ptr = malloc(256 * 1024), .size = 256 * 1024);
+    TRAP_OUT_OF_MEMORY(pool_region.ptr);
+    for (int threads = 1; threads <= thread_pool_max_threads + 1; ++threads) {
+        thread_pool_t * const pool = thread_pool_emplace_init(pool_region, (uint8_t)max_int32_t(threads - 1, 1), "json_split_", MALLOC_TAG);
+        const json_deflate_split_options_t options = {
+            .pool = pool,
+            .num_helpers = threads - 1,
+            .min_array_size = 64 * 1024,
+            .min_chunk_size = 16 * 1024,
+        };
+        assert_true(deflate_split_matches_stream(layout.consted, json_data, &options));
+
+        const microseconds_t split_start = adk_read_microsecond_clock();
+        for (int j = 0; j < iterations; ++j) {
+            assert_int_equal(json_deflate_parse_data_parallel(layout.consted, json_data, output, json_deflate_parse_target_native, root_type->var, metadata.rust_schema_hash, &options).result.status, json_deflate_parse_status_success);
+        }
+        const double split_time = (double)(adk_read_microsecond_clock().us - split_start.us) / iterations;
+        print_message("[json_deflate] parallel %d thread(s): %8.1f us (%.2fx, %d core(s))\n", threads, split_time, stream_time / split_time, system_metrics.num_cores);
+
+        thread_pool_shutdown(pool, MALLOC_TAG);
+    }
+
+    free(pool_region.ptr);
+    free(output.ptr);
+    free(json);
+    json_deflate_free(real_data.ptr);
+    json_deflate_free(layout.ptr);
+}
+
 static void generate_test_case_without_key_conversion(const char * const test_case) {
     json_deflate_schema_options_t options = {0};
     options.root_name = "Root";
@@ -800,6 +1619,21 @@ int test_json_deflate() {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(generate_all_test_cases),
         cmocka_unit_test(run_all_test_cases),
+        cmocka_unit_test(test_deflate_stream_matches_dom),
+#ifdef HAS_DEFLATE_GEN
+        cmocka_unit_test(test_deflate_field_tables),
+        cmocka_unit_test(test_deflate_field_tables_cycle),
+#endif
+        cmocka_unit_test(test_deflate_scan),
+        cmocka_unit_test(test_deflate_stream_utf8),
+        cmocka_unit_test(test_deflate_stream_fragments),
+// TODO: Uncomment once Leia/Vader have httpx support
+#if !defined(_LEIA) && !defined(_VADER)
+        cmocka_unit_test(test_deflate_httpx_fragments),
+#endif
+        cmocka_unit_test(test_deflate_stream_perf),
+        cmocka_unit_test(test_deflate_parallel),
+        cmocka_unit_test(test_deflate_parallel_perf),
 
 #ifdef HAS_DEFLATE_GEN
         cmocka_unit_test(test_infer_groups),
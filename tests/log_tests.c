@@ -12,6 +12,7 @@ logging test fixture
 
 #include "source/adk/cncbus/cncbus_addresses.h"
 #include "source/adk/cncbus/cncbus_msg_types.h"
+#include "source/adk/log/private/log_binary.h"
 #include "source/adk/log/private/log_p.h"
 #include "source/adk/log/private/log_receiver.h"
 #include "source/adk/runtime/app/app.h"
@@ -187,6 +188,176 @@ static void test_log_macros(void ** state) {
     print_message("\n");
 }
 
+static int log_tests_encode_args(uint8_t * const dst, const int dst_size, const char * const format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int size = log_binary_encode_args(dst, dst_size, format, args);
+    va_end(args);
+    return size;
+}
+
+// deferred formatting must produce exactly what vsnprintf would have
+#define LOG_TESTS_CHECK_DEFERRED(_format, ...)                                                                            \
+    do {                                                                                                                  \
+        uint8_t args[log_binary_max_args_size];                                                                           \
+        char expected[256], formatted[256];                                                                               \
+        const int args_size = log_tests_encode_args(args, ARRAY_SIZE(args), _format, ##__VA_ARGS__);                      \
+        assert_true(args_size >= 0);                                                                                      \
+        const int expected_length = snprintf(expected, ARRAY_SIZE(expected), _format, ##__VA_ARGS__);                     \
+        assert_int_equal(log_binary_format(formatted, ARRAY_SIZE(formatted), _format, args, args_size), expected_length); \
+        assert_string_equal(formatted, expected);                                                                         \
+    } while (0)
+
+static void test_log_deferred_format(void ** state) {
+    char stack_str[16] = "stack";
+    LOG_TESTS_CHECK_DEFERRED("no arguments, 100%% literal");
+    LOG_TESTS_CHECK_DEFERRED("%d %i %u %x %X %o %c", -42, 7, 42u, 0xbeef, 0xbeef, 8, 'z');
+    LOG_TESTS_CHECK_DEFERRED("%hhd %hd %ld %lld %zu %td %jd", (signed char)-3, (short)-300, -70000L, -5000000000LL, (size_t)123456, (ptrdiff_t)-9, (intmax_t)77);
+    LOG_TESTS_CHECK_DEFERRED("%f %.3e %g %10.2lf %-8.1f|", 3.5, 1234.5678, 0.0001, 2.25, -1.0);
+    LOG_TESTS_CHECK_DEFERRED("[%s] [%10s] [%-6s] [%.3s] [%s]", "abc", stack_str, "x", "truncated", "");
+    LOG_TESTS_CHECK_DEFERRED("[%*d] [%-*d] [%.*f] [%*.*s] [%.*s]", 6, 1, 4, 2, 2, 3.14159, 4, 4, (const char *)"TAGS", -1, "negative precision");
+    LOG_TESTS_CHECK_DEFERRED("%p %s", (void *)&stack_str, "end");
+
+    // the encoded strings are copies
+    {
+        uint8_t args[log_binary_max_args_size];
+        char formatted[32];
+        const int args_size = log_tests_encode_args(args, ARRAY_SIZE(args), "%s", stack_str);
+        strcpy(stack_str, "changed");
+        log_binary_format(formatted, ARRAY_SIZE(formatted), "%s", args, args_size);
+        assert_string_equal(formatted, "stack");
+    }
+
+    // a NULL string is encoded as "(null)", checked directly since passing NULL for %s to snprintf is undefined
+    {
+        uint8_t args[log_binary_max_args_size];
+        char formatted[32];
+        const int args_size = log_tests_encode_args(args, ARRAY_SIZE(args), "[%s]", (const char *)NULL);
+        assert_true(args_size >= 0);
+        log_binary_format(formatted, ARRAY_SIZE(formatted), "[%s]", args, args_size);
+        assert_string_equal(formatted, "[(null)]");
+    }
+
+    // formats that must be formatted eagerly
+    {
+        uint8_t args[log_binary_max_args_size];
+        int count;
+        assert_int_equal(log_tests_encode_args(args, ARRAY_SIZE(args), "%n", &count), -1);
+        assert_int_equal(log_tests_encode_args(args, ARRAY_SIZE(args), "%1$d", 1), -1);
+        assert_int_equal(log_tests_encode_args(args, ARRAY_SIZE(args), "%Lf", (long double)1), -1);
+        assert_int_equal(log_tests_encode_args(args, ARRAY_SIZE(args), "%ls", L"wide"), -1);
+        assert_int_equal(log_tests_encode_args(args, 8, "%s", "does not fit"), -1);
+    }
+
+    // truncation follows snprintf
+    {
+        uint8_t args[log_binary_max_args_size];
+        char formatted[8];
+        const int args_size = log_tests_encode_args(args, ARRAY_SIZE(args), "%d-%s", 12345, "abcdef");
+        assert_int_equal(log_binary_format(formatted, ARRAY_SIZE(formatted), "%d-%s", args, args_size), 12);
+        assert_string_equal(formatted, "12345-a");
+    }
+}
+
+static void test_log_binary_file(void ** state) {
+    enum { num_messages = 1000 };
+    static const char * const formats[] = {"first %d", "second %s %d", "third %.2f"};
+    static const char * const file_path = "log_tests_binary.log";
+
+    sb_file_t * const file = sb_fopen(sb_app_cache_directory, file_path, "wb");
+    assert_non_null(file);
+
+    log_binary_writer_t * const writer = malloc(sizeof(log_binary_writer_t));
+    log_binary_writer_init(writer, file);
+
+    for (int i = 0; i < num_messages; ++i) {
+        const log_header_t header = {
+            .time_since_epoch = {.seconds = (uint32_t)i, .microseconds = 7},
+            .fourcc_tag = TAG_TEST,
+            .func = __func__,
+            .file = __FILE__,
+            .line = (uint16_t)i,
+            .level = (log_level_t)(i % num_log_levels)};
+
+        uint8_t args[log_binary_max_args_size];
+        int args_size;
+        switch (i % 4) {
+            case 0:
+                args_size = log_tests_encode_args(args, ARRAY_SIZE(args), formats[0], i);
+                break;
+            case 1:
+                args_size = log_tests_encode_args(args, ARRAY_SIZE(args), formats[1], "str", i);
+                break;
+            case 2:
+                args_size = log_tests_encode_args(args, ARRAY_SIZE(args), formats[2], i * 0.5);
+                break;
+            default:
+                args_size = 0;
+                break;
+        }
+
+        if ((i % 4) == 3) {
+            log_binary_writer_write(writer, &header, NULL, (const uint8_t *)"preformatted", 12);
+        } else {
+            log_binary_writer_write(writer, &header, formats[i % 4], args, args_size);
+        }
+    }
+
+    log_binary_writer_flush(writer);
+    free(writer);
+    sb_fclose(file);
+
+    sb_file_t * const read_file = sb_fopen(sb_app_cache_directory, file_path, "rb");
+    assert_non_null(read_file);
+    sb_fseek(read_file, 0, sb_seek_end);
+    const long file_size = sb_ftell(read_file);
+    sb_fseek(read_file, 0, sb_seek_set);
+    uint8_t * const contents = malloc(file_size);
+    assert_int_equal(sb_fread(contents, 1, file_size, read_file), file_size);
+    sb_fclose(read_file);
+    print_message("%d messages, %ld bytes\n", num_messages, file_size);
+
+    log_binary_reader_t * const reader = malloc(sizeof(log_binary_reader_t));
+    assert_true(log_binary_reader_init(reader, CONST_MEM_REGION(.ptr = contents, .size = file_size)));
+
+    for (int i = 0; i < num_messages; ++i) {
+        log_header_t header;
+        char text[64], expected[64];
+        assert_true(log_binary_reader_next(reader, &header, text, ARRAY_SIZE(text)));
+
+        switch (i % 4) {
+            case 0:
+                sprintf(expected, formats[0], i);
+                break;
+            case 1:
+                sprintf(expected, formats[1], "str", i);
+                break;
+            case 2:
+                sprintf(expected, formats[2], i * 0.5);
+                break;
+            default:
+                strcpy(expected, "preformatted");
+                break;
+        }
+
+        assert_string_equal(text, expected);
+        assert_string_equal(header.file, __FILE__);
+        assert_string_equal(header.func, __func__);
+        assert_int_equal(header.line, i);
+        assert_int_equal(header.level, i % num_log_levels);
+        assert_int_equal(header.time_since_epoch.seconds, i);
+        assert_int_equal(header.fourcc_tag, TAG_TEST);
+    }
+
+    log_header_t header;
+    char text[64];
+    assert_false(log_binary_reader_next(reader, &header, text, ARRAY_SIZE(text)));
+
+    free(reader);
+    free(contents);
+    sb_delete_file(sb_app_cache_directory, file_path);
+}
+
 static void test_log_init(void ** state) {
     print_message("\n******************************************\n");
     assert_non_null(&log_tests.bus);
@@ -227,6 +398,8 @@ int test_log() {
         cmocka_unit_test_setup_teardown(test_log_tags, NULL, NULL),
         cmocka_unit_test_setup_teardown(test_log_message_args, NULL, NULL),
         cmocka_unit_test_setup_teardown(test_log_macros, NULL, NULL),
+        cmocka_unit_test_setup_teardown(test_log_deferred_format, NULL, NULL),
+        cmocka_unit_test_setup_teardown(test_log_binary_file, NULL, NULL),
         cmocka_unit_test_setup_teardown(test_log_init, NULL, NULL),
         cmocka_unit_test_setup_teardown(test_log_message_levels, NULL, NULL),
         cmocka_unit_test_setup_teardown(test_log_message_args, NULL, NULL),
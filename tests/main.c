@@ -99,6 +99,10 @@ int test_watchdog();
 int test_unwind();
 #endif
 
+#ifdef _TELEMETRY_TRACE
+int test_telemetry();
+#endif
+
 int test_blank_test() {
     return 0;
 }
@@ -278,6 +282,10 @@ int main(const int argc, const char * const * const argv) {
 #ifdef _RESTRICTED
         TEST(unwind),
 #endif
+
+#ifdef _TELEMETRY_TRACE
+        TEST(telemetry),
+#endif
     };
 
     const size_t tests_size = ARRAY_SIZE(tests);
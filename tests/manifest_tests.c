@@ -217,10 +217,12 @@ static void test_no_overrides(void ** _) {
 
     assert_int_equal(manifest.runtime_config.renderer.device.num_cmd_buffers, 32);
     assert_int_equal(manifest.runtime_config.renderer.device.cmd_buf_size, 64 * 1024);
+    assert_int_equal(manifest.runtime_config.renderer.device.max_pending_frames, 1);
     assert_false(manifest.runtime_config.renderer.rhi_command_diffing.enabled);
     assert_false(manifest.runtime_config.renderer.rhi_command_diffing.verbose);
     assert_false(manifest.runtime_config.renderer.rhi_command_diffing.tracking.enabled);
     assert_int_equal(manifest.runtime_config.renderer.rhi_command_diffing.tracking.buffer_size, 4096);
+    assert_false(manifest.runtime_config.renderer.rhi_command_diffing.dirty_regions.enabled);
 }
 
 static void test_manifest_config_override(void ** _) {
@@ -538,8 +540,11 @@ static void test_canvas(void ** state) {
     assert_int_equal(manifest.runtime_config.canvas.enable_punchthrough_blend_mode_fix, true);
     assert_int_equal(manifest.runtime_config.canvas.font_atlas.width, 2);
     assert_int_equal(manifest.runtime_config.canvas.font_atlas.height, 3);
+    assert_int_equal(manifest.runtime_config.canvas.font_atlas.num_pages, 4);
     assert_true(manifest.runtime_config.canvas.text_mesh_cache.enabled);
     assert_int_equal(manifest.runtime_config.canvas.text_mesh_cache.size, 33);
+    assert_int_equal(manifest.runtime_config.canvas.text_mesh_cache.max_bytes, 65536);
+    assert_true(manifest.runtime_config.canvas.thread_cache.enabled);
     assert_int_equal(manifest.runtime_config.canvas.gl.internal_limits.max_verts_per_vertex_bank, 7001);
     assert_int_equal(manifest.runtime_config.canvas.gl.internal_limits.num_vertex_banks, 3);
     assert_int_equal(manifest.runtime_config.canvas.gl.internal_limits.num_meshes, 7);
@@ -556,12 +561,17 @@ static void test_renderer(void ** state) {
 
     assert_int_equal(manifest.runtime_config.renderer.device.num_cmd_buffers, 123);
     assert_int_equal(manifest.runtime_config.renderer.device.cmd_buf_size, 456);
+    assert_int_equal(manifest.runtime_config.renderer.device.max_pending_frames, 3);
 
     assert_true(manifest.runtime_config.renderer.rhi_command_diffing.enabled);
     assert_true(manifest.runtime_config.renderer.rhi_command_diffing.verbose);
     assert_true(manifest.runtime_config.renderer.rhi_command_diffing.tracking.enabled);
     assert_int_equal(manifest.runtime_config.renderer.rhi_command_diffing.tracking.buffer_size, 12345);
+    assert_true(manifest.runtime_config.renderer.rhi_command_diffing.dirty_regions.enabled);
+    assert_int_equal(manifest.runtime_config.renderer.rhi_command_diffing.dirty_regions.tile_size, 32);
+    assert_int_equal(manifest.runtime_config.renderer.rhi_command_diffing.dirty_regions.back_buffer_age, 2);
     assert_int_equal(manifest.runtime_config.renderer.render_resource_tracking.periodic_logging, logging_tty_and_metrics);
+    assert_int_equal(manifest.runtime_config.renderer.frame_metrics.periodic_logging, logging_metrics);
 }
 
 static void test_reporting(void ** state) {
@@ -604,6 +614,7 @@ static void test_network_pump(void ** state) {
 
     assert_int_equal(manifest.runtime_config.network_pump_fragment_size, 1024);
     assert_int_equal(manifest.runtime_config.network_pump_sleep_period, 512);
+    assert_int_equal(manifest.runtime_config.network_pump_fragment_budget, 1048576);
 }
 
 int test_manifest() {
@@ -7,6 +7,12 @@
 #include "source/adk/steamboat/sb_platform.h"
 #include "testapi.h"
 
+#include <math.h>
+
+#ifdef _GLFW
+#include "source/adk/steamboat/ref_ports/rhi_gl/rhi_gl_device.h"
+#endif
+
 void rb_cmd_buf_execute(rhi_device_t * const device, rb_cmd_buf_t * const cmd_buf); // from rbcmd.c
 
 // 'Subclass' of `rhi_device_t` that contains values for unit tests
@@ -15,6 +21,11 @@ typedef struct rhi_test_device_t {
     struct {
         size_t counter;
         size_t sum;
+        int num_clears;
+        int num_draws;
+        int num_clip_rects;
+        rhi_rect_t clip_rect;
+        bool is_clipped;
     } test;
 } rhi_test_device_t;
 
@@ -25,8 +36,33 @@ static void rhi_test_device_present(rhi_device_t * const device, const rhi_swap_
     test_device->test.sum += swap_interval.interval;
 }
 
+static void rhi_test_device_set_display_size(rhi_device_t * const device, const int w, const int h) {
+}
+
+static void rhi_test_device_clear_screen_c(rhi_device_t * const device, const float r, const float g, const float b, const float a) {
+    ((rhi_test_device_t *)device)->test.num_clears += 1;
+}
+
+static void rhi_test_device_draw_indirect(rhi_device_t * const device, const rhi_draw_params_indirect_t * const params) {
+    ((rhi_test_device_t *)device)->test.num_draws += 1;
+}
+
+static void rhi_test_device_set_clip_rect(rhi_device_t * const device, const rhi_rect_t * const rect) {
+    rhi_test_device_t * const test_device = (rhi_test_device_t *)device;
+
+    test_device->test.is_clipped = rect != NULL;
+    if (rect) {
+        test_device->test.num_clip_rects += 1;
+        test_device->test.clip_rect = *rect;
+    }
+}
+
 static const rhi_device_vtable_t test_device_vtable = {
-    .present = rhi_test_device_present};
+    .present = rhi_test_device_present,
+    .set_display_size = rhi_test_device_set_display_size,
+    .clear_screen_c = rhi_test_device_clear_screen_c,
+    .draw_indirect = rhi_test_device_draw_indirect,
+    .set_clip_rect = rhi_test_device_set_clip_rect};
 
 static void test_rhi_command_diffing(void ** state) {
     render_cmd_config_t render_cmd_config = {0};
@@ -62,7 +98,155 @@ static void test_rhi_command_diffing(void ** state) {
     sb_unmap_pages(region);
 }
 
+static void rhi_test_write_frame(rb_cmd_buf_t * const cmd_buf, const uint32_t * const draw_hashes, const rhi_rect_t * const draw_bounds, const int num_draws) {
+    static const int elm_count = 3;
+    static rhi_mesh_t * const mesh = NULL;
+    static rhi_mesh_t * const * const mesh_list[] = {&mesh};
+
+    assert_true(render_cmd_buf_write_set_display_size(cmd_buf, 256, 128, MALLOC_TAG));
+    assert_true(render_cmd_buf_write_clear_screen_c(cmd_buf, (render_clear_color_t){0}, MALLOC_TAG));
+    for (int i = 0; i < num_draws; ++i) {
+        const rhi_draw_params_indirect_t params = {
+            .mesh_list = mesh_list,
+            .elm_counts = &elm_count,
+            .hashes = &draw_hashes[i],
+            .num_meshes = 1,
+            .mode = rhi_triangles,
+            .bounds = draw_bounds[i]};
+        assert_true(render_cmd_buf_write_draw_indirect(cmd_buf, params, MALLOC_TAG));
+    }
+    assert_true(render_cmd_buf_write_present(cmd_buf, (rhi_swap_interval_t){.interval = 1}, MALLOC_TAG));
+}
+
+static void test_rhi_dirty_regions(void ** state) {
+    render_cmd_config_t render_cmd_config = {0};
+    render_cmd_config.rhi_command_diffing.enabled = true;
+    render_cmd_config.rhi_command_diffing.dirty_regions.enabled = true;
+    render_cmd_config.rhi_command_diffing.dirty_regions.tile_size = 32;
+    render_cmd_config.rhi_command_diffing.dirty_regions.back_buffer_age = 1;
+    render_cmd_init(render_cmd_config);
+
+    rhi_test_device_t device = {.device = {.resource = {0}, .vtable = &test_device_vtable}, .test = {0}};
+
+    rb_cmd_buf_t cmd_buf = {0};
+    mem_region_t region = sb_map_pages(PAGE_ALIGN_INT(4096), system_page_protect_read_write);
+    hlba_init(&cmd_buf.hlba, region.ptr, (int)region.size);
+
+    const rhi_rect_t draw_bounds[] = {{0, 0, 16, 16}, {100, 50, 140, 90}};
+    uint32_t draw_hashes[] = {1, 2};
+
+    // first frame is always drawn in full
+
+    rhi_test_write_frame(&cmd_buf, draw_hashes, draw_bounds, ARRAY_SIZE(draw_bounds));
+    rb_cmd_buf_execute((rhi_device_t *)&device, &cmd_buf);
+    assert_int_equal(device.test.num_clears, 1);
+    assert_int_equal(device.test.num_draws, 2);
+    assert_int_equal(device.test.counter, 1);
+    assert_int_equal(device.test.num_clip_rects, 0);
+
+    // identical frame: nothing is drawn but the frame is still presented
+
+    rhi_test_write_frame(&cmd_buf, draw_hashes, draw_bounds, ARRAY_SIZE(draw_bounds));
+    rb_cmd_buf_execute((rhi_device_t *)&device, &cmd_buf);
+    assert_int_equal(device.test.num_clears, 1);
+    assert_int_equal(device.test.num_draws, 2);
+    assert_int_equal(device.test.counter, 2);
+    assert_int_equal(device.test.num_clip_rects, 0);
+
+    // second draw changes: only the tiles under it are redrawn, the first draw is outside of them
+
+    draw_hashes[1] = 3;
+    rhi_test_write_frame(&cmd_buf, draw_hashes, draw_bounds, ARRAY_SIZE(draw_bounds));
+    rb_cmd_buf_execute((rhi_device_t *)&device, &cmd_buf);
+    assert_int_equal(device.test.num_clears, 2);
+    assert_int_equal(device.test.num_draws, 3);
+    assert_int_equal(device.test.counter, 3);
+    assert_int_equal(device.test.num_clip_rects, 1);
+    assert_false(device.test.is_clipped);
+    assert_int_equal(device.test.clip_rect.x0, 96);
+    assert_int_equal(device.test.clip_rect.y0, 32);
+    assert_int_equal(device.test.clip_rect.x1, 160);
+    assert_int_equal(device.test.clip_rect.y1, 96);
+
+    render_cmd_metrics_t metrics;
+    render_cmd_get_metrics(&metrics);
+    assert_int_equal(metrics.dirty_regions.full_frames, 1);
+    assert_int_equal(metrics.dirty_regions.partial_frames, 1);
+    assert_int_equal(metrics.dirty_regions.skipped_frames, 1);
+    // 64x64 of 256x128 changed, after a full (100%) and an unchanged (0%) frame
+    assert_true(fabsf(metrics.dirty_regions.last_dirty_area_percent - 12.5f) < 0.001f);
+    assert_true(fabsf(metrics.dirty_regions.average_dirty_area_percent - 112.5f / 3.f) < 0.001f);
+
+    render_cmd_shutdown();
+    sb_unmap_pages(region);
+}
+
+#if defined(_GLFW) && defined(GL_CORE)
+// sampler entry points of a fake GL that, like real drivers, hands out the lowest free name again
+static struct {
+    bool names[8];
+    int num_binds;
+} rhi_gl_test_samplers;
+
+static void APIENTRY rhi_gl_test_gen_samplers(GLsizei count, GLuint * samplers) {
+    for (GLsizei i = 0; i < count; ++i) {
+        GLuint name = 1;
+        while (rhi_gl_test_samplers.names[name]) {
+            ++name;
+        }
+        rhi_gl_test_samplers.names[name] = true;
+        samplers[i] = name;
+    }
+}
+
+static void APIENTRY rhi_gl_test_delete_samplers(GLsizei count, const GLuint * samplers) {
+    for (GLsizei i = 0; i < count; ++i) {
+        rhi_gl_test_samplers.names[samplers[i]] = false;
+    }
+}
+
+static void APIENTRY rhi_gl_test_bind_sampler(GLuint unit, GLuint sampler) {
+    ++rhi_gl_test_samplers.num_binds;
+}
+
+static void test_rhi_gl_sampler_cache(void ** state) {
+    const glf_t saved_glf = glf;
+    glf.glGenSamplers = rhi_gl_test_gen_samplers;
+    glf.glDeleteSamplers = rhi_gl_test_delete_samplers;
+    glf.glBindSampler = rhi_gl_test_bind_sampler;
+    ZEROMEM(&rhi_gl_test_samplers);
+
+    gl_context_t * const context = calloc(1, sizeof(gl_context_t));
+    TRAP_OUT_OF_MEMORY(context);
+
+    GLuint sampler;
+    glc_gen_samplers(context, 1, &sampler);
+    glc_bind_sampler(context, 0, sampler);
+    glc_bind_sampler(context, 1, sampler);
+    glc_bind_sampler(context, 1, sampler);
+    assert_int_equal(rhi_gl_test_samplers.num_binds, 2);
+
+    // the deleted name comes back for the next sampler, binding it must not be skipped as redundant
+    glc_delete_samplers(context, 1, &sampler);
+    GLuint regenerated;
+    glc_gen_samplers(context, 1, &regenerated);
+    assert_int_equal(regenerated, sampler);
+    glc_bind_sampler(context, 0, regenerated);
+    glc_bind_sampler(context, 1, regenerated);
+    assert_int_equal(rhi_gl_test_samplers.num_binds, 4);
+
+    free(context);
+    glf = saved_glf;
+}
+#endif
+
 int test_rhi() {
-    const struct CMUnitTest tests[] = {cmocka_unit_test(test_rhi_command_diffing)};
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_rhi_command_diffing),
+        cmocka_unit_test(test_rhi_dirty_regions),
+#if defined(_GLFW) && defined(GL_CORE)
+        cmocka_unit_test(test_rhi_gl_sampler_cache),
+#endif
+    };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
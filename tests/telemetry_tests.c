@@ -0,0 +1,161 @@
+/* ===========================================================================
+ *
+ * Copyright (c) 2019-2021 Disney Streaming Technology LLC. All rights reserved.
+ *
+ * ==========================================================================*/
+
+/*
+telemetry_tests.c
+
+test fixture for the built-in trace capture backend
+*/
+
+#include "source/adk/runtime/runtime.h"
+#include "source/adk/steamboat/sb_file.h"
+#include "source/adk/steamboat/sb_thread.h"
+#include "source/adk/telemetry/telemetry.h"
+#include "testapi.h"
+
+#if defined(_TELEMETRY) && defined(_TELEMETRY_TRACE)
+
+#define TELEMETRY_TEST_FILE "telemetry_test.json"
+
+enum {
+    telemetry_test_num_threads = 4,
+    // two events per scope, every thread's events fit in its ring so nothing is dropped however late the writer drains
+    telemetry_test_num_scopes = 1000,
+};
+
+static char * telemetry_test_read_trace() {
+    sb_file_t * const file = sb_fopen(sb_app_cache_directory, TELEMETRY_TEST_FILE, "rb");
+    assert_non_null(file);
+    sb_fseek(file, 0, sb_seek_end);
+    const long size = sb_ftell(file);
+    sb_fseek(file, 0, sb_seek_set);
+
+    char * const text = malloc((size_t)size + 1);
+    assert_int_equal(sb_fread(text, 1, (size_t)size, file), (size_t)size);
+    text[size] = '\0';
+    sb_fclose(file);
+    sb_delete_file(sb_app_cache_directory, TELEMETRY_TEST_FILE);
+    return text;
+}
+
+static int telemetry_test_count(const char * const text, const char * const needle) {
+    int count = 0;
+    for (const char * p = strstr(text, needle); p; p = strstr(p + 1, needle)) {
+        ++count;
+    }
+    return count;
+}
+
+static void test_telemetry_capture_groups(void ** state) {
+    telemetry_init(TELEMETRY_TEST_FILE, "canvas");
+
+    assert_true(telemetry_trace_is_capturing(CG_TRACE_MASK));
+    assert_false(telemetry_trace_is_capturing(HTTPX_TRACE_MASK));
+
+    TRACE_NAME_THREAD("test \"main\"");
+    CG_TRACE_PUSH("cg_scope");
+    HTTPX_TRACE_PUSH("httpx_scope");
+    HTTPX_TRACE_POP();
+    CG_TRACE_POP();
+    TRACE_TIME_SPAN_BEGIN(0x1234, "span %i", 42);
+    TRACE_TIME_SPAN_END(0x1234);
+    TRACE_TICK();
+
+    telemetry_shutdown();
+    assert_false(telemetry_trace_is_capturing(CG_TRACE_MASK));
+
+    char * const text = telemetry_test_read_trace();
+    assert_non_null(strstr(text, "{\"traceEvents\":["));
+    assert_non_null(strstr(text, "\n]}\n"));
+    assert_non_null(strstr(text, "\"name\":\"test \\\"main\\\"\""));
+    assert_int_equal(telemetry_test_count(text, "\"cg_scope\""), 1);
+    assert_null(strstr(text, "httpx_scope"));
+    assert_int_equal(telemetry_test_count(text, "\"ph\":\"B\""), 1);
+    assert_int_equal(telemetry_test_count(text, "\"ph\":\"E\""), 1);
+    assert_non_null(strstr(text, "\"ph\":\"b\",\"cat\":\"span\",\"id\":\"0x1234\""));
+    assert_non_null(strstr(text, "\"name\":\"span 42\""));
+    assert_non_null(strstr(text, "\"ph\":\"e\",\"cat\":\"span\",\"id\":\"0x1234\""));
+    assert_int_equal(telemetry_test_count(text, "\"name\":\"tick\""), 1);
+    free(text);
+}
+
+static int telemetry_test_thread_proc(void * const arg) {
+    (void)arg;
+    for (int i = 0; i < telemetry_test_num_scopes; ++i) {
+        RUNTIME_TRACE_PUSH_FN();
+        RUNTIME_TRACE_POP();
+    }
+    return 0;
+}
+
+static void test_telemetry_threads(void ** state) {
+    // all groups
+    telemetry_init(TELEMETRY_TEST_FILE, NULL);
+
+    sb_thread_id_t threads[telemetry_test_num_threads];
+    for (int i = 0; i < telemetry_test_num_threads; ++i) {
+        threads[i] = sb_create_thread("telemetry_test", sb_thread_default_options, telemetry_test_thread_proc, NULL, MALLOC_TAG);
+    }
+    for (int i = 0; i < telemetry_test_num_threads; ++i) {
+        sb_join_thread(threads[i]);
+    }
+
+    telemetry_shutdown();
+
+    char * const text = telemetry_test_read_trace();
+    assert_int_equal(telemetry_test_count(text, "\"telemetry_test_thread_proc\""), telemetry_test_num_threads * telemetry_test_num_scopes);
+    assert_int_equal(telemetry_test_count(text, "\"ph\":\"E\""), telemetry_test_num_threads * telemetry_test_num_scopes);
+    free(text);
+}
+
+static sb_atomic_int32_t telemetry_test_should_stop;
+
+static int telemetry_test_record_until_stopped(void * const arg) {
+    (void)arg;
+    while (!sb_atomic_load(&telemetry_test_should_stop, memory_order_acquire)) {
+        RUNTIME_TRACE_PUSH("recording");
+        RUNTIME_TRACE_POP();
+    }
+    return 0;
+}
+
+static void test_telemetry_shutdown_while_recording(void ** state) {
+    // the rings are unmapped by telemetry_shutdown while these threads keep recording
+    sb_atomic_store(&telemetry_test_should_stop, 0, memory_order_relaxed);
+    for (int run = 0; run < 8; ++run) {
+        telemetry_init(TELEMETRY_TEST_FILE, NULL);
+
+        sb_thread_id_t threads[telemetry_test_num_threads];
+        for (int i = 0; i < telemetry_test_num_threads; ++i) {
+            threads[i] = sb_create_thread("telemetry_test", sb_thread_default_options, telemetry_test_record_until_stopped, NULL, MALLOC_TAG);
+        }
+        sb_thread_sleep((milliseconds_t){5});
+
+        telemetry_shutdown();
+
+        sb_atomic_store(&telemetry_test_should_stop, 1, memory_order_release);
+        for (int i = 0; i < telemetry_test_num_threads; ++i) {
+            sb_join_thread(threads[i]);
+        }
+        sb_atomic_store(&telemetry_test_should_stop, 0, memory_order_relaxed);
+
+        char * const text = telemetry_test_read_trace();
+        assert_non_null(strstr(text, "\n]}\n"));
+        free(text);
+    }
+}
+
+int test_telemetry() {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_telemetry_capture_groups),
+        cmocka_unit_test(test_telemetry_threads),
+        cmocka_unit_test(test_telemetry_shutdown_while_recording),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+#endif
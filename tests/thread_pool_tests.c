@@ -10,6 +10,7 @@
  test fixture for thread_pool
  */
 
+#include "source/adk/runtime/memory_thread_cache.h"
 #include "source/adk/runtime/thread_pool.h"
 #include "source/adk/steamboat/sb_thread.h"
 #include "testapi.h"
@@ -70,9 +71,387 @@ static void thread_pool_unit_test(void ** ignored) {
     free(region.ptr);
 }
 
+enum {
+    steal_test_num_parents = 64,
+    steal_test_num_children = 8,
+    steal_test_chain_length = 32,
+};
+
+typedef struct steal_test_user_t {
+    sb_atomic_int32_t num_executed;
+    int num_completed;
+    int next_chain_completion;
+    bool chain_in_order;
+} steal_test_user_t;
+
+static void steal_test_child_job(void * user, thread_pool_t * const pool) {
+    sb_atomic_fetch_add(&((steal_test_user_t *)user)->num_executed, 1, memory_order_relaxed);
+}
+
+static void steal_test_parent_job(void * user, thread_pool_t * const pool) {
+    // front jobs enqueued from a worker land in its deque where idle workers can steal them
+    for (int i = 0; i < steal_test_num_children; ++i) {
+        thread_pool_enqueue_front(pool, steal_test_child_job, NULL, user);
+    }
+    sb_atomic_fetch_add(&((steal_test_user_t *)user)->num_executed, 1, memory_order_relaxed);
+}
+
+static void steal_test_parent_completed(void * user, thread_pool_t * const pool) {
+    ++((steal_test_user_t *)user)->num_completed;
+}
+
+typedef struct steal_test_chain_link_t {
+    steal_test_user_t * user;
+    int index;
+} steal_test_chain_link_t;
+
+static steal_test_chain_link_t steal_test_chain[steal_test_chain_length];
+
+static void steal_test_chain_completed(void * user, thread_pool_t * const pool) {
+    const steal_test_chain_link_t * const link = user;
+    link->user->chain_in_order &= link->index == link->user->next_chain_completion;
+    ++link->user->next_chain_completion;
+}
+
+static void steal_test_chain_job(void * user, thread_pool_t * const pool, job_token_t * const one_time_tok) {
+    const steal_test_chain_link_t * const link = user;
+    // schedule our completion before the continuation so completions run in chain order
+    thread_pool_enqueue_completion(pool, steal_test_chain_completed, one_time_tok);
+    if (link->index + 1 < steal_test_chain_length) {
+        thread_pool_enqueue_ext_job(pool, steal_test_chain_job, &steal_test_chain[link->index + 1]);
+    }
+}
+
+static void thread_pool_work_stealing_test(void ** ignored) {
+    const mem_region_t region = MEM_REGION(.ptr = malloc(256 * 1024), .size = 256 * 1024);
+    TRAP_OUT_OF_MEMORY(region.ptr);
+    thread_pool_t * const pool = thread_pool_emplace_init(region, thread_pool_max_threads, "test_ws_", MALLOC_TAG);
+
+    static steal_test_user_t user;
+    ZEROMEM(&user);
+    user.chain_in_order = true;
+
+    for (int i = 0; i < steal_test_chain_length; ++i) {
+        steal_test_chain[i] = (steal_test_chain_link_t){.user = &user, .index = i};
+    }
+    thread_pool_enqueue_ext_job(pool, steal_test_chain_job, &steal_test_chain[0]);
+
+    for (int i = 0; i < steal_test_num_parents; ++i) {
+        thread_pool_enqueue(pool, steal_test_parent_job, steal_test_parent_completed, &user);
+    }
+
+    thread_pool_drain(pool);
+
+    const int expected_jobs = steal_test_num_parents * (steal_test_num_children + 1);
+    assert_int_equal(sb_atomic_load(&user.num_executed, memory_order_acquire), expected_jobs);
+    assert_int_equal(user.num_completed, steal_test_num_parents);
+    assert_int_equal(user.next_chain_completion, steal_test_chain_length);
+    assert_true(user.chain_in_order);
+
+    uint32_t total_executed = 0;
+    for (int i = 0; i < pool->thread_count; ++i) {
+        const thread_pool_worker_stats_t stats = thread_pool_get_worker_stats(pool, i);
+        assert_true(stats.max_queue_depth <= thread_pool_deque_capacity);
+        total_executed += stats.jobs_executed;
+        print_message("worker [%i]: jobs [%u] steals [%u] max queue depth [%i] idle [%" PRIu64 "us]\n", i, stats.jobs_executed, stats.steals, stats.max_queue_depth, stats.idle_time.us);
+    }
+    assert_int_equal(total_executed, expected_jobs + steal_test_chain_length);
+
+    thread_pool_shutdown(pool, MALLOC_TAG);
+    free(region.ptr);
+}
+
+typedef struct priority_test_user_t {
+    sb_atomic_int32_t gate_open;
+    sb_atomic_int32_t gate_entered;
+    sb_atomic_int32_t num_run;
+    char run_order[16];
+    int num_completed;
+    int num_completed_cancelled;
+} priority_test_user_t;
+
+typedef struct priority_test_job_t {
+    priority_test_user_t * user;
+    char name;
+    bool completion_saw_cancel;
+} priority_test_job_t;
+
+static void priority_test_gate_job(void * user, thread_pool_t * const pool) {
+    priority_test_user_t * const test = ((priority_test_job_t *)user)->user;
+    sb_atomic_store(&test->gate_entered, 1, memory_order_release);
+    while (sb_atomic_load(&test->gate_open, memory_order_acquire) == 0) {
+        sb_thread_sleep((milliseconds_t){1});
+    }
+}
+
+static void priority_test_job(void * user, thread_pool_t * const pool) {
+    priority_test_job_t * const job = user;
+    assert_false(thread_pool_current_job_is_cancelled(pool));
+    const int index = sb_atomic_fetch_add(&job->user->num_run, 1, memory_order_relaxed);
+    job->user->run_order[index] = job->name;
+}
+
+static void priority_test_job_completed(void * user, thread_pool_t * const pool) {
+    priority_test_job_t * const job = user;
+    job->completion_saw_cancel = thread_pool_current_job_is_cancelled(pool);
+    ++job->user->num_completed;
+    if (job->completion_saw_cancel) {
+        ++job->user->num_completed_cancelled;
+    }
+}
+
+static thread_pool_job_handle_t priority_test_submit(thread_pool_t * const pool, priority_test_job_t * const job, const thread_pool_priority_e priority, const thread_pool_job_handle_t * const prerequisites, const int num_prerequisites) {
+    const thread_pool_job_desc_t desc = {
+        .job = priority_test_job,
+        .completion_call = priority_test_job_completed,
+        .user = job,
+        .priority = priority,
+        .prerequisites = prerequisites,
+        .num_prerequisites = num_prerequisites};
+    return thread_pool_submit(pool, &desc);
+}
+
+static void thread_pool_priority_test(void ** ignored) {
+    const mem_region_t region = MEM_REGION(.ptr = malloc(64 * 1024), .size = 64 * 1024);
+    TRAP_OUT_OF_MEMORY(region.ptr);
+    // a single worker makes the run order deterministic
+    thread_pool_t * const pool = thread_pool_emplace_init(region, 1, "test_pr_", MALLOC_TAG);
+
+    static priority_test_user_t user;
+    ZEROMEM(&user);
+
+    // park the worker so everything below is queued before anything runs
+    priority_test_job_t gate = {.user = &user, .name = '-'};
+    thread_pool_enqueue(pool, priority_test_gate_job, NULL, &gate);
+    while (sb_atomic_load(&user.gate_entered, memory_order_acquire) == 0) {
+        sb_thread_sleep((milliseconds_t){1});
+    }
+
+    priority_test_job_t jobs[] = {
+        {.user = &user, .name = 'L'},
+        {.user = &user, .name = 'N'},
+        {.user = &user, .name = 'n'},
+        {.user = &user, .name = 'X'},
+        {.user = &user, .name = 'H'},
+        {.user = &user, .name = 'P'},
+        {.user = &user, .name = 'D'},
+        {.user = &user, .name = 'C'},
+    };
+
+    priority_test_submit(pool, &jobs[0], thread_pool_priority_low, NULL, 0);
+    // a desc that leaves the priority zeroed gets the normal lane
+    const thread_pool_job_desc_t zeroed_desc = {.job = priority_test_job, .completion_call = priority_test_job_completed, .user = &jobs[1]};
+    const thread_pool_job_handle_t normal = thread_pool_submit(pool, &zeroed_desc);
+    priority_test_submit(pool, &jobs[2], thread_pool_priority_normal, NULL, 0);
+    const thread_pool_job_handle_t cancelled = priority_test_submit(pool, &jobs[3], thread_pool_priority_normal, NULL, 0);
+    const thread_pool_job_handle_t high = priority_test_submit(pool, &jobs[4], thread_pool_priority_high, NULL, 0);
+    const thread_pool_job_handle_t promoted = priority_test_submit(pool, &jobs[5], thread_pool_priority_low, NULL, 0);
+
+    // D waits on a normal and a high job, C waits on D and is only queued once D ran
+    const thread_pool_job_handle_t d_prerequisites[] = {normal, high};
+    const thread_pool_job_handle_t dependent = priority_test_submit(pool, &jobs[6], thread_pool_priority_normal, d_prerequisites, ARRAY_SIZE(d_prerequisites));
+    priority_test_submit(pool, &jobs[7], thread_pool_priority_high, &dependent, 1);
+
+    thread_pool_cancel(pool, cancelled);
+    thread_pool_set_priority(pool, promoted, thread_pool_priority_high);
+    assert_true(thread_pool_is_cancelled(pool, cancelled));
+    assert_false(thread_pool_is_cancelled(pool, high));
+
+    sb_atomic_store(&user.gate_open, 1, memory_order_release);
+    thread_pool_drain(pool);
+
+    assert_int_equal(sb_atomic_load(&user.num_run, memory_order_acquire), ARRAY_SIZE(jobs) - 1);
+    assert_string_equal(user.run_order, "HPNnDCL");
+    assert_int_equal(user.num_completed, ARRAY_SIZE(jobs));
+    assert_int_equal(user.num_completed_cancelled, 1);
+    assert_true(jobs[3].completion_saw_cancel);
+    assert_int_equal(thread_pool_get_worker_stats(pool, 0).jobs_cancelled, 1);
+
+    // finished jobs no longer match their handles
+    assert_false(thread_pool_is_cancelled(pool, cancelled));
+    thread_pool_cancel(pool, high);
+    thread_pool_set_priority(pool, high, thread_pool_priority_low);
+
+    // a finished prerequisite doesn't hold its dependent back
+    priority_test_job_t late = {.user = &user, .name = 'E'};
+    priority_test_submit(pool, &late, thread_pool_priority_normal, &high, 1);
+    thread_pool_drain(pool);
+    assert_string_equal(user.run_order, "HPNnDCLE");
+    assert_false(late.completion_saw_cancel);
+
+    thread_pool_shutdown(pool, MALLOC_TAG);
+    free(region.ptr);
+}
+
+typedef struct full_deque_test_user_t {
+    sb_atomic_int32_t gate_open;
+    sb_atomic_int32_t gate_entered;
+    sb_atomic_int32_t num_run;
+} full_deque_test_user_t;
+
+static void full_deque_test_count_job(void * user, thread_pool_t * const pool) {
+    sb_atomic_fetch_add(&((full_deque_test_user_t *)user)->num_run, 1, memory_order_relaxed);
+}
+
+static void full_deque_test_fill_job(void * user, thread_pool_t * const pool) {
+    full_deque_test_user_t * const test = user;
+    for (int i = 0; i < thread_pool_deque_capacity; ++i) {
+        thread_pool_enqueue_front(pool, full_deque_test_count_job, NULL, user);
+    }
+    sb_atomic_store(&test->gate_entered, 1, memory_order_release);
+    while (sb_atomic_load(&test->gate_open, memory_order_acquire) == 0) {
+        sb_thread_sleep((milliseconds_t){1});
+    }
+}
+
+static void thread_pool_full_deque_test(void ** ignored) {
+    const mem_region_t region = MEM_REGION(.ptr = malloc(256 * 1024), .size = 256 * 1024);
+    TRAP_OUT_OF_MEMORY(region.ptr);
+    // a single worker can't steal, so it alone has to drain both its full deque and the shared queue
+    thread_pool_t * const pool = thread_pool_emplace_init(region, 1, "test_fd_", MALLOC_TAG);
+
+    static full_deque_test_user_t user;
+    ZEROMEM(&user);
+
+    thread_pool_enqueue(pool, full_deque_test_fill_job, NULL, &user);
+    while (sb_atomic_load(&user.gate_entered, memory_order_acquire) == 0) {
+        sb_thread_sleep((milliseconds_t){1});
+    }
+    assert_int_equal(thread_pool_get_worker_stats(pool, 0).queue_depth, thread_pool_deque_capacity);
+
+    // a high priority job from outside the pool while the worker's deque has no free slot
+    const thread_pool_job_desc_t desc = {
+        .job = full_deque_test_count_job,
+        .user = &user,
+        .priority = thread_pool_priority_high};
+    thread_pool_submit(pool, &desc);
+
+    sb_atomic_store(&user.gate_open, 1, memory_order_release);
+    thread_pool_drain(pool);
+
+    assert_int_equal(sb_atomic_load(&user.num_run, memory_order_acquire), thread_pool_deque_capacity + 1);
+    assert_int_equal(thread_pool_get_worker_stats(pool, 0).jobs_executed, thread_pool_deque_capacity + 2);
+
+    thread_pool_shutdown(pool, MALLOC_TAG);
+    free(region.ptr);
+}
+
+enum {
+    thread_cache_test_num_jobs = 32,
+    thread_cache_test_num_ptrs = 64,
+    thread_cache_test_heap_size = 1024 * 1024,
+    thread_cache_test_pool_block_size = 48,
+    thread_cache_test_pool_num_blocks = 128,
+};
+
+typedef struct thread_cache_test_user_t {
+    heap_thread_cache_t cache;
+    int num_completed;
+} thread_cache_test_user_t;
+
+static thread_cache_test_user_t thread_cache_test_user;
+
+static void thread_cache_alloc_free_job(void * user, thread_pool_t * const pool) {
+    heap_thread_cache_t * const cache = &((thread_cache_test_user_t *)user)->cache;
+    void * ptrs[thread_cache_test_num_ptrs];
+    for (int round = 0; round < 8; ++round) {
+        for (int i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+            const size_t size = 8 + (size_t)(i % 5) * 70; // the last size is too large to cache
+            ptrs[i] = heap_thread_cache_alloc(cache, size, MALLOC_TAG);
+            memset(ptrs[i], i, size);
+        }
+        for (int i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+            heap_thread_cache_free(cache, ptrs[i], MALLOC_TAG);
+        }
+    }
+}
+
+static void thread_cache_job_completed(void * user, thread_pool_t * const pool) {
+    ++((thread_cache_test_user_t *)user)->num_completed;
+}
+
+static void heap_thread_cache_unit_test(void ** ignored) {
+    const mem_region_t heap_region = MEM_REGION(.ptr = malloc(thread_cache_test_heap_size), .size = thread_cache_test_heap_size);
+    TRAP_OUT_OF_MEMORY(heap_region.ptr);
+    heap_t heap;
+    heap_init_with_region(&heap, heap_region, 8, 0, "thread_cache_test");
+    sb_mutex_t * const mutex = sb_create_mutex(MALLOC_TAG);
+
+    thread_cache_test_user_t * const user = &thread_cache_test_user;
+    heap_thread_cache_t * const cache = &user->cache;
+    heap_thread_cache_init_with_heap(cache, &heap, mutex);
+
+    const mem_region_t pool_region = MEM_REGION(.ptr = malloc(64 * 1024), .size = 64 * 1024);
+    TRAP_OUT_OF_MEMORY(pool_region.ptr);
+    thread_pool_t * const pool = thread_pool_emplace_init(pool_region, thread_pool_max_threads, "test_tc_", MALLOC_TAG);
+
+    user->num_completed = 0;
+    for (int i = 0; i < thread_cache_test_num_jobs; ++i) {
+        thread_pool_enqueue(pool, thread_cache_alloc_free_job, thread_cache_job_completed, user);
+    }
+    thread_cache_alloc_free_job(user, pool);
+    while (user->num_completed < thread_cache_test_num_jobs) {
+        thread_pool_run_completion_callbacks(pool);
+    }
+
+    heap_thread_cache_metrics_t metrics = heap_get_thread_cache_metrics(&heap);
+    assert_true(metrics.total.hits > 0);
+    assert_true(metrics.total.refills > 0);
+    assert_true(metrics.total.num_cached_blocks > 0);
+
+    // workers give their magazines back on shutdown, only the main thread's blocks are still cached
+    thread_pool_shutdown(pool, MALLOC_TAG);
+    free(pool_region.ptr);
+
+    metrics = heap_get_thread_cache_metrics(&heap);
+    assert_int_equal(heap.internal.num_used_blocks, metrics.total.num_cached_blocks);
+    heap_verify(&heap);
+
+    heap_thread_cache_flush_current_thread();
+    assert_int_equal(heap.internal.num_used_blocks, 0);
+    metrics = heap_get_thread_cache_metrics(&heap);
+    assert_int_equal(metrics.total.num_cached_blocks, 0);
+    assert_int_equal(metrics.total.cached_bytes, 0);
+
+    heap_thread_cache_destroy(cache);
+    heap_destroy(&heap, MALLOC_TAG);
+    free(heap_region.ptr);
+
+    // memory_pool_t backed cache: a single size class of the pool's block size
+    const size_t pool_mem_size = thread_cache_test_pool_num_blocks * 128;
+    const mem_region_t mem_pool_region = MEM_REGION(.ptr = malloc(pool_mem_size), .size = pool_mem_size);
+    TRAP_OUT_OF_MEMORY(mem_pool_region.ptr);
+    memory_pool_t mem_pool;
+    memory_pool_init_with_region(&mem_pool, mem_pool_region, thread_cache_test_pool_block_size, 8, 0);
+    heap_thread_cache_init_with_pool(cache, &mem_pool, mutex);
+
+    void * ptrs[heap_thread_cache_magazine_size * 2];
+    for (int i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+        ptrs[i] = heap_thread_cache_alloc(cache, thread_cache_test_pool_block_size, MALLOC_TAG);
+    }
+    for (int i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+        heap_thread_cache_free(cache, ptrs[i], MALLOC_TAG);
+    }
+    assert_true(mem_pool.internal.num_used_blocks <= heap_thread_cache_magazine_size);
+    assert_int_equal(mem_pool.internal.num_used_blocks, heap_thread_cache_get_metrics(cache).total.num_cached_blocks);
+
+    heap_thread_cache_destroy(cache);
+    assert_int_equal(mem_pool.internal.num_used_blocks, 0);
+    memory_pool_verify(&mem_pool);
+    memory_pool_destroy(&mem_pool, MALLOC_TAG);
+    free(mem_pool_region.ptr);
+
+    heap_thread_cache_flush_current_thread();
+    sb_destroy_mutex(mutex, MALLOC_TAG);
+}
+
 int test_thread_pool() {
     const struct CMUnitTest tests[] = {
-        cmocka_unit_test_setup_teardown(thread_pool_unit_test, NULL, NULL)};
+        cmocka_unit_test_setup_teardown(thread_pool_unit_test, NULL, NULL),
+        cmocka_unit_test_setup_teardown(thread_pool_work_stealing_test, NULL, NULL),
+        cmocka_unit_test_setup_teardown(thread_pool_priority_test, NULL, NULL),
+        cmocka_unit_test_setup_teardown(thread_pool_full_deque_test, NULL, NULL),
+        cmocka_unit_test_setup_teardown(heap_thread_cache_unit_test, NULL, NULL)};
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -21,7 +21,7 @@ integration for running rust tests in wasm3
 #include "source/adk/wasm3/wasm3_link.h"
 #endif // _WASM3
 
-static void wasm3_unit_test(void ** state) {
+static int wasm3_setup(void ** state) {
 #ifdef _WASM3
     wasm_interpreter_t * const wasm3 = get_wasm3_interpreter();
     set_active_wasm_interpreter(wasm3);
@@ -35,6 +35,13 @@ static void wasm3_unit_test(void ** state) {
     const uint32_t wasm_high_heap_size = 32 * 1024 * 1024;
     const wasm_memory_region_t region = wasm3->load(sb_app_root_directory, "target/wasm32-unknown-unknown/release/wasm_tests.wasm", wasm_low_heap_size, wasm_high_heap_size, 100 * 1024);
     VERIFY_MSG(region.wasm_bytecode_size, "Failed to load Wasm file");
+#endif // _WASM3
+    return 0;
+}
+
+static void wasm3_unit_test(void ** state) {
+#ifdef _WASM3
+    wasm_interpreter_t * const wasm3 = get_wasm3_interpreter();
 
     const wasm_call_result_t ffi_test = wasm3->call_i("exercise", 0);
     VERIFY_MSG(!ffi_test.status, ffi_test.details);
@@ -44,6 +51,18 @@ static void wasm3_unit_test(void ** state) {
     VERIFY_MSG(r1.status == wasm_call_success, r1.details);
     assert_int_equal(ret1, 42);
 
+    wasm_function_handle_t h1;
+    VERIFY(wasm3->find_function("test_interpreter_1", &h1).status == wasm_call_success);
+    wasm_call_slot_t ret1_handle = {0};
+    const wasm_call_result_t r1_handle = wasm3->call_handle(h1, &ret1_handle, 0, NULL);
+    VERIFY_MSG(r1_handle.status == wasm_call_success, r1_handle.details);
+    assert_int_equal(ret1_handle.I, 42);
+
+    wasm_function_handle_t missing;
+    VERIFY(wasm3->find_function("not_an_export", &missing).status == wasm_call_function_not_found);
+    assert_null(missing.function);
+    assert_int_equal(wasm3->call_handle(missing, NULL, 0, NULL).status, wasm_call_function_not_found);
+
     uint32_t ret2 = 0;
     const wasm_call_result_t r2 = wasm3->call_ri("test_interpreter_2", &ret2);
     VERIFY_MSG(r2.status == wasm_call_success, r2.details);
@@ -95,8 +114,42 @@ static void wasm3_unit_test(void ** state) {
 #endif // _WASM3
 }
 
-static int wasm3_setup(void ** state) {
-    return 0;
+// Times the same trivial export called by name, which looks it up on every call, and through a handle resolved once.
+static void wasm3_call_perf(void ** state) {
+#ifdef _WASM3
+    wasm_interpreter_t * const wasm3 = get_wasm3_interpreter();
+
+    enum {
+        call_count = 100000,
+    };
+
+    wasm_function_handle_t handle;
+    const wasm_call_result_t find_result = wasm3->find_function("test_interpreter_1", &handle);
+    VERIFY_MSG(find_result.status == wasm_call_success, find_result.details);
+
+    uint64_t by_name = 0;
+    const microseconds_t name_start = adk_read_microsecond_clock();
+    for (int i = 0; i < call_count; ++i) {
+        const wasm_call_result_t result = wasm3->call_rI("test_interpreter_1", &by_name);
+        VERIFY_MSG(result.status == wasm_call_success, result.details);
+    }
+    const microseconds_t name_end = adk_read_microsecond_clock();
+
+    wasm_call_slot_t by_handle = {0};
+    const microseconds_t handle_start = adk_read_microsecond_clock();
+    for (int i = 0; i < call_count; ++i) {
+        const wasm_call_result_t result = wasm3->call_handle(handle, &by_handle, 0, NULL);
+        VERIFY_MSG(result.status == wasm_call_success, result.details);
+    }
+    const microseconds_t handle_end = adk_read_microsecond_clock();
+
+    assert_int_equal(by_name, 42);
+    assert_int_equal(by_handle.I, 42);
+
+    const double name_ns = (double)(name_end.us - name_start.us) * 1000.0 / call_count;
+    const double handle_ns = (double)(handle_end.us - handle_start.us) * 1000.0 / call_count;
+    print_message("[wasm3] per call: by name %.1f ns, by handle %.1f ns\n", name_ns, handle_ns);
+#endif // _WASM3
 }
 
 static int wasm3_teardown(void ** state) {
@@ -105,7 +158,8 @@ static int wasm3_teardown(void ** state) {
 
 int test_wasm3() {
     const struct CMUnitTest tests[] = {
-        cmocka_unit_test(wasm3_unit_test)};
+        cmocka_unit_test(wasm3_unit_test),
+        cmocka_unit_test(wasm3_call_perf)};
 
     return cmocka_run_group_tests(tests, wasm3_setup, wasm3_teardown);
 }